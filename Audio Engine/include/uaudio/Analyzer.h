@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+#include <uaudio/utils/TripleBuffer.h>
+
+namespace uaudio
+{
+#if !defined(UAUDIO_DEFAULT_FFT_SIZE)
+
+	#define UAUDIO_DEFAULT_FFT_SIZE 2048
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_NUM_BANDS)
+
+	#define UAUDIO_DEFAULT_NUM_BANDS 64
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_ANALYZER_RATE)
+
+	// How many times per second the worker analyzes the latest frames.
+	#define UAUDIO_DEFAULT_ANALYZER_RATE 30
+
+#endif
+
+	#define UAUDIO_MAX_BANDS 256
+
+	// The lowest level of a band (in dB).
+	#define UAUDIO_ANALYZER_FLOOR -120.0f
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the spectrum analyzer. It taps a bus (or the master) and turns the latest frames into the levels of a set of frequency bands.
+	 *
+		* The channels on the bus add their samples (after the gain stage, downmixed to mono) to a ring while they make their buffers. That is all the audio thread does.
+		  Channels that make a buffer in the same update are mixed from the same position, the position moves on after the update (see Commit).
+		* A worker thread takes the latest frames out of the ring, applies a Hann window and runs an FFT with a plan (bit reversal and twiddles) that is made once.
+		* The magnitudes go into bands, linear or log spaced between a minimum and maximum frequency. A band is the loudest bin in its range (in dB, a full scale sine is 0 dB).
+		* The bands get published through a triple buffer, the UI polls them without waiting on the worker or the audio thread.
+		* All memory is allocated in the constructor.
+	 */
+	struct SpectrumReadings
+	{
+		uint32_t numBands = 0;
+
+		// The center frequency and the level (in dB) of every band.
+		float frequencies[UAUDIO_MAX_BANDS] = {};
+		float bands[UAUDIO_MAX_BANDS] = {};
+	};
+
+	class Analyzer
+	{
+	public:
+		Analyzer(uint32_t a_FFTSize = UAUDIO_DEFAULT_FFT_SIZE);
+		~Analyzer();
+
+		Analyzer(const Analyzer &rhs) = delete;
+		Analyzer &operator=(const Analyzer &rhs) = delete;
+
+		void SetSampleRate(uint32_t a_SampleRate);
+		uint32_t GetSampleRate() const;
+		uint32_t GetFFTSize() const;
+
+		void SetBus(uint32_t a_Bus);
+		uint32_t GetBus() const;
+
+		void SetBands(uint32_t a_NumBands, BAND_SPACING a_Spacing, float a_MinFrequency = 20.0f, float a_MaxFrequency = 20000.0f);
+		uint32_t GetNumBands() const;
+		BAND_SPACING GetSpacing() const;
+
+		void SetEnabled(bool a_Enabled);
+		bool IsEnabled() const;
+
+		// Audio thread.
+		bool IsTapped(uint32_t a_Bus) const;
+		void Write(const float *a_Samples, uint32_t a_NumSamples, uint32_t a_FirstSample, uint16_t a_NumChannels);
+		void Commit();
+
+		// Worker thread (or a test).
+		bool Analyze();
+
+		SpectrumReadings Read();
+
+	private:
+		void Run();
+		void CalculateBands();
+
+		uint32_t m_FFTSize = 0;
+		uint32_t m_SampleRate = WAVE_SAMPLE_RATE_44100;
+
+		std::atomic<uint32_t> m_Bus{UAUDIO_MASTER_BUS};
+		std::atomic<bool> m_Enabled{false};
+
+		// The mono mix of the bus. The write position is in frames since the start, the ring index is the position masked by the ring size.
+		std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Ring;
+		uint32_t m_RingMask = 0;
+		std::atomic<uint64_t> m_Written{0};
+		uint64_t m_Cleared = 0;
+		uint32_t m_UpdateFrames = 0;
+
+		// The worker: the position of the last analysis and the FFT plan.
+		std::thread m_Thread;
+		uint64_t m_Analyzed = 0;
+		std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Window;
+		std::vector<uint32_t, UAUDIO_DEFAULT_ALLOCATOR<uint32_t>> m_BitReverse;
+		std::vector<std::complex<float>, UAUDIO_DEFAULT_ALLOCATOR<std::complex<float>>> m_Twiddles;
+		std::vector<std::complex<float>, UAUDIO_DEFAULT_ALLOCATOR<std::complex<float>>> m_Bins;
+
+		// The bands (shared by the UI and the worker, the audio thread never locks).
+		std::mutex m_BandMutex;
+		uint32_t m_NumBands = UAUDIO_DEFAULT_NUM_BANDS;
+		BAND_SPACING m_Spacing = BAND_SPACING::BAND_SPACING_LOG;
+		float m_MinFrequency = 20.0f, m_MaxFrequency = 20000.0f;
+		uint32_t m_FirstBin[UAUDIO_MAX_BANDS] = {};
+		uint32_t m_LastBin[UAUDIO_MAX_BANDS] = {};
+		float m_Frequencies[UAUDIO_MAX_BANDS] = {};
+
+		utils::TripleBuffer<SpectrumReadings> m_Readings;
+	};
+}
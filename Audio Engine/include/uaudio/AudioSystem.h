@@ -1,11 +1,18 @@
 ﻿#pragma once
 
+#include <array>
+#include <chrono>
 #include <thread>
 #include <vector>
 
 #include <uaudio/xaudio2/XAudio2Channel.h>
+#include <uaudio/Analyzer.h>
 #include <uaudio/Handle.h>
+#include <uaudio/Ducker.h>
+#include <uaudio/Spatializer.h>
+#include <uaudio/Streamer.h>
 #include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
 
 enum class AUDIO_MODE
 {
@@ -47,17 +54,44 @@ namespace uaudio
 		BUFFERSIZE GetBufferSize() const;
 		void SetBufferSize(BUFFERSIZE a_BufferSize);
 
+		uint32_t GetSampleRate() const;
+		uint16_t GetNumChannels() const;
+		uint32_t GetChannelMask() const;
+
+		// 3D positions of the listener and the emitters.
+		Spatializer &GetSpatializer();
+		const Spatializer &GetSpatializer() const;
+
+		// Sidechain ducking between the buses of the channels.
+		Ducker &GetDucker();
+		const Ducker &GetDucker() const;
+
+		// Spectrum of a bus or the master (see Analyzer).
+		Analyzer &GetAnalyzer();
+
+		// Streams of the sounds that stay on the disk (see Streamer).
+		Streamer &GetStreamer();
+
+		// Levels of the buses and the master (the sum of the channels, see Meter). Read them from one thread, such as the UI.
+		void SetMetering(bool a_Metering);
+		bool IsMetering() const;
+		effects::MeterReadings ReadMasterMeter();
+		effects::MeterReadings ReadBusMeter(uint32_t a_Bus);
+
 		// Channel-related methods.
 		ChannelHandle Play(const WaveFile &a_WaveFile);
 
 		uint32_t ChannelSize() const;
 		xaudio2::XAudio2Channel *GetChannel(ChannelHandle a_ChannelHandle);
 
+		void Crossfade(ChannelHandle a_From, ChannelHandle a_To, float a_Milliseconds);
+
 	private:
 		AUDIO_MODE m_AudioMode = AUDIO_MODE::AUDIO_MODE_THREADED;
 
 		void Update();
 		void UpdateChannels();
+		void UpdateMeters();
 
 		std::thread m_Thread;
 
@@ -66,6 +100,31 @@ namespace uaudio
 
 		BUFFERSIZE m_BufferSize = UAUDIO_DEFAULT_BUFFERSIZE;
 
+		// The sample rate of the mastering voice (every channel gets converted to this).
+		uint32_t m_SampleRate = WAVE_SAMPLE_RATE_44100;
+
+		// The number of speakers of the mastering voice.
+		uint16_t m_NumChannels = WAVE_CHANNELS_STEREO;
+		uint32_t m_ChannelMask = WAVE_SPEAKERS_STEREO;
+
+		Spatializer m_Spatializer;
+
+		// Gets updated on the audio thread, after the channels.
+		Ducker m_Ducker;
+		std::chrono::steady_clock::time_point m_LastUpdate = std::chrono::steady_clock::now();
+
+		// Gets its samples from the channels and moves on after every update.
+		Analyzer m_Analyzer;
+
+		// The bus and master levels get added up every block of the meters.
+		bool m_Metering = UAUDIO_DEFAULT_METERING;
+		float m_MeterTime = 0.0f;
+		std::array<utils::TripleBuffer<effects::MeterReadings>, UAUDIO_MAX_BUSES> m_BusMeters;
+		utils::TripleBuffer<effects::MeterReadings> m_MasterMeter;
+
+		// Before the channels, so the channels close their streams before it goes.
+		Streamer m_Streamer;
+
 		std::vector<xaudio2::XAudio2Channel, UAUDIO_DEFAULT_ALLOCATOR<xaudio2::XAudio2Channel>> m_Channels;
 
 		bool m_Active = true;
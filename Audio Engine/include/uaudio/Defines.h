@@ -17,17 +17,46 @@ namespace uaudio
 	constexpr uint16_t WAVE_BITS_PER_SAMPLE_16 = 16;
 	constexpr uint16_t WAVE_BITS_PER_SAMPLE_24 = 24;
 	constexpr uint16_t WAVE_BITS_PER_SAMPLE_32 = 32;
+	constexpr uint16_t WAVE_BITS_PER_SAMPLE_64 = 64;
 
 	// SAMPLE RATE SETTINGS
 	constexpr uint32_t WAVE_SAMPLE_RATE_44100 = 44100;
 	constexpr uint32_t WAVE_SAMPLE_RATE_48000 = 48000;
 	constexpr uint32_t WAVE_SAMPLE_RATE_88200 = 88200;
+	constexpr uint32_t WAVE_SAMPLE_RATE_96000 = 96000;
 	constexpr uint32_t WAVE_SAMPLE_RATE_192000 = 192000;
 
 	// MONO/STEREO.
 	constexpr uint16_t WAVE_CHANNELS_MONO = 1;
 	constexpr uint16_t WAVE_CHANNELS_STEREO = 2;
 
+	// SURROUND.
+	constexpr uint16_t WAVE_CHANNELS_QUAD = 4;
+	constexpr uint16_t WAVE_CHANNELS_5_1 = 6;
+	constexpr uint16_t WAVE_CHANNELS_7_1 = 8;
+
+	// SPEAKER POSITIONS (channel mask of WAVE_FORMAT_EXTENSIBLE, the channels are stored in the order of the bits).
+	constexpr uint32_t WAVE_SPEAKER_FRONT_LEFT = 0x1;
+	constexpr uint32_t WAVE_SPEAKER_FRONT_RIGHT = 0x2;
+	constexpr uint32_t WAVE_SPEAKER_FRONT_CENTER = 0x4;
+	constexpr uint32_t WAVE_SPEAKER_LOW_FREQUENCY = 0x8;
+	constexpr uint32_t WAVE_SPEAKER_BACK_LEFT = 0x10;
+	constexpr uint32_t WAVE_SPEAKER_BACK_RIGHT = 0x20;
+	constexpr uint32_t WAVE_SPEAKER_FRONT_LEFT_OF_CENTER = 0x40;
+	constexpr uint32_t WAVE_SPEAKER_FRONT_RIGHT_OF_CENTER = 0x80;
+	constexpr uint32_t WAVE_SPEAKER_BACK_CENTER = 0x100;
+	constexpr uint32_t WAVE_SPEAKER_SIDE_LEFT = 0x200;
+	constexpr uint32_t WAVE_SPEAKER_SIDE_RIGHT = 0x400;
+
+	// SPEAKER LAYOUTS.
+	constexpr uint32_t WAVE_SPEAKERS_MONO = WAVE_SPEAKER_FRONT_CENTER;
+	constexpr uint32_t WAVE_SPEAKERS_STEREO = WAVE_SPEAKER_FRONT_LEFT | WAVE_SPEAKER_FRONT_RIGHT;
+	constexpr uint32_t WAVE_SPEAKERS_QUAD = WAVE_SPEAKERS_STEREO | WAVE_SPEAKER_BACK_LEFT | WAVE_SPEAKER_BACK_RIGHT;
+	constexpr uint32_t WAVE_SPEAKERS_5_1 = WAVE_SPEAKERS_QUAD | WAVE_SPEAKER_FRONT_CENTER | WAVE_SPEAKER_LOW_FREQUENCY;
+	constexpr uint32_t WAVE_SPEAKERS_7_1 = WAVE_SPEAKERS_5_1 | WAVE_SPEAKER_SIDE_LEFT | WAVE_SPEAKER_SIDE_RIGHT;
+	constexpr uint32_t WAVE_SPEAKERS_LEFT = WAVE_SPEAKER_FRONT_LEFT | WAVE_SPEAKER_BACK_LEFT | WAVE_SPEAKER_FRONT_LEFT_OF_CENTER | WAVE_SPEAKER_SIDE_LEFT;
+	constexpr uint32_t WAVE_SPEAKERS_RIGHT = WAVE_SPEAKER_FRONT_RIGHT | WAVE_SPEAKER_BACK_RIGHT | WAVE_SPEAKER_FRONT_RIGHT_OF_CENTER | WAVE_SPEAKER_SIDE_RIGHT;
+
 	// WAV FORMATS.
 	constexpr uint16_t WAV_FORMAT_UNKNOWN = 1;
 	constexpr uint16_t WAV_FORMAT_PCM = 1;
@@ -42,6 +71,11 @@ namespace uaudio
 	constexpr uint16_t WAV_FORMAT_GSM_610 = 49;
 	constexpr uint16_t WAV_FORMAT_ITU_G721_ADPCM = 64;
 	constexpr uint16_t WAV_FORMAT_MPEG = 80;
+	constexpr uint16_t WAV_FORMAT_IEEE_FLOAT = 3;
+	constexpr uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+	// SIZE OF THE FMT CHUNK WITH THE WAVE_FORMAT_EXTENSIBLE FIELDS.
+	constexpr uint32_t FMT_CHUNK_EXTENSIBLE_SIZE = 40;
 
 	// CHUNK DEFINITIONS.
 	constexpr auto RIFF_CHUNK_ID = "RIFF";
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the sidechain ducker. The level of one bus (the key, for example dialogue) turns down other buses (the targets, for example music).
+	 * Every channel plays on a bus (see XAudio2Channel::SetBus), bus 0 is the default.
+	 *
+		* Channels on the key bus report the peak of every buffer they make (after their volume), which is the key for as long as that buffer lasts.
+		* Update runs on the audio thread after the channels, once per update. Above the threshold the target is the depth, the hold keeps it there after the key drops.
+		* The gain reduction follows the target with a one-pole filter, with the attack when it goes down and the release when it comes back up.
+		* Channels on the target buses ramp from the gain of their last buffer to the current gain, so the reduction does not step at buffer boundaries.
+		* The reduction is atomic, so the UI can read it from another thread.
+	 */
+	struct DuckerSettings
+	{
+		uint32_t keyBus = 1;
+
+		// A bit per bus (bit 0 is bus 0).
+		uint32_t targetBuses = 1u << UAUDIO_DEFAULT_BUS;
+
+		// The level of the key that starts the ducking and the gain reduction when fully ducked (in dB).
+		float threshold = -30.0f;
+		float depth = -12.0f;
+
+		// In milliseconds.
+		float attack = 50.0f;
+		float release = 500.0f;
+		float hold = 200.0f;
+	};
+
+	class Ducker
+	{
+	public:
+		void SetSettings(const DuckerSettings &a_Settings);
+		const DuckerSettings &GetSettings() const;
+
+		void SetEnabled(bool a_Enabled);
+		bool IsEnabled() const;
+
+		bool IsKey(uint32_t a_Bus) const;
+		bool IsTarget(uint32_t a_Bus) const;
+
+		void AddKey(uint32_t a_Bus, float a_Peak, float a_Seconds);
+		void Update(float a_Seconds);
+		void Reset();
+
+		float GetGain(uint32_t a_Bus) const;
+		float GetReduction() const;
+
+	private:
+		DuckerSettings m_Settings;
+		bool m_Enabled = false;
+
+		// The loudest peak of the key and how long it lasts.
+		float m_KeyLevel = 0.0f;
+		float m_KeyTime = 0.0f;
+
+		// How long the reduction stays at the depth after the key drops below the threshold.
+		float m_HoldTime = 0.0f;
+
+		// The current gain reduction (in dB, 0 or lower).
+		std::atomic<float> m_Reduction{0.0f};
+	};
+}
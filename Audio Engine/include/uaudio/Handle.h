@@ -38,4 +38,103 @@ namespace uaudio
 	protected:
 		int32_t m_Handle = SOUND_NULL_HANDLE;
 	};
+
+	struct EmitterHandle
+	{
+		EmitterHandle() = default;
+		EmitterHandle(const int32_t rhs) { m_Handle = rhs; }
+		EmitterHandle(const EmitterHandle& rhs) { m_Handle = rhs; }
+		~EmitterHandle() = default;
+
+		EmitterHandle& operator=(const EmitterHandle& rhs) { m_Handle = rhs; return *this; }
+
+		operator int32_t() const
+		{
+			return m_Handle;
+		}
+
+		EmitterHandle& operator=(const int32_t a_Rhs)
+		{
+			m_Handle = a_Rhs;
+			return *this;
+		}
+
+		/// <summary>
+		/// Retrieves the validity of the handle.
+		/// </summary>
+		/// <returns>Returns whether the handle is valid.</returns>
+		bool IsValid() const
+		{
+			return m_Handle != SOUND_NULL_HANDLE;
+		}
+
+	protected:
+		int32_t m_Handle = SOUND_NULL_HANDLE;
+	};
+
+	struct StreamHandle
+	{
+		StreamHandle() = default;
+		StreamHandle(const int32_t rhs) { m_Handle = rhs; }
+		StreamHandle(const StreamHandle& rhs) { m_Handle = rhs; }
+		~StreamHandle() = default;
+
+		StreamHandle& operator=(const StreamHandle& rhs) { m_Handle = rhs; return *this; }
+
+		operator int32_t() const
+		{
+			return m_Handle;
+		}
+
+		StreamHandle& operator=(const int32_t a_Rhs)
+		{
+			m_Handle = a_Rhs;
+			return *this;
+		}
+
+		/// <summary>
+		/// Retrieves the validity of the handle.
+		/// </summary>
+		/// <returns>Returns whether the handle is valid.</returns>
+		bool IsValid() const
+		{
+			return m_Handle != SOUND_NULL_HANDLE;
+		}
+
+	protected:
+		int32_t m_Handle = SOUND_NULL_HANDLE;
+	};
+
+	struct LoadHandle
+	{
+		LoadHandle() = default;
+		LoadHandle(const int32_t rhs) { m_Handle = rhs; }
+		LoadHandle(const LoadHandle& rhs) { m_Handle = rhs; }
+		~LoadHandle() = default;
+
+		LoadHandle& operator=(const LoadHandle& rhs) { m_Handle = rhs; return *this; }
+
+		operator int32_t() const
+		{
+			return m_Handle;
+		}
+
+		LoadHandle& operator=(const int32_t a_Rhs)
+		{
+			m_Handle = a_Rhs;
+			return *this;
+		}
+
+		/// <summary>
+		/// Retrieves the validity of the handle.
+		/// </summary>
+		/// <returns>Returns whether the handle is valid.</returns>
+		bool IsValid() const
+		{
+			return m_Handle != SOUND_NULL_HANDLE;
+		}
+
+	protected:
+		int32_t m_Handle = SOUND_NULL_HANDLE;
+	};
 }
\ No newline at end of file
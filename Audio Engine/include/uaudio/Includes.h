@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace uaudio
 {
 	enum class BUFFERSIZE
@@ -20,6 +22,91 @@ namespace uaudio
 		LOOP_POINT_SETTING_END,
 		LOOP_POINT_SETTING_BOTH,
 	};
+
+	enum class DITHER
+	{
+		DITHER_NONE,
+		DITHER_TPDF,
+		DITHER_TPDF_NOISE_SHAPING,
+	};
+
+	// The same values as the loop types in the smpl chunk.
+	enum class LOOP_TYPE
+	{
+		LOOP_TYPE_FORWARD,
+		LOOP_TYPE_PING_PONG,
+		LOOP_TYPE_REVERSE,
+	};
+
+	enum class ENVELOPE_CURVE
+	{
+		ENVELOPE_CURVE_LINEAR,
+		ENVELOPE_CURVE_EXPONENTIAL,
+		ENVELOPE_CURVE_EQUAL_POWER,
+	};
+
+	enum class ENVELOPE_STAGE
+	{
+		ENVELOPE_STAGE_ATTACK,
+		ENVELOPE_STAGE_DECAY,
+		ENVELOPE_STAGE_SUSTAIN,
+		ENVELOPE_STAGE_FADE,
+		ENVELOPE_STAGE_RELEASE,
+		ENVELOPE_STAGE_DONE,
+	};
+
+	enum class BAND_SPACING
+	{
+		BAND_SPACING_LINEAR,
+		BAND_SPACING_LOG,
+	};
+
+	enum class ATTENUATION_CURVE
+	{
+		ATTENUATION_CURVE_NONE,
+		ATTENUATION_CURVE_INVERSE,
+		ATTENUATION_CURVE_LINEAR,
+		ATTENUATION_CURVE_EXPONENTIAL,
+	};
+
+	enum class LOAD_PRIORITY
+	{
+		LOAD_PRIORITY_LOW,
+		LOAD_PRIORITY_NORMAL,
+		LOAD_PRIORITY_HIGH,
+	};
+
+	enum class LOAD_STATUS
+	{
+		LOAD_STATUS_INVALID,
+		LOAD_STATUS_QUEUED,
+		LOAD_STATUS_LOADING,
+		LOAD_STATUS_DONE,
+		LOAD_STATUS_FAILED,
+		LOAD_STATUS_CANCELLED,
+	};
+
+	// The instruction sets that the conversion kernels have versions for (see WaveKernels.h).
+	enum class SIMD_LEVEL
+	{
+		SIMD_LEVEL_SCALAR,
+		SIMD_LEVEL_SSE2,
+		SIMD_LEVEL_SSSE3,
+		SIMD_LEVEL_AVX2,
+		SIMD_LEVEL_NEON,
+	};
+
+	// The formats that pcm samples can be stored in (see GetSampleFormat). 8-bit samples are unsigned, like in wave files.
+	enum class SAMPLE_FORMAT
+	{
+		SAMPLE_FORMAT_UNKNOWN,
+		SAMPLE_FORMAT_UINT8,
+		SAMPLE_FORMAT_INT16,
+		SAMPLE_FORMAT_INT24,
+		SAMPLE_FORMAT_INT32,
+		SAMPLE_FORMAT_FLOAT32,
+		SAMPLE_FORMAT_FLOAT64,
+	};
 }
 
 // Necessary to override all the default settings.
@@ -73,6 +160,18 @@ namespace uaudio
 
 	#define UAUDIO_DEFAULT_BUFFERSIZE BUFFERSIZE::BUFFERSIZE_8192
 
+#endif
+
+#if !defined(UAUDIO_DEFAULT_DITHER)
+
+	#define UAUDIO_DEFAULT_DITHER DITHER::DITHER_TPDF
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_METERING)
+
+	#define UAUDIO_DEFAULT_METERING true
+
 #endif
 
 	#define UAUDIO_MAX_PANNING 1.0f
@@ -92,4 +191,32 @@ namespace uaudio
 	#define UAUDIO_DEFAULT_PANNING 0.0f
 
 #endif
+
+	#define UAUDIO_MAX_TEMPO 2.0f
+	#define UAUDIO_MIN_TEMPO 0.5f
+
+#if !defined(UAUDIO_DEFAULT_TEMPO)
+
+	#define UAUDIO_DEFAULT_TEMPO 1.0f
+
+#endif
+
+	// The frequency ratio of the source voices (doppler).
+	#define UAUDIO_MAX_PITCH 2.0f
+	#define UAUDIO_MIN_PITCH 0.5f
+
+	// 7.1 is the biggest speaker layout.
+	#define UAUDIO_MAX_SPEAKERS 8
+
+#if !defined(UAUDIO_DEFAULT_BUS)
+
+	#define UAUDIO_DEFAULT_BUS 0
+
+#endif
+
+	// Buses are a bit in the mask of target buses of the ducker, so there are at most 32.
+	constexpr uint32_t UAUDIO_MAX_BUSES = 32;
+
+	// Not a bus of its own, but all channels together.
+	constexpr uint32_t UAUDIO_MASTER_BUS = UAUDIO_MAX_BUSES;
 }
\ No newline at end of file
@@ -1,7 +1,16 @@
 ﻿#pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include <uaudio/Handle.h>
 #include <uaudio/Includes.h>
 
 #include <uaudio/wave/high_level/WaveConfig.h>
@@ -9,19 +18,153 @@
 
 namespace uaudio
 {
+#if !defined(UAUDIO_DEFAULT_LOAD_THREADS)
+
+	// The amount of threads that load sounds in the background (0 means one per core, minus the thread that plays them).
+	#define UAUDIO_DEFAULT_LOAD_THREADS 0
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_BATCH_THREADS)
+
+	// The amount of threads that load a manifest, including the thread that calls LoadSounds (0 means one per core).
+	#define UAUDIO_DEFAULT_BATCH_THREADS 0
+
+#endif
+
+	// Gets called by SoundSystem::Update (on the thread that calls it) when a load is done, failed or got cancelled.
+	typedef void (*LoadCallback)(LoadHandle a_LoadHandle, UAUDIO_DEFAULT_HASH a_Hash, LOAD_STATUS a_Status, void *a_UserData);
+
+	// A sound that gets loaded by SoundSystem::LoadSounds.
+	struct SoundManifestEntry
+	{
+		std::string path;
+		std::string name;
+		WaveConfig waveConfig;
+	};
+
+	// How one sound of a manifest loaded.
+	struct SoundLoadReport
+	{
+		UAUDIO_DEFAULT_HASH hash = 0;
+		bool loaded = false;
+
+		// The size of the file (in bytes) and how long it took to read, parse and convert it.
+		uint32_t fileSize = 0;
+		float milliseconds = 0.0f;
+		float megabytesPerSecond = 0.0f;
+	};
+
+	// How a whole manifest loaded.
+	struct BatchLoadReport
+	{
+		// In the order of the manifest.
+		std::vector<SoundLoadReport, UAUDIO_DEFAULT_ALLOCATOR<SoundLoadReport>> sounds;
+		uint32_t numLoaded = 0;
+
+		// The size of all files (in bytes) and how long the whole manifest took (wall clock, not the sum of the sounds).
+		uint64_t totalSize = 0;
+		float milliseconds = 0.0f;
+		float megabytesPerSecond = 0.0f;
+	};
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the sound system. It holds the sounds by the hash of their name.
+	 *
+		* LoadSound loads a sound on the thread that calls it.
+		* LoadSoundAsync queues a sound for the workers (started with the first one). A worker reads, parses and converts a whole sound, so while one
+		  worker waits on the disk another one converts. The queue has priorities, within a priority the sounds load in the order they were queued.
+		* A loaded sound waits until Update gets called (on the thread that uses the sounds, such as the game thread). Update moves it into the sounds,
+		  so a sound can be found (and played) only once it is fully there, and the sounds are never changed while another thread reads them.
+		  Update also calls the callbacks of the loads and removes them, after that their handles are invalid.
+		* A load that is still in the queue gets cancelled right away. A load that a worker is busy with finishes, and then gets thrown away.
+		  When the sound system gets destroyed the queued loads get cancelled (without their callbacks) and only the busy ones are waited for.
+		* The sounds are guarded by the same lock as the loads, so they can be found while Update or LoadSounds moves sounds in.
+		* LoadSounds loads a whole manifest (such as all sounds that are needed at boot) and returns when it is done. The sounds get spread over threads
+		  (the calling thread is one of them) that take the next sound of the manifest when they are done with one. When fewer sounds are left
+		  than there are threads, the last sounds split their conversion over the idle threads (see WaveConfig::conversionThreads).
+		  The sounds get moved into the sounds all at once at the end, and the report says how fast every sound and the whole manifest loaded (in MB/s).
+	 */
 	class SoundSystem
 	{
 	public:
+		SoundSystem(uint32_t a_NumThreads = UAUDIO_DEFAULT_LOAD_THREADS);
+		~SoundSystem();
+
+		SoundSystem(const SoundSystem &rhs) = delete;
+		SoundSystem &operator=(const SoundSystem &rhs) = delete;
+
 		UAUDIO_DEFAULT_HASH LoadSound(const char *a_Path, const char *a_Name, WaveConfig &a_WaveConfig);
 		void UnloadSound(const UAUDIO_DEFAULT_HASH hash);
 		WaveFile *FindSound(const UAUDIO_DEFAULT_HASH a_Hash);
 		bool DoesSoundExist(const UAUDIO_DEFAULT_HASH a_Hash) const;
 
+		// Loading in the background.
+		LoadHandle LoadSoundAsync(const char *a_Path, const char *a_Name, const WaveConfig &a_WaveConfig, LOAD_PRIORITY a_Priority = LOAD_PRIORITY::LOAD_PRIORITY_NORMAL, LoadCallback a_Callback = nullptr, void *a_UserData = nullptr);
+		bool CancelLoad(LoadHandle a_LoadHandle);
+		LOAD_STATUS GetLoadStatus(LoadHandle a_LoadHandle) const;
+		UAUDIO_DEFAULT_HASH GetLoadHash(LoadHandle a_LoadHandle) const;
+		uint32_t LoadSize() const;
+		void WaitForLoads();
+		uint32_t Update();
+
+		// Loading a whole manifest at once.
+		BatchLoadReport LoadSounds(const std::vector<SoundManifestEntry, UAUDIO_DEFAULT_ALLOCATOR<SoundManifestEntry>> &a_Manifest, uint32_t a_NumThreads = UAUDIO_DEFAULT_BATCH_THREADS);
+
 		uint32_t SoundSize() const;
 		std::vector<WaveFile *, UAUDIO_DEFAULT_ALLOCATOR<WaveFile *>> GetSounds();
 		std::vector<UAUDIO_DEFAULT_HASH, UAUDIO_DEFAULT_ALLOCATOR<UAUDIO_DEFAULT_HASH>> GetSoundHashes();
 
 	private:
+		struct LoadJob
+		{
+			std::string path;
+			UAUDIO_DEFAULT_HASH hash = 0;
+			WaveConfig waveConfig;
+			LOAD_STATUS status = LOAD_STATUS::LOAD_STATUS_QUEUED;
+			bool cancelled = false;
+			LoadCallback callback = nullptr;
+			void *userData = nullptr;
+
+			// The sound, until Update moves it into the sounds.
+			WaveFile waveFile;
+		};
+
+		// A manifest that is being loaded, the threads only write the sounds and reports of their own entries.
+		struct BatchLoad
+		{
+			const std::vector<SoundManifestEntry, UAUDIO_DEFAULT_ALLOCATOR<SoundManifestEntry>> *manifest = nullptr;
+			std::vector<WaveFile, UAUDIO_DEFAULT_ALLOCATOR<WaveFile>> sounds;
+			BatchLoadReport *report = nullptr;
+			std::atomic<uint32_t> next{0};
+			uint32_t numThreads = 1;
+		};
+
+		void Run();
+		void StartThreads();
+		static void LoadBatch(BatchLoad &a_BatchLoad);
+
+		// Guards the sounds and everything below it, which is shared with the workers.
+		mutable std::mutex m_LoadMutex;
 		std::map<UAUDIO_DEFAULT_HASH, WaveFile> m_Sounds;
+
+		std::condition_variable m_LoadQueued;
+		std::condition_variable m_LoadFinished;
+
+		// The loads by handle (until Update is done with them).
+		std::map<int32_t, LoadJob> m_Loads;
+		int32_t m_NextLoad = 0;
+
+		// The queued loads, one queue per priority.
+		std::array<std::deque<int32_t>, 3> m_Queues;
+
+		// The loads that are done (or failed, or got cancelled) and wait for Update.
+		std::vector<int32_t, UAUDIO_DEFAULT_ALLOCATOR<int32_t>> m_Finished;
+		uint32_t m_NumBusy = 0;
+
+		uint32_t m_NumThreads = UAUDIO_DEFAULT_LOAD_THREADS;
+		bool m_Running = false;
+		std::vector<std::thread, UAUDIO_DEFAULT_ALLOCATOR<std::thread>> m_Threads;
 	};
 }
\ No newline at end of file
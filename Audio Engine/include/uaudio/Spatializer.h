@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <uaudio/Handle.h>
+#include <uaudio/Includes.h>
+
+namespace uaudio
+{
+#if !defined(UAUDIO_DEFAULT_NUM_EMITTERS)
+
+	#define UAUDIO_DEFAULT_NUM_EMITTERS 4096
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_SPEED_OF_SOUND)
+
+	#define UAUDIO_DEFAULT_SPEED_OF_SOUND 343.0f
+
+#endif
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the 3D spatializer. It holds one listener and a set of emitters, and turns their positions into a volume, a panning and a pitch per emitter.
+	 * Channels that have an emitter (see XAudio2Channel::SetEmitter) use the speaker volumes for the output matrix of their source voice and the pitch as frequency ratio.
+	 *
+		* Emitters are stored as structure of arrays and Update processes all of them in one batch (4 at a time when SSE2 is available).
+		* All memory is allocated in the constructor, emitters do not move and the results can be read while the game updates the positions.
+		* Positions are in meters and velocities in meters per second. The coordinate system is left-handed (x is right, y is up, z is forward).
+		* Attenuation: none, inverse (min / (min + rolloff * (distance - min))), linear (from min to max) and exponential ((distance / min) ^ -rolloff).
+		* Cones: full inner volume inside the inner angle, outer volume outside the outer angle and linear in between.
+		* Doppler: (speed of sound + listener speed) / (speed of sound + emitter speed), both along the line from the listener to the emitter.
+	 */
+	struct Vector3
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Listener
+	{
+		Vector3 position;
+		Vector3 velocity;
+		Vector3 forward = {0.0f, 0.0f, 1.0f};
+		Vector3 up = {0.0f, 1.0f, 0.0f};
+	};
+
+	class Spatializer
+	{
+	public:
+		Spatializer(uint32_t a_MaxEmitters = UAUDIO_DEFAULT_NUM_EMITTERS);
+
+		void SetListener(const Listener &a_Listener);
+		const Listener &GetListener() const;
+
+		void SetSpeedOfSound(float a_SpeedOfSound);
+		float GetSpeedOfSound() const;
+
+		void SetDopplerFactor(float a_DopplerFactor);
+		float GetDopplerFactor() const;
+
+		// Emitter-related methods.
+		EmitterHandle AddEmitter();
+		void RemoveEmitter(EmitterHandle a_EmitterHandle);
+		uint32_t EmitterSize() const;
+
+		void SetEmitterPosition(EmitterHandle a_EmitterHandle, const Vector3 &a_Position);
+		void SetEmitterVelocity(EmitterHandle a_EmitterHandle, const Vector3 &a_Velocity);
+		void SetEmitterDirection(EmitterHandle a_EmitterHandle, const Vector3 &a_Direction);
+		void SetEmitterCone(EmitterHandle a_EmitterHandle, float a_InnerAngle, float a_OuterAngle, float a_OuterVolume);
+		void SetEmitterAttenuation(EmitterHandle a_EmitterHandle, ATTENUATION_CURVE a_Curve, float a_MinDistance, float a_MaxDistance, float a_Rolloff = 1.0f);
+
+		void Update();
+
+		// Results of the last update.
+		float GetVolume(EmitterHandle a_EmitterHandle) const;
+		float GetPanning(EmitterHandle a_EmitterHandle) const;
+		float GetPitch(EmitterHandle a_EmitterHandle) const;
+		void GetSpeakerVolumes(EmitterHandle a_EmitterHandle, uint16_t a_NumSpeakers, float *a_Volumes) const;
+
+	private:
+		void ResetEmitter(uint32_t a_Index);
+		void UpdateEmitters(uint32_t a_Begin, uint32_t a_End);
+		bool IsValid(EmitterHandle a_EmitterHandle) const;
+
+		using FloatArray = std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>>;
+
+		Listener m_Listener;
+		Vector3 m_Right = {1.0f, 0.0f, 0.0f};
+		float m_SpeedOfSound = UAUDIO_DEFAULT_SPEED_OF_SOUND;
+		float m_DopplerFactor = 1.0f;
+
+		uint32_t m_MaxEmitters = 0;
+
+		// The amount of slots that have been used (removed emitters leave a hole that gets reused).
+		uint32_t m_NumEmitters = 0;
+		std::vector<uint32_t, UAUDIO_DEFAULT_ALLOCATOR<uint32_t>> m_FreeEmitters;
+
+		// Emitter settings.
+		FloatArray m_PositionX, m_PositionY, m_PositionZ;
+		FloatArray m_VelocityX, m_VelocityY, m_VelocityZ;
+		FloatArray m_DirectionX, m_DirectionY, m_DirectionZ;
+		FloatArray m_ConeOuterCos, m_ConeInverseRange, m_ConeOuterVolume;
+		FloatArray m_MinDistance, m_MaxDistance, m_InverseRange, m_Rolloff;
+		std::vector<int32_t, UAUDIO_DEFAULT_ALLOCATOR<int32_t>> m_Curve;
+
+		// 1 for emitters that are in use, 0 for holes.
+		FloatArray m_Enabled;
+
+		// Results.
+		FloatArray m_Volume, m_Panning, m_Front, m_Pitch;
+	};
+}
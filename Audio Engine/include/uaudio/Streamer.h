@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <uaudio/Handle.h>
+#include <uaudio/Includes.h>
+#include <uaudio/utils/FileReader.h>
+
+namespace uaudio
+{
+#if !defined(UAUDIO_DEFAULT_NUM_STREAMS)
+
+	// The amount of streams that can be open at the same time (a channel that plays a streamed sound uses one).
+	#define UAUDIO_DEFAULT_NUM_STREAMS 16
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_STREAM_BLOCK_SIZE)
+
+	// The amount of bytes that get read from the disk at once.
+	#define UAUDIO_DEFAULT_STREAM_BLOCK_SIZE 65536
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_STREAM_BLOCKS)
+
+	// The amount of blocks that every stream keeps ahead of the play cursor (3 is a triple buffer).
+	#define UAUDIO_DEFAULT_STREAM_BLOCKS 3
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_STREAMER_INTERVAL)
+
+	// How long the I/O thread waits between checks (in milliseconds), it also wakes up when a block gets played.
+	#define UAUDIO_DEFAULT_STREAMER_INTERVAL 5
+
+#endif
+
+	class WaveFile;
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the streamer. It plays sounds that were loaded with the stream setting of the config, those only keep their header chunks in memory (see WaveFormat::IsStreaming).
+	 *
+		* Every channel that plays a streamed sound opens a stream, with its own file and a ring of blocks (a triple buffer by default). A stream never holds more than the ring.
+		* An I/O thread fills the free blocks ahead of the play cursor. The channel reads from the blocks on the audio thread, which never touches the disk.
+		  The ring is lock-free (one writer, one reader). Opening a stream fills the ring before the I/O thread sees it, so playback starts without waiting.
+		* Looping happens on the I/O thread: after the end position the next block starts at the start position (forward only, the loops of the smpl chunk
+		  and the loop crossfade need the data in memory).
+		* Seeking (from any thread) only posts a request: a new generation and position in one atomic. The reader moves its cursor and skips the blocks of older
+		  generations when it sees the request, and the I/O thread reads from the new position when it sees it.
+		* When the reader wants more than the blocks have (the disk was too slow), it gets what there is and the stream counts an underrun.
+		* Closing only marks the stream, the I/O thread closes the file, so the audio thread does not wait on it.
+	 */
+	class Streamer
+	{
+	public:
+		Streamer(uint32_t a_MaxStreams = UAUDIO_DEFAULT_NUM_STREAMS, bool a_Threaded = true);
+		~Streamer();
+
+		Streamer(const Streamer &rhs) = delete;
+		Streamer &operator=(const Streamer &rhs) = delete;
+
+		StreamHandle Open(const WaveFile &a_WaveFile);
+		void Close(StreamHandle a_StreamHandle);
+		uint32_t StreamSize() const;
+
+		// The thread that plays the stream (Seek can be called from any thread).
+		uint32_t Read(StreamHandle a_StreamHandle, unsigned char *a_DataBuffer, uint32_t a_Size, uint32_t &a_Position);
+		void Seek(StreamHandle a_StreamHandle, uint32_t a_Position);
+		void SetLooping(StreamHandle a_StreamHandle, bool a_Looping);
+		bool IsFinished(StreamHandle a_StreamHandle) const;
+
+		uint32_t GetUnderruns(StreamHandle a_StreamHandle) const;
+		uint32_t GetUnderruns() const;
+
+		// The I/O thread (without a thread it needs to be called by the owner).
+		void Update();
+
+	private:
+		struct StreamBlock
+		{
+			// Where the block starts in the data and how many bytes it has.
+			uint32_t position = 0;
+			uint32_t size = 0;
+
+			// The seek that the block belongs to.
+			uint32_t generation = 0;
+
+			// Whether the sound ends after this block.
+			bool last = false;
+		};
+
+		struct Stream
+		{
+			std::atomic<uint32_t> state{0};
+			utils::FileReader file;
+
+			// Where the data chunk is in the file, and the part that gets played.
+			uint32_t dataOffset = 0;
+			uint32_t dataSize = 0;
+			uint32_t blockAlign = 1;
+			uint32_t blockSize = 0;
+			uint32_t startPosition = 0, endPosition = 0;
+			std::atomic<bool> looping{false};
+
+			// The last seek: the generation in the high 32 bits and the position in the low 32 bits (the reader and the I/O thread follow it).
+			std::atomic<uint64_t> seek{0};
+
+			// The I/O thread.
+			uint32_t fileGeneration = 0;
+			uint32_t filePosition = 0;
+			bool endOfData = false;
+
+			// The ring (in blocks since the stream was opened).
+			std::vector<unsigned char, UAUDIO_DEFAULT_ALLOCATOR<unsigned char>> data;
+			std::vector<StreamBlock, UAUDIO_DEFAULT_ALLOCATOR<StreamBlock>> blocks;
+			std::atomic<uint64_t> written{0};
+			std::atomic<uint64_t> read{0};
+
+			// The reader.
+			uint32_t readGeneration = 0;
+			uint32_t readOffset = 0;
+			uint32_t position = 0;
+			bool seeking = false;
+			std::atomic<bool> finished{false};
+			std::atomic<uint32_t> underruns{0};
+		};
+
+		void Run();
+		void Fill(Stream &a_Stream);
+		bool IsValid(StreamHandle a_StreamHandle) const;
+
+		std::vector<Stream, UAUDIO_DEFAULT_ALLOCATOR<Stream>> m_Streams;
+
+		// Opening streams can happen from any thread.
+		std::mutex m_OpenMutex;
+
+		bool m_Threaded = true;
+		std::atomic<bool> m_Running{false};
+		std::thread m_Thread;
+		std::mutex m_WaitMutex;
+		std::condition_variable m_Wait;
+	};
+}
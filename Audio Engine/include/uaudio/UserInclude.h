@@ -19,11 +19,17 @@ namespace uaudio
 	 */
 	// constexpr float UAUDIO_DEFAULT_VOLUME = 1.0f;
 	// constexpr float UAUDIO_DEFAULT_PANNING = 0.0f;
+	// constexpr float UAUDIO_DEFAULT_TEMPO = 1.0f;
 	/*
 	 * A higher or lower buffer size is also possible. You can change this here.
 	 */
 	// constexpr BUFFERSIZE UAUDIO_DEFAULT_BUFFERSIZE BUFFERSIZE::BUFFERSIZE_8192
 
+	/*
+	 * Dither that gets added when the bit depth goes down (conversion at load time and the channel output).
+	 */
+	// #define UAUDIO_DEFAULT_DITHER DITHER::DITHER_TPDF
+
 	/*
 	 * If you want to change the hash class and hashing method, you can override them here.
 	 */
@@ -41,7 +47,9 @@ namespace uaudio
 	 */
 	// #define UAUDIO_DEFAULT_CHUNKS "fmt ", "data"
 	// constexpr uint16_t UAUDIO_DEFAULT_CHANNELS = 2;
+	// constexpr uint32_t UAUDIO_DEFAULT_CHANNEL_MASK = 0x3F;
 	// constexpr uint16_t UAUDIO_DEFAULT_BITS_PER_SAMPLE = 16;
+	// constexpr uint32_t UAUDIO_DEFAULT_SAMPLE_RATE = 0;
 	// constexpr bool UAUDIO_DEFAULT_SET_LOOP_POINTS = LOOP_POINT_SETTING::LOOP_POINT_SETTING_BOTH;
 
 	/*
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace uaudio::utils
+{
+#if !defined(UAUDIO_DEFAULT_FLUSH_DENORMALS)
+
+	// Whether the threads of the engine flush denormals to zero.
+	#define UAUDIO_DEFAULT_FLUSH_DENORMALS true
+
+#endif
+
+	// A tiny signal that recursive filters add to their input, so their state never decays into denormals (-360 dB).
+	constexpr float DENORMAL_GUARD = 1e-18f;
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This turns off denormals (floats that are so small that they lose precision) on the thread that creates it.
+	 * The tails of filters that decay towards silence end up as denormals, and on x86 math with denormals is 10 to 100 times slower.
+	 *
+		* On x86 it sets flush to zero (denormal results become 0) and denormals are zero (denormal inputs count as 0) in the MXCSR register.
+		* On ARM64 it sets flush to zero in the FPCR register (which does both). On other platforms it does nothing.
+		* The old mode comes back when the guard gets destroyed, so it can also guard a call on a thread that the engine does not own.
+		* Every thread that the engine starts (the audio thread, the analyzer and the workers that resample or measure sounds) creates one.
+		* Recursive filters also add DENORMAL_GUARD to their input, so they stay fast on threads without a guard.
+	 */
+	class DenormalGuard
+	{
+	public:
+		DenormalGuard(bool a_Enabled = UAUDIO_DEFAULT_FLUSH_DENORMALS);
+		~DenormalGuard();
+
+		DenormalGuard(const DenormalGuard &) = delete;
+		DenormalGuard &operator=(const DenormalGuard &) = delete;
+
+		static bool IsFlushing();
+
+	private:
+		bool m_Enabled = false;
+		uint64_t m_Mode = 0;
+	};
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace uaudio::utils
+{
+	// The most buffers that one scattered read fills (the rest goes in the next read).
+	constexpr uint32_t FILE_READER_MAX_BUFFERS = 64;
+
+	// A part of a scattered read, the buffers get filled in order from consecutive parts of the file.
+	struct FileBuffer
+	{
+		void *data = nullptr;
+		size_t size = 0;
+	};
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This reads a file at offsets (pread/preadv on POSIX, ReadFile with an offset on Windows), without a file position or a stdio buffer in between.
+	 *
+		* Every read is one system call at the offset that is asked for, so there are no seeks and nothing gets read twice.
+		* A scattered read fills multiple buffers from one range of the file with one call (preadv), such as the chunks of a wave file with the
+		  (small) chunks in between them going into a scratch buffer. On Windows every buffer is its own ReadFile.
+		* It counts its system calls (open, size, reads and close), so the loaders can be checked for how many they need.
+	 */
+	class FileReader
+	{
+	public:
+		FileReader() = default;
+		~FileReader();
+
+		FileReader(const FileReader &) = delete;
+		FileReader &operator=(const FileReader &) = delete;
+
+		bool Open(const char *a_FilePath);
+		void Close();
+
+		bool IsOpen() const;
+		uint64_t GetSize() const;
+		uint32_t GetNumCalls() const;
+
+		size_t Read(uint64_t a_Offset, void *a_Data, size_t a_Size);
+		size_t ReadScattered(uint64_t a_Offset, const FileBuffer *a_Buffers, uint32_t a_NumBuffers);
+
+	private:
+		uint64_t m_Size = 0;
+		uint32_t m_NumCalls = 0;
+
+#if defined(_WIN32)
+		void *m_File = nullptr;
+#else
+		int m_File = -1;
+#endif
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace uaudio::utils
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This maps a file into memory (mmap on POSIX, a file mapping on Windows), so the chunks of a wave file can be read where they are.
+	 *
+		* Nothing gets read when the file is mapped. The pages get read from the disk the first time they are touched.
+		* The mapping is private (copy on write): the pages that are not written to come from the page cache, so every process that maps the file shares them.
+		  A page that gets written to (a conversion that changes a chunk in place) becomes a copy of this process only, the file never changes.
+		* Prefetch tells the system that a range is about to be read (madvise WILLNEED, PrefetchVirtualMemory), so the reads happen before the audio thread gets there.
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		bool Open(const char *a_FilePath);
+		void Close();
+
+		bool IsOpen() const;
+		unsigned char *GetData() const;
+		size_t GetSize() const;
+		bool Contains(const void *a_Pointer) const;
+
+		void Prefetch(size_t a_Offset, size_t a_Size) const;
+
+	private:
+		unsigned char *m_Data = nullptr;
+		size_t m_Size = 0;
+
+#if defined(_WIN32)
+		void *m_File = nullptr;
+		void *m_Mapping = nullptr;
+#endif
+	};
+}
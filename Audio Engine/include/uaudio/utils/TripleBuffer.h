@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace uaudio::utils
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is a lock-free triple buffer, one thread writes values and one other thread reads the latest one.
+	 *
+		* The writer fills the back buffer and publishes it by swapping it with the middle buffer.
+		* The reader swaps the middle buffer with its front buffer when something new was published and reads the front buffer.
+		* Neither side ever waits. The reader always gets a whole value (never half of an old and half of a new one), values in between get skipped.
+		* Copying is not thread-safe, it is meant for moving the owner around before the threads use it.
+	 */
+	template <class T>
+	class TripleBuffer
+	{
+	public:
+		TripleBuffer() = default;
+
+		TripleBuffer(const TripleBuffer &rhs)
+		{
+			operator=(rhs);
+		}
+
+		TripleBuffer &operator=(const TripleBuffer &rhs)
+		{
+			if (this != &rhs)
+			{
+				for (uint32_t i = 0; i < 3; i++)
+					m_Buffers[i] = rhs.m_Buffers[i];
+				m_Middle.store(rhs.m_Middle.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				m_Back = rhs.m_Back;
+				m_Front = rhs.m_Front;
+			}
+			return *this;
+		}
+
+		/// <summary>
+		/// Returns the buffer that the writer fills (only for the writer).
+		/// </summary>
+		/// <returns>The back buffer.</returns>
+		T &GetBack()
+		{
+			return m_Buffers[m_Back];
+		}
+
+		/// <summary>
+		/// Publishes the back buffer (only for the writer).
+		/// </summary>
+		void Publish()
+		{
+			const uint32_t middle = m_Middle.exchange(m_Back | NEW_BIT, std::memory_order_acq_rel);
+			m_Back = middle & INDEX_MASK;
+		}
+
+		/// <summary>
+		/// Publishes a value (only for the writer).
+		/// </summary>
+		/// <param name="a_Value">The value.</param>
+		void Write(const T &a_Value)
+		{
+			GetBack() = a_Value;
+			Publish();
+		}
+
+		/// <summary>
+		/// Returns the latest value that was published (only for the reader).
+		/// </summary>
+		/// <returns>The latest value.</returns>
+		const T &Read()
+		{
+			if (m_Middle.load(std::memory_order_relaxed) & NEW_BIT)
+			{
+				const uint32_t middle = m_Middle.exchange(m_Front, std::memory_order_acq_rel);
+				m_Front = middle & INDEX_MASK;
+			}
+			return m_Buffers[m_Front];
+		}
+
+	private:
+		// The middle index has a bit that says whether it was published after the last read.
+		static constexpr uint32_t NEW_BIT = 0x4;
+		static constexpr uint32_t INDEX_MASK = 0x3;
+
+		T m_Buffers[3] = {};
+		std::atomic<uint32_t> m_Middle{1};
+		uint32_t m_Back = 0;
+		uint32_t m_Front = 2;
+	};
+}
@@ -21,6 +21,14 @@ namespace uaudio::utils
 		return reinterpret_cast<unsigned char *>(ptr) + size;
 	}
 
+	// Packs a chunk id (4 characters) into a number, so chunk ids can be compared without a string compare.
+	inline uint32_t GetFourCC(const void* a_ChunkID)
+	{
+		uint32_t four_cc = 0;
+		memcpy(&four_cc, a_ChunkID, sizeof(four_cc));
+		return four_cc;
+	}
+
 	float PosToMilliseconds(uint32_t m_Pos, uint32_t a_ByteRate);
 	float PosToSeconds(uint32_t m_Pos, uint32_t a_ByteRate);
 	uint32_t SecondsToPos(float m_Seconds, uint32_t a_ByteRate);
@@ -136,6 +136,55 @@ namespace uaudio
 		uint16_t bitsPerSample = 0;
 	};
 
+	/*
+	** Files with more than 2 channels (or more than 16 bits per sample) usually have audio format 0xFFFE (WAVE_FORMAT_EXTENSIBLE).
+	** The fmt chunk is 40 bytes then, the first 16 bytes are the same as above and then:
+	**
+	** 2 bytes (short)				Extension size (22).
+	**
+	** 2 bytes (short)				Valid bits per sample.
+	**									The amount of bits that are actually used (a 20-bit sample is stored in 24 bits for example).
+	**
+	** 4 bytes (long)				Channel mask.
+	**									Which speaker every channel belongs to (see WAVE_SPEAKER_FRONT_LEFT and the others in Defines.h).
+	**									The channels in the data chunk are stored in the order of the bits, so 0x3F (5.1) means
+	**									front left, front right, front center, low frequency, back left and back right.
+	**
+	** 16 bytes (guid)				Sub format.
+	**									The first 2 bytes are the actual audio format (1 for pcm and 3 for float),
+	**									the rest is always 00 00 00 00 10 00 80 00 00 AA 00 38 9B 71.
+	**
+	*/
+	struct FMT_Extensible_Chunk
+	{
+		FMT_Extensible_Chunk(FMT_Extensible_Chunk *a_DataBuffer)
+		{
+			if (a_DataBuffer != nullptr)
+			{
+				audioFormat = a_DataBuffer->audioFormat;
+				numChannels = a_DataBuffer->numChannels;
+				sampleRate = a_DataBuffer->sampleRate;
+				byteRate = a_DataBuffer->byteRate;
+				blockAlign = a_DataBuffer->blockAlign;
+				bitsPerSample = a_DataBuffer->bitsPerSample;
+				extensionSize = a_DataBuffer->extensionSize;
+				validBitsPerSample = a_DataBuffer->validBitsPerSample;
+				channelMask = a_DataBuffer->channelMask;
+				UAUDIO_DEFAULT_MEMCPY(subFormat, a_DataBuffer->subFormat, sizeof(subFormat));
+			}
+		}
+		uint16_t audioFormat = 0;
+		uint16_t numChannels = 0;
+		uint32_t sampleRate = 0;
+		uint32_t byteRate = 0;
+		uint16_t blockAlign = 0;
+		uint16_t bitsPerSample = 0;
+		uint16_t extensionSize = 0;
+		uint16_t validBitsPerSample = 0;
+		uint32_t channelMask = 0;
+		unsigned char subFormat[16] = {};
+	};
+
 	/*
 	** The data chunk goes a little something like this: 8 (chunkid and chunksize) + ?
 	** The Wave Data Chunk contains the digital audio sample data which can be decoded using the
@@ -19,9 +19,22 @@ namespace uaudio
 
 #endif
 
+#if !defined(UAUDIO_DEFAULT_CHANNEL_MASK)
+
+	#define UAUDIO_DEFAULT_CHANNEL_MASK 0
+
+#endif
+
 #if !defined(UAUDIO_DEFAULT_BITS_PER_SAMPLE)
 
-	#define UAUDIO_DEFAULT_BITS_PER_SAMPLE WAVE_BITS_PER_SAMPLE_16
+	// Sounds keep their bits per sample (if the engine plays them).
+	#define UAUDIO_DEFAULT_BITS_PER_SAMPLE 0
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_SAMPLE_RATE)
+
+	#define UAUDIO_DEFAULT_SAMPLE_RATE 0
 
 #endif
 
@@ -29,6 +42,64 @@ namespace uaudio
 
 	#define UAUDIO_DEFAULT_SET_LOOP_POINTS LOOP_POINT_SETTING::LOOP_POINT_SETTING_BOTH
 
+#endif
+
+#if !defined(UAUDIO_DEFAULT_TRIM_SILENCE)
+
+	#define UAUDIO_DEFAULT_TRIM_SILENCE false
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_SILENCE_THRESHOLD)
+
+	// Samples below this level (in dB) count as silence.
+	#define UAUDIO_DEFAULT_SILENCE_THRESHOLD -60.0f
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_RELEASE_TRIMMED_MEMORY)
+
+	#define UAUDIO_DEFAULT_RELEASE_TRIMMED_MEMORY false
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_NORMALIZE)
+
+	#define UAUDIO_DEFAULT_NORMALIZE false
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_TARGET_LOUDNESS)
+
+	// The integrated loudness (in LUFS) that sounds get normalized to (EBU R128).
+	#define UAUDIO_DEFAULT_TARGET_LOUDNESS -23.0f
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_MAX_TRUE_PEAK)
+
+	// The normalization never raises the true peak of a sound above this (in dBTP).
+	#define UAUDIO_DEFAULT_MAX_TRUE_PEAK -1.0f
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_MEMORY_MAP)
+
+	#define UAUDIO_DEFAULT_MEMORY_MAP false
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_STREAM)
+
+	#define UAUDIO_DEFAULT_STREAM false
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_CONVERSION_THREADS)
+
+	// The amount of threads that the bit depth and channel conversions of one sound get split over (0 means one per core).
+	#define UAUDIO_DEFAULT_CONVERSION_THREADS 1
+
 #endif
 
 	/*
@@ -36,9 +107,22 @@ namespace uaudio
 	 * This wave config is used in the wave reader. It contains settings related to the wave loading.
 	 * Currently there are these settings:
 		* Which chunks to load (in a vector of const char*)
-		* How many channels the file should have (stereo or mono)
-		* How many bits per sample the file should have (16-bit, 24-bit, 32-bit)
+		* How many channels the file should have (mono, stereo, quad, 5.1, 7.1)
+		* Which speakers the channels belong to (0 means the default layout for the number of channels)
+		* How many bits per sample the file should have (8-bit, 16-bit, 24-bit, 32-bit, 0 means the original bits per sample is kept if the engine plays it)
+		* Which sample rate the file should have (0 means the original sample rate is kept)
+		* Which tempo the file should have (from 0.5 to 2, the pitch stays the same)
+		* Which dither gets used when the bits per sample go down
 		* If the file needs to load loop points and set them automatically.
+		* If the silence at the start and the end needs to be trimmed, below which level (in dB) a frame is silent
+		  and whether the trimmed frames get removed from memory (otherwise only the start and end positions skip them).
+		* If the loudness needs to be measured and normalized, to which loudness (in LUFS) and how high the true peak may go (in dBTP).
+		  The data does not change, the sound gets a gain that the channels apply along with the volume.
+		* If the file needs to be mapped into memory instead of read (the chunks point into the mapping and the pages get read when they are played).
+		  Chunks that get converted are allocated as usual, so it saves the most for sounds that are already in the format of the config.
+		* If the data needs to stay on the disk and get streamed while it plays (for long sounds, see Streamer.h).
+		  A streamed sound is played the way it is in the file, so it does not get converted, trimmed or normalized.
+		* Over how many threads the conversion of a long sound gets split (short sounds always use one).
 	 * Conversion will take place if a file does not have these settings present.
 	 */
 	struct WaveConfig
@@ -50,7 +134,20 @@ namespace uaudio
 
 		std::vector<const char *, UAUDIO_DEFAULT_ALLOCATOR<const char *>> chunksToLoad = {UAUDIO_DEFAULT_CHUNKS};
 		uint16_t numChannels = UAUDIO_DEFAULT_CHANNELS;
+		uint32_t channelMask = UAUDIO_DEFAULT_CHANNEL_MASK;
 		uint16_t bitsPerSample = UAUDIO_DEFAULT_BITS_PER_SAMPLE;
+		uint32_t sampleRate = UAUDIO_DEFAULT_SAMPLE_RATE;
+		float tempo = 1.0f;
+		DITHER dither = UAUDIO_DEFAULT_DITHER;
 		LOOP_POINT_SETTING setLoopPoints = UAUDIO_DEFAULT_SET_LOOP_POINTS;
+		bool trimSilence = UAUDIO_DEFAULT_TRIM_SILENCE;
+		float silenceThreshold = UAUDIO_DEFAULT_SILENCE_THRESHOLD;
+		bool releaseTrimmedMemory = UAUDIO_DEFAULT_RELEASE_TRIMMED_MEMORY;
+		bool normalize = UAUDIO_DEFAULT_NORMALIZE;
+		float targetLoudness = UAUDIO_DEFAULT_TARGET_LOUDNESS;
+		float maxTruePeak = UAUDIO_DEFAULT_MAX_TRUE_PEAK;
+		bool memoryMap = UAUDIO_DEFAULT_MEMORY_MAP;
+		bool stream = UAUDIO_DEFAULT_STREAM;
+		uint32_t conversionThreads = UAUDIO_DEFAULT_CONVERSION_THREADS;
 	};
 }
@@ -7,6 +7,7 @@
 
 #include <uaudio/wave/high_level/WaveConfig.h>
 #include <uaudio/wave/low_level/WaveFormat.h>
+#include <uaudio/wave/low_level/WaveLoudness.h>
 
 namespace uaudio
 {
@@ -16,8 +17,10 @@ namespace uaudio
         WaveFile();
         WaveFile(const char *a_FilePath, const WaveConfig &a_WaveConfig);
         WaveFile(const WaveFile &rhs);
+        WaveFile(WaveFile &&rhs) noexcept;
 
         WaveFile &operator=(const WaveFile &rhs);
+        WaveFile &operator=(WaveFile &&rhs) noexcept;
 
         ~WaveFile() = default;
 
@@ -37,16 +40,47 @@ namespace uaudio
         void SetStartPosition(uint32_t a_StartPosition);
         uint32_t GetStartPosition() const;
 
+        void SetNormalizationGain(float a_Gain);
+        float GetNormalizationGain() const;
+
+        bool HasLoudness() const;
+        const effects::LoudnessMeasurement &GetLoudness() const;
+
+        bool IsStreaming() const;
+
+        // Reads the pages of a mapped sound ahead (a hint for a sound that is about to play).
+        void Prefetch(uint32_t a_Size = UAUDIO_DEFAULT_PREFETCH_SIZE) const;
+
         const WaveFormat &GetWaveFormat() const;
 
+        // The fmt chunk and the data chunk from when loading finished (for the audio thread, without looking them up).
+        const FMT_Chunk &GetFmtChunk() const;
+        unsigned char *GetData() const;
+        uint32_t GetDataSize() const;
+
     protected:
+        void UpdateChunkCache();
+        void SetLoopPoints(LOOP_POINT_SETTING a_LoopPointSetting);
+        void TrimSilence(float a_Threshold, bool a_ReleaseMemory);
+        void Normalize(float a_TargetLoudness, float a_MaxTruePeak);
+
         bool m_Looping = false;
         float m_Volume = UAUDIO_DEFAULT_VOLUME;
 
+        // The gain that brings the sound to the loudness of the config (1 if it was not measured).
+        float m_NormalizationGain = 1.0f;
+        bool m_HasLoudness = false;
+        effects::LoudnessMeasurement m_Loudness;
+
         uint32_t m_EndPosition = 0, m_StartPosition = 0;
 
         FILE *m_File = nullptr;
 
         WaveFormat m_WaveFormat = {};
+
+        // The chunks that get used on every buffer, looked up once (see UpdateChunkCache).
+        FMT_Chunk m_FmtChunk = FMT_Chunk(nullptr);
+        unsigned char *m_Data = nullptr;
+        uint32_t m_DataSize = 0;
     };
 }
\ No newline at end of file
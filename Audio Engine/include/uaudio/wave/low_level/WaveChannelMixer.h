@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the channel mixer that converts audio data from one speaker layout to another (mono, stereo, quad, 5.1, 7.1 or any other channel mask).
+	 * Every target channel is a weighted sum of the source channels. The weights are stored in a matrix of [target channel][source channel],
+	 * which is the same layout that IXAudio2Voice::SetOutputMatrix uses.
+	 *
+		* Speakers that exist in both layouts are copied.
+		* Mono goes to the front center speaker, or to the front left and front right speaker at full volume (dual mono).
+		* Other speakers that do not exist in the target layout get folded into the nearest speakers with the ITU-R BS.775 coefficients (-3dB).
+		* The low frequency channel is left out of downmixes (like ITU-R BS.775 does).
+		* Downmixes get normalized so that a full scale signal on all channels cannot clip (stereo to mono is (left + right) / 2).
+		* The data gets converted in blocks of frames, every block is one matrix multiply (4 frames at a time when SSE is available).
+		* Every frame gets mixed on its own, so long data can be split into parts that are converted on their own threads.
+	 */
+	namespace conversion
+	{
+		uint32_t GetDefaultChannelMask(uint16_t a_NumChannels);
+		uint32_t GetChannelSpeaker(uint32_t a_ChannelMask, uint16_t a_Channel);
+
+		void CalculateMixMatrix(float *a_Matrix, uint32_t a_SourceMask, uint16_t a_SourceChannels, uint32_t a_TargetMask, uint16_t a_TargetChannels, bool a_Normalize = true);
+
+		uint32_t CalculateChannelConvertSize(uint32_t a_Size, uint16_t a_SourceChannels, uint16_t a_TargetChannels);
+		void ConvertChannels(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BitsPerSample, uint32_t a_SourceMask, uint16_t a_SourceChannels, uint32_t a_TargetMask, uint16_t a_TargetChannels, uint32_t a_NumThreads = 1);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the conversion plan that WaveFormat uses at load time. It puts the bit depth and the channel conversion of the config together,
+	 * so the data gets converted in one pass from the original data to the new data, without a full copy in between.
+	 *
+		* The plan works in blocks of frames that fit in the cache: a block gets read as floats, mixed to the new layout (see WaveChannelMixer.h)
+		  and written at the new bit depth (with dither when the bit depth goes down, see WaveDither.h). Steps that are not needed get skipped.
+		* Every sample format is supported (see SAMPLE_FORMAT). A plan that keeps the channels uses the conversion of the pair of sample formats
+		  (see ConvertSampleFormat), so 32-bit integers and 64-bit floats keep their precision.
+		* There is one allocation (the new data), so converting a sound takes the original data and the new data instead of a copy for every step.
+		* Long data gets split into parts of whole blocks that are converted on their own threads (see CONVERSION_MIN_PART_SAMPLES).
+		* The plan does not resample. Sample rate conversion and time stretching need the frames around every frame (across the blocks and the parts),
+		  so WaveFormat runs them as passes of their own after the plan, each with its own new data (see WaveResampler.h and WaveTimeStretch.h).
+		  A config that also changes the sample rate or the tempo goes through the data two or three times instead of once.
+	 */
+	namespace conversion
+	{
+		// The amount of frames that get converted at a time (8 channels of floats, twice, stay well inside the L1 cache).
+		constexpr uint32_t CONVERSION_PLAN_BLOCK_FRAMES = 256;
+
+		struct ConversionFormat
+		{
+			uint16_t bitsPerSample = WAVE_BITS_PER_SAMPLE_16;
+			uint16_t numChannels = WAVE_CHANNELS_STEREO;
+
+			// 0 means the default layout for the number of channels.
+			uint32_t channelMask = 0;
+
+			// WAV_FORMAT_PCM or WAV_FORMAT_IEEE_FLOAT, 0 means the format of the engine (32-bit and 64-bit samples are floats).
+			uint16_t audioFormat = 0;
+		};
+
+		class ConversionPlan
+		{
+		public:
+			bool Init(const ConversionFormat &a_Source, const ConversionFormat &a_Target, DITHER a_Dither = UAUDIO_DEFAULT_DITHER);
+
+			bool IsEmpty() const;
+			bool ConvertsBitsPerSample() const;
+			bool ConvertsChannels() const;
+
+			uint32_t CalculateSize(uint32_t a_Size) const;
+			void Convert(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads = 1) const;
+
+		private:
+			void ConvertPart(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t a_FirstFrame, uint32_t a_EndFrame) const;
+
+			ConversionFormat m_Source;
+			ConversionFormat m_Target;
+			SAMPLE_FORMAT m_SourceSampleFormat = SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN;
+			SAMPLE_FORMAT m_TargetSampleFormat = SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN;
+			DITHER m_Dither = UAUDIO_DEFAULT_DITHER;
+
+			bool m_ConvertBitsPerSample = false;
+			bool m_ConvertChannels = false;
+
+			// The mix matrix of [target channel][source channel] (see CalculateMixMatrix).
+			float m_Matrix[UAUDIO_MAX_SPEAKERS * UAUDIO_MAX_SPEAKERS] = {};
+		};
+	}
+}
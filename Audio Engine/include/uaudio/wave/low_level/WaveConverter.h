@@ -2,10 +2,33 @@
 
 #include <cstdint>
 
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+
 namespace uaudio
 {
+	/*
+	 * WHAT IS THIS FILE?
+	 * These are the conversions of pcm data between bit depths (at load time) and between mono and stereo.
+	 *
+		* ConvertSampleFormat converts between every pair of sample formats (8-bit unsigned, 16-bit, 24-bit and 32-bit integers, 32-bit and 64-bit floats).
+		  Every pair has its own instance of a template in a table, so the loop of a pair does not check the formats for every sample.
+		* Integers that go to fewer bits (and floats that go to 8-bit, 16-bit or 24-bit) get dithered, see WaveDither.h.
+		  The rest gets converted through doubles and rounded, so going to more bits (and back) does not lose anything.
+		* The ConvertXToY functions are the same conversions for the formats that the engine plays (32-bit means floats).
+	 */
 	namespace conversion
 	{
+		class Ditherer;
+
+		// A conversion from one sample format to another (see GetSampleConvertFunction).
+		using SampleConvertFunction = void (*)(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t a_NumSamples, Ditherer &a_Ditherer);
+
+		// Data that is shorter than this (in samples, about 5 seconds of 48kHz stereo) does not get split over threads when it gets converted.
+		constexpr uint32_t CONVERSION_MIN_PART_SAMPLES = 1 << 19;
+
+		uint32_t GetConversionParts(uint32_t a_NumSamples, uint32_t a_NumThreads);
+
 		uint32_t Calculate24To16Size(uint32_t a_Size);
 		uint32_t Calculate32To16Size(uint32_t a_Size);
 
@@ -18,12 +41,17 @@ namespace uaudio
 		uint32_t CalculateMonoToStereoSize(uint32_t a_Size);
 		uint32_t CalculateStereoToMonoSize(uint32_t a_Size);
 
+		uint32_t CalculateSampleFormatSize(uint32_t a_Size, SAMPLE_FORMAT a_OriginalSampleFormat, SAMPLE_FORMAT a_SampleFormat);
+		SampleConvertFunction GetSampleConvertFunction(SAMPLE_FORMAT a_OriginalSampleFormat, SAMPLE_FORMAT a_SampleFormat);
+		bool ConvertSampleFormat(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, SAMPLE_FORMAT a_OriginalSampleFormat, SAMPLE_FORMAT a_SampleFormat, DITHER a_Dither = UAUDIO_DEFAULT_DITHER, uint16_t a_NumChannels = WAVE_CHANNELS_STEREO, uint32_t a_NumThreads = 1);
 
-		void Convert24To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size);
-		void Convert32To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size);
+		void Convert24To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, DITHER a_Dither = UAUDIO_DEFAULT_DITHER, uint16_t a_NumChannels = WAVE_CHANNELS_STEREO, uint32_t a_NumThreads = 1);
+		void Convert32To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, DITHER a_Dither = UAUDIO_DEFAULT_DITHER, uint16_t a_NumChannels = WAVE_CHANNELS_STEREO, uint32_t a_NumThreads = 1);
+		void Convert24To32(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads = 1);
+		void Convert16To32(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads = 1);
+		void Convert16To24(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads = 1);
+		void Convert32To24(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, DITHER a_Dither = UAUDIO_DEFAULT_DITHER, uint16_t a_NumChannels = WAVE_CHANNELS_STEREO, uint32_t a_NumThreads = 1);
 		void ConvertMonoToStereo(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BlockAlign);
 		void ConvertStereoToMono(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BlockAlign);
-
-		void ConvertToSamples(float* a_OutSamples, unsigned char* a_DataBuffer, uint32_t a_SampleCount);
 	}
 }
\ No newline at end of file
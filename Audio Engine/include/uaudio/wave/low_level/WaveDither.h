@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <uaudio/Includes.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the last stage of everything that lowers the bit depth (conversion at load time and the gain stage of the channels).
+	 * Float samples get quantized to 8-bit, 16-bit or 24-bit with TPDF (triangular) dither of 1 LSB, so that the quantization error
+	 * becomes a constant noise floor instead of distortion that follows the signal (which is very audible on quiet tails).
+	 *
+		* The noise comes from a xorshift generator per thread, so nothing gets shared between threads.
+		* Noise shaping feeds the error back (per channel) and moves the noise to high frequencies where it is harder to hear.
+		* Plain TPDF dither is applied 4 samples at a time when SSE2 is available. Noise shaping depends on the previous sample, so that stays scalar.
+		* 32-bit and 64-bit floats get written as they are. 32-bit integers have more precision than the floats, so they get rounded.
+	 */
+	namespace conversion
+	{
+		class Ditherer
+		{
+		public:
+			void Init(DITHER a_Dither, uint16_t a_NumChannels);
+			void Reset();
+
+			DITHER GetDither() const;
+
+			void Quantize(unsigned char *a_DataBuffer, const float *a_Samples, uint32_t a_NumSamples, uint16_t a_BitsPerSample);
+			void Quantize(unsigned char *a_DataBuffer, const float *a_Samples, uint32_t a_NumSamples, SAMPLE_FORMAT a_SampleFormat);
+
+		private:
+			template <uint16_t BitsPerSample>
+			void QuantizeSamples(unsigned char *a_DataBuffer, const float *a_Samples, uint32_t a_NumSamples);
+
+			DITHER m_Dither = UAUDIO_DEFAULT_DITHER;
+			uint16_t m_NumChannels = 1;
+
+			// The channel of the next sample (buffers do not have to start at the first channel).
+			uint16_t m_Channel = 0;
+
+			// The last two errors of every channel (noise shaping).
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Errors;
+		};
+	}
+}
@@ -44,39 +44,52 @@ namespace uaudio
 		}
 
 		/// <summary>
-		/// Changes the volume of pcm data.
+		/// Returns the volume of the left and right channel for a panning amount.
 		/// </summary>
-		/// <param name="a_DataBuffer">The actual data.</param>
-		/// <param name="a_Size">The data size.</param>
 		/// <param name="a_Amount">The panning amount (-1 is fully left, 1 is fully right, 0 is middle).</param>
-		/// <param name="a_NumChannels">The number of channels (mono or stereo).</param>
-		/// <returns></returns>
-		template <class T>
-		inline void ChangePanning(unsigned char *&a_DataBuffer, uint32_t a_Size, float a_Amount, uint16_t a_NumChannels)
+		/// <param name="a_Left">The volume of the left channel.</param>
+		/// <param name="a_Right">The volume of the right channel.</param>
+		inline void GetPanningVolumes(float a_Amount, float &a_Left, float &a_Right)
 		{
-			if (a_NumChannels == 1)
-				return;
-
 			// Amount is a value from -1 to 1.
 			a_Amount = utils::clamp(a_Amount, UAUDIO_MIN_PANNING, UAUDIO_MAX_PANNING);
 
 			// Set the values to 1.0 as default.
-			float left = UAUDIO_MAX_VOLUME, right = UAUDIO_MAX_VOLUME;
+			a_Left = UAUDIO_MAX_VOLUME;
+			a_Right = UAUDIO_MAX_VOLUME;
 
 			// If the slider is more to the left.
 			if (a_Amount < 0)
 			{
-				right += a_Amount;
+				a_Right += a_Amount;
 				// Clamp the volume to 0.0 min and 1.0 max.
-				right = utils::clamp(right, UAUDIO_MIN_VOLUME, UAUDIO_MAX_VOLUME);
+				a_Right = utils::clamp(a_Right, UAUDIO_MIN_VOLUME, UAUDIO_MAX_VOLUME);
 			}
 			// If the slider is more to the right.
 			else if (a_Amount > 0)
 			{
-				left -= a_Amount;
+				a_Left -= a_Amount;
 				// Clamp the volume to 0.0 min and 1.0 max.
-				left = utils::clamp(left, UAUDIO_MIN_VOLUME, UAUDIO_MAX_VOLUME);
+				a_Left = utils::clamp(a_Left, UAUDIO_MIN_VOLUME, UAUDIO_MAX_VOLUME);
 			}
+		}
+
+		/// <summary>
+		/// Changes the volume of pcm data.
+		/// </summary>
+		/// <param name="a_DataBuffer">The actual data.</param>
+		/// <param name="a_Size">The data size.</param>
+		/// <param name="a_Amount">The panning amount (-1 is fully left, 1 is fully right, 0 is middle).</param>
+		/// <param name="a_NumChannels">The number of channels (mono or stereo).</param>
+		/// <returns></returns>
+		template <class T>
+		inline void ChangePanning(unsigned char *&a_DataBuffer, uint32_t a_Size, float a_Amount, uint16_t a_NumChannels)
+		{
+			if (a_NumChannels == 1)
+				return;
+
+			float left, right;
+			GetPanningVolumes(a_Amount, left, right);
 
 			T *array_16 = reinterpret_cast<T *>(a_DataBuffer);
 			for (uint32_t i = 0; i < (a_Size / sizeof(T)); i += a_NumChannels)
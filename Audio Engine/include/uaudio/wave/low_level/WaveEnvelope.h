@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the envelope of a channel, a volume that moves over time and gets evaluated every frame in the gain stage.
+	 * It does fades (to any level) and ADSR (attack, decay, sustain, release):
+	 *
+		* The attack goes from silence to full volume, the decay goes down to the sustain level, which holds until the release.
+		* The release goes to silence, after which the envelope is done (and the channel stops).
+		* Every stage can be linear, exponential (linear in dB, from -80dB) or equal power (sin/cos, for crossfades).
+		* Stages are counted in frames, so they end at the exact frame. The end of a stage is always the exact target level.
+		* A stage costs one add (linear) or one multiply (exponential) per frame, equal power rotates a sin/cos pair instead of calling sin.
+	 */
+	namespace effects
+	{
+		// The times are in milliseconds, the sustain level is a volume (0 to 1).
+		struct ADSR
+		{
+			float attack = 0.0f;
+			float decay = 0.0f;
+			float sustain = UAUDIO_MAX_VOLUME;
+			float release = 0.0f;
+			ENVELOPE_CURVE curve = ENVELOPE_CURVE::ENVELOPE_CURVE_LINEAR;
+		};
+
+		class Envelope
+		{
+		public:
+			void Init(uint32_t a_SampleRate);
+
+			void SetADSR(const ADSR &a_ADSR);
+			const ADSR &GetADSR() const;
+
+			void Trigger();
+			void Release();
+			void Release(float a_Milliseconds, ENVELOPE_CURVE a_Curve);
+			void Fade(float a_Level, float a_Milliseconds, ENVELOPE_CURVE a_Curve);
+
+			void SetLevel(float a_Level);
+			float GetLevel() const;
+
+			ENVELOPE_STAGE GetStage() const;
+			bool IsMoving() const;
+			bool IsDone() const;
+
+			float Next();
+
+		private:
+			void Begin(ENVELOPE_STAGE a_Stage, float a_Target, float a_Milliseconds, ENVELOPE_CURVE a_Curve);
+			void EndStage();
+
+			ADSR m_ADSR;
+			uint32_t m_SampleRate = WAVE_SAMPLE_RATE_44100;
+
+			ENVELOPE_STAGE m_Stage = ENVELOPE_STAGE::ENVELOPE_STAGE_SUSTAIN;
+			ENVELOPE_CURVE m_Curve = ENVELOPE_CURVE::ENVELOPE_CURVE_LINEAR;
+			float m_Level = UAUDIO_MAX_VOLUME;
+
+			// The stage: where it started, where it goes and how many frames are left.
+			float m_Start = UAUDIO_MAX_VOLUME;
+			float m_Target = UAUDIO_MAX_VOLUME;
+			uint32_t m_Remaining = 0;
+
+			// The change per frame (added when linear, multiplied when exponential).
+			float m_Step = 0.0f;
+
+			// The angle of an equal power stage (as a cos/sin pair) and the rotation per frame.
+			double m_Cos = 1.0, m_Sin = 0.0;
+			double m_RotationCos = 1.0, m_RotationSin = 0.0;
+		};
+
+		/// <summary>
+		/// Moves the envelope one frame and returns the volume of that frame.
+		/// </summary>
+		/// <returns>The volume.</returns>
+		inline float Envelope::Next()
+		{
+			if (m_Remaining == 0)
+				return m_Level;
+
+			switch (m_Curve)
+			{
+				case ENVELOPE_CURVE::ENVELOPE_CURVE_LINEAR:
+				{
+					m_Level += m_Step;
+					break;
+				}
+				case ENVELOPE_CURVE::ENVELOPE_CURVE_EXPONENTIAL:
+				{
+					m_Level *= m_Step;
+					break;
+				}
+				case ENVELOPE_CURVE::ENVELOPE_CURVE_EQUAL_POWER:
+				{
+					const double cos = m_Cos * m_RotationCos - m_Sin * m_RotationSin;
+					m_Sin = m_Sin * m_RotationCos + m_Cos * m_RotationSin;
+					m_Cos = cos;
+					m_Level = static_cast<float>(m_Start * m_Cos + m_Target * m_Sin);
+					break;
+				}
+			}
+
+			if (--m_Remaining == 0)
+				EndStage();
+			return m_Level;
+		}
+	}
+}
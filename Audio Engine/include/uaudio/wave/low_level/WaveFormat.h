@@ -1,19 +1,30 @@
 ﻿#pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <uaudio/wave/low_level/WaveReader.h>
 
 #include <uaudio/wave/low_level/WaveChunkData.h>
+#include <uaudio/wave/high_level/WaveChunks.h>
 
 #include <uaudio/Includes.h>
 
+#include <uaudio/utils/MappedFile.h>
 #include <uaudio/utils/Utils.h>
 
 namespace uaudio
 {
+#if !defined(UAUDIO_DEFAULT_PREFETCH_SIZE)
+
+	// The amount of bytes of a mapped sound that get read ahead when it is about to play (a second of 48kHz 16-bit stereo).
+	#define UAUDIO_DEFAULT_PREFETCH_SIZE 192000
+
+#endif
+
 	/*
 	 * WHAT IS THIS FILE?
 	 * This is the WaveFormat class, where all the chunks are stored along with the file name.
@@ -21,70 +32,115 @@ namespace uaudio
 	 * It has methods to retrieve specific chunks and can remove chunks as well.
 	 *
 	 * This class does not hold information such as volume, panning and pitch. It only stored the actual wave file information.
+	 *
+	 * A streamed sound (see WaveConfig::stream) has no data chunk in memory, only where it is in the file. The Streamer reads it from there.
+	 * A mapped sound (see WaveConfig::memoryMap) has chunks that point into the mapped file (the header of a chunk in a wave file looks like WaveChunkData).
+	 * Copies of the format share the mapping and its chunks, the mapping goes when the last copy does. Converted chunks get allocated as usual.
 	 */
 	class WaveFormat
 	{
 	public:
 		WaveFormat() = default;
 		WaveFormat(const WaveFormat &rhs);
+		WaveFormat(WaveFormat &&rhs) noexcept;
 
 		~WaveFormat();
 
 		WaveFormat &operator=(const WaveFormat &rhs);
+		WaveFormat &operator=(WaveFormat &&rhs) noexcept;
 
 		char *m_FilePath = nullptr;
 
 	private:
 		void SetFileName(const char *a_FilePath);
 		std::vector<WaveChunkData *, UAUDIO_DEFAULT_ALLOCATOR<WaveChunkData *>> m_Chunks;
+
+		// The ids of the chunks as numbers (see utils::GetFourCC), in the same order as the chunks. Looking up a chunk compares numbers in one small array.
+		std::vector<uint32_t, UAUDIO_DEFAULT_ALLOCATOR<uint32_t>> m_ChunkIds;
+		int32_t FindChunk(uint32_t a_ChunkID) const
+		{
+			for (size_t i = 0; i < m_ChunkIds.size(); i++)
+				if (m_ChunkIds[i] == a_ChunkID)
+					return static_cast<int32_t>(i);
+
+			return -1;
+		}
+
 		void ConfigConversion(WaveConfig &a_WaveConfig);
-		void BitsPerSampleConvert(WaveConfig &a_WaveConfig);
-		void MonoStereoConvert(WaveConfig &a_WaveConfig);
+		void FormatConvert(WaveConfig &a_WaveConfig);
+		void SampleRateConvert(WaveConfig &a_WaveConfig);
+		void TimeStretchConvert(WaveConfig &a_WaveConfig);
+		void ScalePositions(double a_Numerator, double a_Denominator);
+		void SetFormat(const FMT_Chunk &a_FmtChunk, uint32_t a_ChannelMask);
+
+		// The file that the chunks point into when the sound was mapped (shared with the copies of the format).
+		std::shared_ptr<utils::MappedFile> m_MappedFile;
+		void FreeChunk(WaveChunkData *a_WaveChunkData) const;
+
+		// Where the data chunk is in the file when the sound gets streamed.
+		bool m_Streaming = false;
+		uint32_t m_StreamOffset = 0;
+		uint32_t m_StreamSize = 0;
+
+		// The size of the file that the sound was loaded from.
+		uint32_t m_FileSize = 0;
 
 		friend class WaveReader;
 
 	public:
+		uint16_t GetAudioFormat() const;
+		uint32_t GetChannelMask() const;
+
+		bool IsStreaming() const;
+		bool IsMapped() const;
+		void Prefetch(uint32_t a_Position, uint32_t a_Size) const;
+		uint32_t GetStreamOffset() const;
+		uint32_t GetDataSize() const;
+		uint32_t GetFileSize() const;
+
+		bool FindAudibleRange(float a_Threshold, uint32_t &a_StartPosition, uint32_t &a_EndPosition) const;
+		void Trim(uint32_t a_StartPosition, uint32_t a_EndPosition);
+
 		void RemoveChunk(const char *a_ChunkID)
 		{
-			for (size_t i = 0; i < m_Chunks.size(); i++)
-				if (strncmp(&a_ChunkID[0], &reinterpret_cast<char *>(m_Chunks[i]->chunk_id)[0], CHUNK_ID_SIZE) == 0)
+			const uint32_t chunk_id = utils::GetFourCC(a_ChunkID);
+			for (size_t i = m_ChunkIds.size(); i > 0; i--)
+				if (m_ChunkIds[i - 1] == chunk_id)
 				{
-					UAUDIO_DEFAULT_FREE(m_Chunks[i]);
-					m_Chunks.erase(m_Chunks.begin() + i);
+					FreeChunk(m_Chunks[i - 1]);
+					m_Chunks.erase(m_Chunks.begin() + static_cast<std::ptrdiff_t>(i - 1));
+					m_ChunkIds.erase(m_ChunkIds.begin() + static_cast<std::ptrdiff_t>(i - 1));
 				}
 		}
 
 		void AddChunk(WaveChunkData *a_WaveChunkData)
 		{
 			m_Chunks.push_back(a_WaveChunkData);
+			m_ChunkIds.push_back(utils::GetFourCC(a_WaveChunkData->chunk_id));
 		}
 
 		uint32_t GetChunkSize(const char *a_ChunkID) const
 		{
-			for (auto *m_Chunk : m_Chunks)
-				if (strncmp(&a_ChunkID[0], &reinterpret_cast<char *>(m_Chunk->chunk_id)[0], CHUNK_ID_SIZE) == 0)
-					return m_Chunk->chunkSize;
+			const int32_t index = FindChunk(utils::GetFourCC(a_ChunkID));
+			return index < 0 ? 0 : m_Chunks[index]->chunkSize;
+		}
 
-			return 0;
+		unsigned char *GetChunkBuffer(const char *a_ChunkID) const
+		{
+			const int32_t index = FindChunk(utils::GetFourCC(a_ChunkID));
+			return index < 0 ? nullptr : reinterpret_cast<unsigned char *>(utils::add(m_Chunks[index], sizeof(WaveChunkData)));
 		}
 
 		template <class T>
 		T GetChunkFromData(const char *a_ChunkID) const
 		{
-			for (auto *m_Chunk : m_Chunks)
-				if (strncmp(&a_ChunkID[0], &reinterpret_cast<char *>(m_Chunk->chunk_id)[0], CHUNK_ID_SIZE) == 0)
-					return T(reinterpret_cast<T *>(utils::add(m_Chunk, sizeof(WaveChunkData))));
-
-			return T(nullptr);
+			const int32_t index = FindChunk(utils::GetFourCC(a_ChunkID));
+			return T(index < 0 ? nullptr : reinterpret_cast<T *>(utils::add(m_Chunks[index], sizeof(WaveChunkData))));
 		}
 
 		bool HasChunk(const char *a_ChunkID) const
 		{
-			for (auto *m_Chunk : m_Chunks)
-				if (strncmp(&a_ChunkID[0], &reinterpret_cast<char *>(m_Chunk->chunk_id)[0], CHUNK_ID_SIZE) == 0)
-					return true;
-
-			return false;
+			return FindChunk(utils::GetFourCC(a_ChunkID)) >= 0;
 		}
 	};
 }
\ No newline at end of file
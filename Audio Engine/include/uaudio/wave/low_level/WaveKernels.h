@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * These are the conversion kernels: the loops that all pcm conversion goes through (reading samples as floats, writing 16-bit samples,
+	 * duplicating mono to stereo and averaging stereo to mono). They have a scalar version and versions for SSE2, SSSE3, AVX2 and NEON.
+	 *
+		* The best version that the cpu has gets picked the first time the kernels are used (runtime dispatch), so the engine does not need
+		  to be compiled for a newer cpu than the one it runs on. The AVX2 versions get compiled for AVX2 on their own.
+		* Every version gives the same data as the scalar version (which is the same as ReadSample and WriteSample in WaveSamples.h).
+		* 8-bit samples get widened in registers, the scalar version reads them through the table of every 8-bit sample (see UINT8_SAMPLES).
+		* 24-bit samples get unpacked with a byte shuffle (SSSE3, AVX2) or a 3-way load (NEON). Floats get converted to 16-bit with rounding
+		  to the nearest even number and saturation.
+		* Stereo to mono is (left + right) / 2, rounded to the nearest even number like the channel mixer does.
+	 */
+	namespace conversion
+	{
+		struct ConversionKernels
+		{
+			SIMD_LEVEL simdLevel = SIMD_LEVEL::SIMD_LEVEL_SCALAR;
+
+			// Samples to floats (-1.0 to 1.0) and back.
+			void (*read8)(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples) = nullptr;
+			void (*read16)(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples) = nullptr;
+			void (*read24)(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples) = nullptr;
+			void (*write16)(unsigned char *a_Data, const float *a_Samples, uint32_t a_NumSamples) = nullptr;
+
+			// Channels (a_NumFrames frames of 16-bit or 32-bit samples, 32-bit samples are floats).
+			void (*monoToStereo16)(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames) = nullptr;
+			void (*monoToStereo32)(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames) = nullptr;
+			void (*stereoToMono16)(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames) = nullptr;
+			void (*stereoToMono32)(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames) = nullptr;
+		};
+
+		SIMD_LEVEL GetSimdLevel();
+		bool IsSimdLevelSupported(SIMD_LEVEL a_SimdLevel);
+
+		const ConversionKernels &GetConversionKernels();
+		const ConversionKernels &GetConversionKernels(SIMD_LEVEL a_SimdLevel);
+	}
+}
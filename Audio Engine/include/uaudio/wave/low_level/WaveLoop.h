@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+#include <uaudio/wave/high_level/WaveChunks.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * These are the helpers that read the data of a sound for playback, with the loop wrapped at the exact frame instead of at a buffer boundary.
+	 * They do not allocate, the data gets copied into a buffer that the caller owns.
+	 *
+		* When the read reaches the loop end, it continues at the loop start inside the same buffer.
+		* The loop seam can be crossfaded (equal power). The last frames before the loop end get mixed with the frames
+		  that lead up to the loop start, so the jump back lands on data that continues the crossfade.
+		  If there are not enough frames before the loop start, the tail gets mixed with the first frames of the loop and playback continues after them.
+		* Without looping the read stops at the end, so the last buffer of a sound is shorter.
+		* The loops of the smpl chunk play inside that range, one after the other:
+			* Forward loops jump back to the loop start, ping-pong loops change direction at both ends and reverse loops play backwards from the loop end.
+			* The play count is the amount of times the loop plays (0 means until the sound gets released, a sustain loop).
+			* The loop end is the last frame of the loop. The fraction gets added up every pass, every time it adds up to a whole frame the pass is one frame longer.
+			* Backwards reads copy the frames in reverse order (8, 4 or 2 frames at a time when SSE2 is available), so they are as fast as forward reads.
+	 */
+	namespace conversion
+	{
+		struct LoopSettings
+		{
+			// The loop (in bytes in the data chunk).
+			uint32_t start = 0;
+			uint32_t end = 0;
+
+			// The length of the crossfade over the loop seam (in frames, 0 means no crossfade).
+			uint32_t crossfade = 0;
+
+			bool looping = false;
+
+			// The loops of the smpl chunk (in frames).
+			const SMPL_Sample_Loop *sampleLoops = nullptr;
+			uint32_t numSampleLoops = 0;
+		};
+
+		// Where the read is in the loops of the smpl chunk (kept by the caller between reads).
+		struct LoopState
+		{
+			// The loop that plays next and the amount of times it has played.
+			uint32_t loop = 0;
+			uint32_t count = 0;
+
+			// The fractions of the loop end that have been added up.
+			uint32_t fraction = 0;
+
+			bool reverse = false;
+
+			// Ends the next sustain loop (a loop with a play count of 0).
+			bool released = false;
+		};
+
+		float GetEqualPowerVolume(float a_Position);
+
+		void ReverseFrames(unsigned char *a_DataBuffer, const unsigned char *a_Data, uint32_t a_NumFrames, uint32_t a_BlockAlign);
+
+		uint32_t ReadLooped(unsigned char *a_DataBuffer, uint32_t a_Size, const unsigned char *a_Data, uint32_t a_DataSize, uint32_t &a_Position, LoopState &a_State, const LoopSettings &a_Loop, uint16_t a_BitsPerSample, uint16_t a_NumChannels);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+#include <uaudio/wave/low_level/WaveMeter.h>
+
+namespace uaudio
+{
+#if !defined(UAUDIO_DEFAULT_LOUDNESS_THREADS)
+
+	// The amount of threads that measure a sound (0 means one per core).
+	#define UAUDIO_DEFAULT_LOUDNESS_THREADS 0
+
+#endif
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This measures the loudness of a whole sound (EBU R128 / ITU-R BS.1770), so sounds can be normalized when they get loaded.
+	 *
+		* The K-weighted energy of every 100ms block comes from the channel meter (see WaveMeter.h), so it is measured with the same vectorized filters.
+		* Integrated loudness: the 400ms blocks (every 100ms) that are louder than -70 LUFS, and then only the ones that are less than 10 LU below their average.
+		* Loudness range (EBU Tech 3342): the spread between the 10% and the 95% of the short-term loudness (3s), without the silence and without what is 20 LU below the average.
+		* True peak: the samples get oversampled 4 times with a polyphase filter (48 taps), the 4 phases of a sample are the lanes of a vector.
+		* Long sounds get split into parts that are measured on their own threads. Every part starts a block early, so the filters have settled when its own blocks start.
+		  The parts only fill in the energy of their blocks, the gating happens afterwards on all blocks, so the result does not depend on the amount of threads.
+	 */
+	namespace effects
+	{
+		struct LoudnessMeasurement
+		{
+			// In LUFS.
+			float integrated = METER_SILENCE;
+			float maxMomentary = METER_SILENCE;
+			float maxShortTerm = METER_SILENCE;
+
+			// In LU.
+			float range = 0.0f;
+
+			// In dBTP (minus infinity for silence).
+			float truePeak = -std::numeric_limits<float>::infinity();
+		};
+
+		LoudnessMeasurement MeasureLoudness(const unsigned char *a_Data, uint32_t a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, uint32_t a_ChannelMask, uint32_t a_SampleRate, uint32_t a_NumThreads = UAUDIO_DEFAULT_LOUDNESS_THREADS);
+		float GetNormalizationGain(const LoudnessMeasurement &a_Measurement, float a_TargetLoudness, float a_MaxTruePeak);
+	}
+}
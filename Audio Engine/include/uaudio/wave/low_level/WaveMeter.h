@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+#include <uaudio/utils/TripleBuffer.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the level meter of a channel. It measures the samples of the gain stage while they get mixed, so it does not need a pass of its own.
+	 *
+		* Peak (the highest sample) and RMS per channel, over blocks of 100ms.
+		* Loudness as in EBU R128 / ITU-R BS.1770: the samples go through the K-weighting filters (a high shelf and a high pass, both biquads).
+		  Momentary loudness is the last 400ms, short-term loudness the last 3s, in LUFS. The LFE does not count, surround channels count 1.41 times.
+		* The channels are the lanes of a vector, so one frame runs through the filters and the sums at once (4 channels at a time when SSE is available).
+		* The filters get a tiny signal on top of the samples, so they do not slow down with denormals when the channel goes silent (see Denormals.h).
+		* After every block the readings get published through a triple buffer, the UI reads them without locking or waiting on the audio thread.
+	 */
+	namespace effects
+	{
+		// The absolute gate of EBU R128, quieter loudness readings get clamped to it.
+		constexpr float METER_SILENCE = -70.0f;
+
+		// Readings are published every block, momentary loudness is 4 blocks and short-term loudness 30 blocks.
+		constexpr uint32_t METER_BLOCKS_PER_SECOND = 10;
+		constexpr uint32_t METER_MOMENTARY_BLOCKS = 4;
+		constexpr uint32_t METER_SHORT_TERM_BLOCKS = 30;
+
+		struct MeterReadings
+		{
+			uint16_t numChannels = 0;
+
+			// Per channel, over the last block (volumes, 0 to 1).
+			float peak[UAUDIO_MAX_SPEAKERS] = {};
+			float rms[UAUDIO_MAX_SPEAKERS] = {};
+
+			// In LUFS.
+			float momentary = METER_SILENCE;
+			float shortTerm = METER_SILENCE;
+
+			// The weighted mean square of the K-weighted samples of the last block (the loudness readings are made of these).
+			float energy = 0.0f;
+		};
+
+		void AddReadings(MeterReadings &a_Sum, const MeterReadings &a_Readings);
+		float GetDecibels(float a_Volume);
+		float GetLoudness(float a_MeanSquare);
+		float GetMeanSquare(float a_Loudness);
+
+		class Meter
+		{
+		public:
+			void Init(uint32_t a_SampleRate, uint16_t a_NumChannels, uint32_t a_ChannelMask);
+			void Reset();
+
+			bool Process(const float *a_Samples, uint32_t a_NumSamples);
+
+			const MeterReadings &GetLast() const;
+			MeterReadings Read();
+
+		private:
+			void ProcessFrames(const float *a_Samples, uint32_t a_NumFrames);
+			void EndBlock();
+
+			uint32_t m_SampleRate = WAVE_SAMPLE_RATE_44100;
+			uint16_t m_NumChannels = WAVE_CHANNELS_STEREO;
+
+			// The K-weighting filters (b0, b1, b2, a1, a2), the same for every channel.
+			float m_Shelf[5] = {};
+			float m_HighPass[5] = {};
+
+			// Per channel (a lane per channel, the lanes after the last channel stay 0).
+			alignas(16) float m_Weights[UAUDIO_MAX_SPEAKERS] = {};
+			alignas(16) float m_ShelfState[2][UAUDIO_MAX_SPEAKERS] = {};
+			alignas(16) float m_HighPassState[2][UAUDIO_MAX_SPEAKERS] = {};
+			alignas(16) float m_Peak[UAUDIO_MAX_SPEAKERS] = {};
+			alignas(16) float m_Square[UAUDIO_MAX_SPEAKERS] = {};
+			alignas(16) float m_Energy[UAUDIO_MAX_SPEAKERS] = {};
+
+			// A frame that was split over two calls.
+			alignas(16) float m_Frame[UAUDIO_MAX_SPEAKERS] = {};
+			uint16_t m_FrameChannel = 0;
+
+			// The frames in a block and the frames of the current block so far.
+			uint32_t m_BlockFrames = WAVE_SAMPLE_RATE_44100 / METER_BLOCKS_PER_SECOND;
+			uint32_t m_Frames = 0;
+
+			// The K-weighted energy of the last blocks (a ring).
+			float m_Blocks[METER_SHORT_TERM_BLOCKS] = {};
+			uint32_t m_Block = 0;
+
+			MeterReadings m_Last;
+			utils::TripleBuffer<MeterReadings> m_Readings;
+		};
+	}
+}
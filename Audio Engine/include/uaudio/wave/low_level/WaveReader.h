@@ -3,9 +3,24 @@
 #include <complex>
 
 #include <uaudio/wave/high_level/WaveConfig.h>
+#include <uaudio/wave/low_level/WaveLoudness.h>
 
 namespace uaudio
 {
+#if !defined(UAUDIO_DEFAULT_HEADER_READ_SIZE)
+
+	// The amount of bytes that get read at once while looking for the chunks (the start of the file, and after a chunk that is longer than that).
+	#define UAUDIO_DEFAULT_HEADER_READ_SIZE 65536
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_READ_GAP_SIZE)
+
+	// Chunks that get loaded and are less than this apart (in bytes) get read with one read, the bytes in between get thrown away.
+	#define UAUDIO_DEFAULT_READ_GAP_SIZE 16384
+
+#endif
+
     class WaveFormat;
 
     enum class WAVE_LOADING_STATUS
@@ -24,13 +39,23 @@ namespace uaudio
     /*
 	 * WHAT IS THIS FILE?
 	 * This is the wave reader. It is responsible for loading the chunks of a wave file and creating a WaveFormat.
-	 * It is also responsible for saving wave files.
+	 * It is also responsible for saving wave files (optionally with a loudness measurement in the bext chunk).
 	 * It uses the WaveConfig to determine which chunks need to be stored into memory.
+	 * With the memory map setting of the config the file gets mapped instead, and the chunks point into the mapping (see MappedFile.h).
+	 *
+	 * Otherwise the file gets read in one pass, at offsets (see FileReader.h):
+		* The start of the file gets read at once and the chunks get looked up in it. A chunk header that is not in it (after a long chunk) starts the next read.
+		* The parts of the chunks that were in those reads get copied. The rest of the chunks gets read at the end, chunks that are close together with one
+		  read (the data in between goes into a scratch buffer). A usual wave file (a few small chunks and then the data) takes two reads.
+		* The chunk ids get compared as 32-bit numbers.
      */
     class WaveReader
     {
     public:
         static WAVE_LOADING_STATUS LoadSound(const char* a_FilePath, WaveFormat& a_WaveFormat, FILE*& a_File, WaveConfig a_WaveConfig = WaveConfig());
-        static WAVE_SAVING_STATUS SaveSound(const char* a_FilePath, const WaveFormat& a_WaveFormat);
+        static WAVE_SAVING_STATUS SaveSound(const char* a_FilePath, const WaveFormat& a_WaveFormat, const effects::LoudnessMeasurement* a_Loudness = nullptr);
+
+    private:
+        static WAVE_LOADING_STATUS LoadMappedSound(const char* a_FilePath, WaveFormat& a_WaveFormat, WaveConfig& a_WaveConfig);
     };
 }
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <uaudio/Includes.h>
+
+namespace uaudio
+{
+#if !defined(UAUDIO_RESAMPLER_ZERO_CROSSINGS)
+
+	#define UAUDIO_RESAMPLER_ZERO_CROSSINGS 16
+
+#endif
+
+#if !defined(UAUDIO_RESAMPLER_MAX_PHASES)
+
+	#define UAUDIO_RESAMPLER_MAX_PHASES 1024
+
+#endif
+
+#if !defined(UAUDIO_RESAMPLER_THREAD_THRESHOLD)
+
+	#define UAUDIO_RESAMPLER_THREAD_THRESHOLD 1048576
+
+#endif
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the polyphase windowed-sinc resampler that is used for sample rate conversion.
+	 * The conversion ratio gets reduced to L/M (interpolation/decimation) and a kaiser windowed sinc filter
+	 * is split into L phases, so every output sample only needs one row of the table.
+	 *
+		* Ratios with more than UAUDIO_RESAMPLER_MAX_PHASES phases use a table of UAUDIO_RESAMPLER_MAX_PHASES phases and interpolate between rows.
+		* Filter tables are cached per ratio. The common ratios (44.1kHz, 48kHz and 96kHz) are built on first use.
+		* Files with more than UAUDIO_RESAMPLER_THREAD_THRESHOLD output frames get split over multiple threads.
+	 */
+	namespace conversion
+	{
+		struct PolyphaseFilter
+		{
+			uint32_t sourceRate = 0;
+			uint32_t targetRate = 0;
+
+			// The reduced ratio (targetRate / sourceRate = interpolation / decimation).
+			uint32_t interpolation = 1;
+			uint32_t decimation = 1;
+
+			// Whether every phase has its own row (otherwise rows get interpolated).
+			bool exact = true;
+
+			uint32_t numPhases = 1;
+			uint32_t numTaps = 0;
+			uint32_t halfTaps = 0;
+
+			// (numPhases + 1) rows of numTaps coefficients.
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> coefficients;
+
+			const float *GetPhase(uint32_t a_Phase) const
+			{
+				return coefficients.data() + static_cast<size_t>(a_Phase) * numTaps;
+			}
+		};
+
+		const PolyphaseFilter &GetPolyphaseFilter(uint32_t a_SourceRate, uint32_t a_TargetRate);
+
+		uint32_t CalculateResampleSize(uint32_t a_Size, uint16_t a_BlockAlign, uint32_t a_SourceRate, uint32_t a_TargetRate);
+		uint32_t ResamplePosition(uint32_t a_Position, uint32_t a_SourceRate, uint32_t a_TargetRate);
+
+		void Resample(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, uint32_t a_SourceRate, uint32_t a_TargetRate);
+
+		/*
+		 * This is the streaming version of the resampler, used by the channels to convert any sound to the sample rate of the audio system.
+		 * It uses the same filter tables as the load-time conversion, but keeps the filter history and the phase between periods.
+		 *
+			* All memory is allocated in Init. Process never allocates, so it is safe to use on the audio thread.
+			* Process converts at most a_MaxInputFrames (see Init) per step, larger buffers get processed in multiple steps.
+		 */
+		class StreamResampler
+		{
+		public:
+			void Init(uint32_t a_SourceRate, uint32_t a_TargetRate, uint16_t a_NumChannels, uint16_t a_BitsPerSample, uint32_t a_MaxInputFrames);
+			void Reset();
+
+			bool IsActive() const;
+			uint32_t GetMaxOutputSize(uint32_t a_Size) const;
+
+			uint32_t Process(const unsigned char *a_DataBuffer, uint32_t a_Size, unsigned char *a_OutDataBuffer);
+
+		private:
+			template <uint16_t BitsPerSample>
+			uint32_t ProcessFrames(const unsigned char *a_DataBuffer, uint32_t a_Frames, unsigned char *a_OutDataBuffer);
+			void Advance();
+
+			const PolyphaseFilter *m_Filter = nullptr;
+
+			uint16_t m_NumChannels = 0;
+			uint16_t m_BitsPerSample = 0;
+			uint32_t m_MaxInputFrames = 0;
+
+			// Interleaved float frames: the filter history followed by the frames of the current step.
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_History;
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_InterpolatedRow;
+			uint32_t m_HistoryFrames = 0;
+
+			// Position of the next output frame (frame in the history plus the phase).
+			uint32_t m_Frame = 0;
+			uint32_t m_Phase = 0;
+			double m_Fraction = 0.0;
+		};
+	}
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+
+#include <uaudio/utils/Utils.h>
+#include <uaudio/wave/low_level/WaveKernels.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * These are the helpers for reading and writing a single pcm sample as a normalized float (-1.0 to 1.0).
+	 * They are templated on the bits per sample so that the DSP code (resampling for example) can pick the
+	 * right version once per buffer instead of once per sample.
+	 *
+		* 8-bit samples are unsigned integers (128 is silence), 16-bit and 24-bit samples are signed integers (little endian).
+		  A single 8-bit sample gets read through a table of the 256 values (see UINT8_SAMPLES), a buffer goes through the kernels.
+		* 32-bit samples are IEEE floats (like the rest of the engine assumes).
+		* ReadFormatSample and WriteFormatSample work on every sample format (see SAMPLE_FORMAT), including 32-bit integers and 64-bit floats.
+		  They use doubles, so that conversions between the formats do not lose more than the target format loses.
+	 */
+	namespace conversion
+	{
+		constexpr float INT8_SCALE = 128.0f;
+		constexpr float INT16_SCALE = 32768.0f;
+		constexpr float INT24_SCALE = 8388608.0f;
+		constexpr double INT32_SCALE = 2147483648.0;
+
+		struct SampleTable8
+		{
+			float values[256] = {};
+		};
+
+		/// <summary>
+		/// Creates the table of every 8-bit sample as a float.
+		/// </summary>
+		/// <returns></returns>
+		constexpr SampleTable8 CreateSampleTable8()
+		{
+			SampleTable8 table;
+			for (int32_t i = 0; i < 256; i++)
+				table.values[i] = static_cast<float>(i - 128) / INT8_SCALE;
+			return table;
+		}
+
+		// Every 8-bit sample as a float, so reading 8-bit data is one lookup per sample.
+		inline constexpr SampleTable8 UINT8_SAMPLES = CreateSampleTable8();
+
+		template <uint16_t BitsPerSample>
+		inline float ReadSample(const unsigned char *a_Data);
+
+		template <uint16_t BitsPerSample>
+		inline void WriteSample(unsigned char *a_Data, float a_Value);
+
+		template <>
+		inline float ReadSample<WAVE_BITS_PER_SAMPLE_8>(const unsigned char *a_Data)
+		{
+			return UINT8_SAMPLES.values[a_Data[0]];
+		}
+
+		template <>
+		inline float ReadSample<WAVE_BITS_PER_SAMPLE_16>(const unsigned char *a_Data)
+		{
+			int16_t value = 0;
+			UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+			return static_cast<float>(value) / INT16_SCALE;
+		}
+
+		template <>
+		inline float ReadSample<WAVE_BITS_PER_SAMPLE_24>(const unsigned char *a_Data)
+		{
+			int32_t value = a_Data[0] | (a_Data[1] << 8) | (a_Data[2] << 16);
+
+			// Sign extend the 24th bit.
+			if (value & 0x800000)
+				value |= ~0xFFFFFF;
+			return static_cast<float>(value) / INT24_SCALE;
+		}
+
+		template <>
+		inline float ReadSample<WAVE_BITS_PER_SAMPLE_32>(const unsigned char *a_Data)
+		{
+			float value = 0.0f;
+			UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+			return value;
+		}
+
+		template <>
+		inline void WriteSample<WAVE_BITS_PER_SAMPLE_8>(unsigned char *a_Data, float a_Value)
+		{
+			a_Data[0] = static_cast<unsigned char>(utils::clamp<long>(std::lrint(a_Value * INT8_SCALE), -128, 127) + 128);
+		}
+
+		template <>
+		inline void WriteSample<WAVE_BITS_PER_SAMPLE_16>(unsigned char *a_Data, float a_Value)
+		{
+			const int16_t value = static_cast<int16_t>(utils::clamp<long>(std::lrint(a_Value * INT16_SCALE), INT16_MIN, INT16_MAX));
+			UAUDIO_DEFAULT_MEMCPY(a_Data, &value, sizeof(value));
+		}
+
+		template <>
+		inline void WriteSample<WAVE_BITS_PER_SAMPLE_24>(unsigned char *a_Data, float a_Value)
+		{
+			const int32_t value = static_cast<int32_t>(utils::clamp<long>(std::lrint(a_Value * INT24_SCALE), -8388608, 8388607));
+			a_Data[0] = static_cast<unsigned char>(value & 0xFF);
+			a_Data[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+			a_Data[2] = static_cast<unsigned char>((value >> 16) & 0xFF);
+		}
+
+		template <>
+		inline void WriteSample<WAVE_BITS_PER_SAMPLE_32>(unsigned char *a_Data, float a_Value)
+		{
+			UAUDIO_DEFAULT_MEMCPY(a_Data, &a_Value, sizeof(a_Value));
+		}
+
+		/// <summary>
+		/// Returns the sample format of pcm data.
+		/// </summary>
+		/// <param name="a_AudioFormat">The audio format (WAV_FORMAT_PCM or WAV_FORMAT_IEEE_FLOAT, 0 means pcm for 8-bit to 24-bit and floats for 32-bit and 64-bit, like the engine).</param>
+		/// <param name="a_BitsPerSample">The bits per sample.</param>
+		/// <returns>The sample format (SAMPLE_FORMAT_UNKNOWN for compressed data and other bit depths).</returns>
+		inline SAMPLE_FORMAT GetSampleFormat(uint16_t a_AudioFormat, uint16_t a_BitsPerSample)
+		{
+			const bool pcm = a_AudioFormat == WAV_FORMAT_PCM || (a_AudioFormat == 0 && a_BitsPerSample <= WAVE_BITS_PER_SAMPLE_24);
+			const bool ieee_float = a_AudioFormat == WAV_FORMAT_IEEE_FLOAT || (a_AudioFormat == 0 && a_BitsPerSample >= WAVE_BITS_PER_SAMPLE_32);
+			switch (a_BitsPerSample)
+			{
+				case WAVE_BITS_PER_SAMPLE_8:
+					return pcm ? SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8 : SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN;
+				case WAVE_BITS_PER_SAMPLE_16:
+					return pcm ? SAMPLE_FORMAT::SAMPLE_FORMAT_INT16 : SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN;
+				case WAVE_BITS_PER_SAMPLE_24:
+					return pcm ? SAMPLE_FORMAT::SAMPLE_FORMAT_INT24 : SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN;
+				case WAVE_BITS_PER_SAMPLE_32:
+					return pcm ? SAMPLE_FORMAT::SAMPLE_FORMAT_INT32 : (ieee_float ? SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32 : SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN);
+				case WAVE_BITS_PER_SAMPLE_64:
+					return ieee_float ? SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64 : SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN;
+				default:
+					return SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN;
+			}
+		}
+
+		/// <summary>
+		/// Returns the bits per sample of a sample format.
+		/// </summary>
+		/// <param name="a_SampleFormat">The sample format.</param>
+		/// <returns>The bits per sample (0 for SAMPLE_FORMAT_UNKNOWN).</returns>
+		constexpr uint16_t GetBitsPerSample(SAMPLE_FORMAT a_SampleFormat)
+		{
+			switch (a_SampleFormat)
+			{
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8:
+					return WAVE_BITS_PER_SAMPLE_8;
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_INT16:
+					return WAVE_BITS_PER_SAMPLE_16;
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_INT24:
+					return WAVE_BITS_PER_SAMPLE_24;
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_INT32:
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32:
+					return WAVE_BITS_PER_SAMPLE_32;
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64:
+					return WAVE_BITS_PER_SAMPLE_64;
+				default:
+					return 0;
+			}
+		}
+
+		/// <summary>
+		/// Returns the audio format of the fmt chunk for a sample format.
+		/// </summary>
+		/// <param name="a_SampleFormat">The sample format.</param>
+		/// <returns>WAV_FORMAT_IEEE_FLOAT for floats, WAV_FORMAT_PCM for integers.</returns>
+		constexpr uint16_t GetAudioFormat(SAMPLE_FORMAT a_SampleFormat)
+		{
+			return a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64 ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM;
+		}
+
+		/// <summary>
+		/// Returns whether the engine plays and processes a sample format (8-bit, 16-bit, 24-bit and 32-bit floats), the rest gets converted at load time.
+		/// </summary>
+		/// <param name="a_SampleFormat">The sample format.</param>
+		/// <returns></returns>
+		constexpr bool IsPlayableSampleFormat(SAMPLE_FORMAT a_SampleFormat)
+		{
+			return a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT16 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT24 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32;
+		}
+
+		template <SAMPLE_FORMAT Format>
+		inline double ReadFormatSample(const unsigned char *a_Data);
+
+		template <SAMPLE_FORMAT Format>
+		inline void WriteFormatSample(unsigned char *a_Data, double a_Value);
+
+		template <>
+		inline double ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8>(const unsigned char *a_Data)
+		{
+			return static_cast<double>(a_Data[0] - 128) / INT8_SCALE;
+		}
+
+		template <>
+		inline double ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT16>(const unsigned char *a_Data)
+		{
+			int16_t value = 0;
+			UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+			return static_cast<double>(value) / INT16_SCALE;
+		}
+
+		template <>
+		inline double ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT24>(const unsigned char *a_Data)
+		{
+			// The sample goes to the top 3 bytes, the shift back sign extends it.
+			const int32_t value = static_cast<int32_t>(static_cast<uint32_t>(a_Data[0] | (a_Data[1] << 8) | (a_Data[2] << 16)) << 8) >> 8;
+			return static_cast<double>(value) / INT24_SCALE;
+		}
+
+		template <>
+		inline double ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>(const unsigned char *a_Data)
+		{
+			int32_t value = 0;
+			UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+			return static_cast<double>(value) / INT32_SCALE;
+		}
+
+		template <>
+		inline double ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32>(const unsigned char *a_Data)
+		{
+			float value = 0.0f;
+			UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+			return value;
+		}
+
+		template <>
+		inline double ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(const unsigned char *a_Data)
+		{
+			double value = 0.0;
+			UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+			return value;
+		}
+
+		// Integer samples get clamped before they get rounded (to the nearest even number), so values that do not fit do not wrap around.
+
+		template <>
+		inline void WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8>(unsigned char *a_Data, double a_Value)
+		{
+			a_Data[0] = static_cast<unsigned char>(std::lrint(utils::clamp(a_Value * INT8_SCALE, -128.0, 127.0)) + 128);
+		}
+
+		template <>
+		inline void WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT16>(unsigned char *a_Data, double a_Value)
+		{
+			const int16_t value = static_cast<int16_t>(std::lrint(utils::clamp(a_Value * INT16_SCALE, -32768.0, 32767.0)));
+			UAUDIO_DEFAULT_MEMCPY(a_Data, &value, sizeof(value));
+		}
+
+		template <>
+		inline void WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT24>(unsigned char *a_Data, double a_Value)
+		{
+			const int32_t value = static_cast<int32_t>(std::lrint(utils::clamp(a_Value * INT24_SCALE, -8388608.0, 8388607.0)));
+			a_Data[0] = static_cast<unsigned char>(value & 0xFF);
+			a_Data[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+			a_Data[2] = static_cast<unsigned char>((value >> 16) & 0xFF);
+		}
+
+		template <>
+		inline void WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>(unsigned char *a_Data, double a_Value)
+		{
+			const int32_t value = static_cast<int32_t>(std::llrint(utils::clamp(a_Value * INT32_SCALE, -2147483648.0, 2147483647.0)));
+			UAUDIO_DEFAULT_MEMCPY(a_Data, &value, sizeof(value));
+		}
+
+		template <>
+		inline void WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32>(unsigned char *a_Data, double a_Value)
+		{
+			const float value = static_cast<float>(a_Value);
+			UAUDIO_DEFAULT_MEMCPY(a_Data, &value, sizeof(value));
+		}
+
+		template <>
+		inline void WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(unsigned char *a_Data, double a_Value)
+		{
+			UAUDIO_DEFAULT_MEMCPY(a_Data, &a_Value, sizeof(a_Value));
+		}
+
+		/// <summary>
+		/// Reads a buffer of pcm samples as floats.
+		/// </summary>
+		/// <param name="a_Samples">The samples.</param>
+		/// <param name="a_Data">The pcm data.</param>
+		/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		inline void ReadSamples(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples, uint16_t a_BitsPerSample)
+		{
+			switch (a_BitsPerSample)
+			{
+				case WAVE_BITS_PER_SAMPLE_8:
+				{
+					GetConversionKernels().read8(a_Samples, a_Data, a_NumSamples);
+					break;
+				}
+				case WAVE_BITS_PER_SAMPLE_16:
+				{
+					GetConversionKernels().read16(a_Samples, a_Data, a_NumSamples);
+					break;
+				}
+				case WAVE_BITS_PER_SAMPLE_24:
+				{
+					GetConversionKernels().read24(a_Samples, a_Data, a_NumSamples);
+					break;
+				}
+				case WAVE_BITS_PER_SAMPLE_32:
+				{
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						a_Samples[i] = ReadSample<WAVE_BITS_PER_SAMPLE_32>(a_Data + i * sizeof(float));
+					break;
+				}
+				default:
+					break;
+			}
+		}
+
+		/// <summary>
+		/// Reads a buffer of samples of any sample format as floats.
+		/// </summary>
+		/// <param name="a_Samples">The samples.</param>
+		/// <param name="a_Data">The pcm data.</param>
+		/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+		/// <param name="a_SampleFormat">The sample format.</param>
+		inline void ReadSamples(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples, SAMPLE_FORMAT a_SampleFormat)
+		{
+			switch (a_SampleFormat)
+			{
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_INT32:
+				{
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						a_Samples[i] = static_cast<float>(ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>(a_Data + i * sizeof(int32_t)));
+					break;
+				}
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64:
+				{
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						a_Samples[i] = static_cast<float>(ReadFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(a_Data + i * sizeof(double)));
+					break;
+				}
+				default:
+				{
+					ReadSamples(a_Samples, a_Data, a_NumSamples, GetBitsPerSample(a_SampleFormat));
+					break;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include <uaudio/Includes.h>
+#include <uaudio/Defines.h>
+
+namespace uaudio
+{
+	/*
+	 * WHAT IS THIS FILE?
+	 * These are the helpers that find the silence at the start and the end of a sound, so it can be trimmed at load or from a tool.
+	 *
+		* A frame is silent when every sample in it is quieter than the threshold (in dB, a full scale sample is 0 dB).
+		* The threshold gets converted to the sample format once, so the scan compares raw samples and never converts them to floats.
+		* The scan checks 8 samples at a time (with SSE2 when it is available) and only looks at single samples in the block where the sound starts or ends.
+		  The scan from the end stops at the first loud sample, so a sound with a short tail only reads that tail.
+		* 8-bit samples are unsigned integers (128 is silence), 16-bit and 24-bit samples are signed integers, 32-bit samples are floats (like the rest of the engine assumes).
+	 */
+	namespace conversion
+	{
+		bool FindAudibleFrames(const unsigned char *a_Data, uint32_t a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, float a_Threshold, uint32_t &a_FirstFrame, uint32_t &a_EndFrame);
+	}
+}
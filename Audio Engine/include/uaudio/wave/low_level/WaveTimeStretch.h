@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <uaudio/Includes.h>
+
+namespace uaudio
+{
+#if !defined(UAUDIO_TIMESTRETCH_FRAME_MS)
+
+	#define UAUDIO_TIMESTRETCH_FRAME_MS 20
+
+#endif
+
+#if !defined(UAUDIO_TIMESTRETCH_SEARCH_MS)
+
+	#define UAUDIO_TIMESTRETCH_SEARCH_MS 5
+
+#endif
+
+	/*
+	 * WHAT IS THIS FILE?
+	 * This is the WSOLA (waveform similarity overlap-add) time-stretcher. It changes the duration of pcm data without changing the pitch.
+	 * The input gets cut into hann windowed frames of UAUDIO_TIMESTRETCH_FRAME_MS that overlap by half. Frames are taken every (half a frame * tempo)
+	 * input frames and added every half a frame in the output, so a tempo of 2 plays twice as fast and a tempo of 0.5 twice as slow.
+	 *
+		* Every frame gets moved by at most UAUDIO_TIMESTRETCH_SEARCH_MS to the position that correlates best with the previous frame, so the waveforms line up.
+		* The tempo goes from UAUDIO_MIN_TEMPO to UAUDIO_MAX_TEMPO.
+		* TimeStretch is used for conversion at load time, StreamTimeStretch is used by the channels.
+	 */
+	namespace conversion
+	{
+		uint32_t CalculateTimeStretchSize(uint32_t a_Size, uint16_t a_BlockAlign, float a_Tempo);
+
+		void TimeStretch(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, uint32_t a_SampleRate, float a_Tempo);
+
+		/*
+		 * The streaming version of the time-stretcher. It keeps the input and the overlap of the last frame between periods.
+		 *
+			* All memory is allocated in Init. Process never allocates, so it is safe to use on the audio thread.
+			* The tempo can be changed at any time, the next frame will use the new tempo.
+		 */
+		class StreamTimeStretch
+		{
+		public:
+			void Init(uint32_t a_SampleRate, uint16_t a_NumChannels, uint16_t a_BitsPerSample, uint32_t a_MaxInputFrames);
+			void Reset();
+
+			void SetTempo(float a_Tempo);
+			float GetTempo() const;
+
+			bool IsActive() const;
+			uint32_t GetMaxOutputSize(uint32_t a_Size) const;
+
+			uint32_t Process(const unsigned char *a_DataBuffer, uint32_t a_Size, unsigned char *a_OutDataBuffer);
+
+		private:
+			template <uint16_t BitsPerSample>
+			uint32_t ProcessFrames(const unsigned char *a_DataBuffer, uint32_t a_Frames, unsigned char *a_OutDataBuffer);
+			int64_t FindBestPosition(int64_t a_Begin, int64_t a_End, int64_t a_Target) const;
+
+			uint16_t m_NumChannels = 0;
+			uint16_t m_BitsPerSample = 0;
+			uint32_t m_MaxInputFrames = 0;
+
+			// Frame length, overlap (half a frame) and the maximum distance a frame can move (all in frames).
+			uint32_t m_FrameLength = 0;
+			uint32_t m_OverlapLength = 0;
+			uint32_t m_SearchLength = 0;
+			uint32_t m_Capacity = 0;
+
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Window;
+
+			// Interleaved float frames and a mono mix of them (used for the correlation).
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Input;
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Mono;
+			uint32_t m_InputFrames = 0;
+
+			// Second half of the last frame, which gets added to the first half of the next frame.
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Overlap;
+
+			// Position of the next frame (without the search) and the position of the last frame (in the input).
+			double m_Position = 0.0;
+			int64_t m_Previous = 0;
+			bool m_HasPrevious = false;
+
+			// The output of the first half frame only contains the silence the input starts with.
+			uint32_t m_SkipFrames = 0;
+
+			float m_Tempo = 1.0f;
+			bool m_NeedsReset = false;
+		};
+	}
+}
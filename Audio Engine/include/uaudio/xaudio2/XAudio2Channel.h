@@ -1,14 +1,38 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <memory>
 #include <queue>
+#include <vector>
 #include <xaudio2.h>
 
 #include <uaudio/xaudio2/XAudio2Callback.h>
-
+#include <uaudio/wave/low_level/WaveDither.h>
+#include <uaudio/wave/low_level/WaveEnvelope.h>
+#include <uaudio/wave/low_level/WaveLoop.h>
+#include <uaudio/wave/low_level/WaveMeter.h>
+#include <uaudio/wave/low_level/WaveResampler.h>
+#include <uaudio/wave/low_level/WaveTimeStretch.h>
+
+#include <uaudio/Ducker.h>
+#include <uaudio/Handle.h>
 #include <uaudio/Includes.h>
 
 namespace uaudio
 {
+#if !defined(UAUDIO_DEFAULT_LOOP_CROSSFADE)
+
+	#define UAUDIO_DEFAULT_LOOP_CROSSFADE 0.0f
+
+#endif
+
+#if !defined(UAUDIO_DEFAULT_QUEUED_BUFFERS)
+
+	// The number of buffers that a channel keeps queued in its voice (the same for every sample format).
+	#define UAUDIO_DEFAULT_QUEUED_BUFFERS 4
+
+#endif
+
 	enum class TIMEUNIT
 	{
 		TIMEUNIT_MS,
@@ -27,10 +51,12 @@ namespace uaudio
 			XAudio2Channel() = default;
 			XAudio2Channel(AudioSystem &a_AudioSystem);
 			XAudio2Channel(const XAudio2Channel &rhs);
+			XAudio2Channel(XAudio2Channel &&rhs) noexcept;
 
 			~XAudio2Channel();
 
 			XAudio2Channel &operator=(const XAudio2Channel &rhs);
+			XAudio2Channel &operator=(XAudio2Channel &&rhs) noexcept;
 
 			void SetSound(const WaveFile &a_Sound);
 
@@ -38,6 +64,7 @@ namespace uaudio
 			bool GetActive() const;
 			void Play();
 			void Pause();
+			void Stop(bool a_Release = false);
 			void Update();
 			void SetPos(uint32_t a_StartPos);
 			float GetPos(TIMEUNIT a_TimeUnit) const;
@@ -56,24 +83,89 @@ namespace uaudio
 			void SetPanning(float a_Panning);
 			float GetPanning() const;
 
+			void SetTempo(float a_Tempo);
+			float GetTempo() const;
+
+			void SetEmitter(EmitterHandle a_EmitterHandle);
+			EmitterHandle GetEmitter() const;
+
+			// The bus of the channel (see Ducker).
+			void SetBus(uint32_t a_Bus);
+			uint32_t GetBus() const;
+
 			bool IsPlaying() const;
 			bool IsInUse() const;
 
 			bool IsLooping() const;
 			void SetLooping(bool a_Looping);
 
-			void ApplyEffects(unsigned char *&a_DataBuffer, uint32_t a_BufferSize) const;
+			// Sounds that stay on the disk play through a stream (see Streamer).
+			bool IsStreaming() const;
+			uint32_t GetStreamUnderruns() const;
+
+			void SetLoopCrossfade(float a_Milliseconds);
+			float GetLoopCrossfade() const;
+
+			// Ends the sustain loop of the smpl chunk (and releases the envelope).
+			void Release();
+
+			void SetADSR(const effects::ADSR &a_ADSR);
+			const effects::ADSR &GetADSR() const;
+			const effects::Envelope &GetEnvelope() const;
+
+			// Fades of the envelope (a channel that has faded out stops). They get posted to the audio thread, which applies them before the next buffer.
+			void FadeIn(float a_Milliseconds, ENVELOPE_CURVE a_Curve = ENVELOPE_CURVE::ENVELOPE_CURVE_EQUAL_POWER);
+			void FadeOut(float a_Milliseconds, ENVELOPE_CURVE a_Curve = ENVELOPE_CURVE::ENVELOPE_CURVE_EQUAL_POWER);
+			bool IsFading() const;
+
+			// Levels of the gain stage (see Meter). GetMeter is for the audio thread, ReadMeter for one other thread such as the UI.
+			const effects::Meter &GetMeter() const;
+			effects::MeterReadings ReadMeter();
+
+			void ApplyEffects(unsigned char *&a_DataBuffer, uint32_t a_BufferSize);
 
 			const WaveFile &GetSound() const;
 
 		private:
-			void Stop();
+			void ApplySpatialization();
+			void ResetOutputMatrix();
+			void PostEnvelopeCommand(uint64_t a_Command, float a_Milliseconds, ENVELOPE_CURVE a_Curve);
+			void ApplyEnvelopeCommands();
 			bool m_Looping = false;
 
 			std::queue<unsigned char *> m_DataBuffers;
 
 			float m_Volume = 1;
 			float m_Panning = UAUDIO_DEFAULT_PANNING;
+			float m_Tempo = UAUDIO_DEFAULT_TEMPO;
+
+			// The length of the crossfade over the loop seam.
+			float m_LoopCrossfade = UAUDIO_DEFAULT_LOOP_CROSSFADE;
+
+			// Fades and ADSR, evaluated every frame in the gain stage (only the audio thread touches it once the sound plays).
+			effects::Envelope m_Envelope;
+
+			// The ADSR of the channel, the envelope gets it with the next sound.
+			effects::ADSR m_ADSR;
+
+			// The last fade or release that the game thread posted (the newest one wins), whether the sustain loop got released
+			// and whether the envelope was moving at the last buffer.
+			std::atomic<uint64_t> m_EnvelopeCommand{0};
+			std::atomic<bool> m_LoopRelease{false};
+			std::atomic<bool> m_EnvelopeMoving{false};
+
+			// Peak, RMS and loudness of the samples after the gain stage.
+			effects::Meter m_Meter;
+
+			// The emitter that positions the channel (see Spatializer).
+			EmitterHandle m_Emitter;
+
+			// The stream that the data gets read from, for a sound that stays on the disk (the start, end and loop points are the ones from when it started).
+			StreamHandle m_Stream;
+
+			// The bus that the channel plays on and the ducking gain of the last buffer (the next buffer ramps from there).
+			uint32_t m_Bus = UAUDIO_DEFAULT_BUS;
+			float m_DuckGain = UAUDIO_MAX_VOLUME;
 
 			const WaveFile *m_CurrentSound = nullptr;
 
@@ -83,8 +175,27 @@ namespace uaudio
 
 			uint32_t m_CurrentPos = 0;
 
+			// Where the playback is in the loops of the smpl chunk.
+			conversion::LoopState m_LoopState;
+
+			// The data of the current buffer gets read (and looped) into this buffer, so the read path does not allocate.
+			std::vector<unsigned char, UAUDIO_DEFAULT_ALLOCATOR<unsigned char>> m_ReadBuffer;
+
+			// The time-stretched data goes into this buffer when it gets resampled afterwards (it does not get submitted itself).
+			std::vector<unsigned char, UAUDIO_DEFAULT_ALLOCATOR<unsigned char>> m_StretchBuffer;
+
+			// XAudio2 keeps a pointer to the callback of the voice, so it stays at the same address when the channel moves (and goes with the voice).
 			IXAudio2SourceVoice *m_SourceVoice = nullptr;
-			XAudio2Callback m_VoiceCallback;
+			std::unique_ptr<XAudio2Callback> m_VoiceCallback = std::make_unique<XAudio2Callback>();
+
+			// Converts the sound to the sample rate of the audio system (inactive if the rates match).
+			conversion::StreamResampler m_Resampler;
+
+			// Changes the tempo of the sound without changing the pitch (inactive if the tempo is 1).
+			conversion::StreamTimeStretch m_TimeStretch;
+
+			// Rounds the samples back to pcm after the effects (keeps the noise shaping state between buffers).
+			conversion::Ditherer m_Ditherer;
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include <uaudio/Analyzer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <uaudio/utils/Denormals.h>
+#include <uaudio/utils/Logger.h>
+#include <uaudio/utils/Utils.h>
+
+namespace uaudio
+{
+	constexpr double ANALYZER_PI = 3.14159265358979323846;
+
+	// The most frames that the channels can add to the ring in one update (resampled and stretched buffers are bigger than the buffer size).
+	constexpr uint32_t ANALYZER_MAX_UPDATE_FRAMES = 32768;
+
+	constexpr uint32_t ANALYZER_MIN_FFT_SIZE = 64;
+
+	/// <summary>
+	/// Allocates the ring and makes the FFT plan.
+	/// </summary>
+	/// <param name="a_FFTSize">The amount of frames per analysis (rounded up to a power of 2).</param>
+	Analyzer::Analyzer(uint32_t a_FFTSize)
+	{
+		m_FFTSize = ANALYZER_MIN_FFT_SIZE;
+		while (m_FFTSize < a_FFTSize)
+			m_FFTSize <<= 1;
+
+		// The ring holds the frames of the analysis and everything that can be written ahead of it.
+		uint32_t ring_size = 1;
+		while (ring_size < m_FFTSize * 2 + ANALYZER_MAX_UPDATE_FRAMES)
+			ring_size <<= 1;
+		m_Ring.resize(ring_size, 0.0f);
+		m_RingMask = ring_size - 1;
+
+		// Hann window.
+		m_Window.resize(m_FFTSize);
+		for (uint32_t i = 0; i < m_FFTSize; i++)
+			m_Window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * ANALYZER_PI * i / m_FFTSize));
+
+		// The plan: where every frame goes before the butterflies, and the rotations of the butterflies.
+		uint32_t num_bits = 0;
+		while ((1u << num_bits) < m_FFTSize)
+			num_bits++;
+		m_BitReverse.resize(m_FFTSize);
+		for (uint32_t i = 0; i < m_FFTSize; i++)
+		{
+			uint32_t reversed = 0;
+			for (uint32_t bit = 0; bit < num_bits; bit++)
+				reversed |= ((i >> bit) & 1u) << (num_bits - 1 - bit);
+			m_BitReverse[i] = reversed;
+		}
+		m_Twiddles.resize(m_FFTSize / 2);
+		for (uint32_t i = 0; i < m_FFTSize / 2; i++)
+			m_Twiddles[i] = std::polar(1.0f, static_cast<float>(-2.0 * ANALYZER_PI * i / m_FFTSize));
+		m_Bins.resize(m_FFTSize);
+
+		CalculateBands();
+	}
+
+	Analyzer::~Analyzer()
+	{
+		SetEnabled(false);
+	}
+
+	/// <summary>
+	/// Sets the sample rate of the bus (the sample rate of the audio system).
+	/// </summary>
+	/// <param name="a_SampleRate">The sample rate.</param>
+	void Analyzer::SetSampleRate(uint32_t a_SampleRate)
+	{
+		std::lock_guard<std::mutex> lock(m_BandMutex);
+		m_SampleRate = std::max(a_SampleRate, 1u);
+		CalculateBands();
+	}
+
+	/// <summary>
+	/// Returns the sample rate of the bus.
+	/// </summary>
+	/// <returns>The sample rate.</returns>
+	uint32_t Analyzer::GetSampleRate() const
+	{
+		return m_SampleRate;
+	}
+
+	/// <summary>
+	/// Returns the amount of frames per analysis.
+	/// </summary>
+	/// <returns>The FFT size.</returns>
+	uint32_t Analyzer::GetFFTSize() const
+	{
+		return m_FFTSize;
+	}
+
+	/// <summary>
+	/// Sets the bus that gets analyzed (UAUDIO_MASTER_BUS for all channels).
+	/// </summary>
+	/// <param name="a_Bus">The bus.</param>
+	void Analyzer::SetBus(uint32_t a_Bus)
+	{
+		m_Bus.store(std::min(a_Bus, UAUDIO_MASTER_BUS), std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Returns the bus that gets analyzed.
+	/// </summary>
+	/// <returns>The bus.</returns>
+	uint32_t Analyzer::GetBus() const
+	{
+		return m_Bus.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Sets the bands that the spectrum gets divided in.
+	/// </summary>
+	/// <param name="a_NumBands">The amount of bands.</param>
+	/// <param name="a_Spacing">Whether the bands are equally wide in Hz (linear) or in octaves (log).</param>
+	/// <param name="a_MinFrequency">The lowest frequency.</param>
+	/// <param name="a_MaxFrequency">The highest frequency (the Nyquist frequency at most).</param>
+	void Analyzer::SetBands(uint32_t a_NumBands, BAND_SPACING a_Spacing, float a_MinFrequency, float a_MaxFrequency)
+	{
+		std::lock_guard<std::mutex> lock(m_BandMutex);
+		m_NumBands = utils::clamp<uint32_t>(a_NumBands, 1, UAUDIO_MAX_BANDS);
+		m_Spacing = a_Spacing;
+		m_MinFrequency = std::max(a_MinFrequency, 1.0f);
+		m_MaxFrequency = std::max(a_MaxFrequency, m_MinFrequency);
+		CalculateBands();
+	}
+
+	/// <summary>
+	/// Returns the amount of bands.
+	/// </summary>
+	/// <returns>The amount of bands.</returns>
+	uint32_t Analyzer::GetNumBands() const
+	{
+		return m_NumBands;
+	}
+
+	/// <summary>
+	/// Returns the spacing of the bands.
+	/// </summary>
+	/// <returns>The spacing.</returns>
+	BAND_SPACING Analyzer::GetSpacing() const
+	{
+		return m_Spacing;
+	}
+
+	/// <summary>
+	/// Starts or stops the tap and the worker thread.
+	/// </summary>
+	/// <param name="a_Enabled">Whether the analyzer runs.</param>
+	void Analyzer::SetEnabled(bool a_Enabled)
+	{
+		if (a_Enabled == m_Enabled.load())
+			return;
+
+		m_Enabled = a_Enabled;
+		if (a_Enabled)
+			m_Thread = std::thread(&Analyzer::Run, this);
+		else if (m_Thread.joinable())
+			m_Thread.join();
+	}
+
+	/// <summary>
+	/// Returns whether the analyzer runs.
+	/// </summary>
+	/// <returns>Whether the analyzer runs.</returns>
+	bool Analyzer::IsEnabled() const
+	{
+		return m_Enabled.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Returns whether the channels on a bus need to write their samples.
+	/// </summary>
+	/// <param name="a_Bus">The bus of the channel.</param>
+	/// <returns>Whether the bus is tapped.</returns>
+	bool Analyzer::IsTapped(uint32_t a_Bus) const
+	{
+		if (!m_Enabled.load(std::memory_order_relaxed))
+			return false;
+		const uint32_t bus = m_Bus.load(std::memory_order_relaxed);
+		return bus == UAUDIO_MASTER_BUS || bus == a_Bus;
+	}
+
+	/// <summary>
+	/// Adds the samples of a channel to the ring (mono, from the position of the current update).
+	/// </summary>
+	/// <param name="a_Samples">The samples.</param>
+	/// <param name="a_NumSamples">The amount of samples.</param>
+	/// <param name="a_FirstSample">Where the samples are in the buffer of the channel.</param>
+	/// <param name="a_NumChannels">The amount of channels of the channel.</param>
+	void Analyzer::Write(const float *a_Samples, uint32_t a_NumSamples, uint32_t a_FirstSample, uint16_t a_NumChannels)
+	{
+		if (a_NumChannels == 0)
+			return;
+
+		const uint64_t start = m_Written.load(std::memory_order_relaxed);
+		const float scale = 1.0f / static_cast<float>(a_NumChannels);
+		uint32_t frame = a_FirstSample / a_NumChannels;
+		uint16_t channel = static_cast<uint16_t>(a_FirstSample % a_NumChannels);
+		for (uint32_t i = 0; i < a_NumSamples && frame < ANALYZER_MAX_UPDATE_FRAMES; i++)
+		{
+			// The frames after the last update get cleared before the first channel adds to them.
+			const uint64_t position = start + frame;
+			while (m_Cleared <= position)
+				m_Ring[m_Cleared++ & m_RingMask] = 0.0f;
+
+			m_Ring[position & m_RingMask] += a_Samples[i] * scale;
+			if (++channel == a_NumChannels)
+			{
+				channel = 0;
+				frame++;
+			}
+		}
+		m_UpdateFrames = std::max(m_UpdateFrames, std::min(frame + (channel != 0 ? 1 : 0), ANALYZER_MAX_UPDATE_FRAMES));
+	}
+
+	/// <summary>
+	/// Moves the write position past the frames of this update (called on the audio thread, after the channels).
+	/// </summary>
+	void Analyzer::Commit()
+	{
+		if (m_UpdateFrames == 0)
+			return;
+
+		m_Written.store(m_Written.load(std::memory_order_relaxed) + m_UpdateFrames, std::memory_order_release);
+		m_UpdateFrames = 0;
+	}
+
+	/// <summary>
+	/// Analyzes the latest frames and publishes the bands (called on the worker thread).
+	/// </summary>
+	/// <returns>Whether there was anything new to analyze.</returns>
+	bool Analyzer::Analyze()
+	{
+		const uint64_t written = m_Written.load(std::memory_order_acquire);
+		if (written == m_Analyzed || written < m_FFTSize)
+			return false;
+		m_Analyzed = written;
+
+		const uint64_t first = written - m_FFTSize;
+		for (uint32_t i = 0; i < m_FFTSize; i++)
+			m_Bins[m_BitReverse[i]] = std::complex<float>(m_Ring[(first + i) & m_RingMask] * m_Window[i], 0.0f);
+
+		// The audio thread writes ahead of the write position. If it moved on too far while copying, the frames may have been overwritten.
+		const uint64_t safe_frames = static_cast<uint64_t>(m_RingMask) + 1 - m_FFTSize - ANALYZER_MAX_UPDATE_FRAMES;
+		if (m_Written.load(std::memory_order_acquire) - written > safe_frames)
+			return false;
+
+		// Radix-2 butterflies, in place.
+		for (uint32_t size = 2; size <= m_FFTSize; size <<= 1)
+		{
+			const uint32_t half = size / 2;
+			const uint32_t step = m_FFTSize / size;
+			for (uint32_t start = 0; start < m_FFTSize; start += size)
+			{
+				for (uint32_t k = 0; k < half; k++)
+				{
+					const std::complex<float> a = m_Bins[start + k];
+					const std::complex<float> b = m_Bins[start + k + half] * m_Twiddles[k * step];
+					m_Bins[start + k] = a + b;
+					m_Bins[start + k + half] = a - b;
+				}
+			}
+		}
+
+		// A full scale sine is a bin of N / 4 (half the amplitude in the positive frequencies, half of that through the window).
+		const float scale = 4.0f / static_cast<float>(m_FFTSize);
+
+		std::lock_guard<std::mutex> lock(m_BandMutex);
+		SpectrumReadings &readings = m_Readings.GetBack();
+		readings.numBands = m_NumBands;
+		for (uint32_t band = 0; band < m_NumBands; band++)
+		{
+			float magnitude = 0.0f;
+			for (uint32_t bin = m_FirstBin[band]; bin <= m_LastBin[band]; bin++)
+				magnitude = std::max(magnitude, std::abs(m_Bins[bin]));
+			magnitude *= scale;
+
+			readings.frequencies[band] = m_Frequencies[band];
+			readings.bands[band] = magnitude > 0.0f ? std::max(20.0f * std::log10(magnitude), UAUDIO_ANALYZER_FLOOR) : UAUDIO_ANALYZER_FLOOR;
+		}
+		m_Readings.Publish();
+		return true;
+	}
+
+	/// <summary>
+	/// Returns the latest bands without waiting (for one thread, such as the UI).
+	/// </summary>
+	/// <returns>The bands.</returns>
+	SpectrumReadings Analyzer::Read()
+	{
+		return m_Readings.Read();
+	}
+
+	/// <summary>
+	/// The worker thread, analyzes the latest frames at a fixed rate.
+	/// </summary>
+	void Analyzer::Run()
+	{
+		utils::DenormalGuard denormal_guard;
+
+		const std::chrono::microseconds interval(1000000 / UAUDIO_DEFAULT_ANALYZER_RATE);
+		while (m_Enabled.load(std::memory_order_relaxed))
+		{
+			Analyze();
+			std::this_thread::sleep_for(interval);
+		}
+	}
+
+	/// <summary>
+	/// Calculates which bins belong to every band (the mutex is locked by the caller).
+	/// </summary>
+	void Analyzer::CalculateBands()
+	{
+		const float bin_width = static_cast<float>(m_SampleRate) / static_cast<float>(m_FFTSize);
+		const uint32_t last_bin = m_FFTSize / 2;
+		const float max_frequency = std::min(m_MaxFrequency, static_cast<float>(m_SampleRate) / 2.0f);
+		const float min_frequency = std::min(m_MinFrequency, max_frequency);
+
+		for (uint32_t band = 0; band < m_NumBands; band++)
+		{
+			const float from = static_cast<float>(band) / static_cast<float>(m_NumBands);
+			const float to = static_cast<float>(band + 1) / static_cast<float>(m_NumBands);
+
+			float low, high, center;
+			if (m_Spacing == BAND_SPACING::BAND_SPACING_LOG)
+			{
+				low = min_frequency * std::pow(max_frequency / min_frequency, from);
+				high = min_frequency * std::pow(max_frequency / min_frequency, to);
+				center = std::sqrt(low * high);
+			}
+			else
+			{
+				low = min_frequency + (max_frequency - min_frequency) * from;
+				high = min_frequency + (max_frequency - min_frequency) * to;
+				center = (low + high) / 2.0f;
+			}
+
+			// The bins from the low frequency up to (not including) the high frequency.
+			// Bands that are narrower than a bin (low log bands) use the bin of their center.
+			const uint32_t first_bin = static_cast<uint32_t>(std::ceil(low / bin_width));
+			const uint32_t end_bin = static_cast<uint32_t>(std::ceil(high / bin_width));
+			if (end_bin > first_bin)
+			{
+				m_FirstBin[band] = utils::clamp(first_bin, 1u, last_bin);
+				m_LastBin[band] = utils::clamp(end_bin - 1, 1u, last_bin);
+			}
+			else
+			{
+				m_FirstBin[band] = utils::clamp(static_cast<uint32_t>(std::lround(center / bin_width)), 1u, last_bin);
+				m_LastBin[band] = m_FirstBin[band];
+			}
+			m_Frequencies[band] = center;
+		}
+	}
+}
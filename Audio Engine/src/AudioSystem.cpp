@@ -1,10 +1,12 @@
 ﻿#include <uaudio/AudioSystem.h>
 
+#include <uaudio/utils/Denormals.h>
 #include <uaudio/utils/Logger.h>
 
 #include <xaudio2.h>
 
 #include <uaudio/SoundSystem.h>
+#include <uaudio/wave/low_level/WaveChannelMixer.h>
 #include <uaudio/wave/low_level/WaveEffects.h>
 
 namespace uaudio
@@ -34,12 +36,28 @@ namespace uaudio
 			logger::log_error("<XAudio2> Creating XAudio2 Mastering Voice failed.");
 			return;
 		}
+
+		XAUDIO2_VOICE_DETAILS details;
+		m_MasterVoice->GetVoiceDetails(&details);
+		m_SampleRate = details.InputSampleRate;
+		m_NumChannels = static_cast<uint16_t>(details.InputChannels);
+
+		// Which speakers the output has (the mix matrix of every channel gets calculated for this layout).
+		DWORD channel_mask = 0;
+		if (SUCCEEDED(m_MasterVoice->GetChannelMask(&channel_mask)) && channel_mask != 0)
+			m_ChannelMask = channel_mask;
+		else
+			m_ChannelMask = conversion::GetDefaultChannelMask(m_NumChannels);
+
+		// The channels get converted to the sample rate of the mastering voice, so that is the rate of every bus.
+		m_Analyzer.SetSampleRate(m_SampleRate);
 	}
 
 	AudioSystem::~AudioSystem()
 	{
 		m_Active = false;
 
+		m_Analyzer.SetEnabled(false);
 		m_Channels.clear();
 
 		m_MasterVoice->DestroyVoice();
@@ -53,6 +71,8 @@ namespace uaudio
 	/// </summary>
 	void AudioSystem::Update()
 	{
+		// The filters of the channels decay into denormals after a sound stops.
+		utils::DenormalGuard denormal_guard;
 		while (m_Active)
 			UpdateChannels();
 	}
@@ -69,6 +89,44 @@ namespace uaudio
 		if (m_Playback)
 			for (int32_t i = static_cast<int32_t>(ChannelSize() - 1); i > -1; i--)
 				m_Channels[i].Update();
+
+		// The samples that the channels added to the analyzer in this update are complete.
+		m_Analyzer.Commit();
+
+		// The ducker follows the peaks that the channels on the key bus reported while they made their buffers.
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		const float seconds = std::chrono::duration<float>(now - m_LastUpdate).count();
+		m_Ducker.Update(seconds);
+		m_LastUpdate = now;
+
+		// The meters of the channels publish a block every 100ms, the buses and the master follow at the same rate.
+		m_MeterTime += seconds;
+		if (m_Metering && m_MeterTime >= 1.0f / static_cast<float>(effects::METER_BLOCKS_PER_SECOND))
+		{
+			m_MeterTime = 0.0f;
+			UpdateMeters();
+		}
+	}
+
+	/// <summary>
+	/// Adds up the levels of the channels that are playing into the levels of their bus and the master.
+	/// </summary>
+	void AudioSystem::UpdateMeters()
+	{
+		std::array<effects::MeterReadings, UAUDIO_MAX_BUSES> buses;
+		effects::MeterReadings master;
+		for (const xaudio2::XAudio2Channel &channel : m_Channels)
+		{
+			if (!channel.IsPlaying())
+				continue;
+			const effects::MeterReadings &readings = channel.GetMeter().GetLast();
+			effects::AddReadings(buses[channel.GetBus()], readings);
+			effects::AddReadings(master, readings);
+		}
+
+		for (uint32_t i = 0; i < UAUDIO_MAX_BUSES; i++)
+			m_BusMeters[i].Write(buses[i]);
+		m_MasterMeter.Write(master);
 	}
 
 	/// <summary>
@@ -78,6 +136,9 @@ namespace uaudio
 	{
 		if (m_AudioMode != AUDIO_MODE::AUDIO_MODE_NORMAL)
 			return;
+
+		// The thread belongs to the game, so its mode only changes during the update.
+		utils::DenormalGuard denormal_guard;
 		UpdateChannels();
 	}
 
@@ -184,6 +245,126 @@ namespace uaudio
 		m_BufferSize = a_BufferSize;
 	}
 
+	/// <summary>
+	/// Returns the sample rate of the output.
+	/// </summary>
+	/// <returns>The sample rate of the mastering voice.</returns>
+	uint32_t AudioSystem::GetSampleRate() const
+	{
+		return m_SampleRate;
+	}
+
+	/// <summary>
+	/// Returns the number of speakers of the output.
+	/// </summary>
+	/// <returns>The number of channels of the mastering voice.</returns>
+	uint16_t AudioSystem::GetNumChannels() const
+	{
+		return m_NumChannels;
+	}
+
+	/// <summary>
+	/// Returns which speakers the output has.
+	/// </summary>
+	/// <returns>The channel mask of the mastering voice.</returns>
+	uint32_t AudioSystem::GetChannelMask() const
+	{
+		return m_ChannelMask;
+	}
+
+	/// <summary>
+	/// Returns the spatializer (listener and emitters).
+	/// </summary>
+	/// <returns>The spatializer.</returns>
+	Spatializer &AudioSystem::GetSpatializer()
+	{
+		return m_Spatializer;
+	}
+
+	/// <summary>
+	/// Returns the spatializer (listener and emitters).
+	/// </summary>
+	/// <returns>The spatializer.</returns>
+	const Spatializer &AudioSystem::GetSpatializer() const
+	{
+		return m_Spatializer;
+	}
+
+	/// <summary>
+	/// Returns the ducker (the key bus turns down the target buses).
+	/// </summary>
+	/// <returns>The ducker.</returns>
+	Ducker &AudioSystem::GetDucker()
+	{
+		return m_Ducker;
+	}
+
+	/// <summary>
+	/// Returns the ducker (the key bus turns down the target buses).
+	/// </summary>
+	/// <returns>The ducker.</returns>
+	const Ducker &AudioSystem::GetDucker() const
+	{
+		return m_Ducker;
+	}
+
+	/// <summary>
+	/// Returns the spectrum analyzer (a tap on a bus or the master, analyzed on a worker thread).
+	/// </summary>
+	/// <returns>The analyzer.</returns>
+	Analyzer &AudioSystem::GetAnalyzer()
+	{
+		return m_Analyzer;
+	}
+
+	/// <summary>
+	/// Returns the streamer (the streams of the channels that play a sound from the disk).
+	/// </summary>
+	/// <returns>The streamer.</returns>
+	Streamer &AudioSystem::GetStreamer()
+	{
+		return m_Streamer;
+	}
+
+	/// <summary>
+	/// Turns the meters on or off (without meters, channels without effects skip the gain stage).
+	/// </summary>
+	/// <param name="a_Metering">Whether the meters are on.</param>
+	void AudioSystem::SetMetering(bool a_Metering)
+	{
+		m_Metering = a_Metering;
+	}
+
+	/// <summary>
+	/// Returns whether the meters are on.
+	/// </summary>
+	/// <returns>Whether the meters are on.</returns>
+	bool AudioSystem::IsMetering() const
+	{
+		return m_Metering;
+	}
+
+	/// <summary>
+	/// Returns the latest levels of all channels together without waiting on the audio thread.
+	/// </summary>
+	/// <returns>The readings.</returns>
+	effects::MeterReadings AudioSystem::ReadMasterMeter()
+	{
+		return m_MasterMeter.Read();
+	}
+
+	/// <summary>
+	/// Returns the latest levels of the channels on a bus without waiting on the audio thread.
+	/// </summary>
+	/// <param name="a_Bus">The bus.</param>
+	/// <returns>The readings.</returns>
+	effects::MeterReadings AudioSystem::ReadBusMeter(uint32_t a_Bus)
+	{
+		if (a_Bus >= UAUDIO_MAX_BUSES)
+			return effects::MeterReadings();
+		return m_BusMeters[a_Bus].Read();
+	}
+
 	/// <summary>
 	/// Makes a sound play.
 	/// </summary>
@@ -204,11 +385,11 @@ namespace uaudio
 
 		if (ChannelSize() < UAUDIO_DEFAULT_NUM_CHANNELS)
 		{
+			// The channel gets its sound in the vector, so its voice and stream are only made once (a copy makes its own).
 			const int32_t size = static_cast<int32_t>(ChannelSize());
-			xaudio2::XAudio2Channel channel = xaudio2::XAudio2Channel(*this);
-			channel.SetSound(a_WaveFile);
-			channel.Play();
-			m_Channels.push_back(channel);
+			m_Channels.emplace_back(*this);
+			m_Channels.back().SetSound(a_WaveFile);
+			m_Channels.back().Play();
 			return static_cast<int32_t>(size);
 		}
 		logger::log_warning("<XAudio2> No inactive channels detected.");
@@ -235,4 +416,19 @@ namespace uaudio
 
 		return &m_Channels[a_ChannelHandle];
 	}
+
+	/// <summary>
+	/// Crossfades from one channel to another (equal power). The channel that fades out stops when the fade is done.
+	/// Both fades get posted to the audio thread, so they start at the same buffer.
+	/// </summary>
+	/// <param name="a_From">Handle to the channel that fades out.</param>
+	/// <param name="a_To">Handle to the channel that fades in.</param>
+	/// <param name="a_Milliseconds">The length of the crossfade in milliseconds.</param>
+	void AudioSystem::Crossfade(ChannelHandle a_From, ChannelHandle a_To, float a_Milliseconds)
+	{
+		if (a_From.IsValid() && a_From < static_cast<int32_t>(ChannelSize()))
+			m_Channels[a_From].FadeOut(a_Milliseconds);
+		if (a_To.IsValid() && a_To < static_cast<int32_t>(ChannelSize()))
+			m_Channels[a_To].FadeIn(a_Milliseconds);
+	}
 }
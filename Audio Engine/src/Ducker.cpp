@@ -0,0 +1,165 @@
+#include <uaudio/Ducker.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace uaudio
+{
+	// A key of silence (a log of 0 does not exist).
+	constexpr float DUCKER_SILENCE = -200.0f;
+
+	// The filter never reaches its target, so it snaps to it when it is this close (in dB).
+	constexpr float DUCKER_SNAP = 0.001f;
+
+	/// <summary>
+	/// Sets the key bus, the target buses, the threshold, the depth and the times of the ducker.
+	/// </summary>
+	/// <param name="a_Settings">The settings.</param>
+	void Ducker::SetSettings(const DuckerSettings &a_Settings)
+	{
+		m_Settings = a_Settings;
+		m_Settings.depth = std::min(m_Settings.depth, 0.0f);
+		m_Settings.attack = std::max(m_Settings.attack, 0.0f);
+		m_Settings.release = std::max(m_Settings.release, 0.0f);
+		m_Settings.hold = std::max(m_Settings.hold, 0.0f);
+	}
+
+	/// <summary>
+	/// Returns the settings of the ducker.
+	/// </summary>
+	/// <returns>The settings.</returns>
+	const DuckerSettings &Ducker::GetSettings() const
+	{
+		return m_Settings;
+	}
+
+	/// <summary>
+	/// Turns the ducker on or off (when off the reduction goes back to 0 dB at once).
+	/// </summary>
+	/// <param name="a_Enabled">Whether the ducker is on.</param>
+	void Ducker::SetEnabled(bool a_Enabled)
+	{
+		m_Enabled = a_Enabled;
+	}
+
+	/// <summary>
+	/// Returns whether the ducker is on.
+	/// </summary>
+	/// <returns>Whether the ducker is on.</returns>
+	bool Ducker::IsEnabled() const
+	{
+		return m_Enabled;
+	}
+
+	/// <summary>
+	/// Returns whether a bus is the key bus.
+	/// </summary>
+	/// <param name="a_Bus">The bus.</param>
+	/// <returns>Whether the bus is the key bus.</returns>
+	bool Ducker::IsKey(uint32_t a_Bus) const
+	{
+		return m_Enabled && a_Bus == m_Settings.keyBus;
+	}
+
+	/// <summary>
+	/// Returns whether a bus gets ducked.
+	/// </summary>
+	/// <param name="a_Bus">The bus.</param>
+	/// <returns>Whether the bus gets ducked.</returns>
+	bool Ducker::IsTarget(uint32_t a_Bus) const
+	{
+		return a_Bus < UAUDIO_MAX_BUSES && (m_Settings.targetBuses & (1u << a_Bus)) != 0;
+	}
+
+	/// <summary>
+	/// Adds the peak of a buffer of a channel (called by the channels while they make their buffers).
+	/// </summary>
+	/// <param name="a_Bus">The bus of the channel.</param>
+	/// <param name="a_Peak">The peak of the buffer (0 to 1).</param>
+	/// <param name="a_Seconds">The length of the buffer.</param>
+	void Ducker::AddKey(uint32_t a_Bus, float a_Peak, float a_Seconds)
+	{
+		if (!IsKey(a_Bus))
+			return;
+
+		m_KeyLevel = std::max(m_KeyLevel, a_Peak);
+		m_KeyTime = std::max(m_KeyTime, a_Seconds);
+	}
+
+	/// <summary>
+	/// Moves the gain reduction towards the key (called on the audio thread).
+	/// </summary>
+	/// <param name="a_Seconds">The time since the last update.</param>
+	void Ducker::Update(float a_Seconds)
+	{
+		if (!m_Enabled)
+		{
+			Reset();
+			return;
+		}
+
+		const float key = m_KeyLevel > 0.0f ? 20.0f * std::log10(m_KeyLevel) : DUCKER_SILENCE;
+
+		// The key lasts as long as the buffer it came from.
+		m_KeyTime -= a_Seconds;
+		if (m_KeyTime <= 0.0f)
+		{
+			m_KeyTime = 0.0f;
+			m_KeyLevel = 0.0f;
+		}
+
+		float target = 0.0f;
+		if (key >= m_Settings.threshold)
+		{
+			m_HoldTime = m_Settings.hold / 1000.0f;
+			target = m_Settings.depth;
+		}
+		else if (m_HoldTime > 0.0f)
+		{
+			m_HoldTime -= a_Seconds;
+			target = m_Settings.depth;
+		}
+
+		float reduction = m_Reduction.load(std::memory_order_relaxed);
+		const float time = (target < reduction ? m_Settings.attack : m_Settings.release) / 1000.0f;
+		if (time > 0.0f)
+			reduction += (target - reduction) * (1.0f - std::exp(-a_Seconds / time));
+		if (time <= 0.0f || std::fabs(target - reduction) < DUCKER_SNAP)
+			reduction = target;
+		m_Reduction.store(reduction, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Forgets the key and sets the reduction back to 0 dB.
+	/// </summary>
+	void Ducker::Reset()
+	{
+		m_KeyLevel = 0.0f;
+		m_KeyTime = 0.0f;
+		m_HoldTime = 0.0f;
+		m_Reduction.store(0.0f, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Returns the gain of a bus (1 for buses that do not get ducked).
+	/// </summary>
+	/// <param name="a_Bus">The bus.</param>
+	/// <returns>The gain.</returns>
+	float Ducker::GetGain(uint32_t a_Bus) const
+	{
+		if (!IsTarget(a_Bus))
+			return UAUDIO_MAX_VOLUME;
+
+		const float reduction = m_Reduction.load(std::memory_order_relaxed);
+		return reduction == 0.0f ? UAUDIO_MAX_VOLUME : std::pow(10.0f, reduction / 20.0f);
+	}
+
+	/// <summary>
+	/// Returns the current gain reduction (can be called from any thread).
+	/// </summary>
+	/// <returns>The reduction in dB (0 or lower).</returns>
+	float Ducker::GetReduction() const
+	{
+		return m_Reduction.load(std::memory_order_relaxed);
+	}
+}
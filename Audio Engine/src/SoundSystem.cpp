@@ -1,11 +1,45 @@
 ﻿#include <uaudio/SoundSystem.h>
 
+#include <algorithm>
+#include <chrono>
 #include <utility>
 
+#include <uaudio/utils/Denormals.h>
 #include <uaudio/utils/Logger.h>
+#include <uaudio/wave/high_level/WaveChunks.h>
 
 namespace uaudio
 {
+	/// <summary>
+	/// Creates the sound system (the workers start with the first sound that gets loaded in the background).
+	/// </summary>
+	/// <param name="a_NumThreads">The amount of workers (0 means one per core, minus the thread that plays the sounds).</param>
+	SoundSystem::SoundSystem(uint32_t a_NumThreads) : m_NumThreads(a_NumThreads)
+	{
+	}
+
+	/// <summary>
+	/// Cancels the loads that are still queued and stops the workers (a load that a worker is busy with finishes first).
+	/// </summary>
+	SoundSystem::~SoundSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_LoadMutex);
+			for (auto &[load, load_job] : m_Loads)
+			{
+				if (load_job.status == LOAD_STATUS::LOAD_STATUS_QUEUED)
+					load_job.status = LOAD_STATUS::LOAD_STATUS_CANCELLED;
+				load_job.cancelled = true;
+			}
+			for (std::deque<int32_t> &queue : m_Queues)
+				queue.clear();
+			m_Running = false;
+		}
+		m_LoadQueued.notify_all();
+		for (std::thread &thread : m_Threads)
+			thread.join();
+	}
+
 	/// <summary>
 	/// Loads a sound.
 	/// </summary>
@@ -18,8 +52,10 @@ namespace uaudio
 		UAUDIO_DEFAULT_HASH hash = UAUDIO_DEFAULT_HASH_FUNCTION(a_Name);
 
 		WaveFile wave_file = WaveFile(a_Path, a_WaveConfig);
-		if (!DoesSoundExist(hash))
-			m_Sounds.insert(std::make_pair(hash, wave_file));
+
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
+		if (m_Sounds.find(hash) == m_Sounds.end())
+			m_Sounds.emplace(hash, std::move(wave_file));
 
 		return hash;
 	}
@@ -30,6 +66,7 @@ namespace uaudio
 	/// <param name="a_Hash">The sound hash.</param>
 	void SoundSystem::UnloadSound(const UAUDIO_DEFAULT_HASH a_Hash)
 	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
 		m_Sounds.erase(a_Hash);
 	}
 
@@ -40,8 +77,12 @@ namespace uaudio
 	/// <returns>Returns the sound, returns nullptr if it did not exist.</returns>
 	WaveFile *SoundSystem::FindSound(const UAUDIO_DEFAULT_HASH a_Hash)
 	{
-		if (DoesSoundExist(a_Hash))
-			return &m_Sounds[a_Hash];
+		{
+			std::lock_guard<std::mutex> lock(m_LoadMutex);
+			const auto it = m_Sounds.find(a_Hash);
+			if (it != m_Sounds.end())
+				return &it->second;
+		}
 
 		logger::ASSERT(false, "Hash %i not found.", a_Hash);
 		logger::log_warning("<SoundSystem> Could not find requested sound with hash number %i. Using default sound instead.", a_Hash);
@@ -56,15 +97,337 @@ namespace uaudio
 	/// <returns>Returns whether the sound exists or not.</returns>
 	bool SoundSystem::DoesSoundExist(const UAUDIO_DEFAULT_HASH a_Hash) const
 	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
 		return m_Sounds.find(a_Hash) != m_Sounds.end();
 	}
 
+	/// <summary>
+	/// Queues a sound to be loaded by the workers. It becomes a sound (that can be found and played) in the Update after it is done.
+	/// </summary>
+	/// <param name="a_Path">The path to the file.</param>
+	/// <param name="a_Name">The name which will be hashed.</param>
+	/// <param name="a_WaveConfig">The config to load the file with (it gets copied).</param>
+	/// <param name="a_Priority">Loads with a higher priority go first.</param>
+	/// <param name="a_Callback">Gets called by Update when the load is over (can be nullptr).</param>
+	/// <param name="a_UserData">Gets passed to the callback.</param>
+	/// <returns>The handle of the load.</returns>
+	LoadHandle SoundSystem::LoadSoundAsync(const char *a_Path, const char *a_Name, const WaveConfig &a_WaveConfig, LOAD_PRIORITY a_Priority, LoadCallback a_Callback, void *a_UserData)
+	{
+		std::unique_lock<std::mutex> lock(m_LoadMutex);
+		if (!m_Running)
+			StartThreads();
+
+		const int32_t load = m_NextLoad++;
+		LoadJob &load_job = m_Loads[load];
+		load_job.path = a_Path;
+		load_job.hash = UAUDIO_DEFAULT_HASH_FUNCTION(a_Name);
+		load_job.waveConfig = a_WaveConfig;
+		load_job.callback = a_Callback;
+		load_job.userData = a_UserData;
+		m_Queues[static_cast<size_t>(a_Priority)].push_back(load);
+
+		lock.unlock();
+		m_LoadQueued.notify_one();
+		return LoadHandle(load);
+	}
+
+	/// <summary>
+	/// Cancels a load. A load that a worker has started finishes, but its sound gets thrown away.
+	/// The callback gets called with the cancelled status in the next Update.
+	/// </summary>
+	/// <param name="a_LoadHandle">The load.</param>
+	/// <returns>Whether the load was still going.</returns>
+	bool SoundSystem::CancelLoad(LoadHandle a_LoadHandle)
+	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
+		const auto it = m_Loads.find(a_LoadHandle);
+		if (it == m_Loads.end() || it->second.cancelled)
+			return false;
+
+		LoadJob &load_job = it->second;
+		if (load_job.status == LOAD_STATUS::LOAD_STATUS_QUEUED)
+		{
+			for (std::deque<int32_t> &queue : m_Queues)
+				queue.erase(std::remove(queue.begin(), queue.end(), static_cast<int32_t>(a_LoadHandle)), queue.end());
+			load_job.status = LOAD_STATUS::LOAD_STATUS_CANCELLED;
+			load_job.cancelled = true;
+			m_Finished.push_back(a_LoadHandle);
+			m_LoadFinished.notify_all();
+			return true;
+		}
+
+		// A load that is done can still be cancelled until Update moves it into the sounds.
+		const bool published = load_job.status != LOAD_STATUS::LOAD_STATUS_LOADING && std::find(m_Finished.begin(), m_Finished.end(), static_cast<int32_t>(a_LoadHandle)) == m_Finished.end();
+		if (published || load_job.status == LOAD_STATUS::LOAD_STATUS_FAILED)
+			return false;
+
+		load_job.cancelled = true;
+		return true;
+	}
+
+	/// <summary>
+	/// Returns where a load is.
+	/// </summary>
+	/// <param name="a_LoadHandle">The load.</param>
+	/// <returns>The status (done means that it waits for Update, after Update the load is gone and it is invalid).</returns>
+	LOAD_STATUS SoundSystem::GetLoadStatus(LoadHandle a_LoadHandle) const
+	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
+		const auto it = m_Loads.find(a_LoadHandle);
+		if (it == m_Loads.end())
+			return LOAD_STATUS::LOAD_STATUS_INVALID;
+
+		return it->second.cancelled ? LOAD_STATUS::LOAD_STATUS_CANCELLED : it->second.status;
+	}
+
+	/// <summary>
+	/// Returns the hash of the sound that a load is for.
+	/// </summary>
+	/// <param name="a_LoadHandle">The load.</param>
+	/// <returns>The hash of the name (0 for an unknown load).</returns>
+	UAUDIO_DEFAULT_HASH SoundSystem::GetLoadHash(LoadHandle a_LoadHandle) const
+	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
+		const auto it = m_Loads.find(a_LoadHandle);
+		if (it == m_Loads.end())
+			return 0;
+
+		return it->second.hash;
+	}
+
+	/// <summary>
+	/// Returns the amount of loads that are queued or busy.
+	/// </summary>
+	/// <returns>The amount of loads.</returns>
+	uint32_t SoundSystem::LoadSize() const
+	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
+		uint32_t size = m_NumBusy;
+		for (const std::deque<int32_t> &queue : m_Queues)
+			size += static_cast<uint32_t>(queue.size());
+		return size;
+	}
+
+	/// <summary>
+	/// Waits until every queued load is over (the sounds still need an Update to become sounds).
+	/// </summary>
+	void SoundSystem::WaitForLoads()
+	{
+		std::unique_lock<std::mutex> lock(m_LoadMutex);
+		while (m_NumBusy > 0 || !m_Queues[0].empty() || !m_Queues[1].empty() || !m_Queues[2].empty())
+			m_LoadFinished.wait(lock);
+	}
+
+	/// <summary>
+	/// Moves the sounds that are done into the sounds and calls the callbacks of the loads that are over.
+	/// The loads are removed afterwards, so their handles become invalid (the callback gets the last status).
+	/// Needs to be called on the thread that uses the sounds (the callbacks get called on it as well).
+	/// </summary>
+	/// <returns>The amount of loads that were over.</returns>
+	uint32_t SoundSystem::Update()
+	{
+		struct FinishedLoad
+		{
+			int32_t load = -1;
+			UAUDIO_DEFAULT_HASH hash = 0;
+			LOAD_STATUS status = LOAD_STATUS::LOAD_STATUS_INVALID;
+			LoadCallback callback = nullptr;
+			void *userData = nullptr;
+		};
+
+		std::unique_lock<std::mutex> lock(m_LoadMutex);
+		std::vector<int32_t, UAUDIO_DEFAULT_ALLOCATOR<int32_t>> finished;
+		finished.swap(m_Finished);
+
+		// The sounds get moved while the lock is held (which does not copy the data), the callbacks get called without it, so they can queue new loads.
+		std::vector<FinishedLoad, UAUDIO_DEFAULT_ALLOCATOR<FinishedLoad>> finished_loads;
+		for (const int32_t load : finished)
+		{
+			const auto it = m_Loads.find(load);
+			if (it == m_Loads.end())
+				continue;
+
+			LoadJob &load_job = it->second;
+			if (load_job.cancelled)
+				load_job.status = LOAD_STATUS::LOAD_STATUS_CANCELLED;
+			else if (load_job.status == LOAD_STATUS::LOAD_STATUS_DONE && m_Sounds.find(load_job.hash) == m_Sounds.end())
+				m_Sounds.emplace(load_job.hash, std::move(load_job.waveFile));
+
+			finished_loads.push_back({load, load_job.hash, load_job.status, load_job.callback, load_job.userData});
+			m_Loads.erase(it);
+		}
+		lock.unlock();
+
+		for (const FinishedLoad &finished_load : finished_loads)
+			if (finished_load.callback != nullptr)
+				finished_load.callback(LoadHandle(finished_load.load), finished_load.hash, finished_load.status, finished_load.userData);
+
+		return static_cast<uint32_t>(finished_loads.size());
+	}
+
+	/// <summary>
+	/// Loads all sounds of a manifest on multiple threads and moves them into the sounds at the end.
+	/// Sounds that already exist (or appear twice in the manifest) get loaded, but the sound that was there first stays.
+	/// </summary>
+	/// <param name="a_Manifest">The sounds (path, name and config).</param>
+	/// <param name="a_NumThreads">The amount of threads, including the calling thread (0 means one per core).</param>
+	/// <returns>How long every sound and the whole manifest took.</returns>
+	BatchLoadReport SoundSystem::LoadSounds(const std::vector<SoundManifestEntry, UAUDIO_DEFAULT_ALLOCATOR<SoundManifestEntry>> &a_Manifest, uint32_t a_NumThreads)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		BatchLoadReport report;
+		report.sounds.resize(a_Manifest.size());
+
+		uint32_t num_threads = a_NumThreads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : a_NumThreads;
+		num_threads = std::max(std::min(num_threads, static_cast<uint32_t>(a_Manifest.size())), 1u);
+
+		BatchLoad batch_load;
+		batch_load.manifest = &a_Manifest;
+		batch_load.sounds.resize(a_Manifest.size());
+		batch_load.report = &report;
+		batch_load.numThreads = num_threads;
+
+		std::vector<std::thread, UAUDIO_DEFAULT_ALLOCATOR<std::thread>> threads;
+		for (uint32_t i = 1; i < num_threads; i++)
+			threads.emplace_back(LoadBatch, std::ref(batch_load));
+		LoadBatch(batch_load);
+		for (std::thread &thread : threads)
+			thread.join();
+
+		// All at once, under the same lock that Update moves the sounds with.
+		{
+			std::lock_guard<std::mutex> lock(m_LoadMutex);
+			for (size_t i = 0; i < a_Manifest.size(); i++)
+			{
+				const SoundLoadReport &sound_report = report.sounds[i];
+				report.totalSize += sound_report.fileSize;
+				if (!sound_report.loaded)
+					continue;
+
+				report.numLoaded++;
+				if (m_Sounds.find(sound_report.hash) == m_Sounds.end())
+					m_Sounds.emplace(sound_report.hash, std::move(batch_load.sounds[i]));
+			}
+		}
+
+		report.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (report.milliseconds > 0.0f)
+			report.megabytesPerSecond = static_cast<float>(static_cast<double>(report.totalSize) / 1000.0 / report.milliseconds);
+
+		logger::log_info("<SoundSystem> Loaded %s%u%s of %s%u%s sounds (%s%.1f MB%s in %s%.1f ms%s, %s%.1f MB/s%s).", logger::COLOR_YELLOW, report.numLoaded, logger::COLOR_WHITE, logger::COLOR_YELLOW, static_cast<uint32_t>(a_Manifest.size()), logger::COLOR_WHITE, logger::COLOR_YELLOW, static_cast<double>(report.totalSize) / 1000000.0, logger::COLOR_WHITE, logger::COLOR_YELLOW, report.milliseconds, logger::COLOR_WHITE, logger::COLOR_YELLOW, report.megabytesPerSecond, logger::COLOR_WHITE);
+		return report;
+	}
+
+	/// <summary>
+	/// A thread of a manifest, it loads the next sound of the manifest until there are none left.
+	/// </summary>
+	/// <param name="a_BatchLoad">The manifest.</param>
+	void SoundSystem::LoadBatch(BatchLoad &a_BatchLoad)
+	{
+		utils::DenormalGuard denormal_guard;
+
+		const uint32_t num_sounds = static_cast<uint32_t>(a_BatchLoad.manifest->size());
+		for (uint32_t i = a_BatchLoad.next++; i < num_sounds; i = a_BatchLoad.next++)
+		{
+			const SoundManifestEntry &entry = (*a_BatchLoad.manifest)[i];
+			SoundLoadReport &sound_report = a_BatchLoad.report->sounds[i];
+			sound_report.hash = UAUDIO_DEFAULT_HASH_FUNCTION(entry.name.c_str());
+
+			// At the end of the manifest threads run out of sounds, the last sounds get their share of them for the conversion.
+			WaveConfig wave_config = entry.waveConfig;
+			const uint32_t num_left = num_sounds - i;
+			if (wave_config.conversionThreads != 0 && num_left < a_BatchLoad.numThreads)
+				wave_config.conversionThreads = std::max(wave_config.conversionThreads, a_BatchLoad.numThreads / num_left);
+
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			WaveFile wave_file(entry.path.c_str(), wave_config);
+			sound_report.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			const WaveFormat &wave_format = wave_file.GetWaveFormat();
+			sound_report.loaded = wave_format.HasChunk(FMT_CHUNK_ID) && (wave_format.HasChunk(DATA_CHUNK_ID) || wave_format.IsStreaming());
+			sound_report.fileSize = wave_format.GetFileSize();
+			if (sound_report.milliseconds > 0.0f)
+				sound_report.megabytesPerSecond = static_cast<float>(sound_report.fileSize / 1000.0 / sound_report.milliseconds);
+
+			if (sound_report.loaded)
+				a_BatchLoad.sounds[i] = std::move(wave_file);
+		}
+	}
+
+	/// <summary>
+	/// Starts the workers (the lock is held).
+	/// </summary>
+	void SoundSystem::StartThreads()
+	{
+		uint32_t num_threads = m_NumThreads;
+		if (num_threads == 0)
+			num_threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_Running = true;
+		for (uint32_t i = 0; i < num_threads; i++)
+			m_Threads.emplace_back(&SoundSystem::Run, this);
+	}
+
+	/// <summary>
+	/// A worker, it loads the queued sounds with the highest priority first.
+	/// </summary>
+	void SoundSystem::Run()
+	{
+		utils::DenormalGuard denormal_guard;
+
+		std::unique_lock<std::mutex> lock(m_LoadMutex);
+		while (true)
+		{
+			int32_t load = -1;
+			for (size_t i = m_Queues.size(); i > 0 && load == -1; i--)
+				if (!m_Queues[i - 1].empty())
+				{
+					load = m_Queues[i - 1].front();
+					m_Queues[i - 1].pop_front();
+				}
+
+			if (load == -1)
+			{
+				if (!m_Running)
+					return;
+				m_LoadQueued.wait(lock);
+				continue;
+			}
+
+			// The job stays where it is in the map, the worker only needs its path and config.
+			LoadJob &load_job = m_Loads[load];
+			load_job.status = LOAD_STATUS::LOAD_STATUS_LOADING;
+			const std::string path = load_job.path;
+			const WaveConfig wave_config = load_job.waveConfig;
+			m_NumBusy++;
+
+			lock.unlock();
+			WaveFile wave_file(path.c_str(), wave_config);
+			const WaveFormat &wave_format = wave_file.GetWaveFormat();
+			const bool loaded = wave_format.HasChunk(FMT_CHUNK_ID) && (wave_format.HasChunk(DATA_CHUNK_ID) || wave_format.IsStreaming());
+			lock.lock();
+
+			if (loaded)
+			{
+				load_job.waveFile = std::move(wave_file);
+				load_job.status = LOAD_STATUS::LOAD_STATUS_DONE;
+			}
+			else
+				load_job.status = LOAD_STATUS::LOAD_STATUS_FAILED;
+			m_Finished.push_back(load);
+			m_NumBusy--;
+			m_LoadFinished.notify_all();
+		}
+	}
+
 	/// <summary>
 	/// Returns the amount of sounds that are currently loaded.
 	/// </summary>
 	/// <returns>Returns the amount of sounds that are currently loaded.</returns>
 	uint32_t SoundSystem::SoundSize() const
 	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
 		return static_cast<uint32_t>(m_Sounds.size());
 	}
 
@@ -74,6 +437,7 @@ namespace uaudio
 	/// <returns>Returns all the sounds in a vector.</returns>
 	std::vector<WaveFile *, UAUDIO_DEFAULT_ALLOCATOR<WaveFile *>> SoundSystem::GetSounds()
 	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
 		std::vector<WaveFile *, UAUDIO_DEFAULT_ALLOCATOR<WaveFile *>> sounds;
 		for (auto &[hash, sound] : m_Sounds)
 			sounds.push_back(&sound);
@@ -87,6 +451,7 @@ namespace uaudio
 	/// <returns>Returns all the sound hashes in a vector.</returns>
 	std::vector<UAUDIO_DEFAULT_HASH, UAUDIO_DEFAULT_ALLOCATOR<UAUDIO_DEFAULT_HASH>> SoundSystem::GetSoundHashes()
 	{
+		std::lock_guard<std::mutex> lock(m_LoadMutex);
 		std::vector<UAUDIO_DEFAULT_HASH, UAUDIO_DEFAULT_ALLOCATOR<UAUDIO_DEFAULT_HASH>> sounds;
 		for (auto &[hash, sound] : m_Sounds)
 			sounds.push_back(hash);
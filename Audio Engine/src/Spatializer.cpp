@@ -0,0 +1,629 @@
+#include <uaudio/Spatializer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+#include <uaudio/utils/Logger.h>
+#include <uaudio/utils/Utils.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UAUDIO_SPATIALIZER_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace uaudio
+{
+	constexpr float PI = 3.14159265358979323846f;
+
+	// Distances below this count as "at the listener" (no direction).
+	constexpr float MIN_DISTANCE = 1e-6f;
+
+	// The smallest range between the inner and outer cone (avoids a division by zero).
+	constexpr float MIN_CONE_RANGE = 1e-4f;
+
+	// Emitters get processed in groups of 4, so the arrays are a multiple of 4.
+	constexpr uint32_t EMITTER_GROUP = 4;
+
+	namespace
+	{
+		struct Speaker
+		{
+			uint16_t index;
+			float azimuth;
+		};
+
+		// Speakers in the order of the channel mask (FL, FR, FC, LFE, BL, BR, SL, SR), sorted by azimuth (degrees, positive is right).
+		constexpr Speaker SPEAKERS_QUAD[] = {{2, -135.0f}, {0, -45.0f}, {1, 45.0f}, {3, 135.0f}};
+		constexpr Speaker SPEAKERS_5_1[] = {{4, -110.0f}, {0, -30.0f}, {2, 0.0f}, {1, 30.0f}, {5, 110.0f}};
+		constexpr Speaker SPEAKERS_7_1[] = {{4, -150.0f}, {6, -90.0f}, {0, -30.0f}, {2, 0.0f}, {1, 30.0f}, {7, 90.0f}, {5, 150.0f}};
+
+		/// <summary>
+		/// Approximates log2 (only for positive numbers).
+		/// </summary>
+		/// <param name="a_Value">The value.</param>
+		/// <returns></returns>
+		inline float FastLog2(float a_Value)
+		{
+			int32_t bits;
+			std::memcpy(&bits, &a_Value, sizeof(bits));
+			const int32_t mantissa_bits = (bits & 0x007FFFFF) | 0x3F000000;
+			float mantissa;
+			std::memcpy(&mantissa, &mantissa_bits, sizeof(mantissa));
+			return static_cast<float>(bits) * 1.1920928955078125e-7f - 124.22551499f - 1.498030302f * mantissa - 1.72587999f / (0.3520887068f + mantissa);
+		}
+
+		/// <summary>
+		/// Approximates 2 to the power of a value.
+		/// </summary>
+		/// <param name="a_Value">The value.</param>
+		/// <returns></returns>
+		inline float FastPow2(float a_Value)
+		{
+			const float offset = a_Value < 0.0f ? 1.0f : 0.0f;
+			const float clipped = std::max(a_Value, -126.0f);
+			const float fraction = clipped - static_cast<float>(static_cast<int32_t>(clipped)) + offset;
+			const int32_t bits = static_cast<int32_t>(8388608.0f * (clipped + 121.2740575f + 27.7280233f / (4.84252568f - fraction) - 1.49012907f * fraction));
+			float result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+#if defined(UAUDIO_SPATIALIZER_SSE2)
+		inline __m128 FastLog2(__m128 a_Value)
+		{
+			const __m128i bits = _mm_castps_si128(a_Value);
+			const __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F000000)));
+			__m128 result = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set1_ps(1.1920928955078125e-7f)), _mm_set1_ps(124.22551499f));
+			result = _mm_sub_ps(result, _mm_mul_ps(_mm_set1_ps(1.498030302f), mantissa));
+			return _mm_sub_ps(result, _mm_div_ps(_mm_set1_ps(1.72587999f), _mm_add_ps(_mm_set1_ps(0.3520887068f), mantissa)));
+		}
+
+		inline __m128 FastPow2(__m128 a_Value)
+		{
+			const __m128 offset = _mm_and_ps(_mm_cmplt_ps(a_Value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+			const __m128 clipped = _mm_max_ps(a_Value, _mm_set1_ps(-126.0f));
+			const __m128 fraction = _mm_add_ps(_mm_sub_ps(clipped, _mm_cvtepi32_ps(_mm_cvttps_epi32(clipped))), offset);
+			__m128 result = _mm_add_ps(clipped, _mm_set1_ps(121.2740575f));
+			result = _mm_add_ps(result, _mm_div_ps(_mm_set1_ps(27.7280233f), _mm_sub_ps(_mm_set1_ps(4.84252568f), fraction)));
+			result = _mm_sub_ps(result, _mm_mul_ps(_mm_set1_ps(1.49012907f), fraction));
+			return _mm_castsi128_ps(_mm_cvttps_epi32(_mm_mul_ps(_mm_set1_ps(8388608.0f), result)));
+		}
+
+		inline __m128 Clamp(__m128 a_Value, __m128 a_Min, __m128 a_Max)
+		{
+			return _mm_min_ps(_mm_max_ps(a_Value, a_Min), a_Max);
+		}
+
+		inline __m128 Select(__m128 a_Mask, __m128 a_True, __m128 a_False)
+		{
+			return _mm_or_ps(_mm_and_ps(a_Mask, a_True), _mm_andnot_ps(a_Mask, a_False));
+		}
+#endif
+
+		/// <summary>
+		/// Normalizes a vector (zero vectors stay zero).
+		/// </summary>
+		/// <param name="a_Vector">The vector.</param>
+		/// <returns></returns>
+		Vector3 Normalize(const Vector3 &a_Vector)
+		{
+			const float length = std::sqrt(a_Vector.x * a_Vector.x + a_Vector.y * a_Vector.y + a_Vector.z * a_Vector.z);
+			if (length < MIN_DISTANCE)
+				return {};
+			return {a_Vector.x / length, a_Vector.y / length, a_Vector.z / length};
+		}
+
+		/// <summary>
+		/// Pans between the two speakers around the azimuth with constant power.
+		/// </summary>
+		/// <param name="a_Speakers">The speakers, sorted by azimuth.</param>
+		/// <param name="a_NumSpeakers">The number of speakers.</param>
+		/// <param name="a_Azimuth">The azimuth in degrees.</param>
+		/// <param name="a_Volumes">The volume per speaker.</param>
+		void PanPairwise(const Speaker *a_Speakers, uint32_t a_NumSpeakers, float a_Azimuth, float *a_Volumes)
+		{
+			// The last speaker pairs with the first one (around the back).
+			for (uint32_t i = 0; i < a_NumSpeakers; i++)
+			{
+				const Speaker &first = a_Speakers[i];
+				const Speaker &second = a_Speakers[(i + 1) % a_NumSpeakers];
+
+				const float start = first.azimuth;
+				const float end = second.azimuth > start ? second.azimuth : second.azimuth + 360.0f;
+				const float azimuth = a_Azimuth < start ? a_Azimuth + 360.0f : a_Azimuth;
+				if (azimuth <= end)
+				{
+					const float fraction = (azimuth - start) / (end - start);
+					a_Volumes[first.index] = std::cos(fraction * PI * 0.5f);
+					a_Volumes[second.index] = std::sin(fraction * PI * 0.5f);
+					return;
+				}
+			}
+		}
+	}
+
+	Spatializer::Spatializer(uint32_t a_MaxEmitters) : m_MaxEmitters(a_MaxEmitters)
+	{
+		const uint32_t size = (a_MaxEmitters + EMITTER_GROUP - 1) / EMITTER_GROUP * EMITTER_GROUP;
+		for (FloatArray *array : {&m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_DirectionX, &m_DirectionY, &m_DirectionZ,
+			&m_ConeOuterCos, &m_ConeInverseRange, &m_ConeOuterVolume, &m_MinDistance, &m_MaxDistance, &m_InverseRange, &m_Rolloff,
+			&m_Enabled, &m_Volume, &m_Panning, &m_Front, &m_Pitch})
+			array->resize(size);
+		m_Curve.resize(size);
+		m_FreeEmitters.reserve(a_MaxEmitters);
+
+		for (uint32_t i = 0; i < size; i++)
+			ResetEmitter(i);
+	}
+
+	/// <summary>
+	/// Sets the listener (usually the camera).
+	/// </summary>
+	/// <param name="a_Listener">The listener.</param>
+	void Spatializer::SetListener(const Listener &a_Listener)
+	{
+		m_Listener = a_Listener;
+
+		// The forward and up vector do not have to be exactly perpendicular.
+		m_Listener.forward = Normalize(a_Listener.forward);
+		if (m_Listener.forward.x == 0.0f && m_Listener.forward.y == 0.0f && m_Listener.forward.z == 0.0f)
+			m_Listener.forward = {0.0f, 0.0f, 1.0f};
+
+		const Vector3 &up = a_Listener.up, &forward = m_Listener.forward;
+		m_Right = Normalize({up.y * forward.z - up.z * forward.y, up.z * forward.x - up.x * forward.z, up.x * forward.y - up.y * forward.x});
+		if (m_Right.x == 0.0f && m_Right.y == 0.0f && m_Right.z == 0.0f)
+			m_Right = {1.0f, 0.0f, 0.0f};
+		m_Listener.up = {forward.y * m_Right.z - forward.z * m_Right.y, forward.z * m_Right.x - forward.x * m_Right.z, forward.x * m_Right.y - forward.y * m_Right.x};
+	}
+
+	/// <summary>
+	/// Returns the listener.
+	/// </summary>
+	/// <returns>The listener (with normalized vectors).</returns>
+	const Listener &Spatializer::GetListener() const
+	{
+		return m_Listener;
+	}
+
+	/// <summary>
+	/// Sets the speed of sound (used for doppler).
+	/// </summary>
+	/// <param name="a_SpeedOfSound">The speed of sound in meters per second.</param>
+	void Spatializer::SetSpeedOfSound(float a_SpeedOfSound)
+	{
+		m_SpeedOfSound = std::max(a_SpeedOfSound, MIN_DISTANCE);
+	}
+
+	/// <summary>
+	/// Returns the speed of sound.
+	/// </summary>
+	/// <returns>The speed of sound in meters per second.</returns>
+	float Spatializer::GetSpeedOfSound() const
+	{
+		return m_SpeedOfSound;
+	}
+
+	/// <summary>
+	/// Sets how strong the doppler effect is.
+	/// </summary>
+	/// <param name="a_DopplerFactor">The doppler factor (0 is no doppler, 1 is realistic).</param>
+	void Spatializer::SetDopplerFactor(float a_DopplerFactor)
+	{
+		m_DopplerFactor = std::max(a_DopplerFactor, 0.0f);
+	}
+
+	/// <summary>
+	/// Returns how strong the doppler effect is.
+	/// </summary>
+	/// <returns>The doppler factor.</returns>
+	float Spatializer::GetDopplerFactor() const
+	{
+		return m_DopplerFactor;
+	}
+
+	/// <summary>
+	/// Adds an emitter (at the origin, omnidirectional, inverse attenuation from 1 meter).
+	/// </summary>
+	/// <returns>Emitter handle.</returns>
+	EmitterHandle Spatializer::AddEmitter()
+	{
+		uint32_t index;
+		if (!m_FreeEmitters.empty())
+		{
+			index = m_FreeEmitters.back();
+			m_FreeEmitters.pop_back();
+		}
+		else if (m_NumEmitters < m_MaxEmitters)
+			index = m_NumEmitters++;
+		else
+		{
+			logger::log_warning("<Spatializer> No free emitters left.");
+			return SOUND_NULL_HANDLE;
+		}
+
+		ResetEmitter(index);
+		m_Enabled[index] = 1.0f;
+		return static_cast<int32_t>(index);
+	}
+
+	/// <summary>
+	/// Removes an emitter (the slot gets reused by the next emitter).
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	void Spatializer::RemoveEmitter(EmitterHandle a_EmitterHandle)
+	{
+		if (!IsValid(a_EmitterHandle))
+			return;
+
+		ResetEmitter(a_EmitterHandle);
+		m_FreeEmitters.push_back(a_EmitterHandle);
+	}
+
+	/// <summary>
+	/// Returns the amount of emitters that are in use.
+	/// </summary>
+	/// <returns>The amount of emitters.</returns>
+	uint32_t Spatializer::EmitterSize() const
+	{
+		return m_NumEmitters - static_cast<uint32_t>(m_FreeEmitters.size());
+	}
+
+	/// <summary>
+	/// Sets the position of an emitter.
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <param name="a_Position">The position.</param>
+	void Spatializer::SetEmitterPosition(EmitterHandle a_EmitterHandle, const Vector3 &a_Position)
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		m_PositionX[a_EmitterHandle] = a_Position.x;
+		m_PositionY[a_EmitterHandle] = a_Position.y;
+		m_PositionZ[a_EmitterHandle] = a_Position.z;
+	}
+
+	/// <summary>
+	/// Sets the velocity of an emitter (used for doppler).
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <param name="a_Velocity">The velocity.</param>
+	void Spatializer::SetEmitterVelocity(EmitterHandle a_EmitterHandle, const Vector3 &a_Velocity)
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		m_VelocityX[a_EmitterHandle] = a_Velocity.x;
+		m_VelocityY[a_EmitterHandle] = a_Velocity.y;
+		m_VelocityZ[a_EmitterHandle] = a_Velocity.z;
+	}
+
+	/// <summary>
+	/// Sets the direction of an emitter (used for the cone).
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <param name="a_Direction">The direction (a zero vector makes the emitter omnidirectional).</param>
+	void Spatializer::SetEmitterDirection(EmitterHandle a_EmitterHandle, const Vector3 &a_Direction)
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		const Vector3 direction = Normalize(a_Direction);
+		m_DirectionX[a_EmitterHandle] = direction.x;
+		m_DirectionY[a_EmitterHandle] = direction.y;
+		m_DirectionZ[a_EmitterHandle] = direction.z;
+	}
+
+	/// <summary>
+	/// Sets the cone of an emitter.
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <param name="a_InnerAngle">The full inner angle in radians (full volume).</param>
+	/// <param name="a_OuterAngle">The full outer angle in radians (outer volume).</param>
+	/// <param name="a_OuterVolume">The volume outside of the outer angle.</param>
+	void Spatializer::SetEmitterCone(EmitterHandle a_EmitterHandle, float a_InnerAngle, float a_OuterAngle, float a_OuterVolume)
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		a_InnerAngle = utils::clamp(a_InnerAngle, 0.0f, 2.0f * PI);
+		a_OuterAngle = utils::clamp(a_OuterAngle, a_InnerAngle, 2.0f * PI);
+
+		const float inner_cos = std::cos(a_InnerAngle * 0.5f), outer_cos = std::cos(a_OuterAngle * 0.5f);
+		m_ConeOuterCos[a_EmitterHandle] = outer_cos;
+		m_ConeInverseRange[a_EmitterHandle] = 1.0f / std::max(inner_cos - outer_cos, MIN_CONE_RANGE);
+		m_ConeOuterVolume[a_EmitterHandle] = utils::clamp(a_OuterVolume, 0.0f, UAUDIO_MAX_VOLUME);
+	}
+
+	/// <summary>
+	/// Sets the distance attenuation of an emitter.
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <param name="a_Curve">The attenuation curve.</param>
+	/// <param name="a_MinDistance">The distance where the attenuation starts.</param>
+	/// <param name="a_MaxDistance">The distance where the attenuation stops.</param>
+	/// <param name="a_Rolloff">How fast the volume goes down.</param>
+	void Spatializer::SetEmitterAttenuation(EmitterHandle a_EmitterHandle, ATTENUATION_CURVE a_Curve, float a_MinDistance, float a_MaxDistance, float a_Rolloff)
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		a_MinDistance = std::max(a_MinDistance, MIN_DISTANCE);
+		a_MaxDistance = std::max(a_MaxDistance, a_MinDistance + MIN_DISTANCE);
+
+		m_Curve[a_EmitterHandle] = static_cast<int32_t>(a_Curve);
+		m_MinDistance[a_EmitterHandle] = a_MinDistance;
+		m_MaxDistance[a_EmitterHandle] = a_MaxDistance;
+		m_InverseRange[a_EmitterHandle] = 1.0f / (a_MaxDistance - a_MinDistance);
+		m_Rolloff[a_EmitterHandle] = std::max(a_Rolloff, 0.0f);
+	}
+
+	/// <summary>
+	/// Calculates the volume, panning and pitch of every emitter.
+	/// </summary>
+	void Spatializer::Update()
+	{
+		UpdateEmitters(0, (m_NumEmitters + EMITTER_GROUP - 1) / EMITTER_GROUP * EMITTER_GROUP);
+	}
+
+	/// <summary>
+	/// Returns the volume of an emitter (attenuation and cone).
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <returns>The volume.</returns>
+	float Spatializer::GetVolume(EmitterHandle a_EmitterHandle) const
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		return m_Volume[a_EmitterHandle];
+	}
+
+	/// <summary>
+	/// Returns the panning of an emitter.
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <returns>The panning (-1 is fully left, 1 is fully right, 0 is middle).</returns>
+	float Spatializer::GetPanning(EmitterHandle a_EmitterHandle) const
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		return m_Panning[a_EmitterHandle];
+	}
+
+	/// <summary>
+	/// Returns the pitch of an emitter (doppler).
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <returns>The frequency ratio.</returns>
+	float Spatializer::GetPitch(EmitterHandle a_EmitterHandle) const
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		return m_Pitch[a_EmitterHandle];
+	}
+
+	/// <summary>
+	/// Returns the volume of an emitter per speaker.
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <param name="a_NumSpeakers">The number of speakers (1 mono, 2 stereo, 4 quad, 6 5.1, 8 7.1).</param>
+	/// <param name="a_Volumes">The volume per speaker (in the order of the channel mask).</param>
+	void Spatializer::GetSpeakerVolumes(EmitterHandle a_EmitterHandle, uint16_t a_NumSpeakers, float *a_Volumes) const
+	{
+		logger::ASSERT(IsValid(a_EmitterHandle), "");
+
+		std::fill(a_Volumes, a_Volumes + a_NumSpeakers, 0.0f);
+		const float volume = m_Volume[a_EmitterHandle];
+
+		const Speaker *speakers = nullptr;
+		uint32_t num_speakers = 0;
+		switch (a_NumSpeakers)
+		{
+			case 1:
+			{
+				a_Volumes[0] = volume;
+				return;
+			}
+			case 4:
+			{
+				speakers = SPEAKERS_QUAD;
+				num_speakers = static_cast<uint32_t>(std::size(SPEAKERS_QUAD));
+				break;
+			}
+			case 6:
+			{
+				speakers = SPEAKERS_5_1;
+				num_speakers = static_cast<uint32_t>(std::size(SPEAKERS_5_1));
+				break;
+			}
+			case UAUDIO_MAX_SPEAKERS:
+			{
+				speakers = SPEAKERS_7_1;
+				num_speakers = static_cast<uint32_t>(std::size(SPEAKERS_7_1));
+				break;
+			}
+			default:
+			{
+				// Stereo (and unknown layouts) pan the first two speakers with constant power.
+				if (a_NumSpeakers < 2)
+					return;
+				const float angle = (m_Panning[a_EmitterHandle] + 1.0f) * PI * 0.25f;
+				a_Volumes[0] = volume * std::cos(angle);
+				a_Volumes[1] = volume * std::sin(angle);
+				return;
+			}
+		}
+
+		const float panning = m_Panning[a_EmitterHandle], front = m_Front[a_EmitterHandle];
+		PanPairwise(speakers, num_speakers, std::atan2(panning, front) * 180.0f / PI, a_Volumes);
+
+		// Sounds above, below or at the listener have no clear direction and get spread over all speakers (keeping the power the same).
+		const float horizontal = std::min(panning * panning + front * front, 1.0f);
+		const float spread = (1.0f - horizontal) / static_cast<float>(num_speakers);
+		for (uint32_t i = 0; i < num_speakers; i++)
+		{
+			float &speaker_volume = a_Volumes[speakers[i].index];
+			speaker_volume = volume * std::sqrt(horizontal * speaker_volume * speaker_volume + spread);
+		}
+	}
+
+	/// <summary>
+	/// Sets the default settings of an emitter slot.
+	/// </summary>
+	/// <param name="a_Index">The index of the emitter.</param>
+	void Spatializer::ResetEmitter(uint32_t a_Index)
+	{
+		m_PositionX[a_Index] = m_PositionY[a_Index] = m_PositionZ[a_Index] = 0.0f;
+		m_VelocityX[a_Index] = m_VelocityY[a_Index] = m_VelocityZ[a_Index] = 0.0f;
+		m_DirectionX[a_Index] = m_DirectionY[a_Index] = m_DirectionZ[a_Index] = 0.0f;
+
+		// A full circle on both angles means no cone.
+		m_ConeOuterCos[a_Index] = -1.0f;
+		m_ConeInverseRange[a_Index] = 1.0f / MIN_CONE_RANGE;
+		m_ConeOuterVolume[a_Index] = UAUDIO_MAX_VOLUME;
+
+		m_Curve[a_Index] = static_cast<int32_t>(ATTENUATION_CURVE::ATTENUATION_CURVE_INVERSE);
+		m_MinDistance[a_Index] = 1.0f;
+		m_MaxDistance[a_Index] = 1000.0f;
+		m_InverseRange[a_Index] = 1.0f / (m_MaxDistance[a_Index] - m_MinDistance[a_Index]);
+		m_Rolloff[a_Index] = 1.0f;
+
+		m_Enabled[a_Index] = 0.0f;
+		m_Volume[a_Index] = 0.0f;
+		m_Panning[a_Index] = 0.0f;
+		m_Front[a_Index] = 0.0f;
+		m_Pitch[a_Index] = 1.0f;
+	}
+
+	/// <summary>
+	/// Calculates the volume, panning and pitch of a range of emitters.
+	/// </summary>
+	/// <param name="a_Begin">The first emitter (multiple of 4).</param>
+	/// <param name="a_End">The end of the range (multiple of 4).</param>
+	void Spatializer::UpdateEmitters(uint32_t a_Begin, uint32_t a_End)
+	{
+		const Vector3 &position = m_Listener.position, &velocity = m_Listener.velocity, &forward = m_Listener.forward;
+		const float speed_of_sound = m_SpeedOfSound, doppler_factor = m_DopplerFactor;
+
+		uint32_t i = a_Begin;
+#if defined(UAUDIO_SPATIALIZER_SSE2)
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), min_distance = _mm_set1_ps(MIN_DISTANCE);
+		const __m128 min_pitch = _mm_set1_ps(UAUDIO_MIN_PITCH), max_pitch = _mm_set1_ps(UAUDIO_MAX_PITCH);
+		const __m128 speed = _mm_set1_ps(speed_of_sound), doppler = _mm_set1_ps(doppler_factor), min_speed = _mm_set1_ps(speed_of_sound * 0.01f);
+		const __m128i inverse_curve = _mm_set1_epi32(static_cast<int32_t>(ATTENUATION_CURVE::ATTENUATION_CURVE_INVERSE));
+		const __m128i linear_curve = _mm_set1_epi32(static_cast<int32_t>(ATTENUATION_CURVE::ATTENUATION_CURVE_LINEAR));
+		const __m128i exponential_curve = _mm_set1_epi32(static_cast<int32_t>(ATTENUATION_CURVE::ATTENUATION_CURVE_EXPONENTIAL));
+		for (; i + EMITTER_GROUP <= a_End; i += EMITTER_GROUP)
+		{
+			// Direction from the listener to the emitter.
+			__m128 x = _mm_sub_ps(_mm_loadu_ps(&m_PositionX[i]), _mm_set1_ps(position.x));
+			__m128 y = _mm_sub_ps(_mm_loadu_ps(&m_PositionY[i]), _mm_set1_ps(position.y));
+			__m128 z = _mm_sub_ps(_mm_loadu_ps(&m_PositionZ[i]), _mm_set1_ps(position.z));
+			const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+			const __m128 has_direction = _mm_cmpgt_ps(distance, min_distance);
+			const __m128 inverse_distance = _mm_and_ps(has_direction, _mm_div_ps(one, _mm_max_ps(distance, min_distance)));
+			x = _mm_mul_ps(x, inverse_distance);
+			y = _mm_mul_ps(y, inverse_distance);
+			z = _mm_mul_ps(z, inverse_distance);
+
+			// Panning and front (the direction in the space of the listener).
+			const __m128 panning = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m_Right.x)), _mm_mul_ps(y, _mm_set1_ps(m_Right.y))), _mm_mul_ps(z, _mm_set1_ps(m_Right.z)));
+			const __m128 front = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(forward.x)), _mm_mul_ps(y, _mm_set1_ps(forward.y))), _mm_mul_ps(z, _mm_set1_ps(forward.z)));
+
+			// Distance attenuation (every curve gets calculated, then the right one gets selected).
+			const __m128 emitter_min = _mm_loadu_ps(&m_MinDistance[i]);
+			const __m128 clamped = Clamp(distance, emitter_min, _mm_loadu_ps(&m_MaxDistance[i]));
+			const __m128 rolloff = _mm_loadu_ps(&m_Rolloff[i]);
+			const __m128 over = _mm_sub_ps(clamped, emitter_min);
+			const __m128 inverse = _mm_div_ps(emitter_min, _mm_add_ps(emitter_min, _mm_mul_ps(rolloff, over)));
+			const __m128 linear = Clamp(_mm_sub_ps(one, _mm_mul_ps(rolloff, _mm_mul_ps(over, _mm_loadu_ps(&m_InverseRange[i])))), zero, one);
+			const __m128 exponential = FastPow2(_mm_mul_ps(_mm_sub_ps(zero, rolloff), FastLog2(_mm_div_ps(clamped, emitter_min))));
+
+			const __m128i curve = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&m_Curve[i]));
+			__m128 volume = one;
+			volume = Select(_mm_castsi128_ps(_mm_cmpeq_epi32(curve, inverse_curve)), inverse, volume);
+			volume = Select(_mm_castsi128_ps(_mm_cmpeq_epi32(curve, linear_curve)), linear, volume);
+			volume = Select(_mm_castsi128_ps(_mm_cmpeq_epi32(curve, exponential_curve)), exponential, volume);
+
+			// Cone (the angle between the direction of the emitter and the direction from the emitter to the listener).
+			// Emitters without a direction get a cosine of 1 (1 - the squared length of the direction), so they are always inside the cone.
+			const __m128 direction_x = _mm_loadu_ps(&m_DirectionX[i]), direction_y = _mm_loadu_ps(&m_DirectionY[i]), direction_z = _mm_loadu_ps(&m_DirectionZ[i]);
+			const __m128 direction_length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(direction_x, direction_x), _mm_mul_ps(direction_y, direction_y)), _mm_mul_ps(direction_z, direction_z));
+			const __m128 cone_cos = _mm_sub_ps(_mm_sub_ps(one, direction_length), _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, direction_x), _mm_mul_ps(y, direction_y)), _mm_mul_ps(z, direction_z)));
+			const __m128 cone_fraction = Clamp(_mm_mul_ps(_mm_sub_ps(cone_cos, _mm_loadu_ps(&m_ConeOuterCos[i])), _mm_loadu_ps(&m_ConeInverseRange[i])), zero, one);
+			const __m128 outer_volume = _mm_loadu_ps(&m_ConeOuterVolume[i]);
+			const __m128 cone = Select(has_direction, _mm_add_ps(outer_volume, _mm_mul_ps(_mm_sub_ps(one, outer_volume), cone_fraction)), one);
+
+			volume = _mm_mul_ps(_mm_mul_ps(volume, cone), _mm_loadu_ps(&m_Enabled[i]));
+
+			// Doppler.
+			const __m128 listener_speed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(velocity.x)), _mm_mul_ps(y, _mm_set1_ps(velocity.y))), _mm_mul_ps(z, _mm_set1_ps(velocity.z)));
+			const __m128 emitter_speed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_loadu_ps(&m_VelocityX[i])), _mm_mul_ps(y, _mm_loadu_ps(&m_VelocityY[i]))), _mm_mul_ps(z, _mm_loadu_ps(&m_VelocityZ[i])));
+			const __m128 pitch = _mm_div_ps(_mm_max_ps(_mm_add_ps(speed, _mm_mul_ps(doppler, listener_speed)), zero), _mm_max_ps(_mm_add_ps(speed, _mm_mul_ps(doppler, emitter_speed)), min_speed));
+
+			_mm_storeu_ps(&m_Volume[i], volume);
+			_mm_storeu_ps(&m_Panning[i], panning);
+			_mm_storeu_ps(&m_Front[i], front);
+			_mm_storeu_ps(&m_Pitch[i], Clamp(pitch, min_pitch, max_pitch));
+		}
+#endif
+		for (; i < a_End; i++)
+		{
+			float x = m_PositionX[i] - position.x, y = m_PositionY[i] - position.y, z = m_PositionZ[i] - position.z;
+			const float distance = std::sqrt(x * x + y * y + z * z);
+			const bool has_direction = distance > MIN_DISTANCE;
+			const float inverse_distance = has_direction ? 1.0f / distance : 0.0f;
+			x *= inverse_distance;
+			y *= inverse_distance;
+			z *= inverse_distance;
+
+			const float emitter_min = m_MinDistance[i];
+			const float clamped = std::min(std::max(distance, emitter_min), m_MaxDistance[i]);
+			float volume = UAUDIO_MAX_VOLUME;
+			switch (static_cast<ATTENUATION_CURVE>(m_Curve[i]))
+			{
+				case ATTENUATION_CURVE::ATTENUATION_CURVE_INVERSE:
+				{
+					volume = emitter_min / (emitter_min + m_Rolloff[i] * (clamped - emitter_min));
+					break;
+				}
+				case ATTENUATION_CURVE::ATTENUATION_CURVE_LINEAR:
+				{
+					volume = utils::clamp(1.0f - m_Rolloff[i] * (clamped - emitter_min) * m_InverseRange[i], 0.0f, 1.0f);
+					break;
+				}
+				case ATTENUATION_CURVE::ATTENUATION_CURVE_EXPONENTIAL:
+				{
+					volume = FastPow2(-m_Rolloff[i] * FastLog2(clamped / emitter_min));
+					break;
+				}
+				default:
+					break;
+			}
+
+			if (has_direction)
+			{
+				const float direction_length = m_DirectionX[i] * m_DirectionX[i] + m_DirectionY[i] * m_DirectionY[i] + m_DirectionZ[i] * m_DirectionZ[i];
+				const float cone_cos = 1.0f - direction_length - (x * m_DirectionX[i] + y * m_DirectionY[i] + z * m_DirectionZ[i]);
+				const float cone_fraction = utils::clamp((cone_cos - m_ConeOuterCos[i]) * m_ConeInverseRange[i], 0.0f, 1.0f);
+				volume *= m_ConeOuterVolume[i] + (1.0f - m_ConeOuterVolume[i]) * cone_fraction;
+			}
+
+			const float listener_speed = x * velocity.x + y * velocity.y + z * velocity.z;
+			const float emitter_speed = x * m_VelocityX[i] + y * m_VelocityY[i] + z * m_VelocityZ[i];
+			const float pitch = std::max(speed_of_sound + doppler_factor * listener_speed, 0.0f) / std::max(speed_of_sound + doppler_factor * emitter_speed, speed_of_sound * 0.01f);
+
+			m_Volume[i] = volume * m_Enabled[i];
+			m_Panning[i] = x * m_Right.x + y * m_Right.y + z * m_Right.z;
+			m_Front[i] = x * forward.x + y * forward.y + z * forward.z;
+			m_Pitch[i] = utils::clamp(pitch, UAUDIO_MIN_PITCH, UAUDIO_MAX_PITCH);
+		}
+	}
+
+	/// <summary>
+	/// Returns whether an emitter handle points to an emitter.
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter.</param>
+	/// <returns></returns>
+	bool Spatializer::IsValid(EmitterHandle a_EmitterHandle) const
+	{
+		return a_EmitterHandle.IsValid() && a_EmitterHandle < static_cast<int32_t>(m_NumEmitters) && m_Enabled[a_EmitterHandle] != 0.0f;
+	}
+}
@@ -0,0 +1,381 @@
+#include <uaudio/Streamer.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include <uaudio/utils/Logger.h>
+#include <uaudio/wave/high_level/WaveChunks.h>
+#include <uaudio/wave/high_level/WaveFile.h>
+
+namespace uaudio
+{
+	// The states of a stream.
+	constexpr uint32_t STREAM_FREE = 0;
+	constexpr uint32_t STREAM_OPEN = 1;
+	constexpr uint32_t STREAM_CLOSING = 2;
+
+	// The generation of a seek request (the position is in the low 32 bits).
+	constexpr uint32_t SEEK_GENERATION_SHIFT = 32;
+
+	/// <summary>
+	/// Creates the slots of the streams (the rings get allocated when a slot gets opened for the first time).
+	/// </summary>
+	/// <param name="a_MaxStreams">The amount of streams that can be open at the same time.</param>
+	/// <param name="a_Threaded">Whether the streams get filled by a thread of their own (otherwise Update needs to be called).</param>
+	Streamer::Streamer(uint32_t a_MaxStreams, bool a_Threaded) : m_Streams(a_MaxStreams), m_Threaded(a_Threaded)
+	{
+	}
+
+	Streamer::~Streamer()
+	{
+		if (m_Thread.joinable())
+		{
+			m_Running = false;
+			m_Wait.notify_one();
+			m_Thread.join();
+		}
+
+		for (Stream &stream : m_Streams)
+			stream.file.Close();
+	}
+
+	/// <summary>
+	/// Opens a stream for a sound that was loaded with the stream setting and fills its ring.
+	/// </summary>
+	/// <param name="a_WaveFile">The sound.</param>
+	/// <returns>The handle of the stream (invalid if the sound does not stream, the file cannot be opened or all streams are in use).</returns>
+	StreamHandle Streamer::Open(const WaveFile &a_WaveFile)
+	{
+		const WaveFormat &wave_format = a_WaveFile.GetWaveFormat();
+		if (!wave_format.IsStreaming() || wave_format.m_FilePath == nullptr)
+			return StreamHandle();
+
+		std::lock_guard<std::mutex> lock(m_OpenMutex);
+
+		uint32_t index = 0;
+		while (index < m_Streams.size() && m_Streams[index].state.load(std::memory_order_acquire) != STREAM_FREE)
+			index++;
+		if (index == m_Streams.size())
+		{
+			logger::log_warning("<Streamer> All %i streams are in use, (%s\"%s\"%s) cannot be played.", static_cast<int>(m_Streams.size()), logger::COLOR_YELLOW, wave_format.m_FilePath, logger::COLOR_WHITE);
+			return StreamHandle();
+		}
+
+		// The blocks get read at their offset in the file, without a file position or a buffer of the file in between.
+		Stream &stream = m_Streams[index];
+		if (!stream.file.Open(wave_format.m_FilePath))
+		{
+			logger::log_warning("<Streamer> Failed opening file: (%s\"%s%s\").", logger::COLOR_YELLOW, wave_format.m_FilePath, logger::COLOR_WHITE);
+			return StreamHandle();
+		}
+
+		const FMT_Chunk &fmt_chunk = a_WaveFile.GetFmtChunk();
+		stream.dataOffset = wave_format.GetStreamOffset();
+		stream.dataSize = wave_format.GetDataSize();
+		stream.blockAlign = std::max<uint32_t>(fmt_chunk.blockAlign, 1);
+
+		// Blocks hold whole frames.
+		stream.blockSize = std::max(UAUDIO_DEFAULT_STREAM_BLOCK_SIZE - UAUDIO_DEFAULT_STREAM_BLOCK_SIZE % stream.blockAlign, stream.blockAlign);
+		stream.data.resize(static_cast<size_t>(stream.blockSize) * UAUDIO_DEFAULT_STREAM_BLOCKS);
+		stream.blocks.resize(UAUDIO_DEFAULT_STREAM_BLOCKS);
+
+		stream.endPosition = std::min(a_WaveFile.GetEndPosition(), stream.dataSize);
+		stream.startPosition = std::min(a_WaveFile.GetStartPosition(), stream.endPosition);
+		stream.looping = a_WaveFile.IsLooping();
+
+		stream.seek = stream.startPosition;
+		stream.fileGeneration = 0;
+		stream.filePosition = stream.startPosition;
+		stream.endOfData = false;
+		stream.written = 0;
+		stream.read = 0;
+		stream.readGeneration = 0;
+		stream.readOffset = 0;
+		stream.position = stream.startPosition;
+		stream.seeking = false;
+		stream.finished = false;
+		stream.underruns = 0;
+
+		// The I/O thread does not see the stream yet, so this thread can fill it.
+		Fill(stream);
+		stream.state.store(STREAM_OPEN, std::memory_order_release);
+
+		if (m_Threaded && !m_Thread.joinable())
+		{
+			m_Running = true;
+			m_Thread = std::thread(&Streamer::Run, this);
+		}
+		return StreamHandle(static_cast<int32_t>(index));
+	}
+
+	/// <summary>
+	/// Closes a stream (the file gets closed on the I/O thread).
+	/// </summary>
+	/// <param name="a_StreamHandle">The stream.</param>
+	void Streamer::Close(StreamHandle a_StreamHandle)
+	{
+		if (!IsValid(a_StreamHandle))
+			return;
+
+		Stream &stream = m_Streams[a_StreamHandle];
+
+		// Without a thread nothing else uses the stream.
+		if (!m_Threaded)
+		{
+			stream.file.Close();
+			stream.state.store(STREAM_FREE, std::memory_order_release);
+			return;
+		}
+
+		stream.state.store(STREAM_CLOSING, std::memory_order_release);
+		m_Wait.notify_one();
+	}
+
+	/// <summary>
+	/// Returns the amount of streams that are in use.
+	/// </summary>
+	/// <returns>The amount of streams.</returns>
+	uint32_t Streamer::StreamSize() const
+	{
+		uint32_t size = 0;
+		for (const Stream &stream : m_Streams)
+			if (stream.state.load(std::memory_order_relaxed) != STREAM_FREE)
+				size++;
+		return size;
+	}
+
+	/// <summary>
+	/// Reads the next bytes of a stream from its ring.
+	/// </summary>
+	/// <param name="a_StreamHandle">The stream.</param>
+	/// <param name="a_DataBuffer">The buffer that the bytes get copied to.</param>
+	/// <param name="a_Size">The amount of bytes (rounded down to whole frames).</param>
+	/// <param name="a_Position">The position in the data after the bytes that were read (the play cursor).</param>
+	/// <returns>The amount of bytes that were read (less than the size at the end of the sound or when the ring ran out).</returns>
+	uint32_t Streamer::Read(StreamHandle a_StreamHandle, unsigned char *a_DataBuffer, uint32_t a_Size, uint32_t &a_Position)
+	{
+		if (!IsValid(a_StreamHandle))
+			return 0;
+
+		Stream &stream = m_Streams[a_StreamHandle];
+		a_Size -= a_Size % stream.blockAlign;
+
+		// A seek that was requested since the last read moves the cursor (the blocks of the new position are on their way).
+		const uint64_t seek = stream.seek.load(std::memory_order_acquire);
+		const uint32_t generation = static_cast<uint32_t>(seek >> SEEK_GENERATION_SHIFT);
+		if (generation != stream.readGeneration)
+		{
+			stream.readGeneration = generation;
+			stream.readOffset = 0;
+			stream.position = static_cast<uint32_t>(seek);
+			stream.seeking = true;
+			stream.finished.store(false, std::memory_order_relaxed);
+		}
+
+		uint32_t size = 0;
+		bool played_block = false;
+		while (size < a_Size && !stream.finished)
+		{
+			const uint64_t read = stream.read.load(std::memory_order_relaxed);
+			if (read == stream.written.load(std::memory_order_acquire))
+				break;
+
+			const uint32_t index = static_cast<uint32_t>(read % stream.blocks.size());
+			const StreamBlock &block = stream.blocks[index];
+
+			// Blocks from before a seek get skipped.
+			if (block.generation == generation)
+			{
+				const uint32_t count = std::min(a_Size - size, block.size - stream.readOffset);
+				UAUDIO_DEFAULT_MEMCPY(a_DataBuffer + size, stream.data.data() + static_cast<size_t>(index) * stream.blockSize + stream.readOffset, count);
+				size += count;
+				stream.readOffset += count;
+				stream.position = block.position + stream.readOffset;
+				stream.seeking = false;
+				if (stream.readOffset < block.size)
+					continue;
+				stream.finished.store(block.last, std::memory_order_relaxed);
+			}
+
+			stream.readOffset = 0;
+			stream.read.store(read + 1, std::memory_order_release);
+			played_block = true;
+		}
+
+		// The ring ran out before the end of the sound (the first blocks after a seek are still on their way, that is not an underrun).
+		if (size < a_Size && !stream.finished && !stream.seeking)
+			stream.underruns.fetch_add(1, std::memory_order_relaxed);
+
+		if (played_block)
+			m_Wait.notify_one();
+
+		a_Position = stream.position;
+		return size;
+	}
+
+	/// <summary>
+	/// Requests a new play cursor for a stream. The reader moves to it on its next read (skipping the blocks that were read ahead), the I/O thread reads from there.
+	/// </summary>
+	/// <param name="a_StreamHandle">The stream.</param>
+	/// <param name="a_Position">The position in the data (rounded down to a whole frame).</param>
+	void Streamer::Seek(StreamHandle a_StreamHandle, uint32_t a_Position)
+	{
+		if (!IsValid(a_StreamHandle))
+			return;
+
+		Stream &stream = m_Streams[a_StreamHandle];
+		a_Position = std::min(a_Position, stream.dataSize);
+		a_Position -= a_Position % stream.blockAlign;
+
+		// The generation and the position go in one store, so nobody sees the new generation with the old position.
+		uint64_t seek = stream.seek.load(std::memory_order_relaxed);
+		uint64_t request = 0;
+		do
+			request = (((seek >> SEEK_GENERATION_SHIFT) + 1) << SEEK_GENERATION_SHIFT) | a_Position;
+		while (!stream.seek.compare_exchange_weak(seek, request, std::memory_order_release, std::memory_order_relaxed));
+		m_Wait.notify_one();
+	}
+
+	/// <summary>
+	/// Sets whether the stream goes back to the start position after the end position (blocks that were already read ahead stay as they are).
+	/// </summary>
+	/// <param name="a_StreamHandle">The stream.</param>
+	/// <param name="a_Looping">Whether the stream loops.</param>
+	void Streamer::SetLooping(StreamHandle a_StreamHandle, bool a_Looping)
+	{
+		if (!IsValid(a_StreamHandle))
+			return;
+
+		m_Streams[a_StreamHandle].looping.store(a_Looping, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Returns whether the reader has read the end of the sound.
+	/// </summary>
+	/// <param name="a_StreamHandle">The stream.</param>
+	/// <returns>Whether the stream is done.</returns>
+	bool Streamer::IsFinished(StreamHandle a_StreamHandle) const
+	{
+		if (!IsValid(a_StreamHandle))
+			return true;
+
+		return m_Streams[a_StreamHandle].finished.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Returns how many times a stream had fewer bytes than the reader wanted.
+	/// </summary>
+	/// <param name="a_StreamHandle">The stream.</param>
+	/// <returns>The amount of underruns since the stream was opened.</returns>
+	uint32_t Streamer::GetUnderruns(StreamHandle a_StreamHandle) const
+	{
+		if (!IsValid(a_StreamHandle))
+			return 0;
+
+		return m_Streams[a_StreamHandle].underruns.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Returns the underruns of all open streams.
+	/// </summary>
+	/// <returns>The amount of underruns.</returns>
+	uint32_t Streamer::GetUnderruns() const
+	{
+		uint32_t underruns = 0;
+		for (const Stream &stream : m_Streams)
+			if (stream.state.load(std::memory_order_relaxed) == STREAM_OPEN)
+				underruns += stream.underruns.load(std::memory_order_relaxed);
+		return underruns;
+	}
+
+	/// <summary>
+	/// Fills the free blocks of the open streams and closes the streams that were closed.
+	/// </summary>
+	void Streamer::Update()
+	{
+		for (Stream &stream : m_Streams)
+		{
+			const uint32_t state = stream.state.load(std::memory_order_acquire);
+			if (state == STREAM_OPEN)
+				Fill(stream);
+			else if (state == STREAM_CLOSING)
+			{
+				stream.file.Close();
+				stream.state.store(STREAM_FREE, std::memory_order_release);
+			}
+		}
+	}
+
+	/// <summary>
+	/// The I/O thread.
+	/// </summary>
+	void Streamer::Run()
+	{
+		const std::chrono::milliseconds interval(UAUDIO_DEFAULT_STREAMER_INTERVAL);
+		while (m_Running.load(std::memory_order_relaxed))
+		{
+			Update();
+
+			std::unique_lock<std::mutex> lock(m_WaitMutex);
+			m_Wait.wait_for(lock, interval);
+		}
+	}
+
+	/// <summary>
+	/// Reads blocks from the file until the ring is full or the sound has ended.
+	/// </summary>
+	/// <param name="a_Stream">The stream.</param>
+	void Streamer::Fill(Stream &a_Stream)
+	{
+		// A seek: the blocks start over at the new position.
+		const uint64_t seek = a_Stream.seek.load(std::memory_order_acquire);
+		const uint32_t generation = static_cast<uint32_t>(seek >> SEEK_GENERATION_SHIFT);
+		if (generation != a_Stream.fileGeneration)
+		{
+			a_Stream.fileGeneration = generation;
+			a_Stream.filePosition = static_cast<uint32_t>(seek);
+			a_Stream.endOfData = false;
+		}
+
+		const uint32_t num_blocks = static_cast<uint32_t>(a_Stream.blocks.size());
+		while (!a_Stream.endOfData)
+		{
+			const uint64_t written = a_Stream.written.load(std::memory_order_relaxed);
+			if (written - a_Stream.read.load(std::memory_order_acquire) >= num_blocks)
+				return;
+
+			const bool looping = a_Stream.looping.load(std::memory_order_relaxed);
+			if (looping && a_Stream.filePosition >= a_Stream.endPosition)
+				a_Stream.filePosition = a_Stream.startPosition;
+
+			const uint32_t index = static_cast<uint32_t>(written % num_blocks);
+			StreamBlock &block = a_Stream.blocks[index];
+			block.position = a_Stream.filePosition;
+			block.generation = generation;
+			block.size = 0;
+			if (a_Stream.filePosition < a_Stream.endPosition)
+			{
+				const uint32_t size = std::min(a_Stream.blockSize, a_Stream.endPosition - a_Stream.filePosition);
+				block.size = static_cast<uint32_t>(a_Stream.file.Read(static_cast<uint64_t>(a_Stream.dataOffset) + a_Stream.filePosition, a_Stream.data.data() + static_cast<size_t>(index) * a_Stream.blockSize, size));
+				block.size -= block.size % a_Stream.blockAlign;
+			}
+			a_Stream.filePosition += block.size;
+
+			// A file that is shorter than its data chunk ends early as well.
+			block.last = block.size == 0 || (!looping && a_Stream.filePosition >= a_Stream.endPosition);
+			a_Stream.endOfData = block.last;
+
+			a_Stream.written.store(written + 1, std::memory_order_release);
+		}
+	}
+
+	/// <summary>
+	/// Returns whether a handle belongs to an open stream.
+	/// </summary>
+	/// <param name="a_StreamHandle">The stream.</param>
+	/// <returns>Whether the stream is open.</returns>
+	bool Streamer::IsValid(StreamHandle a_StreamHandle) const
+	{
+		return a_StreamHandle.IsValid() && static_cast<uint32_t>(a_StreamHandle) < m_Streams.size() && m_Streams[a_StreamHandle].state.load(std::memory_order_relaxed) == STREAM_OPEN;
+	}
+}
@@ -0,0 +1,94 @@
+#include <uaudio/utils/Denormals.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UAUDIO_DENORMALS_SSE
+	#include <xmmintrin.h>
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+	#define UAUDIO_DENORMALS_ARM64
+#endif
+
+namespace uaudio::utils
+{
+#if defined(UAUDIO_DENORMALS_SSE)
+	// Flush to zero and denormals are zero.
+	constexpr uint64_t DENORMAL_FLAGS = 0x8040;
+#elif defined(UAUDIO_DENORMALS_ARM64)
+	// Flush to zero.
+	constexpr uint64_t DENORMAL_FLAGS = 1ull << 24;
+#endif
+
+	namespace
+	{
+		/// <summary>
+		/// Returns the floating point mode of the current thread.
+		/// </summary>
+		/// <returns>The control register (0 when the platform is not supported).</returns>
+		uint64_t GetMode()
+		{
+#if defined(UAUDIO_DENORMALS_SSE)
+			return _mm_getcsr();
+#elif defined(UAUDIO_DENORMALS_ARM64)
+			uint64_t mode = 0;
+			asm volatile("mrs %0, fpcr" : "=r"(mode));
+			return mode;
+#else
+			return 0;
+#endif
+		}
+
+		/// <summary>
+		/// Sets the floating point mode of the current thread.
+		/// </summary>
+		/// <param name="a_Mode">The control register.</param>
+		void SetMode(uint64_t a_Mode)
+		{
+#if defined(UAUDIO_DENORMALS_SSE)
+			_mm_setcsr(static_cast<unsigned int>(a_Mode));
+#elif defined(UAUDIO_DENORMALS_ARM64)
+			asm volatile("msr fpcr, %0" : : "r"(a_Mode));
+#else
+			(void)a_Mode;
+#endif
+		}
+	}
+
+	/// <summary>
+	/// Turns off denormals on the current thread.
+	/// </summary>
+	/// <param name="a_Enabled">Whether the guard does anything.</param>
+	DenormalGuard::DenormalGuard(bool a_Enabled) : m_Enabled(a_Enabled)
+	{
+#if defined(UAUDIO_DENORMALS_SSE) || defined(UAUDIO_DENORMALS_ARM64)
+		if (!m_Enabled)
+			return;
+
+		m_Mode = GetMode();
+		if ((m_Mode & DENORMAL_FLAGS) != DENORMAL_FLAGS)
+			SetMode(m_Mode | DENORMAL_FLAGS);
+#endif
+	}
+
+	/// <summary>
+	/// Sets the mode of the thread back to what it was.
+	/// </summary>
+	DenormalGuard::~DenormalGuard()
+	{
+#if defined(UAUDIO_DENORMALS_SSE) || defined(UAUDIO_DENORMALS_ARM64)
+		if (m_Enabled && (m_Mode & DENORMAL_FLAGS) != DENORMAL_FLAGS)
+			SetMode(m_Mode);
+#endif
+	}
+
+	/// <summary>
+	/// Returns whether the current thread flushes denormals to zero.
+	/// </summary>
+	/// <returns>Whether denormals are turned off.</returns>
+	bool DenormalGuard::IsFlushing()
+	{
+#if defined(UAUDIO_DENORMALS_SSE) || defined(UAUDIO_DENORMALS_ARM64)
+		return (GetMode() & DENORMAL_FLAGS) == DENORMAL_FLAGS;
+#else
+		return false;
+#endif
+	}
+}
@@ -0,0 +1,205 @@
+#include <uaudio/utils/FileReader.h>
+
+#include <algorithm>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+namespace uaudio::utils
+{
+	FileReader::~FileReader()
+	{
+		Close();
+	}
+
+	/// <summary>
+	/// Opens a file for reading and gets its size.
+	/// </summary>
+	/// <param name="a_FilePath">The path to the file.</param>
+	/// <returns>Whether the file got opened.</returns>
+	bool FileReader::Open(const char *a_FilePath)
+	{
+		Close();
+		m_NumCalls = 0;
+
+#if defined(_WIN32)
+		m_NumCalls++;
+		m_File = CreateFileA(a_FilePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_File == INVALID_HANDLE_VALUE)
+		{
+			m_File = nullptr;
+			return false;
+		}
+
+		m_NumCalls++;
+		LARGE_INTEGER size = {};
+		if (!GetFileSizeEx(m_File, &size))
+		{
+			Close();
+			return false;
+		}
+		m_Size = static_cast<uint64_t>(size.QuadPart);
+#else
+		m_NumCalls++;
+		m_File = open(a_FilePath, O_RDONLY);
+		if (m_File == -1)
+			return false;
+
+		m_NumCalls++;
+		struct stat status = {};
+		if (fstat(m_File, &status) != 0)
+		{
+			Close();
+			return false;
+		}
+		m_Size = static_cast<uint64_t>(status.st_size);
+#endif
+		return true;
+	}
+
+	/// <summary>
+	/// Closes the file.
+	/// </summary>
+	void FileReader::Close()
+	{
+#if defined(_WIN32)
+		if (m_File != nullptr)
+		{
+			m_NumCalls++;
+			CloseHandle(m_File);
+		}
+		m_File = nullptr;
+#else
+		if (m_File != -1)
+		{
+			m_NumCalls++;
+			close(m_File);
+		}
+		m_File = -1;
+#endif
+		m_Size = 0;
+	}
+
+	/// <summary>
+	/// Returns whether a file is open.
+	/// </summary>
+	/// <returns></returns>
+	bool FileReader::IsOpen() const
+	{
+#if defined(_WIN32)
+		return m_File != nullptr;
+#else
+		return m_File != -1;
+#endif
+	}
+
+	/// <summary>
+	/// Returns the size of the file.
+	/// </summary>
+	/// <returns>The size (in bytes).</returns>
+	uint64_t FileReader::GetSize() const
+	{
+		return m_Size;
+	}
+
+	/// <summary>
+	/// Returns the amount of system calls since the file was opened (including the open).
+	/// </summary>
+	/// <returns></returns>
+	uint32_t FileReader::GetNumCalls() const
+	{
+		return m_NumCalls;
+	}
+
+	/// <summary>
+	/// Reads a part of the file.
+	/// </summary>
+	/// <param name="a_Offset">Where the part starts in the file (in bytes).</param>
+	/// <param name="a_Data">The buffer.</param>
+	/// <param name="a_Size">The size of the part (in bytes).</param>
+	/// <returns>The amount of bytes that got read (less at the end of the file).</returns>
+	size_t FileReader::Read(uint64_t a_Offset, void *a_Data, size_t a_Size)
+	{
+		FileBuffer buffer;
+		buffer.data = a_Data;
+		buffer.size = a_Size;
+		return ReadScattered(a_Offset, &buffer, 1);
+	}
+
+	/// <summary>
+	/// Reads a part of the file into multiple buffers, one after another.
+	/// </summary>
+	/// <param name="a_Offset">Where the part starts in the file (in bytes).</param>
+	/// <param name="a_Buffers">The buffers.</param>
+	/// <param name="a_NumBuffers">The amount of buffers.</param>
+	/// <returns>The amount of bytes that got read (less at the end of the file).</returns>
+	size_t FileReader::ReadScattered(uint64_t a_Offset, const FileBuffer *a_Buffers, uint32_t a_NumBuffers)
+	{
+		if (!IsOpen())
+			return 0;
+
+		size_t total = 0;
+#if defined(_WIN32)
+		for (uint32_t i = 0; i < a_NumBuffers; i++)
+		{
+			size_t done = 0;
+			while (done < a_Buffers[i].size)
+			{
+				// Reads past the end of the file do not need a call to find out that there is nothing.
+				const uint64_t offset = a_Offset + total + done;
+				if (offset >= m_Size)
+					return total + done;
+
+				OVERLAPPED overlapped = {};
+				overlapped.Offset = static_cast<DWORD>(offset);
+				overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+				DWORD read = 0;
+				const DWORD size = static_cast<DWORD>(std::min<size_t>(a_Buffers[i].size - done, MAXDWORD));
+				m_NumCalls++;
+				if (!ReadFile(m_File, reinterpret_cast<unsigned char *>(a_Buffers[i].data) + done, size, &read, &overlapped) || read == 0)
+					return total + done;
+				done += read;
+			}
+			total += done;
+		}
+#else
+		// A short read (a signal or a very large read) continues where it stopped. Reads past the end of the file do not need a call to find out that there is nothing.
+		uint32_t first = 0;
+		size_t first_done = 0;
+		while (first < a_NumBuffers && a_Offset + total < m_Size)
+		{
+			iovec buffers[FILE_READER_MAX_BUFFERS];
+			uint32_t count = 0;
+			for (uint32_t i = first; i < a_NumBuffers && count < FILE_READER_MAX_BUFFERS; i++, count++)
+			{
+				const size_t skip = i == first ? first_done : 0;
+				buffers[count].iov_base = reinterpret_cast<unsigned char *>(a_Buffers[i].data) + skip;
+				buffers[count].iov_len = a_Buffers[i].size - skip;
+			}
+
+			m_NumCalls++;
+			const ssize_t read = preadv(m_File, buffers, static_cast<int>(count), static_cast<off_t>(a_Offset + total));
+			if (read <= 0)
+				return total;
+
+			total += static_cast<size_t>(read);
+			size_t left = static_cast<size_t>(read);
+			while (first < a_NumBuffers && left >= a_Buffers[first].size - first_done)
+			{
+				left -= a_Buffers[first].size - first_done;
+				first_done = 0;
+				first++;
+			}
+			first_done += left;
+		}
+#endif
+		return total;
+	}
+}
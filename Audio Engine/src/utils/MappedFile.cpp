@@ -0,0 +1,172 @@
+#include <uaudio/utils/MappedFile.h>
+
+#include <algorithm>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace uaudio::utils
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	/// <summary>
+	/// Maps a file into memory (nothing gets read yet).
+	/// </summary>
+	/// <param name="a_FilePath">The path to the file.</param>
+	/// <returns>Whether the file got mapped (an empty file cannot be mapped).</returns>
+	bool MappedFile::Open(const char *a_FilePath)
+	{
+		Close();
+
+#if defined(_WIN32)
+		m_File = CreateFileA(a_FilePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_File == INVALID_HANDLE_VALUE)
+		{
+			m_File = nullptr;
+			return false;
+		}
+
+		LARGE_INTEGER size = {};
+		if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		// Write copy, so that chunks can be changed in place without changing the file.
+		m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (m_Mapping == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		m_Data = reinterpret_cast<unsigned char *>(MapViewOfFile(m_Mapping, FILE_MAP_COPY, 0, 0, 0));
+		if (m_Data == nullptr)
+		{
+			Close();
+			return false;
+		}
+		m_Size = static_cast<size_t>(size.QuadPart);
+#else
+		const int file = open(a_FilePath, O_RDONLY);
+		if (file == -1)
+			return false;
+
+		struct stat status = {};
+		if (fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// Private, so that chunks can be changed in place without changing the file. The mapping stays after the file gets closed.
+		void *data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		m_Data = reinterpret_cast<unsigned char *>(data);
+		m_Size = static_cast<size_t>(status.st_size);
+#endif
+		return true;
+	}
+
+	/// <summary>
+	/// Unmaps the file (every pointer into it becomes invalid).
+	/// </summary>
+	void MappedFile::Close()
+	{
+#if defined(_WIN32)
+		if (m_Data != nullptr)
+			UnmapViewOfFile(m_Data);
+		if (m_Mapping != nullptr)
+			CloseHandle(m_Mapping);
+		if (m_File != nullptr)
+			CloseHandle(m_File);
+		m_Mapping = nullptr;
+		m_File = nullptr;
+#else
+		if (m_Data != nullptr)
+			munmap(m_Data, m_Size);
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	/// <summary>
+	/// Returns whether a file is mapped.
+	/// </summary>
+	/// <returns></returns>
+	bool MappedFile::IsOpen() const
+	{
+		return m_Data != nullptr;
+	}
+
+	/// <summary>
+	/// Returns the start of the mapped file.
+	/// </summary>
+	/// <returns>The first byte of the file (nullptr if nothing is mapped).</returns>
+	unsigned char *MappedFile::GetData() const
+	{
+		return m_Data;
+	}
+
+	/// <summary>
+	/// Returns the size of the mapped file.
+	/// </summary>
+	/// <returns>The size (in bytes).</returns>
+	size_t MappedFile::GetSize() const
+	{
+		return m_Size;
+	}
+
+	/// <summary>
+	/// Returns whether a pointer points into the mapped file.
+	/// </summary>
+	/// <param name="a_Pointer">The pointer.</param>
+	/// <returns></returns>
+	bool MappedFile::Contains(const void *a_Pointer) const
+	{
+		const unsigned char *pointer = reinterpret_cast<const unsigned char *>(a_Pointer);
+		return m_Data != nullptr && pointer >= m_Data && pointer < m_Data + m_Size;
+	}
+
+	/// <summary>
+	/// Asks the system to read a range of the file in the background (it is a hint, it does not wait).
+	/// </summary>
+	/// <param name="a_Offset">The start of the range in the file (in bytes).</param>
+	/// <param name="a_Size">The size of the range (gets cut off at the end of the file).</param>
+	void MappedFile::Prefetch(size_t a_Offset, size_t a_Size) const
+	{
+		if (m_Data == nullptr || a_Offset >= m_Size)
+			return;
+
+		a_Size = std::min(a_Size, m_Size - a_Offset);
+		if (a_Size == 0)
+			return;
+
+#if defined(_WIN32)
+	#if _WIN32_WINNT >= 0x0602
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = m_Data + a_Offset;
+		range.NumberOfBytes = a_Size;
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	#endif
+#else
+		// madvise wants the start of a page.
+		const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		const size_t start = a_Offset - a_Offset % page_size;
+		madvise(m_Data + start, a_Size + (a_Offset - start), MADV_WILLNEED);
+#endif
+	}
+}
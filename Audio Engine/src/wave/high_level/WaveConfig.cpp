@@ -6,7 +6,7 @@ namespace uaudio
 {
 	WaveConfig::WaveConfig() = default;
 
-	WaveConfig::WaveConfig(const WaveConfig& rhs) : chunksToLoad(rhs.chunksToLoad), numChannels(rhs.numChannels), bitsPerSample(rhs.bitsPerSample), setLoopPoints(rhs.setLoopPoints)
+	WaveConfig::WaveConfig(const WaveConfig& rhs) : chunksToLoad(rhs.chunksToLoad), numChannels(rhs.numChannels), channelMask(rhs.channelMask), bitsPerSample(rhs.bitsPerSample), sampleRate(rhs.sampleRate), tempo(rhs.tempo), dither(rhs.dither), setLoopPoints(rhs.setLoopPoints), trimSilence(rhs.trimSilence), silenceThreshold(rhs.silenceThreshold), releaseTrimmedMemory(rhs.releaseTrimmedMemory), normalize(rhs.normalize), targetLoudness(rhs.targetLoudness), maxTruePeak(rhs.maxTruePeak), memoryMap(rhs.memoryMap), stream(rhs.stream), conversionThreads(rhs.conversionThreads)
 	{ }
 
 	WaveConfig& WaveConfig::operator=(const WaveConfig& rhs)
@@ -15,8 +15,21 @@ namespace uaudio
 		{
 			chunksToLoad = rhs.chunksToLoad;
 			numChannels = rhs.numChannels;
+			channelMask = rhs.channelMask;
 			bitsPerSample = rhs.bitsPerSample;
+			sampleRate = rhs.sampleRate;
+			tempo = rhs.tempo;
+			dither = rhs.dither;
 			setLoopPoints = rhs.setLoopPoints;
+			trimSilence = rhs.trimSilence;
+			silenceThreshold = rhs.silenceThreshold;
+			releaseTrimmedMemory = rhs.releaseTrimmedMemory;
+			normalize = rhs.normalize;
+			targetLoudness = rhs.targetLoudness;
+			maxTruePeak = rhs.maxTruePeak;
+			memoryMap = rhs.memoryMap;
+			stream = rhs.stream;
+			conversionThreads = rhs.conversionThreads;
 		}
 		return *this;
 	}
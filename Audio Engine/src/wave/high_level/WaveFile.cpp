@@ -1,5 +1,8 @@
 #include <uaudio/wave/high_level/WaveFile.h>
 
+#include <algorithm>
+#include <utility>
+
 #include <uaudio/utils/Utils.h>
 #include <uaudio/wave/low_level/WaveConverter.h>
 #include <uaudio/wave/low_level/WaveReader.h>
@@ -14,15 +17,38 @@ namespace uaudio
     {
         m_WaveFormat = {};
         WaveReader::LoadSound(a_FilePath, m_WaveFormat, m_File, a_WaveConfig);
+
+        m_EndPosition = m_WaveFormat.GetDataSize();
+
+        // The data of a streamed sound is not in memory to scan.
+        if (a_WaveConfig.trimSilence && !m_WaveFormat.IsStreaming())
+            TrimSilence(a_WaveConfig.silenceThreshold, a_WaveConfig.releaseTrimmedMemory);
+        if (a_WaveConfig.normalize && !m_WaveFormat.IsStreaming())
+            Normalize(a_WaveConfig.targetLoudness, a_WaveConfig.maxTruePeak);
+        SetLoopPoints(a_WaveConfig.setLoopPoints);
+        UpdateChunkCache();
     }
 
     WaveFile::WaveFile(const WaveFile &rhs)
     {
         m_Looping = rhs.m_Looping;
         m_Volume = rhs.m_Volume;
+        m_NormalizationGain = rhs.m_NormalizationGain;
+        m_HasLoudness = rhs.m_HasLoudness;
+        m_Loudness = rhs.m_Loudness;
         m_WaveFormat = rhs.m_WaveFormat;
         m_StartPosition = rhs.m_StartPosition;
         m_EndPosition = rhs.m_EndPosition;
+        UpdateChunkCache();
+    }
+
+    /// <summary>
+    /// Takes over the data of another sound (without copying it).
+    /// </summary>
+    /// <param name="rhs">The sound.</param>
+    WaveFile::WaveFile(WaveFile &&rhs) noexcept
+    {
+        *this = std::move(rhs);
     }
 
     WaveFile &WaveFile::operator=(const WaveFile &rhs)
@@ -31,9 +57,40 @@ namespace uaudio
         {
             m_Looping = rhs.m_Looping;
             m_Volume = rhs.m_Volume;
+            m_NormalizationGain = rhs.m_NormalizationGain;
+            m_HasLoudness = rhs.m_HasLoudness;
+            m_Loudness = rhs.m_Loudness;
             m_WaveFormat = rhs.m_WaveFormat;
             m_StartPosition = rhs.m_StartPosition;
             m_EndPosition = rhs.m_EndPosition;
+            UpdateChunkCache();
+        }
+        return *this;
+    }
+
+    /// <summary>
+    /// Takes over the data of another sound (without copying it).
+    /// </summary>
+    /// <param name="rhs">The sound.</param>
+    /// <returns>The sound.</returns>
+    WaveFile &WaveFile::operator=(WaveFile &&rhs) noexcept
+    {
+        if (&rhs != this)
+        {
+            m_Looping = rhs.m_Looping;
+            m_Volume = rhs.m_Volume;
+            m_NormalizationGain = rhs.m_NormalizationGain;
+            m_HasLoudness = rhs.m_HasLoudness;
+            m_Loudness = rhs.m_Loudness;
+            m_WaveFormat = std::move(rhs.m_WaveFormat);
+            m_StartPosition = rhs.m_StartPosition;
+            m_EndPosition = rhs.m_EndPosition;
+
+            // The chunks moved along, so the cache still points at them.
+            m_FmtChunk = rhs.m_FmtChunk;
+            m_Data = rhs.m_Data;
+            m_DataSize = rhs.m_DataSize;
+            rhs.UpdateChunkCache();
         }
         return *this;
     }
@@ -43,16 +100,23 @@ namespace uaudio
     /// </summary>
     /// <param name="a_StartingPoint">The starting point of where to read from.</param>
     /// <param name="a_ElementCount">The element count of which to search for (will be reduced when reaching end of file)</param>
-    /// <param name="a_DataBuffer">The buffer that will store the data.</param>
+    /// <param name="a_DataBuffer">The buffer that will store the data (nullptr for a streamed sound, see Streamer).</param>
     void WaveFile::Read(uint32_t a_StartingPoint, uint32_t &a_ElementCount, unsigned char *&a_DataBuffer) const
     {
+        if (m_WaveFormat.IsStreaming())
+        {
+            a_ElementCount = 0;
+            a_DataBuffer = nullptr;
+            return;
+        }
+
         // NOTE: This part will reduce the size of the buffer array. It is necessary when reaching the end of the file if we want to loop it.
-        if (a_StartingPoint + a_ElementCount >= m_WaveFormat.GetChunkSize(DATA_CHUNK_ID))
+        if (a_StartingPoint + a_ElementCount >= m_DataSize)
         {
-            const uint32_t new_size = a_ElementCount - ((a_StartingPoint + a_ElementCount) - m_WaveFormat.GetChunkSize(DATA_CHUNK_ID));
+            const uint32_t new_size = a_ElementCount - ((a_StartingPoint + a_ElementCount) - m_DataSize);
             a_ElementCount = new_size;
         }
-        a_DataBuffer = m_WaveFormat.GetChunkFromData<DATA_Chunk>(DATA_CHUNK_ID).data + a_StartingPoint;
+        a_DataBuffer = m_Data + a_StartingPoint;
     }
 
     /// <summary>
@@ -101,13 +165,49 @@ namespace uaudio
         return m_Volume;
     }
 
+    /// <summary>
+    /// Sets the gain that brings the sound to a loudness (the channels apply it along with the volume).
+    /// </summary>
+    /// <param name="a_Gain">The gain (a volume, it can go above 1).</param>
+    void WaveFile::SetNormalizationGain(float a_Gain)
+    {
+        m_NormalizationGain = std::max(a_Gain, 0.0f);
+    }
+
+    /// <summary>
+    /// Returns the gain that brings the sound to the loudness of the config.
+    /// </summary>
+    /// <returns>The gain (1 if the sound was not normalized).</returns>
+    float WaveFile::GetNormalizationGain() const
+    {
+        return m_NormalizationGain;
+    }
+
+    /// <summary>
+    /// Returns whether the loudness of the sound was measured when it got loaded.
+    /// </summary>
+    /// <returns></returns>
+    bool WaveFile::HasLoudness() const
+    {
+        return m_HasLoudness;
+    }
+
+    /// <summary>
+    /// Returns the loudness of the sound (from when it got loaded).
+    /// </summary>
+    /// <returns>The measurement.</returns>
+    const effects::LoudnessMeasurement &WaveFile::GetLoudness() const
+    {
+        return m_Loudness;
+    }
+
     /// <summary>
     /// Sets the end position of the wave file.
     /// </summary>
     /// <param name="a_EndPosition">The end position.</param>
     void WaveFile::SetEndPosition(uint32_t a_EndPosition)
     {
-        a_EndPosition = utils::clamp<uint32_t>(a_EndPosition, 0, m_WaveFormat.GetChunkSize(DATA_CHUNK_ID));
+        a_EndPosition = utils::clamp<uint32_t>(a_EndPosition, 0, m_WaveFormat.GetDataSize());
         m_EndPosition = a_EndPosition;
     }
 
@@ -126,7 +226,7 @@ namespace uaudio
     /// <param name="a_StartPosition">The start position.</param>
     void WaveFile::SetStartPosition(uint32_t a_StartPosition)
     {
-        a_StartPosition = utils::clamp<uint32_t>(a_StartPosition, 0, m_WaveFormat.GetChunkSize(DATA_CHUNK_ID));
+        a_StartPosition = utils::clamp<uint32_t>(a_StartPosition, 0, m_WaveFormat.GetDataSize());
         m_StartPosition = a_StartPosition;
     }
 
@@ -139,6 +239,89 @@ namespace uaudio
         return m_StartPosition;
     }
 
+    /// <summary>
+    /// Sets the start and/or end position from the first loop in the smpl chunk (after conversion, so the positions match the data).
+    /// The end of a loop is the last frame that gets played, so the end position is the frame after it.
+    /// </summary>
+    /// <param name="a_LoopPointSetting">Which loop points need to be set.</param>
+    void WaveFile::SetLoopPoints(LOOP_POINT_SETTING a_LoopPointSetting)
+    {
+        if (a_LoopPointSetting == LOOP_POINT_SETTING::LOOP_POINT_SETTING_NONE || !m_WaveFormat.HasChunk(SMPL_CHUNK_ID))
+            return;
+
+        const SMPL_Chunk smpl_chunk = m_WaveFormat.GetChunkFromData<SMPL_Chunk>(SMPL_CHUNK_ID);
+        if (smpl_chunk.num_sample_loops == 0)
+            return;
+
+        const FMT_Chunk fmt_chunk = m_WaveFormat.GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        if (a_LoopPointSetting == LOOP_POINT_SETTING::LOOP_POINT_SETTING_START || a_LoopPointSetting == LOOP_POINT_SETTING::LOOP_POINT_SETTING_BOTH)
+            SetStartPosition(smpl_chunk.samples[0].start * fmt_chunk.blockAlign);
+        if (a_LoopPointSetting == LOOP_POINT_SETTING::LOOP_POINT_SETTING_END || a_LoopPointSetting == LOOP_POINT_SETTING::LOOP_POINT_SETTING_BOTH)
+            SetEndPosition((smpl_chunk.samples[0].end + 1) * fmt_chunk.blockAlign);
+    }
+
+    /// <summary>
+    /// Skips the silence at the start and the end of the sound (after conversion, so the threshold applies to the data that gets played).
+    /// If the memory gets released, the silent frames get removed from the data and the loop points and cue points move along with it.
+    /// Otherwise the data stays the same and only the start and end positions change.
+    /// A sound that is silent everywhere does not get trimmed.
+    /// </summary>
+    /// <param name="a_Threshold">The level below which a frame is silent (in dB).</param>
+    /// <param name="a_ReleaseMemory">Whether the silent frames get removed from memory.</param>
+    void WaveFile::TrimSilence(float a_Threshold, bool a_ReleaseMemory)
+    {
+        uint32_t start_position = 0, end_position = 0;
+        if (!m_WaveFormat.FindAudibleRange(a_Threshold, start_position, end_position))
+            return;
+
+        if (a_ReleaseMemory)
+        {
+            m_WaveFormat.Trim(start_position, end_position);
+            m_StartPosition = 0;
+            m_EndPosition = m_WaveFormat.GetChunkSize(DATA_CHUNK_ID);
+            return;
+        }
+
+        SetStartPosition(start_position);
+        SetEndPosition(end_position);
+    }
+
+    /// <summary>
+    /// Measures the loudness of the part between the start and end position and sets the gain that brings it to a loudness.
+    /// </summary>
+    /// <param name="a_TargetLoudness">The loudness (in LUFS).</param>
+    /// <param name="a_MaxTruePeak">The highest true peak after the gain (in dBTP).</param>
+    void WaveFile::Normalize(float a_TargetLoudness, float a_MaxTruePeak)
+    {
+        const FMT_Chunk fmt_chunk = m_WaveFormat.GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        const unsigned char *data = m_WaveFormat.GetChunkBuffer(DATA_CHUNK_ID);
+        if (data == nullptr || m_EndPosition <= m_StartPosition)
+            return;
+
+        m_Loudness = effects::MeasureLoudness(data + m_StartPosition, m_EndPosition - m_StartPosition, fmt_chunk.bitsPerSample, fmt_chunk.numChannels, m_WaveFormat.GetChannelMask(), fmt_chunk.sampleRate);
+        m_HasLoudness = true;
+        SetNormalizationGain(effects::GetNormalizationGain(m_Loudness, a_TargetLoudness, a_MaxTruePeak));
+    }
+
+    /// <summary>
+    /// Returns whether the data of the sound stays on the disk and needs to be played through a stream.
+    /// </summary>
+    /// <returns></returns>
+    bool WaveFile::IsStreaming() const
+    {
+        return m_WaveFormat.IsStreaming();
+    }
+
+    /// <summary>
+    /// Asks the system to read the start of a mapped sound in the background, so the first buffers do not wait for the disk.
+    /// Does nothing for a sound that is in memory.
+    /// </summary>
+    /// <param name="a_Size">The amount of bytes from the start position.</param>
+    void WaveFile::Prefetch(uint32_t a_Size) const
+    {
+        m_WaveFormat.Prefetch(m_StartPosition, a_Size);
+    }
+
     /// <summary>
     /// Returns the wav file.
     /// </summary>
@@ -147,4 +330,42 @@ namespace uaudio
     {
         return m_WaveFormat;
     }
+
+    /// <summary>
+    /// Returns the fmt chunk of the sound (from when loading finished).
+    /// </summary>
+    /// <returns>The fmt chunk (empty if there is none).</returns>
+    const FMT_Chunk &WaveFile::GetFmtChunk() const
+    {
+        return m_FmtChunk;
+    }
+
+    /// <summary>
+    /// Returns the data of the sound (from when loading finished).
+    /// </summary>
+    /// <returns>The data (nullptr for a streamed sound, see Streamer).</returns>
+    unsigned char *WaveFile::GetData() const
+    {
+        return m_Data;
+    }
+
+    /// <summary>
+    /// Returns the size of the data of the sound (from when loading finished, the size in the file for a streamed sound).
+    /// </summary>
+    /// <returns>The size (in bytes).</returns>
+    uint32_t WaveFile::GetDataSize() const
+    {
+        return m_DataSize;
+    }
+
+    /// <summary>
+    /// Looks up the fmt chunk and the data chunk, so the buffers of the audio thread do not need to.
+    /// Needs to be called again whenever the chunks of the format change.
+    /// </summary>
+    void WaveFile::UpdateChunkCache()
+    {
+        m_FmtChunk = m_WaveFormat.GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        m_Data = m_WaveFormat.GetChunkBuffer(DATA_CHUNK_ID);
+        m_DataSize = m_WaveFormat.GetDataSize();
+    }
 }
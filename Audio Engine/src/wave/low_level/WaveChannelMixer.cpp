@@ -0,0 +1,376 @@
+#include <uaudio/wave/low_level/WaveChannelMixer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <uaudio/wave/low_level/WaveConverter.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define UAUDIO_CHANNEL_MIXER_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		// -3dB, used when one speaker gets spread over two speakers or folded into a neighbour.
+		constexpr float MIX_ITU_VOLUME = 0.70710678f;
+
+		// -6dB, used when surround speakers get folded into the front center speaker.
+		constexpr float MIX_ITU_SURROUND_CENTER_VOLUME = 0.5f;
+
+		// The amount of frames that get converted with one matrix multiply.
+		constexpr uint32_t MIX_BLOCK_FRAMES = 256;
+
+		namespace
+		{
+			struct SpeakerFold
+			{
+				uint32_t speakers = 0;
+				float volume = 0.0f;
+			};
+
+			struct SpeakerFallback
+			{
+				uint32_t speaker = 0;
+
+				// In order of preference, the first fold of which all speakers exist in the target layout gets used.
+				SpeakerFold folds[3];
+			};
+
+			// Where a speaker goes when the target layout does not have it. The low frequency channel is not in here, so it gets left out.
+			constexpr SpeakerFallback SPEAKER_FALLBACKS[] = {
+				{WAVE_SPEAKER_FRONT_LEFT, {{WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_VOLUME}}},
+				{WAVE_SPEAKER_FRONT_RIGHT, {{WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_VOLUME}}},
+				{WAVE_SPEAKER_FRONT_CENTER, {{WAVE_SPEAKERS_STEREO, MIX_ITU_VOLUME}}},
+				{WAVE_SPEAKER_BACK_LEFT, {{WAVE_SPEAKER_SIDE_LEFT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_LEFT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_SURROUND_CENTER_VOLUME}}},
+				{WAVE_SPEAKER_BACK_RIGHT, {{WAVE_SPEAKER_SIDE_RIGHT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_RIGHT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_SURROUND_CENTER_VOLUME}}},
+				{WAVE_SPEAKER_FRONT_LEFT_OF_CENTER, {{WAVE_SPEAKER_FRONT_LEFT, UAUDIO_MAX_VOLUME}, {WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_VOLUME}}},
+				{WAVE_SPEAKER_FRONT_RIGHT_OF_CENTER, {{WAVE_SPEAKER_FRONT_RIGHT, UAUDIO_MAX_VOLUME}, {WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_VOLUME}}},
+				{WAVE_SPEAKER_BACK_CENTER, {{WAVE_SPEAKER_BACK_LEFT | WAVE_SPEAKER_BACK_RIGHT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_SIDE_LEFT | WAVE_SPEAKER_SIDE_RIGHT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_SURROUND_CENTER_VOLUME}}},
+				{WAVE_SPEAKER_SIDE_LEFT, {{WAVE_SPEAKER_BACK_LEFT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_LEFT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_SURROUND_CENTER_VOLUME}}},
+				{WAVE_SPEAKER_SIDE_RIGHT, {{WAVE_SPEAKER_BACK_RIGHT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_RIGHT, MIX_ITU_VOLUME}, {WAVE_SPEAKER_FRONT_CENTER, MIX_ITU_SURROUND_CENTER_VOLUME}}},
+			};
+
+			/// <summary>
+			/// Returns the channel index of a speaker, or the number of channels if the layout does not have the speaker.
+			/// </summary>
+			/// <param name="a_Speakers">The speaker of every channel.</param>
+			/// <param name="a_NumChannels">The number of channels.</param>
+			/// <param name="a_Speaker">The speaker.</param>
+			/// <returns></returns>
+			uint16_t FindChannel(const uint32_t *a_Speakers, uint16_t a_NumChannels, uint32_t a_Speaker)
+			{
+				for (uint16_t i = 0; i < a_NumChannels; i++)
+					if (a_Speakers[i] == a_Speaker)
+						return i;
+				return a_NumChannels;
+			}
+
+			/// <summary>
+			/// Adds a source channel to all target speakers in a mask.
+			/// </summary>
+			/// <returns>Whether all speakers exist in the target layout (nothing gets added otherwise).</returns>
+			bool AddToSpeakers(float *a_Matrix, const uint32_t *a_TargetSpeakers, uint16_t a_TargetChannels, uint16_t a_SourceChannels, uint16_t a_Source, uint32_t a_Speakers, float a_Volume)
+			{
+				uint32_t found = 0;
+				for (uint16_t i = 0; i < a_TargetChannels; i++)
+					found |= a_TargetSpeakers[i] & a_Speakers;
+				if (found != a_Speakers)
+					return false;
+
+				for (uint16_t i = 0; i < a_TargetChannels; i++)
+					if (a_TargetSpeakers[i] & a_Speakers)
+						a_Matrix[i * a_SourceChannels + a_Source] += a_Volume;
+				return true;
+			}
+
+			/// <summary>
+			/// Converts a block of frames from one layout to another.
+			/// </summary>
+			/// <param name="a_DataBuffer">The new data buffer.</param>
+			/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+			/// <param name="a_NumFrames">The amount of frames (up to MIX_BLOCK_FRAMES).</param>
+			/// <param name="a_Matrix">The mix matrix.</param>
+			/// <param name="a_SourceChannels">The number of channels in the original data.</param>
+			/// <param name="a_TargetChannels">The number of channels in the new data.</param>
+			template <uint16_t BitsPerSample>
+			void MixBlock(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t a_NumFrames, const float *a_Matrix, uint16_t a_SourceChannels, uint16_t a_TargetChannels)
+			{
+				constexpr uint32_t bytes_per_sample = BitsPerSample / 8;
+
+				alignas(16) float source[UAUDIO_MAX_SPEAKERS][MIX_BLOCK_FRAMES];
+				alignas(16) float target[MIX_BLOCK_FRAMES];
+
+				// Split the channels, so that the matrix multiply can do 4 frames at a time.
+				for (uint16_t channel = 0; channel < a_SourceChannels; channel++)
+					for (uint32_t i = 0; i < a_NumFrames; i++)
+						source[channel][i] = ReadSample<BitsPerSample>(a_OriginalDataBuffer + (i * a_SourceChannels + channel) * bytes_per_sample);
+
+				for (uint16_t output = 0; output < a_TargetChannels; output++)
+				{
+					const float *row = a_Matrix + output * a_SourceChannels;
+					std::fill(target, target + a_NumFrames, 0.0f);
+					for (uint16_t input = 0; input < a_SourceChannels; input++)
+					{
+						const float volume = row[input];
+						if (volume == 0.0f)
+							continue;
+
+						uint32_t i = 0;
+#if defined(UAUDIO_CHANNEL_MIXER_SSE)
+						const __m128 volume4 = _mm_set1_ps(volume);
+						for (; i + 4 <= a_NumFrames; i += 4)
+							_mm_store_ps(target + i, _mm_add_ps(_mm_load_ps(target + i), _mm_mul_ps(_mm_load_ps(source[input] + i), volume4)));
+#endif
+						for (; i < a_NumFrames; i++)
+							target[i] += source[input][i] * volume;
+					}
+
+					for (uint32_t i = 0; i < a_NumFrames; i++)
+						WriteSample<BitsPerSample>(a_DataBuffer + (i * a_TargetChannels + output) * bytes_per_sample, target[i]);
+				}
+			}
+
+			/// <summary>
+			/// Converts a part of the frames, block by block.
+			/// </summary>
+			/// <param name="a_DataBuffer">The new data buffer.</param>
+			/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+			/// <param name="a_FirstFrame">The first frame of the part.</param>
+			/// <param name="a_EndFrame">The frame after the part.</param>
+			/// <param name="a_BitsPerSample">The bits per sample.</param>
+			/// <param name="a_Matrix">The matrix of [target channel][source channel].</param>
+			/// <param name="a_SourceChannels">The number of channels in the original data.</param>
+			/// <param name="a_TargetChannels">The number of channels in the new data.</param>
+			void MixPart(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t a_FirstFrame, uint32_t a_EndFrame, uint16_t a_BitsPerSample, const float *a_Matrix, uint16_t a_SourceChannels, uint16_t a_TargetChannels)
+			{
+				const uint32_t source_block_align = a_SourceChannels * a_BitsPerSample / 8;
+				const uint32_t target_block_align = a_TargetChannels * a_BitsPerSample / 8;
+				for (uint32_t i = a_FirstFrame; i < a_EndFrame; i += MIX_BLOCK_FRAMES)
+				{
+					const uint32_t count = std::min(MIX_BLOCK_FRAMES, a_EndFrame - i);
+					unsigned char *data = a_DataBuffer + static_cast<size_t>(i) * target_block_align;
+					const unsigned char *original_data = a_OriginalDataBuffer + static_cast<size_t>(i) * source_block_align;
+					switch (a_BitsPerSample)
+					{
+						case WAVE_BITS_PER_SAMPLE_8:
+						{
+							MixBlock<WAVE_BITS_PER_SAMPLE_8>(data, original_data, count, a_Matrix, a_SourceChannels, a_TargetChannels);
+							break;
+						}
+						case WAVE_BITS_PER_SAMPLE_16:
+						{
+							MixBlock<WAVE_BITS_PER_SAMPLE_16>(data, original_data, count, a_Matrix, a_SourceChannels, a_TargetChannels);
+							break;
+						}
+						case WAVE_BITS_PER_SAMPLE_24:
+						{
+							MixBlock<WAVE_BITS_PER_SAMPLE_24>(data, original_data, count, a_Matrix, a_SourceChannels, a_TargetChannels);
+							break;
+						}
+						case WAVE_BITS_PER_SAMPLE_32:
+						{
+							MixBlock<WAVE_BITS_PER_SAMPLE_32>(data, original_data, count, a_Matrix, a_SourceChannels, a_TargetChannels);
+							break;
+						}
+						default:
+							break;
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Returns the channel mask that gets used for files without one (the WAVE_FORMAT_EXTENSIBLE defaults).
+		/// </summary>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <returns></returns>
+		uint32_t GetDefaultChannelMask(uint16_t a_NumChannels)
+		{
+			switch (a_NumChannels)
+			{
+				case WAVE_CHANNELS_MONO:
+					return WAVE_SPEAKERS_MONO;
+				case WAVE_CHANNELS_STEREO:
+					return WAVE_SPEAKERS_STEREO;
+				case 3:
+					return WAVE_SPEAKERS_STEREO | WAVE_SPEAKER_FRONT_CENTER;
+				case WAVE_CHANNELS_QUAD:
+					return WAVE_SPEAKERS_QUAD;
+				case 5:
+					return WAVE_SPEAKERS_QUAD | WAVE_SPEAKER_FRONT_CENTER;
+				case WAVE_CHANNELS_5_1:
+					return WAVE_SPEAKERS_5_1;
+				case 7:
+					return WAVE_SPEAKERS_5_1 | WAVE_SPEAKER_BACK_CENTER;
+				case WAVE_CHANNELS_7_1:
+					return WAVE_SPEAKERS_7_1;
+				default:
+					return 0;
+			}
+		}
+
+		/// <summary>
+		/// Returns the speaker of a channel (0 if the channel mask does not say where the channel goes).
+		/// </summary>
+		/// <param name="a_ChannelMask">The channel mask.</param>
+		/// <param name="a_Channel">The channel index.</param>
+		/// <returns></returns>
+		uint32_t GetChannelSpeaker(uint32_t a_ChannelMask, uint16_t a_Channel)
+		{
+			uint16_t channel = 0;
+			for (uint32_t speaker = 1; speaker != 0 && speaker <= a_ChannelMask; speaker <<= 1)
+				if (a_ChannelMask & speaker)
+				{
+					if (channel == a_Channel)
+						return speaker;
+					channel++;
+				}
+			return 0;
+		}
+
+		/// <summary>
+		/// Calculates the mix matrix from one speaker layout to another.
+		/// </summary>
+		/// <param name="a_Matrix">The matrix (a_TargetChannels rows of a_SourceChannels volumes).</param>
+		/// <param name="a_SourceMask">The channel mask of the source (0 means the default for the number of channels).</param>
+		/// <param name="a_SourceChannels">The number of source channels.</param>
+		/// <param name="a_TargetMask">The channel mask of the target (0 means the default for the number of channels).</param>
+		/// <param name="a_TargetChannels">The number of target channels.</param>
+		/// <param name="a_Normalize">Whether the volumes should be lowered so that the output cannot clip.</param>
+		void CalculateMixMatrix(float *a_Matrix, uint32_t a_SourceMask, uint16_t a_SourceChannels, uint32_t a_TargetMask, uint16_t a_TargetChannels, bool a_Normalize)
+		{
+			a_SourceChannels = std::min<uint16_t>(a_SourceChannels, UAUDIO_MAX_SPEAKERS);
+			a_TargetChannels = std::min<uint16_t>(a_TargetChannels, UAUDIO_MAX_SPEAKERS);
+			std::fill(a_Matrix, a_Matrix + a_SourceChannels * a_TargetChannels, 0.0f);
+
+			if (a_SourceMask == 0)
+				a_SourceMask = GetDefaultChannelMask(a_SourceChannels);
+			if (a_TargetMask == 0)
+				a_TargetMask = GetDefaultChannelMask(a_TargetChannels);
+
+			uint32_t source_speakers[UAUDIO_MAX_SPEAKERS], target_speakers[UAUDIO_MAX_SPEAKERS];
+			for (uint16_t i = 0; i < a_SourceChannels; i++)
+				source_speakers[i] = GetChannelSpeaker(a_SourceMask, i);
+			for (uint16_t i = 0; i < a_TargetChannels; i++)
+				target_speakers[i] = GetChannelSpeaker(a_TargetMask, i);
+
+			for (uint16_t input = 0; input < a_SourceChannels; input++)
+			{
+				const uint32_t speaker = source_speakers[input];
+
+				// Channels without a speaker only get copied to the channel with the same index.
+				if (speaker == 0)
+				{
+					if (input < a_TargetChannels && target_speakers[input] == 0)
+						a_Matrix[input * a_SourceChannels + input] = UAUDIO_MAX_VOLUME;
+					continue;
+				}
+
+				const uint16_t output = FindChannel(target_speakers, a_TargetChannels, speaker);
+				if (output != a_TargetChannels)
+				{
+					a_Matrix[output * a_SourceChannels + input] += UAUDIO_MAX_VOLUME;
+					continue;
+				}
+
+				// Mono goes to both front speakers at full volume, so that converting mono to stereo and back does not change the data.
+				if (a_SourceChannels == WAVE_CHANNELS_MONO && AddToSpeakers(a_Matrix, target_speakers, a_TargetChannels, a_SourceChannels, input, WAVE_SPEAKERS_STEREO, UAUDIO_MAX_VOLUME))
+					continue;
+
+				for (const SpeakerFallback &fallback : SPEAKER_FALLBACKS)
+				{
+					if (fallback.speaker != speaker)
+						continue;
+
+					for (const SpeakerFold &fold : fallback.folds)
+						if (fold.speakers != 0 && AddToSpeakers(a_Matrix, target_speakers, a_TargetChannels, a_SourceChannels, input, fold.speakers, fold.volume))
+							break;
+					break;
+				}
+			}
+
+			if (!a_Normalize)
+				return;
+
+			float max_volume = 0.0f;
+			for (uint16_t output = 0; output < a_TargetChannels; output++)
+			{
+				float volume = 0.0f;
+				for (uint16_t input = 0; input < a_SourceChannels; input++)
+					volume += std::fabs(a_Matrix[output * a_SourceChannels + input]);
+				max_volume = std::max(max_volume, volume);
+			}
+
+			if (max_volume > UAUDIO_MAX_VOLUME)
+				for (uint32_t i = 0; i < static_cast<uint32_t>(a_SourceChannels * a_TargetChannels); i++)
+					a_Matrix[i] /= max_volume;
+		}
+
+		/// <summary>
+		/// Calculates the size of the data after a channel conversion.
+		/// </summary>
+		/// <param name="a_Size">The size of the original data.</param>
+		/// <param name="a_SourceChannels">The number of channels in the original data.</param>
+		/// <param name="a_TargetChannels">The number of channels in the new data.</param>
+		/// <returns></returns>
+		uint32_t CalculateChannelConvertSize(uint32_t a_Size, uint16_t a_SourceChannels, uint16_t a_TargetChannels)
+		{
+			if (a_SourceChannels == 0)
+				return 0;
+			return a_Size / a_SourceChannels * a_TargetChannels;
+		}
+
+		/// <summary>
+		/// Converts data from one speaker layout to another.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer (needs to be CalculateChannelConvertSize bytes).</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed).</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_SourceMask">The channel mask of the original data (0 means the default for the number of channels).</param>
+		/// <param name="a_SourceChannels">The number of channels in the original data.</param>
+		/// <param name="a_TargetMask">The channel mask of the new data (0 means the default for the number of channels).</param>
+		/// <param name="a_TargetChannels">The number of channels in the new data.</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void ConvertChannels(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BitsPerSample, uint32_t a_SourceMask, uint16_t a_SourceChannels, uint32_t a_TargetMask, uint16_t a_TargetChannels, uint32_t a_NumThreads)
+		{
+			if (a_SourceChannels == 0 || a_SourceChannels > UAUDIO_MAX_SPEAKERS || a_TargetChannels == 0 || a_TargetChannels > UAUDIO_MAX_SPEAKERS)
+				return;
+
+			if (a_BitsPerSample != WAVE_BITS_PER_SAMPLE_8 && a_BitsPerSample != WAVE_BITS_PER_SAMPLE_16 && a_BitsPerSample != WAVE_BITS_PER_SAMPLE_24 && a_BitsPerSample != WAVE_BITS_PER_SAMPLE_32)
+				return;
+
+			const uint32_t source_block_align = a_SourceChannels * a_BitsPerSample / 8;
+			const uint32_t target_block_align = a_TargetChannels * a_BitsPerSample / 8;
+			if (a_Size % source_block_align != 0)
+				return;
+
+			const uint32_t num_frames = a_Size / source_block_align;
+			a_Size = num_frames * target_block_align;
+
+			float matrix[UAUDIO_MAX_SPEAKERS * UAUDIO_MAX_SPEAKERS];
+			CalculateMixMatrix(matrix, a_SourceMask, a_SourceChannels, a_TargetMask, a_TargetChannels);
+
+			// The parts start on a block, so they mix the same blocks as one part would.
+			const uint32_t num_parts = GetConversionParts(num_frames * a_SourceChannels, a_NumThreads);
+			std::vector<std::thread> threads;
+			for (uint32_t i = 1; i < num_parts; i++)
+			{
+				const uint32_t first_frame = static_cast<uint32_t>(static_cast<uint64_t>(num_frames) * i / num_parts) / MIX_BLOCK_FRAMES * MIX_BLOCK_FRAMES;
+				const uint32_t end_frame = i + 1 == num_parts ? num_frames : static_cast<uint32_t>(static_cast<uint64_t>(num_frames) * (i + 1) / num_parts) / MIX_BLOCK_FRAMES * MIX_BLOCK_FRAMES;
+				threads.emplace_back(MixPart, a_DataBuffer, a_OriginalDataBuffer, first_frame, end_frame, a_BitsPerSample, matrix, a_SourceChannels, a_TargetChannels);
+			}
+
+			const uint32_t first_end = num_parts == 1 ? num_frames : num_frames / num_parts / MIX_BLOCK_FRAMES * MIX_BLOCK_FRAMES;
+			MixPart(a_DataBuffer, a_OriginalDataBuffer, 0, first_end, a_BitsPerSample, matrix, a_SourceChannels, a_TargetChannels);
+			for (std::thread &thread : threads)
+				thread.join();
+		}
+	}
+}
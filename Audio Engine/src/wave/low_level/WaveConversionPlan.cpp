@@ -0,0 +1,179 @@
+#include <uaudio/wave/low_level/WaveConversionPlan.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <uaudio/utils/Denormals.h>
+#include <uaudio/wave/low_level/WaveChannelMixer.h>
+#include <uaudio/wave/low_level/WaveConverter.h>
+#include <uaudio/wave/low_level/WaveDither.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		/// <summary>
+		/// Sets up the plan from one format to another.
+		/// </summary>
+		/// <param name="a_Source">The format of the original data.</param>
+		/// <param name="a_Target">The format of the new data.</param>
+		/// <param name="a_Dither">The dither type (only used when the bit depth goes down).</param>
+		/// <returns>Whether both formats are supported (a known sample format with 1 to UAUDIO_MAX_SPEAKERS channels).</returns>
+		bool ConversionPlan::Init(const ConversionFormat &a_Source, const ConversionFormat &a_Target, DITHER a_Dither)
+		{
+			m_ConvertBitsPerSample = false;
+			m_ConvertChannels = false;
+
+			m_SourceSampleFormat = GetSampleFormat(a_Source.audioFormat, a_Source.bitsPerSample);
+			m_TargetSampleFormat = GetSampleFormat(a_Target.audioFormat, a_Target.bitsPerSample);
+			if (m_SourceSampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN || m_TargetSampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN)
+				return false;
+
+			if (a_Source.numChannels == 0 || a_Source.numChannels > UAUDIO_MAX_SPEAKERS || a_Target.numChannels == 0 || a_Target.numChannels > UAUDIO_MAX_SPEAKERS)
+				return false;
+
+			m_Source = a_Source;
+			m_Target = a_Target;
+			if (m_Source.channelMask == 0)
+				m_Source.channelMask = GetDefaultChannelMask(m_Source.numChannels);
+			if (m_Target.channelMask == 0)
+				m_Target.channelMask = GetDefaultChannelMask(m_Target.numChannels);
+
+			// Dither only hides the error of a lower bit depth, the same or a higher bit depth gets rounded.
+			m_Dither = m_Target.bitsPerSample < m_Source.bitsPerSample ? a_Dither : DITHER::DITHER_NONE;
+
+			m_ConvertBitsPerSample = m_SourceSampleFormat != m_TargetSampleFormat;
+			m_ConvertChannels = m_Source.numChannels != m_Target.numChannels || m_Source.channelMask != m_Target.channelMask;
+			if (m_ConvertChannels)
+				CalculateMixMatrix(m_Matrix, m_Source.channelMask, m_Source.numChannels, m_Target.channelMask, m_Target.numChannels);
+			return true;
+		}
+
+		/// <summary>
+		/// Returns whether the plan has nothing to do.
+		/// </summary>
+		/// <returns></returns>
+		bool ConversionPlan::IsEmpty() const
+		{
+			return !m_ConvertBitsPerSample && !m_ConvertChannels;
+		}
+
+		/// <summary>
+		/// Returns whether the plan changes the bit depth.
+		/// </summary>
+		/// <returns></returns>
+		bool ConversionPlan::ConvertsBitsPerSample() const
+		{
+			return m_ConvertBitsPerSample;
+		}
+
+		/// <summary>
+		/// Returns whether the plan changes the number of channels or the speaker layout.
+		/// </summary>
+		/// <returns></returns>
+		bool ConversionPlan::ConvertsChannels() const
+		{
+			return m_ConvertChannels;
+		}
+
+		/// <summary>
+		/// Calculates the size of the data after the conversion.
+		/// </summary>
+		/// <param name="a_Size">The size of the original data.</param>
+		/// <returns>The size of the new data (whole frames only).</returns>
+		uint32_t ConversionPlan::CalculateSize(uint32_t a_Size) const
+		{
+			const uint32_t source_block_align = m_Source.numChannels * m_Source.bitsPerSample / 8;
+			const uint32_t target_block_align = m_Target.numChannels * m_Target.bitsPerSample / 8;
+			if (source_block_align == 0)
+				return 0;
+
+			return a_Size / source_block_align * target_block_align;
+		}
+
+		/// <summary>
+		/// Converts the data in one pass.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer (needs to be CalculateSize bytes).</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed).</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void ConversionPlan::Convert(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads) const
+		{
+			const uint32_t source_block_align = m_Source.numChannels * m_Source.bitsPerSample / 8;
+			if (source_block_align == 0)
+				return;
+
+			const uint32_t num_frames = a_Size / source_block_align;
+			a_Size = CalculateSize(a_Size);
+
+			// The parts start on a block, so they convert the same blocks as one part would.
+			const uint32_t num_parts = GetConversionParts(num_frames * std::max(m_Source.numChannels, m_Target.numChannels), a_NumThreads);
+			std::vector<std::thread> threads;
+			for (uint32_t i = 1; i < num_parts; i++)
+			{
+				const uint32_t first_frame = static_cast<uint32_t>(static_cast<uint64_t>(num_frames) * i / num_parts) / CONVERSION_PLAN_BLOCK_FRAMES * CONVERSION_PLAN_BLOCK_FRAMES;
+				const uint32_t end_frame = i + 1 == num_parts ? num_frames : static_cast<uint32_t>(static_cast<uint64_t>(num_frames) * (i + 1) / num_parts) / CONVERSION_PLAN_BLOCK_FRAMES * CONVERSION_PLAN_BLOCK_FRAMES;
+				threads.emplace_back(&ConversionPlan::ConvertPart, this, a_DataBuffer, a_OriginalDataBuffer, first_frame, end_frame);
+			}
+
+			const uint32_t first_end = num_parts == 1 ? num_frames : num_frames / num_parts / CONVERSION_PLAN_BLOCK_FRAMES * CONVERSION_PLAN_BLOCK_FRAMES;
+			ConvertPart(a_DataBuffer, a_OriginalDataBuffer, 0, first_end);
+			for (std::thread &thread : threads)
+				thread.join();
+		}
+
+		/// <summary>
+		/// Converts a part of the frames, block by block: read as floats, mix and write at the new bit depth.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_FirstFrame">The first frame of the part.</param>
+		/// <param name="a_EndFrame">The frame after the part.</param>
+		void ConversionPlan::ConvertPart(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t a_FirstFrame, uint32_t a_EndFrame) const
+		{
+			utils::DenormalGuard denormal_guard;
+
+			const uint16_t source_channels = m_Source.numChannels, target_channels = m_Target.numChannels;
+			const uint32_t source_block_align = source_channels * m_Source.bitsPerSample / 8;
+			const uint32_t target_block_align = target_channels * m_Target.bitsPerSample / 8;
+
+			// Every part has its own noise shaping, it starts at silence like the first part does.
+			Ditherer ditherer;
+			ditherer.Init(m_Dither, target_channels);
+
+			// Without a mix the pair of sample formats has its own conversion (that does not go through floats where it does not need to).
+			if (!m_ConvertChannels)
+			{
+				GetSampleConvertFunction(m_SourceSampleFormat, m_TargetSampleFormat)(a_DataBuffer + static_cast<size_t>(a_FirstFrame) * target_block_align, a_OriginalDataBuffer + static_cast<size_t>(a_FirstFrame) * source_block_align, (a_EndFrame - a_FirstFrame) * source_channels, ditherer);
+				return;
+			}
+
+			float source[UAUDIO_MAX_SPEAKERS * CONVERSION_PLAN_BLOCK_FRAMES];
+			float target[UAUDIO_MAX_SPEAKERS * CONVERSION_PLAN_BLOCK_FRAMES];
+			for (uint32_t i = a_FirstFrame; i < a_EndFrame; i += CONVERSION_PLAN_BLOCK_FRAMES)
+			{
+				const uint32_t count = std::min(CONVERSION_PLAN_BLOCK_FRAMES, a_EndFrame - i);
+				ReadSamples(source, a_OriginalDataBuffer + static_cast<size_t>(i) * source_block_align, count * source_channels, m_SourceSampleFormat);
+
+				for (uint32_t frame = 0; frame < count; frame++)
+				{
+					const float *input = source + frame * source_channels;
+					float *output = target + frame * target_channels;
+					for (uint16_t channel = 0; channel < target_channels; channel++)
+					{
+						const float *row = m_Matrix + channel * source_channels;
+						float sum = 0.0f;
+						for (uint16_t j = 0; j < source_channels; j++)
+							sum += row[j] * input[j];
+						output[channel] = sum;
+					}
+				}
+
+				ditherer.Quantize(a_DataBuffer + static_cast<size_t>(i) * target_block_align, target, count * target_channels, m_TargetSampleFormat);
+			}
+		}
+	}
+}
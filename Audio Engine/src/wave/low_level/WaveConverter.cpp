@@ -1,14 +1,202 @@
 ﻿#include <uaudio/wave/low_level/WaveConverter.h>
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <uaudio/utils/Denormals.h>
 #include <uaudio/utils/uint24_t.h>
+#include <uaudio/wave/low_level/WaveChannelMixer.h>
+#include <uaudio/wave/low_level/WaveDither.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
 
 namespace uaudio
 {
-	// Square root of 2 (size of uint16_t)
-	constexpr float SQRT_TWO = 1.4142135623730950488016887242097f;
-
 	namespace conversion
 	{
+		// The amount of samples that get converted to floats at a time (stays on the stack).
+		constexpr uint32_t CONVERSION_BLOCK_SAMPLES = 1024;
+
+		// The amount of sample formats (SAMPLE_FORMAT_UNKNOWN included, so that a sample format is its own index).
+		constexpr size_t NUM_SAMPLE_FORMATS = static_cast<size_t>(SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64) + 1;
+
+		namespace
+		{
+			/// <summary>
+			/// Returns whether a conversion goes to an integer format with fewer bits, so that it needs dither.
+			/// </summary>
+			/// <param name="a_OriginalSampleFormat">The sample format of the original data.</param>
+			/// <param name="a_SampleFormat">The sample format of the new data.</param>
+			/// <returns></returns>
+			constexpr bool IsDithered(SAMPLE_FORMAT a_OriginalSampleFormat, SAMPLE_FORMAT a_SampleFormat)
+			{
+				const bool ditherable = a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT16 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT24;
+				return ditherable && GetBitsPerSample(a_SampleFormat) < GetBitsPerSample(a_OriginalSampleFormat);
+			}
+
+			/// <summary>
+			/// Returns whether a sample format stores integers.
+			/// </summary>
+			/// <param name="a_SampleFormat">The sample format.</param>
+			/// <returns></returns>
+			constexpr bool IsInteger(SAMPLE_FORMAT a_SampleFormat)
+			{
+				return a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT16 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT24 || a_SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT32;
+			}
+
+			/// <summary>
+			/// Reads an integer sample as a signed integer (8-bit samples get their offset removed).
+			/// </summary>
+			/// <param name="a_Data">The data.</param>
+			/// <returns></returns>
+			template <SAMPLE_FORMAT SampleFormat>
+			inline int32_t ReadInteger(const unsigned char *a_Data)
+			{
+				if constexpr (SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8)
+					return a_Data[0] - 128;
+				else if constexpr (SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT16)
+				{
+					int16_t value = 0;
+					UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+					return value;
+				}
+				else if constexpr (SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT24)
+					return static_cast<int32_t>(static_cast<uint32_t>(a_Data[0] | (a_Data[1] << 8) | (a_Data[2] << 16)) << 8) >> 8;
+				else
+				{
+					int32_t value = 0;
+					UAUDIO_DEFAULT_MEMCPY(&value, a_Data, sizeof(value));
+					return value;
+				}
+			}
+
+			/// <summary>
+			/// Writes a signed integer as an integer sample (already in range).
+			/// </summary>
+			/// <param name="a_Data">The data.</param>
+			/// <param name="a_Value">The sample.</param>
+			template <SAMPLE_FORMAT SampleFormat>
+			inline void WriteInteger(unsigned char *a_Data, int32_t a_Value)
+			{
+				if constexpr (SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT16)
+				{
+					const int16_t value = static_cast<int16_t>(a_Value);
+					UAUDIO_DEFAULT_MEMCPY(a_Data, &value, sizeof(value));
+				}
+				else if constexpr (SampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_INT24)
+				{
+					a_Data[0] = static_cast<unsigned char>(a_Value & 0xFF);
+					a_Data[1] = static_cast<unsigned char>((a_Value >> 8) & 0xFF);
+					a_Data[2] = static_cast<unsigned char>((a_Value >> 16) & 0xFF);
+				}
+				else
+					UAUDIO_DEFAULT_MEMCPY(a_Data, &a_Value, sizeof(a_Value));
+			}
+
+			/// <summary>
+			/// Converts samples from one sample format to another.
+			/// </summary>
+			/// <param name="a_DataBuffer">The new data buffer.</param>
+			/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+			/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+			/// <param name="a_Ditherer">The ditherer (only used when the conversion is dithered).</param>
+			template <SAMPLE_FORMAT OriginalSampleFormat, SAMPLE_FORMAT SampleFormat>
+			void ConvertSamples(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t a_NumSamples, Ditherer &a_Ditherer)
+			{
+				constexpr size_t original_bytes_per_sample = GetBitsPerSample(OriginalSampleFormat) / 8;
+				constexpr size_t bytes_per_sample = GetBitsPerSample(SampleFormat) / 8;
+
+				if constexpr (OriginalSampleFormat == SampleFormat)
+					UAUDIO_DEFAULT_MEMCPY(a_DataBuffer, a_OriginalDataBuffer, a_NumSamples * bytes_per_sample);
+				else if constexpr (IsInteger(OriginalSampleFormat) && IsInteger(SampleFormat) && GetBitsPerSample(SampleFormat) > GetBitsPerSample(OriginalSampleFormat))
+				{
+					// More bits for an integer is a shift, the new low bits are 0.
+					constexpr uint32_t shift = GetBitsPerSample(SampleFormat) - GetBitsPerSample(OriginalSampleFormat);
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						WriteInteger<SampleFormat>(a_DataBuffer + i * bytes_per_sample, static_cast<int32_t>(static_cast<uint32_t>(ReadInteger<OriginalSampleFormat>(a_OriginalDataBuffer + i * original_bytes_per_sample)) << shift));
+				}
+				else if constexpr (OriginalSampleFormat == SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8)
+				{
+					// 8-bit samples to floats is a lookup.
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						WriteFormatSample<SampleFormat>(a_DataBuffer + i * bytes_per_sample, UINT8_SAMPLES.values[a_OriginalDataBuffer[i]]);
+				}
+				else if constexpr (IsDithered(OriginalSampleFormat, SampleFormat))
+				{
+					// The dither works on floats, a block at a time.
+					float samples[CONVERSION_BLOCK_SAMPLES];
+					for (uint32_t i = 0; i < a_NumSamples; i += CONVERSION_BLOCK_SAMPLES)
+					{
+						const uint32_t count = std::min(CONVERSION_BLOCK_SAMPLES, a_NumSamples - i);
+						ReadSamples(samples, a_OriginalDataBuffer + i * original_bytes_per_sample, count, OriginalSampleFormat);
+						a_Ditherer.Quantize(a_DataBuffer + i * bytes_per_sample, samples, count, SampleFormat);
+					}
+				}
+				else
+				{
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						WriteFormatSample<SampleFormat>(a_DataBuffer + i * bytes_per_sample, ReadFormatSample<OriginalSampleFormat>(a_OriginalDataBuffer + i * original_bytes_per_sample));
+				}
+			}
+
+			// The conversions from one sample format to every other sample format.
+			template <SAMPLE_FORMAT OriginalSampleFormat>
+			struct SampleConvertFunctions
+			{
+				static constexpr SampleConvertFunction functions[NUM_SAMPLE_FORMATS] = {
+					nullptr,
+					ConvertSamples<OriginalSampleFormat, SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8>,
+					ConvertSamples<OriginalSampleFormat, SAMPLE_FORMAT::SAMPLE_FORMAT_INT16>,
+					ConvertSamples<OriginalSampleFormat, SAMPLE_FORMAT::SAMPLE_FORMAT_INT24>,
+					ConvertSamples<OriginalSampleFormat, SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>,
+					ConvertSamples<OriginalSampleFormat, SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32>,
+					ConvertSamples<OriginalSampleFormat, SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>,
+				};
+			};
+
+			// [original sample format][sample format].
+			constexpr const SampleConvertFunction *SAMPLE_CONVERT_FUNCTIONS[NUM_SAMPLE_FORMATS] = {
+				nullptr,
+				SampleConvertFunctions<SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8>::functions,
+				SampleConvertFunctions<SAMPLE_FORMAT::SAMPLE_FORMAT_INT16>::functions,
+				SampleConvertFunctions<SAMPLE_FORMAT::SAMPLE_FORMAT_INT24>::functions,
+				SampleConvertFunctions<SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>::functions,
+				SampleConvertFunctions<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32>::functions,
+				SampleConvertFunctions<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>::functions,
+			};
+
+			/// <summary>
+			/// Converts a part of the pcm data to another sample format.
+			/// </summary>
+			/// <param name="a_Function">The conversion.</param>
+			/// <param name="a_DataBuffer">The new data buffer (at the start of the part).</param>
+			/// <param name="a_OriginalDataBuffer">The original data buffer (at the start of the part).</param>
+			/// <param name="a_NumSamples">The amount of samples in the part (not frames).</param>
+			/// <param name="a_Dither">The dither type.</param>
+			/// <param name="a_NumChannels">The number of channels.</param>
+			void ConvertSampleFormatPart(SampleConvertFunction a_Function, unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t a_NumSamples, DITHER a_Dither, uint16_t a_NumChannels)
+			{
+				utils::DenormalGuard denormal_guard;
+
+				// Every part has its own noise shaping, it starts at silence like the first part does.
+				Ditherer ditherer;
+				ditherer.Init(a_Dither, a_NumChannels);
+				a_Function(a_DataBuffer, a_OriginalDataBuffer, a_NumSamples, ditherer);
+			}
+		}
+
+		/// <summary>
+		/// Returns in how many parts data gets converted.
+		/// </summary>
+		/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+		/// <param name="a_NumThreads">The amount of threads (0 means one per core).</param>
+		/// <returns>The amount of parts (at least 1, parts are never shorter than CONVERSION_MIN_PART_SAMPLES).</returns>
+		uint32_t GetConversionParts(uint32_t a_NumSamples, uint32_t a_NumThreads)
+		{
+			const uint32_t num_threads = a_NumThreads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : a_NumThreads;
+			return std::max(std::min(num_threads, a_NumSamples / CONVERSION_MIN_PART_SAMPLES), 1u);
+		}
+
 		/// <summary>
 		/// Recalculates the buffer size from 24-bit to 16-bit.
 		/// </summary>
@@ -90,26 +278,91 @@ namespace uaudio
 		}
 
 		/// <summary>
-		/// Converts 24 bit pcm data to 16 bit pcm data.
+		/// Recalculates the buffer size from one sample format to another.
 		/// </summary>
-		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_Size">The buffer size.</param>
+		/// <param name="a_OriginalSampleFormat">The sample format of the original data.</param>
+		/// <param name="a_SampleFormat">The sample format of the new data.</param>
+		/// <returns>The new buffer size (0 if a sample format is unknown).</returns>
+		uint32_t CalculateSampleFormatSize(uint32_t a_Size, SAMPLE_FORMAT a_OriginalSampleFormat, SAMPLE_FORMAT a_SampleFormat)
+		{
+			const uint32_t original_bytes_per_sample = GetBitsPerSample(a_OriginalSampleFormat) / 8;
+			if (original_bytes_per_sample == 0)
+				return 0;
+
+			return a_Size / original_bytes_per_sample * (GetBitsPerSample(a_SampleFormat) / 8);
+		}
+
+		/// <summary>
+		/// Returns the conversion from one sample format to another.
+		/// </summary>
+		/// <param name="a_OriginalSampleFormat">The sample format of the original data.</param>
+		/// <param name="a_SampleFormat">The sample format of the new data.</param>
+		/// <returns>The conversion (nullptr if a sample format is unknown).</returns>
+		SampleConvertFunction GetSampleConvertFunction(SAMPLE_FORMAT a_OriginalSampleFormat, SAMPLE_FORMAT a_SampleFormat)
+		{
+			const size_t original_index = static_cast<size_t>(a_OriginalSampleFormat), index = static_cast<size_t>(a_SampleFormat);
+			if (original_index >= NUM_SAMPLE_FORMATS || index >= NUM_SAMPLE_FORMATS || SAMPLE_CONVERT_FUNCTIONS[original_index] == nullptr)
+				return nullptr;
+
+			return SAMPLE_CONVERT_FUNCTIONS[original_index][index];
+		}
+
+		/// <summary>
+		/// Converts pcm data from one sample format to another, long data gets split into parts (of whole frames) that are converted on their own threads.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer (needs to be CalculateSampleFormatSize bytes).</param>
 		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
-		/// <param name="a_Size">The data size (will get changed)</param>
-		void Convert24To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size)
+		/// <param name="a_Size">The data size (will get changed).</param>
+		/// <param name="a_OriginalSampleFormat">The sample format of the original data.</param>
+		/// <param name="a_SampleFormat">The sample format of the new data.</param>
+		/// <param name="a_Dither">The dither type (only used when the conversion goes to an integer format with fewer bits).</param>
+		/// <param name="a_NumChannels">The number of channels (used by the noise shaping).</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		/// <returns>Whether both sample formats are known.</returns>
+		bool ConvertSampleFormat(unsigned char *a_DataBuffer, const unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, SAMPLE_FORMAT a_OriginalSampleFormat, SAMPLE_FORMAT a_SampleFormat, DITHER a_Dither, uint16_t a_NumChannels, uint32_t a_NumThreads)
 		{
-			// Determine the size of a 16bit data array.
-			// Chunk size divided by the size of a 24bit int (3) multiplied by the size of a 16bit int (2).
-			const uint32_t newSize = Calculate24To16Size(a_Size);
+			const SampleConvertFunction function = GetSampleConvertFunction(a_OriginalSampleFormat, a_SampleFormat);
+			if (function == nullptr)
+				return false;
 
-			uint16_t *array_16 = reinterpret_cast<uint16_t *>(a_DataBuffer);
+			const size_t original_bytes_per_sample = GetBitsPerSample(a_OriginalSampleFormat) / 8, bytes_per_sample = GetBitsPerSample(a_SampleFormat) / 8;
+			const uint32_t num_samples = static_cast<uint32_t>(a_Size / original_bytes_per_sample);
+			const uint32_t num_channels = std::max<uint32_t>(a_NumChannels, 1);
+			const uint32_t num_frames = num_samples / num_channels;
+			const uint32_t num_parts = GetConversionParts(num_samples, a_NumThreads);
+			const DITHER dither = IsDithered(a_OriginalSampleFormat, a_SampleFormat) ? a_Dither : DITHER::DITHER_NONE;
 
-			int i = 0;
-			for (uint32_t a = 0; a < a_Size; a += sizeof(uint24_t), i++)
+			std::vector<std::thread> threads;
+			for (uint32_t i = 1; i < num_parts; i++)
 			{
-				// Skip 1 bit every time since we go from 24bit to 16bit.
-				array_16[i] = *reinterpret_cast<uint16_t *>(a_OriginalDataBuffer + a + 1);
+				const uint32_t first_sample = static_cast<uint32_t>(static_cast<uint64_t>(num_frames) * i / num_parts) * num_channels;
+				const uint32_t end_sample = i + 1 == num_parts ? num_samples : static_cast<uint32_t>(static_cast<uint64_t>(num_frames) * (i + 1) / num_parts) * num_channels;
+				threads.emplace_back(ConvertSampleFormatPart, function, a_DataBuffer + first_sample * bytes_per_sample, a_OriginalDataBuffer + first_sample * original_bytes_per_sample, end_sample - first_sample, dither, a_NumChannels);
 			}
-			a_Size = newSize;
+
+			const uint32_t first_end = num_parts == 1 ? num_samples : num_frames / num_parts * num_channels;
+			ConvertSampleFormatPart(function, a_DataBuffer, a_OriginalDataBuffer, first_end, dither, a_NumChannels);
+			for (std::thread &thread : threads)
+				thread.join();
+
+			a_Size = static_cast<uint32_t>(num_samples * bytes_per_sample);
+			return true;
+		}
+
+		/// <summary>
+		/// Converts 24 bit pcm data to 16 bit pcm data.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed)</param>
+		/// <param name="a_Dither">The dither type.</param>
+		/// <param name="a_NumChannels">The number of channels (used by the noise shaping).</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void Convert24To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, DITHER a_Dither, uint16_t a_NumChannels, uint32_t a_NumThreads)
+		{
+			// The low byte does not get dropped, it gets rounded with dither.
+			ConvertSampleFormat(a_DataBuffer, a_OriginalDataBuffer, a_Size, SAMPLE_FORMAT::SAMPLE_FORMAT_INT24, SAMPLE_FORMAT::SAMPLE_FORMAT_INT16, a_Dither, a_NumChannels, a_NumThreads);
 		}
 
 		/// <summary>
@@ -118,31 +371,67 @@ namespace uaudio
 		/// <param name="a_DataBuffer">The new data buffer.</param>
 		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
 		/// <param name="a_Size">The data size (will get changed)</param>
-		void Convert32To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size)
+		/// <param name="a_Dither">The dither type.</param>
+		/// <param name="a_NumChannels">The number of channels (used by the noise shaping).</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void Convert32To16(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, DITHER a_Dither, uint16_t a_NumChannels, uint32_t a_NumThreads)
 		{
-			// Determine the size of a 16bit data array.
-			// Chunk size divided by the size of a 32bit int (4) multiplied by the size of a 16bit int (2).
-			uint32_t new_size = Calculate32To16Size(a_Size);
+			// 32-bit samples are floats from -1.0 to 1.0, so they map to the full 16-bit range.
+			ConvertSampleFormat(a_DataBuffer, a_OriginalDataBuffer, a_Size, SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32, SAMPLE_FORMAT::SAMPLE_FORMAT_INT16, a_Dither, a_NumChannels, a_NumThreads);
+		}
 
-			uint16_t *array_16 = reinterpret_cast<uint16_t *>(a_DataBuffer);
+		/// <summary>
+		/// Converts 24 bit pcm data to 32 bit float data.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed)</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void Convert24To32(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads)
+		{
+			ConvertSampleFormat(a_DataBuffer, a_OriginalDataBuffer, a_Size, SAMPLE_FORMAT::SAMPLE_FORMAT_INT24, SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32, DITHER::DITHER_NONE, WAVE_CHANNELS_STEREO, a_NumThreads);
+		}
 
-			int i = 0;
-			for (uint32_t a = 0; a < a_Size; a += sizeof(uint32_t), i++)
-			{
-				// Add the size of a 32bit int (4) to move the data pointer.
-				float converted_value = *reinterpret_cast<float *>(a_OriginalDataBuffer + a);
+		/// <summary>
+		/// Converts 16 bit pcm data to 32 bit float data.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed)</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void Convert16To32(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads)
+		{
+			ConvertSampleFormat(a_DataBuffer, a_OriginalDataBuffer, a_Size, SAMPLE_FORMAT::SAMPLE_FORMAT_INT16, SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32, DITHER::DITHER_NONE, WAVE_CHANNELS_STEREO, a_NumThreads);
+		}
 
-				// Calc 32 to 16 bit int.
-				converted_value /= SQRT_TWO;
-				converted_value *= INT16_MAX;
+		/// <summary>
+		/// Converts 16 bit pcm data to 24 bit pcm data.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed)</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void Convert16To24(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint32_t a_NumThreads)
+		{
+			ConvertSampleFormat(a_DataBuffer, a_OriginalDataBuffer, a_Size, SAMPLE_FORMAT::SAMPLE_FORMAT_INT16, SAMPLE_FORMAT::SAMPLE_FORMAT_INT24, DITHER::DITHER_NONE, WAVE_CHANNELS_STEREO, a_NumThreads);
+		}
 
-				array_16[i] = static_cast<uint16_t>(converted_value);
-			}
-			a_Size = new_size;
+		/// <summary>
+		/// Converts 32 bit float data to 24 bit pcm data.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed)</param>
+		/// <param name="a_Dither">The dither type.</param>
+		/// <param name="a_NumChannels">The number of channels (used by the noise shaping).</param>
+		/// <param name="a_NumThreads">The amount of threads that long data gets split over (0 means one per core).</param>
+		void Convert32To24(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, DITHER a_Dither, uint16_t a_NumChannels, uint32_t a_NumThreads)
+		{
+			ConvertSampleFormat(a_DataBuffer, a_OriginalDataBuffer, a_Size, SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32, SAMPLE_FORMAT::SAMPLE_FORMAT_INT24, a_Dither, a_NumChannels, a_NumThreads);
 		}
 
 		/// <summary>
-		/// Converts mono data to stereo data.
+		/// Converts mono data to stereo data (both channels get the mono signal).
 		/// </summary>
 		/// <param name="a_DataBuffer">The new data buffer.</param>
 		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
@@ -150,30 +439,24 @@ namespace uaudio
 		/// <param name="a_BlockAlign">The alignment of 1 sample.</param>
 		void ConvertMonoToStereo(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BlockAlign)
 		{
-			if (a_Size % a_BlockAlign != 0)
-				return;
-
-			// Double the size.
-			a_Size = CalculateMonoToStereoSize(a_Size);
-
-			int newIndex = 0;
-			for (uint32_t i = 0; i <= a_Size / 2 - a_BlockAlign; i += a_BlockAlign)
+			// 16-bit and 32-bit samples go through the conversion kernels, the rest through the channel mixer.
+			const ConversionKernels &kernels = GetConversionKernels();
+			if (a_BlockAlign == sizeof(int16_t) || a_BlockAlign == sizeof(float))
 			{
-				int echo = 0;
-				while (echo < 2)
-				{
-					for (uint32_t j = 0; j < a_BlockAlign; j++)
-					{
-						a_DataBuffer[newIndex] = a_OriginalDataBuffer[i + j];
-						newIndex++;
-					}
-					echo++;
-				}
+				if (a_Size % a_BlockAlign != 0)
+					return;
+
+				const uint32_t num_frames = a_Size / a_BlockAlign;
+				(a_BlockAlign == sizeof(int16_t) ? kernels.monoToStereo16 : kernels.monoToStereo32)(a_DataBuffer, a_OriginalDataBuffer, num_frames);
+				a_Size = num_frames * a_BlockAlign * WAVE_CHANNELS_STEREO;
+				return;
 			}
+
+			ConvertChannels(a_DataBuffer, a_OriginalDataBuffer, a_Size, a_BlockAlign * 8, WAVE_SPEAKERS_MONO, WAVE_CHANNELS_MONO, WAVE_SPEAKERS_STEREO, WAVE_CHANNELS_STEREO);
 		}
 
 		/// <summary>
-		/// Converts stereo data to mono data.
+		/// Converts stereo data to mono data (the average of both channels).
 		/// </summary>
 		/// <param name="a_DataBuffer">The new data buffer.</param>
 		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
@@ -181,29 +464,21 @@ namespace uaudio
 		/// <param name="a_BlockAlign">The alignment of 1 sample.</param>
 		void ConvertStereoToMono(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BlockAlign)
 		{
-			if (a_Size % a_BlockAlign != 0)
-				return;
-
-			// Double the size.
-			a_Size = CalculateStereoToMonoSize(a_Size);
-
-			uint32_t newIndex = 0;
-			for (uint32_t i = 0; i <= a_Size * 2 - a_BlockAlign; i += a_BlockAlign)
-				for (uint32_t j = 0; j < static_cast<uint32_t>(a_BlockAlign) / 2; j++)
-				{
-					a_DataBuffer[newIndex] = a_OriginalDataBuffer[i + j];
-					newIndex++;
-				}
-		}
-
-		void ConvertToSamples(float* a_OutSamples, unsigned char* a_DataBuffer, uint32_t a_SampleCount)
-		{
-			for (uint32_t i = 0; i < a_SampleCount; ++i, a_DataBuffer += 4, ++a_OutSamples)
+			// 16-bit and 32-bit samples go through the conversion kernels, the rest through the channel mixer.
+			const ConversionKernels &kernels = GetConversionKernels();
+			const uint16_t bytes_per_sample = a_BlockAlign / WAVE_CHANNELS_STEREO;
+			if (bytes_per_sample == sizeof(int16_t) || bytes_per_sample == sizeof(float))
 			{
-				short lSample = *(const short*)a_DataBuffer;
-				short rSample = *(const short*)(a_DataBuffer + 2);
-				*a_OutSamples = ((float)lSample + (float)rSample) / 65536.f;
+				if (a_Size % a_BlockAlign != 0)
+					return;
+
+				const uint32_t num_frames = a_Size / a_BlockAlign;
+				(bytes_per_sample == sizeof(int16_t) ? kernels.stereoToMono16 : kernels.stereoToMono32)(a_DataBuffer, a_OriginalDataBuffer, num_frames);
+				a_Size = num_frames * bytes_per_sample;
+				return;
 			}
+
+			ConvertChannels(a_DataBuffer, a_OriginalDataBuffer, a_Size, a_BlockAlign / WAVE_CHANNELS_STEREO * 8, WAVE_SPEAKERS_STEREO, WAVE_CHANNELS_STEREO, WAVE_SPEAKERS_MONO, WAVE_CHANNELS_MONO);
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include <uaudio/wave/low_level/WaveDither.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+#include <uaudio/Defines.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UAUDIO_DITHER_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		// Error feedback of the noise shaping: the noise gets filtered by 1 - z^-1 + 0.5z^-2 (-6dB at DC, +8dB at nyquist).
+		constexpr float NOISE_SHAPING_FIRST = 1.0f;
+		constexpr float NOISE_SHAPING_SECOND = -0.5f;
+
+		// The error that gets fed back is limited, so that clipping does not make the noise shaping run away.
+		constexpr float NOISE_SHAPING_MAX_ERROR = 2.0f;
+
+		// Scale from a 24-bit random number to a float from 0 to 1.
+		constexpr float RANDOM_SCALE = 1.0f / 16777216.0f;
+
+		namespace
+		{
+			struct RandomState
+			{
+				uint32_t lanes[4] = {};
+				bool seeded = false;
+			};
+
+			thread_local RandomState random_state;
+			std::atomic<uint32_t> random_seed{0x9E3779B9u};
+
+			/// <summary>
+			/// Returns the random state of the current thread (seeded on first use).
+			/// </summary>
+			/// <returns></returns>
+			RandomState &GetRandomState()
+			{
+				RandomState &state = random_state;
+				if (!state.seeded)
+				{
+					uint32_t seed = random_seed.fetch_add(0x9E3779B9u) ^ static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+					for (uint32_t &lane : state.lanes)
+					{
+						// Spread the seed over the lanes (xorshift does not work with 0).
+						seed = seed * 1664525u + 1013904223u;
+						lane = seed | 1u;
+					}
+					state.seeded = true;
+				}
+				return state;
+			}
+
+			/// <summary>
+			/// Returns a random float from -0.5 to 0.5 (xorshift32).
+			/// </summary>
+			/// <param name="a_State">The random state.</param>
+			/// <returns></returns>
+			inline float RandomUniform(uint32_t &a_State)
+			{
+				a_State ^= a_State << 13;
+				a_State ^= a_State >> 17;
+				a_State ^= a_State << 5;
+				return static_cast<float>(a_State >> 8) * RANDOM_SCALE - 0.5f;
+			}
+
+			/// <summary>
+			/// Returns triangular noise from -1 to 1 (the sum of two uniform random numbers).
+			/// </summary>
+			/// <param name="a_State">The random state.</param>
+			/// <returns></returns>
+			inline float RandomTriangular(uint32_t &a_State)
+			{
+				return RandomUniform(a_State) + RandomUniform(a_State);
+			}
+
+#if defined(UAUDIO_DITHER_SSE2)
+			/// <summary>
+			/// Returns 4 random floats from -0.5 to 0.5 (xorshift32 on 4 lanes).
+			/// </summary>
+			/// <param name="a_State">The random state.</param>
+			/// <returns></returns>
+			inline __m128 RandomUniform4(__m128i &a_State)
+			{
+				a_State = _mm_xor_si128(a_State, _mm_slli_epi32(a_State, 13));
+				a_State = _mm_xor_si128(a_State, _mm_srli_epi32(a_State, 17));
+				a_State = _mm_xor_si128(a_State, _mm_slli_epi32(a_State, 5));
+				return _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(a_State, 8)), _mm_set1_ps(RANDOM_SCALE)), _mm_set1_ps(0.5f));
+			}
+#endif
+
+			/// <summary>
+			/// Returns the scale of a float sample to an integer sample.
+			/// </summary>
+			/// <returns></returns>
+			template <uint16_t BitsPerSample>
+			constexpr float GetQuantizeScale()
+			{
+				return BitsPerSample == WAVE_BITS_PER_SAMPLE_8 ? INT8_SCALE : (BitsPerSample == WAVE_BITS_PER_SAMPLE_16 ? INT16_SCALE : INT24_SCALE);
+			}
+
+			/// <summary>
+			/// Writes an integer sample (already in range).
+			/// </summary>
+			/// <param name="a_Data">The data.</param>
+			/// <param name="a_Value">The sample.</param>
+			template <uint16_t BitsPerSample>
+			inline void StoreSample(unsigned char *a_Data, int32_t a_Value)
+			{
+				if constexpr (BitsPerSample == WAVE_BITS_PER_SAMPLE_8)
+					a_Data[0] = static_cast<unsigned char>(a_Value + 128);
+				else if constexpr (BitsPerSample == WAVE_BITS_PER_SAMPLE_16)
+				{
+					const int16_t value = static_cast<int16_t>(a_Value);
+					UAUDIO_DEFAULT_MEMCPY(a_Data, &value, sizeof(value));
+				}
+				else
+				{
+					a_Data[0] = static_cast<unsigned char>(a_Value & 0xFF);
+					a_Data[1] = static_cast<unsigned char>((a_Value >> 8) & 0xFF);
+					a_Data[2] = static_cast<unsigned char>((a_Value >> 16) & 0xFF);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Sets up the ditherer. This is the only place where memory gets allocated.
+		/// </summary>
+		/// <param name="a_Dither">The dither type.</param>
+		/// <param name="a_NumChannels">The number of channels (the noise shaping is done per channel).</param>
+		void Ditherer::Init(DITHER a_Dither, uint16_t a_NumChannels)
+		{
+			m_Dither = a_Dither;
+			m_NumChannels = std::max<uint16_t>(1, a_NumChannels);
+			m_Errors.assign(static_cast<size_t>(m_NumChannels) * 2, 0.0f);
+			Reset();
+		}
+
+		/// <summary>
+		/// Clears the noise shaping errors.
+		/// </summary>
+		void Ditherer::Reset()
+		{
+			m_Channel = 0;
+			std::fill(m_Errors.begin(), m_Errors.end(), 0.0f);
+		}
+
+		/// <summary>
+		/// Returns the dither type.
+		/// </summary>
+		/// <returns></returns>
+		DITHER Ditherer::GetDither() const
+		{
+			return m_Dither;
+		}
+
+		/// <summary>
+		/// Writes float samples as pcm data.
+		/// </summary>
+		/// <param name="a_DataBuffer">The pcm data.</param>
+		/// <param name="a_Samples">The samples (-1.0 to 1.0).</param>
+		/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+		/// <param name="a_BitsPerSample">The bits per sample of the pcm data (8-bit, 16-bit, 24-bit, 32-bit floats).</param>
+		void Ditherer::Quantize(unsigned char *a_DataBuffer, const float *a_Samples, uint32_t a_NumSamples, uint16_t a_BitsPerSample)
+		{
+			Quantize(a_DataBuffer, a_Samples, a_NumSamples, GetSampleFormat(0, a_BitsPerSample));
+		}
+
+		/// <summary>
+		/// Writes float samples as samples of any sample format.
+		/// </summary>
+		/// <param name="a_DataBuffer">The pcm data.</param>
+		/// <param name="a_Samples">The samples (-1.0 to 1.0).</param>
+		/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+		/// <param name="a_SampleFormat">The sample format of the pcm data.</param>
+		void Ditherer::Quantize(unsigned char *a_DataBuffer, const float *a_Samples, uint32_t a_NumSamples, SAMPLE_FORMAT a_SampleFormat)
+		{
+			switch (a_SampleFormat)
+			{
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8:
+				{
+					QuantizeSamples<WAVE_BITS_PER_SAMPLE_8>(a_DataBuffer, a_Samples, a_NumSamples);
+					break;
+				}
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_INT16:
+				{
+					QuantizeSamples<WAVE_BITS_PER_SAMPLE_16>(a_DataBuffer, a_Samples, a_NumSamples);
+					break;
+				}
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_INT24:
+				{
+					QuantizeSamples<WAVE_BITS_PER_SAMPLE_24>(a_DataBuffer, a_Samples, a_NumSamples);
+					break;
+				}
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_INT32:
+				{
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>(a_DataBuffer + i * sizeof(int32_t), a_Samples[i]);
+					break;
+				}
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32:
+				{
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						WriteSample<WAVE_BITS_PER_SAMPLE_32>(a_DataBuffer + i * sizeof(float), a_Samples[i]);
+					break;
+				}
+				case SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64:
+				{
+					for (uint32_t i = 0; i < a_NumSamples; i++)
+						WriteFormatSample<SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(a_DataBuffer + i * sizeof(double), a_Samples[i]);
+					break;
+				}
+				default:
+					return;
+			}
+			m_Channel = static_cast<uint16_t>((m_Channel + a_NumSamples) % m_NumChannels);
+		}
+
+		/// <summary>
+		/// Quantizes float samples to integer samples.
+		/// </summary>
+		/// <param name="a_DataBuffer">The pcm data.</param>
+		/// <param name="a_Samples">The samples (-1.0 to 1.0).</param>
+		/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+		template <uint16_t BitsPerSample>
+		void Ditherer::QuantizeSamples(unsigned char *a_DataBuffer, const float *a_Samples, uint32_t a_NumSamples)
+		{
+			const uint32_t bytes_per_sample = BitsPerSample / 8;
+			constexpr float scale = GetQuantizeScale<BitsPerSample>();
+			constexpr float low = -scale, high = scale - 1.0f;
+
+			if (m_Dither == DITHER::DITHER_NONE)
+			{
+				if constexpr (BitsPerSample == WAVE_BITS_PER_SAMPLE_16)
+				{
+					GetConversionKernels().write16(a_DataBuffer, a_Samples, a_NumSamples);
+					return;
+				}
+
+				for (uint32_t i = 0; i < a_NumSamples; i++)
+					WriteSample<BitsPerSample>(a_DataBuffer + i * bytes_per_sample, a_Samples[i]);
+				return;
+			}
+
+			RandomState &random = GetRandomState();
+
+			if (m_Dither == DITHER::DITHER_TPDF_NOISE_SHAPING)
+			{
+				uint16_t channel = m_Channel;
+				for (uint32_t i = 0; i < a_NumSamples; i++)
+				{
+					float *errors = m_Errors.data() + static_cast<size_t>(channel) * 2;
+					const float value = a_Samples[i] * scale - (NOISE_SHAPING_FIRST * errors[0] + NOISE_SHAPING_SECOND * errors[1]);
+					const float quantized = std::nearbyint(std::clamp(value + RandomTriangular(random.lanes[0]), low, high));
+					StoreSample<BitsPerSample>(a_DataBuffer + i * bytes_per_sample, static_cast<int32_t>(quantized));
+
+					errors[1] = errors[0];
+					errors[0] = std::clamp(quantized - value, -NOISE_SHAPING_MAX_ERROR, NOISE_SHAPING_MAX_ERROR);
+
+					if (++channel == m_NumChannels)
+						channel = 0;
+				}
+				return;
+			}
+
+			uint32_t i = 0;
+#if defined(UAUDIO_DITHER_SSE2)
+			__m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i *>(random.lanes));
+			const __m128 scale4 = _mm_set1_ps(scale), low4 = _mm_set1_ps(low), high4 = _mm_set1_ps(high);
+			for (; i + 4 <= a_NumSamples; i += 4)
+			{
+				const __m128 noise = _mm_add_ps(RandomUniform4(state), RandomUniform4(state));
+				__m128 value = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a_Samples + i), scale4), noise);
+				value = _mm_min_ps(_mm_max_ps(value, low4), high4);
+
+				// Rounds to the nearest integer (default rounding mode).
+				const __m128i quantized = _mm_cvtps_epi32(value);
+				if constexpr (BitsPerSample == WAVE_BITS_PER_SAMPLE_16)
+					_mm_storel_epi64(reinterpret_cast<__m128i *>(a_DataBuffer + i * bytes_per_sample), _mm_packs_epi32(quantized, quantized));
+				else
+				{
+					alignas(16) int32_t values[4];
+					_mm_store_si128(reinterpret_cast<__m128i *>(values), quantized);
+					for (uint32_t j = 0; j < 4; j++)
+						StoreSample<BitsPerSample>(a_DataBuffer + (i + j) * bytes_per_sample, values[j]);
+				}
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(random.lanes), state);
+#endif
+			for (; i < a_NumSamples; i++)
+			{
+				const float value = a_Samples[i] * scale + RandomTriangular(random.lanes[0]);
+				StoreSample<BitsPerSample>(a_DataBuffer + i * bytes_per_sample, static_cast<int32_t>(std::nearbyint(std::clamp(value, low, high))));
+			}
+		}
+	}
+}
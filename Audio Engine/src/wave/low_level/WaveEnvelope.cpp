@@ -0,0 +1,214 @@
+#include <uaudio/wave/low_level/WaveEnvelope.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <uaudio/utils/Utils.h>
+
+namespace uaudio
+{
+	namespace effects
+	{
+		// Exponential stages go from and to -80dB instead of silence (which cannot be reached by multiplying).
+		constexpr float ENVELOPE_EXPONENTIAL_FLOOR = 0.0001f;
+
+		constexpr double ENVELOPE_HALF_PI = 1.5707963267948966;
+
+		/// <summary>
+		/// Sets the sample rate of the data that the envelope gets applied to.
+		/// </summary>
+		/// <param name="a_SampleRate">The sample rate.</param>
+		void Envelope::Init(uint32_t a_SampleRate)
+		{
+			m_SampleRate = std::max(a_SampleRate, 1u);
+		}
+
+		/// <summary>
+		/// Sets the ADSR that gets used by the next trigger and release.
+		/// </summary>
+		/// <param name="a_ADSR">The ADSR.</param>
+		void Envelope::SetADSR(const ADSR &a_ADSR)
+		{
+			m_ADSR = a_ADSR;
+			m_ADSR.attack = std::max(m_ADSR.attack, 0.0f);
+			m_ADSR.decay = std::max(m_ADSR.decay, 0.0f);
+			m_ADSR.sustain = utils::clamp(m_ADSR.sustain, 0.0f, UAUDIO_MAX_VOLUME);
+			m_ADSR.release = std::max(m_ADSR.release, 0.0f);
+		}
+
+		/// <summary>
+		/// Returns the ADSR.
+		/// </summary>
+		/// <returns>The ADSR.</returns>
+		const ADSR &Envelope::GetADSR() const
+		{
+			return m_ADSR;
+		}
+
+		/// <summary>
+		/// Starts the attack from silence (a sound without an attack starts at full volume).
+		/// </summary>
+		void Envelope::Trigger()
+		{
+			m_Level = 0.0f;
+			Begin(ENVELOPE_STAGE::ENVELOPE_STAGE_ATTACK, UAUDIO_MAX_VOLUME, m_ADSR.attack, m_ADSR.curve);
+		}
+
+		/// <summary>
+		/// Starts the release of the ADSR.
+		/// </summary>
+		void Envelope::Release()
+		{
+			Release(m_ADSR.release, m_ADSR.curve);
+		}
+
+		/// <summary>
+		/// Goes to silence from the current volume, after which the envelope is done.
+		/// </summary>
+		/// <param name="a_Milliseconds">The length of the release.</param>
+		/// <param name="a_Curve">The curve.</param>
+		void Envelope::Release(float a_Milliseconds, ENVELOPE_CURVE a_Curve)
+		{
+			if (m_Stage == ENVELOPE_STAGE::ENVELOPE_STAGE_DONE)
+				return;
+			Begin(ENVELOPE_STAGE::ENVELOPE_STAGE_RELEASE, 0.0f, a_Milliseconds, a_Curve);
+		}
+
+		/// <summary>
+		/// Goes to a volume from the current volume and holds it.
+		/// </summary>
+		/// <param name="a_Level">The volume.</param>
+		/// <param name="a_Milliseconds">The length of the fade.</param>
+		/// <param name="a_Curve">The curve.</param>
+		void Envelope::Fade(float a_Level, float a_Milliseconds, ENVELOPE_CURVE a_Curve)
+		{
+			if (m_Stage == ENVELOPE_STAGE::ENVELOPE_STAGE_DONE)
+				return;
+			Begin(ENVELOPE_STAGE::ENVELOPE_STAGE_FADE, utils::clamp(a_Level, 0.0f, UAUDIO_MAX_VOLUME), a_Milliseconds, a_Curve);
+		}
+
+		/// <summary>
+		/// Jumps to a volume and holds it.
+		/// </summary>
+		/// <param name="a_Level">The volume.</param>
+		void Envelope::SetLevel(float a_Level)
+		{
+			m_Level = utils::clamp(a_Level, 0.0f, UAUDIO_MAX_VOLUME);
+			m_Stage = ENVELOPE_STAGE::ENVELOPE_STAGE_SUSTAIN;
+			m_Remaining = 0;
+		}
+
+		/// <summary>
+		/// Returns the volume of the envelope.
+		/// </summary>
+		/// <returns>The volume.</returns>
+		float Envelope::GetLevel() const
+		{
+			return m_Level;
+		}
+
+		/// <summary>
+		/// Returns the stage of the envelope.
+		/// </summary>
+		/// <returns>The stage.</returns>
+		ENVELOPE_STAGE Envelope::GetStage() const
+		{
+			return m_Stage;
+		}
+
+		/// <summary>
+		/// Returns whether the volume changes over the next frames.
+		/// </summary>
+		/// <returns></returns>
+		bool Envelope::IsMoving() const
+		{
+			return m_Remaining > 0;
+		}
+
+		/// <summary>
+		/// Returns whether the release has finished.
+		/// </summary>
+		/// <returns></returns>
+		bool Envelope::IsDone() const
+		{
+			return m_Stage == ENVELOPE_STAGE::ENVELOPE_STAGE_DONE;
+		}
+
+		/// <summary>
+		/// Starts a stage from the current volume.
+		/// </summary>
+		/// <param name="a_Stage">The stage.</param>
+		/// <param name="a_Target">The volume at the end of the stage.</param>
+		/// <param name="a_Milliseconds">The length of the stage.</param>
+		/// <param name="a_Curve">The curve.</param>
+		void Envelope::Begin(ENVELOPE_STAGE a_Stage, float a_Target, float a_Milliseconds, ENVELOPE_CURVE a_Curve)
+		{
+			m_Stage = a_Stage;
+			m_Curve = a_Curve;
+			m_Start = m_Level;
+			m_Target = a_Target;
+			m_Remaining = static_cast<uint32_t>(std::lround(std::max(a_Milliseconds, 0.0f) * static_cast<float>(m_SampleRate) / 1000.0f));
+
+			if (m_Remaining == 0 || m_Start == m_Target)
+			{
+				m_Remaining = 0;
+				EndStage();
+				return;
+			}
+
+			const double frames = static_cast<double>(m_Remaining);
+			switch (m_Curve)
+			{
+				case ENVELOPE_CURVE::ENVELOPE_CURVE_LINEAR:
+				{
+					m_Step = static_cast<float>((static_cast<double>(m_Target) - m_Start) / frames);
+					break;
+				}
+				case ENVELOPE_CURVE::ENVELOPE_CURVE_EXPONENTIAL:
+				{
+					m_Level = std::max(m_Level, ENVELOPE_EXPONENTIAL_FLOOR);
+					m_Step = static_cast<float>(std::pow(static_cast<double>(std::max(m_Target, ENVELOPE_EXPONENTIAL_FLOOR)) / m_Level, 1.0 / frames));
+					break;
+				}
+				case ENVELOPE_CURVE::ENVELOPE_CURVE_EQUAL_POWER:
+				{
+					m_Cos = 1.0;
+					m_Sin = 0.0;
+					m_RotationCos = std::cos(ENVELOPE_HALF_PI / frames);
+					m_RotationSin = std::sin(ENVELOPE_HALF_PI / frames);
+					break;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Ends the current stage at its exact target and moves on to the next stage.
+		/// </summary>
+		void Envelope::EndStage()
+		{
+			m_Level = m_Target;
+			m_Remaining = 0;
+			switch (m_Stage)
+			{
+				case ENVELOPE_STAGE::ENVELOPE_STAGE_ATTACK:
+				{
+					Begin(ENVELOPE_STAGE::ENVELOPE_STAGE_DECAY, m_ADSR.sustain, m_ADSR.decay, m_ADSR.curve);
+					break;
+				}
+				case ENVELOPE_STAGE::ENVELOPE_STAGE_DECAY:
+				case ENVELOPE_STAGE::ENVELOPE_STAGE_FADE:
+				{
+					m_Stage = ENVELOPE_STAGE::ENVELOPE_STAGE_SUSTAIN;
+					break;
+				}
+				case ENVELOPE_STAGE::ENVELOPE_STAGE_RELEASE:
+				{
+					m_Stage = ENVELOPE_STAGE::ENVELOPE_STAGE_DONE;
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+}
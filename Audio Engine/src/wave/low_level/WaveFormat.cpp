@@ -1,32 +1,65 @@
 #include <uaudio/wave/low_level/WaveFormat.h>
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 #include <uaudio/Includes.h>
 
+#include "uaudio/utils/Logger.h"
 #include "uaudio/utils/uint24_t.h"
 #include "uaudio/wave/high_level/WaveChunks.h"
+#include "uaudio/wave/low_level/WaveChannelMixer.h"
+#include "uaudio/wave/low_level/WaveConversionPlan.h"
 #include "uaudio/wave/low_level/WaveConverter.h"
+#include "uaudio/wave/low_level/WaveResampler.h"
+#include "uaudio/wave/low_level/WaveSamples.h"
+#include "uaudio/wave/low_level/WaveSilence.h"
+#include "uaudio/wave/low_level/WaveTimeStretch.h"
 
 namespace uaudio
 {
     WaveFormat::WaveFormat(const WaveFormat &rhs)
     {
         SetFileName(rhs.m_FilePath);
+        m_Streaming = rhs.m_Streaming;
+        m_StreamOffset = rhs.m_StreamOffset;
+        m_StreamSize = rhs.m_StreamSize;
+        m_FileSize = rhs.m_FileSize;
+        m_MappedFile = rhs.m_MappedFile;
         for (auto *chunk : rhs.m_Chunks)
         {
+            // Chunks in the mapped file do not get copied.
+            if (m_MappedFile != nullptr && m_MappedFile->Contains(chunk))
+            {
+                AddChunk(chunk);
+                continue;
+            }
+
             WaveChunkData *chunk_data = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(chunk->chunkSize + sizeof(WaveChunkData)));
             if (chunk_data != nullptr)
             {
                 UAUDIO_DEFAULT_MEMCPY(chunk_data, chunk, chunk->chunkSize + sizeof(WaveChunkData));
-                m_Chunks.push_back(chunk_data);
+                AddChunk(chunk_data);
             }
         }
     }
 
+    /// <summary>
+    /// Takes over the chunks of another format (the other format ends up empty).
+    /// </summary>
+    /// <param name="rhs">The format.</param>
+    WaveFormat::WaveFormat(WaveFormat &&rhs) noexcept
+    {
+        *this = std::move(rhs);
+    }
+
     WaveFormat::~WaveFormat()
     {
         for (int32_t i = static_cast<uint32_t>(m_Chunks.size()) - 1; i > -1; i--)
-            UAUDIO_DEFAULT_FREE(m_Chunks[i]);
+            FreeChunk(m_Chunks[i]);
         m_Chunks.clear();
+        m_ChunkIds.clear();
 
         UAUDIO_DEFAULT_FREE(m_FilePath);
     }
@@ -35,20 +68,79 @@ namespace uaudio
     {
         if (&rhs != this)
         {
+            // The old chunks go first, while the mapping that they can be in is still there.
+            for (auto *chunk : m_Chunks)
+                FreeChunk(chunk);
+            m_Chunks.clear();
+            m_ChunkIds.clear();
+
             SetFileName(rhs.m_FilePath);
+            m_Streaming = rhs.m_Streaming;
+            m_StreamOffset = rhs.m_StreamOffset;
+            m_StreamSize = rhs.m_StreamSize;
+            m_FileSize = rhs.m_FileSize;
+            m_MappedFile = rhs.m_MappedFile;
             for (auto *chunk : rhs.m_Chunks)
             {
+                if (m_MappedFile != nullptr && m_MappedFile->Contains(chunk))
+                {
+                    AddChunk(chunk);
+                    continue;
+                }
+
                 WaveChunkData *chunk_data = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(chunk->chunkSize + sizeof(WaveChunkData)));
                 if (chunk_data != nullptr)
                 {
                     UAUDIO_DEFAULT_MEMCPY(chunk_data, chunk, chunk->chunkSize + sizeof(WaveChunkData));
-                    m_Chunks.push_back(chunk_data);
+                    AddChunk(chunk_data);
                 }
             }
         }
         return *this;
     }
 
+    /// <summary>
+    /// Takes over the chunks of another format (the other format ends up empty).
+    /// </summary>
+    /// <param name="rhs">The format.</param>
+    /// <returns>The format.</returns>
+    WaveFormat &WaveFormat::operator=(WaveFormat &&rhs) noexcept
+    {
+        if (&rhs != this)
+        {
+            for (auto *chunk : m_Chunks)
+                FreeChunk(chunk);
+            UAUDIO_DEFAULT_FREE(m_FilePath);
+
+            m_FilePath = rhs.m_FilePath;
+            m_Chunks = std::move(rhs.m_Chunks);
+            m_ChunkIds = std::move(rhs.m_ChunkIds);
+            m_MappedFile = std::move(rhs.m_MappedFile);
+            m_Streaming = rhs.m_Streaming;
+            m_StreamOffset = rhs.m_StreamOffset;
+            m_StreamSize = rhs.m_StreamSize;
+            m_FileSize = rhs.m_FileSize;
+
+            rhs.m_FilePath = nullptr;
+            rhs.m_Chunks.clear();
+            rhs.m_ChunkIds.clear();
+            rhs.m_Streaming = false;
+        }
+        return *this;
+    }
+
+    /// <summary>
+    /// Frees a chunk, unless it is in the mapped file (the mapping goes along with the format).
+    /// </summary>
+    /// <param name="a_WaveChunkData">The chunk.</param>
+    void WaveFormat::FreeChunk(WaveChunkData *a_WaveChunkData) const
+    {
+        if (m_MappedFile != nullptr && m_MappedFile->Contains(a_WaveChunkData))
+            return;
+
+        UAUDIO_DEFAULT_FREE(a_WaveChunkData);
+    }
+
     /// <summary>
     /// Sets the file path.
     /// </summary>
@@ -56,6 +148,7 @@ namespace uaudio
     void WaveFormat::SetFileName(const char *a_FilePath)
     {
         UAUDIO_DEFAULT_FREE(m_FilePath);
+        m_FilePath = nullptr;
         if (a_FilePath != nullptr)
         {
             const size_t len = strlen(a_FilePath);
@@ -74,141 +167,454 @@ namespace uaudio
     /// <param name="a_WaveConfig">The config containing specific loading instructions.</param>
     void WaveFormat::ConfigConversion(WaveConfig &a_WaveConfig)
     {
-        BitsPerSampleConvert(a_WaveConfig);
-        MonoStereoConvert(a_WaveConfig);
+        // A streamed sound gets played the way it is in the file.
+        if (m_Streaming)
+            return;
+
+        // The bits per sample and the channels get converted in one pass, the time stretch and the sample rate conversion are passes of their own (see WaveConversionPlan.h).
+        FormatConvert(a_WaveConfig);
+        TimeStretchConvert(a_WaveConfig);
+        SampleRateConvert(a_WaveConfig);
     }
 
     /// <summary>
-    /// Converts the bits per sample if that has been stated in the config.
+    /// Converts the bits per sample and the number of channels (and speaker layout) if that has been stated in the config.
+    /// Both happen in one pass through a conversion plan, from the original data to one new data chunk.
+    /// Sample formats that the engine does not play (32-bit integers, 64-bit floats) always get converted.
     /// </summary>
     /// <param name="a_WaveConfig">The config containing specific loading instructions.</param>
-    void WaveFormat::BitsPerSampleConvert(WaveConfig &a_WaveConfig)
+    void WaveFormat::FormatConvert(WaveConfig &a_WaveConfig)
     {
         FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
 
-        if (a_WaveConfig.bitsPerSample == WAVE_BITS_PER_SAMPLE_16 || a_WaveConfig.bitsPerSample == WAVE_BITS_PER_SAMPLE_24 || a_WaveConfig.bitsPerSample == WAVE_BITS_PER_SAMPLE_32)
-            if (fmt_chunk.bitsPerSample != a_WaveConfig.bitsPerSample)
-            {
-                WaveChunkData *data_WaveChunkData = nullptr;
+        // Compressed data (and bit depths that are not in the matrix) stays the way it is.
+        const SAMPLE_FORMAT source_sample_format = conversion::GetSampleFormat(GetAudioFormat(), fmt_chunk.bitsPerSample);
+        if (source_sample_format == SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN)
+            return;
 
-                const DATA_Chunk data_chunk = GetChunkFromData<DATA_Chunk>(DATA_CHUNK_ID);
-                uint32_t data_chunk_size = GetChunkSize(DATA_CHUNK_ID);
+        conversion::ConversionFormat source;
+        source.bitsPerSample = fmt_chunk.bitsPerSample;
+        source.numChannels = fmt_chunk.numChannels;
+        source.channelMask = GetChannelMask();
+        source.audioFormat = GetAudioFormat();
 
-                switch (a_WaveConfig.bitsPerSample)
-                {
-	                case WAVE_BITS_PER_SAMPLE_16:
-	                {
-	                    if (fmt_chunk.bitsPerSample == WAVE_BITS_PER_SAMPLE_24)
-	                    {
-	                        data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(conversion::Calculate24To16Size(data_chunk_size) + sizeof(WaveChunkData)));
-	                        conversion::Convert24To16(reinterpret_cast<unsigned char *>(utils::add(data_WaveChunkData, sizeof(WaveChunkData))), data_chunk.data, data_chunk_size);
-
-	                        // const SMPL_Chunk smpl_chunk = GetChunkFromData<SMPL_Chunk>(SMPL_CHUNK_ID);
-	                        // m_StartPosition = conversion::Calculate24To16Size(smpl_chunk.samples[0].start) * sizeof(uint24_t);
-	                        // m_EndPosition = conversion::Calculate24To16Size(smpl_chunk.samples[0].end) * sizeof(uint24_t);
-	                        break;
-	                    }
-	                    else if (fmt_chunk.bitsPerSample == WAVE_BITS_PER_SAMPLE_32)
-	                    {
-	                        data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(conversion::Calculate32To16Size(data_chunk_size) + sizeof(WaveChunkData)));
-	                        conversion::Convert32To16(reinterpret_cast<unsigned char *>(utils::add(data_WaveChunkData, sizeof(WaveChunkData))), data_chunk.data, data_chunk_size);
-
-	                        // const SMPL_Chunk smpl_chunk = GetChunkFromData<SMPL_Chunk>(SMPL_CHUNK_ID);
-	                        // m_StartPosition = conversion::Calculate32To16Size(smpl_chunk.samples[0].start) * sizeof(uint32_t);
-	                        // m_EndPosition = conversion::Calculate32To16Size(smpl_chunk.samples[0].end) * sizeof(uint32_t);
-	                        break;
-	                    }
-	                    break;
-	                }
-	                default:
-	                    return;
-                }
+        // The engine plays 8-bit, 16-bit, 24-bit and 32-bit floats. Data goes to the bits per sample of the config (up or down), a config of 0 keeps the bits per sample.
+        // 32-bit integers and 64-bit floats then go to 32-bit floats, which keep 24 bits of each sample.
+        conversion::ConversionFormat target = source;
+        SAMPLE_FORMAT target_sample_format = conversion::IsPlayableSampleFormat(source_sample_format) ? source_sample_format : SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32;
+        const SAMPLE_FORMAT config_sample_format = conversion::GetSampleFormat(0, a_WaveConfig.bitsPerSample);
+        if (conversion::IsPlayableSampleFormat(config_sample_format))
+            target_sample_format = config_sample_format;
+        else if (a_WaveConfig.bitsPerSample != 0)
+            logger::log_warning("<WaveFormat> The engine does not play %s%u%s bits per sample, the sound gets %s%u%s bits per sample instead.", logger::COLOR_YELLOW, a_WaveConfig.bitsPerSample, logger::COLOR_WHITE, logger::COLOR_YELLOW, conversion::GetBitsPerSample(target_sample_format), logger::COLOR_WHITE);
+        target.bitsPerSample = conversion::GetBitsPerSample(target_sample_format);
+        target.audioFormat = conversion::GetAudioFormat(target_sample_format);
 
-                // TODO: Maybe go through all chunks to update positions in loop points?
+        // A number of channels of 0 means that the config does not care about the number of channels.
+        if (a_WaveConfig.numChannels != 0 && a_WaveConfig.numChannels <= UAUDIO_MAX_SPEAKERS)
+        {
+            target.numChannels = a_WaveConfig.numChannels;
+            target.channelMask = a_WaveConfig.channelMask != 0 ? a_WaveConfig.channelMask : conversion::GetDefaultChannelMask(a_WaveConfig.numChannels);
+        }
 
-                if (data_WaveChunkData != nullptr)
-                {
-                    UAUDIO_DEFAULT_MEMCPY(data_WaveChunkData->chunk_id, DATA_CHUNK_ID, CHUNK_ID_SIZE);
-                    data_WaveChunkData->chunkSize = data_chunk_size;
-                }
-                fmt_chunk.audioFormat = WAV_FORMAT_PCM;
-                fmt_chunk.bitsPerSample = a_WaveConfig.bitsPerSample;
-                fmt_chunk.blockAlign = fmt_chunk.numChannels * fmt_chunk.bitsPerSample / 8;
-                fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.numChannels * fmt_chunk.bitsPerSample / 8;
+        conversion::ConversionPlan plan;
+        if (!plan.Init(source, target, a_WaveConfig.dither) || plan.IsEmpty())
+            return;
 
-                WaveChunkData *fmt_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(sizeof(FMT_Chunk) + sizeof(WaveChunkData)));
-                if (fmt_WaveChunkData != nullptr)
-                {
-                    UAUDIO_DEFAULT_MEMCPY(fmt_WaveChunkData->chunk_id, FMT_CHUNK_ID, CHUNK_ID_SIZE);
-                    fmt_WaveChunkData->chunkSize = GetChunkSize(FMT_CHUNK_ID);
-                    UAUDIO_DEFAULT_MEMCPY(utils::add(fmt_WaveChunkData, sizeof(WaveChunkData)), reinterpret_cast<const char *>(&fmt_chunk), sizeof(FMT_Chunk));
-                }
+        const DATA_Chunk data_chunk = GetChunkFromData<DATA_Chunk>(DATA_CHUNK_ID);
+        uint32_t data_chunk_size = GetChunkSize(DATA_CHUNK_ID);
 
-                if (data_WaveChunkData != nullptr)
-                {
-                    RemoveChunk(FMT_CHUNK_ID);
-                    AddChunk(fmt_WaveChunkData);
+        WaveChunkData *data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(plan.CalculateSize(data_chunk_size) + sizeof(WaveChunkData)));
+        if (data_WaveChunkData == nullptr)
+            return;
 
-                    RemoveChunk(DATA_CHUNK_ID);
-                    AddChunk(data_WaveChunkData);
-                }
-            }
+        plan.Convert(reinterpret_cast<unsigned char *>(utils::add(data_WaveChunkData, sizeof(WaveChunkData))), data_chunk.data, data_chunk_size, a_WaveConfig.conversionThreads);
+        UAUDIO_DEFAULT_MEMCPY(data_WaveChunkData->chunk_id, DATA_CHUNK_ID, CHUNK_ID_SIZE);
+        data_WaveChunkData->chunkSize = data_chunk_size;
+
+        fmt_chunk.audioFormat = target.audioFormat;
+        fmt_chunk.bitsPerSample = target.bitsPerSample;
+        fmt_chunk.numChannels = target.numChannels;
+        fmt_chunk.blockAlign = fmt_chunk.numChannels * fmt_chunk.bitsPerSample / 8;
+        fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+        SetFormat(fmt_chunk, plan.ConvertsChannels() ? target.channelMask : GetChannelMask());
+
+        RemoveChunk(DATA_CHUNK_ID);
+        AddChunk(data_WaveChunkData);
     }
 
     /// <summary>
-    /// Converts the audio data to the right channel setting if that has been stated in the config.
+    /// Converts the audio data to the right sample rate if that has been stated in the config.
+    /// Loop points, cue points and the sample length get moved along with the data.
     /// </summary>
     /// <param name="a_WaveConfig">The config containing specific loading instructions.</param>
-    void WaveFormat::MonoStereoConvert(WaveConfig &a_WaveConfig)
+    void WaveFormat::SampleRateConvert(WaveConfig &a_WaveConfig)
     {
-        FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        const FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
 
-        // Check if the number of channels in the config is mono or stereo (anything other than 1 or 2 means unspecified)
-        if (a_WaveConfig.numChannels == WAVE_CHANNELS_STEREO || a_WaveConfig.numChannels == WAVE_CHANNELS_MONO)
-            // Check if the number of channels in the config and the number of channels in the chunk is equal.
-            if (fmt_chunk.numChannels != a_WaveConfig.numChannels)
+        // A sample rate of 0 means that the config does not care about the sample rate.
+        if (a_WaveConfig.sampleRate == 0 || fmt_chunk.sampleRate == 0 || fmt_chunk.sampleRate == a_WaveConfig.sampleRate)
+            return;
+
+        if (fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_8 && fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_16 && fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_24 && fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_32)
+            return;
+
+        const uint32_t source_rate = fmt_chunk.sampleRate;
+        const uint32_t target_rate = a_WaveConfig.sampleRate;
+
+        const uint16_t block_align = fmt_chunk.numChannels * fmt_chunk.bitsPerSample / 8;
+        if (block_align == 0)
+            return;
+
+        // The resampler only takes whole frames, a partial frame at the end gets left out.
+        const DATA_Chunk data_chunk = GetChunkFromData<DATA_Chunk>(DATA_CHUNK_ID);
+        uint32_t data_chunk_size = GetChunkSize(DATA_CHUNK_ID);
+        data_chunk_size -= data_chunk_size % block_align;
+
+        WaveChunkData *data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(conversion::CalculateResampleSize(data_chunk_size, block_align, source_rate, target_rate) + sizeof(WaveChunkData)));
+        if (data_WaveChunkData == nullptr)
+            return;
+
+        conversion::Resample(reinterpret_cast<unsigned char *>(utils::add(data_WaveChunkData, sizeof(WaveChunkData))), data_chunk.data, data_chunk_size, fmt_chunk.bitsPerSample, fmt_chunk.numChannels, source_rate, target_rate);
+        UAUDIO_DEFAULT_MEMCPY(data_WaveChunkData->chunk_id, DATA_CHUNK_ID, CHUNK_ID_SIZE);
+        data_WaveChunkData->chunkSize = data_chunk_size;
+
+        RemoveChunk(DATA_CHUNK_ID);
+        AddChunk(data_WaveChunkData);
+
+        // The fmt chunk keeps the same size, so it can be changed in place.
+        FMT_Chunk *fmt_buffer = reinterpret_cast<FMT_Chunk *>(GetChunkBuffer(FMT_CHUNK_ID));
+        fmt_buffer->sampleRate = target_rate;
+        fmt_buffer->byteRate = target_rate * block_align;
+
+        // The sample period is the duration of one frame in nanoseconds.
+        if (HasChunk(SMPL_CHUNK_ID))
+        {
+            SMPL_Chunk *smpl_buffer = reinterpret_cast<SMPL_Chunk *>(GetChunkBuffer(SMPL_CHUNK_ID));
+            smpl_buffer->sample_period = static_cast<uint32_t>(1000000000ull / target_rate);
+        }
+
+        ScalePositions(target_rate, source_rate);
+    }
+
+    /// <summary>
+    /// Changes the duration of the audio data (without changing the pitch) if that has been stated in the config.
+    /// Loop points, cue points and the sample length get moved along with the data.
+    /// </summary>
+    /// <param name="a_WaveConfig">The config containing specific loading instructions.</param>
+    void WaveFormat::TimeStretchConvert(WaveConfig &a_WaveConfig)
+    {
+        const FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+
+        const float tempo = utils::clamp(a_WaveConfig.tempo, UAUDIO_MIN_TEMPO, UAUDIO_MAX_TEMPO);
+        if (tempo == 1.0f)
+            return;
+
+        if (fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_8 && fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_16 && fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_24 && fmt_chunk.bitsPerSample != WAVE_BITS_PER_SAMPLE_32)
+            return;
+
+        const uint16_t block_align = fmt_chunk.numChannels * fmt_chunk.bitsPerSample / 8;
+        if (block_align == 0 || fmt_chunk.sampleRate == 0)
+            return;
+
+        // The time-stretcher only takes whole frames, a partial frame at the end gets left out.
+        const DATA_Chunk data_chunk = GetChunkFromData<DATA_Chunk>(DATA_CHUNK_ID);
+        uint32_t data_chunk_size = GetChunkSize(DATA_CHUNK_ID);
+        data_chunk_size -= data_chunk_size % block_align;
+
+        WaveChunkData *data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(conversion::CalculateTimeStretchSize(data_chunk_size, block_align, tempo) + sizeof(WaveChunkData)));
+        if (data_WaveChunkData == nullptr)
+            return;
+
+        conversion::TimeStretch(reinterpret_cast<unsigned char *>(utils::add(data_WaveChunkData, sizeof(WaveChunkData))), data_chunk.data, data_chunk_size, fmt_chunk.bitsPerSample, fmt_chunk.numChannels, fmt_chunk.sampleRate, tempo);
+        UAUDIO_DEFAULT_MEMCPY(data_WaveChunkData->chunk_id, DATA_CHUNK_ID, CHUNK_ID_SIZE);
+        data_WaveChunkData->chunkSize = data_chunk_size;
+
+        RemoveChunk(DATA_CHUNK_ID);
+        AddChunk(data_WaveChunkData);
+
+        ScalePositions(1.0, tempo);
+    }
+
+    /// <summary>
+    /// Moves the loop points, cue points and the sample length after the data got longer or shorter.
+    /// </summary>
+    /// <param name="a_Numerator">The numerator of the scale.</param>
+    /// <param name="a_Denominator">The denominator of the scale.</param>
+    void WaveFormat::ScalePositions(double a_Numerator, double a_Denominator)
+    {
+        const auto scale = [a_Numerator, a_Denominator](uint32_t a_Position)
+        {
+            return static_cast<uint32_t>(std::llround(static_cast<double>(a_Position) * a_Numerator / a_Denominator));
+        };
+
+        // Loop points (in frames). The fraction is a fraction of a frame and gets carried over.
+        if (HasChunk(SMPL_CHUNK_ID))
+        {
+            const SMPL_Chunk smpl_chunk = GetChunkFromData<SMPL_Chunk>(SMPL_CHUNK_ID);
+            for (uint32_t i = 0; i < smpl_chunk.num_sample_loops; i++)
             {
-                WaveChunkData *data_WaveChunkData = nullptr;
-                const DATA_Chunk data_chunk = GetChunkFromData<DATA_Chunk>(DATA_CHUNK_ID);
-                uint32_t data_chunk_size = GetChunkSize(DATA_CHUNK_ID);
+                SMPL_Sample_Loop &loop = smpl_chunk.samples[i];
+                loop.start = scale(loop.start);
 
-                if (a_WaveConfig.numChannels == WAVE_CHANNELS_STEREO)
-                {
-                    data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(conversion::CalculateMonoToStereoSize(data_chunk_size) + sizeof(WaveChunkData)));
-                    conversion::ConvertMonoToStereo(reinterpret_cast<unsigned char *>(utils::add(data_WaveChunkData, sizeof(WaveChunkData))), data_chunk.data, data_chunk_size, fmt_chunk.blockAlign);
-                }
-                else if (a_WaveConfig.numChannels == WAVE_CHANNELS_MONO)
-                {
-                    data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(conversion::CalculateStereoToMonoSize(data_chunk_size) + sizeof(WaveChunkData)));
-                    conversion::ConvertStereoToMono(reinterpret_cast<unsigned char *>(utils::add(data_WaveChunkData, sizeof(WaveChunkData))), data_chunk.data, data_chunk_size, fmt_chunk.blockAlign);
-                }
+                const double end = (static_cast<double>(loop.end) + static_cast<double>(loop.fraction) / 4294967296.0) * a_Numerator / a_Denominator;
+                loop.end = static_cast<uint32_t>(end);
+                loop.fraction = static_cast<uint32_t>((end - static_cast<double>(loop.end)) * 4294967296.0);
+            }
+        }
 
-                if (data_WaveChunkData != nullptr)
-                {
-                    UAUDIO_DEFAULT_MEMCPY(data_WaveChunkData->chunk_id, DATA_CHUNK_ID, CHUNK_ID_SIZE);
-                    data_WaveChunkData->chunkSize = data_chunk_size;
-                }
+        // Cue points (in frames).
+        if (HasChunk(CUE_CHUNK_ID))
+        {
+            const CUE_Chunk cue_chunk = GetChunkFromData<CUE_Chunk>(CUE_CHUNK_ID);
+            for (uint32_t i = 0; i < cue_chunk.num_cue_points; i++)
+            {
+                cue_chunk.cue_points[i].position = scale(cue_chunk.cue_points[i].position);
+                cue_chunk.cue_points[i].sample_offset = scale(cue_chunk.cue_points[i].sample_offset);
+            }
+        }
 
-                fmt_chunk.numChannels = a_WaveConfig.numChannels;
-                fmt_chunk.blockAlign = fmt_chunk.numChannels * fmt_chunk.bitsPerSample / 8;
-                fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.numChannels * fmt_chunk.bitsPerSample / 8;
+        // Sample length (in frames).
+        if (HasChunk(FACT_CHUNK_ID))
+        {
+            FACT_Chunk *fact_buffer = reinterpret_cast<FACT_Chunk *>(GetChunkBuffer(FACT_CHUNK_ID));
+            fact_buffer->sample_length = scale(fact_buffer->sample_length);
+        }
+    }
 
-                WaveChunkData *fmt_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(sizeof(FMT_Chunk) + sizeof(WaveChunkData)));
-                if (fmt_WaveChunkData != nullptr)
-                {
-                    UAUDIO_DEFAULT_MEMCPY(fmt_WaveChunkData->chunk_id, FMT_CHUNK_ID, CHUNK_ID_SIZE);
-                    fmt_WaveChunkData->chunkSize = GetChunkSize(FMT_CHUNK_ID);
-                    UAUDIO_DEFAULT_MEMCPY(utils::add(fmt_WaveChunkData, sizeof(WaveChunkData)), reinterpret_cast<const char *>(&fmt_chunk), sizeof(FMT_Chunk));
-                }
+    /// <summary>
+    /// Finds the part of the data between the silence at the start and the silence at the end.
+    /// </summary>
+    /// <param name="a_Threshold">The level below which a frame is silent (in dB).</param>
+    /// <param name="a_StartPosition">The position of the first frame that is not silent (in bytes).</param>
+    /// <param name="a_EndPosition">The position after the last frame that is not silent (in bytes).</param>
+    /// <returns>Whether there is a frame that is not silent (if not, both positions are 0).</returns>
+    bool WaveFormat::FindAudibleRange(float a_Threshold, uint32_t &a_StartPosition, uint32_t &a_EndPosition) const
+    {
+        a_StartPosition = 0;
+        a_EndPosition = 0;
+        if (!HasChunk(DATA_CHUNK_ID) || !HasChunk(FMT_CHUNK_ID))
+            return false;
 
-                if (data_WaveChunkData != nullptr && fmt_WaveChunkData != nullptr)
-                {
-                    RemoveChunk(FMT_CHUNK_ID);
-                    AddChunk(fmt_WaveChunkData);
+        const FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        if (GetAudioFormat() != WAV_FORMAT_PCM && GetAudioFormat() != WAV_FORMAT_IEEE_FLOAT)
+            return false;
 
-                    RemoveChunk(DATA_CHUNK_ID);
-                    AddChunk(data_WaveChunkData);
-                }
+        uint32_t first_frame = 0, end_frame = 0;
+        if (!conversion::FindAudibleFrames(GetChunkBuffer(DATA_CHUNK_ID), GetChunkSize(DATA_CHUNK_ID), fmt_chunk.bitsPerSample, fmt_chunk.numChannels, a_Threshold, first_frame, end_frame))
+            return false;
+
+        a_StartPosition = first_frame * fmt_chunk.blockAlign;
+        a_EndPosition = end_frame * fmt_chunk.blockAlign;
+        return true;
+    }
+
+    /// <summary>
+    /// Removes the data before the start position and after the end position (the data chunk gets a new allocation of the new size).
+    /// Loop points, cue points and the sample length get moved along with the data.
+    /// </summary>
+    /// <param name="a_StartPosition">The position of the first frame that is kept (in bytes).</param>
+    /// <param name="a_EndPosition">The position after the last frame that is kept (in bytes).</param>
+    void WaveFormat::Trim(uint32_t a_StartPosition, uint32_t a_EndPosition)
+    {
+        const FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        if (fmt_chunk.blockAlign == 0 || !HasChunk(DATA_CHUNK_ID))
+            return;
+
+        // Whole frames only.
+        const uint32_t data_chunk_size = GetChunkSize(DATA_CHUNK_ID);
+        const uint32_t first_frame = utils::clamp<uint32_t>(a_StartPosition, 0, data_chunk_size) / fmt_chunk.blockAlign;
+        const uint32_t end_frame = utils::clamp<uint32_t>(a_EndPosition, a_StartPosition, data_chunk_size) / fmt_chunk.blockAlign;
+        const uint32_t num_frames = end_frame - first_frame;
+        const uint32_t size = num_frames * fmt_chunk.blockAlign;
+        if (size == data_chunk_size)
+            return;
+
+        WaveChunkData *data_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(size + sizeof(WaveChunkData)));
+        if (data_WaveChunkData == nullptr)
+            return;
+
+        UAUDIO_DEFAULT_MEMCPY(utils::add(data_WaveChunkData, sizeof(WaveChunkData)), GetChunkBuffer(DATA_CHUNK_ID) + first_frame * fmt_chunk.blockAlign, size);
+        UAUDIO_DEFAULT_MEMCPY(data_WaveChunkData->chunk_id, DATA_CHUNK_ID, CHUNK_ID_SIZE);
+        data_WaveChunkData->chunkSize = size;
+
+        RemoveChunk(DATA_CHUNK_ID);
+        AddChunk(data_WaveChunkData);
+
+        // Positions before the first frame move to the start, positions after the last frame move to the end.
+        const auto shift = [first_frame, num_frames](uint32_t a_Frame)
+        {
+            return a_Frame < first_frame ? 0 : std::min(a_Frame - first_frame, num_frames);
+        };
+
+        // Loop points (in frames). The loop end is the last frame of the loop, so it stays inside the data.
+        if (HasChunk(SMPL_CHUNK_ID))
+        {
+            const SMPL_Chunk smpl_chunk = GetChunkFromData<SMPL_Chunk>(SMPL_CHUNK_ID);
+            for (uint32_t i = 0; i < smpl_chunk.num_sample_loops; i++)
+            {
+                SMPL_Sample_Loop &loop = smpl_chunk.samples[i];
+                const uint32_t last_frame = num_frames == 0 ? 0 : num_frames - 1;
+                loop.start = std::min(shift(loop.start), last_frame);
+                loop.end = std::min(shift(loop.end), last_frame);
+            }
+        }
+
+        // Cue points (in frames).
+        if (HasChunk(CUE_CHUNK_ID))
+        {
+            const CUE_Chunk cue_chunk = GetChunkFromData<CUE_Chunk>(CUE_CHUNK_ID);
+            for (uint32_t i = 0; i < cue_chunk.num_cue_points; i++)
+            {
+                cue_chunk.cue_points[i].position = shift(cue_chunk.cue_points[i].position);
+                cue_chunk.cue_points[i].sample_offset = shift(cue_chunk.cue_points[i].sample_offset);
             }
+        }
+
+        // Sample length (in frames).
+        if (HasChunk(FACT_CHUNK_ID))
+        {
+            FACT_Chunk *fact_buffer = reinterpret_cast<FACT_Chunk *>(GetChunkBuffer(FACT_CHUNK_ID));
+            fact_buffer->sample_length = num_frames;
+        }
+    }
+
+    /// <summary>
+    /// Replaces the fmt chunk. Files with more than 2 channels or a speaker layout that is not the default get the WAVE_FORMAT_EXTENSIBLE fields.
+    /// </summary>
+    /// <param name="a_FmtChunk">The format (with the actual audio format, not WAV_FORMAT_EXTENSIBLE).</param>
+    /// <param name="a_ChannelMask">The speaker layout (0 means the default for the number of channels).</param>
+    void WaveFormat::SetFormat(const FMT_Chunk &a_FmtChunk, uint32_t a_ChannelMask)
+    {
+        const uint32_t default_mask = conversion::GetDefaultChannelMask(a_FmtChunk.numChannels);
+        if (a_ChannelMask == 0)
+            a_ChannelMask = default_mask;
+
+        const bool extensible = a_FmtChunk.numChannels > WAVE_CHANNELS_STEREO || a_ChannelMask != default_mask;
+        const uint32_t chunk_size = extensible ? FMT_CHUNK_EXTENSIBLE_SIZE : static_cast<uint32_t>(sizeof(FMT_Chunk));
+
+        WaveChunkData *fmt_WaveChunkData = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(chunk_size + sizeof(WaveChunkData)));
+        if (fmt_WaveChunkData == nullptr)
+            return;
+
+        UAUDIO_DEFAULT_MEMCPY(fmt_WaveChunkData->chunk_id, FMT_CHUNK_ID, CHUNK_ID_SIZE);
+        fmt_WaveChunkData->chunkSize = chunk_size;
+
+        FMT_Extensible_Chunk fmt_chunk(nullptr);
+        fmt_chunk.audioFormat = extensible ? WAV_FORMAT_EXTENSIBLE : a_FmtChunk.audioFormat;
+        fmt_chunk.numChannels = a_FmtChunk.numChannels;
+        fmt_chunk.sampleRate = a_FmtChunk.sampleRate;
+        fmt_chunk.byteRate = a_FmtChunk.byteRate;
+        fmt_chunk.blockAlign = a_FmtChunk.blockAlign;
+        fmt_chunk.bitsPerSample = a_FmtChunk.bitsPerSample;
+        if (extensible)
+        {
+            // KSDATAFORMAT_SUBTYPE_PCM and KSDATAFORMAT_SUBTYPE_IEEE_FLOAT only differ in the audio format at the start.
+            constexpr unsigned char sub_format[16] = {0, 0, 0, 0, 0x10, 0, 0x80, 0, 0, 0xAA, 0, 0x38, 0x9B, 0x71};
+            fmt_chunk.extensionSize = static_cast<uint16_t>(FMT_CHUNK_EXTENSIBLE_SIZE - sizeof(FMT_Chunk) - sizeof(uint16_t));
+            fmt_chunk.validBitsPerSample = a_FmtChunk.bitsPerSample;
+            fmt_chunk.channelMask = a_ChannelMask;
+            UAUDIO_DEFAULT_MEMCPY(fmt_chunk.subFormat, sub_format, sizeof(sub_format));
+            fmt_chunk.subFormat[0] = static_cast<unsigned char>(a_FmtChunk.audioFormat & 0xFF);
+            fmt_chunk.subFormat[1] = static_cast<unsigned char>(a_FmtChunk.audioFormat >> 8);
+        }
+        UAUDIO_DEFAULT_MEMCPY(utils::add(fmt_WaveChunkData, sizeof(WaveChunkData)), reinterpret_cast<const char *>(&fmt_chunk), chunk_size);
+
+        RemoveChunk(FMT_CHUNK_ID);
+        AddChunk(fmt_WaveChunkData);
+    }
+
+    /// <summary>
+    /// Returns the audio format (for WAVE_FORMAT_EXTENSIBLE files this is the audio format in the sub format).
+    /// </summary>
+    /// <returns></returns>
+    uint16_t WaveFormat::GetAudioFormat() const
+    {
+        const FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        if (fmt_chunk.audioFormat != WAV_FORMAT_EXTENSIBLE || GetChunkSize(FMT_CHUNK_ID) < FMT_CHUNK_EXTENSIBLE_SIZE)
+            return fmt_chunk.audioFormat;
+
+        const FMT_Extensible_Chunk fmt_extensible_chunk = GetChunkFromData<FMT_Extensible_Chunk>(FMT_CHUNK_ID);
+        return static_cast<uint16_t>(fmt_extensible_chunk.subFormat[0] | (fmt_extensible_chunk.subFormat[1] << 8));
+    }
+
+    /// <summary>
+    /// Returns which speakers the channels belong to (the default layout for the number of channels if the file does not say).
+    /// </summary>
+    /// <returns></returns>
+    uint32_t WaveFormat::GetChannelMask() const
+    {
+        const FMT_Chunk fmt_chunk = GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+        if (fmt_chunk.audioFormat == WAV_FORMAT_EXTENSIBLE && GetChunkSize(FMT_CHUNK_ID) >= FMT_CHUNK_EXTENSIBLE_SIZE)
+        {
+            const FMT_Extensible_Chunk fmt_extensible_chunk = GetChunkFromData<FMT_Extensible_Chunk>(FMT_CHUNK_ID);
+            if (fmt_extensible_chunk.channelMask != 0)
+                return fmt_extensible_chunk.channelMask;
+        }
+        return conversion::GetDefaultChannelMask(fmt_chunk.numChannels);
+    }
+
+    /// <summary>
+    /// Returns whether the data stays in the file (the sound was loaded with the stream setting).
+    /// </summary>
+    /// <returns></returns>
+    bool WaveFormat::IsStreaming() const
+    {
+        return m_Streaming;
+    }
+
+    /// <summary>
+    /// Returns where the data of a streamed sound starts in the file.
+    /// </summary>
+    /// <returns>The offset (in bytes).</returns>
+    uint32_t WaveFormat::GetStreamOffset() const
+    {
+        return m_StreamOffset;
+    }
+
+    /// <summary>
+    /// Returns the size of the data, also when it stays in the file.
+    /// </summary>
+    /// <returns>The size (in bytes).</returns>
+    uint32_t WaveFormat::GetDataSize() const
+    {
+        return m_Streaming ? m_StreamSize : GetChunkSize(DATA_CHUNK_ID);
+    }
+
+    /// <summary>
+    /// Returns the size of the file that the sound was loaded from (0 if it was not loaded from a file).
+    /// </summary>
+    /// <returns></returns>
+    uint32_t WaveFormat::GetFileSize() const
+    {
+        return m_FileSize;
+    }
+
+    /// <summary>
+    /// Returns whether the data chunk is a view into the mapped file (it did not get converted).
+    /// </summary>
+    /// <returns></returns>
+    bool WaveFormat::IsMapped() const
+    {
+        return m_MappedFile != nullptr && m_MappedFile->Contains(GetChunkBuffer(DATA_CHUNK_ID));
+    }
+
+    /// <summary>
+    /// Asks the system to read a part of the data of a mapped sound in the background, so the pages are there when it plays.
+    /// Does nothing for a sound that is in memory.
+    /// </summary>
+    /// <param name="a_Position">The start of the part in the data (in bytes).</param>
+    /// <param name="a_Size">The size of the part (in bytes).</param>
+    void WaveFormat::Prefetch(uint32_t a_Position, uint32_t a_Size) const
+    {
+        if (!IsMapped())
+            return;
+
+        const unsigned char *data = GetChunkBuffer(DATA_CHUNK_ID);
+        const uint32_t data_size = GetChunkSize(DATA_CHUNK_ID);
+        if (a_Position >= data_size)
+            return;
+
+        m_MappedFile->Prefetch(static_cast<size_t>(data - m_MappedFile->GetData()) + a_Position, std::min(a_Size, data_size - a_Position));
     }
 }
@@ -0,0 +1,641 @@
+#include <uaudio/wave/low_level/WaveKernels.h>
+
+#include <algorithm>
+
+#include <uaudio/Defines.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UAUDIO_KERNELS_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+	#define UAUDIO_KERNELS_NEON
+	#include <arm_neon.h>
+#endif
+
+// The SSSE3 and AVX2 versions get compiled for their instruction set on their own (MSVC does not need that for intrinsics).
+#if defined(__GNUC__) || defined(__clang__)
+	#define UAUDIO_KERNELS_TARGET(x) __attribute__((target(x)))
+#else
+	#define UAUDIO_KERNELS_TARGET(x)
+#endif
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		constexpr float READ_8_SCALE = 1.0f / INT8_SCALE;
+		constexpr float READ_16_SCALE = 1.0f / INT16_SCALE;
+		constexpr float READ_24_SCALE = 1.0f / INT24_SCALE;
+
+		namespace
+		{
+			/// <summary>
+			/// Returns the average of two 16-bit samples, rounded to the nearest even number (like std::lrint).
+			/// </summary>
+			/// <param name="a_Sum">The sum of the two samples.</param>
+			/// <returns></returns>
+			inline int32_t AverageSum(int32_t a_Sum)
+			{
+				const int32_t half = a_Sum >> 1;
+				return half + (half & a_Sum & 1);
+			}
+
+			// Scalar (the reference for the other versions).
+
+			void Read8Scalar(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				for (uint32_t i = 0; i < a_NumSamples; i++)
+					a_Samples[i] = UINT8_SAMPLES.values[a_Data[i]];
+			}
+
+			void Read16Scalar(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				for (uint32_t i = 0; i < a_NumSamples; i++)
+					a_Samples[i] = ReadSample<WAVE_BITS_PER_SAMPLE_16>(a_Data + i * sizeof(int16_t));
+			}
+
+			void Read24Scalar(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				for (uint32_t i = 0; i < a_NumSamples; i++)
+					a_Samples[i] = ReadSample<WAVE_BITS_PER_SAMPLE_24>(a_Data + i * 3);
+			}
+
+			void Write16Scalar(unsigned char *a_Data, const float *a_Samples, uint32_t a_NumSamples)
+			{
+				for (uint32_t i = 0; i < a_NumSamples; i++)
+					WriteSample<WAVE_BITS_PER_SAMPLE_16>(a_Data + i * sizeof(int16_t), a_Samples[i]);
+			}
+
+			void MonoToStereo16Scalar(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				for (uint32_t i = 0; i < a_NumFrames; i++)
+				{
+					UAUDIO_DEFAULT_MEMCPY(a_Data + i * 4, a_OriginalData + i * 2, 2);
+					UAUDIO_DEFAULT_MEMCPY(a_Data + i * 4 + 2, a_OriginalData + i * 2, 2);
+				}
+			}
+
+			void MonoToStereo32Scalar(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				for (uint32_t i = 0; i < a_NumFrames; i++)
+				{
+					UAUDIO_DEFAULT_MEMCPY(a_Data + i * 8, a_OriginalData + i * 4, 4);
+					UAUDIO_DEFAULT_MEMCPY(a_Data + i * 8 + 4, a_OriginalData + i * 4, 4);
+				}
+			}
+
+			void StereoToMono16Scalar(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				for (uint32_t i = 0; i < a_NumFrames; i++)
+				{
+					int16_t frame[2];
+					UAUDIO_DEFAULT_MEMCPY(frame, a_OriginalData + i * 4, sizeof(frame));
+					const int16_t value = static_cast<int16_t>(AverageSum(frame[0] + frame[1]));
+					UAUDIO_DEFAULT_MEMCPY(a_Data + i * 2, &value, sizeof(value));
+				}
+			}
+
+			void StereoToMono32Scalar(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				for (uint32_t i = 0; i < a_NumFrames; i++)
+				{
+					float frame[2];
+					UAUDIO_DEFAULT_MEMCPY(frame, a_OriginalData + i * 8, sizeof(frame));
+					const float value = frame[0] * 0.5f + frame[1] * 0.5f;
+					UAUDIO_DEFAULT_MEMCPY(a_Data + i * 4, &value, sizeof(value));
+				}
+			}
+
+			const ConversionKernels SCALAR_KERNELS = {SIMD_LEVEL::SIMD_LEVEL_SCALAR, Read8Scalar, Read16Scalar, Read24Scalar, Write16Scalar, MonoToStereo16Scalar, MonoToStereo32Scalar, StereoToMono16Scalar, StereoToMono32Scalar};
+
+#if defined(UAUDIO_KERNELS_X86)
+			// SSE2 (every x64 cpu).
+
+			/// <summary>
+			/// Averages the left and right samples of 4 stereo frames (16-bit) as 32-bit integers.
+			/// </summary>
+			/// <param name="a_Frames">The frames.</param>
+			/// <returns></returns>
+			inline __m128i AverageFrames16(__m128i a_Frames)
+			{
+				const __m128i left = _mm_srai_epi32(_mm_slli_epi32(a_Frames, 16), 16);
+				const __m128i right = _mm_srai_epi32(a_Frames, 16);
+				const __m128i sum = _mm_add_epi32(left, right);
+				const __m128i half = _mm_srai_epi32(sum, 1);
+				return _mm_add_epi32(half, _mm_and_si128(_mm_and_si128(half, sum), _mm_set1_epi32(1)));
+			}
+
+			void Read8Sse2(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				// Widened to 16 bits (where the offset gets removed) and then to 32 bits.
+				const __m128 scale = _mm_set1_ps(READ_8_SCALE);
+				const __m128i zero = _mm_setzero_si128(), offset = _mm_set1_epi16(128);
+				uint32_t i = 0;
+				for (; i + 16 <= a_NumSamples; i += 16)
+				{
+					const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + i));
+					const __m128i low = _mm_sub_epi16(_mm_unpacklo_epi8(samples, zero), offset);
+					const __m128i high = _mm_sub_epi16(_mm_unpackhi_epi8(samples, zero), offset);
+					_mm_storeu_ps(a_Samples + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(low, low), 16)), scale));
+					_mm_storeu_ps(a_Samples + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(low, low), 16)), scale));
+					_mm_storeu_ps(a_Samples + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(high, high), 16)), scale));
+					_mm_storeu_ps(a_Samples + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(high, high), 16)), scale));
+				}
+				Read8Scalar(a_Samples + i, a_Data + i, a_NumSamples - i);
+			}
+
+			void Read16Sse2(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				const __m128 scale = _mm_set1_ps(READ_16_SCALE);
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumSamples; i += 8)
+				{
+					const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + i * sizeof(int16_t)));
+					const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+					const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+					_mm_storeu_ps(a_Samples + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+					_mm_storeu_ps(a_Samples + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+				}
+				Read16Scalar(a_Samples + i, a_Data + i * sizeof(int16_t), a_NumSamples - i);
+			}
+
+			void Write16Sse2(unsigned char *a_Data, const float *a_Samples, uint32_t a_NumSamples)
+			{
+				// The clamp keeps values that do not fit in 32 bits from wrapping around, the pack saturates the rest.
+				const __m128 scale = _mm_set1_ps(INT16_SCALE), low = _mm_set1_ps(-INT16_SCALE), high = _mm_set1_ps(INT16_SCALE - 1.0f);
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumSamples; i += 8)
+				{
+					const __m128 first = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(a_Samples + i), scale), low), high);
+					const __m128 second = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(a_Samples + i + 4), scale), low), high);
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(a_Data + i * sizeof(int16_t)), _mm_packs_epi32(_mm_cvtps_epi32(first), _mm_cvtps_epi32(second)));
+				}
+				Write16Scalar(a_Data + i * sizeof(int16_t), a_Samples + i, a_NumSamples - i);
+			}
+
+			void MonoToStereo16Sse2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumFrames; i += 8)
+				{
+					const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_OriginalData + i * 2));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(a_Data + i * 4), _mm_unpacklo_epi16(samples, samples));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(a_Data + i * 4 + 16), _mm_unpackhi_epi16(samples, samples));
+				}
+				MonoToStereo16Scalar(a_Data + i * 4, a_OriginalData + i * 2, a_NumFrames - i);
+			}
+
+			void MonoToStereo32Sse2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 4 <= a_NumFrames; i += 4)
+				{
+					const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_OriginalData + i * 4));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(a_Data + i * 8), _mm_unpacklo_epi32(samples, samples));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(a_Data + i * 8 + 16), _mm_unpackhi_epi32(samples, samples));
+				}
+				MonoToStereo32Scalar(a_Data + i * 8, a_OriginalData + i * 4, a_NumFrames - i);
+			}
+
+			void StereoToMono16Sse2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumFrames; i += 8)
+				{
+					const __m128i first = AverageFrames16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a_OriginalData + i * 4)));
+					const __m128i second = AverageFrames16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a_OriginalData + i * 4 + 16)));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(a_Data + i * 2), _mm_packs_epi32(first, second));
+				}
+				StereoToMono16Scalar(a_Data + i * 2, a_OriginalData + i * 4, a_NumFrames - i);
+			}
+
+			void StereoToMono32Sse2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				const __m128 half = _mm_set1_ps(0.5f);
+				uint32_t i = 0;
+				for (; i + 4 <= a_NumFrames; i += 4)
+				{
+					const __m128 first = _mm_loadu_ps(reinterpret_cast<const float *>(a_OriginalData + i * 8));
+					const __m128 second = _mm_loadu_ps(reinterpret_cast<const float *>(a_OriginalData + i * 8 + 16));
+					const __m128 left = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+					const __m128 right = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+					_mm_storeu_ps(reinterpret_cast<float *>(a_Data + i * 4), _mm_add_ps(_mm_mul_ps(left, half), _mm_mul_ps(right, half)));
+				}
+				StereoToMono32Scalar(a_Data + i * 4, a_OriginalData + i * 8, a_NumFrames - i);
+			}
+
+			const ConversionKernels SSE2_KERNELS = {SIMD_LEVEL::SIMD_LEVEL_SSE2, Read8Sse2, Read16Sse2, Read24Scalar, Write16Sse2, MonoToStereo16Sse2, MonoToStereo32Sse2, StereoToMono16Sse2, StereoToMono32Sse2};
+
+			// SSSE3 (the byte shuffle for 24-bit samples).
+
+			UAUDIO_KERNELS_TARGET("ssse3")
+			void Read24Ssse3(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				// Every sample goes to the top 3 bytes of a 32-bit integer, the shift back sign extends it.
+				const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+				const __m128 scale = _mm_set1_ps(READ_24_SCALE);
+
+				// A load of 16 bytes has 4 samples (12 bytes), the other 4 bytes need to be in the data as well.
+				uint32_t i = 0;
+				for (; i + 6 <= a_NumSamples; i += 4)
+				{
+					const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + i * 3));
+					const __m128i samples = _mm_srai_epi32(_mm_shuffle_epi8(bytes, shuffle), 8);
+					_mm_storeu_ps(a_Samples + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+				}
+				Read24Scalar(a_Samples + i, a_Data + i * 3, a_NumSamples - i);
+			}
+
+			const ConversionKernels SSSE3_KERNELS = {SIMD_LEVEL::SIMD_LEVEL_SSSE3, Read8Sse2, Read16Sse2, Read24Ssse3, Write16Sse2, MonoToStereo16Sse2, MonoToStereo32Sse2, StereoToMono16Sse2, StereoToMono32Sse2};
+
+			// AVX2.
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			inline __m256i AverageFrames16Avx2(__m256i a_Frames)
+			{
+				const __m256i left = _mm256_srai_epi32(_mm256_slli_epi32(a_Frames, 16), 16);
+				const __m256i right = _mm256_srai_epi32(a_Frames, 16);
+				const __m256i sum = _mm256_add_epi32(left, right);
+				const __m256i half = _mm256_srai_epi32(sum, 1);
+				return _mm256_add_epi32(half, _mm256_and_si256(_mm256_and_si256(half, sum), _mm256_set1_epi32(1)));
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void Read8Avx2(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				const __m256 scale = _mm256_set1_ps(READ_8_SCALE);
+				const __m256i offset = _mm256_set1_epi32(128);
+				uint32_t i = 0;
+				for (; i + 16 <= a_NumSamples; i += 16)
+				{
+					const __m256i first = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(a_Data + i))), offset);
+					const __m256i second = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(a_Data + i + 8))), offset);
+					_mm256_storeu_ps(a_Samples + i, _mm256_mul_ps(_mm256_cvtepi32_ps(first), scale));
+					_mm256_storeu_ps(a_Samples + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(second), scale));
+				}
+				Read8Sse2(a_Samples + i, a_Data + i, a_NumSamples - i);
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void Read16Avx2(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				const __m256 scale = _mm256_set1_ps(READ_16_SCALE);
+				uint32_t i = 0;
+				for (; i + 16 <= a_NumSamples; i += 16)
+				{
+					const __m256i first = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + i * sizeof(int16_t))));
+					const __m256i second = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + (i + 8) * sizeof(int16_t))));
+					_mm256_storeu_ps(a_Samples + i, _mm256_mul_ps(_mm256_cvtepi32_ps(first), scale));
+					_mm256_storeu_ps(a_Samples + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(second), scale));
+				}
+				Read16Sse2(a_Samples + i, a_Data + i * sizeof(int16_t), a_NumSamples - i);
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void Read24Avx2(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				// The shuffle works per 128-bit lane, so every lane gets a load of its own 4 samples.
+				const __m256i shuffle = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+				const __m256 scale = _mm256_set1_ps(READ_24_SCALE);
+
+				// The second load (at 12 bytes) reads 16 bytes, so 28 bytes need to be in the data.
+				uint32_t i = 0;
+				for (; i + 10 <= a_NumSamples; i += 8)
+				{
+					const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + i * 3));
+					const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + i * 3 + 12));
+					const __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+					const __m256i samples = _mm256_srai_epi32(_mm256_shuffle_epi8(bytes, shuffle), 8);
+					_mm256_storeu_ps(a_Samples + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+				}
+				Read24Ssse3(a_Samples + i, a_Data + i * 3, a_NumSamples - i);
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void Write16Avx2(unsigned char *a_Data, const float *a_Samples, uint32_t a_NumSamples)
+			{
+				const __m256 scale = _mm256_set1_ps(INT16_SCALE), low = _mm256_set1_ps(-INT16_SCALE), high = _mm256_set1_ps(INT16_SCALE - 1.0f);
+				uint32_t i = 0;
+				for (; i + 16 <= a_NumSamples; i += 16)
+				{
+					const __m256 first = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(a_Samples + i), scale), low), high);
+					const __m256 second = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(a_Samples + i + 8), scale), low), high);
+
+					// The pack works per 128-bit lane, the permute puts the samples back in order.
+					const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(first), _mm256_cvtps_epi32(second));
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(a_Data + i * sizeof(int16_t)), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+				}
+				Write16Sse2(a_Data + i * sizeof(int16_t), a_Samples + i, a_NumSamples - i);
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void MonoToStereo16Avx2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 16 <= a_NumFrames; i += 16)
+				{
+					const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_OriginalData + i * 2));
+					const __m256i low = _mm256_unpacklo_epi16(samples, samples);
+					const __m256i high = _mm256_unpackhi_epi16(samples, samples);
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(a_Data + i * 4), _mm256_permute2x128_si256(low, high, 0x20));
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(a_Data + i * 4 + 32), _mm256_permute2x128_si256(low, high, 0x31));
+				}
+				MonoToStereo16Sse2(a_Data + i * 4, a_OriginalData + i * 2, a_NumFrames - i);
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void MonoToStereo32Avx2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumFrames; i += 8)
+				{
+					const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_OriginalData + i * 4));
+					const __m256i low = _mm256_unpacklo_epi32(samples, samples);
+					const __m256i high = _mm256_unpackhi_epi32(samples, samples);
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(a_Data + i * 8), _mm256_permute2x128_si256(low, high, 0x20));
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(a_Data + i * 8 + 32), _mm256_permute2x128_si256(low, high, 0x31));
+				}
+				MonoToStereo32Sse2(a_Data + i * 8, a_OriginalData + i * 4, a_NumFrames - i);
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void StereoToMono16Avx2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 16 <= a_NumFrames; i += 16)
+				{
+					const __m256i first = AverageFrames16Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_OriginalData + i * 4)));
+					const __m256i second = AverageFrames16Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_OriginalData + i * 4 + 32)));
+					const __m256i packed = _mm256_packs_epi32(first, second);
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(a_Data + i * 2), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+				}
+				StereoToMono16Sse2(a_Data + i * 2, a_OriginalData + i * 4, a_NumFrames - i);
+			}
+
+			UAUDIO_KERNELS_TARGET("avx2")
+			void StereoToMono32Avx2(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				const __m256 half = _mm256_set1_ps(0.5f);
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumFrames; i += 8)
+				{
+					const __m256 first = _mm256_loadu_ps(reinterpret_cast<const float *>(a_OriginalData + i * 8));
+					const __m256 second = _mm256_loadu_ps(reinterpret_cast<const float *>(a_OriginalData + i * 8 + 32));
+
+					// The shuffle works per 128-bit lane, the permute puts the frames back in order.
+					const __m256 left = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+					const __m256 right = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+					_mm256_storeu_ps(reinterpret_cast<float *>(a_Data + i * 4), _mm256_add_ps(_mm256_mul_ps(left, half), _mm256_mul_ps(right, half)));
+				}
+				StereoToMono32Sse2(a_Data + i * 4, a_OriginalData + i * 8, a_NumFrames - i);
+			}
+
+			const ConversionKernels AVX2_KERNELS = {SIMD_LEVEL::SIMD_LEVEL_AVX2, Read8Avx2, Read16Avx2, Read24Avx2, Write16Avx2, MonoToStereo16Avx2, MonoToStereo32Avx2, StereoToMono16Avx2, StereoToMono32Avx2};
+
+			/// <summary>
+			/// Returns whether the cpu (and the system, for AVX2) supports SSSE3 and AVX2.
+			/// </summary>
+			/// <param name="a_Ssse3">Whether the cpu has SSSE3.</param>
+			/// <param name="a_Avx2">Whether the cpu has AVX2 and the system saves the AVX registers.</param>
+			void DetectX86(bool &a_Ssse3, bool &a_Avx2)
+			{
+	#if defined(_MSC_VER)
+				int info[4] = {};
+				__cpuid(info, 1);
+				a_Ssse3 = (info[2] & (1 << 9)) != 0;
+				const bool avx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+
+				__cpuidex(info, 7, 0);
+				a_Avx2 = avx && (info[1] & (1 << 5)) != 0;
+	#else
+				__builtin_cpu_init();
+				a_Ssse3 = __builtin_cpu_supports("ssse3");
+				a_Avx2 = __builtin_cpu_supports("avx2");
+	#endif
+			}
+#endif
+
+#if defined(UAUDIO_KERNELS_NEON)
+			// NEON (every arm64 cpu).
+
+			void Read8Neon(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				// The widening subtract wraps around, which gives the signed sample.
+				uint32_t i = 0;
+				for (; i + 16 <= a_NumSamples; i += 16)
+				{
+					const uint8x16_t samples = vld1q_u8(a_Data + i);
+					const int16x8_t low = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(samples), vdup_n_u8(128)));
+					const int16x8_t high = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(samples), vdup_n_u8(128)));
+					vst1q_f32(a_Samples + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(low))), READ_8_SCALE));
+					vst1q_f32(a_Samples + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(low))), READ_8_SCALE));
+					vst1q_f32(a_Samples + i + 8, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(high))), READ_8_SCALE));
+					vst1q_f32(a_Samples + i + 12, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(high))), READ_8_SCALE));
+				}
+				Read8Scalar(a_Samples + i, a_Data + i, a_NumSamples - i);
+			}
+
+			void Read16Neon(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumSamples; i += 8)
+				{
+					const int16x8_t samples = vreinterpretq_s16_u8(vld1q_u8(a_Data + i * sizeof(int16_t)));
+					vst1q_f32(a_Samples + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), READ_16_SCALE));
+					vst1q_f32(a_Samples + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), READ_16_SCALE));
+				}
+				Read16Scalar(a_Samples + i, a_Data + i * sizeof(int16_t), a_NumSamples - i);
+			}
+
+			void Read24Neon(float *a_Samples, const unsigned char *a_Data, uint32_t a_NumSamples)
+			{
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumSamples; i += 8)
+				{
+					// The 3-way load puts the first, second and third byte of 8 samples in their own register.
+					const uint8x8x3_t bytes = vld3_u8(a_Data + i * 3);
+					const uint16x8_t low = vorrq_u16(vmovl_u8(bytes.val[0]), vshll_n_u8(bytes.val[1], 8));
+					const int16x8_t high = vmovl_s8(vreinterpret_s8_u8(bytes.val[2]));
+					const int32x4_t first = vorrq_s32(vshll_n_s16(vget_low_s16(high), 16), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+					const int32x4_t second = vorrq_s32(vshll_n_s16(vget_high_s16(high), 16), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+					vst1q_f32(a_Samples + i, vmulq_n_f32(vcvtq_f32_s32(first), READ_24_SCALE));
+					vst1q_f32(a_Samples + i + 4, vmulq_n_f32(vcvtq_f32_s32(second), READ_24_SCALE));
+				}
+				Read24Scalar(a_Samples + i, a_Data + i * 3, a_NumSamples - i);
+			}
+
+			void Write16Neon(unsigned char *a_Data, const float *a_Samples, uint32_t a_NumSamples)
+			{
+				// The conversion rounds to the nearest even number and the narrow saturates.
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumSamples; i += 8)
+				{
+					const int32x4_t first = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(a_Samples + i), INT16_SCALE));
+					const int32x4_t second = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(a_Samples + i + 4), INT16_SCALE));
+					vst1q_u8(a_Data + i * sizeof(int16_t), vreinterpretq_u8_s16(vcombine_s16(vqmovn_s32(first), vqmovn_s32(second))));
+				}
+				Write16Scalar(a_Data + i * sizeof(int16_t), a_Samples + i, a_NumSamples - i);
+			}
+
+			void MonoToStereo16Neon(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumFrames; i += 8)
+				{
+					const uint16x8_t samples = vreinterpretq_u16_u8(vld1q_u8(a_OriginalData + i * 2));
+					uint16x8x2_t frames;
+					frames.val[0] = samples;
+					frames.val[1] = samples;
+					vst2q_u16(reinterpret_cast<uint16_t *>(a_Data + i * 4), frames);
+				}
+				MonoToStereo16Scalar(a_Data + i * 4, a_OriginalData + i * 2, a_NumFrames - i);
+			}
+
+			void MonoToStereo32Neon(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 4 <= a_NumFrames; i += 4)
+				{
+					const uint32x4_t samples = vreinterpretq_u32_u8(vld1q_u8(a_OriginalData + i * 4));
+					uint32x4x2_t frames;
+					frames.val[0] = samples;
+					frames.val[1] = samples;
+					vst2q_u32(reinterpret_cast<uint32_t *>(a_Data + i * 8), frames);
+				}
+				MonoToStereo32Scalar(a_Data + i * 8, a_OriginalData + i * 4, a_NumFrames - i);
+			}
+
+			void StereoToMono16Neon(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				const int32x4_t one = vdupq_n_s32(1);
+				uint32_t i = 0;
+				for (; i + 8 <= a_NumFrames; i += 8)
+				{
+					const int16x8x2_t frames = vld2q_s16(reinterpret_cast<const int16_t *>(a_OriginalData + i * 4));
+					const int32x4_t low_sum = vaddl_s16(vget_low_s16(frames.val[0]), vget_low_s16(frames.val[1]));
+					const int32x4_t high_sum = vaddl_s16(vget_high_s16(frames.val[0]), vget_high_s16(frames.val[1]));
+					const int32x4_t low_half = vshrq_n_s32(low_sum, 1);
+					const int32x4_t high_half = vshrq_n_s32(high_sum, 1);
+					const int32x4_t low = vaddq_s32(low_half, vandq_s32(vandq_s32(low_half, low_sum), one));
+					const int32x4_t high = vaddq_s32(high_half, vandq_s32(vandq_s32(high_half, high_sum), one));
+					vst1q_u8(a_Data + i * 2, vreinterpretq_u8_s16(vcombine_s16(vmovn_s32(low), vmovn_s32(high))));
+				}
+				StereoToMono16Scalar(a_Data + i * 2, a_OriginalData + i * 4, a_NumFrames - i);
+			}
+
+			void StereoToMono32Neon(unsigned char *a_Data, const unsigned char *a_OriginalData, uint32_t a_NumFrames)
+			{
+				uint32_t i = 0;
+				for (; i + 4 <= a_NumFrames; i += 4)
+				{
+					const float32x4x2_t frames = vld2q_f32(reinterpret_cast<const float *>(a_OriginalData + i * 8));
+					vst1q_f32(reinterpret_cast<float *>(a_Data + i * 4), vaddq_f32(vmulq_n_f32(frames.val[0], 0.5f), vmulq_n_f32(frames.val[1], 0.5f)));
+				}
+				StereoToMono32Scalar(a_Data + i * 4, a_OriginalData + i * 8, a_NumFrames - i);
+			}
+
+			const ConversionKernels NEON_KERNELS = {SIMD_LEVEL::SIMD_LEVEL_NEON, Read8Neon, Read16Neon, Read24Neon, Write16Neon, MonoToStereo16Neon, MonoToStereo32Neon, StereoToMono16Neon, StereoToMono32Neon};
+#endif
+
+			/// <summary>
+			/// Returns the best instruction set that the kernels have a version for and the cpu supports.
+			/// </summary>
+			/// <returns></returns>
+			SIMD_LEVEL DetectSimdLevel()
+			{
+				for (const SIMD_LEVEL simd_level : {SIMD_LEVEL::SIMD_LEVEL_NEON, SIMD_LEVEL::SIMD_LEVEL_AVX2, SIMD_LEVEL::SIMD_LEVEL_SSSE3, SIMD_LEVEL::SIMD_LEVEL_SSE2})
+					if (IsSimdLevelSupported(simd_level))
+						return simd_level;
+
+				return SIMD_LEVEL::SIMD_LEVEL_SCALAR;
+			}
+		}
+
+		/// <summary>
+		/// Returns the instruction set of the kernels that get used (detected once).
+		/// </summary>
+		/// <returns></returns>
+		SIMD_LEVEL GetSimdLevel()
+		{
+			static const SIMD_LEVEL simd_level = DetectSimdLevel();
+			return simd_level;
+		}
+
+		/// <summary>
+		/// Returns whether the kernels have a version for an instruction set and the cpu supports it.
+		/// </summary>
+		/// <param name="a_SimdLevel">The instruction set.</param>
+		/// <returns></returns>
+		bool IsSimdLevelSupported(SIMD_LEVEL a_SimdLevel)
+		{
+			switch (a_SimdLevel)
+			{
+				case SIMD_LEVEL::SIMD_LEVEL_SCALAR:
+					return true;
+#if defined(UAUDIO_KERNELS_X86)
+				case SIMD_LEVEL::SIMD_LEVEL_SSE2:
+					return true;
+				case SIMD_LEVEL::SIMD_LEVEL_SSSE3:
+				case SIMD_LEVEL::SIMD_LEVEL_AVX2:
+				{
+					static bool ssse3 = false, avx2 = false;
+					static const bool detected = (DetectX86(ssse3, avx2), true);
+					(void) detected;
+					return a_SimdLevel == SIMD_LEVEL::SIMD_LEVEL_SSSE3 ? ssse3 : avx2;
+				}
+#endif
+#if defined(UAUDIO_KERNELS_NEON)
+				case SIMD_LEVEL::SIMD_LEVEL_NEON:
+					return true;
+#endif
+				default:
+					return false;
+			}
+		}
+
+		/// <summary>
+		/// Returns the kernels for the best instruction set of the cpu.
+		/// </summary>
+		/// <returns></returns>
+		const ConversionKernels &GetConversionKernels()
+		{
+			static const ConversionKernels &kernels = GetConversionKernels(GetSimdLevel());
+			return kernels;
+		}
+
+		/// <summary>
+		/// Returns the kernels for an instruction set (to compare them, the engine uses the best one).
+		/// </summary>
+		/// <param name="a_SimdLevel">The instruction set.</param>
+		/// <returns>The kernels (the scalar kernels if the cpu does not support the instruction set).</returns>
+		const ConversionKernels &GetConversionKernels(SIMD_LEVEL a_SimdLevel)
+		{
+			if (!IsSimdLevelSupported(a_SimdLevel))
+				return SCALAR_KERNELS;
+
+			switch (a_SimdLevel)
+			{
+#if defined(UAUDIO_KERNELS_X86)
+				case SIMD_LEVEL::SIMD_LEVEL_SSE2:
+					return SSE2_KERNELS;
+				case SIMD_LEVEL::SIMD_LEVEL_SSSE3:
+					return SSSE3_KERNELS;
+				case SIMD_LEVEL::SIMD_LEVEL_AVX2:
+					return AVX2_KERNELS;
+#endif
+#if defined(UAUDIO_KERNELS_NEON)
+				case SIMD_LEVEL::SIMD_LEVEL_NEON:
+					return NEON_KERNELS;
+#endif
+				default:
+					return SCALAR_KERNELS;
+			}
+		}
+	}
+}
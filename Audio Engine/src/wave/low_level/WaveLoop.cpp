@@ -0,0 +1,446 @@
+#include <uaudio/wave/low_level/WaveLoop.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <uaudio/Defines.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UAUDIO_LOOP_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		constexpr float HALF_PI = 1.57079632679f;
+
+		// The fraction of a loop end is in 1 / 2^32 frames.
+		constexpr uint64_t LOOP_FRACTION_ONE = 4294967296ull;
+
+		namespace
+		{
+			/// <summary>
+			/// Mixes the tail of a loop with the frames that continue after the jump back (equal power).
+			/// </summary>
+			/// <param name="a_DataBuffer">The new data.</param>
+			/// <param name="a_Tail">The frames before the loop end.</param>
+			/// <param name="a_Continuation">The frames that the tail fades into.</param>
+			/// <param name="a_NumFrames">The amount of frames that need to be mixed.</param>
+			/// <param name="a_FirstFrame">The index of the first frame in the crossfade.</param>
+			/// <param name="a_CrossfadeFrames">The length of the crossfade.</param>
+			/// <param name="a_NumChannels">The number of channels.</param>
+			template <uint16_t BitsPerSample>
+			void MixCrossfade(unsigned char *a_DataBuffer, const unsigned char *a_Tail, const unsigned char *a_Continuation, uint32_t a_NumFrames, uint32_t a_FirstFrame, uint32_t a_CrossfadeFrames, uint16_t a_NumChannels)
+			{
+				constexpr uint32_t bytes_per_sample = BitsPerSample / 8;
+				for (uint32_t i = 0; i < a_NumFrames; i++)
+				{
+					const float position = (static_cast<float>(a_FirstFrame + i) + 0.5f) / static_cast<float>(a_CrossfadeFrames);
+					const float fade_in = GetEqualPowerVolume(position);
+					const float fade_out = GetEqualPowerVolume(1.0f - position);
+					for (uint16_t channel = 0; channel < a_NumChannels; channel++)
+					{
+						const uint32_t offset = (i * a_NumChannels + channel) * bytes_per_sample;
+						WriteSample<BitsPerSample>(a_DataBuffer + offset, ReadSample<BitsPerSample>(a_Tail + offset) * fade_out + ReadSample<BitsPerSample>(a_Continuation + offset) * fade_in);
+					}
+				}
+			}
+
+			/// <summary>
+			/// Copies frames of a fixed size in reverse order (the size is known, so every copy is a single move).
+			/// </summary>
+			/// <param name="a_DataBuffer">The new data.</param>
+			/// <param name="a_Data">The first frame of the original data.</param>
+			/// <param name="a_First">The first frame that needs to be copied.</param>
+			/// <param name="a_NumFrames">The number of frames.</param>
+			template <uint32_t BlockAlign>
+			void ReverseFixedFrames(unsigned char *a_DataBuffer, const unsigned char *a_Data, uint32_t a_First, uint32_t a_NumFrames)
+			{
+				for (uint32_t i = a_First; i < a_NumFrames; i++)
+					UAUDIO_DEFAULT_MEMCPY(a_DataBuffer + i * BlockAlign, a_Data + (a_NumFrames - 1 - i) * BlockAlign, BlockAlign);
+			}
+
+			// Where the read continues after a forward loop, and what the tail of the loop gets mixed with.
+			struct LoopCrossfade
+			{
+				uint32_t size = 0;
+				uint32_t restart = 0;
+				const unsigned char *continuation = nullptr;
+			};
+
+			/// <summary>
+			/// Calculates the crossfade of a forward loop.
+			/// </summary>
+			/// <param name="a_Data">The data chunk.</param>
+			/// <param name="a_Start">The loop start (in bytes).</param>
+			/// <param name="a_End">The loop end (in bytes).</param>
+			/// <param name="a_Frames">The length of the crossfade (in frames).</param>
+			/// <param name="a_BlockAlign">The block align.</param>
+			/// <returns>The crossfade.</returns>
+			LoopCrossfade GetLoopCrossfade(const unsigned char *a_Data, uint32_t a_Start, uint32_t a_End, uint32_t a_Frames, uint32_t a_BlockAlign)
+			{
+				LoopCrossfade crossfade;
+				crossfade.restart = a_Start;
+				crossfade.continuation = a_Data + a_Start;
+				if (a_Frames == 0)
+					return crossfade;
+
+				// Use the frames before the loop start when there are enough of them, otherwise the first frames of the loop (which get skipped after the jump back).
+				const uint32_t loop_frames = (a_End - a_Start) / a_BlockAlign;
+				if (a_Start / a_BlockAlign >= a_Frames && a_Frames <= loop_frames)
+				{
+					crossfade.size = a_Frames * a_BlockAlign;
+					crossfade.continuation = a_Data + a_Start - crossfade.size;
+				}
+				else
+				{
+					crossfade.size = std::min(a_Frames, loop_frames / 2) * a_BlockAlign;
+					crossfade.restart = a_Start + crossfade.size;
+				}
+				return crossfade;
+			}
+
+			/// <summary>
+			/// Returns whether a loop of the smpl chunk is done playing.
+			/// </summary>
+			/// <param name="a_Loop">The loop.</param>
+			/// <param name="a_State">The loop state.</param>
+			/// <returns></returns>
+			bool IsLoopFinished(const SMPL_Sample_Loop &a_Loop, const LoopState &a_State)
+			{
+				if (a_Loop.play_count == 0)
+					return a_State.released;
+				return a_State.count >= a_Loop.play_count;
+			}
+
+			/// <summary>
+			/// Moves on to the next loop of the smpl chunk (a release only ends one sustain loop).
+			/// </summary>
+			/// <param name="a_Loop">The loop that is done.</param>
+			/// <param name="a_State">The loop state.</param>
+			void NextLoop(const SMPL_Sample_Loop &a_Loop, LoopState &a_State)
+			{
+				if (a_Loop.play_count == 0)
+					a_State.released = false;
+				a_State.loop++;
+				a_State.count = 0;
+				a_State.fraction = 0;
+				a_State.reverse = false;
+			}
+		}
+
+		/// <summary>
+		/// Returns the volume of an equal power fade in (sin), 1 - position gives the fade out.
+		/// </summary>
+		/// <param name="a_Position">The position in the fade (0 to 1).</param>
+		/// <returns></returns>
+		float GetEqualPowerVolume(float a_Position)
+		{
+			if (a_Position <= 0.0f)
+				return 0.0f;
+			if (a_Position >= 1.0f)
+				return 1.0f;
+			return std::sin(HALF_PI * a_Position);
+		}
+
+		/// <summary>
+		/// Copies frames in reverse order, the last frame becomes the first frame (the samples in a frame keep their order).
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data (a_NumFrames * a_BlockAlign bytes).</param>
+		/// <param name="a_Data">The first frame of the original data.</param>
+		/// <param name="a_NumFrames">The number of frames.</param>
+		/// <param name="a_BlockAlign">The size of a frame.</param>
+		void ReverseFrames(unsigned char *a_DataBuffer, const unsigned char *a_Data, uint32_t a_NumFrames, uint32_t a_BlockAlign)
+		{
+			uint32_t i = 0;
+#if defined(UAUDIO_LOOP_SSE2)
+			// One register holds 16 bytes, the frames in it get reversed with shuffles.
+			switch (a_BlockAlign)
+			{
+				case BLOCK_ALIGN_16_BIT_MONO:
+				{
+					for (; i + 8 <= a_NumFrames; i += 8)
+					{
+						__m128i frames = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + (a_NumFrames - i - 8) * BLOCK_ALIGN_16_BIT_MONO));
+						frames = _mm_shufflelo_epi16(frames, _MM_SHUFFLE(0, 1, 2, 3));
+						frames = _mm_shufflehi_epi16(frames, _MM_SHUFFLE(0, 1, 2, 3));
+						frames = _mm_shuffle_epi32(frames, _MM_SHUFFLE(1, 0, 3, 2));
+						_mm_storeu_si128(reinterpret_cast<__m128i *>(a_DataBuffer + i * BLOCK_ALIGN_16_BIT_MONO), frames);
+					}
+					break;
+				}
+				case BLOCK_ALIGN_16_BIT_STEREO:
+				{
+					for (; i + 8 <= a_NumFrames; i += 8)
+					{
+						const unsigned char *data = a_Data + (a_NumFrames - i - 8) * BLOCK_ALIGN_16_BIT_STEREO;
+						const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+						const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+						_mm_storeu_si128(reinterpret_cast<__m128i *>(a_DataBuffer + i * BLOCK_ALIGN_16_BIT_STEREO), _mm_shuffle_epi32(first, _MM_SHUFFLE(0, 1, 2, 3)));
+						_mm_storeu_si128(reinterpret_cast<__m128i *>(a_DataBuffer + i * BLOCK_ALIGN_16_BIT_STEREO + 16), _mm_shuffle_epi32(second, _MM_SHUFFLE(0, 1, 2, 3)));
+					}
+					break;
+				}
+				case BLOCK_ALIGN_32_BIT_STEREO:
+				{
+					for (; i + 2 <= a_NumFrames; i += 2)
+					{
+						const __m128i frames = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + (a_NumFrames - i - 2) * BLOCK_ALIGN_32_BIT_STEREO));
+						_mm_storeu_si128(reinterpret_cast<__m128i *>(a_DataBuffer + i * BLOCK_ALIGN_32_BIT_STEREO), _mm_shuffle_epi32(frames, _MM_SHUFFLE(1, 0, 3, 2)));
+					}
+					break;
+				}
+				default:
+					break;
+			}
+#endif
+			switch (a_BlockAlign)
+			{
+				case BLOCK_ALIGN_16_BIT_MONO:
+				{
+					ReverseFixedFrames<BLOCK_ALIGN_16_BIT_MONO>(a_DataBuffer, a_Data, i, a_NumFrames);
+					break;
+				}
+				case BLOCK_ALIGN_24_BIT_MONO:
+				{
+					ReverseFixedFrames<BLOCK_ALIGN_24_BIT_MONO>(a_DataBuffer, a_Data, i, a_NumFrames);
+					break;
+				}
+				case BLOCK_ALIGN_16_BIT_STEREO:
+				{
+					ReverseFixedFrames<BLOCK_ALIGN_16_BIT_STEREO>(a_DataBuffer, a_Data, i, a_NumFrames);
+					break;
+				}
+				case BLOCK_ALIGN_24_BIT_STEREO:
+				{
+					ReverseFixedFrames<BLOCK_ALIGN_24_BIT_STEREO>(a_DataBuffer, a_Data, i, a_NumFrames);
+					break;
+				}
+				case BLOCK_ALIGN_32_BIT_STEREO:
+				{
+					ReverseFixedFrames<BLOCK_ALIGN_32_BIT_STEREO>(a_DataBuffer, a_Data, i, a_NumFrames);
+					break;
+				}
+				default:
+				{
+					for (; i < a_NumFrames; i++)
+						UAUDIO_DEFAULT_MEMCPY(a_DataBuffer + i * a_BlockAlign, a_Data + (a_NumFrames - 1 - i) * a_BlockAlign, a_BlockAlign);
+					break;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Copies the data of a sound from a position and wraps around the loops at the exact frame.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data (at least a_Size bytes).</param>
+		/// <param name="a_Size">The amount of bytes that need to be read.</param>
+		/// <param name="a_Data">The data chunk.</param>
+		/// <param name="a_DataSize">The size of the data chunk.</param>
+		/// <param name="a_Position">The read position (will get changed).</param>
+		/// <param name="a_State">Where the read is in the loops of the smpl chunk (will get changed).</param>
+		/// <param name="a_Loop">The loop settings.</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <returns>The amount of bytes that have been read (less than a_Size when the sound ends).</returns>
+		uint32_t ReadLooped(unsigned char *a_DataBuffer, uint32_t a_Size, const unsigned char *a_Data, uint32_t a_DataSize, uint32_t &a_Position, LoopState &a_State, const LoopSettings &a_Loop, uint16_t a_BitsPerSample, uint16_t a_NumChannels)
+		{
+			const uint32_t block_align = a_BitsPerSample / 8 * a_NumChannels;
+			if (block_align == 0)
+				return 0;
+
+			// Everything happens on whole frames.
+			const uint32_t size = a_Size - a_Size % block_align;
+			const uint32_t end = std::min(a_Loop.end, a_DataSize) / block_align * block_align;
+			const uint32_t start = std::min(a_Loop.start / block_align * block_align, end);
+			const bool looping = a_Loop.looping && end > start;
+			const bool can_crossfade = a_BitsPerSample == WAVE_BITS_PER_SAMPLE_8 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_16 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_24 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_32;
+
+			uint32_t written = 0;
+			while (written < size)
+			{
+				unsigned char *data = a_DataBuffer + written;
+
+				// Find the loop of the smpl chunk that plays next (loops that are outside of the range or behind the read position get skipped).
+				const SMPL_Sample_Loop *sample_loop = nullptr;
+				uint32_t loop_start = 0, loop_end = 0;
+				while (a_State.loop < a_Loop.numSampleLoops)
+				{
+					const SMPL_Sample_Loop &candidate = a_Loop.sampleLoops[a_State.loop];
+
+					// The end is the last frame of the loop, the fraction makes the pass one frame longer when it adds up to a whole frame (as long as that frame is in the range).
+					const uint64_t candidate_start = static_cast<uint64_t>(candidate.start) * block_align;
+					uint64_t candidate_end = (static_cast<uint64_t>(candidate.end) + 1) * block_align;
+					const bool in_range = candidate.type <= static_cast<uint32_t>(LOOP_TYPE::LOOP_TYPE_REVERSE) && candidate_start >= start && candidate_start < candidate_end && candidate_end <= end;
+					if (a_State.fraction + static_cast<uint64_t>(candidate.fraction) >= LOOP_FRACTION_ONE)
+						candidate_end = std::min<uint64_t>(candidate_end + block_align, end);
+					if (in_range && (a_State.reverse || a_Position <= candidate_end))
+					{
+						sample_loop = &candidate;
+						loop_start = static_cast<uint32_t>(candidate_start);
+						loop_end = static_cast<uint32_t>(candidate_end);
+						break;
+					}
+					NextLoop(candidate, a_State);
+				}
+
+				// Loops of one frame cannot change direction.
+				LOOP_TYPE type = LOOP_TYPE::LOOP_TYPE_FORWARD;
+				if (sample_loop != nullptr && loop_end - loop_start >= 2 * block_align)
+					type = static_cast<LOOP_TYPE>(sample_loop->type);
+
+				if (sample_loop == nullptr || type == LOOP_TYPE::LOOP_TYPE_FORWARD)
+					a_State.reverse = false;
+
+				// Backwards to the loop start.
+				if (a_State.reverse)
+				{
+					if (a_Position <= loop_start)
+					{
+						if (type == LOOP_TYPE::LOOP_TYPE_PING_PONG)
+						{
+							// The loop start has just been played, so the read continues after it.
+							a_State.count++;
+							a_State.reverse = false;
+							a_Position = loop_start + block_align;
+							continue;
+						}
+
+						// A reverse loop starts again at the loop end, or continues after the loop when it is done.
+						a_State.count++;
+						a_Position = loop_end;
+						if (IsLoopFinished(*sample_loop, a_State))
+							NextLoop(*sample_loop, a_State);
+						else
+							a_State.fraction += sample_loop->fraction;
+						continue;
+					}
+
+					const uint32_t count = std::min(size - written, a_Position - loop_start);
+					ReverseFrames(data, a_Data + a_Position - count, count / block_align, block_align);
+					a_Position -= count;
+					written += count;
+					continue;
+				}
+
+				// Forwards to the end of the loop (or the end of the range).
+				const uint32_t boundary = sample_loop != nullptr ? loop_end : end;
+
+				// Only forward loops that will jump back get crossfaded.
+				LoopCrossfade crossfade;
+				crossfade.restart = start;
+				const uint32_t crossfade_frames = can_crossfade ? a_Loop.crossfade : 0;
+				if (sample_loop == nullptr && looping)
+					crossfade = GetLoopCrossfade(a_Data, start, end, crossfade_frames, block_align);
+				else if (type == LOOP_TYPE::LOOP_TYPE_FORWARD && sample_loop != nullptr)
+				{
+					LoopState next_state = a_State;
+					next_state.count++;
+					crossfade = GetLoopCrossfade(a_Data, loop_start, loop_end, IsLoopFinished(*sample_loop, next_state) ? 0 : crossfade_frames, block_align);
+				}
+
+				if (a_Position >= boundary)
+				{
+					if (sample_loop == nullptr)
+					{
+						if (!looping)
+							break;
+
+						// The whole range starts again, and so do the loops in it.
+						a_Position = crossfade.restart;
+						a_State = LoopState();
+						continue;
+					}
+
+					switch (type)
+					{
+						case LOOP_TYPE::LOOP_TYPE_FORWARD:
+						{
+							a_State.count++;
+							if (IsLoopFinished(*sample_loop, a_State))
+								NextLoop(*sample_loop, a_State);
+							else
+							{
+								a_Position = crossfade.restart;
+								a_State.fraction += sample_loop->fraction;
+							}
+							break;
+						}
+						case LOOP_TYPE::LOOP_TYPE_PING_PONG:
+						{
+							a_State.count++;
+							if (IsLoopFinished(*sample_loop, a_State))
+								NextLoop(*sample_loop, a_State);
+							else
+							{
+								// The loop end has just been played, so the read continues before it.
+								a_State.reverse = true;
+								a_State.fraction += sample_loop->fraction;
+								a_Position = loop_end - block_align;
+							}
+							break;
+						}
+						case LOOP_TYPE::LOOP_TYPE_REVERSE:
+						{
+							if (IsLoopFinished(*sample_loop, a_State))
+								NextLoop(*sample_loop, a_State);
+							else
+							{
+								a_State.reverse = true;
+								a_Position = loop_end - block_align;
+							}
+							break;
+						}
+					}
+					continue;
+				}
+
+				const uint32_t count = std::min(size - written, boundary - a_Position);
+				const uint32_t crossfade_start = boundary - crossfade.size;
+
+				// The part before the crossfade is a plain copy.
+				const uint32_t plain = a_Position < crossfade_start ? std::min(count, crossfade_start - a_Position) : 0;
+				UAUDIO_DEFAULT_MEMCPY(data, a_Data + a_Position, plain);
+
+				if (count > plain)
+				{
+					const uint32_t offset = a_Position + plain - crossfade_start;
+					const uint32_t num_frames = (count - plain) / block_align;
+					const uint32_t first_frame = offset / block_align;
+					switch (a_BitsPerSample)
+					{
+						case WAVE_BITS_PER_SAMPLE_8:
+						{
+							MixCrossfade<WAVE_BITS_PER_SAMPLE_8>(data + plain, a_Data + crossfade_start + offset, crossfade.continuation + offset, num_frames, first_frame, crossfade.size / block_align, a_NumChannels);
+							break;
+						}
+						case WAVE_BITS_PER_SAMPLE_16:
+						{
+							MixCrossfade<WAVE_BITS_PER_SAMPLE_16>(data + plain, a_Data + crossfade_start + offset, crossfade.continuation + offset, num_frames, first_frame, crossfade.size / block_align, a_NumChannels);
+							break;
+						}
+						case WAVE_BITS_PER_SAMPLE_24:
+						{
+							MixCrossfade<WAVE_BITS_PER_SAMPLE_24>(data + plain, a_Data + crossfade_start + offset, crossfade.continuation + offset, num_frames, first_frame, crossfade.size / block_align, a_NumChannels);
+							break;
+						}
+						case WAVE_BITS_PER_SAMPLE_32:
+						{
+							MixCrossfade<WAVE_BITS_PER_SAMPLE_32>(data + plain, a_Data + crossfade_start + offset, crossfade.continuation + offset, num_frames, first_frame, crossfade.size / block_align, a_NumChannels);
+							break;
+						}
+						default:
+							break;
+					}
+				}
+
+				a_Position += count;
+				written += count;
+			}
+			return written;
+		}
+	}
+}
@@ -0,0 +1,374 @@
+#include <uaudio/wave/low_level/WaveLoudness.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <uaudio/utils/Denormals.h>
+#include <uaudio/utils/Utils.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define UAUDIO_LOUDNESS_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace uaudio
+{
+	namespace effects
+	{
+		constexpr double LOUDNESS_PI = 3.14159265358979323846;
+
+		// The oversampling filter of the true peak: 4 phases of 12 taps.
+		constexpr uint32_t TRUE_PEAK_PHASES = 4;
+		constexpr uint32_t TRUE_PEAK_TAPS = 12;
+
+		// The relative gates (in LU below the average) of the integrated loudness and the loudness range.
+		constexpr float LOUDNESS_RELATIVE_GATE = -10.0f;
+		constexpr float RANGE_RELATIVE_GATE = -20.0f;
+
+		// The loudness range is the spread between these percentiles of the short-term loudness.
+		constexpr float RANGE_LOW_PERCENTILE = 0.10f;
+		constexpr float RANGE_HIGH_PERCENTILE = 0.95f;
+
+		// Parts that are shorter than this (in blocks, 10 seconds) do not get a thread of their own.
+		constexpr uint32_t LOUDNESS_MIN_PART_BLOCKS = 100;
+
+		namespace
+		{
+			// The taps of the oversampling filter, every tap has the coefficients of the 4 phases next to each other.
+			struct TruePeakFilter
+			{
+				TruePeakFilter()
+				{
+					// A windowed sinc (Blackman) with the cutoff at the original Nyquist frequency.
+					constexpr uint32_t length = TRUE_PEAK_TAPS * TRUE_PEAK_PHASES;
+					double taps[length] = {};
+					for (uint32_t i = 0; i < length; i++)
+					{
+						const double t = (static_cast<double>(i) - (length - 1) / 2.0) / TRUE_PEAK_PHASES;
+						const double sinc = t == 0.0 ? 1.0 : std::sin(LOUDNESS_PI * t) / (LOUDNESS_PI * t);
+						const double position = (static_cast<double>(i) + 0.5) / length;
+						const double window = 0.42 - 0.5 * std::cos(2.0 * LOUDNESS_PI * position) + 0.08 * std::cos(4.0 * LOUDNESS_PI * position);
+						taps[i] = sinc * window;
+					}
+
+					// Every phase passes DC at unity gain.
+					for (uint32_t phase = 0; phase < TRUE_PEAK_PHASES; phase++)
+					{
+						double sum = 0.0;
+						for (uint32_t tap = 0; tap < TRUE_PEAK_TAPS; tap++)
+							sum += taps[tap * TRUE_PEAK_PHASES + phase];
+						for (uint32_t tap = 0; tap < TRUE_PEAK_TAPS; tap++)
+							coefficients[tap][phase] = static_cast<float>(taps[tap * TRUE_PEAK_PHASES + phase] / sum);
+					}
+				}
+
+				alignas(16) float coefficients[TRUE_PEAK_TAPS][TRUE_PEAK_PHASES] = {};
+			};
+
+			const TruePeakFilter &GetTruePeakFilter()
+			{
+				static const TruePeakFilter filter;
+				return filter;
+			}
+
+			/// <summary>
+			/// Oversamples a line of samples of one channel and returns the highest peak.
+			/// </summary>
+			/// <param name="a_Line">The samples (the first 11 are the samples before the ones that get measured).</param>
+			/// <param name="a_NumFrames">The amount of samples that get measured.</param>
+			/// <returns>The highest peak (a volume).</returns>
+			float GetOversampledPeak(const float *a_Line, uint32_t a_NumFrames)
+			{
+				const TruePeakFilter &filter = GetTruePeakFilter();
+#if defined(UAUDIO_LOUDNESS_SSE)
+				__m128 coefficients[TRUE_PEAK_TAPS];
+				for (uint32_t tap = 0; tap < TRUE_PEAK_TAPS; tap++)
+					coefficients[tap] = _mm_load_ps(filter.coefficients[tap]);
+
+				const __m128 zero = _mm_setzero_ps();
+				__m128 peak = zero;
+				for (uint32_t i = 0; i < a_NumFrames; i++)
+				{
+					// The 4 phases at once, every tap multiplies one sample with the coefficients of all phases.
+					const float *samples = a_Line + i + TRUE_PEAK_TAPS - 1;
+					__m128 sum = zero;
+					for (uint32_t tap = 0; tap < TRUE_PEAK_TAPS; tap++)
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(*(samples - tap)), coefficients[tap]));
+					peak = _mm_max_ps(peak, _mm_max_ps(sum, _mm_sub_ps(zero, sum)));
+				}
+
+				alignas(16) float lanes[TRUE_PEAK_PHASES];
+				_mm_store_ps(lanes, peak);
+				return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#else
+				float peak = 0.0f;
+				for (uint32_t i = 0; i < a_NumFrames; i++)
+				{
+					const float *samples = a_Line + i + TRUE_PEAK_TAPS - 1;
+					for (uint32_t phase = 0; phase < TRUE_PEAK_PHASES; phase++)
+					{
+						float sum = 0.0f;
+						for (uint32_t tap = 0; tap < TRUE_PEAK_TAPS; tap++)
+							sum += *(samples - tap) * filter.coefficients[tap][phase];
+						peak = std::max(peak, std::fabs(sum));
+					}
+				}
+				return peak;
+#endif
+			}
+
+			// The true peak of all channels, the last samples of every channel are kept for the next call.
+			class TruePeak
+			{
+			public:
+				TruePeak(uint16_t a_NumChannels, uint32_t a_MaxFrames) : m_NumChannels(a_NumChannels), m_Stride(a_MaxFrames + TRUE_PEAK_TAPS - 1), m_Lines(static_cast<size_t>(m_Stride) * a_NumChannels, 0.0f)
+				{ }
+
+				/// <summary>
+				/// Adds interleaved frames.
+				/// </summary>
+				/// <param name="a_Samples">The samples.</param>
+				/// <param name="a_NumFrames">The amount of frames (at most the amount that was given to the constructor).</param>
+				/// <param name="a_Measure">Whether the frames count (otherwise they only fill the filter).</param>
+				void Process(const float *a_Samples, uint32_t a_NumFrames, bool a_Measure)
+				{
+					for (uint16_t channel = 0; channel < m_NumChannels; channel++)
+					{
+						float *line = m_Lines.data() + static_cast<size_t>(channel) * m_Stride;
+						for (uint32_t i = 0; i < a_NumFrames; i++)
+							line[TRUE_PEAK_TAPS - 1 + i] = a_Samples[i * m_NumChannels + channel];
+
+						if (a_Measure)
+							m_Peak = std::max(m_Peak, GetOversampledPeak(line, a_NumFrames));
+
+						memmove(line, line + a_NumFrames, (TRUE_PEAK_TAPS - 1) * sizeof(float));
+					}
+				}
+
+				/// <summary>
+				/// Measures what the filter still holds after the last frame.
+				/// </summary>
+				void Flush()
+				{
+					const float silence[(TRUE_PEAK_TAPS - 1) * UAUDIO_MAX_SPEAKERS] = {};
+					Process(silence, std::min<uint32_t>(TRUE_PEAK_TAPS - 1, m_Stride - (TRUE_PEAK_TAPS - 1)), true);
+				}
+
+				float GetPeak() const
+				{
+					return m_Peak;
+				}
+
+			private:
+				uint16_t m_NumChannels = 0;
+				uint32_t m_Stride = 0;
+				std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> m_Lines;
+				float m_Peak = 0.0f;
+			};
+
+			// A part of a sound that gets measured on its own thread.
+			struct LoudnessPart
+			{
+				uint32_t firstBlock = 0;
+				uint32_t endBlock = 0;
+				uint32_t endFrame = 0;
+				float truePeak = 0.0f;
+			};
+
+			/// <summary>
+			/// Measures the energy of the blocks of a part and its true peak.
+			/// </summary>
+			/// <param name="a_Part">The part.</param>
+			/// <param name="a_Data">The pcm data.</param>
+			/// <param name="a_BitsPerSample">The bits per sample.</param>
+			/// <param name="a_NumChannels">The number of channels.</param>
+			/// <param name="a_ChannelMask">Which speaker every channel belongs to.</param>
+			/// <param name="a_SampleRate">The sample rate.</param>
+			/// <param name="a_Energies">The energy of every block of the sound (the part only writes its own blocks).</param>
+			/// <param name="a_Last">Whether this is the last part (the filter of the true peak gets flushed).</param>
+			void MeasurePart(LoudnessPart &a_Part, const unsigned char *a_Data, uint16_t a_BitsPerSample, uint16_t a_NumChannels, uint32_t a_ChannelMask, uint32_t a_SampleRate, float *a_Energies, bool a_Last)
+			{
+				// The first part runs on the thread that loads the sound, the guard sets its mode back afterwards.
+				utils::DenormalGuard denormal_guard;
+
+				Meter meter;
+				meter.Init(a_SampleRate, a_NumChannels, a_ChannelMask);
+
+				const uint32_t block_frames = std::max(a_SampleRate / METER_BLOCKS_PER_SECOND, 1u);
+				const uint32_t block_align = a_BitsPerSample / 8 * a_NumChannels;
+				std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> samples(static_cast<size_t>(block_frames) * a_NumChannels);
+				TruePeak true_peak(a_NumChannels, block_frames);
+
+				// The block before the part only lets the filters settle.
+				const uint32_t first_block = a_Part.firstBlock > 0 ? a_Part.firstBlock - 1 : 0;
+				for (uint32_t frame = first_block * block_frames; frame < a_Part.endFrame; frame += block_frames)
+				{
+					const uint32_t block = frame / block_frames;
+					const uint32_t num_frames = std::min(block_frames, a_Part.endFrame - frame);
+					conversion::ReadSamples(samples.data(), a_Data + static_cast<size_t>(frame) * block_align, num_frames * a_NumChannels, a_BitsPerSample);
+
+					const bool measure = block >= a_Part.firstBlock;
+					if (meter.Process(samples.data(), num_frames * a_NumChannels) && measure && block < a_Part.endBlock)
+						a_Energies[block] = meter.GetLast().energy;
+					true_peak.Process(samples.data(), num_frames, measure);
+				}
+
+				if (a_Last)
+					true_peak.Flush();
+				a_Part.truePeak = true_peak.GetPeak();
+			}
+
+			/// <summary>
+			/// Returns the average energy of the blocks that are louder than a gate.
+			/// </summary>
+			/// <param name="a_Energies">The energies.</param>
+			/// <param name="a_Gate">The gate (in LUFS).</param>
+			/// <returns>The average energy (0 if no block is louder).</returns>
+			double GetGatedEnergy(const std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> &a_Energies, float a_Gate)
+			{
+				double sum = 0.0;
+				uint32_t count = 0;
+				for (const float energy : a_Energies)
+					if (GetLoudness(energy) > a_Gate)
+					{
+						sum += energy;
+						count++;
+					}
+				return count == 0 ? 0.0 : sum / count;
+			}
+
+			/// <summary>
+			/// Returns the average energy of every window of blocks (one window per block, from the first block where the window is full).
+			/// </summary>
+			/// <param name="a_Energies">The energy of every block.</param>
+			/// <param name="a_NumBlocks">The amount of blocks in a window.</param>
+			/// <returns>The energies of the windows.</returns>
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> GetWindows(const std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> &a_Energies, uint32_t a_NumBlocks)
+			{
+				std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> windows;
+				if (a_Energies.size() < a_NumBlocks)
+					return windows;
+
+				windows.reserve(a_Energies.size() - a_NumBlocks + 1);
+				double sum = 0.0;
+				for (size_t i = 0; i < a_Energies.size(); i++)
+				{
+					sum += a_Energies[i];
+					if (i >= a_NumBlocks)
+						sum -= a_Energies[i - a_NumBlocks];
+					if (i + 1 >= a_NumBlocks)
+						windows.push_back(static_cast<float>(std::max(sum, 0.0) / a_NumBlocks));
+				}
+				return windows;
+			}
+		}
+
+		/// <summary>
+		/// Measures the integrated loudness, the loudness range and the true peak of a sound.
+		/// </summary>
+		/// <param name="a_Data">The pcm data.</param>
+		/// <param name="a_Size">The size of the data (in bytes).</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <param name="a_ChannelMask">Which speaker every channel belongs to.</param>
+		/// <param name="a_SampleRate">The sample rate.</param>
+		/// <param name="a_NumThreads">The amount of threads (0 means one per core, short sounds use less).</param>
+		/// <returns>The measurement.</returns>
+		LoudnessMeasurement MeasureLoudness(const unsigned char *a_Data, uint32_t a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, uint32_t a_ChannelMask, uint32_t a_SampleRate, uint32_t a_NumThreads)
+		{
+			LoudnessMeasurement measurement;
+			if (a_Data == nullptr || a_NumChannels == 0 || a_NumChannels > UAUDIO_MAX_SPEAKERS || a_SampleRate == 0)
+				return measurement;
+			if (a_BitsPerSample != WAVE_BITS_PER_SAMPLE_8 && a_BitsPerSample != WAVE_BITS_PER_SAMPLE_16 && a_BitsPerSample != WAVE_BITS_PER_SAMPLE_24 && a_BitsPerSample != WAVE_BITS_PER_SAMPLE_32)
+				return measurement;
+
+			const uint32_t block_align = a_BitsPerSample / 8 * a_NumChannels;
+			const uint32_t num_frames = a_Size / block_align;
+			const uint32_t block_frames = std::max(a_SampleRate / METER_BLOCKS_PER_SECOND, 1u);
+			const uint32_t num_blocks = num_frames / block_frames;
+
+			// The parts, the last one also has the frames after the last whole block.
+			uint32_t num_threads = a_NumThreads == 0 ? std::thread::hardware_concurrency() : a_NumThreads;
+			num_threads = utils::clamp(num_threads, 1u, std::max(num_blocks / LOUDNESS_MIN_PART_BLOCKS, 1u));
+
+			std::vector<LoudnessPart> parts(num_threads);
+			for (uint32_t i = 0; i < num_threads; i++)
+			{
+				parts[i].firstBlock = static_cast<uint32_t>(static_cast<uint64_t>(num_blocks) * i / num_threads);
+				parts[i].endBlock = static_cast<uint32_t>(static_cast<uint64_t>(num_blocks) * (i + 1) / num_threads);
+				parts[i].endFrame = i + 1 == num_threads ? num_frames : parts[i].endBlock * block_frames;
+			}
+
+			std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> energies(num_blocks, 0.0f);
+			std::vector<std::thread> threads;
+			for (uint32_t i = 1; i < num_threads; i++)
+				threads.emplace_back(MeasurePart, std::ref(parts[i]), a_Data, a_BitsPerSample, a_NumChannels, a_ChannelMask, a_SampleRate, energies.data(), i + 1 == num_threads);
+			MeasurePart(parts[0], a_Data, a_BitsPerSample, a_NumChannels, a_ChannelMask, a_SampleRate, energies.data(), num_threads == 1);
+			for (std::thread &thread : threads)
+				thread.join();
+
+			float true_peak = 0.0f;
+			for (const LoudnessPart &part : parts)
+				true_peak = std::max(true_peak, part.truePeak);
+			measurement.truePeak = GetDecibels(true_peak);
+
+			// Integrated loudness: the momentary blocks above the absolute gate, and then the ones above the relative gate.
+			const std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> momentary = GetWindows(energies, METER_MOMENTARY_BLOCKS);
+			const double absolute = GetGatedEnergy(momentary, METER_SILENCE);
+			if (absolute > 0.0)
+			{
+				const float relative = GetLoudness(static_cast<float>(absolute)) + LOUDNESS_RELATIVE_GATE;
+				measurement.integrated = GetLoudness(static_cast<float>(GetGatedEnergy(momentary, std::max(relative, METER_SILENCE))));
+				measurement.maxMomentary = GetLoudness(*std::max_element(momentary.begin(), momentary.end()));
+			}
+
+			// Loudness range: the spread of the short-term loudness above both gates.
+			const std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> short_term = GetWindows(energies, METER_SHORT_TERM_BLOCKS);
+			const double short_term_absolute = GetGatedEnergy(short_term, METER_SILENCE);
+			if (short_term_absolute > 0.0)
+			{
+				measurement.maxShortTerm = GetLoudness(*std::max_element(short_term.begin(), short_term.end()));
+
+				const float relative = std::max(GetLoudness(static_cast<float>(short_term_absolute)) + RANGE_RELATIVE_GATE, METER_SILENCE);
+				std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> levels;
+				for (const float energy : short_term)
+					if (GetLoudness(energy) > relative)
+						levels.push_back(GetLoudness(energy));
+
+				if (!levels.empty())
+				{
+					std::sort(levels.begin(), levels.end());
+					const size_t last = levels.size() - 1;
+					const float low = levels[static_cast<size_t>(std::lround(last * RANGE_LOW_PERCENTILE))];
+					const float high = levels[static_cast<size_t>(std::lround(last * RANGE_HIGH_PERCENTILE))];
+					measurement.range = high - low;
+				}
+			}
+
+			return measurement;
+		}
+
+		/// <summary>
+		/// Returns the volume that brings a sound to a loudness, lowered if the true peak would go above a maximum.
+		/// </summary>
+		/// <param name="a_Measurement">The measurement of the sound.</param>
+		/// <param name="a_TargetLoudness">The loudness (in LUFS).</param>
+		/// <param name="a_MaxTruePeak">The highest true peak (in dBTP).</param>
+		/// <returns>The volume (1 for silent sounds).</returns>
+		float GetNormalizationGain(const LoudnessMeasurement &a_Measurement, float a_TargetLoudness, float a_MaxTruePeak)
+		{
+			if (a_Measurement.integrated <= METER_SILENCE)
+				return 1.0f;
+
+			float gain = a_TargetLoudness - a_Measurement.integrated;
+			if (std::isfinite(a_Measurement.truePeak))
+				gain = std::min(gain, a_MaxTruePeak - a_Measurement.truePeak);
+			return std::pow(10.0f, gain / 20.0f);
+		}
+	}
+}
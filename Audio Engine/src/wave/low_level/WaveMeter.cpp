@@ -0,0 +1,397 @@
+#include <uaudio/wave/low_level/WaveMeter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <uaudio/utils/Denormals.h>
+#include <uaudio/utils/Utils.h>
+#include <uaudio/wave/low_level/WaveChannelMixer.h>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define UAUDIO_METER_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace uaudio
+{
+	namespace effects
+	{
+		constexpr double METER_PI = 3.14159265358979323846;
+
+		// ITU-R BS.1770: the weight of surround channels and the offset of the loudness.
+		constexpr float METER_SURROUND_WEIGHT = 1.41f;
+		constexpr float METER_LOUDNESS_OFFSET = -0.691f;
+
+		// The channels are processed in groups of 4 (the lanes of a vector).
+		constexpr uint16_t METER_GROUP = 4;
+
+		namespace
+		{
+#if defined(UAUDIO_METER_SSE)
+			/// <summary>
+			/// Loads the samples of a group of channels into the lanes of a vector (the other lanes are 0).
+			/// </summary>
+			/// <param name="a_Samples">The samples.</param>
+			/// <param name="a_NumLanes">The amount of channels in the group (1 to 4).</param>
+			/// <returns>The vector.</returns>
+			inline __m128 LoadLanes(const float *a_Samples, uint16_t a_NumLanes)
+			{
+				switch (a_NumLanes)
+				{
+					case 1:
+						return _mm_load_ss(a_Samples);
+					case 2:
+						return _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(a_Samples));
+					case 3:
+						return _mm_setr_ps(a_Samples[0], a_Samples[1], a_Samples[2], 0.0f);
+					default:
+						return _mm_loadu_ps(a_Samples);
+				}
+			}
+#endif
+		}
+
+		/// <summary>
+		/// Adds the readings of a channel to the readings of a bus (peaks are the highest peak, RMS and loudness add up as power).
+		/// </summary>
+		/// <param name="a_Sum">The readings of the bus.</param>
+		/// <param name="a_Readings">The readings of the channel.</param>
+		void AddReadings(MeterReadings &a_Sum, const MeterReadings &a_Readings)
+		{
+			const uint16_t num_channels = std::min<uint16_t>(a_Readings.numChannels, UAUDIO_MAX_SPEAKERS);
+			a_Sum.numChannels = std::max(a_Sum.numChannels, num_channels);
+			for (uint16_t i = 0; i < num_channels; i++)
+			{
+				a_Sum.peak[i] = std::max(a_Sum.peak[i], a_Readings.peak[i]);
+				a_Sum.rms[i] = std::sqrt(a_Sum.rms[i] * a_Sum.rms[i] + a_Readings.rms[i] * a_Readings.rms[i]);
+			}
+			a_Sum.momentary = GetLoudness(GetMeanSquare(a_Sum.momentary) + GetMeanSquare(a_Readings.momentary));
+			a_Sum.shortTerm = GetLoudness(GetMeanSquare(a_Sum.shortTerm) + GetMeanSquare(a_Readings.shortTerm));
+			a_Sum.energy += a_Readings.energy;
+		}
+
+		/// <summary>
+		/// Turns a volume into dB (full scale).
+		/// </summary>
+		/// <param name="a_Volume">The volume.</param>
+		/// <returns>The volume in dB (minus infinity for silence).</returns>
+		float GetDecibels(float a_Volume)
+		{
+			if (a_Volume <= 0.0f)
+				return -std::numeric_limits<float>::infinity();
+			return 20.0f * std::log10(a_Volume);
+		}
+
+		/// <summary>
+		/// Turns a mean square of K-weighted samples into LUFS.
+		/// </summary>
+		/// <param name="a_MeanSquare">The mean square.</param>
+		/// <returns>The loudness (at least METER_SILENCE).</returns>
+		float GetLoudness(float a_MeanSquare)
+		{
+			if (a_MeanSquare <= 0.0f)
+				return METER_SILENCE;
+			return std::max(METER_LOUDNESS_OFFSET + 10.0f * std::log10(a_MeanSquare), METER_SILENCE);
+		}
+
+		/// <summary>
+		/// Turns LUFS back into a mean square (silence is 0, so it does not add up).
+		/// </summary>
+		/// <param name="a_Loudness">The loudness.</param>
+		/// <returns>The mean square.</returns>
+		float GetMeanSquare(float a_Loudness)
+		{
+			if (a_Loudness <= METER_SILENCE)
+				return 0.0f;
+			return std::pow(10.0f, (a_Loudness - METER_LOUDNESS_OFFSET) / 10.0f);
+		}
+
+		/// <summary>
+		/// Sets the format of the samples and calculates the K-weighting filters for the sample rate.
+		/// </summary>
+		/// <param name="a_SampleRate">The sample rate.</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <param name="a_ChannelMask">Which speaker every channel belongs to.</param>
+		void Meter::Init(uint32_t a_SampleRate, uint16_t a_NumChannels, uint32_t a_ChannelMask)
+		{
+			m_SampleRate = std::max(a_SampleRate, 1u);
+			m_NumChannels = utils::clamp<uint16_t>(a_NumChannels, WAVE_CHANNELS_MONO, UAUDIO_MAX_SPEAKERS);
+			m_BlockFrames = std::max(m_SampleRate / METER_BLOCKS_PER_SECOND, 1u);
+
+			// The high shelf (+4dB above ~1.7kHz), for any sample rate.
+			const double rate = static_cast<double>(m_SampleRate);
+			{
+				const double k = std::tan(METER_PI * 1681.974450955533 / rate);
+				const double q = 0.7071752369554196;
+				const double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+				const double vb = std::pow(vh, 0.4996667741545416);
+				const double a0 = 1.0 + k / q + k * k;
+				m_Shelf[0] = static_cast<float>((vh + vb * k / q + k * k) / a0);
+				m_Shelf[1] = static_cast<float>(2.0 * (k * k - vh) / a0);
+				m_Shelf[2] = static_cast<float>((vh - vb * k / q + k * k) / a0);
+				m_Shelf[3] = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+				m_Shelf[4] = static_cast<float>((1.0 - k / q + k * k) / a0);
+			}
+
+			// The high pass (the RLB curve, ~38Hz).
+			{
+				const double k = std::tan(METER_PI * 38.13547087602444 / rate);
+				const double q = 0.5003270373238773;
+				const double a0 = 1.0 + k / q + k * k;
+				m_HighPass[0] = 1.0f;
+				m_HighPass[1] = -2.0f;
+				m_HighPass[2] = 1.0f;
+				m_HighPass[3] = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+				m_HighPass[4] = static_cast<float>((1.0 - k / q + k * k) / a0);
+			}
+
+			std::fill(std::begin(m_Weights), std::end(m_Weights), 0.0f);
+			for (uint16_t i = 0; i < m_NumChannels; i++)
+			{
+				const uint32_t speaker = conversion::GetChannelSpeaker(a_ChannelMask, i);
+				if (speaker & WAVE_SPEAKER_LOW_FREQUENCY)
+					m_Weights[i] = 0.0f;
+				else if (speaker & (WAVE_SPEAKER_BACK_LEFT | WAVE_SPEAKER_BACK_RIGHT | WAVE_SPEAKER_BACK_CENTER | WAVE_SPEAKER_SIDE_LEFT | WAVE_SPEAKER_SIDE_RIGHT))
+					m_Weights[i] = METER_SURROUND_WEIGHT;
+				else
+					m_Weights[i] = 1.0f;
+			}
+
+			Reset();
+		}
+
+		/// <summary>
+		/// Clears the filters and the blocks (the readings that were published stay).
+		/// </summary>
+		void Meter::Reset()
+		{
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				std::fill(std::begin(m_ShelfState[i]), std::end(m_ShelfState[i]), 0.0f);
+				std::fill(std::begin(m_HighPassState[i]), std::end(m_HighPassState[i]), 0.0f);
+			}
+			std::fill(std::begin(m_Peak), std::end(m_Peak), 0.0f);
+			std::fill(std::begin(m_Square), std::end(m_Square), 0.0f);
+			std::fill(std::begin(m_Energy), std::end(m_Energy), 0.0f);
+			std::fill(std::begin(m_Frame), std::end(m_Frame), 0.0f);
+			std::fill(std::begin(m_Blocks), std::end(m_Blocks), 0.0f);
+			m_FrameChannel = 0;
+			m_Frames = 0;
+			m_Block = 0;
+			m_Last = MeterReadings();
+			m_Last.numChannels = m_NumChannels;
+		}
+
+		/// <summary>
+		/// Measures interleaved samples (frames may be split over calls).
+		/// </summary>
+		/// <param name="a_Samples">The samples.</param>
+		/// <param name="a_NumSamples">The number of samples.</param>
+		/// <returns>Whether new readings were published.</returns>
+		bool Meter::Process(const float *a_Samples, uint32_t a_NumSamples)
+		{
+			bool published = false;
+
+			// First the rest of the frame that was split.
+			while (m_FrameChannel != 0 && a_NumSamples > 0)
+			{
+				m_Frame[m_FrameChannel++] = *a_Samples++;
+				a_NumSamples--;
+				if (m_FrameChannel == m_NumChannels)
+				{
+					m_FrameChannel = 0;
+					ProcessFrames(m_Frame, 1);
+					if (++m_Frames == m_BlockFrames)
+					{
+						EndBlock();
+						published = true;
+					}
+				}
+			}
+
+			// Whole frames, up to the end of every block.
+			uint32_t num_frames = a_NumSamples / m_NumChannels;
+			while (num_frames > 0)
+			{
+				const uint32_t count = std::min(num_frames, m_BlockFrames - m_Frames);
+				ProcessFrames(a_Samples, count);
+				a_Samples += count * m_NumChannels;
+				a_NumSamples -= count * m_NumChannels;
+				num_frames -= count;
+				m_Frames += count;
+				if (m_Frames == m_BlockFrames)
+				{
+					EndBlock();
+					published = true;
+				}
+			}
+
+			// The start of a frame that continues in the next call.
+			for (uint32_t i = 0; i < a_NumSamples; i++)
+				m_Frame[m_FrameChannel++] = a_Samples[i];
+
+			return published;
+		}
+
+		/// <summary>
+		/// Returns the readings of the last block (only for the thread that processes).
+		/// </summary>
+		/// <returns>The readings.</returns>
+		const MeterReadings &Meter::GetLast() const
+		{
+			return m_Last;
+		}
+
+		/// <summary>
+		/// Returns the latest readings that were published (for one other thread, such as the UI).
+		/// </summary>
+		/// <returns>The readings.</returns>
+		MeterReadings Meter::Read()
+		{
+			return m_Readings.Read();
+		}
+
+		/// <summary>
+		/// Runs whole frames through the K-weighting filters and adds them to the sums of the block.
+		/// </summary>
+		/// <param name="a_Samples">The samples.</param>
+		/// <param name="a_NumFrames">The number of frames.</param>
+		void Meter::ProcessFrames(const float *a_Samples, uint32_t a_NumFrames)
+		{
+			// The filters get a tiny signal at half the sample rate on top of the samples, so their state never decays into denormals after a sound stops.
+			// The high pass would remove a DC offset, so that would not keep its state up. The readings do not include it.
+			const float first_guard = (m_Frames & 1) ? -utils::DENORMAL_GUARD : utils::DENORMAL_GUARD;
+
+			for (uint16_t group = 0; group < m_NumChannels; group += METER_GROUP)
+			{
+				const uint16_t num_lanes = std::min<uint16_t>(METER_GROUP, m_NumChannels - group);
+				const float *samples = a_Samples + group;
+#if defined(UAUDIO_METER_SSE)
+				const __m128 sb0 = _mm_set1_ps(m_Shelf[0]), sb1 = _mm_set1_ps(m_Shelf[1]), sb2 = _mm_set1_ps(m_Shelf[2]);
+				const __m128 sa1 = _mm_set1_ps(m_Shelf[3]), sa2 = _mm_set1_ps(m_Shelf[4]);
+				const __m128 ha1 = _mm_set1_ps(m_HighPass[3]), ha2 = _mm_set1_ps(m_HighPass[4]);
+				const __m128 minus_two = _mm_set1_ps(-2.0f);
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 sign = _mm_set1_ps(-0.0f);
+				__m128 guard = _mm_set1_ps(first_guard);
+
+				__m128 s1 = _mm_load_ps(m_ShelfState[0] + group), s2 = _mm_load_ps(m_ShelfState[1] + group);
+				__m128 h1 = _mm_load_ps(m_HighPassState[0] + group), h2 = _mm_load_ps(m_HighPassState[1] + group);
+				__m128 peak = _mm_load_ps(m_Peak + group);
+				__m128 square = _mm_load_ps(m_Square + group);
+				__m128 energy = _mm_load_ps(m_Energy + group);
+
+				for (uint32_t i = 0; i < a_NumFrames; i++, samples += m_NumChannels)
+				{
+					const __m128 x = LoadLanes(samples, num_lanes);
+					const __m128 input = _mm_add_ps(x, guard);
+					guard = _mm_xor_ps(guard, sign);
+
+					// Transposed direct form II, the high pass has 1, -2, 1 as numerator.
+					const __m128 y = _mm_add_ps(_mm_mul_ps(sb0, input), s1);
+					s1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(sb1, input), _mm_mul_ps(sa1, y)), s2);
+					s2 = _mm_sub_ps(_mm_mul_ps(sb2, input), _mm_mul_ps(sa2, y));
+
+					const __m128 z = _mm_add_ps(y, h1);
+					h1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(minus_two, y), _mm_mul_ps(ha1, z)), h2);
+					h2 = _mm_sub_ps(y, _mm_mul_ps(ha2, z));
+
+					peak = _mm_max_ps(peak, _mm_max_ps(x, _mm_sub_ps(zero, x)));
+					square = _mm_add_ps(square, _mm_mul_ps(x, x));
+					energy = _mm_add_ps(energy, _mm_mul_ps(z, z));
+				}
+
+				_mm_store_ps(m_ShelfState[0] + group, s1);
+				_mm_store_ps(m_ShelfState[1] + group, s2);
+				_mm_store_ps(m_HighPassState[0] + group, h1);
+				_mm_store_ps(m_HighPassState[1] + group, h2);
+				_mm_store_ps(m_Peak + group, peak);
+				_mm_store_ps(m_Square + group, square);
+				_mm_store_ps(m_Energy + group, energy);
+#else
+				for (uint16_t lane = 0; lane < num_lanes; lane++)
+				{
+					const uint16_t channel = group + lane;
+					float s1 = m_ShelfState[0][channel], s2 = m_ShelfState[1][channel];
+					float h1 = m_HighPassState[0][channel], h2 = m_HighPassState[1][channel];
+					float peak = m_Peak[channel], square = m_Square[channel], energy = m_Energy[channel];
+					float guard = first_guard;
+
+					const float *sample = samples + lane;
+					for (uint32_t i = 0; i < a_NumFrames; i++, sample += m_NumChannels)
+					{
+						const float x = *sample;
+						const float input = x + guard;
+						guard = -guard;
+
+						const float y = m_Shelf[0] * input + s1;
+						s1 = m_Shelf[1] * input - m_Shelf[3] * y + s2;
+						s2 = m_Shelf[2] * input - m_Shelf[4] * y;
+
+						const float z = y + h1;
+						h1 = -2.0f * y - m_HighPass[3] * z + h2;
+						h2 = y - m_HighPass[4] * z;
+
+						peak = std::max(peak, std::fabs(x));
+						square += x * x;
+						energy += z * z;
+					}
+
+					m_ShelfState[0][channel] = s1;
+					m_ShelfState[1][channel] = s2;
+					m_HighPassState[0][channel] = h1;
+					m_HighPassState[1][channel] = h2;
+					m_Peak[channel] = peak;
+					m_Square[channel] = square;
+					m_Energy[channel] = energy;
+				}
+#endif
+			}
+		}
+
+		/// <summary>
+		/// Turns the sums of a block into readings, publishes them and starts the next block.
+		/// </summary>
+		void Meter::EndBlock()
+		{
+			const float num_frames = static_cast<float>(m_BlockFrames);
+
+			float energy = 0.0f;
+			for (uint16_t i = 0; i < m_NumChannels; i++)
+				energy += m_Weights[i] * m_Energy[i];
+			m_Blocks[m_Block] = energy / num_frames;
+			m_Block = (m_Block + 1) % METER_SHORT_TERM_BLOCKS;
+
+			MeterReadings &readings = m_Readings.GetBack();
+			readings = MeterReadings();
+			readings.numChannels = m_NumChannels;
+			for (uint16_t i = 0; i < m_NumChannels; i++)
+			{
+				readings.peak[i] = m_Peak[i];
+				readings.rms[i] = std::sqrt(m_Square[i] / num_frames);
+			}
+
+			// The ring holds the last 30 blocks, the last 4 of them are the momentary loudness.
+			float momentary = 0.0f, short_term = 0.0f;
+			for (uint32_t i = 0; i < METER_SHORT_TERM_BLOCKS; i++)
+			{
+				const float block = m_Blocks[(m_Block + METER_SHORT_TERM_BLOCKS - 1 - i) % METER_SHORT_TERM_BLOCKS];
+				if (i < METER_MOMENTARY_BLOCKS)
+					momentary += block;
+				short_term += block;
+			}
+			readings.momentary = GetLoudness(momentary / static_cast<float>(METER_MOMENTARY_BLOCKS));
+			readings.shortTerm = GetLoudness(short_term / static_cast<float>(METER_SHORT_TERM_BLOCKS));
+			readings.energy = energy / num_frames;
+
+			m_Last = readings;
+			m_Readings.Publish();
+
+			std::fill(std::begin(m_Peak), std::end(m_Peak), 0.0f);
+			std::fill(std::begin(m_Square), std::end(m_Square), 0.0f);
+			std::fill(std::begin(m_Energy), std::end(m_Energy), 0.0f);
+			m_Frames = 0;
+		}
+	}
+}
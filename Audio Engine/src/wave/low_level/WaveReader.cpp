@@ -1,17 +1,52 @@
 #include <uaudio/wave/low_level/WaveReader.h>
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include <uaudio/utils/FileReader.h>
 #include <uaudio/utils/Logger.h>
+#include <uaudio/utils/MappedFile.h>
 #include <uaudio/utils/Utils.h>
 #include <uaudio/wave/low_level/WaveFormat.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
 
 namespace uaudio
 {
+	// The version of the bext chunk that has the loudness fields.
+	constexpr uint16_t BEXT_LOUDNESS_VERSION = 2;
+
+	// The amount of bytes that get copied at once when a streamed sound gets saved.
+	constexpr uint32_t STREAM_COPY_SIZE = 65536;
+
+	namespace
+	{
+		/// <summary>
+		/// Turns a loudness value into a field of the bext chunk (100 times the value, rounded, as a signed 16-bit integer).
+		/// </summary>
+		/// <param name="a_Value">The value (in LUFS, LU or dBTP).</param>
+		/// <returns>The field.</returns>
+		uint16_t GetLoudnessField(float a_Value)
+		{
+			const float value = utils::clamp(a_Value * 100.0f, static_cast<float>(INT16_MIN), static_cast<float>(INT16_MAX));
+			return static_cast<uint16_t>(static_cast<int16_t>(std::lround(value)));
+		}
+
+		// A part of a chunk that was not in the reads of the chunk headers, it gets read after all chunks were found.
+		struct ChunkRead
+		{
+			uint64_t offset = 0;
+			unsigned char *data = nullptr;
+			size_t size = 0;
+		};
+	}
+
 	/// <summary>
 	/// Loads the sound.
 	/// </summary>
 	/// <param name="a_FilePath">The path to the file.</param>
 	/// <param name="a_WaveFormat">The wave format.</param>
-	/// <param name="a_File">The pointer to the file.</param>
+	/// <param name="a_File">The pointer to the file (a file that is still open gets closed, the file gets read with a FileReader).</param>
 	/// <param name="a_WaveConfig">The config containing specific loading instructions.</param>
 	/// <returns>WAVE loading status.</returns>
 	WAVE_LOADING_STATUS WaveReader::LoadSound(const char *a_FilePath, WaveFormat &a_WaveFormat, FILE *&a_File, WaveConfig a_WaveConfig)
@@ -29,86 +64,248 @@ namespace uaudio
 			a_File = nullptr;
 		}
 
+		// A streamed sound does not need its data anywhere, so it does not get mapped either.
+		if (a_WaveConfig.memoryMap && !a_WaveConfig.stream)
+		{
+			const WAVE_LOADING_STATUS status = LoadMappedSound(a_FilePath, a_WaveFormat, a_WaveConfig);
+			if (status != WAVE_LOADING_STATUS::STATUS_FAILED_OPENING_FILE)
+				return status;
+
+			logger::log_warning("<WaveReader> Failed mapping file, reading it instead: (%s\"%s%s\").", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
+		}
+
 		// Open the file.
-		fopen_s(&a_File, a_FilePath, "rb");
-		if (a_File == nullptr)
+		utils::FileReader file_reader;
+		if (!file_reader.Open(a_FilePath))
 		{
 			logger::log_warning("<WaveReader> Failed opening file: (%s\"%s%s\").", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
 			return WAVE_LOADING_STATUS::STATUS_FAILED_OPENING_FILE;
 		}
 
-		fseek(a_File, 0, SEEK_END);
-		long total_size = ftell(a_File);
-		rewind(a_File);
+		const uint64_t total_size = file_reader.GetSize();
+		a_WaveFormat.m_FileSize = static_cast<uint32_t>(total_size);
 
 		logger::log_info("<WaveReader> Reading wave file: (%s\"%s\"%s).", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
 
-		char previous_chunk_id[4] = {};
+		std::vector<uint32_t, UAUDIO_DEFAULT_ALLOCATOR<uint32_t>> chunk_ids;
+		for (const auto &chunk_name : a_WaveConfig.chunksToLoad)
+			chunk_ids.push_back(utils::GetFourCC(chunk_name));
+		const uint32_t riff_id = utils::GetFourCC(RIFF_CHUNK_ID);
+		const uint32_t data_id = utils::GetFourCC(DATA_CHUNK_ID);
+
+		// The part of the file that the chunk headers get looked up in.
+		std::vector<unsigned char, UAUDIO_DEFAULT_ALLOCATOR<unsigned char>> window(static_cast<size_t>(std::min<uint64_t>(UAUDIO_DEFAULT_HEADER_READ_SIZE, total_size)));
+		uint64_t window_offset = 0;
+		size_t window_size = file_reader.Read(0, window.data(), window.size());
 
-		// Check if file has reached eof.
-		while (total_size != ftell(a_File))
+		std::vector<ChunkRead, UAUDIO_DEFAULT_ALLOCATOR<ChunkRead>> chunk_reads;
+		uint32_t previous_chunk_id = 0;
+		uint64_t offset = 0;
+		while (offset + sizeof(WaveChunkData) <= total_size)
 		{
-			char chunk_id[CHUNK_ID_SIZE] = {};
+			// The header comes after a chunk that went past the window, the next window starts at it.
+			if (offset + sizeof(WaveChunkData) > window_offset + window_size)
+			{
+				window_offset = offset;
+				window_size = file_reader.Read(offset, window.data(), window.size());
+				if (window_size < sizeof(WaveChunkData))
+					break;
+			}
 
-			// Read what chunk id the a_File has.
-			fread(&chunk_id, sizeof(chunk_id), 1, a_File);
+			WaveChunkData header;
+			UAUDIO_DEFAULT_MEMCPY(&header, window.data() + (offset - window_offset), sizeof(WaveChunkData));
+			const uint32_t chunk_id = utils::GetFourCC(header.chunk_id);
 
 			// Fail-safe for if the algorithm is stuck with a specific chunk. It gives up at second try.
-			if (strncmp(&chunk_id[0], &previous_chunk_id[0], CHUNK_ID_SIZE) == 0)
+			if (chunk_id == previous_chunk_id)
 			{
 				logger::log_warning("<WaveReader> Failed to load wave a_File (\"%s\").", a_FilePath);
 				return WAVE_LOADING_STATUS::STATUS_FAILED_LOADING_CHUNK;
 			}
+			previous_chunk_id = chunk_id;
 
-			UAUDIO_DEFAULT_MEMCPY(previous_chunk_id, chunk_id, sizeof(chunk_id));
-
-			uint32_t chunk_size = 0;
-
-			// Check chunk size (chunk size).
-			fread(&chunk_size, sizeof(chunk_size), 1, a_File);
-
-			if (strncmp(&chunk_id[0], "RIFF", CHUNK_ID_SIZE) == 0)
+			offset += sizeof(WaveChunkData);
+			if (chunk_id == riff_id)
 			{
 				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk.)", logger::COLOR_YELLOW, RIFF_CHUNK_ID, logger::COLOR_WHITE);
-
-				fseek(a_File, 4, SEEK_CUR);
+				offset += CHUNK_ID_SIZE;
 				continue;
 			}
 
-			bool get_chunk = false;
+			// A chunk that claims to be longer than the file ends with the file.
+			if (header.chunkSize > total_size - offset)
+				header.chunkSize = static_cast<uint32_t>(total_size - offset);
+
 			// Check if the chunk is in the config.
-			for (const auto &chunk_name : a_WaveConfig.chunksToLoad)
-				if (strncmp(&chunk_id[0], chunk_name, CHUNK_ID_SIZE) == 0)
-					get_chunk = true;
+			const bool get_chunk = std::find(chunk_ids.begin(), chunk_ids.end(), chunk_id) != chunk_ids.end();
 
-			if (get_chunk)
+			// A streamed sound only remembers where its data is.
+			if (get_chunk && a_WaveConfig.stream && chunk_id == data_id)
 			{
-				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk with size %s"%i"%s.)", logger::COLOR_YELLOW, chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, chunk_size, logger::COLOR_WHITE);
+				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk with size %s"%i"%s that gets streamed.)", logger::COLOR_YELLOW, header.chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, header.chunkSize, logger::COLOR_WHITE);
 
-				WaveChunkData *chunk_data = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(chunk_size + sizeof(WaveChunkData)));
+				a_WaveFormat.m_Streaming = true;
+				a_WaveFormat.m_StreamOffset = static_cast<uint32_t>(offset);
+				a_WaveFormat.m_StreamSize = header.chunkSize;
+			}
+			else if (get_chunk)
+			{
+				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk with size %s"%i"%s.)", logger::COLOR_YELLOW, header.chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, header.chunkSize, logger::COLOR_WHITE);
 
+				WaveChunkData *chunk_data = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(header.chunkSize + sizeof(WaveChunkData)));
 				if (chunk_data != nullptr)
 				{
-					UAUDIO_DEFAULT_MEMCPY(chunk_data->chunk_id, chunk_id, sizeof(chunk_id));
-					chunk_data->chunkSize = chunk_size;
-					fread(utils::add(chunk_data, sizeof(WaveChunkData)), 1, chunk_size, a_File);
-				}
-				else
-					fseek(a_File, static_cast<long>(chunk_size), SEEK_CUR);
+					UAUDIO_DEFAULT_MEMCPY(chunk_data, &header, sizeof(WaveChunkData));
 
-				a_WaveFormat.AddChunk(chunk_data);
+					// The part that is in the window gets copied, the rest gets read after the last chunk was found.
+					unsigned char *data = reinterpret_cast<unsigned char *>(utils::add(chunk_data, sizeof(WaveChunkData)));
+					const size_t in_window = static_cast<size_t>(std::min<uint64_t>(header.chunkSize, window_offset + window_size - offset));
+					UAUDIO_DEFAULT_MEMCPY(data, window.data() + (offset - window_offset), in_window);
+					if (in_window < header.chunkSize)
+					{
+						ChunkRead chunk_read;
+						chunk_read.offset = offset + in_window;
+						chunk_read.data = data + in_window;
+						chunk_read.size = header.chunkSize - in_window;
+						chunk_reads.push_back(chunk_read);
+					}
+					a_WaveFormat.AddChunk(chunk_data);
+				}
 			}
 			else
+				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk with size %s"%i"%s that is not in config.)", logger::COLOR_YELLOW, header.chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, header.chunkSize, logger::COLOR_WHITE);
+
+			offset += header.chunkSize;
+		}
+
+		// The window is not needed anymore, the bytes between chunks that get read at once go into it.
+		const size_t max_gap = std::min<size_t>(UAUDIO_DEFAULT_READ_GAP_SIZE, window.size());
+		size_t next_read = 0;
+		while (next_read < chunk_reads.size())
+		{
+			utils::FileBuffer buffers[utils::FILE_READER_MAX_BUFFERS];
+			uint32_t num_buffers = 0;
+			const uint64_t read_offset = chunk_reads[next_read].offset;
+			uint64_t read_end = read_offset;
+			while (next_read < chunk_reads.size() && num_buffers + 2 <= utils::FILE_READER_MAX_BUFFERS)
 			{
-				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk with size %s"%i"%s that is not in config.)", logger::COLOR_YELLOW, chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, chunk_size, logger::COLOR_WHITE);
-				fseek(a_File, static_cast<long>(chunk_size), SEEK_CUR);
+				const ChunkRead &chunk_read = chunk_reads[next_read];
+				const uint64_t gap = chunk_read.offset - read_end;
+				if (num_buffers > 0 && gap > max_gap)
+					break;
+
+				if (gap > 0)
+				{
+					buffers[num_buffers].data = window.data();
+					buffers[num_buffers].size = static_cast<size_t>(gap);
+					num_buffers++;
+				}
+				buffers[num_buffers].data = chunk_read.data;
+				buffers[num_buffers].size = chunk_read.size;
+				num_buffers++;
+				read_end = chunk_read.offset + chunk_read.size;
+				next_read++;
+			}
+			file_reader.ReadScattered(read_offset, buffers, num_buffers);
+		}
+
+		// The channels play a streamed sound the way it is in the file, so pcm that the engine does not play (32-bit integers, 64-bit floats) gets loaded and converted instead.
+		if (a_WaveFormat.m_Streaming && a_WaveFormat.HasChunk(FMT_CHUNK_ID))
+		{
+			const SAMPLE_FORMAT sample_format = conversion::GetSampleFormat(a_WaveFormat.GetAudioFormat(), a_WaveFormat.GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID).bitsPerSample);
+			if (sample_format != SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN && !conversion::IsPlayableSampleFormat(sample_format))
+			{
+				logger::log_info(R"(<WaveReader> Sample format of %s"%.4s"%s chunk can not be streamed, loading it instead.)", logger::COLOR_YELLOW, DATA_CHUNK_ID, logger::COLOR_WHITE);
+
+				WaveChunkData *chunk_data = reinterpret_cast<WaveChunkData *>(UAUDIO_DEFAULT_ALLOC(a_WaveFormat.m_StreamSize + sizeof(WaveChunkData)));
+				if (chunk_data != nullptr)
+				{
+					UAUDIO_DEFAULT_MEMCPY(chunk_data->chunk_id, DATA_CHUNK_ID, CHUNK_ID_SIZE);
+					chunk_data->chunkSize = a_WaveFormat.m_StreamSize;
+					file_reader.Read(a_WaveFormat.m_StreamOffset, utils::add(chunk_data, sizeof(WaveChunkData)), a_WaveFormat.m_StreamSize);
+					a_WaveFormat.AddChunk(chunk_data);
+
+					a_WaveFormat.m_Streaming = false;
+					a_WaveFormat.m_StreamOffset = 0;
+					a_WaveFormat.m_StreamSize = 0;
+				}
 			}
 		}
+		file_reader.Close();
+
+		logger::log_info("<WaveReader> Read wave file with %s%u%s system calls.", logger::COLOR_YELLOW, file_reader.GetNumCalls(), logger::COLOR_WHITE);
 
 		a_WaveFormat.ConfigConversion(a_WaveConfig);
 
-		fclose(a_File);
-		a_File = nullptr;
+		logger::log_success("<WaveReader> Opened file successfully: (%s\"%s\"%s).", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
+		return WAVE_LOADING_STATUS::STATUS_SUCCESSFUL;
+	}
+
+	/// <summary>
+	/// Loads the sound by mapping the file, the chunks point into the mapping instead of getting read (the pages get read when they are used).
+	/// </summary>
+	/// <param name="a_FilePath">The path to the file.</param>
+	/// <param name="a_WaveFormat">The wave format.</param>
+	/// <param name="a_WaveConfig">The config containing specific loading instructions.</param>
+	/// <returns>WAVE loading status.</returns>
+	WAVE_LOADING_STATUS WaveReader::LoadMappedSound(const char *a_FilePath, WaveFormat &a_WaveFormat, WaveConfig &a_WaveConfig)
+	{
+		std::shared_ptr<utils::MappedFile> mapped_file = std::make_shared<utils::MappedFile>();
+		if (!mapped_file->Open(a_FilePath))
+			return WAVE_LOADING_STATUS::STATUS_FAILED_OPENING_FILE;
+
+		// Before the chunks get added, so the format never frees them.
+		a_WaveFormat.m_MappedFile = mapped_file;
+
+		logger::log_info("<WaveReader> Mapping wave file: (%s\"%s\"%s).", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
+
+		unsigned char *data = mapped_file->GetData();
+		const size_t total_size = mapped_file->GetSize();
+		a_WaveFormat.m_FileSize = static_cast<uint32_t>(total_size);
+		size_t offset = 0;
+		char previous_chunk_id[CHUNK_ID_SIZE] = {};
+		while (offset + sizeof(WaveChunkData) <= total_size)
+		{
+			WaveChunkData *chunk_data = reinterpret_cast<WaveChunkData *>(data + offset);
+			const char *chunk_id = reinterpret_cast<const char *>(chunk_data->chunk_id);
+
+			// Fail-safe for if the algorithm is stuck with a specific chunk. It gives up at second try.
+			if (strncmp(chunk_id, &previous_chunk_id[0], CHUNK_ID_SIZE) == 0)
+			{
+				logger::log_warning("<WaveReader> Failed to load wave a_File (\"%s\").", a_FilePath);
+				return WAVE_LOADING_STATUS::STATUS_FAILED_LOADING_CHUNK;
+			}
+			UAUDIO_DEFAULT_MEMCPY(previous_chunk_id, chunk_id, CHUNK_ID_SIZE);
+
+			offset += sizeof(WaveChunkData);
+			if (strncmp(chunk_id, "RIFF", CHUNK_ID_SIZE) == 0)
+			{
+				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk.)", logger::COLOR_YELLOW, RIFF_CHUNK_ID, logger::COLOR_WHITE);
+				offset += CHUNK_ID_SIZE;
+				continue;
+			}
+
+			// A chunk that claims to be longer than the file ends with the file (the header is in the private mapping, so the file stays as it is).
+			if (chunk_data->chunkSize > total_size - offset)
+				chunk_data->chunkSize = static_cast<uint32_t>(total_size - offset);
+
+			bool get_chunk = false;
+			for (const auto &chunk_name : a_WaveConfig.chunksToLoad)
+				if (strncmp(chunk_id, chunk_name, CHUNK_ID_SIZE) == 0)
+					get_chunk = true;
+
+			if (get_chunk)
+			{
+				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk with size %s"%i"%s.)", logger::COLOR_YELLOW, chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, chunk_data->chunkSize, logger::COLOR_WHITE);
+				a_WaveFormat.AddChunk(chunk_data);
+			}
+			else
+				logger::log_info(R"(<WaveReader> Found %s"%.4s"%s chunk with size %s"%i"%s that is not in config.)", logger::COLOR_YELLOW, chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, chunk_data->chunkSize, logger::COLOR_WHITE);
+
+			offset += chunk_data->chunkSize;
+		}
+
+		a_WaveFormat.ConfigConversion(a_WaveConfig);
 
 		logger::log_success("<WaveReader> Opened file successfully: (%s\"%s\"%s).", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
 		return WAVE_LOADING_STATUS::STATUS_SUCCESSFUL;
@@ -119,9 +316,44 @@ namespace uaudio
 	/// </summary>
 	/// <param name="a_FilePath">The path to save to.</param>
 	/// <param name="a_WaveFormat">The format with all the chunks.</param>
+	/// <param name="a_Loudness">The loudness that gets written into the bext chunk (nullptr keeps the bext chunk as it is, a bext chunk gets added if there is none).</param>
 	/// <returns>WAVE saving status.</returns>
-	WAVE_SAVING_STATUS WaveReader::SaveSound(const char *a_FilePath, const WaveFormat &a_WaveFormat)
+	WAVE_SAVING_STATUS WaveReader::SaveSound(const char *a_FilePath, const WaveFormat &a_WaveFormat, const effects::LoudnessMeasurement *a_Loudness)
 	{
+		// The fields of the bext chunk that get written instead of the ones in the format (the rest of the chunk, like the coding history, stays).
+		BEXT_Chunk bext_chunk(nullptr);
+		const bool has_bext = a_WaveFormat.GetChunkSize(BEXT_CHUNK_ID) >= sizeof(BEXT_Chunk);
+		if (a_Loudness != nullptr)
+		{
+			if (has_bext)
+				bext_chunk = a_WaveFormat.GetChunkFromData<BEXT_Chunk>(BEXT_CHUNK_ID);
+			bext_chunk.version = std::max(bext_chunk.version, BEXT_LOUDNESS_VERSION);
+			bext_chunk.loudness_value = GetLoudnessField(a_Loudness->integrated);
+			bext_chunk.loudness_range = GetLoudnessField(a_Loudness->range);
+			bext_chunk.max_true_peak_level = GetLoudnessField(a_Loudness->truePeak);
+			bext_chunk.max_momentary_loudness = GetLoudnessField(a_Loudness->maxMomentary);
+			bext_chunk.max_short_term_loudness = GetLoudnessField(a_Loudness->maxShortTerm);
+		}
+		const bool add_bext = a_Loudness != nullptr && !has_bext;
+
+		// The data of a streamed sound gets copied from its own file, which cannot be the one that gets written.
+		FILE *stream_file = nullptr;
+		if (a_WaveFormat.IsStreaming())
+		{
+			if (a_WaveFormat.m_FilePath == nullptr || strcmp(a_WaveFormat.m_FilePath, a_FilePath) == 0)
+			{
+				logger::log_warning("<WaveReader> Failed saving streamed file over itself: (%s\"%s%s\").", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
+				return WAVE_SAVING_STATUS::STATUS_FAILED_OPENING_FILE;
+			}
+
+			fopen_s(&stream_file, a_WaveFormat.m_FilePath, "rb");
+			if (stream_file == nullptr)
+			{
+				logger::log_warning("<WaveReader> Failed opening file: (%s\"%s%s\").", logger::COLOR_YELLOW, a_WaveFormat.m_FilePath, logger::COLOR_WHITE);
+				return WAVE_SAVING_STATUS::STATUS_FAILED_OPENING_FILE;
+			}
+		}
+
 		FILE *file;
 
 		// Open the file.
@@ -129,6 +361,8 @@ namespace uaudio
 		if (file == nullptr)
 		{
 			logger::log_warning("<WaveReader> Failed saving file: (%s\"%s%s\").", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
+			if (stream_file != nullptr)
+				fclose(stream_file);
 			return WAVE_SAVING_STATUS::STATUS_FAILED_OPENING_FILE;
 		}
 
@@ -136,6 +370,10 @@ namespace uaudio
 		uint32_t chunk_size = CHUNK_ID_SIZE;
 		for (auto &m_Chunk : a_WaveFormat.m_Chunks)
 			chunk_size += m_Chunk->chunkSize + sizeof(WaveChunkData);
+		if (add_bext)
+			chunk_size += sizeof(BEXT_Chunk) + sizeof(WaveChunkData);
+		if (stream_file != nullptr)
+			chunk_size += a_WaveFormat.m_StreamSize + sizeof(WaveChunkData);
 		fwrite(reinterpret_cast<char *>(&chunk_size), sizeof(chunk_size), 1, file);
 		fwrite(FMT_CHUNK_FORMAT, CHUNK_ID_SIZE, 1, file);
 
@@ -143,10 +381,62 @@ namespace uaudio
 		{
 			fwrite(reinterpret_cast<char *>(&m_Chunk->chunk_id), CHUNK_ID_SIZE, 1, file);
 			fwrite(reinterpret_cast<char *>(&m_Chunk->chunkSize), sizeof(m_Chunk->chunkSize), 1, file);
-			fwrite(reinterpret_cast<char *>(utils::add(m_Chunk, sizeof(WaveChunkData))), m_Chunk->chunkSize, 1, file);
+			if (a_Loudness != nullptr && has_bext && strncmp(reinterpret_cast<char *>(m_Chunk->chunk_id), BEXT_CHUNK_ID, CHUNK_ID_SIZE) == 0)
+			{
+				fwrite(reinterpret_cast<char *>(&bext_chunk), sizeof(BEXT_Chunk), 1, file);
+				fwrite(reinterpret_cast<char *>(utils::add(m_Chunk, sizeof(WaveChunkData) + sizeof(BEXT_Chunk))), m_Chunk->chunkSize - sizeof(BEXT_Chunk), 1, file);
+			}
+			else
+				fwrite(reinterpret_cast<char *>(utils::add(m_Chunk, sizeof(WaveChunkData))), m_Chunk->chunkSize, 1, file);
 			logger::log_info(R"(<WaveReader> Saved chunk %s"%.4s"%s with size %s"%i"%s to file: (%s"%s%s").)", logger::COLOR_YELLOW, m_Chunk->chunk_id, logger::COLOR_WHITE, logger::COLOR_YELLOW, m_Chunk->chunkSize, logger::COLOR_WHITE, logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
 		}
 
+		if (add_bext)
+		{
+			const uint32_t bext_size = sizeof(BEXT_Chunk);
+			fwrite(BEXT_CHUNK_ID, CHUNK_ID_SIZE, 1, file);
+			fwrite(reinterpret_cast<const char *>(&bext_size), sizeof(bext_size), 1, file);
+			fwrite(reinterpret_cast<char *>(&bext_chunk), sizeof(BEXT_Chunk), 1, file);
+			logger::log_info(R"(<WaveReader> Saved chunk %s"%.4s"%s with size %s"%i"%s to file: (%s"%s%s").)", logger::COLOR_YELLOW, BEXT_CHUNK_ID, logger::COLOR_WHITE, logger::COLOR_YELLOW, bext_size, logger::COLOR_WHITE, logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
+		}
+
+		if (stream_file != nullptr)
+		{
+			const uint32_t data_size = a_WaveFormat.m_StreamSize;
+			fwrite(DATA_CHUNK_ID, CHUNK_ID_SIZE, 1, file);
+			fwrite(reinterpret_cast<const char *>(&data_size), sizeof(data_size), 1, file);
+
+			// In pieces, so the data never has to be in memory at once.
+			unsigned char buffer[STREAM_COPY_SIZE];
+			fseek(stream_file, static_cast<long>(a_WaveFormat.m_StreamOffset), SEEK_SET);
+			uint32_t remaining = data_size;
+			while (remaining > 0)
+			{
+				const size_t size = fread(buffer, 1, std::min<uint32_t>(remaining, sizeof(buffer)), stream_file);
+				if (size == 0)
+					break;
+				fwrite(buffer, 1, size, file);
+				remaining -= static_cast<uint32_t>(size);
+			}
+
+			// A file that changed since it was loaded still gives a data chunk of the size that was written in front of it (filled with silence, which is 128 for 8-bit samples).
+			if (remaining > 0)
+			{
+				const bool is_8_bit = a_WaveFormat.HasChunk(FMT_CHUNK_ID) && a_WaveFormat.GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID).bitsPerSample == WAVE_BITS_PER_SAMPLE_8;
+				std::fill(buffer, buffer + sizeof(buffer), static_cast<unsigned char>(is_8_bit ? 128 : 0));
+				while (remaining > 0)
+				{
+					const uint32_t size = std::min<uint32_t>(remaining, sizeof(buffer));
+					fwrite(buffer, 1, size, file);
+					remaining -= size;
+				}
+			}
+
+			fclose(stream_file);
+			stream_file = nullptr;
+			logger::log_info(R"(<WaveReader> Saved chunk %s"%.4s"%s with size %s"%i"%s to file: (%s"%s%s").)", logger::COLOR_YELLOW, DATA_CHUNK_ID, logger::COLOR_WHITE, logger::COLOR_YELLOW, data_size, logger::COLOR_WHITE, logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
+		}
+
 		fclose(file);
 		file = nullptr;
 		logger::log_success(R"(<WaveReader> Saved file: (%s"%s%s").)", logger::COLOR_YELLOW, a_FilePath, logger::COLOR_WHITE);
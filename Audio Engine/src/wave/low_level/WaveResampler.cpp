@@ -0,0 +1,548 @@
+#include <uaudio/wave/low_level/WaveResampler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+#include <uaudio/Defines.h>
+#include <uaudio/utils/Denormals.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		// Rolloff of the lowpass filter relative to the lowest nyquist frequency.
+		constexpr double RESAMPLER_ROLLOFF = 0.945;
+
+		// Kaiser window beta (about 85 dB of stopband attenuation).
+		constexpr double RESAMPLER_KAISER_BETA = 8.6;
+
+		// The amount of output frames that get processed per block (keeps the float scratch buffer in cache).
+		constexpr uint64_t RESAMPLER_BLOCK_FRAMES = 4096;
+
+		constexpr double PI = 3.14159265358979323846;
+
+		namespace
+		{
+			/// <summary>
+			/// Zeroth order modified bessel function of the first kind (used by the kaiser window).
+			/// </summary>
+			/// <param name="a_Value">The input value.</param>
+			/// <returns></returns>
+			double BesselI0(double a_Value)
+			{
+				double sum = 1.0, term = 1.0;
+				const double half = a_Value / 2.0;
+				for (int k = 1; k < 64; k++)
+				{
+					term *= (half / k) * (half / k);
+					sum += term;
+					if (term < sum * 1e-12)
+						break;
+				}
+				return sum;
+			}
+
+			/// <summary>
+			/// Creates the polyphase filter table for a specific ratio.
+			/// </summary>
+			/// <param name="a_SourceRate">The sample rate of the original data.</param>
+			/// <param name="a_TargetRate">The sample rate of the new data.</param>
+			/// <returns>The filter table.</returns>
+			PolyphaseFilter CreatePolyphaseFilter(uint32_t a_SourceRate, uint32_t a_TargetRate)
+			{
+				PolyphaseFilter filter;
+				filter.sourceRate = a_SourceRate;
+				filter.targetRate = a_TargetRate;
+
+				const uint32_t divisor = std::gcd(a_SourceRate, a_TargetRate);
+				filter.interpolation = a_TargetRate / divisor;
+				filter.decimation = a_SourceRate / divisor;
+				filter.exact = filter.interpolation <= UAUDIO_RESAMPLER_MAX_PHASES;
+				filter.numPhases = filter.exact ? filter.interpolation : UAUDIO_RESAMPLER_MAX_PHASES;
+
+				// When downsampling, the cutoff moves down and the filter gets wider.
+				const double ratio = std::min(1.0, static_cast<double>(a_TargetRate) / static_cast<double>(a_SourceRate));
+				const double cutoff = ratio * RESAMPLER_ROLLOFF;
+				filter.halfTaps = static_cast<uint32_t>(std::ceil(UAUDIO_RESAMPLER_ZERO_CROSSINGS / ratio));
+				filter.numTaps = filter.halfTaps * 2;
+
+				const double i0_beta = BesselI0(RESAMPLER_KAISER_BETA);
+				filter.coefficients.resize(static_cast<size_t>(filter.numPhases + 1) * filter.numTaps);
+				for (uint32_t phase = 0; phase <= filter.numPhases; phase++)
+				{
+					float *row = filter.coefficients.data() + static_cast<size_t>(phase) * filter.numTaps;
+					const double fraction = static_cast<double>(phase) / static_cast<double>(filter.numPhases);
+
+					double sum = 0.0;
+					for (uint32_t tap = 0; tap < filter.numTaps; tap++)
+					{
+						// Distance (in source samples) between the tap and the output position.
+						const double t = static_cast<double>(tap) - static_cast<double>(filter.halfTaps) + 1.0 - fraction;
+						const double x = cutoff * t;
+						const double sinc = x == 0.0 ? 1.0 : std::sin(PI * x) / (PI * x);
+
+						const double window_pos = t / static_cast<double>(filter.halfTaps);
+						const double window = window_pos * window_pos >= 1.0 ? 0.0 : BesselI0(RESAMPLER_KAISER_BETA * std::sqrt(1.0 - window_pos * window_pos)) / i0_beta;
+
+						const double value = cutoff * sinc * window;
+						row[tap] = static_cast<float>(value);
+						sum += value;
+					}
+
+					// Normalize every phase to unity gain so that there is no ripple on DC.
+					if (sum != 0.0)
+						for (uint32_t tap = 0; tap < filter.numTaps; tap++)
+							row[tap] = static_cast<float>(row[tap] / sum);
+				}
+
+				return filter;
+			}
+
+			struct ResampleJob
+			{
+				const PolyphaseFilter *filter = nullptr;
+				const unsigned char *input = nullptr;
+				unsigned char *output = nullptr;
+				uint64_t inFrames = 0;
+				uint16_t numChannels = 0;
+				uint16_t bytesPerSample = 0;
+			};
+
+			/// <summary>
+			/// Returns the source frame and the phase that belong to an output frame.
+			/// </summary>
+			/// <param name="a_Filter">The filter table.</param>
+			/// <param name="a_OutFrame">The output frame.</param>
+			/// <param name="a_Phase">The phase (will get changed).</param>
+			/// <param name="a_PhaseFraction">The fraction between this phase and the next one (will get changed, always 0 for exact ratios).</param>
+			/// <returns>The source frame.</returns>
+			int64_t GetSourceFrame(const PolyphaseFilter &a_Filter, uint64_t a_OutFrame, uint32_t &a_Phase, float &a_PhaseFraction)
+			{
+				if (a_Filter.exact)
+				{
+					const uint64_t position = a_OutFrame * a_Filter.decimation;
+					a_Phase = static_cast<uint32_t>(position % a_Filter.interpolation);
+					a_PhaseFraction = 0.0f;
+					return static_cast<int64_t>(position / a_Filter.interpolation);
+				}
+
+				const double position = static_cast<double>(a_OutFrame) * static_cast<double>(a_Filter.sourceRate) / static_cast<double>(a_Filter.targetRate);
+				const double source_frame = std::floor(position);
+				const double phase = (position - source_frame) * a_Filter.numPhases;
+				a_Phase = std::min(static_cast<uint32_t>(phase), a_Filter.numPhases - 1);
+				a_PhaseFraction = static_cast<float>(phase - a_Phase);
+				return static_cast<int64_t>(source_frame);
+			}
+
+			/// <summary>
+			/// Resamples a range of output frames.
+			/// </summary>
+			/// <param name="a_Job">The resample job.</param>
+			/// <param name="a_Begin">The first output frame.</param>
+			/// <param name="a_End">The output frame after the last output frame.</param>
+			template <uint16_t BitsPerSample>
+			void ResampleRange(const ResampleJob &a_Job, uint64_t a_Begin, uint64_t a_End)
+			{
+				// The filter tails of quiet parts produce denormals (the guard sets the mode of the thread back afterwards).
+				utils::DenormalGuard denormal_guard;
+
+				const PolyphaseFilter &filter = *a_Job.filter;
+				const uint16_t num_channels = a_Job.numChannels;
+
+				std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> scratch;
+				std::vector<float, UAUDIO_DEFAULT_ALLOCATOR<float>> interpolated_row(filter.numTaps);
+
+				for (uint64_t block = a_Begin; block < a_End; block += RESAMPLER_BLOCK_FRAMES)
+				{
+					const uint64_t block_end = std::min(block + RESAMPLER_BLOCK_FRAMES, a_End);
+
+					uint32_t phase = 0;
+					float phase_fraction = 0.0f;
+					const int64_t first_frame = GetSourceFrame(filter, block, phase, phase_fraction) - filter.halfTaps + 1;
+					const int64_t last_frame = GetSourceFrame(filter, block_end - 1, phase, phase_fraction) + filter.halfTaps;
+					const size_t frame_count = static_cast<size_t>(last_frame - first_frame + 1);
+
+					// Convert the source frames this block needs to planar floats (silence outside of the data).
+					scratch.resize(frame_count * num_channels);
+					for (size_t frame = 0; frame < frame_count; frame++)
+					{
+						const int64_t source_frame = first_frame + static_cast<int64_t>(frame);
+						const bool inside = source_frame >= 0 && static_cast<uint64_t>(source_frame) < a_Job.inFrames;
+						for (uint16_t channel = 0; channel < num_channels; channel++)
+							scratch[channel * frame_count + frame] = inside ? ReadSample<BitsPerSample>(a_Job.input + (static_cast<uint64_t>(source_frame) * num_channels + channel) * a_Job.bytesPerSample) : 0.0f;
+					}
+
+					for (uint64_t out_frame = block; out_frame < block_end; out_frame++)
+					{
+						const int64_t source_frame = GetSourceFrame(filter, out_frame, phase, phase_fraction);
+						const float *row = filter.GetPhase(phase);
+						if (!filter.exact)
+						{
+							const float *next_row = filter.GetPhase(phase + 1);
+							for (uint32_t tap = 0; tap < filter.numTaps; tap++)
+								interpolated_row[tap] = row[tap] + (next_row[tap] - row[tap]) * phase_fraction;
+							row = interpolated_row.data();
+						}
+
+						const size_t offset = static_cast<size_t>(source_frame - filter.halfTaps + 1 - first_frame);
+						for (uint16_t channel = 0; channel < num_channels; channel++)
+						{
+							const float *samples = scratch.data() + channel * frame_count + offset;
+							float sum = 0.0f;
+							for (uint32_t tap = 0; tap < filter.numTaps; tap++)
+								sum += samples[tap] * row[tap];
+							WriteSample<BitsPerSample>(a_Job.output + (out_frame * num_channels + channel) * a_Job.bytesPerSample, sum);
+						}
+					}
+				}
+			}
+
+			/// <summary>
+			/// Resamples all output frames, spread over multiple threads for long files.
+			/// </summary>
+			/// <param name="a_Job">The resample job.</param>
+			/// <param name="a_OutFrames">The amount of output frames.</param>
+			template <uint16_t BitsPerSample>
+			void ResampleAll(const ResampleJob &a_Job, uint64_t a_OutFrames)
+			{
+				const uint32_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+				if (a_OutFrames < UAUDIO_RESAMPLER_THREAD_THRESHOLD || num_threads == 1)
+				{
+					ResampleRange<BitsPerSample>(a_Job, 0, a_OutFrames);
+					return;
+				}
+
+				std::vector<std::thread, UAUDIO_DEFAULT_ALLOCATOR<std::thread>> threads;
+				const uint64_t frames_per_thread = (a_OutFrames + num_threads - 1) / num_threads;
+				for (uint64_t begin = 0; begin < a_OutFrames; begin += frames_per_thread)
+					threads.emplace_back(&ResampleRange<BitsPerSample>, std::cref(a_Job), begin, std::min(begin + frames_per_thread, a_OutFrames));
+
+				for (auto &thread : threads)
+					thread.join();
+			}
+		}
+
+		/// <summary>
+		/// Returns the (cached) polyphase filter for a ratio. The common ratios get created together on first use.
+		/// </summary>
+		/// <param name="a_SourceRate">The sample rate of the original data.</param>
+		/// <param name="a_TargetRate">The sample rate of the new data.</param>
+		/// <returns>The filter table.</returns>
+		const PolyphaseFilter &GetPolyphaseFilter(uint32_t a_SourceRate, uint32_t a_TargetRate)
+		{
+			static std::mutex filter_mutex;
+			static std::map<std::pair<uint32_t, uint32_t>, PolyphaseFilter> filters;
+
+			std::lock_guard<std::mutex> lock(filter_mutex);
+			if (filters.empty())
+			{
+				constexpr uint32_t common_rates[] = {
+					WAVE_SAMPLE_RATE_44100,
+					WAVE_SAMPLE_RATE_48000,
+					WAVE_SAMPLE_RATE_96000,
+				};
+				for (const uint32_t source_rate : common_rates)
+					for (const uint32_t target_rate : common_rates)
+						if (source_rate != target_rate)
+							filters.emplace(std::make_pair(source_rate, target_rate), CreatePolyphaseFilter(source_rate, target_rate));
+			}
+
+			const auto key = std::make_pair(a_SourceRate, a_TargetRate);
+			auto it = filters.find(key);
+			if (it == filters.end())
+				it = filters.emplace(key, CreatePolyphaseFilter(a_SourceRate, a_TargetRate)).first;
+			return it->second;
+		}
+
+		/// <summary>
+		/// Recalculates the buffer size from one sample rate to another.
+		/// </summary>
+		/// <param name="a_Size">The buffer size.</param>
+		/// <param name="a_BlockAlign">The alignment of 1 frame.</param>
+		/// <param name="a_SourceRate">The sample rate of the original data.</param>
+		/// <param name="a_TargetRate">The sample rate of the new data.</param>
+		/// <returns></returns>
+		uint32_t CalculateResampleSize(uint32_t a_Size, uint16_t a_BlockAlign, uint32_t a_SourceRate, uint32_t a_TargetRate)
+		{
+			if (a_BlockAlign == 0 || a_SourceRate == 0)
+				return 0;
+
+			const uint64_t in_frames = a_Size / a_BlockAlign;
+			const uint64_t out_frames = (in_frames * a_TargetRate + a_SourceRate - 1) / a_SourceRate;
+			return static_cast<uint32_t>(out_frames * a_BlockAlign);
+		}
+
+		/// <summary>
+		/// Recalculates a frame position (loop points, cue points) from one sample rate to another.
+		/// </summary>
+		/// <param name="a_Position">The position in frames.</param>
+		/// <param name="a_SourceRate">The sample rate of the original data.</param>
+		/// <param name="a_TargetRate">The sample rate of the new data.</param>
+		/// <returns></returns>
+		uint32_t ResamplePosition(uint32_t a_Position, uint32_t a_SourceRate, uint32_t a_TargetRate)
+		{
+			if (a_SourceRate == 0)
+				return a_Position;
+
+			return static_cast<uint32_t>((static_cast<uint64_t>(a_Position) * a_TargetRate + a_SourceRate / 2) / a_SourceRate);
+		}
+
+		/// <summary>
+		/// Converts pcm data from one sample rate to another.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer.</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed)</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <param name="a_SourceRate">The sample rate of the original data.</param>
+		/// <param name="a_TargetRate">The sample rate of the new data.</param>
+		void Resample(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, uint32_t a_SourceRate, uint32_t a_TargetRate)
+		{
+			const uint16_t block_align = a_NumChannels * a_BitsPerSample / 8;
+			if (block_align == 0 || a_SourceRate == 0 || a_TargetRate == 0 || a_Size % block_align != 0)
+				return;
+
+			ResampleJob job;
+			job.filter = &GetPolyphaseFilter(a_SourceRate, a_TargetRate);
+			job.input = a_OriginalDataBuffer;
+			job.output = a_DataBuffer;
+			job.inFrames = a_Size / block_align;
+			job.numChannels = a_NumChannels;
+			job.bytesPerSample = a_BitsPerSample / 8;
+
+			const uint32_t new_size = CalculateResampleSize(a_Size, block_align, a_SourceRate, a_TargetRate);
+			const uint64_t out_frames = new_size / block_align;
+
+			switch (a_BitsPerSample)
+			{
+				case WAVE_BITS_PER_SAMPLE_8:
+				{
+					ResampleAll<WAVE_BITS_PER_SAMPLE_8>(job, out_frames);
+					break;
+				}
+				case WAVE_BITS_PER_SAMPLE_16:
+				{
+					ResampleAll<WAVE_BITS_PER_SAMPLE_16>(job, out_frames);
+					break;
+				}
+				case WAVE_BITS_PER_SAMPLE_24:
+				{
+					ResampleAll<WAVE_BITS_PER_SAMPLE_24>(job, out_frames);
+					break;
+				}
+				case WAVE_BITS_PER_SAMPLE_32:
+				{
+					ResampleAll<WAVE_BITS_PER_SAMPLE_32>(job, out_frames);
+					break;
+				}
+				default:
+					return;
+			}
+			a_Size = new_size;
+		}
+
+		/// <summary>
+		/// Sets up the resampler for a sound. This is the only place where memory gets allocated.
+		/// </summary>
+		/// <param name="a_SourceRate">The sample rate of the sound.</param>
+		/// <param name="a_TargetRate">The sample rate of the output.</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_MaxInputFrames">The maximum amount of frames that get converted per step.</param>
+		void StreamResampler::Init(uint32_t a_SourceRate, uint32_t a_TargetRate, uint16_t a_NumChannels, uint16_t a_BitsPerSample, uint32_t a_MaxInputFrames)
+		{
+			m_NumChannels = a_NumChannels;
+			m_BitsPerSample = a_BitsPerSample;
+			m_MaxInputFrames = std::max(1u, a_MaxInputFrames);
+
+			const bool supported = a_BitsPerSample == WAVE_BITS_PER_SAMPLE_8 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_16 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_24 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_32;
+			if (!supported || a_NumChannels == 0 || a_SourceRate == 0 || a_TargetRate == 0 || a_SourceRate == a_TargetRate)
+			{
+				m_Filter = nullptr;
+				m_History.clear();
+				return;
+			}
+
+			m_Filter = &GetPolyphaseFilter(a_SourceRate, a_TargetRate);
+			m_History.assign(static_cast<size_t>(m_Filter->numTaps + m_MaxInputFrames) * m_NumChannels, 0.0f);
+			m_InterpolatedRow.assign(m_Filter->numTaps, 0.0f);
+			Reset();
+		}
+
+		/// <summary>
+		/// Clears the filter history (after seeking for example).
+		/// </summary>
+		void StreamResampler::Reset()
+		{
+			if (m_Filter == nullptr)
+				return;
+
+			// Prime the history with silence so that the first output frame lands on the first input frame.
+			m_HistoryFrames = m_Filter->halfTaps - 1;
+			std::fill(m_History.begin(), m_History.begin() + static_cast<size_t>(m_HistoryFrames) * m_NumChannels, 0.0f);
+			m_Frame = m_Filter->halfTaps - 1;
+			m_Phase = 0;
+			m_Fraction = 0.0;
+		}
+
+		/// <summary>
+		/// Returns whether the resampler needs to be used (the sample rates differ).
+		/// </summary>
+		/// <returns></returns>
+		bool StreamResampler::IsActive() const
+		{
+			return m_Filter != nullptr;
+		}
+
+		/// <summary>
+		/// Returns the maximum size of the output for an input size.
+		/// </summary>
+		/// <param name="a_Size">The input size.</param>
+		/// <returns></returns>
+		uint32_t StreamResampler::GetMaxOutputSize(uint32_t a_Size) const
+		{
+			const uint32_t block_align = m_NumChannels * m_BitsPerSample / 8;
+			if (m_Filter == nullptr || block_align == 0)
+				return a_Size;
+
+			const uint64_t frames = a_Size / block_align;
+			return static_cast<uint32_t>(((frames + 1) * m_Filter->targetRate / m_Filter->sourceRate + 1) * block_align);
+		}
+
+		/// <summary>
+		/// Converts a buffer of pcm data. The output buffer needs to be at least GetMaxOutputSize(a_Size) bytes.
+		/// </summary>
+		/// <param name="a_DataBuffer">The input data.</param>
+		/// <param name="a_Size">The input size.</param>
+		/// <param name="a_OutDataBuffer">The output data.</param>
+		/// <returns>The output size.</returns>
+		uint32_t StreamResampler::Process(const unsigned char *a_DataBuffer, uint32_t a_Size, unsigned char *a_OutDataBuffer)
+		{
+			const uint32_t block_align = m_NumChannels * m_BitsPerSample / 8;
+			if (m_Filter == nullptr || block_align == 0)
+				return 0;
+
+			uint32_t frames = a_Size / block_align;
+			uint32_t out_size = 0;
+			while (frames > 0)
+			{
+				const uint32_t step = std::min(frames, m_MaxInputFrames);
+				uint32_t out_frames = 0;
+				switch (m_BitsPerSample)
+				{
+					case WAVE_BITS_PER_SAMPLE_8:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_8>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					case WAVE_BITS_PER_SAMPLE_16:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_16>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					case WAVE_BITS_PER_SAMPLE_24:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_24>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					case WAVE_BITS_PER_SAMPLE_32:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_32>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					default:
+						return out_size;
+				}
+				out_size += out_frames * block_align;
+				a_DataBuffer += step * block_align;
+				frames -= step;
+			}
+			return out_size;
+		}
+
+		/// <summary>
+		/// Moves the position to the next output frame.
+		/// </summary>
+		void StreamResampler::Advance()
+		{
+			if (m_Filter->exact)
+			{
+				m_Phase += m_Filter->decimation;
+				m_Frame += m_Phase / m_Filter->interpolation;
+				m_Phase %= m_Filter->interpolation;
+				return;
+			}
+
+			m_Fraction += static_cast<double>(m_Filter->sourceRate) / static_cast<double>(m_Filter->targetRate);
+			const double whole = std::floor(m_Fraction);
+			m_Frame += static_cast<uint32_t>(whole);
+			m_Fraction -= whole;
+		}
+
+		/// <summary>
+		/// Appends frames to the history and produces every output frame that the history allows.
+		/// </summary>
+		/// <param name="a_DataBuffer">The input data.</param>
+		/// <param name="a_Frames">The amount of input frames (at most the max input frames).</param>
+		/// <param name="a_OutDataBuffer">The output data.</param>
+		/// <returns>The amount of output frames.</returns>
+		template <uint16_t BitsPerSample>
+		uint32_t StreamResampler::ProcessFrames(const unsigned char *a_DataBuffer, uint32_t a_Frames, unsigned char *a_OutDataBuffer)
+		{
+			const PolyphaseFilter &filter = *m_Filter;
+			const uint32_t bytes_per_sample = BitsPerSample / 8;
+			float *history = m_History.data();
+
+			float *write = history + static_cast<size_t>(m_HistoryFrames) * m_NumChannels;
+			for (uint32_t i = 0; i < a_Frames * m_NumChannels; i++)
+				write[i] = ReadSample<BitsPerSample>(a_DataBuffer + i * bytes_per_sample);
+			m_HistoryFrames += a_Frames;
+
+			uint32_t out_frames = 0;
+			while (m_Frame + filter.halfTaps < m_HistoryFrames)
+			{
+				const float *row = nullptr;
+				if (filter.exact)
+					row = filter.GetPhase(m_Phase);
+				else
+				{
+					const double phase = m_Fraction * filter.numPhases;
+					const uint32_t phase_index = std::min(static_cast<uint32_t>(phase), filter.numPhases - 1);
+					const float phase_fraction = static_cast<float>(phase - phase_index);
+					const float *current_row = filter.GetPhase(phase_index);
+					const float *next_row = filter.GetPhase(phase_index + 1);
+					for (uint32_t tap = 0; tap < filter.numTaps; tap++)
+						m_InterpolatedRow[tap] = current_row[tap] + (next_row[tap] - current_row[tap]) * phase_fraction;
+					row = m_InterpolatedRow.data();
+				}
+
+				const float *frames = history + static_cast<size_t>(m_Frame - filter.halfTaps + 1) * m_NumChannels;
+				for (uint16_t channel = 0; channel < m_NumChannels; channel++)
+				{
+					float sum = 0.0f;
+					for (uint32_t tap = 0; tap < filter.numTaps; tap++)
+						sum += frames[tap * m_NumChannels + channel] * row[tap];
+					WriteSample<BitsPerSample>(a_OutDataBuffer + (static_cast<size_t>(out_frames) * m_NumChannels + channel) * bytes_per_sample, sum);
+				}
+				out_frames++;
+				Advance();
+			}
+
+			// Drop the frames the filter does not need anymore.
+			const uint32_t shift = std::min(m_Frame - filter.halfTaps + 1, m_HistoryFrames);
+			std::memmove(history, history + static_cast<size_t>(shift) * m_NumChannels, static_cast<size_t>(m_HistoryFrames - shift) * m_NumChannels * sizeof(float));
+			m_HistoryFrames -= shift;
+			m_Frame -= shift;
+
+			return out_frames;
+		}
+	}
+}
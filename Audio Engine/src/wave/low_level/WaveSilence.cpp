@@ -0,0 +1,239 @@
+#include <uaudio/wave/low_level/WaveSilence.h>
+
+#include <cmath>
+
+#include <uaudio/utils/Utils.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UAUDIO_SILENCE_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		// The amount of samples that get checked at once.
+		constexpr uint32_t SILENCE_BLOCK = 8;
+
+		namespace
+		{
+			// The threshold in the sample format (samples at or above it are loud).
+			struct SilenceLevels
+			{
+				int32_t integer = 1;
+				float volume = 0.0f;
+			};
+
+			/// <summary>
+			/// Checks whether a single sample is loud.
+			/// </summary>
+			/// <param name="a_Data">The pcm data.</param>
+			/// <param name="a_Index">The index of the sample.</param>
+			/// <param name="a_Levels">The threshold.</param>
+			/// <returns>Whether the sample is at or above the threshold.</returns>
+			template <uint16_t BitsPerSample>
+			bool IsAudible(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels);
+
+			template <>
+			bool IsAudible<WAVE_BITS_PER_SAMPLE_8>(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				const int32_t value = a_Data[a_Index] - 128;
+				return value >= a_Levels.integer || value <= -a_Levels.integer;
+			}
+
+			template <>
+			bool IsAudible<WAVE_BITS_PER_SAMPLE_16>(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				int16_t value = 0;
+				UAUDIO_DEFAULT_MEMCPY(&value, a_Data + a_Index * sizeof(int16_t), sizeof(value));
+				return value >= a_Levels.integer || value <= -a_Levels.integer;
+			}
+
+			template <>
+			bool IsAudible<WAVE_BITS_PER_SAMPLE_24>(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				const unsigned char *sample = a_Data + a_Index * 3;
+				int32_t value = sample[0] | (sample[1] << 8) | (sample[2] << 16);
+
+				// Sign extend the 24th bit.
+				if (value & 0x800000)
+					value |= ~0xFFFFFF;
+				return value >= a_Levels.integer || value <= -a_Levels.integer;
+			}
+
+			template <>
+			bool IsAudible<WAVE_BITS_PER_SAMPLE_32>(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				return std::fabs(ReadSample<WAVE_BITS_PER_SAMPLE_32>(a_Data + a_Index * sizeof(float))) >= a_Levels.volume;
+			}
+
+			/// <summary>
+			/// Checks whether any sample in a block is loud.
+			/// </summary>
+			/// <param name="a_Data">The pcm data.</param>
+			/// <param name="a_Index">The index of the first sample in the block.</param>
+			/// <param name="a_Levels">The threshold.</param>
+			/// <returns>Whether a sample in the block is at or above the threshold.</returns>
+			template <uint16_t BitsPerSample>
+			bool IsBlockAudible(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				bool audible = false;
+				for (uint32_t i = 0; i < SILENCE_BLOCK; i++)
+					audible |= IsAudible<BitsPerSample>(a_Data, a_Index + i, a_Levels);
+				return audible;
+			}
+
+#if defined(UAUDIO_SILENCE_SSE2)
+			template <>
+			bool IsBlockAudible<WAVE_BITS_PER_SAMPLE_8>(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				// Flipping the top bit turns the unsigned samples into signed ones around 0.
+				const __m128i samples = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(a_Data + a_Index)), _mm_set1_epi8(static_cast<char>(0x80)));
+				const __m128i above = _mm_cmpgt_epi8(samples, _mm_set1_epi8(static_cast<char>(a_Levels.integer - 1)));
+				const __m128i below = _mm_cmplt_epi8(samples, _mm_set1_epi8(static_cast<char>(1 - a_Levels.integer)));
+				return (_mm_movemask_epi8(_mm_or_si128(above, below)) & 0xFF) != 0;
+			}
+
+			template <>
+			bool IsBlockAudible<WAVE_BITS_PER_SAMPLE_16>(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				// Compared against the threshold on both sides, so -32768 does not need an absolute value (which does not fit).
+				const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_Data + a_Index * sizeof(int16_t)));
+				const __m128i above = _mm_cmpgt_epi16(samples, _mm_set1_epi16(static_cast<int16_t>(a_Levels.integer - 1)));
+				const __m128i below = _mm_cmplt_epi16(samples, _mm_set1_epi16(static_cast<int16_t>(1 - a_Levels.integer)));
+				return _mm_movemask_epi8(_mm_or_si128(above, below)) != 0;
+			}
+
+			template <>
+			bool IsBlockAudible<WAVE_BITS_PER_SAMPLE_32>(const unsigned char *a_Data, uint32_t a_Index, const SilenceLevels &a_Levels)
+			{
+				const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+				const __m128 threshold = _mm_set1_ps(a_Levels.volume);
+				const float *samples = reinterpret_cast<const float *>(a_Data) + a_Index;
+				const __m128 first = _mm_and_ps(_mm_loadu_ps(samples), abs_mask);
+				const __m128 second = _mm_and_ps(_mm_loadu_ps(samples + 4), abs_mask);
+				return _mm_movemask_ps(_mm_or_ps(_mm_cmpge_ps(first, threshold), _mm_cmpge_ps(second, threshold))) != 0;
+			}
+#endif
+
+			/// <summary>
+			/// Finds the first loud sample.
+			/// </summary>
+			/// <param name="a_Data">The pcm data.</param>
+			/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+			/// <param name="a_Levels">The threshold.</param>
+			/// <returns>The index of the first loud sample (the amount of samples if there is none).</returns>
+			template <uint16_t BitsPerSample>
+			uint32_t FindFirstAudible(const unsigned char *a_Data, uint32_t a_NumSamples, const SilenceLevels &a_Levels)
+			{
+				uint32_t i = 0;
+				while (i + SILENCE_BLOCK <= a_NumSamples && !IsBlockAudible<BitsPerSample>(a_Data, i, a_Levels))
+					i += SILENCE_BLOCK;
+
+				for (; i < a_NumSamples; i++)
+					if (IsAudible<BitsPerSample>(a_Data, i, a_Levels))
+						return i;
+				return a_NumSamples;
+			}
+
+			/// <summary>
+			/// Finds the last loud sample, starting at the end.
+			/// </summary>
+			/// <param name="a_Data">The pcm data.</param>
+			/// <param name="a_NumSamples">The amount of samples (not frames).</param>
+			/// <param name="a_Levels">The threshold.</param>
+			/// <returns>The index after the last loud sample (0 if there is none).</returns>
+			template <uint16_t BitsPerSample>
+			uint32_t FindEndAudible(const unsigned char *a_Data, uint32_t a_NumSamples, const SilenceLevels &a_Levels)
+			{
+				// The samples after the last whole block go first, so the blocks line up with the start.
+				uint32_t i = a_NumSamples;
+				const uint32_t blocks_end = a_NumSamples - a_NumSamples % SILENCE_BLOCK;
+				for (; i > blocks_end; i--)
+					if (IsAudible<BitsPerSample>(a_Data, i - 1, a_Levels))
+						return i;
+
+				while (i >= SILENCE_BLOCK && !IsBlockAudible<BitsPerSample>(a_Data, i - SILENCE_BLOCK, a_Levels))
+					i -= SILENCE_BLOCK;
+
+				for (; i > 0; i--)
+					if (IsAudible<BitsPerSample>(a_Data, i - 1, a_Levels))
+						return i;
+				return 0;
+			}
+
+			/// <summary>
+			/// Finds the loud frames for one sample format.
+			/// </summary>
+			template <uint16_t BitsPerSample>
+			bool FindAudible(const unsigned char *a_Data, uint32_t a_NumSamples, uint16_t a_NumChannels, const SilenceLevels &a_Levels, uint32_t &a_FirstFrame, uint32_t &a_EndFrame)
+			{
+				const uint32_t first = FindFirstAudible<BitsPerSample>(a_Data, a_NumSamples, a_Levels);
+				if (first == a_NumSamples)
+					return false;
+
+				// The scan from the end never gets past the first loud sample.
+				const uint32_t end = FindEndAudible<BitsPerSample>(a_Data, a_NumSamples, a_Levels);
+				a_FirstFrame = first / a_NumChannels;
+				a_EndFrame = (end + a_NumChannels - 1) / a_NumChannels;
+				return true;
+			}
+		}
+
+		/// <summary>
+		/// Finds the frames between the silence at the start and the silence at the end.
+		/// </summary>
+		/// <param name="a_Data">The pcm data.</param>
+		/// <param name="a_Size">The size of the data (in bytes).</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <param name="a_Threshold">The level below which a sample is silent (in dB).</param>
+		/// <param name="a_FirstFrame">The first frame that is not silent.</param>
+		/// <param name="a_EndFrame">The frame after the last frame that is not silent.</param>
+		/// <returns>Whether there is a frame that is not silent (if not, both frames are 0).</returns>
+		bool FindAudibleFrames(const unsigned char *a_Data, uint32_t a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, float a_Threshold, uint32_t &a_FirstFrame, uint32_t &a_EndFrame)
+		{
+			a_FirstFrame = 0;
+			a_EndFrame = 0;
+			if (a_Data == nullptr || a_NumChannels == 0)
+				return false;
+
+			const uint32_t bytes_per_sample = a_BitsPerSample / 8;
+			const uint32_t block_align = bytes_per_sample * a_NumChannels;
+			if (block_align == 0)
+				return false;
+
+			// Only whole frames count.
+			const uint32_t num_samples = a_Size / block_align * a_NumChannels;
+
+			SilenceLevels levels;
+			levels.volume = std::pow(10.0f, a_Threshold / 20.0f);
+			switch (a_BitsPerSample)
+			{
+				case WAVE_BITS_PER_SAMPLE_8:
+				{
+					levels.integer = static_cast<int32_t>(utils::clamp(std::ceil(levels.volume * INT8_SCALE), 1.0f, INT8_SCALE));
+					return FindAudible<WAVE_BITS_PER_SAMPLE_8>(a_Data, num_samples, a_NumChannels, levels, a_FirstFrame, a_EndFrame);
+				}
+				case WAVE_BITS_PER_SAMPLE_16:
+				{
+					levels.integer = static_cast<int32_t>(utils::clamp(std::ceil(levels.volume * INT16_SCALE), 1.0f, INT16_SCALE));
+					return FindAudible<WAVE_BITS_PER_SAMPLE_16>(a_Data, num_samples, a_NumChannels, levels, a_FirstFrame, a_EndFrame);
+				}
+				case WAVE_BITS_PER_SAMPLE_24:
+				{
+					levels.integer = static_cast<int32_t>(utils::clamp(std::ceil(levels.volume * INT24_SCALE), 1.0f, INT24_SCALE));
+					return FindAudible<WAVE_BITS_PER_SAMPLE_24>(a_Data, num_samples, a_NumChannels, levels, a_FirstFrame, a_EndFrame);
+				}
+				case WAVE_BITS_PER_SAMPLE_32:
+				{
+					return FindAudible<WAVE_BITS_PER_SAMPLE_32>(a_Data, num_samples, a_NumChannels, levels, a_FirstFrame, a_EndFrame);
+				}
+				default:
+					return false;
+			}
+		}
+	}
+}
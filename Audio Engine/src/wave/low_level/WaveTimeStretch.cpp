@@ -0,0 +1,405 @@
+#include <uaudio/wave/low_level/WaveTimeStretch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <uaudio/Defines.h>
+#include <uaudio/utils/Utils.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define UAUDIO_TIMESTRETCH_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace uaudio
+{
+	namespace conversion
+	{
+		// The amount of frames that get converted per step when stretching at load time.
+		constexpr uint32_t TIMESTRETCH_BLOCK_FRAMES = 4096;
+
+		constexpr double TWO_PI = 6.28318530717958647692;
+
+		namespace
+		{
+			/// <summary>
+			/// Returns the dot product of two float arrays (4 or 8 at a time when SSE is available).
+			/// </summary>
+			/// <param name="a_Left">The first array.</param>
+			/// <param name="a_Right">The second array.</param>
+			/// <param name="a_Size">The amount of floats.</param>
+			/// <returns></returns>
+			float DotProduct(const float *a_Left, const float *a_Right, uint32_t a_Size)
+			{
+				uint32_t i = 0;
+				float sum = 0.0f;
+#if defined(UAUDIO_TIMESTRETCH_SSE)
+				__m128 sum_low = _mm_setzero_ps(), sum_high = _mm_setzero_ps();
+				for (; i + 8 <= a_Size; i += 8)
+				{
+					sum_low = _mm_add_ps(sum_low, _mm_mul_ps(_mm_loadu_ps(a_Left + i), _mm_loadu_ps(a_Right + i)));
+					sum_high = _mm_add_ps(sum_high, _mm_mul_ps(_mm_loadu_ps(a_Left + i + 4), _mm_loadu_ps(a_Right + i + 4)));
+				}
+				float lanes[4];
+				_mm_storeu_ps(lanes, _mm_add_ps(sum_low, sum_high));
+				sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+				for (; i < a_Size; i++)
+					sum += a_Left[i] * a_Right[i];
+				return sum;
+			}
+		}
+
+		/// <summary>
+		/// Calculates the size of time-stretched pcm data.
+		/// </summary>
+		/// <param name="a_Size">The size of the original data.</param>
+		/// <param name="a_BlockAlign">The block align.</param>
+		/// <param name="a_Tempo">The tempo (2 is twice as fast).</param>
+		/// <returns></returns>
+		uint32_t CalculateTimeStretchSize(uint32_t a_Size, uint16_t a_BlockAlign, float a_Tempo)
+		{
+			if (a_BlockAlign == 0 || a_Tempo <= 0.0f)
+				return 0;
+
+			const uint64_t in_frames = a_Size / a_BlockAlign;
+			const uint64_t out_frames = static_cast<uint64_t>(std::llround(static_cast<double>(in_frames) / a_Tempo));
+			return static_cast<uint32_t>(out_frames * a_BlockAlign);
+		}
+
+		/// <summary>
+		/// Changes the duration of pcm data without changing the pitch.
+		/// </summary>
+		/// <param name="a_DataBuffer">The new data buffer (needs to be CalculateTimeStretchSize bytes).</param>
+		/// <param name="a_OriginalDataBuffer">The original data buffer.</param>
+		/// <param name="a_Size">The data size (will get changed)</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <param name="a_SampleRate">The sample rate.</param>
+		/// <param name="a_Tempo">The tempo (2 is twice as fast).</param>
+		void TimeStretch(unsigned char *a_DataBuffer, unsigned char *a_OriginalDataBuffer, uint32_t &a_Size, uint16_t a_BitsPerSample, uint16_t a_NumChannels, uint32_t a_SampleRate, float a_Tempo)
+		{
+			const uint16_t block_align = a_NumChannels * a_BitsPerSample / 8;
+			if (block_align == 0 || a_SampleRate == 0 || a_Size % block_align != 0)
+				return;
+
+			const uint32_t new_size = CalculateTimeStretchSize(a_Size, block_align, a_Tempo);
+
+			StreamTimeStretch stretch;
+			stretch.Init(a_SampleRate, a_NumChannels, a_BitsPerSample, TIMESTRETCH_BLOCK_FRAMES);
+			stretch.SetTempo(a_Tempo);
+			if (!stretch.IsActive())
+			{
+				UAUDIO_DEFAULT_MEMCPY(a_DataBuffer, a_OriginalDataBuffer, a_Size);
+				return;
+			}
+
+			const uint32_t block_size = TIMESTRETCH_BLOCK_FRAMES * block_align;
+			std::vector<unsigned char, UAUDIO_DEFAULT_ALLOCATOR<unsigned char>> scratch(stretch.GetMaxOutputSize(block_size));
+			std::vector<unsigned char, UAUDIO_DEFAULT_ALLOCATOR<unsigned char>> silence(block_size, static_cast<unsigned char>(a_BitsPerSample == WAVE_BITS_PER_SAMPLE_8 ? 128 : 0));
+
+			// Feed the data and then silence until the output is complete (the last frames are still in the stretcher).
+			uint32_t pos = 0, out_size = 0;
+			while (out_size < new_size)
+			{
+				const unsigned char *input = silence.data();
+				uint32_t input_size = block_size;
+				if (pos < a_Size)
+				{
+					input = a_OriginalDataBuffer + pos;
+					input_size = std::min(block_size, a_Size - pos);
+					pos += input_size;
+				}
+
+				const uint32_t processed = stretch.Process(input, input_size, scratch.data());
+				const uint32_t copy_size = std::min(processed, new_size - out_size);
+				UAUDIO_DEFAULT_MEMCPY(a_DataBuffer + out_size, scratch.data(), copy_size);
+				out_size += copy_size;
+			}
+			a_Size = new_size;
+		}
+
+		/// <summary>
+		/// Sets up the time-stretcher for a sound. This is the only place where memory gets allocated.
+		/// </summary>
+		/// <param name="a_SampleRate">The sample rate of the sound.</param>
+		/// <param name="a_NumChannels">The number of channels.</param>
+		/// <param name="a_BitsPerSample">The bits per sample (8-bit, 16-bit, 24-bit, 32-bit).</param>
+		/// <param name="a_MaxInputFrames">The maximum amount of frames that get converted per step.</param>
+		void StreamTimeStretch::Init(uint32_t a_SampleRate, uint16_t a_NumChannels, uint16_t a_BitsPerSample, uint32_t a_MaxInputFrames)
+		{
+			m_NumChannels = a_NumChannels;
+			m_BitsPerSample = a_BitsPerSample;
+			m_MaxInputFrames = std::max(1u, a_MaxInputFrames);
+
+			const bool supported = a_BitsPerSample == WAVE_BITS_PER_SAMPLE_8 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_16 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_24 || a_BitsPerSample == WAVE_BITS_PER_SAMPLE_32;
+			if (!supported || a_NumChannels == 0 || a_SampleRate == 0)
+			{
+				m_FrameLength = 0;
+				m_Input.clear();
+				return;
+			}
+
+			m_OverlapLength = std::max(1u, a_SampleRate * UAUDIO_TIMESTRETCH_FRAME_MS / 2000);
+			m_FrameLength = m_OverlapLength * 2;
+			m_SearchLength = a_SampleRate * UAUDIO_TIMESTRETCH_SEARCH_MS / 1000;
+
+			// Enough for the frames the next step needs plus a full step of input.
+			m_Capacity = m_FrameLength * 4 + m_SearchLength * 4 + m_MaxInputFrames;
+
+			// A periodic hann window adds up to exactly 1 at half a frame of overlap.
+			m_Window.resize(m_FrameLength);
+			for (uint32_t i = 0; i < m_FrameLength; i++)
+				m_Window[i] = static_cast<float>(0.5 - 0.5 * std::cos(TWO_PI * i / m_FrameLength));
+
+			m_Input.assign(static_cast<size_t>(m_Capacity) * m_NumChannels, 0.0f);
+			m_Mono.assign(m_Capacity, 0.0f);
+			m_Overlap.assign(static_cast<size_t>(m_OverlapLength) * m_NumChannels, 0.0f);
+			Reset();
+		}
+
+		/// <summary>
+		/// Clears the input and the overlap (after seeking for example).
+		/// </summary>
+		void StreamTimeStretch::Reset()
+		{
+			m_NeedsReset = false;
+			if (m_FrameLength == 0)
+				return;
+
+			// Start with half a frame of silence so that the first frame does not fade in the sound.
+			m_InputFrames = m_OverlapLength;
+			std::fill(m_Input.begin(), m_Input.begin() + static_cast<size_t>(m_InputFrames) * m_NumChannels, 0.0f);
+			std::fill(m_Mono.begin(), m_Mono.begin() + m_InputFrames, 0.0f);
+			std::fill(m_Overlap.begin(), m_Overlap.end(), 0.0f);
+
+			m_Position = 0.0;
+			m_Previous = 0;
+			m_HasPrevious = false;
+			m_SkipFrames = m_OverlapLength;
+		}
+
+		/// <summary>
+		/// Sets the tempo (2 is twice as fast, 0.5 is twice as slow).
+		/// </summary>
+		/// <param name="a_Tempo">The tempo.</param>
+		void StreamTimeStretch::SetTempo(float a_Tempo)
+		{
+			a_Tempo = utils::clamp(a_Tempo, UAUDIO_MIN_TEMPO, UAUDIO_MAX_TEMPO);
+
+			// The input stops being stored while the tempo is 1, so it needs to start over when that changes.
+			if ((m_Tempo == 1.0f) != (a_Tempo == 1.0f))
+				m_NeedsReset = true;
+			m_Tempo = a_Tempo;
+		}
+
+		/// <summary>
+		/// Returns the tempo.
+		/// </summary>
+		/// <returns></returns>
+		float StreamTimeStretch::GetTempo() const
+		{
+			return m_Tempo;
+		}
+
+		/// <summary>
+		/// Returns whether the time-stretcher needs to be used (the tempo is not 1).
+		/// </summary>
+		/// <returns></returns>
+		bool StreamTimeStretch::IsActive() const
+		{
+			return m_FrameLength != 0 && m_Tempo != 1.0f;
+		}
+
+		/// <summary>
+		/// Returns the maximum size of the output for an input size.
+		/// </summary>
+		/// <param name="a_Size">The input size.</param>
+		/// <returns></returns>
+		uint32_t StreamTimeStretch::GetMaxOutputSize(uint32_t a_Size) const
+		{
+			const uint32_t block_align = m_NumChannels * m_BitsPerSample / 8;
+			if (m_FrameLength == 0 || block_align == 0)
+				return a_Size;
+
+			// Every frame moves the input by at least half a frame * UAUDIO_MIN_TEMPO and outputs half a frame.
+			const uint64_t frames = a_Size / block_align + m_Capacity;
+			const uint64_t steps = frames / std::max<uint64_t>(1, static_cast<uint64_t>(m_OverlapLength * UAUDIO_MIN_TEMPO)) + 1;
+			return static_cast<uint32_t>(steps * m_OverlapLength * block_align);
+		}
+
+		/// <summary>
+		/// Time-stretches a buffer of pcm data. The output buffer needs to be at least GetMaxOutputSize(a_Size) bytes.
+		/// </summary>
+		/// <param name="a_DataBuffer">The input data.</param>
+		/// <param name="a_Size">The input size.</param>
+		/// <param name="a_OutDataBuffer">The output data.</param>
+		/// <returns>The output size.</returns>
+		uint32_t StreamTimeStretch::Process(const unsigned char *a_DataBuffer, uint32_t a_Size, unsigned char *a_OutDataBuffer)
+		{
+			const uint32_t block_align = m_NumChannels * m_BitsPerSample / 8;
+			if (m_FrameLength == 0 || block_align == 0)
+				return 0;
+
+			if (m_NeedsReset)
+				Reset();
+
+			uint32_t frames = a_Size / block_align;
+			uint32_t out_size = 0;
+			while (frames > 0)
+			{
+				const uint32_t step = std::min(frames, m_MaxInputFrames);
+				uint32_t out_frames = 0;
+				switch (m_BitsPerSample)
+				{
+					case WAVE_BITS_PER_SAMPLE_8:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_8>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					case WAVE_BITS_PER_SAMPLE_16:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_16>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					case WAVE_BITS_PER_SAMPLE_24:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_24>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					case WAVE_BITS_PER_SAMPLE_32:
+					{
+						out_frames = ProcessFrames<WAVE_BITS_PER_SAMPLE_32>(a_DataBuffer, step, a_OutDataBuffer + out_size);
+						break;
+					}
+					default:
+						return out_size;
+				}
+				out_size += out_frames * block_align;
+				a_DataBuffer += step * block_align;
+				frames -= step;
+			}
+			return out_size;
+		}
+
+		/// <summary>
+		/// Looks for the frame position that continues the waveform of the previous frame best (normalized cross-correlation on the mono mix).
+		/// </summary>
+		/// <param name="a_Begin">The first position.</param>
+		/// <param name="a_End">The last position.</param>
+		/// <param name="a_Target">The position where the previous frame would naturally continue.</param>
+		/// <returns>The best position.</returns>
+		int64_t StreamTimeStretch::FindBestPosition(int64_t a_Begin, int64_t a_End, int64_t a_Target) const
+		{
+			const float *mono = m_Mono.data();
+			const float *target = mono + a_Target;
+
+			// The energy of the candidate gets updated while sliding, so only the correlation needs a full pass.
+			float energy = DotProduct(mono + a_Begin, mono + a_Begin, m_OverlapLength);
+
+			int64_t best_position = a_Begin;
+			float best_score = -std::numeric_limits<float>::max();
+			for (int64_t position = a_Begin; position <= a_End; position++)
+			{
+				const float correlation = DotProduct(mono + position, target, m_OverlapLength);
+				const float score = energy > 1e-9f ? correlation / std::sqrt(energy) : 0.0f;
+				if (score > best_score)
+				{
+					best_score = score;
+					best_position = position;
+				}
+
+				const float removed = mono[position], added = mono[position + m_OverlapLength];
+				energy = std::max(0.0f, energy - removed * removed + added * added);
+			}
+			return best_position;
+		}
+
+		/// <summary>
+		/// Appends frames to the input and outputs every frame that the input allows.
+		/// </summary>
+		/// <param name="a_DataBuffer">The input data.</param>
+		/// <param name="a_Frames">The amount of input frames (at most the max input frames).</param>
+		/// <param name="a_OutDataBuffer">The output data.</param>
+		/// <returns>The amount of output frames.</returns>
+		template <uint16_t BitsPerSample>
+		uint32_t StreamTimeStretch::ProcessFrames(const unsigned char *a_DataBuffer, uint32_t a_Frames, unsigned char *a_OutDataBuffer)
+		{
+			const uint32_t bytes_per_sample = BitsPerSample / 8;
+			const float channel_scale = 1.0f / m_NumChannels;
+
+			float *input = m_Input.data() + static_cast<size_t>(m_InputFrames) * m_NumChannels;
+			float *mono = m_Mono.data() + m_InputFrames;
+			for (uint32_t frame = 0; frame < a_Frames; frame++)
+			{
+				float sum = 0.0f;
+				for (uint16_t channel = 0; channel < m_NumChannels; channel++)
+				{
+					const float value = ReadSample<BitsPerSample>(a_DataBuffer + (static_cast<size_t>(frame) * m_NumChannels + channel) * bytes_per_sample);
+					input[static_cast<size_t>(frame) * m_NumChannels + channel] = value;
+					sum += value;
+				}
+				mono[frame] = sum * channel_scale;
+			}
+			m_InputFrames += a_Frames;
+
+			uint32_t out_frames = 0;
+			const int64_t input_frames = m_InputFrames;
+			while (true)
+			{
+				const int64_t nominal = static_cast<int64_t>(m_Position);
+				const int64_t begin = std::max<int64_t>(0, nominal - m_SearchLength);
+				const int64_t end = nominal + m_SearchLength;
+
+				// The candidates and the natural continuation of the previous frame need to be in the input.
+				int64_t needed = end + m_FrameLength;
+				if (m_HasPrevious)
+					needed = std::max<int64_t>(needed, m_Previous + m_FrameLength);
+				if (needed > input_frames)
+					break;
+
+				const int64_t position = m_HasPrevious ? FindBestPosition(begin, end, m_Previous + m_OverlapLength) : nominal;
+				const float *frame = m_Input.data() + static_cast<size_t>(position) * m_NumChannels;
+
+				// The first half gets added to the overlap of the previous frame and is done.
+				for (uint32_t i = 0; i < m_OverlapLength; i++)
+				{
+					for (uint16_t channel = 0; channel < m_NumChannels; channel++)
+					{
+						const size_t index = static_cast<size_t>(i) * m_NumChannels + channel;
+						const float value = m_Overlap[index] + frame[index] * m_Window[i];
+						m_Overlap[index] = frame[static_cast<size_t>(m_OverlapLength) * m_NumChannels + index] * m_Window[m_OverlapLength + i];
+						if (m_SkipFrames == 0)
+							WriteSample<BitsPerSample>(a_OutDataBuffer + (static_cast<size_t>(out_frames) * m_NumChannels + channel) * bytes_per_sample, value);
+					}
+					if (m_SkipFrames > 0)
+						m_SkipFrames--;
+					else
+						out_frames++;
+				}
+
+				m_Previous = position;
+				m_HasPrevious = true;
+				m_Position += m_OverlapLength * static_cast<double>(m_Tempo);
+			}
+
+			// Drop the input that no frame needs anymore.
+			int64_t shift = std::max<int64_t>(0, static_cast<int64_t>(m_Position) - m_SearchLength);
+			if (m_HasPrevious)
+				shift = std::min<int64_t>(shift, m_Previous + m_OverlapLength);
+			shift = std::min<int64_t>(shift, input_frames);
+
+			const uint32_t remaining = static_cast<uint32_t>(input_frames - shift);
+			std::memmove(m_Input.data(), m_Input.data() + static_cast<size_t>(shift) * m_NumChannels, static_cast<size_t>(remaining) * m_NumChannels * sizeof(float));
+			std::memmove(m_Mono.data(), m_Mono.data() + shift, static_cast<size_t>(remaining) * sizeof(float));
+			m_InputFrames = remaining;
+			m_Position -= static_cast<double>(shift);
+			m_Previous -= shift;
+
+			return out_frames;
+		}
+	}
+}
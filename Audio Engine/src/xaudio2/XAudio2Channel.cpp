@@ -3,27 +3,64 @@
 #include <uaudio/xaudio2/XAudio2Channel.h>
 #include <comdef.h>
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <uaudio/wave/low_level/WaveChannelMixer.h>
 #include <uaudio/wave/low_level/WaveEffects.h>
+#include <uaudio/wave/low_level/WaveLoop.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
 #include <uaudio/utils/Logger.h>
 
 #include <uaudio/wave/high_level/WaveChunks.h>
 
 namespace uaudio::xaudio2
 {
+	// The amount of samples that the effects process at a time (stays on the stack).
+	constexpr uint32_t EFFECTS_BLOCK_SAMPLES = 256;
+
+	// An envelope command holds what it does (the low byte), the curve (the byte above it) and the length in milliseconds (a float in the high 32 bits).
+	// 0 means that there is no command.
+	constexpr uint64_t ENVELOPE_COMMAND_FADE_IN = 1;
+	constexpr uint64_t ENVELOPE_COMMAND_RELEASE = 2;
+	constexpr uint64_t ENVELOPE_COMMAND_MASK = 0xFF;
+	constexpr uint32_t ENVELOPE_COMMAND_CURVE_SHIFT = 8;
+	constexpr uint32_t ENVELOPE_COMMAND_LENGTH_SHIFT = 32;
+
 	XAudio2Channel::XAudio2Channel(AudioSystem &a_AudioSystem) : m_AudioSystem(&a_AudioSystem)
 	{
-		m_VoiceCallback = XAudio2Callback();
 	}
 
 	XAudio2Channel::XAudio2Channel(const XAudio2Channel &rhs) : m_AudioSystem(rhs.m_AudioSystem)
 	{
 		m_Volume = rhs.m_Volume;
 		m_Panning = rhs.m_Panning;
+		m_Tempo = rhs.m_Tempo;
+		m_LoopCrossfade = rhs.m_LoopCrossfade;
+		m_Emitter = rhs.m_Emitter;
+		m_Bus = rhs.m_Bus;
+		m_DuckGain = rhs.m_DuckGain;
 		m_CurrentSound = rhs.m_CurrentSound;
 		m_IsPlaying = rhs.m_IsPlaying;
 		m_CurrentPos = rhs.m_CurrentPos;
 		SetSound(*m_CurrentSound);
-		m_VoiceCallback = rhs.m_VoiceCallback;
+		m_LoopState = rhs.m_LoopState;
+		m_Envelope = rhs.m_Envelope;
+		m_ADSR = rhs.m_ADSR;
+		m_EnvelopeCommand = rhs.m_EnvelopeCommand.load();
+		m_LoopRelease = rhs.m_LoopRelease.load();
+		m_EnvelopeMoving = rhs.m_EnvelopeMoving.load();
+		*m_VoiceCallback = *rhs.m_VoiceCallback;
+	}
+
+	/// <summary>
+	/// Takes over the source voice, the stream and the queued buffers of another channel (the vector of channels moves them when a channel gets erased).
+	/// </summary>
+	/// <param name="rhs">The channel that gets moved (it does not play anything after this).</param>
+	XAudio2Channel::XAudio2Channel(XAudio2Channel &&rhs) noexcept
+	{
+		*this = std::move(rhs);
 	}
 
 	XAudio2Channel::~XAudio2Channel()
@@ -42,11 +79,91 @@ namespace uaudio::xaudio2
 			m_AudioSystem = rhs.m_AudioSystem;
 			m_Volume = rhs.m_Volume;
 			m_Panning = rhs.m_Panning;
+			m_Tempo = rhs.m_Tempo;
+			m_LoopCrossfade = rhs.m_LoopCrossfade;
+			m_Envelope = rhs.m_Envelope;
+			m_ADSR = rhs.m_ADSR;
+			m_EnvelopeCommand = rhs.m_EnvelopeCommand.load();
+			m_LoopRelease = rhs.m_LoopRelease.load();
+			m_EnvelopeMoving = rhs.m_EnvelopeMoving.load();
+			m_Meter = rhs.m_Meter;
+			m_Emitter = rhs.m_Emitter;
+			m_Bus = rhs.m_Bus;
+			m_DuckGain = rhs.m_DuckGain;
+			m_CurrentSound = rhs.m_CurrentSound;
+			m_IsPlaying = rhs.m_IsPlaying;
+			m_CurrentPos = rhs.m_CurrentPos;
+			m_LoopState = rhs.m_LoopState;
+			m_SourceVoice = rhs.m_SourceVoice;
+			*m_VoiceCallback = *rhs.m_VoiceCallback;
+
+			// A stream belongs to one channel (closing it would stop the other channel), so a copy opens its own at the same position.
+			if (m_AudioSystem != nullptr)
+				m_AudioSystem->GetStreamer().Close(m_Stream);
+			m_Stream = StreamHandle();
+			if (rhs.m_Stream.IsValid() && m_AudioSystem != nullptr && m_CurrentSound != nullptr)
+			{
+				m_Stream = m_AudioSystem->GetStreamer().Open(*m_CurrentSound);
+				if (m_Stream.IsValid())
+					m_AudioSystem->GetStreamer().Seek(m_Stream, m_CurrentPos);
+			}
+			m_Resampler = rhs.m_Resampler;
+			m_TimeStretch = rhs.m_TimeStretch;
+			m_Ditherer = rhs.m_Ditherer;
+			m_ReadBuffer = rhs.m_ReadBuffer;
+			m_StretchBuffer = rhs.m_StretchBuffer;
+		}
+		return *this;
+	}
+
+	/// <summary>
+	/// Stops the channel and takes over the source voice, the stream and the queued buffers of another channel.
+	/// </summary>
+	/// <param name="rhs">The channel that gets moved (it does not play anything after this).</param>
+	/// <returns></returns>
+	XAudio2Channel &XAudio2Channel::operator=(XAudio2Channel &&rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			// The voice, the stream and the buffers of this channel are not used by anything else.
+			Stop();
+
+			m_AudioSystem = rhs.m_AudioSystem;
+			m_Volume = rhs.m_Volume;
+			m_Panning = rhs.m_Panning;
+			m_Tempo = rhs.m_Tempo;
+			m_LoopCrossfade = rhs.m_LoopCrossfade;
+			m_Looping = rhs.m_Looping;
+			m_Active = rhs.m_Active;
+			m_Envelope = rhs.m_Envelope;
+			m_ADSR = rhs.m_ADSR;
+			m_EnvelopeCommand = rhs.m_EnvelopeCommand.exchange(0);
+			m_LoopRelease = rhs.m_LoopRelease.exchange(false);
+			m_EnvelopeMoving = rhs.m_EnvelopeMoving.load();
+			m_Meter = rhs.m_Meter;
+			m_Emitter = rhs.m_Emitter;
+			m_Bus = rhs.m_Bus;
+			m_DuckGain = rhs.m_DuckGain;
 			m_CurrentSound = rhs.m_CurrentSound;
 			m_IsPlaying = rhs.m_IsPlaying;
 			m_CurrentPos = rhs.m_CurrentPos;
+			m_LoopState = rhs.m_LoopState;
+			m_Resampler = std::move(rhs.m_Resampler);
+			m_TimeStretch = std::move(rhs.m_TimeStretch);
+			m_Ditherer = std::move(rhs.m_Ditherer);
+			m_ReadBuffer = std::move(rhs.m_ReadBuffer);
+			m_StretchBuffer = std::move(rhs.m_StretchBuffer);
+			m_DataBuffers = std::move(rhs.m_DataBuffers);
+
+			// The other channel lets go of them, so its destructor does not close the stream or destroy the voice.
+			m_Stream = rhs.m_Stream;
+			rhs.m_Stream = StreamHandle();
 			m_SourceVoice = rhs.m_SourceVoice;
-			m_VoiceCallback = rhs.m_VoiceCallback;
+			rhs.m_SourceVoice = nullptr;
+			rhs.m_IsPlaying = false;
+
+			// XAudio2 calls the callback that the voice was created with, so that goes along. The voice of this channel is gone, the other channel can use its callback.
+			std::swap(m_VoiceCallback, rhs.m_VoiceCallback);
 		}
 		return *this;
 	}
@@ -62,29 +179,81 @@ namespace uaudio::xaudio2
 			m_Looping = m_CurrentSound->IsLooping();
 
 		m_CurrentPos = a_Sound.GetStartPosition();
+		m_LoopState = conversion::LoopState();
 		HRESULT hr;
 		if (m_SourceVoice != nullptr)
 			Stop();
+
+		// The pages of a mapped sound get read while the voice gets set up.
+		a_Sound.Prefetch();
+
+		// A sound that stays on the disk fills its stream before it starts. Without a stream the channel has nothing to play and frees itself.
+		m_AudioSystem->GetStreamer().Close(m_Stream);
+		m_Stream = StreamHandle();
+		if (a_Sound.IsStreaming())
+		{
+			m_Stream = m_AudioSystem->GetStreamer().Open(a_Sound);
+			if (!m_Stream.IsValid())
+				logger::log_warning("<XAudio2> Failed opening a stream for a sound.");
+		}
+
+		const FMT_Chunk &fmt_chunk = m_CurrentSound->GetFmtChunk();
+
+		// Sounds with a different sample rate get converted while streaming, so that every source voice runs at the rate of the audio system.
+		m_Resampler.Init(fmt_chunk.sampleRate, m_AudioSystem->GetSampleRate(), fmt_chunk.numChannels, fmt_chunk.bitsPerSample, static_cast<uint32_t>(BUFFERSIZE::BUFFERSIZE_8192) / fmt_chunk.blockAlign);
+
+		m_TimeStretch.Init(fmt_chunk.sampleRate, fmt_chunk.numChannels, fmt_chunk.bitsPerSample, static_cast<uint32_t>(BUFFERSIZE::BUFFERSIZE_8192) / fmt_chunk.blockAlign);
+		m_TimeStretch.SetTempo(m_Tempo);
+
+		m_Ditherer.Init(UAUDIO_DEFAULT_DITHER, fmt_chunk.numChannels);
+
+		// Big enough for the biggest buffer size, so that changing the buffer size does not allocate either.
+		m_ReadBuffer.resize(static_cast<size_t>(BUFFERSIZE::BUFFERSIZE_8192));
+		m_StretchBuffer.resize(m_TimeStretch.GetMaxOutputSize(static_cast<uint32_t>(BUFFERSIZE::BUFFERSIZE_8192)));
+
+		// The envelope runs at the rate of the data that gets submitted, and starts with the attack.
+		m_Envelope.Init(m_Resampler.IsActive() ? m_AudioSystem->GetSampleRate() : fmt_chunk.sampleRate);
+		m_Envelope.SetADSR(m_ADSR);
+		m_Envelope.Trigger();
+		m_Meter.Init(m_Resampler.IsActive() ? m_AudioSystem->GetSampleRate() : fmt_chunk.sampleRate, fmt_chunk.numChannels, m_CurrentSound->GetWaveFormat().GetChannelMask());
+
 		if (m_SourceVoice == nullptr)
 		{
-			WAVEFORMATEX wave;
+			WAVEFORMATEXTENSIBLE wave_extensible = {};
+			WAVEFORMATEX &wave = wave_extensible.Format;
 
-			const FMT_Chunk fmt_chunk = m_CurrentSound->GetWaveFormat().GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
 			// Set WAV format default. (what we expect the user to provide).
-			wave.wFormatTag = fmt_chunk.audioFormat;
+			const uint16_t audio_format = m_CurrentSound->GetWaveFormat().GetAudioFormat();
+			const uint32_t channel_mask = m_CurrentSound->GetWaveFormat().GetChannelMask();
+			wave.wFormatTag = audio_format;
 			wave.nChannels = fmt_chunk.numChannels;
-			wave.nSamplesPerSec = fmt_chunk.sampleRate; // 44100 hz (should be standard).
+			wave.nSamplesPerSec = m_Resampler.IsActive() ? m_AudioSystem->GetSampleRate() : fmt_chunk.sampleRate;
 			wave.cbSize = 0;
 			wave.wBitsPerSample = fmt_chunk.bitsPerSample;
 			wave.nBlockAlign = fmt_chunk.blockAlign;
-			wave.nAvgBytesPerSec = fmt_chunk.byteRate;
-			if (FAILED(hr = m_AudioSystem->GetEngine().CreateSourceVoice(&m_SourceVoice, &wave, 0, 2.0f, &m_VoiceCallback)))
+			wave.nAvgBytesPerSec = wave.nSamplesPerSec * fmt_chunk.blockAlign;
+
+			// More than 2 channels (or another speaker layout) need WAVE_FORMAT_EXTENSIBLE, otherwise XAudio2 does not know which speaker a channel belongs to.
+			if (fmt_chunk.numChannels > WAVE_CHANNELS_STEREO || channel_mask != conversion::GetDefaultChannelMask(fmt_chunk.numChannels))
+			{
+				wave.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+				wave.cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+				wave_extensible.Samples.wValidBitsPerSample = fmt_chunk.bitsPerSample;
+				wave_extensible.dwChannelMask = channel_mask;
+				wave_extensible.SubFormat = {audio_format, 0x0000, 0x0010, {0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71}};
+			}
+			if (FAILED(hr = m_AudioSystem->GetEngine().CreateSourceVoice(&m_SourceVoice, &wave, 0, 2.0f, m_VoiceCallback.get())))
 			{
 				logger::ASSERT(false, "<XAudio2> Creating XAudio2 Source Voice failed.");
 				m_IsPlaying = false;
 				return;
 			}
 		}
+
+		// Channels with an emitter get their output matrix from the spatializer.
+		if (!m_Emitter.IsValid())
+			ResetOutputMatrix();
+
 		if (FAILED(hr = m_SourceVoice->Start(0, 0)))
 		{
 			logger::ASSERT(false, "<XAudio2> Starting XAudio2 Source Voice failed.");
@@ -127,10 +296,29 @@ namespace uaudio::xaudio2
 	}
 
 	/// <summary>
-	/// Stops and resets the channel (removing the sound and flushing the buffers).
+	/// Stops and resets the channel (flushing the buffers).
+	/// With a release, the envelope releases first and then the sound gets removed, so that the channel can be used by the next sound.
 	/// </summary>
-	void XAudio2Channel::Stop()
+	/// <param name="a_Release">Whether the envelope needs to release first.</param>
+	void XAudio2Channel::Stop(bool a_Release)
 	{
+		if (a_Release)
+		{
+			// The channel gets freed by the update once the release is done.
+			if (m_IsPlaying && m_SourceVoice != nullptr && m_ADSR.release > 0.0f)
+				PostEnvelopeCommand(ENVELOPE_COMMAND_RELEASE, m_ADSR.release, m_ADSR.curve);
+			else
+			{
+				Stop();
+				RemoveSound();
+			}
+			return;
+		}
+
+		if (m_AudioSystem != nullptr)
+			m_AudioSystem->GetStreamer().Close(m_Stream);
+		m_Stream = StreamHandle();
+
 		while (!m_DataBuffers.empty())
 		{
 			unsigned char *buffer = m_DataBuffers.front();
@@ -149,6 +337,14 @@ namespace uaudio::xaudio2
 		m_IsPlaying = false;
 
 		m_CurrentPos = IsInUse() ? m_CurrentSound->GetStartPosition() : 0;
+		m_LoopState = conversion::LoopState();
+		m_Envelope.Trigger();
+		m_EnvelopeCommand = 0;
+		m_LoopRelease = false;
+		m_EnvelopeMoving = false;
+		m_Resampler.Reset();
+		m_TimeStretch.Reset();
+		m_Ditherer.Reset();
 	}
 
 	/// <summary>
@@ -174,7 +370,16 @@ namespace uaudio::xaudio2
 	/// <param name="a_StartPos"></param>
 	void XAudio2Channel::SetPos(uint32_t a_StartPos)
 	{
+		if (m_Stream.IsValid())
+			m_AudioSystem->GetStreamer().Seek(m_Stream, a_StartPos);
+		else if (m_CurrentSound != nullptr)
+			m_CurrentSound->GetWaveFormat().Prefetch(a_StartPos, UAUDIO_DEFAULT_PREFETCH_SIZE);
+
 		m_CurrentPos = a_StartPos;
+		m_LoopState = conversion::LoopState();
+		m_Resampler.Reset();
+		m_TimeStretch.Reset();
+		m_Ditherer.Reset();
 	}
 
 	/// <summary>
@@ -187,7 +392,7 @@ namespace uaudio::xaudio2
 		if (!IsInUse())
 			return 0.0f;
 
-		const FMT_Chunk fmt_chunk = m_CurrentSound->GetWaveFormat().GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+		const FMT_Chunk &fmt_chunk = m_CurrentSound->GetFmtChunk();
 		switch (a_TimeUnit)
 		{
 		case TIMEUNIT::TIMEUNIT_MS:
@@ -211,16 +416,13 @@ namespace uaudio::xaudio2
 	}
 
 	/// <summary>
-	/// Returns the buffer size of the current sound.
+	/// Returns the number of buffers that the channel keeps queued for the current sound.
 	/// </summary>
 	/// <returns></returns>
 	uint32_t XAudio2Channel::GetBufferSize() const
 	{
 		if (m_CurrentSound != nullptr)
-		{
-			const FMT_Chunk fmt_chunk = m_CurrentSound->GetWaveFormat().GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
-			return fmt_chunk.bitsPerSample / 8;
-		}
+			return UAUDIO_DEFAULT_QUEUED_BUFFERS;
 		else
 			return 0;
 	}
@@ -242,51 +444,109 @@ namespace uaudio::xaudio2
 		m_SourceVoice->GetState(&state);
 		if (state.BuffersQueued < GetBufferSize())
 		{
-			if (m_DataBuffers.size() == 2)
+			// Buffers that XAudio2 has finished with can be freed (they get played in order, so the last BuffersQueued are still in use).
+			while (m_DataBuffers.size() > state.BuffersQueued)
 			{
 				unsigned char *buffer = m_DataBuffers.front();
 				UAUDIO_DEFAULT_FREE(buffer);
 				m_DataBuffers.pop();
 			}
 
-			// If the sound is done playing, check whether it needs to be repeated or whether it needs to be stopped entirely.
-			if (m_CurrentSound->IsEndOfBuffer(a_StartPos))
+			// The fades and releases of the game thread take effect from this buffer on.
+			ApplyEnvelopeCommands();
+
+			const FMT_Chunk &fmt_chunk = m_CurrentSound->GetFmtChunk();
+			const bool looping = m_CurrentSound->IsLooping() || m_Looping;
+
+			conversion::LoopSettings loop;
+			loop.start = m_CurrentSound->GetStartPosition();
+			loop.end = m_CurrentSound->GetEndPosition();
+			loop.looping = looping;
+			loop.crossfade = static_cast<uint32_t>(m_LoopCrossfade * static_cast<float>(fmt_chunk.sampleRate) / 1000.0f);
+
+			// The loops of the smpl chunk play inside the range (forward, ping-pong or reverse, with their play count).
+			if (m_CurrentSound->GetWaveFormat().HasChunk(SMPL_CHUNK_ID))
+			{
+				const SMPL_Chunk smpl_chunk = m_CurrentSound->GetWaveFormat().GetChunkFromData<SMPL_Chunk>(SMPL_CHUNK_ID);
+				loop.sampleLoops = smpl_chunk.samples;
+				loop.numSampleLoops = smpl_chunk.num_sample_loops;
+			}
+
+			// Read the part of the wave file (wrapping around the loop at the exact frame).
+			a_Size = std::min(a_Size, static_cast<uint32_t>(m_ReadBuffer.size()));
+			unsigned char *data = m_ReadBuffer.data();
+			const unsigned char *wave_data = m_CurrentSound->GetData();
+			if (m_Envelope.IsDone())
+				a_Size = 0;
+			else if (m_CurrentSound->IsStreaming())
 			{
-				m_CurrentPos = m_CurrentSound->GetStartPosition();
-				a_StartPos = m_CurrentSound->GetStartPosition();
-				// If the sound is not set to repeat, then stop the channel.
-				if (!m_CurrentSound->IsLooping() && !m_Looping)
+				// The stream loops between the start and end position (the loops of the smpl chunk and the crossfade need the data in memory).
+				Streamer &streamer = m_AudioSystem->GetStreamer();
+				streamer.SetLooping(m_Stream, looping);
+				a_Size = streamer.Read(m_Stream, data, a_Size, a_StartPos);
+
+				// The disk has not caught up (an underrun or a seek), the queued buffers keep playing until it has.
+				if (a_Size == 0 && !streamer.IsFinished(m_Stream))
+					return;
+			}
+			else
+				a_Size = conversion::ReadLooped(data, a_Size, wave_data, m_CurrentSound->GetDataSize(), a_StartPos, m_LoopState, loop, fmt_chunk.bitsPerSample, fmt_chunk.numChannels);
+
+			// If the sound is done playing (or the envelope has released), let the queued buffers finish and then stop the channel.
+			if (a_Size == 0)
+			{
+				if (state.BuffersQueued == 0)
 				{
 					Stop();
 					RemoveSound();
-					return;
 				}
+				return;
 			}
 
-			unsigned char *data = {};
-
-			// Read the part of the wave file and store it back in the read buffer.
-			m_CurrentSound->Read(a_StartPos, a_Size, data);
+			// Time-stretching happens at the rate of the sound, so before the resampling.
+			// Only the buffer that gets submitted gets allocated, stretched data that still gets resampled goes into the buffer of the channel.
+			unsigned char *stretched_data = nullptr;
+			const unsigned char *source_data = data;
+			uint32_t source_size = a_Size;
+			if (m_TimeStretch.IsActive())
+			{
+				stretched_data = m_Resampler.IsActive() ? m_StretchBuffer.data() : reinterpret_cast<unsigned char *>(UAUDIO_DEFAULT_ALLOC(m_TimeStretch.GetMaxOutputSize(a_Size)));
+				source_size = m_TimeStretch.Process(data, a_Size, stretched_data);
+				source_data = stretched_data;
+			}
 
-			unsigned char *new_data = reinterpret_cast<unsigned char *>(UAUDIO_DEFAULT_ALLOC(a_Size));
-			UAUDIO_DEFAULT_MEMCPY(new_data, data, a_Size);
+			// The size of the buffer that gets submitted (differs from the read size when the sound gets stretched or resampled).
+			uint32_t buffer_size = source_size;
+			unsigned char *new_data = nullptr;
+			if (m_Resampler.IsActive())
+			{
+				new_data = reinterpret_cast<unsigned char *>(UAUDIO_DEFAULT_ALLOC(m_Resampler.GetMaxOutputSize(source_size)));
+				buffer_size = m_Resampler.Process(source_data, source_size, new_data);
+			}
+			else if (stretched_data != nullptr)
+				new_data = stretched_data;
+			else
+			{
+				new_data = reinterpret_cast<unsigned char *>(UAUDIO_DEFAULT_ALLOC(a_Size));
+				UAUDIO_DEFAULT_MEMCPY(new_data, data, a_Size);
+			}
 
 			// Other effects.
-			ApplyEffects(new_data, a_Size);
+			ApplyEffects(new_data, buffer_size);
 
-			// Make sure the new pos is the current pos.
+			// The read moved the position (and wrapped it around the loop), so that on the next frame we will get the next part of the wave file.
 			m_CurrentPos = a_StartPos;
 
-			// Make sure we add the size of this read buffer to the total size, so that on the next frame we will get the next part of the wave file.
-			m_CurrentPos += a_Size;
-
-			if (!m_Active)
+			// The resampler and the time-stretcher hold back frames (filter delay, overlap), so there can be nothing to submit yet.
+			if (buffer_size == 0)
 			{
-				const FMT_Chunk fmt_chunk = m_CurrentSound->GetWaveFormat().GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
-				effects::ChangeVolume<int16_t>(new_data, a_Size, UAUDIO_MIN_VOLUME, fmt_chunk.blockAlign, fmt_chunk.numChannels);
+				UAUDIO_DEFAULT_FREE(new_data);
+				return;
 			}
 
-			PlayBuffer(new_data, a_Size);
+			ApplySpatialization();
+
+			PlayBuffer(new_data, buffer_size);
 			m_DataBuffers.push(new_data);
 		}
 	}
@@ -315,7 +575,14 @@ namespace uaudio::xaudio2
 	/// </summary>
 	void XAudio2Channel::ResetPos()
 	{
+		if (m_Stream.IsValid())
+			m_AudioSystem->GetStreamer().Seek(m_Stream, 0);
+
 		m_CurrentPos = 0;
+		m_LoopState = conversion::LoopState();
+		m_Resampler.Reset();
+		m_TimeStretch.Reset();
+		m_Ditherer.Reset();
 	}
 
 	/// <summary>
@@ -341,7 +608,7 @@ namespace uaudio::xaudio2
 	/// <returns>The XAudio2 voice callback</returns>
 	XAudio2Callback &XAudio2Channel::GetVoiceCallback()
 	{
-		return m_VoiceCallback;
+		return *m_VoiceCallback;
 	}
 
 	/// <summary>
@@ -382,6 +649,65 @@ namespace uaudio::xaudio2
 		return m_Panning;
 	}
 
+	/// <summary>
+	/// Sets the tempo of the channel (the pitch stays the same).
+	/// </summary>
+	/// <param name="a_Tempo">The tempo (from 0.5 to 2).</param>
+	void XAudio2Channel::SetTempo(float a_Tempo)
+	{
+		a_Tempo = utils::clamp(a_Tempo, UAUDIO_MIN_TEMPO, UAUDIO_MAX_TEMPO);
+		m_Tempo = a_Tempo;
+		m_TimeStretch.SetTempo(a_Tempo);
+	}
+
+	/// <summary>
+	/// Returns the tempo of the channel.
+	/// </summary>
+	/// <returns>The tempo of the channel.</returns>
+	float XAudio2Channel::GetTempo() const
+	{
+		return m_Tempo;
+	}
+
+	/// <summary>
+	/// Sets the emitter that positions the channel in 3D.
+	/// </summary>
+	/// <param name="a_EmitterHandle">Handle to the emitter (an invalid handle removes the positioning).</param>
+	void XAudio2Channel::SetEmitter(EmitterHandle a_EmitterHandle)
+	{
+		const bool had_emitter = m_Emitter.IsValid();
+		m_Emitter = a_EmitterHandle;
+		if (had_emitter && !m_Emitter.IsValid())
+			ResetOutputMatrix();
+	}
+
+	/// <summary>
+	/// Returns the emitter that positions the channel.
+	/// </summary>
+	/// <returns>Handle to the emitter.</returns>
+	EmitterHandle XAudio2Channel::GetEmitter() const
+	{
+		return m_Emitter;
+	}
+
+	/// <summary>
+	/// Sets the bus that the channel plays on (the ducker turns buses down, see Ducker).
+	/// </summary>
+	/// <param name="a_Bus">The bus.</param>
+	void XAudio2Channel::SetBus(uint32_t a_Bus)
+	{
+		m_Bus = std::min(a_Bus, UAUDIO_MAX_BUSES - 1);
+	}
+
+	/// <summary>
+	/// Returns the bus that the channel plays on.
+	/// </summary>
+	/// <returns>The bus.</returns>
+	uint32_t XAudio2Channel::GetBus() const
+	{
+		return m_Bus;
+	}
+
 	/// <summary>
 	/// Returns whether or not the channel is playing audio.
 	/// </summary>
@@ -418,30 +744,325 @@ namespace uaudio::xaudio2
 		m_Looping = a_Looping;
 	}
 
+	/// <summary>
+	/// Returns whether the channel reads its sound from a stream.
+	/// </summary>
+	/// <returns></returns>
+	bool XAudio2Channel::IsStreaming() const
+	{
+		return m_Stream.IsValid();
+	}
+
+	/// <summary>
+	/// Returns how many times the stream of the channel could not keep up with the playback.
+	/// </summary>
+	/// <returns>The amount of underruns (0 for a sound in memory).</returns>
+	uint32_t XAudio2Channel::GetStreamUnderruns() const
+	{
+		if (!m_Stream.IsValid())
+			return 0;
+
+		return m_AudioSystem->GetStreamer().GetUnderruns(m_Stream);
+	}
+
+	/// <summary>
+	/// Sets the length of the crossfade over the loop seam.
+	/// </summary>
+	/// <param name="a_Milliseconds">The length of the crossfade in milliseconds (0 means no crossfade).</param>
+	void XAudio2Channel::SetLoopCrossfade(float a_Milliseconds)
+	{
+		m_LoopCrossfade = std::max(a_Milliseconds, 0.0f);
+	}
+
+	/// <summary>
+	/// Returns the length of the crossfade over the loop seam.
+	/// </summary>
+	/// <returns>The length of the crossfade in milliseconds.</returns>
+	float XAudio2Channel::GetLoopCrossfade() const
+	{
+		return m_LoopCrossfade;
+	}
+
+	/// <summary>
+	/// Releases the sound, the sustain loop (a loop in the smpl chunk with a play count of 0) plays to its end and the sound continues after it.
+	/// When the envelope has a release time, the envelope releases as well and the channel stops after it.
+	/// </summary>
+	void XAudio2Channel::Release()
+	{
+		m_LoopRelease = true;
+		if (m_ADSR.release > 0.0f)
+			PostEnvelopeCommand(ENVELOPE_COMMAND_RELEASE, m_ADSR.release, m_ADSR.curve);
+	}
+
+	/// <summary>
+	/// Sets the ADSR of the envelope (used from the next sound on, and by the release).
+	/// </summary>
+	/// <param name="a_ADSR">The ADSR.</param>
+	void XAudio2Channel::SetADSR(const effects::ADSR &a_ADSR)
+	{
+		m_ADSR = a_ADSR;
+	}
+
+	/// <summary>
+	/// Returns the ADSR of the envelope.
+	/// </summary>
+	/// <returns>The ADSR.</returns>
+	const effects::ADSR &XAudio2Channel::GetADSR() const
+	{
+		return m_ADSR;
+	}
+
+	/// <summary>
+	/// Returns the envelope of the channel (only for the audio thread while the sound plays).
+	/// </summary>
+	/// <returns>The envelope.</returns>
+	const effects::Envelope &XAudio2Channel::GetEnvelope() const
+	{
+		return m_Envelope;
+	}
+
+	/// <summary>
+	/// Fades the channel in. A channel that is not fading starts from silence.
+	/// </summary>
+	/// <param name="a_Milliseconds">The length of the fade in milliseconds.</param>
+	/// <param name="a_Curve">The curve of the fade.</param>
+	void XAudio2Channel::FadeIn(float a_Milliseconds, ENVELOPE_CURVE a_Curve)
+	{
+		PostEnvelopeCommand(ENVELOPE_COMMAND_FADE_IN, a_Milliseconds, a_Curve);
+	}
+
+	/// <summary>
+	/// Fades the channel out. The channel stops when the fade is done.
+	/// </summary>
+	/// <param name="a_Milliseconds">The length of the fade in milliseconds.</param>
+	/// <param name="a_Curve">The curve of the fade.</param>
+	void XAudio2Channel::FadeOut(float a_Milliseconds, ENVELOPE_CURVE a_Curve)
+	{
+		PostEnvelopeCommand(ENVELOPE_COMMAND_RELEASE, a_Milliseconds, a_Curve);
+	}
+
+	/// <summary>
+	/// Returns whether the volume of the envelope is changing (fades, attack, decay and release), as of the last buffer or a fade that is still posted.
+	/// </summary>
+	/// <returns></returns>
+	bool XAudio2Channel::IsFading() const
+	{
+		return m_EnvelopeCommand != 0 || m_EnvelopeMoving;
+	}
+
+	/// <summary>
+	/// Posts a fade or release for the audio thread (it replaces one that has not been applied yet).
+	/// </summary>
+	/// <param name="a_Command">What the envelope needs to do.</param>
+	/// <param name="a_Milliseconds">The length in milliseconds.</param>
+	/// <param name="a_Curve">The curve.</param>
+	void XAudio2Channel::PostEnvelopeCommand(uint64_t a_Command, float a_Milliseconds, ENVELOPE_CURVE a_Curve)
+	{
+		uint32_t milliseconds = 0;
+		UAUDIO_DEFAULT_MEMCPY(&milliseconds, &a_Milliseconds, sizeof(milliseconds));
+		m_EnvelopeCommand = a_Command | (static_cast<uint64_t>(a_Curve) << ENVELOPE_COMMAND_CURVE_SHIFT) | (static_cast<uint64_t>(milliseconds) << ENVELOPE_COMMAND_LENGTH_SHIFT);
+	}
+
+	/// <summary>
+	/// Applies the fade, release and loop release that the game thread posted (on the audio thread, before a buffer gets read).
+	/// </summary>
+	void XAudio2Channel::ApplyEnvelopeCommands()
+	{
+		if (m_LoopRelease.exchange(false))
+			m_LoopState.released = true;
+
+		const uint64_t command = m_EnvelopeCommand.exchange(0);
+		if (command != 0)
+		{
+			const ENVELOPE_CURVE curve = static_cast<ENVELOPE_CURVE>((command >> ENVELOPE_COMMAND_CURVE_SHIFT) & ENVELOPE_COMMAND_MASK);
+			const uint32_t milliseconds = static_cast<uint32_t>(command >> ENVELOPE_COMMAND_LENGTH_SHIFT);
+			float length = 0.0f;
+			UAUDIO_DEFAULT_MEMCPY(&length, &milliseconds, sizeof(length));
+
+			switch (command & ENVELOPE_COMMAND_MASK)
+			{
+				case ENVELOPE_COMMAND_FADE_IN:
+				{
+					// A channel that is not fading starts from silence.
+					if (!m_Envelope.IsMoving())
+						m_Envelope.SetLevel(0.0f);
+					m_Envelope.Fade(UAUDIO_MAX_VOLUME, length, curve);
+					break;
+				}
+				case ENVELOPE_COMMAND_RELEASE:
+				{
+					m_Envelope.Release(length, curve);
+					break;
+				}
+			}
+		}
+		m_EnvelopeMoving = m_Envelope.IsMoving();
+	}
+
+	/// <summary>
+	/// Returns the meter of the channel (only for the audio thread).
+	/// </summary>
+	/// <returns>The meter.</returns>
+	const effects::Meter &XAudio2Channel::GetMeter() const
+	{
+		return m_Meter;
+	}
+
+	/// <summary>
+	/// Returns the latest levels of the channel without waiting on the audio thread (for one thread, such as the UI).
+	/// </summary>
+	/// <returns>The readings.</returns>
+	effects::MeterReadings XAudio2Channel::ReadMeter()
+	{
+		return m_Meter.Read();
+	}
+
 	/// <summary>
 	/// Applies all the effects.
 	/// </summary>
 	/// <param name="a_DataBuffer">The pcm data that needs to be processed.</param>
 	/// <param name="a_BufferSize">The size of the pcm data block.</param>
 	/// <returns></returns>
-	void XAudio2Channel::ApplyEffects(unsigned char *&a_DataBuffer, uint32_t a_BufferSize) const
+	void XAudio2Channel::ApplyEffects(unsigned char *&a_DataBuffer, uint32_t a_BufferSize)
 	{
-		const FMT_Chunk fmt_chunk = m_CurrentSound->GetWaveFormat().GetChunkFromData<FMT_Chunk>(FMT_CHUNK_ID);
+		const FMT_Chunk &fmt_chunk = m_CurrentSound->GetFmtChunk();
+
+		// Master volume, channel volume and sound volume (not sure why you would want this but I want it in here damn it).
+		float volume = utils::clamp(m_AudioSystem->GetMasterVolume(), UAUDIO_MIN_VOLUME, UAUDIO_MAX_VOLUME);
+		volume *= utils::clamp(m_Volume, UAUDIO_MIN_VOLUME, UAUDIO_MAX_VOLUME);
+		volume *= utils::clamp(m_CurrentSound->GetVolume(), UAUDIO_MIN_VOLUME, UAUDIO_MAX_VOLUME);
+
+		// The loudness normalization of the sound (measured at load, it can go above the maximum volume).
+		volume *= m_CurrentSound->GetNormalizationGain();
+
+		// Inactive channels keep streaming, but silently.
+		if (!m_Active)
+			volume = 0.0f;
+
+		// Master panning and channel panning on the speakers on the left and the right (mono sounds and center speakers do not get panned).
+		const uint16_t num_channels = std::min<uint16_t>(fmt_chunk.numChannels, UAUDIO_MAX_SPEAKERS);
+		float gains[UAUDIO_MAX_SPEAKERS];
+		std::fill(gains, gains + num_channels, volume);
+		if (fmt_chunk.numChannels != WAVE_CHANNELS_MONO)
+		{
+			float master_left, master_right, left, right;
+			effects::GetPanningVolumes(m_AudioSystem->GetMasterPanning(), master_left, master_right);
+			effects::GetPanningVolumes(m_Panning, left, right);
+
+			const uint32_t channel_mask = m_CurrentSound->GetWaveFormat().GetChannelMask();
+			for (uint16_t i = 0; i < num_channels; i++)
+			{
+				const uint32_t speaker = conversion::GetChannelSpeaker(channel_mask, i);
+				if (speaker & WAVE_SPEAKERS_LEFT)
+					gains[i] *= master_left * left;
+				else if (speaker & WAVE_SPEAKERS_RIGHT)
+					gains[i] *= master_right * right;
+			}
+		}
 
-		// Master volume.
-		effects::ChangeVolume<int16_t>(a_DataBuffer, a_BufferSize, m_AudioSystem->GetMasterVolume(), fmt_chunk.blockAlign, fmt_chunk.numChannels);
+		// The envelope moves every frame.
+		float envelope = m_Envelope.GetLevel();
 
-		// Channel volume.
-		effects::ChangeVolume<int16_t>(a_DataBuffer, a_BufferSize, m_Volume, fmt_chunk.blockAlign, fmt_chunk.numChannels);
+		// The ducking gain of the bus ramps from the last buffer to this one.
+		Ducker &ducker = m_AudioSystem->GetDucker();
+		const bool is_key = ducker.IsKey(m_Bus);
+		float duck = m_DuckGain;
+		m_DuckGain = ducker.GetGain(m_Bus);
+
+		// Nothing changes, so the data does not have to be quantized again (the key bus, the meter and the analyzer still need the samples).
+		const bool metering = m_AudioSystem->IsMetering();
+		Analyzer &analyzer = m_AudioSystem->GetAnalyzer();
+		const bool analyzing = analyzer.IsTapped(m_Bus);
+		const bool unchanged = !m_Envelope.IsMoving() && envelope == UAUDIO_MAX_VOLUME && duck == UAUDIO_MAX_VOLUME && m_DuckGain == UAUDIO_MAX_VOLUME && std::all_of(gains, gains + num_channels, [](float a_Gain) { return a_Gain == UAUDIO_MAX_VOLUME; });
+		if (unchanged && !is_key && !metering && !analyzing)
+			return;
+
+		const uint32_t num_frames = a_BufferSize / fmt_chunk.blockAlign;
+		const float duck_step = num_frames > 0 ? (m_DuckGain - duck) / static_cast<float>(num_frames) : 0.0f;
+		float peak = 0.0f;
+
+		// All gains are applied in one pass on floats, so the data only gets rounded (and dithered) once.
+		const uint16_t bytes_per_sample = fmt_chunk.bitsPerSample / 8;
+		const uint32_t num_samples = a_BufferSize / bytes_per_sample;
+		float samples[EFFECTS_BLOCK_SAMPLES];
+		uint16_t channel = 0;
+		for (uint32_t i = 0; i < num_samples; i += EFFECTS_BLOCK_SAMPLES)
+		{
+			const uint32_t count = std::min(EFFECTS_BLOCK_SAMPLES, num_samples - i);
+			unsigned char *data = a_DataBuffer + i * bytes_per_sample;
+			conversion::ReadSamples(samples, data, count, fmt_chunk.bitsPerSample);
+			for (uint32_t j = 0; j < count; j++)
+			{
+				samples[j] *= (channel < num_channels ? gains[channel] : volume) * envelope * duck;
+				peak = std::max(peak, std::fabs(samples[j]));
+				if (++channel == fmt_chunk.numChannels)
+				{
+					channel = 0;
+					envelope = m_Envelope.Next();
+					duck += duck_step;
+				}
+			}
+			if (metering)
+				m_Meter.Process(samples, count);
+			if (analyzing)
+				analyzer.Write(samples, count, i, fmt_chunk.numChannels);
+			if (!unchanged)
+				m_Ditherer.Quantize(data, samples, count, fmt_chunk.bitsPerSample);
+		}
+
+		// The peak is the key for as long as the buffer plays.
+		if (is_key)
+		{
+			const uint32_t sample_rate = m_Resampler.IsActive() ? m_AudioSystem->GetSampleRate() : fmt_chunk.sampleRate;
+			ducker.AddKey(m_Bus, peak, static_cast<float>(num_frames) / static_cast<float>(sample_rate));
+		}
+	}
+
+	/// <summary>
+	/// Applies the last update of the emitter to the source voice (speaker volumes and doppler).
+	/// </summary>
+	void XAudio2Channel::ApplySpatialization()
+	{
+		if (!m_Emitter.IsValid() || m_SourceVoice == nullptr)
+			return;
+
+		const Spatializer &spatializer = m_AudioSystem->GetSpatializer();
+		const FMT_Chunk &fmt_chunk = m_CurrentSound->GetFmtChunk();
+		const uint16_t num_inputs = std::min<uint16_t>(fmt_chunk.numChannels, UAUDIO_MAX_SPEAKERS);
+		const uint16_t num_outputs = std::min<uint16_t>(m_AudioSystem->GetNumChannels(), UAUDIO_MAX_SPEAKERS);
+
+		float speaker_volumes[UAUDIO_MAX_SPEAKERS];
+		spatializer.GetSpeakerVolumes(m_Emitter, num_outputs, speaker_volumes);
+
+		// 3D sounds should be mono. Sounds with more channels get downmixed to the position of the emitter.
+		float matrix[UAUDIO_MAX_SPEAKERS * UAUDIO_MAX_SPEAKERS];
+		for (uint16_t output = 0; output < num_outputs; output++)
+			for (uint16_t input = 0; input < num_inputs; input++)
+				matrix[output * num_inputs + input] = speaker_volumes[output] / num_inputs;
+
+		m_SourceVoice->SetOutputMatrix(nullptr, num_inputs, num_outputs, matrix);
+		m_SourceVoice->SetFrequencyRatio(spatializer.GetPitch(m_Emitter));
+	}
+
+	/// <summary>
+	/// Sets the output matrix and the frequency ratio back to how they were without an emitter.
+	/// </summary>
+	void XAudio2Channel::ResetOutputMatrix()
+	{
+		if (m_SourceVoice == nullptr || m_CurrentSound == nullptr)
+			return;
 
-		// Sound volume (not sure why you would want this but I want it in here damn it)
-		effects::ChangeVolume<int16_t>(a_DataBuffer, a_BufferSize, m_CurrentSound->GetVolume(), fmt_chunk.blockAlign, fmt_chunk.numChannels);
+		const FMT_Chunk &fmt_chunk = m_CurrentSound->GetFmtChunk();
+		const uint16_t num_inputs = std::min<uint16_t>(fmt_chunk.numChannels, UAUDIO_MAX_SPEAKERS);
+		const uint16_t num_outputs = std::min<uint16_t>(m_AudioSystem->GetNumChannels(), UAUDIO_MAX_SPEAKERS);
 
-		// Master panning.
-		effects::ChangePanning<int16_t>(a_DataBuffer, a_BufferSize, m_AudioSystem->GetMasterPanning(), fmt_chunk.numChannels);
+		// Every channel goes to its own speaker, speakers that the output does not have get mixed into the nearest ones.
+		// This is not normalized, the volume of the sound stays the same on every speaker layout.
+		float matrix[UAUDIO_MAX_SPEAKERS * UAUDIO_MAX_SPEAKERS];
+		conversion::CalculateMixMatrix(matrix, m_CurrentSound->GetWaveFormat().GetChannelMask(), num_inputs, m_AudioSystem->GetChannelMask(), num_outputs, false);
 
-		//// Channel panning.
-		effects::ChangePanning<int16_t>(a_DataBuffer, a_BufferSize, m_Panning, fmt_chunk.numChannels);
+		m_SourceVoice->SetOutputMatrix(nullptr, num_inputs, num_outputs, matrix);
+		m_SourceVoice->SetFrequencyRatio(1.0f);
 	}
 
 	/// <summary>
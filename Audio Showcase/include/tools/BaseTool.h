@@ -4,6 +4,8 @@
 
 #include <imgui/imgui.h>
 
+#include <uaudio/wave/low_level/WaveMeter.h>
+
 // https://github.com/juliettef/IconFontCppHeaders/blob/main/IconsFontAwesome4.h
 
 #define PLAY "\xef\x81\x8b"
@@ -29,10 +31,14 @@
 #define SUN "\xef\x86\x85"
 #define RIGHT "\xef\x81\xa1"
 #define LEFT "\xef\x81\xa0"
+#define SIGN_OUT "\xef\x82\x8b"
 #define SAVE "\xef\x83\x87"
 
 #define IMGUI_INDENT 16.0f
 
+// The lowest level that the meters show (in dB).
+#define METER_RANGE -60.0f
+
 class BaseTool
 {
 public:
@@ -41,6 +47,7 @@ public:
 
 	static float GetRGBColor(int color);
 	void ShowValue(const char* a_Text, const char* a_Value);
+	void ShowMeter(const uaudio::effects::MeterReadings &a_Readings);
 	virtual void WindowBegin();
 	virtual void WindowEnd();
 	void Update();
@@ -61,10 +61,36 @@ private:
 		uaudio::WAVE_BITS_PER_SAMPLE_32,
 	};
 
-	std::array<const char*, 3> m_ChannelsTextOptions = {
+	std::array<const char*, 4> m_SampleRateTextOptions = {
+		"I don't really care",
+		"44100 Hz",
+		"48000 Hz",
+		"96000 Hz",
+	};
+
+	std::array<uint32_t, 4> m_SampleRateOptions = {
+		0,
+		uaudio::WAVE_SAMPLE_RATE_44100,
+		uaudio::WAVE_SAMPLE_RATE_48000,
+		uaudio::WAVE_SAMPLE_RATE_96000,
+	};
+
+	std::array<const char*, 6> m_ChannelsTextOptions = {
 		"I don't really care",
 		"Mono",
-		"Stereo"
+		"Stereo",
+		"Quad",
+		"5.1",
+		"7.1"
+	};
+
+	std::array<uint16_t, 6> m_ChannelsOptions = {
+		0,
+		uaudio::WAVE_CHANNELS_MONO,
+		uaudio::WAVE_CHANNELS_STEREO,
+		uaudio::WAVE_CHANNELS_QUAD,
+		uaudio::WAVE_CHANNELS_5_1,
+		uaudio::WAVE_CHANNELS_7_1,
 	};
 
 	std::array<const char*, 4> m_LoopPointTextOptions = {
@@ -74,10 +100,24 @@ private:
 		"Load Start & End Point"
 	};
 
+	std::array<const char*, 3> m_DitherTextOptions = {
+		"None",
+		"TPDF",
+		"TPDF + Noise Shaping"
+	};
+
 	uaudio::WaveConfig m_WaveConfig;
 
 	std::vector<chunk_select> m_ChunkIds;
 	chunk_select m_SelectedChunk = { "", false, true };
 
+	uint32_t m_SelectedChannels = 0;
 	uint32_t m_SelectedBitsPerSample = 0;
+	uint32_t m_SelectedSampleRate = 0;
+
+	// Whether opened files get loaded by the workers of the sound system.
+	bool m_LoadAsync = false;
+
+	// The buses that the UI shows (ducking targets and meters).
+	uint32_t m_NumBuses = 8;
 };
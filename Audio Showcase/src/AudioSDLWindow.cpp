@@ -163,6 +163,7 @@ void AudioSDLWindow::RenderWindow()
 		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplSDL2_NewFrame(m_Window);
 		m_AudioSystem.UpdateNonExtraThread();
+		m_SoundSystem.Update();
 		m_AudioWindow->Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
@@ -3,6 +3,9 @@
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
 
+#include <algorithm>
+#include <string>
+
 BaseTool::BaseTool(ImGuiWindowFlags a_Flags, std::string a_Name, std::string a_Category, bool a_FullScreen) : m_Flags(a_Flags), m_Name(a_Name), m_Category(a_Category), m_FullScreen(a_FullScreen)
 { }
 
@@ -21,6 +24,21 @@ void BaseTool::ShowValue(const char* a_Text, const char* a_Value)
     ImGui::TextColored(color, "%s\n", a_Value);
 }
 
+void BaseTool::ShowMeter(const uaudio::effects::MeterReadings &a_Readings)
+{
+    // A bar per channel with the peak, the RMS in the text.
+    for (uint16_t i = 0; i < a_Readings.numChannels; i++)
+    {
+        const float peak = uaudio::effects::GetDecibels(a_Readings.peak[i]);
+        const float rms = uaudio::effects::GetDecibels(a_Readings.rms[i]);
+        const float fraction = std::clamp(1.0f - peak / METER_RANGE, 0.0f, 1.0f);
+        const std::string text = std::to_string(i) + ": " + (peak > METER_RANGE ? std::to_string(static_cast<int>(peak)) : "-inf") + " dB peak, " + (rms > METER_RANGE ? std::to_string(static_cast<int>(rms)) : "-inf") + " dB RMS";
+        ImGui::ProgressBar(fraction, ImVec2(-1, 0), text.c_str());
+    }
+
+    ImGui::Text("Momentary: %.1f LUFS, short-term: %.1f LUFS", a_Readings.momentary, a_Readings.shortTerm);
+}
+
 void BaseTool::WindowBegin()
 {
     ImGui::Begin(m_Name.c_str(), 0, m_Flags);
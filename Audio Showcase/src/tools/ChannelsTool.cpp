@@ -2,6 +2,8 @@
 
 #include <uaudio/wave/high_level/WaveFile.h>
 
+#include <algorithm>
+
 #include <imgui/imgui.h>
 #include <imgui/imgui_helpers.h>
 
@@ -44,6 +46,13 @@ void ChannelsTool::RenderChannel(uint32_t a_Index, uaudio::xaudio2::XAudio2Chann
     if (ImGui::Knob(volume_text.c_str(), &volume, 0, 1, ImVec2(25, 25), volume_tooltip_text.c_str(), 1.0f))
         a_Channel->SetVolume(volume);
 
+    ImGui::SameLine();
+    float tempo = a_Channel->GetTempo();
+    std::string tempo_tooltip_text = std::string(CLOCK) + " Tempo (affects channel " + std::to_string(a_Index) + ")";
+    std::string tempo_text = "##Tempo_Channel_" + std::to_string(a_Index);
+    if (ImGui::Knob(tempo_text.c_str(), &tempo, UAUDIO_MIN_TEMPO, UAUDIO_MAX_TEMPO, ImVec2(25, 25), tempo_tooltip_text.c_str(), 1.0f))
+        a_Channel->SetTempo(tempo);
+
     int32_t pos = static_cast<int32_t>(a_Channel->GetPos(uaudio::TIMEUNIT::TIMEUNIT_POS));
     float final_pos = uaudio::utils::PosToSeconds(a_Channel->GetSound().GetEndPosition(), fmt_chunk.byteRate);
     ImGui::Text("%s", std::string(
@@ -112,6 +121,28 @@ void ChannelsTool::RenderChannel(uint32_t a_Index, uaudio::xaudio2::XAudio2Chann
     if (ImGui::CheckboxButton(loop_button_text.c_str(), &isLooping, ImVec2(25, 25)))
         a_Channel->SetLooping(isLooping);
 
+    ImGui::SameLine();
+    float loop_crossfade = a_Channel->GetLoopCrossfade();
+    std::string loop_crossfade_tooltip_text = std::string(RETRY) + " Loop crossfade in ms (affects channel " + std::to_string(a_Index) + ")";
+    std::string loop_crossfade_text = "##Loop_Crossfade_Channel_" + std::to_string(a_Index);
+    if (ImGui::Knob(loop_crossfade_text.c_str(), &loop_crossfade, 0, 100, ImVec2(25, 25), loop_crossfade_tooltip_text.c_str(), 0.0f))
+        a_Channel->SetLoopCrossfade(loop_crossfade);
+
+    ImGui::SameLine();
+    std::string release_button_text = std::string(SIGN_OUT) + "##Release_Channel_" + std::to_string(a_Index);
+    if (ImGui::Button(release_button_text.c_str(), ImVec2(25, 25)))
+        a_Channel->Release();
+
+    ImGui::SameLine();
+    int bus = static_cast<int>(a_Channel->GetBus());
+    std::string bus_text = "Bus##Bus_Channel_" + std::to_string(a_Index);
+    ImGui::SetNextItemWidth(75);
+    if (ImGui::InputInt(bus_text.c_str(), &bus))
+        a_Channel->SetBus(static_cast<uint32_t>(std::max(bus, 0)));
+
+    if (m_AudioSystem.IsMetering())
+        ShowMeter(a_Channel->ReadMeter());
+
     if (a_Channel->IsInUse())
     {
         std::string channel_name_text = "Channel " + std::to_string(a_Index) + " (" + std::string(a_Channel->GetSound().GetWaveFormat().m_FilePath) + ")" + "##Channel_" + std::to_string(a_Index);
@@ -132,6 +163,8 @@ void ChannelsTool::RenderChannel(uint32_t a_Index, uaudio::xaudio2::XAudio2Chann
                                                    "/" +
                                                    std::to_string(a_Channel->GetSound().GetEndPosition()))
                                                    .c_str());
+            if (a_Channel->IsStreaming())
+                ShowValue("Stream underruns: ", std::to_string(a_Channel->GetStreamUnderruns()).c_str());
             ImGui::Unindent(IMGUI_INDENT);
         }
     }
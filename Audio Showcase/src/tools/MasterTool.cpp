@@ -2,6 +2,9 @@
 
 #include "uaudio/wave/high_level/WaveFile.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <imgui/imgui.h>
 #include <imgui/imgui_stdlib.h>
 #include <imgui/imgui_helpers.h>
@@ -58,6 +61,66 @@ void MasterTool::Render()
     if (ImGui::Knob("Volume##Master_Volume", &volume, 0, 1, ImVec2(50, 50), master_volume_text.c_str(), 1.0f))
         m_AudioSystem.SetMasterVolume(volume);
 
+    if (ImGui::CollapsingHeader("Levels"))
+    {
+        ImGui::Indent(IMGUI_INDENT);
+
+        bool metering = m_AudioSystem.IsMetering();
+        if (ImGui::Checkbox("Metering##Metering", &metering))
+            m_AudioSystem.SetMetering(metering);
+
+        if (metering)
+        {
+            ImGui::Text("Master");
+            ShowMeter(m_AudioSystem.ReadMasterMeter());
+
+            // Only the buses that have channels playing on them.
+            for (uint32_t i = 0; i < m_NumBuses; i++)
+            {
+                const uaudio::effects::MeterReadings readings = m_AudioSystem.ReadBusMeter(i);
+                if (readings.numChannels == 0)
+                    continue;
+                ImGui::Text("Bus %u", i);
+                ShowMeter(readings);
+            }
+        }
+
+        ImGui::Unindent(IMGUI_INDENT);
+    }
+
+    if (ImGui::CollapsingHeader("Spectrum"))
+    {
+        ImGui::Indent(IMGUI_INDENT);
+
+        uaudio::Analyzer &analyzer = m_AudioSystem.GetAnalyzer();
+        bool analyzing = analyzer.IsEnabled();
+        if (ImGui::Checkbox("Spectrum analyzer##Analyzer", &analyzing))
+            analyzer.SetEnabled(analyzing);
+
+        // The last option is the master.
+        int bus = static_cast<int>(std::min(analyzer.GetBus(), m_NumBuses));
+        ImGui::Text("Bus (%u is the master)", m_NumBuses);
+        if (ImGui::SliderInt("##Analyzer_Bus", &bus, 0, static_cast<int>(m_NumBuses)))
+            analyzer.SetBus(static_cast<uint32_t>(bus) == m_NumBuses ? uaudio::UAUDIO_MASTER_BUS : static_cast<uint32_t>(bus));
+
+        int spacing = static_cast<int>(analyzer.GetSpacing());
+        ImGui::Text("Bands");
+        if (ImGui::Combo("##Analyzer_Spacing", &spacing, "Linear\0Log\0"))
+            analyzer.SetBands(analyzer.GetNumBands(), static_cast<uaudio::BAND_SPACING>(spacing));
+
+        if (analyzing)
+        {
+            // The bands are in dB, the histogram starts at the floor.
+            const uaudio::SpectrumReadings readings = analyzer.Read();
+            float bands[UAUDIO_MAX_BANDS];
+            for (uint32_t i = 0; i < readings.numBands; i++)
+                bands[i] = readings.bands[i] - UAUDIO_ANALYZER_FLOOR;
+            ImGui::PlotHistogram("##Analyzer_Bands", bands, static_cast<int>(readings.numBands), 0, nullptr, 0.0f, -UAUDIO_ANALYZER_FLOOR, ImVec2(-1, 100));
+        }
+
+        ImGui::Unindent(IMGUI_INDENT);
+    }
+
     const std::string buffer_size_text = "Buffer Size";
     ImGui::Text("%s", buffer_size_text.c_str());
     if (ImGui::BeginCombo("##Buffer_Size", std::string(m_BufferSizeSelection == -1 ? "CHOOSE BUFFER SIZE" : m_BufferSizeTextOptions[m_BufferSizeSelection]).c_str(), ImGuiComboFlags_PopupAlignLeft))
@@ -82,15 +145,15 @@ void MasterTool::Render()
     {
         ImGui::Indent(IMGUI_INDENT);
 
-        const std::string channels_text = "Channels (stereo or mono)";
+        const std::string channels_text = "Channels (speaker layout)";
         ImGui::Text("%s", channels_text.c_str());
-        if (ImGui::BeginCombo("##Stereo_Or_Mono", m_ChannelsTextOptions[m_WaveConfig.numChannels], ImGuiComboFlags_PopupAlignLeft))
+        if (ImGui::BeginCombo("##Channels", m_ChannelsTextOptions[m_SelectedChannels], ImGuiComboFlags_PopupAlignLeft))
         {
             for (uint32_t n = 0; n < static_cast<uint32_t>(m_ChannelsTextOptions.size()); n++)
             {
-                const bool is_selected = n == m_WaveConfig.numChannels;
+                const bool is_selected = n == m_SelectedChannels;
                 if (ImGui::Selectable(m_ChannelsTextOptions[n], is_selected))
-                    m_WaveConfig.numChannels = static_cast<uint16_t>(n);
+                    m_SelectedChannels = n;
             }
             ImGui::EndCombo();
         }
@@ -108,6 +171,36 @@ void MasterTool::Render()
             ImGui::EndCombo();
         }
 
+        const std::string sample_rate_text = "Sample rate";
+        ImGui::Text("%s", sample_rate_text.c_str());
+        if (ImGui::BeginCombo("##Sample_Rate", m_SampleRateTextOptions[m_SelectedSampleRate], ImGuiComboFlags_PopupAlignLeft))
+        {
+            for (uint16_t n = 0; n < static_cast<uint16_t>(m_SampleRateOptions.size()); n++)
+            {
+                const bool is_selected = n == m_SelectedSampleRate;
+                if (ImGui::Selectable(m_SampleRateTextOptions[n], is_selected))
+                    m_SelectedSampleRate = n;
+            }
+            ImGui::EndCombo();
+        }
+
+        const std::string tempo_text = "Tempo (the pitch stays the same)";
+        ImGui::Text("%s", tempo_text.c_str());
+        ImGui::SliderFloat("##Tempo", &m_WaveConfig.tempo, UAUDIO_MIN_TEMPO, UAUDIO_MAX_TEMPO, "%.2fx");
+
+        const std::string dither_text = "Dither (when the bits per sample go down)";
+        ImGui::Text("%s", dither_text.c_str());
+        if (ImGui::BeginCombo("##Dither", m_DitherTextOptions[static_cast<int>(m_WaveConfig.dither)], ImGuiComboFlags_PopupAlignLeft))
+        {
+            for (uint16_t n = 0; n < static_cast<uint16_t>(m_DitherTextOptions.size()); n++)
+            {
+                const bool is_selected = n == static_cast<int>(m_WaveConfig.dither);
+                if (ImGui::Selectable(m_DitherTextOptions[n], is_selected))
+                    m_WaveConfig.dither = static_cast<uaudio::DITHER>(n);
+            }
+            ImGui::EndCombo();
+        }
+
         const std::string loop_poins_text = "Loop Points";
         ImGui::Text("%s", loop_poins_text.c_str());
         if (ImGui::BeginCombo("##Loop_Points", m_LoopPointTextOptions[static_cast<int>(m_WaveConfig.setLoopPoints)], ImGuiComboFlags_PopupAlignLeft))
@@ -121,6 +214,27 @@ void MasterTool::Render()
             ImGui::EndCombo();
         }
 
+        ImGui::Checkbox("Trim Silence", &m_WaveConfig.trimSilence);
+        if (m_WaveConfig.trimSilence)
+        {
+            ImGui::SameLine();
+            ImGui::Checkbox("Release Trimmed Memory", &m_WaveConfig.releaseTrimmedMemory);
+            ImGui::SliderFloat("##Silence_Threshold", &m_WaveConfig.silenceThreshold, -96.0f, 0.0f, "%.1f dB");
+        }
+
+        ImGui::Checkbox("Normalize Loudness", &m_WaveConfig.normalize);
+        if (m_WaveConfig.normalize)
+        {
+            ImGui::SliderFloat("##Target_Loudness", &m_WaveConfig.targetLoudness, -40.0f, -6.0f, "%.1f LUFS");
+            ImGui::SliderFloat("##Max_True_Peak", &m_WaveConfig.maxTruePeak, -12.0f, 0.0f, "%.1f dBTP");
+        }
+
+        ImGui::Checkbox("Memory Map", &m_WaveConfig.memoryMap);
+        ImGui::SameLine();
+        ImGui::Checkbox("Stream From Disk", &m_WaveConfig.stream);
+        ImGui::SameLine();
+        ImGui::Checkbox("Load In Background", &m_LoadAsync);
+
         ImGui::Text("%s", "Selected Chunks");
         for (uint32_t i = 0; i < m_ChunkIds.size(); i++)
         {
@@ -160,6 +274,63 @@ void MasterTool::Render()
         }
         ImGui::Unindent(IMGUI_INDENT);
     }
+
+    if (ImGui::CollapsingHeader("Ducking"))
+    {
+        ImGui::Indent(IMGUI_INDENT);
+
+        uaudio::Ducker &ducker = m_AudioSystem.GetDucker();
+        bool ducking = ducker.IsEnabled();
+        if (ImGui::Checkbox("Duck the target buses when the key bus plays##Ducking", &ducking))
+            ducker.SetEnabled(ducking);
+
+        uaudio::DuckerSettings settings = ducker.GetSettings();
+        bool changed = false;
+
+        int key_bus = static_cast<int>(settings.keyBus);
+        ImGui::Text("Key bus");
+        if (ImGui::SliderInt("##Ducking_Key_Bus", &key_bus, 0, static_cast<int>(uaudio::UAUDIO_MAX_BUSES - 1)))
+        {
+            settings.keyBus = static_cast<uint32_t>(key_bus);
+            changed = true;
+        }
+
+        ImGui::Text("Target buses");
+        for (uint32_t i = 0; i < m_NumBuses; i++)
+        {
+            if (i > 0)
+                ImGui::SameLine();
+            bool target = (settings.targetBuses & (1u << i)) != 0;
+            const std::string target_text = std::to_string(i) + "##Ducking_Target_" + std::to_string(i);
+            if (ImGui::Checkbox(target_text.c_str(), &target))
+            {
+                settings.targetBuses = target ? settings.targetBuses | (1u << i) : settings.targetBuses & ~(1u << i);
+                changed = true;
+            }
+        }
+
+        ImGui::Text("Threshold");
+        changed |= ImGui::SliderFloat("##Ducking_Threshold", &settings.threshold, -60.0f, 0.0f, "%.1f dB");
+        ImGui::Text("Depth");
+        changed |= ImGui::SliderFloat("##Ducking_Depth", &settings.depth, -40.0f, 0.0f, "%.1f dB");
+        ImGui::Text("Attack");
+        changed |= ImGui::SliderFloat("##Ducking_Attack", &settings.attack, 0.0f, 500.0f, "%.0f ms");
+        ImGui::Text("Release");
+        changed |= ImGui::SliderFloat("##Ducking_Release", &settings.release, 0.0f, 2000.0f, "%.0f ms");
+        ImGui::Text("Hold");
+        changed |= ImGui::SliderFloat("##Ducking_Hold", &settings.hold, 0.0f, 2000.0f, "%.0f ms");
+
+        if (changed)
+            ducker.SetSettings(settings);
+
+        // The reduction gets updated on the audio thread.
+        const float reduction = ducker.GetReduction();
+        const std::string reduction_text = std::to_string(static_cast<int>(std::round(reduction))) + " dB";
+        ImGui::Text("Gain reduction");
+        ImGui::ProgressBar(settings.depth < 0.0f ? reduction / settings.depth : 0.0f, ImVec2(-1, 0), reduction_text.c_str());
+
+        ImGui::Unindent(IMGUI_INDENT);
+    }
 }
 
 /// <summary>
@@ -192,8 +363,13 @@ void MasterTool::OpenFile()
                 chunks.push_back(chunk.chunk_id.c_str());
 
         m_WaveConfig.chunksToLoad = chunks;
+        m_WaveConfig.numChannels = m_ChannelsOptions[m_SelectedChannels];
         m_WaveConfig.bitsPerSample = m_BitsPerSampleOptions[m_SelectedBitsPerSample];
-        uaudio::UAUDIO_DEFAULT_HASH hash = m_SoundSystem.LoadSound(path, path, m_WaveConfig);
+        m_WaveConfig.sampleRate = m_SampleRateOptions[m_SelectedSampleRate];
+        if (m_LoadAsync)
+            m_SoundSystem.LoadSoundAsync(path, path, m_WaveConfig);
+        else
+            m_SoundSystem.LoadSound(path, path, m_WaveConfig);
         delete[] path;
     }
 }
\ No newline at end of file
@@ -59,6 +59,12 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
 
     const uaudio::FMT_Chunk fmt_chunk = a_WaveFile->GetWaveFormat().GetChunkFromData<uaudio::FMT_Chunk>(uaudio::FMT_CHUNK_ID);
 
+    if (a_WaveFile->HasLoudness())
+    {
+        const uaudio::effects::LoudnessMeasurement &loudness = a_WaveFile->GetLoudness();
+        ImGui::Text("Loudness: %.1f LUFS, range %.1f LU, true peak %.1f dBTP, gain %+.1f dB", loudness.integrated, loudness.range, loudness.truePeak, uaudio::effects::GetDecibels(a_WaveFile->GetNormalizationGain()));
+    }
+
     const std::string loop_options_text = "Loop Options##Loop_Options_Sound_" + std::to_string(a_SoundHash);
     if (ImGui::CollapsingHeader(loop_options_text.c_str()))
     {
@@ -72,7 +78,7 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
                               .c_str());
         const uint32_t start_position_temp = static_cast<uint32_t>(start_position), end_position_temp = static_cast<uint32_t>(end_position);
         std::string range_slider_sound_name_text = "##Range_Slider_Sound_" + std::to_string(a_SoundHash);
-        if (ImGui::RangeSliderFloat(range_slider_sound_name_text.c_str(), &start_position, &end_position, 0.0f, static_cast<float>(a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID)), ""))
+        if (ImGui::RangeSliderFloat(range_slider_sound_name_text.c_str(), &start_position, &end_position, 0.0f, static_cast<float>(a_WaveFile->GetWaveFormat().GetDataSize()), ""))
         {
             const uint32_t start_position_int = static_cast<uint32_t>(start_position);
             const uint32_t end_position_int = static_cast<uint32_t>(end_position);
@@ -81,7 +87,7 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
             {
                 uint32_t new_start_position = start_position_int % static_cast<int>(m_AudioSystem.GetBufferSize());
                 new_start_position = start_position_int - new_start_position;
-                new_start_position = uaudio::utils::clamp<uint32_t>(new_start_position, 0, a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
+                new_start_position = uaudio::utils::clamp<uint32_t>(new_start_position, 0, a_WaveFile->GetWaveFormat().GetDataSize());
                 m_Channel.PlayRanged(new_start_position, static_cast<int>(m_AudioSystem.GetBufferSize()));
                 a_WaveFile->SetStartPosition(new_start_position);
             }
@@ -89,8 +95,8 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
             {
                 uint32_t new_end_position = end_position_int % static_cast<int>(m_AudioSystem.GetBufferSize());
                 new_end_position = end_position_int - new_end_position;
-                new_end_position = uaudio::utils::clamp<uint32_t>(new_end_position, 0, a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
-                a_WaveFile->SetEndPosition(a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
+                new_end_position = uaudio::utils::clamp<uint32_t>(new_end_position, 0, a_WaveFile->GetWaveFormat().GetDataSize());
+                a_WaveFile->SetEndPosition(a_WaveFile->GetWaveFormat().GetDataSize());
                 m_Channel.PlayRanged(new_end_position, static_cast<int>(m_AudioSystem.GetBufferSize()));
                 a_WaveFile->SetEndPosition(new_end_position);
             }
@@ -101,7 +107,7 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
         if (ImGui::Button(left_button_start_text.c_str(), ImVec2(25, 25)))
         {
             int32_t new_start_position = start_position_int - static_cast<int>(m_AudioSystem.GetBufferSize());
-            new_start_position = uaudio::utils::clamp<int32_t>(new_start_position, 0, a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
+            new_start_position = uaudio::utils::clamp<int32_t>(new_start_position, 0, a_WaveFile->GetWaveFormat().GetDataSize());
             m_Channel.SetSound(*a_WaveFile);
             m_Channel.PlayRanged(new_start_position, static_cast<int>(m_AudioSystem.GetBufferSize()));
             a_WaveFile->SetStartPosition(new_start_position);
@@ -112,7 +118,7 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
         if (ImGui::Button(right_button_start_text.c_str(), ImVec2(25, 25)))
         {
             uint32_t new_start_position = start_position_int + static_cast<int>(m_AudioSystem.GetBufferSize());
-            new_start_position = uaudio::utils::clamp<uint32_t>(new_start_position, 0, a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
+            new_start_position = uaudio::utils::clamp<uint32_t>(new_start_position, 0, a_WaveFile->GetWaveFormat().GetDataSize());
             m_Channel.SetSound(*a_WaveFile);
             m_Channel.PlayRanged(new_start_position, static_cast<int>(m_AudioSystem.GetBufferSize()));
             a_WaveFile->SetStartPosition(new_start_position);
@@ -123,7 +129,7 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
         if (ImGui::Button(left_button_end_text.c_str(), ImVec2(25, 25)))
         {
             int32_t new_end_position = end_position_int - static_cast<int>(m_AudioSystem.GetBufferSize());
-            new_end_position = uaudio::utils::clamp<int32_t>(new_end_position, 0, a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
+            new_end_position = uaudio::utils::clamp<int32_t>(new_end_position, 0, a_WaveFile->GetWaveFormat().GetDataSize());
             m_Channel.SetSound(*a_WaveFile);
             m_Channel.PlayRanged(new_end_position, static_cast<int>(m_AudioSystem.GetBufferSize()));
             a_WaveFile->SetEndPosition(new_end_position);
@@ -134,33 +140,28 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
         if (ImGui::Button(right_button_end_text.c_str(), ImVec2(25, 25)))
         {
             uint32_t new_end_position = end_position_int + static_cast<int>(m_AudioSystem.GetBufferSize());
-            new_end_position = uaudio::utils::clamp<uint32_t>(new_end_position, 0, a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
+            new_end_position = uaudio::utils::clamp<uint32_t>(new_end_position, 0, a_WaveFile->GetWaveFormat().GetDataSize());
             m_Channel.SetSound(*a_WaveFile);
-            a_WaveFile->SetEndPosition(a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID));
+            a_WaveFile->SetEndPosition(a_WaveFile->GetWaveFormat().GetDataSize());
             m_Channel.PlayRanged(new_end_position, static_cast<int>(m_AudioSystem.GetBufferSize()));
             a_WaveFile->SetEndPosition(new_end_position);
         }
 
-        static int sensitivity = 0;
+        static float silence_threshold = UAUDIO_DEFAULT_SILENCE_THRESHOLD;
         std::string silence_detect_text = "Silence Detection##Silence_Detection_" + std::to_string(a_SoundHash);
         if (ImGui::Button(silence_detect_text.c_str()))
         {
-            uaudio::DATA_Chunk data_chunk = a_WaveFile->GetWaveFormat().GetChunkFromData<uaudio::DATA_Chunk>(uaudio::DATA_CHUNK_ID);
-            uint32_t pos = a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID);
-            for (int32_t i = a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID) - 1; i > -1; i--)
+            uint32_t start_position = 0, end_position = 0;
+            if (a_WaveFile->GetWaveFormat().FindAudibleRange(silence_threshold, start_position, end_position))
             {
-                if (data_chunk.data[i - 1] > sensitivity)
-                {
-                    pos = i;
-                    break;
-                }
+                a_WaveFile->SetStartPosition(start_position);
+                a_WaveFile->SetEndPosition(end_position);
             }
-            a_WaveFile->SetEndPosition(pos);
         }
         ImGui::SameLine();
         ImGui::PushItemWidth(100);
-        std::string silence_detect_sensitivity_text = "Sensitivity##Silence_Detection_Sensitivity_" + std::to_string(a_SoundHash);
-        ImGui::InputInt(silence_detect_sensitivity_text.c_str(), &sensitivity, 1);
+        std::string silence_detect_threshold_text = "Threshold (dB)##Silence_Detection_Threshold_" + std::to_string(a_SoundHash);
+        ImGui::SliderFloat(silence_detect_threshold_text.c_str(), &silence_threshold, -96.0f, 0.0f, "%.1f");
         ImGui::PopItemWidth();
     }
 
@@ -192,7 +193,7 @@ void SoundsTool::RenderSound(uaudio::UAUDIO_DEFAULT_HASH a_SoundHash)
             {
                 ImGui::Indent(IMGUI_INDENT);
                 ShowValue("Chunk ID: ", uaudio::DATA_CHUNK_ID);
-                ShowValue("Chunk Size: ", std::to_string(a_WaveFile->GetWaveFormat().GetChunkSize(uaudio::DATA_CHUNK_ID)).c_str());
+                ShowValue("Chunk Size: ", std::to_string(a_WaveFile->GetWaveFormat().GetDataSize()).c_str());
                 ImGui::Unindent(IMGUI_INDENT);
             }
         }
@@ -379,7 +380,8 @@ void SoundsTool::SaveFile(const uaudio::WaveFile *a_WaveFile)
         const auto path = new char[wcslen(ofn.lpstrFile) + 1];
         wsprintfA(path, "%S", ofn.lpstrFile);
 
-        uaudio::WaveReader::SaveSound(path, a_WaveFile->GetWaveFormat());
+        // Sounds that were measured when they got loaded save their loudness in the bext chunk.
+        uaudio::WaveReader::SaveSound(path, a_WaveFile->GetWaveFormat(), a_WaveFile->HasLoudness() ? &a_WaveFile->GetLoudness() : nullptr);
         delete[] path;
     }
 }
\ No newline at end of file
@@ -1,7 +1,36 @@
-﻿#include <uaudio/wave/low_level/WaveConverter.h>
+﻿#include <uaudio/Analyzer.h>
+#include <uaudio/SoundSystem.h>
+#include <uaudio/Ducker.h>
+#include <uaudio/Spatializer.h>
+#include <uaudio/Streamer.h>
+#include <uaudio/utils/Denormals.h>
+#include <uaudio/utils/FileReader.h>
+#include <uaudio/wave/low_level/WaveChannelMixer.h>
+#include <uaudio/wave/low_level/WaveConversionPlan.h>
+#include <uaudio/wave/low_level/WaveConverter.h>
+#include <uaudio/wave/low_level/WaveDither.h>
+#include <uaudio/wave/low_level/WaveEnvelope.h>
+#include <uaudio/wave/low_level/WaveKernels.h>
+#include <uaudio/wave/low_level/WaveLoop.h>
+#include <uaudio/wave/low_level/WaveLoudness.h>
+#include <uaudio/wave/low_level/WaveMeter.h>
+#include <uaudio/wave/low_level/WaveResampler.h>
+#include <uaudio/wave/low_level/WaveSamples.h>
+#include <uaudio/wave/low_level/WaveSilence.h>
+#include <uaudio/wave/low_level/WaveTimeStretch.h>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <thread>
 #include <vector>
 
+#if defined(__GLIBC__)
+	#include <malloc.h>
+#endif
+
 #include "doctest.h"
 #include <uaudio/utils/Logger.h>
 #include <uaudio/wave/high_level/WaveChunks.h>
@@ -75,6 +104,36 @@ void random_mono_to_stereo(uint16_t block_align)
 	uaudio::logger::log_success("%s[MONO TO STEREO %i-BIT (random)]%s\n", uaudio::logger::COLOR_CYAN, block_align * 8, uaudio::logger::COLOR_WHITE);
 }
 
+void average_samples(unsigned char *out, const unsigned char *left, const unsigned char *right, uint16_t bytes_per_sample)
+{
+	// 32-bit samples are floats.
+	if (bytes_per_sample == sizeof(float))
+	{
+		float l, r;
+		memcpy(&l, left, sizeof(float));
+		memcpy(&r, right, sizeof(float));
+		const float m = l * 0.5f + r * 0.5f;
+		memcpy(out, &m, sizeof(float));
+		return;
+	}
+
+	int32_t l = 0, r = 0;
+	for (uint16_t i = 0; i < bytes_per_sample; i++)
+	{
+		l |= left[i] << (i * 8);
+		r |= right[i] << (i * 8);
+	}
+
+	// Sign extend.
+	const int32_t shift = 32 - bytes_per_sample * 8;
+	l = (l << shift) >> shift;
+	r = (r << shift) >> shift;
+
+	const int32_t m = static_cast<int32_t>(std::lrint((l + r) / 2.0));
+	for (uint16_t i = 0; i < bytes_per_sample; i++)
+		out[i] = static_cast<unsigned char>((m >> (i * 8)) & 0xFF);
+}
+
 void random_stereo_to_mono(uint16_t block_align)
 {
 	uaudio::logger::log_info("%s[STEREO TO MONO %i-BIT (random)]%s", uaudio::logger::COLOR_CYAN, block_align / 2 * 8, uaudio::logger::COLOR_WHITE);
@@ -96,14 +155,12 @@ void random_stereo_to_mono(uint16_t block_align)
 
 	std::vector<unsigned char> EXPECTED(size / 2);
 
+	// The mono channel is the average of the left and right channel.
 	int newIndex = 0;
 	for (uint16_t i = 0; i <= size - block_align; i += block_align)
 	{
-		for (uint16_t j = 0; j < block_align / 2; j++)
-		{
-			EXPECTED[newIndex] = data[i + j];
-			newIndex++;
-		}
+		average_samples(&EXPECTED[newIndex], &data[i], &data[i + block_align / 2], block_align / 2);
+		newIndex += block_align / 2;
 	}
 
 	PRINT_ARRAY("EXPECTED: ", EXPECTED);
@@ -120,6 +177,236 @@ void random_stereo_to_mono(uint16_t block_align)
 	uaudio::logger::log_success("%s[STEREO TO MONO %i-BIT (random)]%s\n", uaudio::logger::COLOR_CYAN, block_align / 2 * 8, uaudio::logger::COLOR_WHITE);
 }
 
+void resample_sine(uint32_t source_rate, uint32_t target_rate)
+{
+	uaudio::logger::log_info("%s[RESAMPLE %i TO %i]%s", uaudio::logger::COLOR_CYAN, source_rate, target_rate, uaudio::logger::COLOR_WHITE);
+
+	constexpr double PI = 3.14159265358979323846;
+	constexpr double FREQUENCY = 1000.0;
+	constexpr double AMPLITUDE = 0.5;
+	const uint16_t block_align = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+
+	// One second of a stereo sine (right channel is inverted).
+	std::vector<int16_t> dat(static_cast<size_t>(source_rate) * 2);
+	for (uint32_t i = 0; i < source_rate; i++)
+	{
+		const double value = AMPLITUDE * sin(2.0 * PI * FREQUENCY * i / source_rate);
+		dat[i * 2] = static_cast<int16_t>(lround(value * 32767.0));
+		dat[i * 2 + 1] = static_cast<int16_t>(lround(-value * 32767.0));
+	}
+
+	uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+	const uint32_t new_size = uaudio::conversion::CalculateResampleSize(size, block_align, source_rate, target_rate);
+	CHECK(new_size == target_rate * block_align);
+
+	std::vector<int16_t> new_data(new_size / sizeof(int16_t));
+	uaudio::conversion::Resample(reinterpret_cast<unsigned char *>(new_data.data()), reinterpret_cast<unsigned char *>(dat.data()), size, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO, source_rate, target_rate);
+	CHECK(size == new_size);
+
+	// Skip the filter edges, everything else should be the same sine at the new rate.
+	double max_error = 0.0;
+	for (uint32_t i = 64; i < target_rate - 64; i++)
+	{
+		const double expected = AMPLITUDE * sin(2.0 * PI * FREQUENCY * i / target_rate);
+		max_error = std::max(max_error, std::abs(new_data[i * 2] / 32767.0 - expected));
+		max_error = std::max(max_error, std::abs(new_data[i * 2 + 1] / 32767.0 + expected));
+	}
+	CHECK(max_error < 0.001);
+
+	uaudio::logger::log_success("%s[RESAMPLE %i TO %i]%s\n", uaudio::logger::COLOR_CYAN, source_rate, target_rate, uaudio::logger::COLOR_WHITE);
+}
+
+void stream_resample_sine(uint32_t source_rate, uint32_t target_rate, uint32_t period_frames)
+{
+	uaudio::logger::log_info("%s[STREAM RESAMPLE %i TO %i]%s", uaudio::logger::COLOR_CYAN, source_rate, target_rate, uaudio::logger::COLOR_WHITE);
+
+	constexpr double PI = 3.14159265358979323846;
+	const uint16_t block_align = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+
+	std::vector<int16_t> dat(static_cast<size_t>(source_rate) * 2);
+	for (uint32_t i = 0; i < source_rate; i++)
+	{
+		const double value = 0.5 * sin(2.0 * PI * 1000.0 * i / source_rate);
+		dat[i * 2] = static_cast<int16_t>(lround(value * 32767.0));
+		dat[i * 2 + 1] = static_cast<int16_t>(lround(-value * 32767.0));
+	}
+
+	uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+	std::vector<int16_t> expected(uaudio::conversion::CalculateResampleSize(size, block_align, source_rate, target_rate) / sizeof(int16_t));
+	uaudio::conversion::Resample(reinterpret_cast<unsigned char *>(expected.data()), reinterpret_cast<unsigned char *>(dat.data()), size, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO, source_rate, target_rate);
+
+	// Feed the same data in small periods, the output should be the same as the load-time conversion (minus the tail the stream holds back).
+	uaudio::conversion::StreamResampler resampler;
+	resampler.Init(source_rate, target_rate, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_BITS_PER_SAMPLE_16, period_frames);
+	CHECK(resampler.IsActive());
+
+	const uint32_t period_size = period_frames * block_align;
+	std::vector<int16_t> result(expected.size() + resampler.GetMaxOutputSize(period_size) / sizeof(int16_t));
+	uint32_t result_size = 0;
+	for (uint32_t pos = 0; pos < dat.size() * sizeof(int16_t); pos += period_size)
+	{
+		const uint32_t step = std::min(period_size, static_cast<uint32_t>(dat.size() * sizeof(int16_t)) - pos);
+		const uint32_t out_size = resampler.Process(reinterpret_cast<unsigned char *>(dat.data()) + pos, step, reinterpret_cast<unsigned char *>(result.data()) + result_size);
+		CHECK(out_size <= resampler.GetMaxOutputSize(step));
+		result_size += out_size;
+	}
+	CHECK(result_size <= expected.size() * sizeof(int16_t));
+	CHECK(result_size >= (expected.size() - 64 * 2) * sizeof(int16_t));
+
+	int max_difference = 0;
+	for (uint32_t i = 0; i < result_size / sizeof(int16_t); i++)
+		max_difference = std::max(max_difference, std::abs(result[i] - expected[i]));
+	CHECK(max_difference <= 1);
+
+	uaudio::logger::log_success("%s[STREAM RESAMPLE %i TO %i]%s\n", uaudio::logger::COLOR_CYAN, source_rate, target_rate, uaudio::logger::COLOR_WHITE);
+}
+
+void time_stretch_sine(float tempo)
+{
+	uaudio::logger::log_info("%s[TIME STRETCH %.2fx]%s", uaudio::logger::COLOR_CYAN, tempo, uaudio::logger::COLOR_WHITE);
+
+	constexpr double PI = 3.14159265358979323846;
+	constexpr double FREQUENCY = 440.0;
+	constexpr double AMPLITUDE = 0.5;
+	const uint32_t sample_rate = uaudio::WAVE_SAMPLE_RATE_48000;
+	const uint16_t block_align = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+
+	std::vector<int16_t> dat(static_cast<size_t>(sample_rate) * 2);
+	for (uint32_t i = 0; i < sample_rate; i++)
+	{
+		const double value = AMPLITUDE * sin(2.0 * PI * FREQUENCY * i / sample_rate);
+		dat[i * 2] = static_cast<int16_t>(lround(value * 32767.0));
+		dat[i * 2 + 1] = static_cast<int16_t>(lround(value * 32767.0));
+	}
+
+	uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+	const uint32_t new_size = uaudio::conversion::CalculateTimeStretchSize(size, block_align, tempo);
+	CHECK(new_size == static_cast<uint32_t>(lround(sample_rate / tempo)) * block_align);
+
+	std::vector<int16_t> new_data(new_size / sizeof(int16_t));
+	uaudio::conversion::TimeStretch(reinterpret_cast<unsigned char *>(new_data.data()), reinterpret_cast<unsigned char *>(dat.data()), size, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO, sample_rate, tempo);
+	CHECK(size == new_size);
+
+	// The pitch (zero crossings) and the level (rms) should stay the same, skipping the edges.
+	const uint32_t frames = new_size / block_align;
+	const uint32_t begin = frames / 10, end = frames - frames / 10;
+	uint32_t crossings = 0;
+	double sum = 0.0;
+	for (uint32_t i = begin; i < end; i++)
+	{
+		if ((new_data[i * 2] < 0) != (new_data[(i + 1) * 2] < 0))
+			crossings++;
+		sum += (new_data[i * 2] / 32767.0) * (new_data[i * 2] / 32767.0);
+	}
+	const double frequency = crossings / 2.0 / (static_cast<double>(end - begin) / sample_rate);
+	const double rms = std::sqrt(sum / (end - begin));
+	CHECK(std::abs(frequency - FREQUENCY) < FREQUENCY * 0.02);
+	CHECK(std::abs(rms - AMPLITUDE / std::sqrt(2.0)) < 0.05);
+
+	uaudio::logger::log_success("%s[TIME STRETCH %.2fx]%s\n", uaudio::logger::COLOR_CYAN, tempo, uaudio::logger::COLOR_WHITE);
+}
+
+struct DitherResult
+{
+	// THD+N in dB (everything but the fundamental, relative to the fundamental).
+	double thdn = 0.0;
+
+	// Energy of harmonic 2 to 10.
+	double harmonics = 0.0;
+
+	// Energy of the residual below ~1kHz.
+	double low_noise = 0.0;
+};
+
+double goertzel_power(const std::vector<double> &samples, double frequency, double sample_rate)
+{
+	constexpr double PI = 3.14159265358979323846;
+	const double coefficient = 2.0 * cos(2.0 * PI * frequency / sample_rate);
+	double previous = 0.0, previous2 = 0.0;
+	for (double sample : samples)
+	{
+		const double value = sample + coefficient * previous - previous2;
+		previous2 = previous;
+		previous = value;
+	}
+	return (previous2 * previous2 + previous * previous - coefficient * previous * previous2) / (samples.size() * samples.size());
+}
+
+DitherResult dither_sine(uaudio::DITHER dither)
+{
+	constexpr double PI = 3.14159265358979323846;
+	constexpr double FREQUENCY = 1000.0;
+
+	// -60dBFS.
+	constexpr double AMPLITUDE = 0.001;
+	const uint32_t sample_rate = uaudio::WAVE_SAMPLE_RATE_48000;
+
+	std::vector<float> dat(sample_rate);
+	for (uint32_t i = 0; i < sample_rate; i++)
+		dat[i] = static_cast<float>(AMPLITUDE * sin(2.0 * PI * FREQUENCY * i / sample_rate));
+
+	uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(float));
+	std::vector<int16_t> new_data(uaudio::conversion::Calculate32To16Size(size) / sizeof(int16_t));
+	uaudio::conversion::Convert32To16(reinterpret_cast<unsigned char *>(new_data.data()), reinterpret_cast<unsigned char *>(dat.data()), size, dither, uaudio::WAVE_CHANNELS_MONO);
+	CHECK(size == new_data.size() * sizeof(int16_t));
+
+	std::vector<double> result(new_data.size());
+	for (size_t i = 0; i < new_data.size(); i++)
+		result[i] = new_data[i] / 32768.0;
+
+	// Fit the fundamental (the frequency fits exactly in the buffer) and remove it.
+	double sin_sum = 0.0, cos_sum = 0.0;
+	for (size_t i = 0; i < result.size(); i++)
+	{
+		sin_sum += result[i] * sin(2.0 * PI * FREQUENCY * i / sample_rate);
+		cos_sum += result[i] * cos(2.0 * PI * FREQUENCY * i / sample_rate);
+	}
+	sin_sum *= 2.0 / result.size();
+	cos_sum *= 2.0 / result.size();
+
+	DitherResult dither_result;
+	double residual_sum = 0.0;
+	std::vector<double> residual(result.size());
+	for (size_t i = 0; i < result.size(); i++)
+	{
+		residual[i] = result[i] - (sin_sum * sin(2.0 * PI * FREQUENCY * i / sample_rate) + cos_sum * cos(2.0 * PI * FREQUENCY * i / sample_rate));
+		residual_sum += residual[i] * residual[i];
+	}
+	const double signal_power = (sin_sum * sin_sum + cos_sum * cos_sum) / 2.0;
+	dither_result.thdn = 10.0 * log10((residual_sum / residual.size()) / signal_power);
+
+	for (uint32_t harmonic = 2; harmonic <= 10; harmonic++)
+		dither_result.harmonics += goertzel_power(residual, FREQUENCY * harmonic, sample_rate);
+
+	// Four one-pole low-pass filters.
+	std::vector<double> low(residual);
+	const double alpha = 1.0 - exp(-2.0 * PI * FREQUENCY / sample_rate);
+	for (uint32_t pass = 0; pass < 4; pass++)
+	{
+		double state = 0.0;
+		for (double &sample : low)
+		{
+			state += alpha * (sample - state);
+			sample = state;
+		}
+	}
+	for (double sample : low)
+		dither_result.low_noise += sample * sample;
+	dither_result.low_noise /= low.size();
+
+	return dither_result;
+}
+
+// Adds a chunk with a copy of the data to a wave format.
+void add_chunk(uaudio::WaveFormat &wave_format, const char *chunk_id, const void *data, uint32_t size)
+{
+	uaudio::WaveChunkData *chunk = reinterpret_cast<uaudio::WaveChunkData *>(malloc(sizeof(uaudio::WaveChunkData) + size));
+	memcpy(chunk->chunk_id, chunk_id, uaudio::CHUNK_ID_SIZE);
+	chunk->chunkSize = size;
+	memcpy(reinterpret_cast<unsigned char *>(chunk) + sizeof(uaudio::WaveChunkData), data, size);
+	wave_format.AddChunk(chunk);
+}
+
 TEST_CASE("Testing Hash Function")
 {
 	const std::string _stringLit = "Rs_239Ksa*--A";
@@ -530,140 +817,3026 @@ TEST_CASE("Audio Conversion")
 	}
 }
 
-TEST_CASE("Miscellaneous")
+TEST_CASE("Sample Rate Conversion")
 {
-	SUBCASE("Clamp")
+	SUBCASE("Common ratios")
 	{
-		uaudio::logger::log_info("%s[CLAMP]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
-
-		float value = 5.0f;
-		value = uaudio::utils::clamp(value, 0.0f, 4.0f);
-
-		CHECK(value == 4.0f);
+		resample_sine(uaudio::WAVE_SAMPLE_RATE_44100, uaudio::WAVE_SAMPLE_RATE_48000);
+		resample_sine(uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_44100);
+		resample_sine(uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_96000);
+		resample_sine(uaudio::WAVE_SAMPLE_RATE_96000, uaudio::WAVE_SAMPLE_RATE_44100);
+	}
+	SUBCASE("Uncommon ratio")
+	{
+		resample_sine(44056, uaudio::WAVE_SAMPLE_RATE_48000);
+	}
+	SUBCASE("Streaming")
+	{
+		stream_resample_sine(uaudio::WAVE_SAMPLE_RATE_44100, uaudio::WAVE_SAMPLE_RATE_48000, 512);
+		stream_resample_sine(uaudio::WAVE_SAMPLE_RATE_96000, uaudio::WAVE_SAMPLE_RATE_48000, 100);
+		stream_resample_sine(44056, uaudio::WAVE_SAMPLE_RATE_48000, 1024);
+	}
+	SUBCASE("Positions")
+	{
+		uaudio::logger::log_info("%s[RESAMPLE POSITIONS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 
-		value = -1.0f;
-		value = uaudio::utils::clamp(value, 0.0f, 4.0f);
+		CHECK(uaudio::conversion::ResamplePosition(44100, uaudio::WAVE_SAMPLE_RATE_44100, uaudio::WAVE_SAMPLE_RATE_48000) == 48000);
+		CHECK(uaudio::conversion::ResamplePosition(147, uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_44100) == 135);
+		CHECK(uaudio::conversion::ResamplePosition(0, uaudio::WAVE_SAMPLE_RATE_96000, uaudio::WAVE_SAMPLE_RATE_48000) == 0);
 
-		CHECK(value == 0.0f);
+		uaudio::logger::log_success("%s[RESAMPLE POSITIONS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Partial frame")
+	{
+		uaudio::logger::log_info("%s[RESAMPLE PARTIAL FRAME]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A data chunk that ends in the middle of a frame gets resampled without the partial frame.
+		constexpr uint32_t NUM_FRAMES = 4800;
+		const std::vector<int16_t> samples(NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO + 1, 1000);
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		fmt_chunk.blockAlign = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		REQUIRE(uaudio::WaveReader::SaveSound("partial_frame.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		uaudio::WaveConfig config;
+		config.sampleRate = uaudio::WAVE_SAMPLE_RATE_44100;
+		uaudio::WaveFile wave_file("partial_frame.wav", config);
+		CHECK(wave_file.GetFmtChunk().sampleRate == uaudio::WAVE_SAMPLE_RATE_44100);
+		CHECK(wave_file.GetDataSize() == uaudio::conversion::CalculateResampleSize(NUM_FRAMES * uaudio::BLOCK_ALIGN_16_BIT_STEREO, uaudio::BLOCK_ALIGN_16_BIT_STEREO, uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_44100));
+		CHECK(wave_file.GetDataSize() % uaudio::BLOCK_ALIGN_16_BIT_STEREO == 0);
+		int16_t middle = 0;
+		memcpy(&middle, wave_file.GetData() + wave_file.GetDataSize() / 2, sizeof(middle));
+		CHECK(std::abs(middle - 1000) <= 2);
+		remove("partial_frame.wav");
+
+		uaudio::logger::log_success("%s[RESAMPLE PARTIAL FRAME]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
 
-		uaudio::logger::log_success("%s[CLAMP]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+TEST_CASE("Time Stretching")
+{
+	SUBCASE("Tempos")
+	{
+		time_stretch_sine(0.5f);
+		time_stretch_sine(0.8f);
+		time_stretch_sine(1.25f);
+		time_stretch_sine(2.0f);
 	}
-	SUBCASE("SECONDS TO MILLISECONDS")
+	SUBCASE("Streaming")
 	{
-		uaudio::logger::log_info("%s[SECONDS TO MILLISECONDS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+		uaudio::logger::log_info("%s[STREAM TIME STRETCH]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 
-		float value = 1.0f;
-		value = uaudio::utils::SecondsToMilliseconds(value);
+		constexpr uint32_t PERIOD_FRAMES = 512;
+		const uint16_t block_align = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		std::vector<int16_t> dat(PERIOD_FRAMES * 2, 1000);
 
-		CHECK(value == 1000.0f);
+		uaudio::conversion::StreamTimeStretch stretch;
+		stretch.Init(uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_BITS_PER_SAMPLE_16, PERIOD_FRAMES);
+		CHECK(!stretch.IsActive());
 
-		value = 2.0f;
-		value = uaudio::utils::SecondsToMilliseconds(value);
+		stretch.SetTempo(4.0f);
+		CHECK(stretch.GetTempo() == UAUDIO_MAX_TEMPO);
+		CHECK(stretch.IsActive());
 
-		CHECK(value == 2000.0f);
+		// Every period of input should give half a period of output on average.
+		std::vector<unsigned char> result(stretch.GetMaxOutputSize(PERIOD_FRAMES * block_align));
+		uint32_t out_frames = 0;
+		for (uint32_t i = 0; i < 200; i++)
+		{
+			const uint32_t out_size = stretch.Process(reinterpret_cast<unsigned char *>(dat.data()), PERIOD_FRAMES * block_align, result.data());
+			CHECK(out_size <= result.size());
+			out_frames += out_size / block_align;
+		}
+		CHECK(std::abs(static_cast<int>(out_frames) - 200 * static_cast<int>(PERIOD_FRAMES) / 2) < 2048);
 
-		value = 2.5f;
-		value = uaudio::utils::SecondsToMilliseconds(value);
+		uaudio::logger::log_success("%s[STREAM TIME STRETCH]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Partial frame")
+	{
+		uaudio::logger::log_info("%s[TIME STRETCH PARTIAL FRAME]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A data chunk that ends in the middle of a frame gets stretched without the partial frame.
+		constexpr uint32_t NUM_FRAMES = 4800;
+		const std::vector<int16_t> samples(NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO + 1, 1000);
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		fmt_chunk.blockAlign = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		REQUIRE(uaudio::WaveReader::SaveSound("partial_frame.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		uaudio::WaveConfig config;
+		config.tempo = 1.5f;
+		uaudio::WaveFile wave_file("partial_frame.wav", config);
+		CHECK(wave_file.GetDataSize() == uaudio::conversion::CalculateTimeStretchSize(NUM_FRAMES * uaudio::BLOCK_ALIGN_16_BIT_STEREO, uaudio::BLOCK_ALIGN_16_BIT_STEREO, 1.5f));
+		CHECK(wave_file.GetDataSize() % uaudio::BLOCK_ALIGN_16_BIT_STEREO == 0);
+		int16_t middle = 0;
+		memcpy(&middle, wave_file.GetData() + wave_file.GetDataSize() / 2, sizeof(middle));
+		CHECK(std::abs(middle - 1000) <= 2);
+		remove("partial_frame.wav");
+
+		uaudio::logger::log_success("%s[TIME STRETCH PARTIAL FRAME]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
 
-		CHECK(value == 2500.0f);
+TEST_CASE("Dithering")
+{
+	SUBCASE("THD+N")
+	{
+		uaudio::logger::log_info("%s[DITHER -60DBFS SINE]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 
-		value = 5.523f;
-		value = uaudio::utils::SecondsToMilliseconds(value);
+		const DitherResult none = dither_sine(uaudio::DITHER::DITHER_NONE);
+		const DitherResult tpdf = dither_sine(uaudio::DITHER::DITHER_TPDF);
+		const DitherResult shaped = dither_sine(uaudio::DITHER::DITHER_TPDF_NOISE_SHAPING);
 
-		CHECK(value == 5523.0f);
+		uaudio::logger::log_info("THD+N: none %.2fdB, tpdf %.2fdB, noise shaping %.2fdB.", none.thdn, tpdf.thdn, shaped.thdn);
 
-		float random = fmodf(rand(), 5.0f);
-		value = random;
-		value = uaudio::utils::SecondsToMilliseconds(value);
+		// TPDF dither of 1 LSB gives a noise floor of LSB^2 / 4, which is ~33dB under a -60dBFS sine.
+		CHECK(std::abs(tpdf.thdn + 33.0) < 2.0);
 
-		CHECK(value == random * 1000);
+		// Without dither the error follows the signal (harmonics), with dither it is noise.
+		CHECK(10.0 * log10(none.harmonics / tpdf.harmonics) > 10.0);
 
-		uaudio::logger::log_success("%s[SECONDS TO MILLISECONDS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+		// Noise shaping moves the noise out of the low frequencies.
+		CHECK(shaped.low_noise < tpdf.low_noise);
+
+		uaudio::logger::log_success("%s[DITHER -60DBFS SINE]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 	}
-	SUBCASE("MILLISECONDS TO SECONDS")
+	SUBCASE("Block boundaries")
 	{
-		uaudio::logger::log_info("%s[MILLISECONDS TO SECONDS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+		uaudio::logger::log_info("%s[DITHER BLOCKS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 
-		float value = 1000.0f;
-		value = uaudio::utils::MillisecondsToSeconds(value);
+		// Quantizing in odd blocks should keep the channels apart (stereo, left silent).
+		std::vector<float> dat(1000);
+		for (size_t i = 0; i < dat.size(); i += 2)
+			dat[i + 1] = 0.5f;
 
-		CHECK(value == 1.0f);
+		uaudio::conversion::Ditherer ditherer;
+		ditherer.Init(uaudio::DITHER::DITHER_TPDF_NOISE_SHAPING, uaudio::WAVE_CHANNELS_STEREO);
+		std::vector<int16_t> result(dat.size());
+		for (uint32_t i = 0; i < dat.size(); i += 7)
+		{
+			const uint32_t count = std::min<uint32_t>(7, static_cast<uint32_t>(dat.size()) - i);
+			ditherer.Quantize(reinterpret_cast<unsigned char *>(result.data() + i), dat.data() + i, count, uaudio::WAVE_BITS_PER_SAMPLE_16);
+		}
+		for (size_t i = 0; i < result.size(); i += 2)
+		{
+			CHECK(std::abs(result[i]) <= 4);
+			CHECK(std::abs(result[i + 1] - 16384) <= 4);
+		}
 
-		value = 2000.0f;
-		value = uaudio::utils::MillisecondsToSeconds(value);
+		uaudio::logger::log_success("%s[DITHER BLOCKS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
 
-		CHECK(value == 2.0f);
+TEST_CASE("Spatialization")
+{
+	constexpr float PI = 3.14159265358979323846f;
 
-		value = 2500.0f;
-		value = uaudio::utils::MillisecondsToSeconds(value);
+	SUBCASE("Attenuation")
+	{
+		uaudio::logger::log_info("%s[SPATIALIZER ATTENUATION]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Spatializer spatializer(16);
+		const uaudio::EmitterHandle inverse = spatializer.AddEmitter();
+		const uaudio::EmitterHandle linear = spatializer.AddEmitter();
+		const uaudio::EmitterHandle exponential = spatializer.AddEmitter();
+		const uaudio::EmitterHandle none = spatializer.AddEmitter();
+		const uaudio::EmitterHandle scalar = spatializer.AddEmitter();
+		spatializer.SetEmitterAttenuation(inverse, uaudio::ATTENUATION_CURVE::ATTENUATION_CURVE_INVERSE, 2.0f, 100.0f);
+		spatializer.SetEmitterAttenuation(linear, uaudio::ATTENUATION_CURVE::ATTENUATION_CURVE_LINEAR, 2.0f, 6.0f);
+		spatializer.SetEmitterAttenuation(exponential, uaudio::ATTENUATION_CURVE::ATTENUATION_CURVE_EXPONENTIAL, 2.0f, 100.0f, 2.0f);
+		spatializer.SetEmitterAttenuation(none, uaudio::ATTENUATION_CURVE::ATTENUATION_CURVE_NONE, 2.0f, 100.0f);
+
+		// Inside the min distance nothing gets attenuated.
+		for (const uaudio::EmitterHandle &emitter : {inverse, linear, exponential, none})
+			spatializer.SetEmitterPosition(emitter, {0.0f, 0.0f, 1.0f});
+		spatializer.Update();
+		for (const uaudio::EmitterHandle &emitter : {inverse, linear, exponential, none})
+			CHECK(spatializer.GetVolume(emitter) == doctest::Approx(1.0f).epsilon(0.001));
+
+		for (const uaudio::EmitterHandle &emitter : {inverse, linear, exponential, none})
+			spatializer.SetEmitterPosition(emitter, {0.0f, 0.0f, 4.0f});
+
+		// The fifth emitter is in the second group of 4 (same code path on every emitter, results should match the first one).
+		spatializer.SetEmitterAttenuation(scalar, uaudio::ATTENUATION_CURVE::ATTENUATION_CURVE_EXPONENTIAL, 2.0f, 100.0f, 2.0f);
+		spatializer.SetEmitterPosition(scalar, {0.0f, 4.0f, 0.0f});
+		spatializer.Update();
+		CHECK(spatializer.GetVolume(inverse) == doctest::Approx(0.5f).epsilon(0.001));
+		CHECK(spatializer.GetVolume(linear) == doctest::Approx(0.5f).epsilon(0.001));
+		CHECK(spatializer.GetVolume(exponential) == doctest::Approx(0.25f).epsilon(0.001));
+		CHECK(spatializer.GetVolume(none) == doctest::Approx(1.0f).epsilon(0.001));
+		CHECK(spatializer.GetVolume(scalar) == doctest::Approx(0.25f).epsilon(0.001));
+
+		// Past the max distance the volume stays the same.
+		spatializer.SetEmitterPosition(linear, {0.0f, 0.0f, 50.0f});
+		spatializer.Update();
+		CHECK(spatializer.GetVolume(linear) == doctest::Approx(0.0f));
+
+		uaudio::logger::log_success("%s[SPATIALIZER ATTENUATION]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Panning")
+	{
+		uaudio::logger::log_info("%s[SPATIALIZER PANNING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Spatializer spatializer(4);
+		const uaudio::EmitterHandle emitter = spatializer.AddEmitter();
+		spatializer.SetEmitterAttenuation(emitter, uaudio::ATTENUATION_CURVE::ATTENUATION_CURVE_NONE, 1.0f, 100.0f);
+
+		spatializer.SetEmitterPosition(emitter, {5.0f, 0.0f, 0.0f});
+		spatializer.Update();
+		CHECK(spatializer.GetPanning(emitter) == doctest::Approx(1.0f));
+
+		float volumes[uaudio::WAVE_CHANNELS_STEREO];
+		spatializer.GetSpeakerVolumes(emitter, uaudio::WAVE_CHANNELS_STEREO, volumes);
+		CHECK(volumes[0] == doctest::Approx(0.0f));
+		CHECK(volumes[1] == doctest::Approx(1.0f));
+
+		// Turn the listener to the emitter.
+		uaudio::Listener listener;
+		listener.forward = {1.0f, 0.0f, 0.0f};
+		spatializer.SetListener(listener);
+		spatializer.Update();
+		CHECK(spatializer.GetPanning(emitter) == doctest::Approx(0.0f));
+
+		// Front center on 5.1 only uses the center speaker, and the power stays the same everywhere.
+		float surround[6];
+		spatializer.GetSpeakerVolumes(emitter, 6, surround);
+		CHECK(surround[2] == doctest::Approx(1.0f));
+		CHECK(surround[3] == doctest::Approx(0.0f));
+
+		for (float angle = 0.0f; angle < 2.0f * PI; angle += 0.1f)
+		{
+			spatializer.SetEmitterPosition(emitter, {std::cos(angle) * 5.0f, 0.0f, std::sin(angle) * 5.0f});
+			spatializer.Update();
+
+			float power = 0.0f;
+			spatializer.GetSpeakerVolumes(emitter, uaudio::WAVE_CHANNELS_STEREO, volumes);
+			for (float volume : volumes)
+				power += volume * volume;
+			CHECK(power == doctest::Approx(1.0f));
+
+			float speakers[UAUDIO_MAX_SPEAKERS];
+			spatializer.GetSpeakerVolumes(emitter, UAUDIO_MAX_SPEAKERS, speakers);
+			power = 0.0f;
+			for (float volume : speakers)
+				power += volume * volume;
+			CHECK(power == doctest::Approx(1.0f));
+			CHECK(speakers[3] == 0.0f);
+		}
 
-		CHECK(value == 2.5f);
+		uaudio::logger::log_success("%s[SPATIALIZER PANNING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Cone and doppler")
+	{
+		uaudio::logger::log_info("%s[SPATIALIZER CONE AND DOPPLER]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Spatializer spatializer(4);
+		const uaudio::EmitterHandle emitter = spatializer.AddEmitter();
+		spatializer.SetEmitterAttenuation(emitter, uaudio::ATTENUATION_CURVE::ATTENUATION_CURVE_NONE, 1.0f, 100.0f);
+		spatializer.SetEmitterPosition(emitter, {0.0f, 0.0f, 10.0f});
+		spatializer.SetEmitterCone(emitter, PI * 0.5f, PI, 0.2f);
+
+		// Facing the listener.
+		spatializer.SetEmitterDirection(emitter, {0.0f, 0.0f, -1.0f});
+		spatializer.Update();
+		CHECK(spatializer.GetVolume(emitter) == doctest::Approx(1.0f));
+
+		// Facing away.
+		spatializer.SetEmitterDirection(emitter, {0.0f, 0.0f, 1.0f});
+		spatializer.Update();
+		CHECK(spatializer.GetVolume(emitter) == doctest::Approx(0.2f));
+
+		// Moving to the listener at a tenth of the speed of sound.
+		spatializer.SetEmitterDirection(emitter, {});
+		spatializer.SetEmitterVelocity(emitter, {0.0f, 0.0f, -UAUDIO_DEFAULT_SPEED_OF_SOUND * 0.1f});
+		spatializer.Update();
+		CHECK(spatializer.GetVolume(emitter) == doctest::Approx(1.0f));
+		CHECK(spatializer.GetPitch(emitter) == doctest::Approx(1.0f / 0.9f));
+
+		// Moving away.
+		spatializer.SetEmitterVelocity(emitter, {0.0f, 0.0f, UAUDIO_DEFAULT_SPEED_OF_SOUND * 0.1f});
+		spatializer.Update();
+		CHECK(spatializer.GetPitch(emitter) == doctest::Approx(1.0f / 1.1f));
+
+		spatializer.SetDopplerFactor(0.0f);
+		spatializer.Update();
+		CHECK(spatializer.GetPitch(emitter) == doctest::Approx(1.0f));
+
+		uaudio::logger::log_success("%s[SPATIALIZER CONE AND DOPPLER]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Handles")
+	{
+		uaudio::logger::log_info("%s[SPATIALIZER HANDLES]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Spatializer spatializer(2);
+		const uaudio::EmitterHandle first = spatializer.AddEmitter();
+		const uaudio::EmitterHandle second = spatializer.AddEmitter();
+		CHECK(first.IsValid());
+		CHECK(second.IsValid());
+		CHECK(!spatializer.AddEmitter().IsValid());
+		CHECK(spatializer.EmitterSize() == 2);
+
+		// Removed emitters are silent and the slot gets reused.
+		spatializer.RemoveEmitter(first);
+		CHECK(spatializer.EmitterSize() == 1);
+		const uaudio::EmitterHandle third = spatializer.AddEmitter();
+		CHECK(static_cast<int32_t>(third) == static_cast<int32_t>(first));
+		CHECK(spatializer.EmitterSize() == 2);
+
+		uaudio::logger::log_success("%s[SPATIALIZER HANDLES]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
 
-		value = 5523.0f;
-		value = uaudio::utils::MillisecondsToSeconds(value);
+bool check_matrix(const float *matrix, const std::vector<float> &expected)
+{
+	bool equal = true;
+	for (size_t i = 0; i < expected.size(); i++)
+		equal &= std::abs(matrix[i] - expected[i]) < 0.0001f;
+	return equal;
+}
 
-		CHECK(value == 5.523f);
+TEST_CASE("Channel Mixing")
+{
+	constexpr float ITU = 0.70710678f;
 
-		float random = fmodf(rand(), 5.0f) * 1000;
-		value = random;
-		value = uaudio::utils::MillisecondsToSeconds(value);
+	SUBCASE("Matrix")
+	{
+		uaudio::logger::log_info("%s[CHANNEL MIX MATRIX]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		float matrix[UAUDIO_MAX_SPEAKERS * UAUDIO_MAX_SPEAKERS];
+
+		CHECK(uaudio::conversion::GetDefaultChannelMask(uaudio::WAVE_CHANNELS_5_1) == 0x3F);
+		CHECK(uaudio::conversion::GetDefaultChannelMask(uaudio::WAVE_CHANNELS_7_1) == 0x63F);
+		CHECK(uaudio::conversion::GetChannelSpeaker(uaudio::WAVE_SPEAKERS_5_1, 2) == uaudio::WAVE_SPEAKER_FRONT_CENTER);
+		CHECK(uaudio::conversion::GetChannelSpeaker(uaudio::WAVE_SPEAKERS_STEREO, 2) == 0);
+
+		// Mono goes to both speakers at full volume.
+		uaudio::conversion::CalculateMixMatrix(matrix, 0, uaudio::WAVE_CHANNELS_MONO, 0, uaudio::WAVE_CHANNELS_STEREO);
+		CHECK(check_matrix(matrix, {1.0f, 1.0f}));
+
+		// Stereo to mono is the average.
+		uaudio::conversion::CalculateMixMatrix(matrix, 0, uaudio::WAVE_CHANNELS_STEREO, 0, uaudio::WAVE_CHANNELS_MONO);
+		CHECK(check_matrix(matrix, {0.5f, 0.5f}));
+
+		// 5.1 to stereo (ITU-R BS.775): L = FL + 0.707 FC + 0.707 BL, the low frequency channel gets left out.
+		uaudio::conversion::CalculateMixMatrix(matrix, 0, uaudio::WAVE_CHANNELS_5_1, 0, uaudio::WAVE_CHANNELS_STEREO, false);
+		CHECK(check_matrix(matrix, {
+			1.0f, 0.0f, ITU, 0.0f, ITU, 0.0f,
+			0.0f, 1.0f, ITU, 0.0f, 0.0f, ITU,
+		}));
+
+		// Normalized so that all channels at full scale do not clip.
+		uaudio::conversion::CalculateMixMatrix(matrix, 0, uaudio::WAVE_CHANNELS_5_1, 0, uaudio::WAVE_CHANNELS_STEREO);
+		const float scale = 1.0f / (1.0f + 2.0f * ITU);
+		CHECK(check_matrix(matrix, {
+			scale, 0.0f, ITU * scale, 0.0f, ITU * scale, 0.0f,
+			0.0f, scale, ITU * scale, 0.0f, 0.0f, ITU * scale,
+		}));
+
+		// 7.1 to 5.1: the side speakers get folded into the back speakers.
+		uaudio::conversion::CalculateMixMatrix(matrix, 0, uaudio::WAVE_CHANNELS_7_1, 0, uaudio::WAVE_CHANNELS_5_1, false);
+		CHECK(check_matrix(matrix, {
+			1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, ITU, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, ITU,
+		}));
+
+		// Upmixing quad to 5.1 leaves the center and low frequency channel silent.
+		uaudio::conversion::CalculateMixMatrix(matrix, 0, uaudio::WAVE_CHANNELS_QUAD, 0, uaudio::WAVE_CHANNELS_5_1);
+		CHECK(check_matrix(matrix, {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f,
+		}));
+
+		// Stereo that is meant for the side speakers.
+		uaudio::conversion::CalculateMixMatrix(matrix, uaudio::WAVE_SPEAKER_SIDE_LEFT | uaudio::WAVE_SPEAKER_SIDE_RIGHT, uaudio::WAVE_CHANNELS_STEREO, 0, uaudio::WAVE_CHANNELS_7_1);
+		CHECK(check_matrix(matrix, {
+			0.0f, 0.0f,
+			0.0f, 0.0f,
+			0.0f, 0.0f,
+			0.0f, 0.0f,
+			0.0f, 0.0f,
+			0.0f, 0.0f,
+			1.0f, 0.0f,
+			0.0f, 1.0f,
+		}));
+
+		uaudio::logger::log_success("%s[CHANNEL MIX MATRIX]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Conversion")
+	{
+		uaudio::logger::log_info("%s[CHANNEL CONVERSION]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// 5.1 with a different constant on every channel (more than one block of frames).
+		constexpr uint32_t NUM_FRAMES = 1000;
+		const int16_t values[uaudio::WAVE_CHANNELS_5_1] = {1000, -2000, 3000, 4000, -5000, 6000};
+		std::vector<int16_t> dat(NUM_FRAMES * uaudio::WAVE_CHANNELS_5_1);
+		for (size_t i = 0; i < dat.size(); i++)
+			dat[i] = values[i % uaudio::WAVE_CHANNELS_5_1];
+
+		uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+		std::vector<int16_t> stereo(uaudio::conversion::CalculateChannelConvertSize(size, uaudio::WAVE_CHANNELS_5_1, uaudio::WAVE_CHANNELS_STEREO) / sizeof(int16_t));
+		uaudio::conversion::ConvertChannels(reinterpret_cast<unsigned char *>(stereo.data()), reinterpret_cast<const unsigned char *>(dat.data()), size, uaudio::WAVE_BITS_PER_SAMPLE_16, 0, uaudio::WAVE_CHANNELS_5_1, 0, uaudio::WAVE_CHANNELS_STEREO);
+		CHECK(size == NUM_FRAMES * uaudio::BLOCK_ALIGN_16_BIT_STEREO);
+
+		const float scale = 1.0f / (1.0f + 2.0f * ITU);
+		const long left = std::lrint((values[0] + ITU * values[2] + ITU * values[4]) * scale);
+		const long right = std::lrint((values[1] + ITU * values[2] + ITU * values[5]) * scale);
+		bool equal = true;
+		for (size_t i = 0; i < stereo.size(); i += 2)
+			equal &= std::abs(stereo[i] - left) <= 1 && std::abs(stereo[i + 1] - right) <= 1;
+		CHECK(equal);
+
+		// Mono to stereo and back does not change the data.
+		std::vector<unsigned char> mono(NUM_FRAMES * 3);
+		for (size_t i = 0; i < mono.size(); i++)
+			mono[i] = static_cast<unsigned char>(i * 37);
+		size = static_cast<uint32_t>(mono.size());
+		std::vector<unsigned char> upmix(uaudio::conversion::CalculateChannelConvertSize(size, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_CHANNELS_STEREO));
+		std::vector<unsigned char> downmix(mono.size());
+		uaudio::conversion::ConvertChannels(upmix.data(), mono.data(), size, uaudio::WAVE_BITS_PER_SAMPLE_24, 0, uaudio::WAVE_CHANNELS_MONO, 0, uaudio::WAVE_CHANNELS_STEREO);
+		CHECK(size == upmix.size());
+		uaudio::conversion::ConvertChannels(downmix.data(), upmix.data(), size, uaudio::WAVE_BITS_PER_SAMPLE_24, 0, uaudio::WAVE_CHANNELS_STEREO, 0, uaudio::WAVE_CHANNELS_MONO);
+		CHECK(size == mono.size());
+		CHECK(downmix == mono);
+
+		uaudio::logger::log_success("%s[CHANNEL CONVERSION]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Channel mask")
+	{
+		uaudio::logger::log_info("%s[CHANNEL MASK]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A WAVE_FORMAT_EXTENSIBLE fmt chunk of a 5.1 file with side speakers.
+		uaudio::FMT_Extensible_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_EXTENSIBLE;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_5_1;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_32;
+		fmt_chunk.channelMask = 0x60F;
+		fmt_chunk.subFormat[0] = uaudio::WAV_FORMAT_IEEE_FLOAT;
+
+		uaudio::WaveChunkData *chunk = reinterpret_cast<uaudio::WaveChunkData *>(malloc(sizeof(uaudio::WaveChunkData) + sizeof(fmt_chunk)));
+		memcpy(chunk->chunk_id, uaudio::FMT_CHUNK_ID, uaudio::CHUNK_ID_SIZE);
+		chunk->chunkSize = sizeof(fmt_chunk);
+		memcpy(reinterpret_cast<unsigned char *>(chunk) + sizeof(uaudio::WaveChunkData), &fmt_chunk, sizeof(fmt_chunk));
+
+		uaudio::WaveFormat wave_format;
+		wave_format.AddChunk(chunk);
+		CHECK(sizeof(fmt_chunk) == uaudio::FMT_CHUNK_EXTENSIBLE_SIZE);
+		CHECK(wave_format.GetChannelMask() == 0x60F);
+		CHECK(wave_format.GetAudioFormat() == uaudio::WAV_FORMAT_IEEE_FLOAT);
+
+		uaudio::logger::log_success("%s[CHANNEL MASK]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
 
-		CHECK(value == random / 1000);
+TEST_CASE("Looping")
+{
+	// 16-bit stereo frames where every sample is the index of its frame.
+	constexpr uint32_t NUM_FRAMES = 1000;
+	std::vector<int16_t> dat(NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO);
+	for (size_t i = 0; i < dat.size(); i++)
+		dat[i] = static_cast<int16_t>(i / uaudio::WAVE_CHANNELS_STEREO);
+	const unsigned char *data = reinterpret_cast<const unsigned char *>(dat.data());
+	const uint32_t data_size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
 
-		uaudio::logger::log_success("%s[MILLISECONDS TO SECONDS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	SUBCASE("Sample accurate")
+	{
+		uaudio::logger::log_info("%s[LOOP WRAP]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::conversion::LoopSettings loop;
+		uaudio::conversion::LoopState state;
+		loop.start = 100 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		loop.end = 900 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		loop.looping = true;
+
+		// A buffer that spans the loop end continues at the loop start, without a gap.
+		std::vector<int16_t> result(300 * uaudio::WAVE_CHANNELS_STEREO);
+		uint32_t position = 800 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		const uint32_t size = static_cast<uint32_t>(result.size() * sizeof(int16_t));
+		CHECK(uaudio::conversion::ReadLooped(reinterpret_cast<unsigned char *>(result.data()), size, data, data_size, position, state, loop, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO) == size);
+		CHECK(result[99 * uaudio::WAVE_CHANNELS_STEREO] == 899);
+		CHECK(result[100 * uaudio::WAVE_CHANNELS_STEREO] == 100);
+		CHECK(result[299 * uaudio::WAVE_CHANNELS_STEREO + 1] == 299);
+		CHECK(position == 300 * uaudio::BLOCK_ALIGN_16_BIT_STEREO);
+
+		// Without looping the read stops at the end of the data.
+		loop.looping = false;
+		loop.end = data_size;
+		position = 900 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		CHECK(uaudio::conversion::ReadLooped(reinterpret_cast<unsigned char *>(result.data()), size, data, data_size, position, state, loop, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO) == 100 * uaudio::BLOCK_ALIGN_16_BIT_STEREO);
+		CHECK(position == data_size);
+		CHECK(uaudio::conversion::ReadLooped(reinterpret_cast<unsigned char *>(result.data()), size, data, data_size, position, state, loop, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO) == 0);
+
+		uaudio::logger::log_success("%s[LOOP WRAP]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 	}
-	SUBCASE("SECONDS TO HOURS")
+	SUBCASE("Crossfade")
 	{
-		uaudio::logger::log_info("%s[SECONDS TO HOURS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+		uaudio::logger::log_info("%s[LOOP CROSSFADE]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 
-		float value = 3600.0f;
-		uint32_t hours = uaudio::utils::SecondsToHours(value);
+		// Equal power: the power of both sides adds up to 1.
+		bool equal_power = true;
+		for (float position = 0.0f; position <= 1.0f; position += 0.05f)
+		{
+			const float fade_in = uaudio::conversion::GetEqualPowerVolume(position);
+			const float fade_out = uaudio::conversion::GetEqualPowerVolume(1.0f - position);
+			equal_power &= std::abs(fade_in * fade_in + fade_out * fade_out - 1.0f) < 0.0001f;
+		}
+		CHECK(equal_power);
+
+		uaudio::conversion::LoopSettings loop;
+		uaudio::conversion::LoopState state;
+		loop.start = 100 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		loop.end = 900 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		loop.crossfade = 50;
+		loop.looping = true;
+
+		// The tail fades into the frames before the loop start, so the jump back lands where the crossfade ends.
+		std::vector<int16_t> result(200 * uaudio::WAVE_CHANNELS_STEREO);
+		uint32_t position = 800 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		const uint32_t size = static_cast<uint32_t>(result.size() * sizeof(int16_t));
+		CHECK(uaudio::conversion::ReadLooped(reinterpret_cast<unsigned char *>(result.data()), size, data, data_size, position, state, loop, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO) == size);
+		CHECK(result[49 * uaudio::WAVE_CHANNELS_STEREO] == 849);
+		CHECK(std::abs(result[50 * uaudio::WAVE_CHANNELS_STEREO] - 850) <= 1);
+		const float fade_in = uaudio::conversion::GetEqualPowerVolume(49.5f / 50.0f);
+		const float fade_out = uaudio::conversion::GetEqualPowerVolume(0.5f / 50.0f);
+		CHECK(std::abs(result[99 * uaudio::WAVE_CHANNELS_STEREO] - std::lrint(899 * fade_out + 99 * fade_in)) <= 1);
+		CHECK(result[100 * uaudio::WAVE_CHANNELS_STEREO] == 100);
+
+		// Not enough frames before the loop start: the tail fades into the first frames of the loop, which get skipped after the jump back.
+		loop.start = 0;
+		position = 800 * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		CHECK(uaudio::conversion::ReadLooped(reinterpret_cast<unsigned char *>(result.data()), size, data, data_size, position, state, loop, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO) == size);
+		CHECK(std::abs(result[99 * uaudio::WAVE_CHANNELS_STEREO] - std::lrint(899 * fade_out + 49 * fade_in)) <= 1);
+		CHECK(result[100 * uaudio::WAVE_CHANNELS_STEREO] == 50);
+
+		uaudio::logger::log_success("%s[LOOP CROSSFADE]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Loop types")
+	{
+		uaudio::logger::log_info("%s[LOOP TYPES]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 
-		CHECK(hours == 1);
+		// Reads the sound from the start, returns the frame indices that got played.
+		const auto read = [data, data_size](const uaudio::SMPL_Sample_Loop *a_SampleLoops, uint32_t a_NumSampleLoops, uint32_t &a_Position, uaudio::conversion::LoopState &a_State, uint32_t a_NumFrames)
+		{
+			uaudio::conversion::LoopSettings loop;
+			loop.end = data_size;
+			loop.sampleLoops = a_SampleLoops;
+			loop.numSampleLoops = a_NumSampleLoops;
+
+			std::vector<int16_t> result(a_NumFrames * uaudio::WAVE_CHANNELS_STEREO);
+			const uint32_t size = uaudio::conversion::ReadLooped(reinterpret_cast<unsigned char *>(result.data()), a_NumFrames * uaudio::BLOCK_ALIGN_16_BIT_STEREO, data, data_size, a_Position, a_State, loop, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO);
+
+			std::vector<int16_t> frames;
+			for (uint32_t i = 0; i < size / uaudio::BLOCK_ALIGN_16_BIT_STEREO; i++)
+				frames.push_back(result[i * uaudio::WAVE_CHANNELS_STEREO] == result[i * uaudio::WAVE_CHANNELS_STEREO + 1] ? result[i * uaudio::WAVE_CHANNELS_STEREO] : -1);
+			return frames;
+		};
 
-		value = 1800.0f;
-		hours = uaudio::utils::SecondsToHours(value);
+		// The loop end is the last frame of the loop.
+		uaudio::SMPL_Sample_Loop sample_loops[2] = {{0, static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_FORWARD), 100, 199, 0, 2}};
+
+		// Forward: plays twice, then continues after the loop.
+		uint32_t position = 0;
+		uaudio::conversion::LoopState state;
+		std::vector<int16_t> frames = read(sample_loops, 1, position, state, 1200);
+		CHECK(frames.size() == 1100);
+		CHECK(frames[199] == 199);
+		CHECK(frames[200] == 100);
+		CHECK(frames[299] == 199);
+		CHECK(frames[300] == 200);
+		CHECK(frames.back() == 999);
+
+		// Ping-pong: changes direction at both ends without playing the loop end or loop start twice.
+		sample_loops[0].type = static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_PING_PONG);
+		position = 0;
+		state = {};
+		frames = read(sample_loops, 1, position, state, 1200);
+		CHECK(frames.size() == 1198);
+		CHECK(frames[200] == 198);
+		CHECK(frames[298] == 100);
+		CHECK(frames[299] == 101);
+		CHECK(frames[397] == 199);
+		CHECK(frames[398] == 200);
+
+		// Reverse: plays backwards from the loop end, twice.
+		sample_loops[0].type = static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_REVERSE);
+		position = 0;
+		state = {};
+		frames = read(sample_loops, 1, position, state, 1200);
+		CHECK(frames.size() == 1199);
+		CHECK(frames[200] == 198);
+		CHECK(frames[298] == 100);
+		CHECK(frames[299] == 199);
+		CHECK(frames[398] == 100);
+		CHECK(frames[399] == 200);
+
+		// Sustain: a play count of 0 loops until the release, the loops after it still play.
+		sample_loops[0] = {0, static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_FORWARD), 100, 199, 0, 0};
+		sample_loops[1] = {0, static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_FORWARD), 300, 349, 0, 2};
+		position = 0;
+		state = {};
+		frames = read(sample_loops, 2, position, state, 500);
+		CHECK(frames[400] == 100);
+		CHECK(frames[499] == 199);
+		state.released = true;
+		frames = read(sample_loops, 2, position, state, 300);
+		CHECK(frames[0] == 200);
+		CHECK(frames[150] == 300);
+		CHECK(frames[200] == 350);
+		CHECK(!state.released);
+
+		// A fraction of half a frame makes every other pass one frame longer.
+		sample_loops[0] = {0, static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_FORWARD), 100, 199, 0x80000000, 0};
+		position = 0;
+		state = {};
+		frames = read(sample_loops, 1, position, state, 501);
+		CHECK(frames[199] == 199);
+		CHECK(frames[200] == 100);
+		CHECK(frames[300] == 200);
+		CHECK(frames[301] == 100);
+		CHECK(frames[400] == 199);
+		CHECK(frames[401] == 100);
+
+		// The reverse copy keeps the samples of a frame together.
+		bool reversed = true;
+		std::vector<unsigned char> original(37 * 12);
+		for (size_t i = 0; i < original.size(); i++)
+			original[i] = static_cast<unsigned char>(i * 13);
+		for (uint32_t block_align : {2, 3, 4, 6, 8, 12})
+		{
+			const uint32_t num_frames = static_cast<uint32_t>(original.size()) / block_align;
+			std::vector<unsigned char> result(original.size());
+			uaudio::conversion::ReverseFrames(result.data(), original.data(), num_frames, block_align);
+			for (uint32_t i = 0; i < num_frames; i++)
+				reversed &= memcmp(result.data() + i * block_align, original.data() + (num_frames - 1 - i) * block_align, block_align) == 0;
+		}
+		CHECK(reversed);
 
-		CHECK(hours == 0);
+		uaudio::logger::log_success("%s[LOOP TYPES]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
 
-		value = 2700.0f;
-		hours = uaudio::utils::SecondsToHours(value);
+TEST_CASE("Envelopes")
+{
+	// 1 frame per millisecond.
+	constexpr uint32_t SAMPLE_RATE = 1000;
 
-		CHECK(hours == 0);
+	// Moves the envelope a number of frames and returns the volume.
+	const auto advance = [](uaudio::effects::Envelope &a_Envelope, uint32_t a_NumFrames)
+	{
+		for (uint32_t i = 0; i < a_NumFrames; i++)
+			a_Envelope.Next();
+		return a_Envelope.GetLevel();
+	};
 
-		uaudio::logger::log_success("%s[SECONDS TO HOURS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	SUBCASE("Curves")
+	{
+		uaudio::logger::log_info("%s[ENVELOPE CURVES]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::effects::Envelope envelope;
+		envelope.Init(SAMPLE_RATE);
+
+		// Linear: halfway is half the volume, the end is exact.
+		envelope.SetLevel(0.0f);
+		envelope.Fade(1.0f, 10.0f, uaudio::ENVELOPE_CURVE::ENVELOPE_CURVE_LINEAR);
+		CHECK(envelope.IsMoving());
+		CHECK(advance(envelope, 5) == doctest::Approx(0.5f));
+		CHECK(advance(envelope, 5) == 1.0f);
+		CHECK(envelope.GetStage() == uaudio::ENVELOPE_STAGE::ENVELOPE_STAGE_SUSTAIN);
+		CHECK(!envelope.IsMoving());
+
+		// Exponential: halfway is halfway in dB.
+		envelope.Fade(0.01f, 100.0f, uaudio::ENVELOPE_CURVE::ENVELOPE_CURVE_EXPONENTIAL);
+		CHECK(advance(envelope, 50) == doctest::Approx(0.1f).epsilon(0.001));
+		CHECK(advance(envelope, 50) == 0.01f);
+
+		// Equal power: halfway is -3dB, at every frame the volume is cos (a long fade, so the rotation must not drift).
+		envelope.SetLevel(1.0f);
+		envelope.Release(1000.0f, uaudio::ENVELOPE_CURVE::ENVELOPE_CURVE_EQUAL_POWER);
+		float max_error = 0.0f;
+		for (uint32_t i = 1; i <= 1000; i++)
+			max_error = std::max(max_error, std::abs(envelope.Next() - std::cos(1.57079632679f * static_cast<float>(i) / 1000.0f)));
+		CHECK(max_error < 0.0001f);
+		CHECK(envelope.GetLevel() == 0.0f);
+		CHECK(envelope.IsDone());
+
+		// A done envelope stays silent.
+		envelope.Fade(1.0f, 10.0f, uaudio::ENVELOPE_CURVE::ENVELOPE_CURVE_LINEAR);
+		CHECK(advance(envelope, 10) == 0.0f);
+
+		uaudio::logger::log_success("%s[ENVELOPE CURVES]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 	}
-	SUBCASE("SECONDS TO MINUTES")
+	SUBCASE("ADSR")
 	{
-		uaudio::logger::log_info("%s[SECONDS TO MINUTES]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
-
-		float value = 60.0f;
-		uint32_t minutes = uaudio::utils::SecondsToMinutes(value);
-
-		CHECK(minutes == 1);
-
-		value = 120.0f;
-		minutes = uaudio::utils::SecondsToMinutes(value);
+		uaudio::logger::log_info("%s[ENVELOPE ADSR]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::effects::Envelope envelope;
+		envelope.Init(SAMPLE_RATE);
+
+		// Without an attack, decay and release the sound plays at full volume.
+		envelope.Trigger();
+		CHECK(envelope.GetLevel() == 1.0f);
+		CHECK(envelope.GetStage() == uaudio::ENVELOPE_STAGE::ENVELOPE_STAGE_SUSTAIN);
+
+		uaudio::effects::ADSR adsr;
+		adsr.attack = 10.0f;
+		adsr.decay = 20.0f;
+		adsr.sustain = 0.5f;
+		adsr.release = 40.0f;
+		envelope.SetADSR(adsr);
+
+		envelope.Trigger();
+		CHECK(envelope.GetLevel() == 0.0f);
+		CHECK(envelope.GetStage() == uaudio::ENVELOPE_STAGE::ENVELOPE_STAGE_ATTACK);
+		CHECK(advance(envelope, 10) == 1.0f);
+		CHECK(envelope.GetStage() == uaudio::ENVELOPE_STAGE::ENVELOPE_STAGE_DECAY);
+		CHECK(advance(envelope, 20) == 0.5f);
+		CHECK(envelope.GetStage() == uaudio::ENVELOPE_STAGE::ENVELOPE_STAGE_SUSTAIN);
+		CHECK(advance(envelope, 1000) == 0.5f);
+
+		envelope.Release();
+		CHECK(advance(envelope, 20) == doctest::Approx(0.25f));
+		CHECK(advance(envelope, 19) > 0.0f);
+		CHECK(advance(envelope, 1) == 0.0f);
+		CHECK(envelope.IsDone());
+
+		// A release during the attack starts from the volume that the attack got to.
+		envelope.Trigger();
+		advance(envelope, 5);
+		envelope.Release();
+		CHECK(envelope.GetLevel() == doctest::Approx(0.5f));
+		CHECK(advance(envelope, 20) == doctest::Approx(0.25f));
+
+		uaudio::logger::log_success("%s[ENVELOPE ADSR]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
 
-		CHECK(minutes == 2);
+TEST_CASE("Ducking")
+{
+	// Updates the ducker every millisecond for a number of milliseconds, with a key from the key bus before every update.
+	const auto advance = [](uaudio::Ducker &a_Ducker, uint32_t a_Milliseconds, float a_Peak)
+	{
+		for (uint32_t i = 0; i < a_Milliseconds; i++)
+		{
+			a_Ducker.AddKey(a_Ducker.GetSettings().keyBus, a_Peak, 0.001f);
+			a_Ducker.Update(0.001f);
+		}
+		return a_Ducker.GetReduction();
+	};
 
-		uaudio::logger::log_success("%s[SECONDS TO MINUTES]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	SUBCASE("Buses")
+	{
+		uaudio::logger::log_info("%s[DUCKING BUSES]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Ducker ducker;
+		uaudio::DuckerSettings settings;
+		settings.keyBus = 1;
+		settings.targetBuses = (1u << 0) | (1u << 2);
+		settings.depth = -20.0f;
+		settings.attack = 0.0f;
+		ducker.SetSettings(settings);
+
+		// A disabled ducker ignores the key.
+		CHECK(advance(ducker, 10, 1.0f) == 0.0f);
+		CHECK(!ducker.IsKey(1));
+
+		ducker.SetEnabled(true);
+		CHECK(ducker.IsKey(1));
+		CHECK(advance(ducker, 1, 1.0f) == -20.0f);
+
+		// Only the target buses get ducked, -20 dB is a tenth of the volume.
+		CHECK(ducker.GetGain(0) == doctest::Approx(0.1f));
+		CHECK(ducker.GetGain(1) == 1.0f);
+		CHECK(ducker.GetGain(2) == doctest::Approx(0.1f));
+		CHECK(ducker.GetGain(3) == 1.0f);
+		CHECK(ducker.GetGain(uaudio::UAUDIO_MAX_BUSES) == 1.0f);
+
+		// Channels on other buses are not the key.
+		ducker.Reset();
+		ducker.AddKey(0, 1.0f, 1.0f);
+		ducker.Update(0.001f);
+		CHECK(ducker.GetReduction() == 0.0f);
+
+		// Turning it off lets the buses go at once.
+		advance(ducker, 1, 1.0f);
+		ducker.SetEnabled(false);
+		ducker.Update(0.001f);
+		CHECK(ducker.GetGain(0) == 1.0f);
+
+		uaudio::logger::log_success("%s[DUCKING BUSES]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Follower")
+	{
+		uaudio::logger::log_info("%s[DUCKING FOLLOWER]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Ducker ducker;
+		uaudio::DuckerSettings settings;
+		settings.threshold = -30.0f;
+		settings.depth = -12.0f;
+		settings.attack = 10.0f;
+		settings.release = 100.0f;
+		settings.hold = 50.0f;
+		ducker.SetSettings(settings);
+		ducker.SetEnabled(true);
+
+		// A key below the threshold does nothing.
+		CHECK(advance(ducker, 100, 0.01f) == 0.0f);
+
+		// After one attack time constant the reduction is 63% of the depth and after 10 it is at the depth.
+		CHECK(advance(ducker, 10, 0.5f) == doctest::Approx(-12.0f * (1.0f - std::exp(-1.0f))).epsilon(0.01));
+		CHECK(advance(ducker, 90, 0.5f) == -12.0f);
+
+		// The hold keeps the depth after the key stops.
+		CHECK(advance(ducker, 49, 0.0f) == -12.0f);
+
+		// Then it recovers with the release.
+		CHECK(advance(ducker, 100, 0.0f) == doctest::Approx(-12.0f * std::exp(-1.0f)).epsilon(0.05));
+		CHECK(advance(ducker, 2000, 0.0f) == 0.0f);
+		CHECK(ducker.GetGain(UAUDIO_DEFAULT_BUS) == 1.0f);
+
+		// A key lasts as long as its buffer, so one short buffer only ducks for its length and the hold.
+		ducker.AddKey(settings.keyBus, 1.0f, 0.01f);
+		CHECK(advance(ducker, 20, 0.0f) < -10.0f);
+		CHECK(advance(ducker, 50, 0.0f) > -12.0f);
+
+		uaudio::logger::log_success("%s[DUCKING FOLLOWER]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 	}
 }
 
-TEST_CASE("Audio Loading")
+TEST_CASE("Metering")
 {
-	SUBCASE("Existing file")
+	constexpr uint32_t SAMPLE_RATE = uaudio::WAVE_SAMPLE_RATE_48000;
+
+	// A 1kHz sine in every channel (a channel volume of 0 makes that channel silent).
+	const auto make_sine = [](uint32_t a_NumFrames, uint16_t a_NumChannels, const std::vector<float> &a_Volumes)
 	{
-		uaudio::logger::log_info("%s[OPENING EXISTING VALID FILE]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+		std::vector<float> samples(static_cast<size_t>(a_NumFrames) * a_NumChannels);
+		for (uint32_t i = 0; i < a_NumFrames; i++)
+			for (uint16_t j = 0; j < a_NumChannels; j++)
+				samples[i * a_NumChannels + j] = a_Volumes[j] * std::sin(2.0f * 3.14159265f * 1000.0f * static_cast<float>(i) / SAMPLE_RATE);
+		return samples;
+	};
+
+	SUBCASE("Peak and RMS")
+	{
+		uaudio::logger::log_info("%s[METERING PEAK AND RMS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		const std::vector<float> samples = make_sine(SAMPLE_RATE, uaudio::WAVE_CHANNELS_STEREO, {0.5f, 0.0f});
+
+		uaudio::effects::Meter meter;
+		meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_SPEAKERS_STEREO);
+
+		// Nothing is published before the first block is full.
+		CHECK(!meter.Process(samples.data(), SAMPLE_RATE / 20 * 2));
+		CHECK(meter.Read().numChannels == 0);
+		CHECK(meter.Process(samples.data(), SAMPLE_RATE / 20 * 2));
+
+		const uaudio::effects::MeterReadings readings = meter.Read();
+		CHECK(readings.numChannels == uaudio::WAVE_CHANNELS_STEREO);
+		CHECK(readings.peak[0] == doctest::Approx(0.5f).epsilon(0.001));
+		CHECK(readings.rms[0] == doctest::Approx(0.5f / std::sqrt(2.0f)).epsilon(0.001));
+		CHECK(readings.peak[1] == 0.0f);
+		CHECK(readings.rms[1] == 0.0f);
+		CHECK(uaudio::effects::GetDecibels(readings.peak[0]) == doctest::Approx(-6.02f).epsilon(0.01));
+
+		// Frames that are split over calls (odd amounts of samples) give the same readings as whole buffers.
+		uaudio::effects::Meter split_meter;
+		split_meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_SPEAKERS_STEREO);
+		for (uint32_t i = 0; i < SAMPLE_RATE / 10 * 2; i += 255)
+			split_meter.Process(samples.data() + i, std::min(255u, SAMPLE_RATE / 10 * 2 - i));
+		const uaudio::effects::MeterReadings split_readings = split_meter.Read();
+		CHECK(split_readings.peak[0] == readings.peak[0]);
+		CHECK(split_readings.rms[0] == doctest::Approx(readings.rms[0]));
+		CHECK(split_readings.momentary == doctest::Approx(readings.momentary));
+
+		uaudio::logger::log_success("%s[METERING PEAK AND RMS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Loudness")
+	{
+		uaudio::logger::log_info("%s[METERING LOUDNESS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// ITU-R BS.1770: a 1kHz sine at full scale in one channel is -3.01 LUFS.
+		uaudio::effects::Meter meter;
+		meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_SPEAKERS_MONO);
+		std::vector<float> samples = make_sine(SAMPLE_RATE * 3, uaudio::WAVE_CHANNELS_MONO, {1.0f});
+		meter.Process(samples.data(), SAMPLE_RATE / 2);
+		CHECK(meter.GetLast().momentary == doctest::Approx(-3.01f).epsilon(0.01));
+
+		// The short-term window is 3 seconds, so it is only full after 3 seconds.
+		CHECK(meter.GetLast().shortTerm < -10.0f);
+		meter.Process(samples.data() + SAMPLE_RATE / 2, SAMPLE_RATE * 5 / 2);
+		CHECK(meter.GetLast().shortTerm == doctest::Approx(-3.01f).epsilon(0.01));
+
+		// In both channels it is twice the power (+3dB).
+		meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_SPEAKERS_STEREO);
+		samples = make_sine(SAMPLE_RATE / 2, uaudio::WAVE_CHANNELS_STEREO, {1.0f, 1.0f});
+		meter.Process(samples.data(), static_cast<uint32_t>(samples.size()));
+		CHECK(meter.GetLast().momentary == doctest::Approx(0.0f).epsilon(0.01));
+
+		// 5.1: the LFE does not count, the surround channels count 1.41 times (+1.5dB).
+		meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_5_1, uaudio::WAVE_SPEAKERS_5_1);
+		samples = make_sine(SAMPLE_RATE / 2, uaudio::WAVE_CHANNELS_5_1, {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f});
+		meter.Process(samples.data(), static_cast<uint32_t>(samples.size()));
+		CHECK(meter.GetLast().momentary == uaudio::effects::METER_SILENCE);
+		CHECK(meter.GetLast().peak[3] == doctest::Approx(1.0f).epsilon(0.001));
+		meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_5_1, uaudio::WAVE_SPEAKERS_5_1);
+		samples = make_sine(SAMPLE_RATE / 2, uaudio::WAVE_CHANNELS_5_1, {0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f});
+		meter.Process(samples.data(), static_cast<uint32_t>(samples.size()));
+		CHECK(meter.GetLast().momentary == doctest::Approx(-3.01f + 10.0f * std::log10(1.41f)).epsilon(0.01));
+
+		// Buses add up the power of their channels.
+		uaudio::effects::MeterReadings bus;
+		uaudio::effects::AddReadings(bus, meter.GetLast());
+		uaudio::effects::AddReadings(bus, meter.GetLast());
+		CHECK(bus.numChannels == uaudio::WAVE_CHANNELS_5_1);
+		CHECK(bus.momentary == doctest::Approx(meter.GetLast().momentary + 3.01f).epsilon(0.01));
+		CHECK(bus.peak[4] == meter.GetLast().peak[4]);
+
+		uaudio::logger::log_success("%s[METERING LOUDNESS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Triple buffer")
+	{
+		uaudio::logger::log_info("%s[METERING TRIPLE BUFFER]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 
-		uaudio::WaveFormat format;
-		FILE *file = nullptr;
-		uaudio::WaveReader::LoadSound("3 Steps Ahead - Drop It (Happy Mix).wav", format, file);
+		uaudio::utils::TripleBuffer<uint32_t> buffer;
+		CHECK(buffer.Read() == 0);
+		buffer.Write(1);
+		buffer.Write(2);
+		CHECK(buffer.Read() == 2);
+		CHECK(buffer.Read() == 2);
 
-		CHECK(format.HasChunk(uaudio::FMT_CHUNK_ID));
+		// The reader never sees a value that is half written (both halves are the same when it is whole).
+		struct Pair
+		{
+			uint32_t a = 0, b = 0;
+		};
+		uaudio::utils::TripleBuffer<Pair> pairs;
+		std::thread writer([&pairs]()
+		{
+			for (uint32_t i = 1; i <= 100000; i++)
+			{
+				Pair &pair = pairs.GetBack();
+				pair.a = i;
+				pair.b = i;
+				pairs.Publish();
+			}
+		});
+		bool torn = false;
+		uint32_t last = 0;
+		bool ordered = true;
+		while (last < 100000)
+		{
+			const Pair pair = pairs.Read();
+			torn |= pair.a != pair.b;
+			ordered &= pair.a >= last;
+			last = pair.a;
+		}
+		writer.join();
+		CHECK(!torn);
+		CHECK(ordered);
 
-		uaudio::FMT_Chunk fmt_chunk = format.GetChunkFromData<uaudio::FMT_Chunk>(uaudio::FMT_CHUNK_ID);
+		uaudio::logger::log_success("%s[METERING TRIPLE BUFFER]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Spectrum Analysis")
+{
+	constexpr uint32_t SAMPLE_RATE = uaudio::WAVE_SAMPLE_RATE_48000;
+
+	// Interleaved sines (the same in every channel).
+	const auto make_sine = [](float a_Frequency, float a_Volume, uint32_t a_NumFrames, uint16_t a_NumChannels)
+	{
+		std::vector<float> samples(static_cast<size_t>(a_NumFrames) * a_NumChannels);
+		for (uint32_t i = 0; i < a_NumFrames; i++)
+			for (uint16_t j = 0; j < a_NumChannels; j++)
+				samples[i * a_NumChannels + j] = a_Volume * std::sin(2.0f * 3.14159265f * a_Frequency * static_cast<float>(i) / SAMPLE_RATE);
+		return samples;
+	};
+
+	// Returns the band that a frequency is in.
+	const auto find_band = [](const uaudio::SpectrumReadings &a_Readings, float a_Frequency)
+	{
+		uint32_t band = 0;
+		for (uint32_t i = 0; i < a_Readings.numBands; i++)
+			if (std::abs(a_Readings.frequencies[i] - a_Frequency) < std::abs(a_Readings.frequencies[band] - a_Frequency))
+				band = i;
+		return band;
+	};
+
+	SUBCASE("Bands")
+	{
+		uaudio::logger::log_info("%s[SPECTRUM ANALYSIS BANDS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Analyzer analyzer(2048);
+		analyzer.SetSampleRate(SAMPLE_RATE);
+		CHECK(analyzer.GetFFTSize() == 2048);
+
+		// Nothing to analyze before a whole FFT has been written.
+		CHECK(!analyzer.Analyze());
+
+		const std::vector<float> samples = make_sine(1000.0f, 1.0f, 4096, uaudio::WAVE_CHANNELS_STEREO);
+		analyzer.Write(samples.data(), static_cast<uint32_t>(samples.size()), 0, uaudio::WAVE_CHANNELS_STEREO);
+		analyzer.Commit();
+		CHECK(analyzer.Analyze());
+		CHECK(!analyzer.Analyze());
+
+		// A full scale sine is 0 dB (minus the scalloping of the window, 1.42 dB at most), far away bands are quiet.
+		uaudio::SpectrumReadings readings = analyzer.Read();
+		CHECK(readings.numBands == UAUDIO_DEFAULT_NUM_BANDS);
+		const uint32_t band = find_band(readings, 1000.0f);
+		CHECK(readings.bands[band] > -1.5f);
+		CHECK(readings.bands[band] <= 0.01f);
+		CHECK(readings.bands[find_band(readings, 100.0f)] < -60.0f);
+		CHECK(readings.bands[find_band(readings, 10000.0f)] < -60.0f);
+
+		// Log bands are equally wide in octaves, linear bands in Hz.
+		CHECK(readings.frequencies[1] / readings.frequencies[0] == doctest::Approx(readings.frequencies[11] / readings.frequencies[10]));
+		analyzer.SetBands(16, uaudio::BAND_SPACING::BAND_SPACING_LINEAR, 0.0f, 24000.0f);
+		analyzer.Write(samples.data(), static_cast<uint32_t>(samples.size()), 0, uaudio::WAVE_CHANNELS_STEREO);
+		analyzer.Commit();
+		CHECK(analyzer.Analyze());
+		readings = analyzer.Read();
+		CHECK(readings.numBands == 16);
+		CHECK(readings.frequencies[1] - readings.frequencies[0] == doctest::Approx(readings.frequencies[11] - readings.frequencies[10]));
+		CHECK(find_band(readings, 1000.0f) == 0);
+		CHECK(readings.bands[0] > -1.5f);
+
+		uaudio::logger::log_success("%s[SPECTRUM ANALYSIS BANDS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Tap")
+	{
+		uaudio::logger::log_info("%s[SPECTRUM ANALYSIS TAP]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Analyzer analyzer(2048);
+		analyzer.SetSampleRate(SAMPLE_RATE);
+
+		// A disabled analyzer taps nothing, the master taps every bus.
+		CHECK(!analyzer.IsTapped(UAUDIO_DEFAULT_BUS));
+		analyzer.SetEnabled(true);
+		CHECK(analyzer.IsTapped(UAUDIO_DEFAULT_BUS));
+		CHECK(analyzer.IsTapped(5));
+		analyzer.SetBus(5);
+		CHECK(!analyzer.IsTapped(UAUDIO_DEFAULT_BUS));
+		CHECK(analyzer.IsTapped(5));
+		analyzer.SetEnabled(false);
+
+		// Two channels in the same update are mixed: two sines at half volume are two bands at -6 dB.
+		analyzer.SetBands(UAUDIO_DEFAULT_NUM_BANDS, uaudio::BAND_SPACING::BAND_SPACING_LOG);
+		const std::vector<float> low = make_sine(500.0f, 0.5f, 4096, uaudio::WAVE_CHANNELS_MONO);
+		const std::vector<float> high = make_sine(4000.0f, 0.5f, 4096, uaudio::WAVE_CHANNELS_STEREO);
+		for (uint32_t i = 0; i < 4096; i += 256)
+			analyzer.Write(low.data() + i, 256, i, uaudio::WAVE_CHANNELS_MONO);
+		for (uint32_t i = 0; i < 4096 * 2; i += 255)
+			analyzer.Write(high.data() + i, std::min(255u, 4096 * 2 - i), i, uaudio::WAVE_CHANNELS_STEREO);
+		analyzer.Commit();
+		CHECK(analyzer.Analyze());
+		const uaudio::SpectrumReadings readings = analyzer.Read();
+		CHECK(readings.bands[find_band(readings, 500.0f)] == doctest::Approx(-6.02f).epsilon(0.25));
+		CHECK(readings.bands[find_band(readings, 4000.0f)] == doctest::Approx(-6.02f).epsilon(0.25));
+
+		// The next update starts after the frames of this one, on cleared frames.
+		analyzer.Commit();
+		CHECK(!analyzer.Analyze());
+		const std::vector<float> silence(4096, 0.0f);
+		analyzer.Write(silence.data(), 4096, 0, uaudio::WAVE_CHANNELS_MONO);
+		analyzer.Commit();
+		CHECK(analyzer.Analyze());
+		CHECK(analyzer.Read().bands[find_band(readings, 500.0f)] == UAUDIO_ANALYZER_FLOOR);
+
+		uaudio::logger::log_success("%s[SPECTRUM ANALYSIS TAP]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Worker")
+	{
+		uaudio::logger::log_info("%s[SPECTRUM ANALYSIS WORKER]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Analyzer analyzer(1024);
+		analyzer.SetSampleRate(SAMPLE_RATE);
+		analyzer.SetEnabled(true);
+
+		// The worker picks up the frames on its own.
+		const std::vector<float> samples = make_sine(1000.0f, 1.0f, 2048, uaudio::WAVE_CHANNELS_MONO);
+		analyzer.Write(samples.data(), 2048, 0, uaudio::WAVE_CHANNELS_MONO);
+		analyzer.Commit();
+		uaudio::SpectrumReadings readings;
+		for (uint32_t i = 0; i < 200 && readings.numBands == 0; i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			readings = analyzer.Read();
+		}
+		analyzer.SetEnabled(false);
+		CHECK(readings.numBands == UAUDIO_DEFAULT_NUM_BANDS);
+		CHECK(readings.bands[find_band(readings, 1000.0f)] > -1.5f);
+
+		uaudio::logger::log_success("%s[SPECTRUM ANALYSIS WORKER]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Silence Trimming")
+{
+	SUBCASE("Detection")
+	{
+		uaudio::logger::log_info("%s[SILENCE DETECTION]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// -60 dB is 32.8 in 16-bit, so 33 is the quietest sample that is not silent.
+		std::vector<int16_t> samples_16(100 * uaudio::WAVE_CHANNELS_STEREO, 32);
+		samples_16[20 * 2] = -33;
+		samples_16[50 * 2 + 1] = INT16_MIN;
+		samples_16[70 * 2 + 1] = 40;
+		uint32_t first_frame = 0, end_frame = 0;
+		CHECK(uaudio::conversion::FindAudibleFrames(reinterpret_cast<const unsigned char *>(samples_16.data()), static_cast<uint32_t>(samples_16.size() * sizeof(int16_t)), uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO, -60.0f, first_frame, end_frame));
+		CHECK(first_frame == 20);
+		CHECK(end_frame == 71);
+
+		// Raising the threshold only keeps the full scale sample.
+		CHECK(uaudio::conversion::FindAudibleFrames(reinterpret_cast<const unsigned char *>(samples_16.data()), static_cast<uint32_t>(samples_16.size() * sizeof(int16_t)), uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO, 0.0f, first_frame, end_frame));
+		CHECK(first_frame == 50);
+		CHECK(end_frame == 51);
+
+		// 24-bit mono, with a length that is not a multiple of the block.
+		std::vector<unsigned char> samples_24(37 * 3, 0);
+		const auto write_24 = [&samples_24](uint32_t a_Index, int32_t a_Value)
+		{
+			samples_24[a_Index * 3] = static_cast<unsigned char>(a_Value & 0xFF);
+			samples_24[a_Index * 3 + 1] = static_cast<unsigned char>((a_Value >> 8) & 0xFF);
+			samples_24[a_Index * 3 + 2] = static_cast<unsigned char>((a_Value >> 16) & 0xFF);
+		};
+		write_24(3, -8388);
+		write_24(9, -8389);
+		write_24(35, 9000);
+		write_24(36, 8388);
+		CHECK(uaudio::conversion::FindAudibleFrames(samples_24.data(), static_cast<uint32_t>(samples_24.size()), uaudio::WAVE_BITS_PER_SAMPLE_24, uaudio::WAVE_CHANNELS_MONO, -60.0f, first_frame, end_frame));
+		CHECK(first_frame == 9);
+		CHECK(end_frame == 36);
+
+		// 32-bit 5.1, the frames count as a whole.
+		std::vector<float> samples_32(17 * uaudio::WAVE_CHANNELS_5_1, 0.0005f);
+		samples_32[3 * 6 + 5] = -0.5f;
+		samples_32[12 * 6] = 0.001f;
+		CHECK(uaudio::conversion::FindAudibleFrames(reinterpret_cast<const unsigned char *>(samples_32.data()), static_cast<uint32_t>(samples_32.size() * sizeof(float)), uaudio::WAVE_BITS_PER_SAMPLE_32, uaudio::WAVE_CHANNELS_5_1, -60.0f, first_frame, end_frame));
+		CHECK(first_frame == 3);
+		CHECK(end_frame == 13);
+
+		// Silence everywhere.
+		CHECK(!uaudio::conversion::FindAudibleFrames(reinterpret_cast<const unsigned char *>(samples_32.data()), static_cast<uint32_t>(samples_32.size() * sizeof(float)), uaudio::WAVE_BITS_PER_SAMPLE_32, uaudio::WAVE_CHANNELS_5_1, 0.0f, first_frame, end_frame));
+		CHECK(first_frame == 0);
+		CHECK(end_frame == 0);
+
+		uaudio::logger::log_success("%s[SILENCE DETECTION]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Trim")
+	{
+		uaudio::logger::log_info("%s[SILENCE TRIM]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// 100 frames of 16-bit mono, loud from frame 20 up to frame 70.
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_MONO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_44100;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		fmt_chunk.blockAlign = sizeof(int16_t);
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+
+		std::vector<int16_t> samples(100, 0);
+		for (uint32_t i = 20; i < 70; i++)
+			samples[i] = static_cast<int16_t>(1000 + i);
+
+		// Two loops (the first one goes past the loud frames) and two cue points.
+		uint32_t smpl_chunk[9 + 2 * 6] = {};
+		smpl_chunk[7] = 2;
+		const uint32_t loops[2][6] = {{0, 0, 10, 80, 0, 0}, {1, 0, 30, 39, 0, 0}};
+		memcpy(&smpl_chunk[9], loops, sizeof(loops));
+
+		uint32_t cue_chunk[1 + 2 * 6] = {};
+		cue_chunk[0] = 2;
+		cue_chunk[1 + 1] = 25;
+		cue_chunk[1 + 5] = 25;
+		cue_chunk[1 + 6 + 1] = 5;
+		cue_chunk[1 + 6 + 5] = 5;
+
+		const uint32_t fact_chunk = 100;
+
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		add_chunk(wave_format, uaudio::SMPL_CHUNK_ID, smpl_chunk, sizeof(smpl_chunk));
+		add_chunk(wave_format, uaudio::CUE_CHUNK_ID, cue_chunk, sizeof(cue_chunk));
+		add_chunk(wave_format, uaudio::FACT_CHUNK_ID, &fact_chunk, sizeof(fact_chunk));
+
+		uint32_t start_position = 0, end_position = 0;
+		CHECK(wave_format.FindAudibleRange(-60.0f, start_position, end_position));
+		CHECK(start_position == 20 * sizeof(int16_t));
+		CHECK(end_position == 70 * sizeof(int16_t));
+
+		wave_format.Trim(start_position, end_position);
+		CHECK(wave_format.GetChunkSize(uaudio::DATA_CHUNK_ID) == 50 * sizeof(int16_t));
+		const int16_t *data = reinterpret_cast<const int16_t *>(wave_format.GetChunkBuffer(uaudio::DATA_CHUNK_ID));
+		CHECK(data[0] == 1020);
+		CHECK(data[49] == 1069);
+
+		const uaudio::SMPL_Chunk smpl = wave_format.GetChunkFromData<uaudio::SMPL_Chunk>(uaudio::SMPL_CHUNK_ID);
+		CHECK(smpl.samples[0].start == 0);
+		CHECK(smpl.samples[0].end == 49);
+		CHECK(smpl.samples[1].start == 10);
+		CHECK(smpl.samples[1].end == 19);
+
+		const uaudio::CUE_Chunk cue = wave_format.GetChunkFromData<uaudio::CUE_Chunk>(uaudio::CUE_CHUNK_ID);
+		CHECK(cue.cue_points[0].position == 5);
+		CHECK(cue.cue_points[0].sample_offset == 5);
+		CHECK(cue.cue_points[1].position == 0);
+		CHECK(cue.cue_points[1].sample_offset == 0);
+
+		CHECK(wave_format.GetChunkFromData<uaudio::FACT_Chunk>(uaudio::FACT_CHUNK_ID).sample_length == 50);
+
+		// Nothing left to trim.
+		CHECK(wave_format.FindAudibleRange(-60.0f, start_position, end_position));
+		CHECK(start_position == 0);
+		CHECK(end_position == 50 * sizeof(int16_t));
+
+		uaudio::logger::log_success("%s[SILENCE TRIM]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Loudness Normalization")
+{
+	constexpr uint32_t SAMPLE_RATE = uaudio::WAVE_SAMPLE_RATE_48000;
+
+	// Interleaved stereo 16-bit sines, a list of (seconds, volume) parts.
+	const auto make_sine = [](const std::vector<std::pair<uint32_t, float>> &a_Parts)
+	{
+		std::vector<int16_t> samples;
+		for (const auto &part : a_Parts)
+			for (uint32_t i = 0; i < part.first * SAMPLE_RATE; i++)
+			{
+				const float sample = part.second * std::sin(2.0f * 3.14159265f * 1000.0f * static_cast<float>(i) / SAMPLE_RATE);
+				samples.push_back(static_cast<int16_t>(std::lrint(sample * 32767.0f)));
+				samples.push_back(samples.back());
+			}
+		return samples;
+	};
+
+	const auto measure = [](const std::vector<int16_t> &a_Samples, uint32_t a_NumThreads)
+	{
+		return uaudio::effects::MeasureLoudness(reinterpret_cast<const unsigned char *>(a_Samples.data()), static_cast<uint32_t>(a_Samples.size() * sizeof(int16_t)), uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_SPEAKERS_STEREO, SAMPLE_RATE, a_NumThreads);
+	};
+
+	SUBCASE("Integrated loudness")
+	{
+		uaudio::logger::log_info("%s[LOUDNESS INTEGRATED]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A 1kHz sine in both channels is as loud (in LUFS) as its peak (in dBFS).
+		const std::vector<int16_t> sine = make_sine({{5, 0.1f}});
+		uaudio::effects::LoudnessMeasurement measurement = measure(sine, 1);
+		CHECK(measurement.integrated == doctest::Approx(-20.0f).epsilon(0.005));
+		CHECK(measurement.maxMomentary == doctest::Approx(-20.0f).epsilon(0.005));
+		CHECK(measurement.maxShortTerm == doctest::Approx(-20.0f).epsilon(0.005));
+		CHECK(measurement.range == doctest::Approx(0.0f).epsilon(0.01));
+
+		// Silence falls below the absolute gate and a part that is 30 LU quieter below the relative gate (without the gates it would be -26 LUFS).
+		// The blocks that overlap the edges of the loud part pull it down a little.
+		measurement = measure(make_sine({{5, 0.0f}, {5, 0.1f}, {5, 0.0f}, {5, 0.00316f}}), 1);
+		CHECK(measurement.integrated == doctest::Approx(-20.0f).epsilon(0.02));
+
+		// A sound that is quieter for a while has a loudness range.
+		measurement = measure(make_sine({{10, 0.1f}, {10, 0.0316f}}), 1);
+		CHECK(measurement.range == doctest::Approx(10.0f).epsilon(0.05));
+
+		// An empty sound does not have a single block.
+		measurement = measure(make_sine({{0, 0.0f}}), 1);
+		CHECK(measurement.integrated == uaudio::effects::METER_SILENCE);
+
+		uaudio::logger::log_success("%s[LOUDNESS INTEGRATED]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("True peak")
+	{
+		uaudio::logger::log_info("%s[LOUDNESS TRUE PEAK]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A sine at a quarter of the sample rate, sampled 45 degrees away from its peaks (every sample is 3dB below the peak).
+		std::vector<float> samples(SAMPLE_RATE);
+		for (uint32_t i = 0; i < SAMPLE_RATE; i++)
+			samples[i] = std::sin(3.14159265f / 2.0f * static_cast<float>(i % 4) + 3.14159265f / 4.0f);
+		const uaudio::effects::LoudnessMeasurement measurement = uaudio::effects::MeasureLoudness(reinterpret_cast<const unsigned char *>(samples.data()), static_cast<uint32_t>(samples.size() * sizeof(float)), uaudio::WAVE_BITS_PER_SAMPLE_32, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_SPEAKERS_MONO, SAMPLE_RATE, 1);
+		CHECK(uaudio::effects::GetDecibels(*std::max_element(samples.begin(), samples.end())) == doctest::Approx(-3.01f).epsilon(0.01));
+		CHECK(measurement.truePeak > -0.5f);
+		CHECK(measurement.truePeak < 0.5f);
+
+		// Silence has no peak.
+		std::fill(samples.begin(), samples.end(), 0.0f);
+		CHECK(std::isinf(uaudio::effects::MeasureLoudness(reinterpret_cast<const unsigned char *>(samples.data()), static_cast<uint32_t>(samples.size() * sizeof(float)), uaudio::WAVE_BITS_PER_SAMPLE_32, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_SPEAKERS_MONO, SAMPLE_RATE, 1).truePeak));
+
+		uaudio::logger::log_success("%s[LOUDNESS TRUE PEAK]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Threads")
+	{
+		uaudio::logger::log_info("%s[LOUDNESS THREADS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The parts get split at every thread, the result has to be the same as with a single thread.
+		const std::vector<int16_t> samples = make_sine({{17, 0.1f}, {13, 0.5f}, {11, 0.02f}, {20, 0.0f}, {19, 0.3f}});
+		const uaudio::effects::LoudnessMeasurement single = measure(samples, 1);
+		for (const uint32_t num_threads : {2u, 3u, 8u})
+		{
+			const uaudio::effects::LoudnessMeasurement multi = measure(samples, num_threads);
+			CHECK(multi.integrated == doctest::Approx(single.integrated).epsilon(0.0001));
+			CHECK(multi.range == doctest::Approx(single.range).epsilon(0.0001));
+			CHECK(multi.maxMomentary == doctest::Approx(single.maxMomentary).epsilon(0.0001));
+			CHECK(multi.truePeak == single.truePeak);
+		}
+
+		uaudio::logger::log_success("%s[LOUDNESS THREADS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Gain")
+	{
+		uaudio::logger::log_info("%s[LOUDNESS GAIN]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::effects::LoudnessMeasurement measurement;
+		measurement.integrated = -20.0f;
+		measurement.truePeak = -10.0f;
+		CHECK(uaudio::effects::GetNormalizationGain(measurement, -23.0f, -1.0f) == doctest::Approx(std::pow(10.0f, -3.0f / 20.0f)));
+
+		// Raising it by 14dB would take the true peak above -1 dBTP, so it only gets raised by 9dB.
+		CHECK(uaudio::effects::GetNormalizationGain(measurement, -6.0f, -1.0f) == doctest::Approx(std::pow(10.0f, 9.0f / 20.0f)));
+
+		// Silence stays as it is.
+		CHECK(uaudio::effects::GetNormalizationGain(uaudio::effects::LoudnessMeasurement(), -23.0f, -1.0f) == 1.0f);
+
+		uaudio::logger::log_success("%s[LOUDNESS GAIN]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Bext")
+	{
+		uaudio::logger::log_info("%s[LOUDNESS BEXT]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.sampleRate = SAMPLE_RATE;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+
+		const std::vector<int16_t> samples = make_sine({{1, 0.1f}});
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+
+		// A format without a bext chunk gets one.
+		const uaudio::effects::LoudnessMeasurement measurement = measure(samples, 1);
+		CHECK(uaudio::WaveReader::SaveSound("loudness.wav", wave_format, &measurement) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		uaudio::WaveConfig config;
+		config.chunksToLoad.push_back(uaudio::BEXT_CHUNK_ID);
+		uaudio::WaveFormat loaded;
+		FILE *file = nullptr;
+		CHECK(uaudio::WaveReader::LoadSound("loudness.wav", loaded, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		remove("loudness.wav");
+
+		REQUIRE(loaded.HasChunk(uaudio::BEXT_CHUNK_ID));
+		const uaudio::BEXT_Chunk bext_chunk = loaded.GetChunkFromData<uaudio::BEXT_Chunk>(uaudio::BEXT_CHUNK_ID);
+		CHECK(bext_chunk.version == 2);
+		CHECK(static_cast<int16_t>(bext_chunk.loudness_value) == static_cast<int16_t>(std::lround(measurement.integrated * 100.0f)));
+		CHECK(static_cast<int16_t>(bext_chunk.loudness_value) == doctest::Approx(-2000).epsilon(0.005));
+		CHECK(static_cast<int16_t>(bext_chunk.max_true_peak_level) == static_cast<int16_t>(std::lround(measurement.truePeak * 100.0f)));
+		CHECK(loaded.GetChunkSize(uaudio::DATA_CHUNK_ID) == samples.size() * sizeof(int16_t));
+
+		uaudio::logger::log_success("%s[LOUDNESS BEXT]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Denormals")
+{
+	SUBCASE("Flush to zero")
+	{
+		uaudio::logger::log_info("%s[DENORMALS FLUSH TO ZERO]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Volatile, so the compiler does not calculate it.
+		volatile float smallest = std::numeric_limits<float>::min();
+		const bool flushing = uaudio::utils::DenormalGuard::IsFlushing();
+		{
+			uaudio::utils::DenormalGuard denormal_guard;
+			CHECK(uaudio::utils::DenormalGuard::IsFlushing());
+			CHECK(smallest * 0.5f == 0.0f);
+
+			// A guard inside a guard leaves the mode alone.
+			{
+				uaudio::utils::DenormalGuard inner_guard;
+			}
+			CHECK(uaudio::utils::DenormalGuard::IsFlushing());
+		}
+		CHECK(uaudio::utils::DenormalGuard::IsFlushing() == flushing);
+
+		// A disabled guard does nothing.
+		if (!flushing)
+		{
+			uaudio::utils::DenormalGuard denormal_guard(false);
+			CHECK(!uaudio::utils::DenormalGuard::IsFlushing());
+			CHECK(smallest * 0.5f > 0.0f);
+		}
+
+		uaudio::logger::log_success("%s[DENORMALS FLUSH TO ZERO]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Filter tails")
+	{
+		uaudio::logger::log_info("%s[DENORMALS FILTER TAILS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A loud block and then a minute of silence, without flushing: the filters of the meter keep their state above the denormals.
+		uaudio::utils::DenormalGuard denormal_guard(false);
+		constexpr uint32_t SAMPLE_RATE = uaudio::WAVE_SAMPLE_RATE_48000;
+		std::vector<float> samples(SAMPLE_RATE / 10 * uaudio::WAVE_CHANNELS_STEREO, 0.0f);
+		for (size_t i = 0; i < samples.size(); i++)
+			samples[i] = std::sin(static_cast<float>(i) * 0.3f);
+
+		uaudio::effects::Meter meter;
+		meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_SPEAKERS_STEREO);
+		meter.Process(samples.data(), static_cast<uint32_t>(samples.size()));
+		std::fill(samples.begin(), samples.end(), 0.0f);
+		for (uint32_t i = 0; i < 600; i++)
+			meter.Process(samples.data(), static_cast<uint32_t>(samples.size()));
+
+		// The readings do not include the guard signal.
+		CHECK(meter.GetLast().momentary == uaudio::effects::METER_SILENCE);
+		CHECK(meter.GetLast().peak[0] == 0.0f);
+		CHECK(meter.GetLast().rms[0] == 0.0f);
+		CHECK(std::fpclassify(meter.GetLast().energy) == FP_NORMAL);
+
+		uaudio::logger::log_success("%s[DENORMALS FILTER TAILS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Streaming")
+{
+	// Interleaved stereo 16-bit frames that tell where they are (the low and the high half of the frame index).
+	constexpr uint32_t NUM_FRAMES = 200000;
+	constexpr uint32_t BLOCK_ALIGN = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+	std::vector<uint16_t> samples(NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO);
+	for (uint32_t i = 0; i < NUM_FRAMES; i++)
+	{
+		samples[i * 2] = static_cast<uint16_t>(i & 0xFFFF);
+		samples[i * 2 + 1] = static_cast<uint16_t>(i >> 16);
+	}
+
+	uaudio::FMT_Chunk fmt_chunk(nullptr);
+	fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+	fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+	fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_44100;
+	fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+	fmt_chunk.blockAlign = BLOCK_ALIGN;
+	fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+
+	uaudio::WaveFormat wave_format;
+	add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+	add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(uint16_t)));
+	REQUIRE(uaudio::WaveReader::SaveSound("stream.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+	uaudio::WaveConfig config;
+	config.stream = true;
+	uaudio::WaveFile wave_file("stream.wav", config);
+
+	// The frame at a position in the data.
+	const auto frame_at = [](const std::vector<unsigned char> &a_Data, uint32_t a_Position)
+	{
+		uint16_t low = 0, high = 0;
+		memcpy(&low, a_Data.data() + a_Position, sizeof(low));
+		memcpy(&high, a_Data.data() + a_Position + sizeof(low), sizeof(high));
+		return static_cast<uint32_t>(low) | (static_cast<uint32_t>(high) << 16);
+	};
+
+	SUBCASE("Loading")
+	{
+		uaudio::logger::log_info("%s[STREAMING LOADING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Only the header is in memory.
+		CHECK(wave_file.IsStreaming());
+		CHECK(!wave_file.GetWaveFormat().HasChunk(uaudio::DATA_CHUNK_ID));
+		CHECK(wave_file.GetWaveFormat().GetDataSize() == NUM_FRAMES * BLOCK_ALIGN);
+		CHECK(wave_file.GetEndPosition() == NUM_FRAMES * BLOCK_ALIGN);
+
+		// Saving copies the data from the file (but not over the file itself).
+		CHECK(uaudio::WaveReader::SaveSound("stream.wav", wave_file.GetWaveFormat()) == uaudio::WAVE_SAVING_STATUS::STATUS_FAILED_OPENING_FILE);
+		CHECK(uaudio::WaveReader::SaveSound("stream_copy.wav", wave_file.GetWaveFormat()) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+		uaudio::WaveFormat loaded;
+		FILE *file = nullptr;
+		CHECK(uaudio::WaveReader::LoadSound("stream_copy.wav", loaded, file) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		remove("stream_copy.wav");
+		REQUIRE(loaded.GetChunkSize(uaudio::DATA_CHUNK_ID) == NUM_FRAMES * BLOCK_ALIGN);
+		CHECK(memcmp(loaded.GetChunkBuffer(uaudio::DATA_CHUNK_ID), samples.data(), NUM_FRAMES * BLOCK_ALIGN) == 0);
+
+		uaudio::logger::log_success("%s[STREAMING LOADING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Playback")
+	{
+		uaudio::logger::log_info("%s[STREAMING PLAYBACK]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Without a thread the owner fills the streams, here after every buffer.
+		uaudio::Streamer streamer(2, false);
+		const uaudio::StreamHandle stream = streamer.Open(wave_file);
+		REQUIRE(stream.IsValid());
+		CHECK(streamer.StreamSize() == 1);
+
+		std::vector<unsigned char> played;
+		std::vector<unsigned char> buffer(8192);
+		uint32_t position = 0;
+		while (!streamer.IsFinished(stream))
+		{
+			const uint32_t size = streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position);
+			played.insert(played.end(), buffer.begin(), buffer.begin() + size);
+			CHECK(position == played.size());
+			streamer.Update();
+		}
+		REQUIRE(played.size() == NUM_FRAMES * BLOCK_ALIGN);
+		CHECK(memcmp(played.data(), samples.data(), played.size()) == 0);
+		CHECK(streamer.GetUnderruns(stream) == 0);
+
+		// A finished stream has nothing left.
+		CHECK(streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position) == 0);
+		CHECK(streamer.GetUnderruns(stream) == 0);
+
+		streamer.Close(stream);
+		CHECK(streamer.StreamSize() == 0);
+
+		uaudio::logger::log_success("%s[STREAMING PLAYBACK]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Seek and loop")
+	{
+		uaudio::logger::log_info("%s[STREAMING SEEK AND LOOP]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::Streamer streamer(1, false);
+		std::vector<unsigned char> buffer(4000);
+		uint32_t position = 0;
+
+		// A loop from frame 1000 to frame 150000.
+		wave_file.SetStartPosition(1000 * BLOCK_ALIGN);
+		wave_file.SetEndPosition(150000 * BLOCK_ALIGN);
+		wave_file.SetLooping(true);
+		uaudio::StreamHandle stream = streamer.Open(wave_file);
+		REQUIRE(stream.IsValid());
+
+		// All streams are in use.
+		CHECK(!streamer.Open(wave_file).IsValid());
+
+		CHECK(streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position) == buffer.size());
+		CHECK(frame_at(buffer, 0) == 1000);
+		CHECK(position == 2000 * BLOCK_ALIGN);
+
+		// The blocks that were read ahead get skipped, the first read after the seek waits for the new blocks without an underrun.
+		streamer.Seek(stream, 149500 * BLOCK_ALIGN + 1);
+		CHECK(streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position) == 0);
+		CHECK(position == 149500 * BLOCK_ALIGN);
+		CHECK(streamer.GetUnderruns(stream) == 0);
+		streamer.Update();
+
+		// 500 frames before the end of the loop and 500 after its start.
+		CHECK(streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position) == buffer.size());
+		CHECK(frame_at(buffer, 0) == 149500);
+		CHECK(frame_at(buffer, 499 * BLOCK_ALIGN) == 149999);
+		CHECK(frame_at(buffer, 500 * BLOCK_ALIGN) == 1000);
+		CHECK(position == 1500 * BLOCK_ALIGN);
+		CHECK(!streamer.IsFinished(stream));
+
+		// Without the loop the stream ends at the end position (after the blocks that were read ahead with the loop).
+		streamer.SetLooping(stream, false);
+		streamer.Seek(stream, 140000 * BLOCK_ALIGN);
+		streamer.Update();
+		uint32_t size = 0;
+		while (!streamer.IsFinished(stream))
+		{
+			size += streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position);
+			streamer.Update();
+		}
+		CHECK(size == 10000 * BLOCK_ALIGN);
+		CHECK(position == 150000 * BLOCK_ALIGN);
+
+		streamer.Close(stream);
+		CHECK(streamer.Open(wave_file).IsValid());
+
+		uaudio::logger::log_success("%s[STREAMING SEEK AND LOOP]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Underruns")
+	{
+		uaudio::logger::log_info("%s[STREAMING UNDERRUNS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Nothing fills the stream after it opened, so the reader runs out after the first blocks.
+		uaudio::Streamer streamer(1, false);
+		const uaudio::StreamHandle stream = streamer.Open(wave_file);
+		std::vector<unsigned char> buffer(UAUDIO_DEFAULT_STREAM_BLOCK_SIZE * UAUDIO_DEFAULT_STREAM_BLOCKS + 1000 * BLOCK_ALIGN);
+		uint32_t position = 0;
+		CHECK(streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position) == UAUDIO_DEFAULT_STREAM_BLOCK_SIZE * UAUDIO_DEFAULT_STREAM_BLOCKS);
+		CHECK(streamer.GetUnderruns(stream) == 1);
+		CHECK(streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position) == 0);
+		CHECK(streamer.GetUnderruns() == 2);
+		CHECK(!streamer.IsFinished(stream));
+
+		// The stream carries on where it was once the blocks are there.
+		streamer.Update();
+		CHECK(streamer.Read(stream, buffer.data(), BLOCK_ALIGN, position) == BLOCK_ALIGN);
+		CHECK(frame_at(buffer, 0) == UAUDIO_DEFAULT_STREAM_BLOCK_SIZE * UAUDIO_DEFAULT_STREAM_BLOCKS / BLOCK_ALIGN);
+
+		uaudio::logger::log_success("%s[STREAMING UNDERRUNS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Threaded")
+	{
+		uaudio::logger::log_info("%s[STREAMING THREADED]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Two streams of the same sound at once, read the way the audio thread does (the I/O thread wakes up when a block has been played).
+		uaudio::Streamer streamer;
+		const uaudio::StreamHandle streams[] = {streamer.Open(wave_file), streamer.Open(wave_file)};
+		std::vector<unsigned char> played[2];
+		std::vector<unsigned char> buffer(8192);
+		uint32_t position = 0;
+		while (!streamer.IsFinished(streams[0]) || !streamer.IsFinished(streams[1]))
+		{
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				const uint32_t size = streamer.Read(streams[i], buffer.data(), static_cast<uint32_t>(buffer.size()), position);
+				played[i].insert(played[i].end(), buffer.begin(), buffer.begin() + size);
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			REQUIRE(played[i].size() == NUM_FRAMES * BLOCK_ALIGN);
+			CHECK(memcmp(played[i].data(), samples.data(), played[i].size()) == 0);
+			streamer.Close(streams[i]);
+		}
+
+		uaudio::logger::log_success("%s[STREAMING THREADED]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Seeking from another thread")
+	{
+		uaudio::logger::log_info("%s[STREAMING SEEKING FROM ANOTHER THREAD]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The game thread seeks while the audio thread reads, every read still gets frames that follow each other from one position.
+		uaudio::Streamer streamer;
+		const uaudio::StreamHandle stream = streamer.Open(wave_file);
+		REQUIRE(stream.IsValid());
+		std::atomic<bool> seeking{true};
+		std::thread game_thread([&streamer, &stream, &seeking, BLOCK_ALIGN]()
+		{
+			for (uint32_t i = 0; i < 200; i++)
+			{
+				streamer.Seek(stream, (i * 997) % (NUM_FRAMES / 2) * BLOCK_ALIGN);
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+			seeking = false;
+		});
+
+		std::vector<unsigned char> buffer(256 * BLOCK_ALIGN);
+		uint32_t position = 0;
+		bool contiguous = true;
+		while (seeking)
+		{
+			const uint32_t size = streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position);
+			for (uint32_t i = BLOCK_ALIGN; i < size; i += BLOCK_ALIGN)
+				contiguous &= frame_at(buffer, i) == frame_at(buffer, i - BLOCK_ALIGN) + 1;
+			if (size > 0)
+				contiguous &= position == frame_at(buffer, 0) * BLOCK_ALIGN + size;
+		}
+		game_thread.join();
+		CHECK(contiguous);
+
+		// The last seek is where the reader carries on.
+		streamer.Seek(stream, 5000 * BLOCK_ALIGN);
+		uint32_t size = 0;
+		while (size == 0)
+		{
+			size = streamer.Read(stream, buffer.data(), static_cast<uint32_t>(buffer.size()), position);
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		CHECK(frame_at(buffer, 0) == 5000);
+		streamer.Close(stream);
+
+		uaudio::logger::log_success("%s[STREAMING SEEKING FROM ANOTHER THREAD]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+
+	remove("stream.wav");
+}
+
+TEST_CASE("Memory Mapping")
+{
+	// A second of stereo 16-bit noise with a smpl chunk.
+	constexpr uint32_t NUM_FRAMES = uaudio::WAVE_SAMPLE_RATE_44100;
+	std::vector<int16_t> samples(NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO);
+	for (size_t i = 0; i < samples.size(); i++)
+		samples[i] = static_cast<int16_t>((i * 7919) % 65536 - 32768);
+
+	uaudio::FMT_Chunk fmt_chunk(nullptr);
+	fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+	fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+	fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_44100;
+	fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+	fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+	fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+
+	uint32_t smpl_chunk[9 + 6] = {};
+	smpl_chunk[7] = 1;
+	const uint32_t loop[6] = {0, 0, 100, 40000, 0, 0};
+	memcpy(&smpl_chunk[9], loop, sizeof(loop));
+
+	uaudio::WaveFormat wave_format;
+	add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+	add_chunk(wave_format, uaudio::SMPL_CHUNK_ID, smpl_chunk, sizeof(smpl_chunk));
+	add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+	REQUIRE(uaudio::WaveReader::SaveSound("mapped.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+	uaudio::WaveConfig config;
+	config.memoryMap = true;
+	config.chunksToLoad.push_back(uaudio::SMPL_CHUNK_ID);
+
+	SUBCASE("Chunks")
+	{
+		uaudio::logger::log_info("%s[MEMORY MAPPING CHUNKS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::WaveFormat mapped;
+		FILE *file = nullptr;
+		CHECK(uaudio::WaveReader::LoadSound("mapped.wav", mapped, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		CHECK(mapped.IsMapped());
+		REQUIRE(mapped.GetChunkSize(uaudio::DATA_CHUNK_ID) == samples.size() * sizeof(int16_t));
+		CHECK(memcmp(mapped.GetChunkBuffer(uaudio::DATA_CHUNK_ID), samples.data(), samples.size() * sizeof(int16_t)) == 0);
+		CHECK(mapped.GetChunkFromData<uaudio::SMPL_Chunk>(uaudio::SMPL_CHUNK_ID).samples[0].end == 40000);
+		mapped.Prefetch(0, UAUDIO_DEFAULT_PREFETCH_SIZE);
+
+		// Copies point at the same pages and keep them after the original is gone.
+		uaudio::WaveFormat *original = new uaudio::WaveFormat(mapped);
+		uaudio::WaveFormat copy(*original);
+		uaudio::WaveFormat assigned;
+		assigned = *original;
+		CHECK(copy.GetChunkBuffer(uaudio::DATA_CHUNK_ID) == mapped.GetChunkBuffer(uaudio::DATA_CHUNK_ID));
+		CHECK(assigned.GetChunkBuffer(uaudio::DATA_CHUNK_ID) == mapped.GetChunkBuffer(uaudio::DATA_CHUNK_ID));
+		delete original;
+		mapped = uaudio::WaveFormat();
+		CHECK(!mapped.IsMapped());
+		CHECK(memcmp(copy.GetChunkBuffer(uaudio::DATA_CHUNK_ID), samples.data(), samples.size() * sizeof(int16_t)) == 0);
+
+		uaudio::logger::log_success("%s[MEMORY MAPPING CHUNKS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Conversion")
+	{
+		uaudio::logger::log_info("%s[MEMORY MAPPING CONVERSION]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The converted data gets allocated, the loop points change in the private pages (the file stays the same).
+		config.sampleRate = uaudio::WAVE_SAMPLE_RATE_88200;
+		uaudio::WaveFormat converted;
+		FILE *file = nullptr;
+		CHECK(uaudio::WaveReader::LoadSound("mapped.wav", converted, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		CHECK(!converted.IsMapped());
+		CHECK(converted.GetChunkSize(uaudio::DATA_CHUNK_ID) == samples.size() * sizeof(int16_t) * 2);
+		CHECK(converted.GetChunkFromData<uaudio::SMPL_Chunk>(uaudio::SMPL_CHUNK_ID).samples[0].end == 80000);
+
+		uaudio::WaveFormat loaded;
+		CHECK(uaudio::WaveReader::LoadSound("mapped.wav", loaded, file, uaudio::WaveConfig()) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		CHECK(loaded.GetChunkFromData<uaudio::FMT_Chunk>(uaudio::FMT_CHUNK_ID).sampleRate == uaudio::WAVE_SAMPLE_RATE_44100);
+
+		uaudio::logger::log_success("%s[MEMORY MAPPING CONVERSION]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Missing file")
+	{
+		uaudio::logger::log_info("%s[MEMORY MAPPING MISSING FILE]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::WaveFormat missing;
+		FILE *file = nullptr;
+		CHECK(uaudio::WaveReader::LoadSound("missing.wav", missing, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_FAILED_OPENING_FILE);
+		CHECK(!missing.IsMapped());
+
+		uaudio::logger::log_success("%s[MEMORY MAPPING MISSING FILE]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+
+	remove("mapped.wav");
+}
+
+TEST_CASE("Async Loading")
+{
+	// Ten seconds of stereo 16-bit noise.
+	constexpr uint32_t NUM_FRAMES = uaudio::WAVE_SAMPLE_RATE_44100 * 10;
+	std::vector<int16_t> samples(NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO);
+	for (size_t i = 0; i < samples.size(); i++)
+		samples[i] = static_cast<int16_t>((i * 7919) % 65536 - 32768);
+
+	uaudio::FMT_Chunk fmt_chunk(nullptr);
+	fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+	fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+	fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_44100;
+	fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+	fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+	fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+
+	uaudio::WaveFormat wave_format;
+	add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+	add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+	REQUIRE(uaudio::WaveReader::SaveSound("async.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+	// The callbacks write down the order in which the loads were over.
+	struct LoadRecord
+	{
+		std::vector<uaudio::UAUDIO_DEFAULT_HASH> hashes;
+		std::vector<uaudio::LOAD_STATUS> statuses;
+	};
+	const uaudio::LoadCallback record_load = [](uaudio::LoadHandle, uaudio::UAUDIO_DEFAULT_HASH a_Hash, uaudio::LOAD_STATUS a_Status, void *a_UserData)
+	{
+		LoadRecord *record = static_cast<LoadRecord *>(a_UserData);
+		record->hashes.push_back(a_Hash);
+		record->statuses.push_back(a_Status);
+	};
+
+	SUBCASE("Loading")
+	{
+		uaudio::logger::log_info("%s[ASYNC LOADING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::SoundSystem sound_system(2);
+		const uaudio::LoadHandle load = sound_system.LoadSoundAsync("async.wav", "async", uaudio::WaveConfig());
+		CHECK(sound_system.GetLoadHash(load) == uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("async"));
+		sound_system.WaitForLoads();
+		CHECK(sound_system.LoadSize() == 0);
+		CHECK(sound_system.GetLoadStatus(load) == uaudio::LOAD_STATUS::LOAD_STATUS_DONE);
+
+		// The sound only shows up after Update.
+		CHECK(!sound_system.DoesSoundExist(uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("async")));
+		CHECK(sound_system.Update() == 1);
+		CHECK(sound_system.Update() == 0);
+		uaudio::WaveFile *wave_file = sound_system.FindSound(uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("async"));
+		REQUIRE(wave_file != nullptr);
+		CHECK(wave_file->GetWaveFormat().GetDataSize() == samples.size() * sizeof(int16_t));
+		CHECK(memcmp(wave_file->GetWaveFormat().GetChunkBuffer(uaudio::DATA_CHUNK_ID), samples.data(), samples.size() * sizeof(int16_t)) == 0);
+
+		// Update is done with the load, so it is gone.
+		CHECK(sound_system.GetLoadStatus(load) == uaudio::LOAD_STATUS::LOAD_STATUS_INVALID);
+		CHECK(sound_system.GetLoadHash(load) == 0);
+		CHECK(sound_system.GetLoadStatus(uaudio::LoadHandle(100)) == uaudio::LOAD_STATUS::LOAD_STATUS_INVALID);
+
+		uaudio::logger::log_success("%s[ASYNC LOADING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Priorities")
+	{
+		uaudio::logger::log_info("%s[ASYNC LOADING PRIORITIES]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// One worker, which is busy with the first (converted) load while the others get queued.
+		uaudio::SoundSystem sound_system(1);
+		uaudio::WaveConfig config;
+		config.sampleRate = uaudio::WAVE_SAMPLE_RATE_88200;
+		LoadRecord record;
+		const uaudio::LoadHandle first = sound_system.LoadSoundAsync("async.wav", "first", config, uaudio::LOAD_PRIORITY::LOAD_PRIORITY_LOW, record_load, &record);
+		while (sound_system.GetLoadStatus(first) == uaudio::LOAD_STATUS::LOAD_STATUS_QUEUED)
+			std::this_thread::yield();
+		sound_system.LoadSoundAsync("async.wav", "low", uaudio::WaveConfig(), uaudio::LOAD_PRIORITY::LOAD_PRIORITY_LOW, record_load, &record);
+		sound_system.LoadSoundAsync("async.wav", "normal", uaudio::WaveConfig(), uaudio::LOAD_PRIORITY::LOAD_PRIORITY_NORMAL, record_load, &record);
+		sound_system.LoadSoundAsync("async.wav", "high", uaudio::WaveConfig(), uaudio::LOAD_PRIORITY::LOAD_PRIORITY_HIGH, record_load, &record);
+		sound_system.WaitForLoads();
+		CHECK(sound_system.Update() == 4);
+
+		REQUIRE(record.hashes.size() == 4);
+		CHECK(record.hashes[0] == uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("first"));
+		CHECK(record.hashes[1] == uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("high"));
+		CHECK(record.hashes[2] == uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("normal"));
+		CHECK(record.hashes[3] == uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("low"));
+		CHECK(sound_system.SoundSize() == 4);
+		CHECK(sound_system.FindSound(uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("first"))->GetWaveFormat().GetDataSize() == samples.size() * sizeof(int16_t) * 2);
+
+		uaudio::logger::log_success("%s[ASYNC LOADING PRIORITIES]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Cancel")
+	{
+		uaudio::logger::log_info("%s[ASYNC LOADING CANCEL]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::SoundSystem sound_system(1);
+		uaudio::WaveConfig config;
+		config.sampleRate = uaudio::WAVE_SAMPLE_RATE_88200;
+		LoadRecord record;
+		const uaudio::LoadHandle first = sound_system.LoadSoundAsync("async.wav", "first", config, uaudio::LOAD_PRIORITY::LOAD_PRIORITY_NORMAL, record_load, &record);
+		const uaudio::LoadHandle second = sound_system.LoadSoundAsync("async.wav", "second", uaudio::WaveConfig(), uaudio::LOAD_PRIORITY::LOAD_PRIORITY_NORMAL, record_load, &record);
+
+		// Both can be cancelled, whether the worker has started on them or not.
+		CHECK(sound_system.CancelLoad(second));
+		CHECK(!sound_system.CancelLoad(second));
+		CHECK(sound_system.CancelLoad(first));
+		sound_system.WaitForLoads();
+		CHECK(sound_system.GetLoadStatus(first) == uaudio::LOAD_STATUS::LOAD_STATUS_CANCELLED);
+		CHECK(sound_system.GetLoadStatus(second) == uaudio::LOAD_STATUS::LOAD_STATUS_CANCELLED);
+		CHECK(sound_system.Update() == 2);
+		CHECK(sound_system.SoundSize() == 0);
+		CHECK(sound_system.GetLoadStatus(first) == uaudio::LOAD_STATUS::LOAD_STATUS_INVALID);
+		CHECK(sound_system.GetLoadStatus(second) == uaudio::LOAD_STATUS::LOAD_STATUS_INVALID);
+		REQUIRE(record.statuses.size() == 2);
+		CHECK(record.statuses[0] == uaudio::LOAD_STATUS::LOAD_STATUS_CANCELLED);
+		CHECK(record.statuses[1] == uaudio::LOAD_STATUS::LOAD_STATUS_CANCELLED);
+
+		// A load that was moved into the sounds can not be cancelled anymore.
+		const uaudio::LoadHandle third = sound_system.LoadSoundAsync("async.wav", "third", uaudio::WaveConfig());
+		sound_system.WaitForLoads();
+		sound_system.Update();
+		CHECK(!sound_system.CancelLoad(third));
+		CHECK(sound_system.DoesSoundExist(uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("third")));
+
+		uaudio::logger::log_success("%s[ASYNC LOADING CANCEL]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Missing file")
+	{
+		uaudio::logger::log_info("%s[ASYNC LOADING MISSING FILE]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::SoundSystem sound_system(1);
+		LoadRecord record;
+		const uaudio::LoadHandle load = sound_system.LoadSoundAsync("missing.wav", "missing", uaudio::WaveConfig(), uaudio::LOAD_PRIORITY::LOAD_PRIORITY_NORMAL, record_load, &record);
+		sound_system.WaitForLoads();
+		CHECK(sound_system.GetLoadStatus(load) == uaudio::LOAD_STATUS::LOAD_STATUS_FAILED);
+		CHECK(sound_system.Update() == 1);
+		CHECK(sound_system.GetLoadStatus(load) == uaudio::LOAD_STATUS::LOAD_STATUS_INVALID);
+		CHECK(!sound_system.DoesSoundExist(uaudio::UAUDIO_DEFAULT_HASH_FUNCTION("missing")));
+		REQUIRE(record.statuses.size() == 1);
+		CHECK(record.statuses[0] == uaudio::LOAD_STATUS::LOAD_STATUS_FAILED);
+
+		uaudio::logger::log_success("%s[ASYNC LOADING MISSING FILE]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Shutdown")
+	{
+		uaudio::logger::log_info("%s[ASYNC LOADING SHUTDOWN]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::WaveConfig config;
+		config.sampleRate = uaudio::WAVE_SAMPLE_RATE_88200;
+
+		// How long one (converted) load takes.
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		{
+			uaudio::SoundSystem sound_system(1);
+			sound_system.LoadSoundAsync("async.wav", "single", config);
+			sound_system.WaitForLoads();
+		}
+		const std::chrono::steady_clock::duration single_load = std::chrono::steady_clock::now() - start;
+
+		// The queued loads get cancelled, only the one that the worker is busy with gets waited for.
+		constexpr uint32_t NUM_LOADS = 16;
+		LoadRecord record;
+		start = std::chrono::steady_clock::now();
+		{
+			uaudio::SoundSystem sound_system(1);
+			for (uint32_t i = 0; i < NUM_LOADS; i++)
+				sound_system.LoadSoundAsync("async.wav", ("shutdown" + std::to_string(i)).c_str(), config, uaudio::LOAD_PRIORITY::LOAD_PRIORITY_NORMAL, record_load, &record);
+		}
+		const std::chrono::steady_clock::duration shutdown = std::chrono::steady_clock::now() - start;
+		CHECK(shutdown < single_load * (NUM_LOADS / 4));
+		CHECK(record.hashes.empty());
+
+		uaudio::logger::log_success("%s[ASYNC LOADING SHUTDOWN]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+
+	remove("async.wav");
+}
+
+TEST_CASE("Batch Loading")
+{
+	// Eight short 16-bit stereo sounds of different lengths.
+	constexpr uint32_t NUM_SOUNDS = 8;
+	uaudio::FMT_Chunk fmt_chunk(nullptr);
+	fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+	fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+	fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+	fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+	fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+	fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+
+	std::vector<std::vector<int16_t>> sounds(NUM_SOUNDS);
+	std::vector<std::string> paths(NUM_SOUNDS);
+	for (uint32_t i = 0; i < NUM_SOUNDS; i++)
+	{
+		sounds[i].resize((i + 1) * 4800 * uaudio::WAVE_CHANNELS_STEREO);
+		for (size_t j = 0; j < sounds[i].size(); j++)
+			sounds[i][j] = static_cast<int16_t>((j * 7919 + i) % 65536 - 32768);
+
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, sounds[i].data(), static_cast<uint32_t>(sounds[i].size() * sizeof(int16_t)));
+		paths[i] = "batch" + std::to_string(i) + ".wav";
+		REQUIRE(uaudio::WaveReader::SaveSound(paths[i].c_str(), wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+	}
+
+	SUBCASE("Manifest")
+	{
+		uaudio::logger::log_info("%s[BATCH LOADING MANIFEST]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		std::vector<uaudio::SoundManifestEntry> manifest;
+		for (uint32_t i = 0; i < NUM_SOUNDS; i++)
+			manifest.push_back({paths[i], "batch" + std::to_string(i), uaudio::WaveConfig()});
+		manifest.push_back({"missing.wav", "missing", uaudio::WaveConfig()});
+
+		uaudio::SoundSystem sound_system;
+		const uaudio::BatchLoadReport report = sound_system.LoadSounds(manifest, 4);
+		CHECK(report.numLoaded == NUM_SOUNDS);
+		CHECK(sound_system.SoundSize() == NUM_SOUNDS);
+		REQUIRE(report.sounds.size() == NUM_SOUNDS + 1);
+		CHECK(!report.sounds[NUM_SOUNDS].loaded);
+		CHECK(!sound_system.DoesSoundExist(uaudio::GetHash("missing")));
+
+		uint64_t total_size = 0;
+		for (uint32_t i = 0; i < NUM_SOUNDS; i++)
+		{
+			const uaudio::SoundLoadReport &sound_report = report.sounds[i];
+			CHECK(sound_report.loaded);
+			CHECK(sound_report.hash == uaudio::GetHash(manifest[i].name.c_str()));
+			CHECK(sound_report.fileSize > sounds[i].size() * sizeof(int16_t));
+			total_size += sound_report.fileSize;
+
+			uaudio::WaveFile *wave_file = sound_system.FindSound(sound_report.hash);
+			REQUIRE(wave_file != nullptr);
+			REQUIRE(wave_file->GetWaveFormat().GetDataSize() == sounds[i].size() * sizeof(int16_t));
+			CHECK(memcmp(wave_file->GetWaveFormat().GetChunkBuffer(uaudio::DATA_CHUNK_ID), sounds[i].data(), sounds[i].size() * sizeof(int16_t)) == 0);
+		}
+		CHECK(report.totalSize == total_size);
+		CHECK(report.megabytesPerSecond > 0.0f);
+
+		// The sounds that were already there stay.
+		const uaudio::BatchLoadReport second_report = sound_system.LoadSounds(manifest, 2);
+		CHECK(second_report.numLoaded == NUM_SOUNDS);
+		CHECK(sound_system.SoundSize() == NUM_SOUNDS);
+
+		uaudio::logger::log_success("%s[BATCH LOADING MANIFEST]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Split conversion")
+	{
+		uaudio::logger::log_info("%s[BATCH LOADING SPLIT CONVERSION]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Twenty seconds of 24-bit quad noise, long enough to get split into parts.
+		std::vector<unsigned char> samples(uaudio::WAVE_SAMPLE_RATE_48000 * 20 * uaudio::WAVE_CHANNELS_QUAD * 3);
+		for (size_t i = 0; i < samples.size(); i++)
+			samples[i] = static_cast<unsigned char>((i * 7919) >> 3);
+
+		uaudio::FMT_Chunk long_fmt_chunk = fmt_chunk;
+		long_fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_QUAD;
+		long_fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		long_fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_QUAD * 3;
+		long_fmt_chunk.byteRate = long_fmt_chunk.sampleRate * long_fmt_chunk.blockAlign;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &long_fmt_chunk, sizeof(long_fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size()));
+		REQUIRE(uaudio::WaveReader::SaveSound("batch_long.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+		CHECK(uaudio::conversion::GetConversionParts(static_cast<uint32_t>(samples.size() / 3), 4) == 4);
+		CHECK(uaudio::conversion::GetConversionParts(1000, 4) == 1);
+
+		// Without dither every part converts the same way one part would.
+		uaudio::WaveConfig config;
+		config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		config.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		config.dither = uaudio::DITHER::DITHER_NONE;
+		uaudio::WaveFormat serial, split;
+		FILE *file = nullptr;
+		CHECK(uaudio::WaveReader::LoadSound("batch_long.wav", serial, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		config.conversionThreads = 4;
+		CHECK(uaudio::WaveReader::LoadSound("batch_long.wav", split, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		REQUIRE(serial.GetDataSize() == samples.size() / 3 / 2 * sizeof(int16_t));
+		REQUIRE(split.GetDataSize() == serial.GetDataSize());
+		CHECK(memcmp(split.GetChunkBuffer(uaudio::DATA_CHUNK_ID), serial.GetChunkBuffer(uaudio::DATA_CHUNK_ID), serial.GetDataSize()) == 0);
+		remove("batch_long.wav");
+
+		uaudio::logger::log_success("%s[BATCH LOADING SPLIT CONVERSION]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+
+	for (const std::string &path : paths)
+		remove(path.c_str());
+}
+
+TEST_CASE("Chunk Scanning")
+{
+	// A file with many small chunks that do not get loaded, a large one that is longer than the first read, and chunks after the data.
+	uaudio::FMT_Chunk fmt_chunk(nullptr);
+	fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+	fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+	fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+	fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+	fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+	fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+
+	std::vector<int16_t> samples(uaudio::WAVE_SAMPLE_RATE_48000 * uaudio::WAVE_CHANNELS_STEREO);
+	for (size_t i = 0; i < samples.size(); i++)
+		samples[i] = static_cast<int16_t>((i * 7919) % 65536 - 32768);
+	std::vector<unsigned char> junk(100000);
+	for (size_t i = 0; i < junk.size(); i++)
+		junk[i] = static_cast<unsigned char>(i * 31);
+	uint32_t smpl_chunk[9 + 6] = {};
+	smpl_chunk[7] = 1;
+	smpl_chunk[9 + 3] = 40000;
+	const unsigned char cue_chunk[28] = {1, 0, 0, 0, 1, 0, 0, 0, 'd', 'a', 't', 'a', 0, 0, 0, 0, 0, 0, 0, 0, 0x40, 0x9C, 0, 0};
+
+	uaudio::WaveFormat wave_format;
+	add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+	for (uint32_t i = 0; i < 30; i++)
+	{
+		const char chunk_id[uaudio::CHUNK_ID_SIZE + 1] = {'j', 'n', static_cast<char>('a' + i / 10), static_cast<char>('0' + i % 10), 0};
+		add_chunk(wave_format, chunk_id, junk.data(), 64 + i * 2);
+	}
+	add_chunk(wave_format, uaudio::SMPL_CHUNK_ID, smpl_chunk, sizeof(smpl_chunk));
+	add_chunk(wave_format, "LIST", junk.data(), static_cast<uint32_t>(junk.size()));
+	add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+	add_chunk(wave_format, "junk", junk.data(), 1000);
+	add_chunk(wave_format, uaudio::CUE_CHUNK_ID, cue_chunk, sizeof(cue_chunk));
+	REQUIRE(uaudio::WaveReader::SaveSound("chunks.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+	SUBCASE("Chunks")
+	{
+		uaudio::logger::log_info("%s[CHUNK SCANNING CHUNKS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::WaveConfig config;
+		config.chunksToLoad.push_back(uaudio::SMPL_CHUNK_ID);
+		config.chunksToLoad.push_back(uaudio::CUE_CHUNK_ID);
+		config.chunksToLoad.push_back("jnc9");
+		uaudio::WaveFormat loaded;
+		FILE *file = nullptr;
+		REQUIRE(uaudio::WaveReader::LoadSound("chunks.wav", loaded, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		CHECK(file == nullptr);
+
+		for (const char *chunk_id : {uaudio::FMT_CHUNK_ID, uaudio::SMPL_CHUNK_ID, uaudio::DATA_CHUNK_ID, uaudio::CUE_CHUNK_ID, "jnc9"})
+		{
+			REQUIRE(loaded.GetChunkSize(chunk_id) == wave_format.GetChunkSize(chunk_id));
+			CHECK(memcmp(loaded.GetChunkBuffer(chunk_id), wave_format.GetChunkBuffer(chunk_id), wave_format.GetChunkSize(chunk_id)) == 0);
+		}
+		CHECK(!loaded.HasChunk("LIST"));
+		CHECK(!loaded.HasChunk("jna0"));
+		CHECK(!loaded.HasChunk("junk"));
+		CHECK(loaded.GetFileSize() > samples.size() * sizeof(int16_t) + junk.size());
+
+		// Streaming only remembers where the data is.
+		config.stream = true;
+		uaudio::WaveFormat streamed;
+		REQUIRE(uaudio::WaveReader::LoadSound("chunks.wav", streamed, file, config) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		CHECK(streamed.IsStreaming());
+		CHECK(!streamed.HasChunk(uaudio::DATA_CHUNK_ID));
+		CHECK(streamed.GetDataSize() == samples.size() * sizeof(int16_t));
+		CHECK(streamed.HasChunk(uaudio::CUE_CHUNK_ID));
+
+		uaudio::logger::log_success("%s[CHUNK SCANNING CHUNKS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Truncated file")
+	{
+		uaudio::logger::log_info("%s[CHUNK SCANNING TRUNCATED FILE]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The data chunk says it is longer than what is left of the file.
+		uaudio::WaveFormat short_format;
+		add_chunk(short_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(short_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		REQUIRE(uaudio::WaveReader::SaveSound("truncated.wav", short_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		FILE *file = nullptr;
+		fopen_s(&file, "truncated.wav", "rb");
+		REQUIRE(file != nullptr);
+		std::vector<unsigned char> bytes(1000);
+		const size_t size = fread(bytes.data(), 1, bytes.size(), file);
+		fclose(file);
+		file = nullptr;
+		REQUIRE(size == bytes.size());
+		fopen_s(&file, "truncated.wav", "wb");
+		REQUIRE(file != nullptr);
+		fwrite(bytes.data(), 1, bytes.size(), file);
+		fclose(file);
+		file = nullptr;
+
+		uaudio::WaveFormat loaded;
+		CHECK(uaudio::WaveReader::LoadSound("truncated.wav", loaded, file, uaudio::WaveConfig()) == uaudio::WAVE_LOADING_STATUS::STATUS_SUCCESSFUL);
+		CHECK(loaded.HasChunk(uaudio::FMT_CHUNK_ID));
+		REQUIRE(loaded.GetChunkSize(uaudio::DATA_CHUNK_ID) > 0);
+		CHECK(loaded.GetChunkSize(uaudio::DATA_CHUNK_ID) < bytes.size());
+		CHECK(memcmp(loaded.GetChunkBuffer(uaudio::DATA_CHUNK_ID), samples.data(), loaded.GetChunkSize(uaudio::DATA_CHUNK_ID)) == 0);
+		remove("truncated.wav");
+
+		uaudio::logger::log_success("%s[CHUNK SCANNING TRUNCATED FILE]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Scattered reads")
+	{
+		uaudio::logger::log_info("%s[CHUNK SCANNING SCATTERED READS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::utils::FileReader file_reader;
+		CHECK(!file_reader.Open("missing.wav"));
+		REQUIRE(file_reader.Open("chunks.wav"));
+		CHECK(file_reader.GetNumCalls() == 2);
+
+		// Three buffers from one range of the file, with one call.
+		unsigned char header[12] = {};
+		unsigned char middle[100] = {};
+		std::vector<unsigned char> rest(static_cast<size_t>(file_reader.GetSize()) - sizeof(header) - sizeof(middle) + 10);
+		uaudio::utils::FileBuffer buffers[3];
+		buffers[0].data = header;
+		buffers[0].size = sizeof(header);
+		buffers[1].data = middle;
+		buffers[1].size = sizeof(middle);
+		buffers[2].data = rest.data();
+		buffers[2].size = rest.size();
+		CHECK(file_reader.ReadScattered(0, buffers, 3) == file_reader.GetSize());
+		CHECK(memcmp(header, "RIFF", 4) == 0);
+		CHECK(memcmp(header + 8, "WAVE", 4) == 0);
+		CHECK(file_reader.GetNumCalls() <= 4);
+
+		unsigned char chunk_id[4] = {};
+		CHECK(file_reader.Read(12, chunk_id, sizeof(chunk_id)) == sizeof(chunk_id));
+		CHECK(memcmp(chunk_id, uaudio::FMT_CHUNK_ID, 4) == 0);
+		CHECK(file_reader.Read(file_reader.GetSize(), chunk_id, sizeof(chunk_id)) == 0);
+		file_reader.Close();
+		CHECK(!file_reader.IsOpen());
+
+		uaudio::logger::log_success("%s[CHUNK SCANNING SCATTERED READS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+
+	remove("chunks.wav");
+}
+
+TEST_CASE("Chunk Index")
+{
+	uaudio::FMT_Chunk fmt_chunk(nullptr);
+	fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+	fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+	fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_44100;
+	fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+	fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+	fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+	std::vector<int16_t> samples(4410 * uaudio::WAVE_CHANNELS_STEREO);
+	for (size_t i = 0; i < samples.size(); i++)
+		samples[i] = static_cast<int16_t>(i);
+	const unsigned char metadata[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+	SUBCASE("Lookups")
+	{
+		uaudio::logger::log_info("%s[CHUNK INDEX LOOKUPS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, "LIST", metadata, sizeof(metadata));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		add_chunk(wave_format, "LIST", metadata, 8);
+
+		CHECK(wave_format.HasChunk(uaudio::FMT_CHUNK_ID));
+		CHECK(!wave_format.HasChunk(uaudio::SMPL_CHUNK_ID));
+		CHECK(!wave_format.HasChunk("fmt\0"));
+		CHECK(!wave_format.HasChunk("Data"));
+		CHECK(wave_format.GetChunkSize("LIST") == sizeof(metadata));
+		CHECK(wave_format.GetChunkSize(uaudio::SMPL_CHUNK_ID) == 0);
+		CHECK(wave_format.GetChunkBuffer(uaudio::SMPL_CHUNK_ID) == nullptr);
+		CHECK(wave_format.GetChunkFromData<uaudio::FMT_Chunk>(uaudio::FMT_CHUNK_ID).sampleRate == uaudio::WAVE_SAMPLE_RATE_44100);
+		CHECK(memcmp(wave_format.GetChunkBuffer(uaudio::DATA_CHUNK_ID), samples.data(), samples.size() * sizeof(int16_t)) == 0);
+
+		// Removing a chunk removes every chunk with that id, the index stays in line with the chunks.
+		wave_format.RemoveChunk("LIST");
+		CHECK(!wave_format.HasChunk("LIST"));
+		CHECK(wave_format.GetChunkSize(uaudio::DATA_CHUNK_ID) == samples.size() * sizeof(int16_t));
+		add_chunk(wave_format, uaudio::SMPL_CHUNK_ID, metadata, sizeof(metadata));
+		CHECK(wave_format.GetChunkSize(uaudio::SMPL_CHUNK_ID) == sizeof(metadata));
+
+		// Copies and moves take the index along.
+		uaudio::WaveFormat copy = wave_format;
+		CHECK(copy.GetChunkSize(uaudio::SMPL_CHUNK_ID) == sizeof(metadata));
+		CHECK(copy.GetChunkBuffer(uaudio::DATA_CHUNK_ID) != wave_format.GetChunkBuffer(uaudio::DATA_CHUNK_ID));
+		uaudio::WaveFormat moved = std::move(copy);
+		CHECK(moved.HasChunk(uaudio::FMT_CHUNK_ID));
+		CHECK(!copy.HasChunk(uaudio::FMT_CHUNK_ID));
+		copy = moved;
+		CHECK(copy.GetChunkSize(uaudio::DATA_CHUNK_ID) == samples.size() * sizeof(int16_t));
+
+		uaudio::logger::log_success("%s[CHUNK INDEX LOOKUPS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Cached chunks")
+	{
+		uaudio::logger::log_info("%s[CHUNK INDEX CACHED CHUNKS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		REQUIRE(uaudio::WaveReader::SaveSound("index.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		// The cache matches the chunks of the format, after conversion.
+		uaudio::WaveConfig config;
+		config.numChannels = uaudio::WAVE_CHANNELS_MONO;
+		uaudio::WaveFile wave_file("index.wav", config);
+		const uaudio::WaveFormat &format = wave_file.GetWaveFormat();
+		CHECK(wave_file.GetFmtChunk().numChannels == uaudio::WAVE_CHANNELS_MONO);
+		CHECK(wave_file.GetFmtChunk().blockAlign == format.GetChunkFromData<uaudio::FMT_Chunk>(uaudio::FMT_CHUNK_ID).blockAlign);
+		CHECK(wave_file.GetData() == format.GetChunkBuffer(uaudio::DATA_CHUNK_ID));
+		CHECK(wave_file.GetDataSize() == samples.size() * sizeof(int16_t) / 2);
+
+		uint32_t size = 1000000;
+		unsigned char *data = nullptr;
+		wave_file.Read(100, size, data);
+		CHECK(data == wave_file.GetData() + 100);
+		CHECK(size == wave_file.GetDataSize() - 100);
+
+		// A copy points at its own data, a move keeps the data where it was.
+		uaudio::WaveFile copy = wave_file;
+		CHECK(copy.GetData() == copy.GetWaveFormat().GetChunkBuffer(uaudio::DATA_CHUNK_ID));
+		CHECK(copy.GetData() != wave_file.GetData());
+		unsigned char *moved_data = wave_file.GetData();
+		uaudio::WaveFile moved = std::move(wave_file);
+		CHECK(moved.GetData() == moved_data);
+		CHECK(moved.GetFmtChunk().sampleRate == uaudio::WAVE_SAMPLE_RATE_44100);
+		CHECK(wave_file.GetData() == nullptr);
+		CHECK(wave_file.GetDataSize() == 0);
+
+		// A streamed sound has no data in memory, only its size.
+		config.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		config.stream = true;
+		uaudio::WaveFile streamed("index.wav", config);
+		CHECK(streamed.GetData() == nullptr);
+		CHECK(streamed.GetDataSize() == samples.size() * sizeof(int16_t));
+		CHECK(streamed.GetFmtChunk().numChannels == uaudio::WAVE_CHANNELS_STEREO);
+		remove("index.wav");
+
+		uaudio::logger::log_success("%s[CHUNK INDEX CACHED CHUNKS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Conversion Plan")
+{
+	// Two seconds of a 24-bit sine that moves between the channels of a 5.1 layout.
+	constexpr uint32_t NUM_FRAMES = uaudio::WAVE_SAMPLE_RATE_48000 * 2;
+	std::vector<unsigned char> surround(NUM_FRAMES * uaudio::WAVE_CHANNELS_5_1 * 3);
+	for (uint32_t i = 0; i < NUM_FRAMES; i++)
+		for (uint16_t channel = 0; channel < uaudio::WAVE_CHANNELS_5_1; channel++)
+			uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_24>(surround.data() + (i * uaudio::WAVE_CHANNELS_5_1 + channel) * 3, 0.4f * std::sin(static_cast<float>(i) * 0.01f * static_cast<float>(channel + 1)));
+
+	SUBCASE("One pass")
+	{
+		uaudio::logger::log_info("%s[CONVERSION PLAN ONE PASS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// 24-bit mono to 16-bit stereo: the same data as converting the bit depth and then the channels.
+		std::vector<unsigned char> mono(NUM_FRAMES * 3);
+		for (uint32_t i = 0; i < NUM_FRAMES; i++)
+			memcpy(mono.data() + i * 3, surround.data() + i * uaudio::WAVE_CHANNELS_5_1 * 3, 3);
+
+		uint32_t size = static_cast<uint32_t>(mono.size());
+		std::vector<unsigned char> bits(uaudio::conversion::Calculate24To16Size(size));
+		uaudio::conversion::Convert24To16(bits.data(), mono.data(), size, uaudio::DITHER::DITHER_NONE, uaudio::WAVE_CHANNELS_MONO);
+		std::vector<unsigned char> two_passes(uaudio::conversion::CalculateChannelConvertSize(size, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_CHANNELS_STEREO));
+		uaudio::conversion::ConvertChannels(two_passes.data(), bits.data(), size, uaudio::WAVE_BITS_PER_SAMPLE_16, 0, uaudio::WAVE_CHANNELS_MONO, 0, uaudio::WAVE_CHANNELS_STEREO);
+
+		uaudio::conversion::ConversionFormat source, target;
+		source.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		source.numChannels = uaudio::WAVE_CHANNELS_MONO;
+		target.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		target.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		uaudio::conversion::ConversionPlan plan;
+		REQUIRE(plan.Init(source, target, uaudio::DITHER::DITHER_NONE));
+		CHECK(plan.ConvertsBitsPerSample());
+		CHECK(plan.ConvertsChannels());
+
+		size = static_cast<uint32_t>(mono.size());
+		std::vector<unsigned char> one_pass(plan.CalculateSize(size));
+		plan.Convert(one_pass.data(), mono.data(), size);
+		CHECK(size == two_passes.size());
+		CHECK(one_pass == two_passes);
+
+		// A downmix gets rounded once instead of twice, so it is at most 1 step away.
+		source.numChannels = uaudio::WAVE_CHANNELS_5_1;
+		target.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		REQUIRE(plan.Init(source, target, uaudio::DITHER::DITHER_NONE));
+		size = static_cast<uint32_t>(surround.size());
+		bits.resize(uaudio::conversion::Calculate24To16Size(size));
+		uaudio::conversion::Convert24To16(bits.data(), surround.data(), size, uaudio::DITHER::DITHER_NONE, uaudio::WAVE_CHANNELS_5_1);
+		std::vector<int16_t> downmix(uaudio::conversion::CalculateChannelConvertSize(size, uaudio::WAVE_CHANNELS_5_1, uaudio::WAVE_CHANNELS_STEREO) / sizeof(int16_t));
+		uaudio::conversion::ConvertChannels(reinterpret_cast<unsigned char *>(downmix.data()), bits.data(), size, uaudio::WAVE_BITS_PER_SAMPLE_16, 0, uaudio::WAVE_CHANNELS_5_1, 0, uaudio::WAVE_CHANNELS_STEREO);
+
+		size = static_cast<uint32_t>(surround.size());
+		std::vector<int16_t> fused(plan.CalculateSize(size) / sizeof(int16_t));
+		plan.Convert(reinterpret_cast<unsigned char *>(fused.data()), surround.data(), size);
+		REQUIRE(fused.size() == downmix.size());
+		int32_t max_difference = 0;
+		for (size_t i = 0; i < fused.size(); i++)
+			max_difference = std::max(max_difference, std::abs(fused[i] - downmix[i]));
+		CHECK(max_difference <= 1);
+
+		// Nothing to do.
+		REQUIRE(plan.Init(source, source));
+		CHECK(plan.IsEmpty());
+		source.bitsPerSample = 12;
+		CHECK(!plan.Init(source, target));
+		source.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_32;
+		source.audioFormat = uaudio::WAV_FORMAT_MICROSOFT_ADPCM;
+		CHECK(!plan.Init(source, target));
+
+		uaudio::logger::log_success("%s[CONVERSION PLAN ONE PASS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Threads")
+	{
+		uaudio::logger::log_info("%s[CONVERSION PLAN THREADS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Parts of whole blocks give the same data as one part.
+		std::vector<unsigned char> long_data(surround.size() * 4);
+		for (size_t i = 0; i < 4; i++)
+			memcpy(long_data.data() + i * surround.size(), surround.data(), surround.size());
+
+		uaudio::conversion::ConversionFormat source, target;
+		source.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		source.numChannels = uaudio::WAVE_CHANNELS_5_1;
+		target.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_32;
+		target.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		uaudio::conversion::ConversionPlan plan;
+		REQUIRE(plan.Init(source, target));
+		CHECK(uaudio::conversion::GetConversionParts(static_cast<uint32_t>(long_data.size() / 3), 4) > 1);
+
+		uint32_t size = static_cast<uint32_t>(long_data.size());
+		std::vector<unsigned char> single(plan.CalculateSize(size));
+		plan.Convert(single.data(), long_data.data(), size);
+		size = static_cast<uint32_t>(long_data.size());
+		std::vector<unsigned char> split(plan.CalculateSize(size));
+		plan.Convert(split.data(), long_data.data(), size, 4);
+		CHECK(size == single.size());
+		CHECK(split == single);
+
+		uaudio::logger::log_success("%s[CONVERSION PLAN THREADS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Loading")
+	{
+		uaudio::logger::log_info("%s[CONVERSION PLAN LOADING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_5_1;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_5_1 * 3;
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, surround.data(), static_cast<uint32_t>(surround.size()));
+		REQUIRE(uaudio::WaveReader::SaveSound("plan.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		// The bit depth and the channels change with one new data chunk, the fmt chunk follows.
+		uaudio::WaveConfig config;
+		config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		config.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		config.sampleRate = 0;
+		uaudio::WaveFile wave_file("plan.wav", config);
+		CHECK(wave_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_16);
+		CHECK(wave_file.GetFmtChunk().numChannels == uaudio::WAVE_CHANNELS_STEREO);
+		CHECK(wave_file.GetFmtChunk().blockAlign == uaudio::BLOCK_ALIGN_16_BIT_STEREO);
+		CHECK(wave_file.GetFmtChunk().byteRate == uaudio::WAVE_SAMPLE_RATE_48000 * uaudio::BLOCK_ALIGN_16_BIT_STEREO);
+		CHECK(wave_file.GetWaveFormat().GetChannelMask() == uaudio::WAVE_SPEAKERS_STEREO);
+		CHECK(wave_file.GetDataSize() == NUM_FRAMES * uaudio::BLOCK_ALIGN_16_BIT_STEREO);
+
+		// Only the channels.
+		config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		config.numChannels = uaudio::WAVE_CHANNELS_QUAD;
+		uaudio::WaveFile quad("plan.wav", config);
+		CHECK(quad.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_24);
+		CHECK(quad.GetFmtChunk().numChannels == uaudio::WAVE_CHANNELS_QUAD);
+		CHECK(quad.GetDataSize() == NUM_FRAMES * uaudio::WAVE_CHANNELS_QUAD * 3);
+		remove("plan.wav");
+
+		uaudio::logger::log_success("%s[CONVERSION PLAN LOADING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Conversion Kernels")
+{
+	// Odd lengths, so every version has a remainder that goes through the smaller versions.
+	constexpr uint32_t NUM_SAMPLES = 1037;
+	std::vector<float> floats(NUM_SAMPLES);
+	std::vector<unsigned char> pcm16(NUM_SAMPLES * sizeof(int16_t)), pcm24(NUM_SAMPLES * 3), pcm32(NUM_SAMPLES * sizeof(float));
+	for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+	{
+		// Full scale, silence, negative values, values halfway between two steps and values that saturate.
+		floats[i] = i < 8 ? std::array<float, 8>{1.0f, -1.0f, 0.0f, -0.0f, 1.5f, -1.5f, 0.5f / 32768.0f, -2.5f / 32768.0f}[i] : 1.2f * std::sin(static_cast<float>(i) * 0.37f);
+		uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_16>(pcm16.data() + i * sizeof(int16_t), floats[i]);
+		uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_24>(pcm24.data() + i * 3, floats[i]);
+		memcpy(pcm32.data() + i * sizeof(float), &floats[i], sizeof(float));
+	}
+	const uaudio::conversion::ConversionKernels &scalar = uaudio::conversion::GetConversionKernels(uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR);
+
+	SUBCASE("Dispatch")
+	{
+		uaudio::logger::log_info("%s[CONVERSION KERNELS DISPATCH]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		CHECK(uaudio::conversion::IsSimdLevelSupported(uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR));
+		CHECK(uaudio::conversion::IsSimdLevelSupported(uaudio::conversion::GetSimdLevel()));
+		CHECK(uaudio::conversion::GetConversionKernels().simdLevel == uaudio::conversion::GetSimdLevel());
+		CHECK(scalar.simdLevel == uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR);
+#if defined(__x86_64__) || defined(_M_X64)
+		CHECK(uaudio::conversion::GetSimdLevel() != uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR);
+#endif
+
+		// A level that the cpu does not have gives the scalar kernels.
+		for (const uaudio::SIMD_LEVEL simd_level : {uaudio::SIMD_LEVEL::SIMD_LEVEL_SSE2, uaudio::SIMD_LEVEL::SIMD_LEVEL_SSSE3, uaudio::SIMD_LEVEL::SIMD_LEVEL_AVX2, uaudio::SIMD_LEVEL::SIMD_LEVEL_NEON})
+			CHECK(uaudio::conversion::GetConversionKernels(simd_level).simdLevel == (uaudio::conversion::IsSimdLevelSupported(simd_level) ? simd_level : uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR));
+
+		uaudio::logger::log_success("%s[CONVERSION KERNELS DISPATCH]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Same data")
+	{
+		uaudio::logger::log_info("%s[CONVERSION KERNELS SAME DATA]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Every version the cpu has gives the same bytes as the scalar version (for every length up to a few blocks).
+		for (const uaudio::SIMD_LEVEL simd_level : {uaudio::SIMD_LEVEL::SIMD_LEVEL_SSE2, uaudio::SIMD_LEVEL::SIMD_LEVEL_SSSE3, uaudio::SIMD_LEVEL::SIMD_LEVEL_AVX2, uaudio::SIMD_LEVEL::SIMD_LEVEL_NEON})
+		{
+			if (!uaudio::conversion::IsSimdLevelSupported(simd_level))
+				continue;
+
+			const uaudio::conversion::ConversionKernels &kernels = uaudio::conversion::GetConversionKernels(simd_level);
+			for (uint32_t count : {1u, 2u, 3u, 7u, 15u, 17u, 33u, 100u, NUM_SAMPLES / 2, NUM_SAMPLES})
+			{
+				std::vector<float> expected_floats(count), floats_out(count);
+				scalar.read16(expected_floats.data(), pcm16.data(), count);
+				kernels.read16(floats_out.data(), pcm16.data(), count);
+				CHECK(memcmp(expected_floats.data(), floats_out.data(), count * sizeof(float)) == 0);
+
+				// The bytes of the 16-bit samples are 8-bit samples too.
+				scalar.read8(expected_floats.data(), pcm16.data(), count);
+				kernels.read8(floats_out.data(), pcm16.data(), count);
+				CHECK(memcmp(expected_floats.data(), floats_out.data(), count * sizeof(float)) == 0);
+
+				// Only the samples of count get read (the buffer ends there).
+				std::vector<unsigned char> exact24(pcm24.begin(), pcm24.begin() + count * 3);
+				scalar.read24(expected_floats.data(), exact24.data(), count);
+				kernels.read24(floats_out.data(), exact24.data(), count);
+				CHECK(memcmp(expected_floats.data(), floats_out.data(), count * sizeof(float)) == 0);
+
+				std::vector<unsigned char> expected(count * 2 * sizeof(float)), out(count * 2 * sizeof(float));
+				scalar.write16(expected.data(), floats.data(), count);
+				kernels.write16(out.data(), floats.data(), count);
+				CHECK(memcmp(expected.data(), out.data(), count * sizeof(int16_t)) == 0);
+
+				scalar.monoToStereo16(expected.data(), pcm16.data(), count);
+				kernels.monoToStereo16(out.data(), pcm16.data(), count);
+				CHECK(memcmp(expected.data(), out.data(), count * 2 * sizeof(int16_t)) == 0);
+
+				scalar.monoToStereo32(expected.data(), pcm32.data(), count);
+				kernels.monoToStereo32(out.data(), pcm32.data(), count);
+				CHECK(memcmp(expected.data(), out.data(), count * 2 * sizeof(float)) == 0);
+
+				scalar.stereoToMono16(expected.data(), pcm16.data(), count / 2);
+				kernels.stereoToMono16(out.data(), pcm16.data(), count / 2);
+				CHECK(memcmp(expected.data(), out.data(), count / 2 * sizeof(int16_t)) == 0);
+
+				scalar.stereoToMono32(expected.data(), pcm32.data(), count / 2);
+				kernels.stereoToMono32(out.data(), pcm32.data(), count / 2);
+				CHECK(memcmp(expected.data(), out.data(), count / 2 * sizeof(float)) == 0);
+			}
+		}
+
+		uaudio::logger::log_success("%s[CONVERSION KERNELS SAME DATA]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Scalar")
+	{
+		uaudio::logger::log_info("%s[CONVERSION KERNELS SCALAR]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The scalar version is the same as the sample helpers: saturation and rounding to the nearest even number.
+		std::array<int16_t, 8> values = {};
+		scalar.write16(reinterpret_cast<unsigned char *>(values.data()), floats.data(), 8);
+		CHECK(values == std::array<int16_t, 8>{INT16_MAX, INT16_MIN, 0, 0, INT16_MAX, INT16_MIN, 0, -2});
+
+		const std::array<int16_t, 8> frames = {3, 0, -3, 0, 1, 2, -1, -2};
+		std::array<int16_t, 4> mono = {};
+		scalar.stereoToMono16(reinterpret_cast<unsigned char *>(mono.data()), reinterpret_cast<const unsigned char *>(frames.data()), 4);
+		CHECK(mono == std::array<int16_t, 4>{2, -2, 2, -2});
+
+		std::array<float, 8> read = {};
+		scalar.read24(read.data(), pcm24.data(), 8);
+		for (uint32_t i = 0; i < 8; i++)
+			CHECK(read[i] == uaudio::conversion::ReadSample<uaudio::WAVE_BITS_PER_SAMPLE_24>(pcm24.data() + i * 3));
+
+		uaudio::logger::log_success("%s[CONVERSION KERNELS SCALAR]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Sample Formats")
+{
+	const std::array<uaudio::SAMPLE_FORMAT, 6> sample_formats = {uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT24, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64};
+
+	// A sine with full scale and silence at the start, as 64-bit floats.
+	constexpr uint32_t NUM_SAMPLES = 4099;
+	std::vector<double> reference(NUM_SAMPLES);
+	for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+		reference[i] = i < 3 ? std::array<double, 3>{1.0, -1.0, 0.0}[i] : 0.9 * std::sin(static_cast<double>(i) * 0.05);
+
+	// Converts data from one sample format to another (without dither).
+	const auto convert = [](const std::vector<unsigned char> &a_Data, uaudio::SAMPLE_FORMAT a_OriginalSampleFormat, uaudio::SAMPLE_FORMAT a_SampleFormat)
+	{
+		uint32_t size = static_cast<uint32_t>(a_Data.size());
+		std::vector<unsigned char> data(uaudio::conversion::CalculateSampleFormatSize(size, a_OriginalSampleFormat, a_SampleFormat));
+		CHECK(uaudio::conversion::ConvertSampleFormat(data.data(), a_Data.data(), size, a_OriginalSampleFormat, a_SampleFormat, uaudio::DITHER::DITHER_NONE));
+		CHECK(size == data.size());
+		return data;
+	};
+	std::vector<unsigned char> reference_data(NUM_SAMPLES * sizeof(double));
+	memcpy(reference_data.data(), reference.data(), reference_data.size());
+
+	SUBCASE("Audio format")
+	{
+		uaudio::logger::log_info("%s[SAMPLE FORMATS AUDIO FORMAT]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// 32-bit samples are integers in pcm files and floats in float files (and in the engine).
+		CHECK(uaudio::conversion::GetSampleFormat(uaudio::WAV_FORMAT_PCM, uaudio::WAVE_BITS_PER_SAMPLE_32) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32);
+		CHECK(uaudio::conversion::GetSampleFormat(uaudio::WAV_FORMAT_IEEE_FLOAT, uaudio::WAVE_BITS_PER_SAMPLE_32) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32);
+		CHECK(uaudio::conversion::GetSampleFormat(0, uaudio::WAVE_BITS_PER_SAMPLE_32) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32);
+		CHECK(uaudio::conversion::GetSampleFormat(uaudio::WAV_FORMAT_IEEE_FLOAT, uaudio::WAVE_BITS_PER_SAMPLE_64) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64);
+		CHECK(uaudio::conversion::GetSampleFormat(uaudio::WAV_FORMAT_PCM, uaudio::WAVE_BITS_PER_SAMPLE_8) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8);
+		CHECK(uaudio::conversion::GetSampleFormat(uaudio::WAV_FORMAT_PCM, uaudio::WAVE_BITS_PER_SAMPLE_64) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN);
+		CHECK(uaudio::conversion::GetSampleFormat(uaudio::WAV_FORMAT_IEEE_FLOAT, uaudio::WAVE_BITS_PER_SAMPLE_16) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN);
+		CHECK(uaudio::conversion::GetSampleFormat(uaudio::WAV_FORMAT_MICROSOFT_ADPCM, uaudio::WAVE_BITS_PER_SAMPLE_16) == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN);
+		CHECK(uaudio::conversion::GetSampleConvertFunction(uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16) == nullptr);
+		CHECK(uaudio::conversion::GetSampleConvertFunction(uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UNKNOWN) == nullptr);
+
+		// The same bits are a different sample as an integer or as a float.
+		const std::vector<unsigned char> int32_data = convert(reference_data, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32);
+		int32_t first = 0;
+		memcpy(&first, int32_data.data(), sizeof(first));
+		CHECK(first == INT32_MAX);
+		CHECK(uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>(int32_data.data() + sizeof(int32_t)) == -1.0);
+
+		// 8-bit samples are unsigned.
+		const std::vector<unsigned char> uint8_data = convert(reference_data, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8);
+		CHECK(uint8_data[0] == 255);
+		CHECK(uint8_data[1] == 0);
+		CHECK(uint8_data[2] == 128);
+
+		uaudio::logger::log_success("%s[SAMPLE FORMATS AUDIO FORMAT]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Matrix")
+	{
+		uaudio::logger::log_info("%s[SAMPLE FORMATS MATRIX]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The reference in every sample format.
+		std::array<std::vector<unsigned char>, 6> data;
+		for (size_t i = 0; i < sample_formats.size(); i++)
+			data[i] = convert(reference_data, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, sample_formats[i]);
+
+		// The step of the format with the least precision (and the precision of a 32-bit float).
+		const auto step = [](uaudio::SAMPLE_FORMAT a_SampleFormat)
+		{
+			switch (a_SampleFormat)
+			{
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8: return 1.0 / 128.0;
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16: return 1.0 / 32768.0;
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT24: return 1.0 / 8388608.0;
+				default: return 0.0;
+			}
+		};
+
+		for (size_t i = 0; i < sample_formats.size(); i++)
+			for (size_t j = 0; j < sample_formats.size(); j++)
+			{
+				const uaudio::SAMPLE_FORMAT original = sample_formats[i], target = sample_formats[j];
+				const std::vector<unsigned char> converted = convert(data[i], original, target);
+				REQUIRE(converted.size() == NUM_SAMPLES * uaudio::conversion::GetBitsPerSample(target) / 8);
+
+				// Every sample is within a step of the original sample.
+				const std::vector<unsigned char> result = convert(converted, target, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64);
+				const std::vector<unsigned char> expected = convert(data[i], original, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64);
+				const double tolerance = std::max(step(original), step(target)) + 1.0 / 8388608.0;
+				double max_difference = 0.0;
+				for (uint32_t k = 0; k < NUM_SAMPLES; k++)
+				{
+					const double difference = std::fabs(uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(result.data() + k * sizeof(double)) - uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(expected.data() + k * sizeof(double)));
+					max_difference = std::max(max_difference, difference);
+				}
+				CHECK(max_difference <= tolerance);
+
+				// Going to more precision and back does not lose anything.
+				const bool integers = target != uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32 && target != uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64 && original != uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32 && original != uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64;
+				const bool lossless = original == target || (integers && j > i) || (target == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32 && i < 3) || target == uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64;
+				if (lossless)
+					CHECK(convert(converted, target, original) == data[i]);
+			}
+
+		uaudio::logger::log_success("%s[SAMPLE FORMATS MATRIX]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Loading")
+	{
+		uaudio::logger::log_info("%s[SAMPLE FORMATS LOADING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Files in the formats that the engine does not play get converted to the bits per sample of the config.
+		const auto save = [&reference_data](const char *a_FilePath, uaudio::SAMPLE_FORMAT a_SampleFormat)
+		{
+			uint32_t size = static_cast<uint32_t>(reference_data.size());
+			std::vector<unsigned char> data(uaudio::conversion::CalculateSampleFormatSize(size, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, a_SampleFormat));
+			uaudio::conversion::ConvertSampleFormat(data.data(), reference_data.data(), size, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, a_SampleFormat, uaudio::DITHER::DITHER_NONE);
+
+			uaudio::FMT_Chunk fmt_chunk(nullptr);
+			fmt_chunk.audioFormat = uaudio::conversion::GetAudioFormat(a_SampleFormat);
+			fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_MONO;
+			fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+			fmt_chunk.bitsPerSample = uaudio::conversion::GetBitsPerSample(a_SampleFormat);
+			fmt_chunk.blockAlign = fmt_chunk.bitsPerSample / 8;
+			fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+			uaudio::WaveFormat wave_format;
+			add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+			add_chunk(wave_format, uaudio::DATA_CHUNK_ID, data.data(), size);
+			REQUIRE(uaudio::WaveReader::SaveSound(a_FilePath, wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+		};
+		save("int32.wav", uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32);
+		save("float64.wav", uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64);
+		save("int16.wav", uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16);
+
+		// 32-bit integers to 16-bit (they used to be read as floats).
+		uaudio::WaveConfig config;
+		config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		config.dither = uaudio::DITHER::DITHER_NONE;
+		uaudio::WaveFile int32_file("int32.wav", config);
+		CHECK(int32_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_16);
+		CHECK(int32_file.GetFmtChunk().audioFormat == uaudio::WAV_FORMAT_PCM);
+		REQUIRE(int32_file.GetDataSize() == NUM_SAMPLES * sizeof(int16_t));
+		int16_t samples[2] = {};
+		memcpy(samples, int32_file.GetData(), sizeof(samples));
+		CHECK(samples[0] == INT16_MAX);
+		CHECK(samples[1] == INT16_MIN);
+
+		// Without bits per sample in the config, 32-bit integers go to 32-bit floats instead of losing bits.
+		config.bitsPerSample = 0;
+		uaudio::WaveFile kept_int32_file("int32.wav", config);
+		CHECK(kept_int32_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_32);
+		CHECK(kept_int32_file.GetFmtChunk().audioFormat == uaudio::WAV_FORMAT_IEEE_FLOAT);
+		REQUIRE(kept_int32_file.GetDataSize() == NUM_SAMPLES * sizeof(float));
+		CHECK(uaudio::conversion::ReadSample<uaudio::WAVE_BITS_PER_SAMPLE_32>(kept_int32_file.GetData() + sizeof(float)) == -1.0f);
+		CHECK(uaudio::conversion::ReadSample<uaudio::WAVE_BITS_PER_SAMPLE_32>(kept_int32_file.GetData() + 3 * sizeof(float)) == static_cast<float>(reference[3]));
+
+		// 64-bit floats to 32-bit floats.
+		config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_32;
+		uaudio::WaveFile float64_file("float64.wav", config);
+		CHECK(float64_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_32);
+		CHECK(float64_file.GetFmtChunk().audioFormat == uaudio::WAV_FORMAT_IEEE_FLOAT);
+		REQUIRE(float64_file.GetDataSize() == NUM_SAMPLES * sizeof(float));
+		CHECK(uaudio::conversion::ReadSample<uaudio::WAVE_BITS_PER_SAMPLE_32>(float64_file.GetData() + 3 * sizeof(float)) == static_cast<float>(reference[3]));
+
+		// Streams get played the way they are in the file, so the formats that the engine does not play get loaded instead.
+		config.stream = true;
+		uaudio::WaveFile streamed_int32_file("int32.wav", config);
+		CHECK(!streamed_int32_file.IsStreaming());
+		CHECK(streamed_int32_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_32);
+		CHECK(streamed_int32_file.GetFmtChunk().audioFormat == uaudio::WAV_FORMAT_IEEE_FLOAT);
+		REQUIRE(streamed_int32_file.GetDataSize() == NUM_SAMPLES * sizeof(float));
+		CHECK(uaudio::conversion::ReadSample<uaudio::WAVE_BITS_PER_SAMPLE_32>(streamed_int32_file.GetData()) == 1.0f);
+		{
+			uaudio::WaveFile streamed_int16_file("int16.wav", config);
+			CHECK(streamed_int16_file.IsStreaming());
+		}
+		config.stream = false;
+
+		// The config asks for 24-bit, 32-bit integers go down to it and 16-bit goes up to it.
+		config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		uaudio::WaveFile int24_file("int32.wav", config);
+		CHECK(int24_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_24);
+		CHECK(int24_file.GetFmtChunk().blockAlign == 3);
+		CHECK(int24_file.GetDataSize() == NUM_SAMPLES * 3);
+		uaudio::WaveFile int16_file("int16.wav", config);
+		CHECK(int16_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_24);
+		CHECK(int16_file.GetFmtChunk().blockAlign == 3);
+		CHECK(int16_file.GetDataSize() == NUM_SAMPLES * 3);
+
+		remove("int32.wav");
+		remove("float64.wav");
+		remove("int16.wav");
+
+		uaudio::logger::log_success("%s[SAMPLE FORMATS LOADING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("8-bit")
+	{
+		uaudio::logger::log_info("%s[SAMPLE FORMATS 8-BIT]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The table has every 8-bit sample.
+		std::array<unsigned char, 256> all_values;
+		std::array<float, 256> all_samples;
+		for (uint32_t i = 0; i < 256; i++)
+			all_values[i] = static_cast<unsigned char>(i);
+		uaudio::conversion::ReadSamples(all_samples.data(), all_values.data(), 256, uaudio::WAVE_BITS_PER_SAMPLE_8);
+		for (uint32_t i = 0; i < 256; i++)
+			CHECK(all_samples[i] == (static_cast<float>(i) - 128.0f) / 128.0f);
+
+		// Writing them again gives the same bytes.
+		uaudio::conversion::Ditherer ditherer;
+		ditherer.Init(uaudio::DITHER::DITHER_NONE, uaudio::WAVE_CHANNELS_MONO);
+		std::array<unsigned char, 256> written = {};
+		ditherer.Quantize(written.data(), all_samples.data(), 256, uaudio::WAVE_BITS_PER_SAMPLE_8);
+		CHECK(written == all_values);
+
+		const std::vector<unsigned char> uint8_data = convert(reference_data, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8);
+		const std::vector<unsigned char> float_data = convert(uint8_data, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32);
+
+		// An 8-bit file stays 8-bit with the default config (or a config that keeps the bits per sample), and goes up to 16-bit when the config asks for it.
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_MONO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_8;
+		fmt_chunk.blockAlign = 1;
+		fmt_chunk.byteRate = fmt_chunk.sampleRate;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, uint8_data.data(), static_cast<uint32_t>(uint8_data.size()));
+		REQUIRE(uaudio::WaveReader::SaveSound("uint8.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		uaudio::WaveConfig config;
+		config.bitsPerSample = 0;
+		uaudio::WaveFile uint8_file("uint8.wav", config);
+		CHECK(uint8_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_8);
+		REQUIRE(uint8_file.GetDataSize() == NUM_SAMPLES);
+		CHECK(memcmp(uint8_file.GetData(), uint8_data.data(), NUM_SAMPLES) == 0);
+
+		uaudio::WaveFile default_uint8_file("uint8.wav", uaudio::WaveConfig());
+		CHECK(default_uint8_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_8);
+		REQUIRE(default_uint8_file.GetDataSize() == NUM_SAMPLES);
+		CHECK(memcmp(default_uint8_file.GetData(), uint8_data.data(), NUM_SAMPLES) == 0);
+
+		config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		uaudio::WaveFile uint16_file("uint8.wav", config);
+		CHECK(uint16_file.GetFmtChunk().bitsPerSample == uaudio::WAVE_BITS_PER_SAMPLE_16);
+		REQUIRE(uint16_file.GetDataSize() == NUM_SAMPLES * sizeof(int16_t));
+		int16_t first = 0;
+		memcpy(&first, uint16_file.GetData(), sizeof(first));
+		CHECK(first == 127 * 256);
+		remove("uint8.wav");
+
+		// The effects work on 8-bit data, within a step of the same effect on the same samples as floats.
+		const auto check_close = [](const std::vector<unsigned char> &a_Data8, const std::vector<unsigned char> &a_Data32, uint32_t a_Size8, uint32_t a_Size32)
+		{
+			REQUIRE(a_Size8 * sizeof(float) == a_Size32);
+			std::vector<float> samples(a_Size8);
+			uaudio::conversion::ReadSamples(samples.data(), a_Data8.data(), a_Size8, uaudio::WAVE_BITS_PER_SAMPLE_8);
+			float max_difference = 0.0f;
+			for (uint32_t i = 3; i < a_Size8; i++)
+				max_difference = std::max(max_difference, std::fabs(samples[i] - uaudio::conversion::ReadSample<uaudio::WAVE_BITS_PER_SAMPLE_32>(a_Data32.data() + i * sizeof(float))));
+			CHECK(max_difference <= 1.0f / 128.0f);
+		};
+
+		std::vector<unsigned char> source8 = uint8_data, source32 = float_data;
+		uint32_t size8 = NUM_SAMPLES, size32 = NUM_SAMPLES * sizeof(float);
+		std::vector<unsigned char> resampled8(uaudio::conversion::CalculateResampleSize(size8, 1, uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_44100));
+		std::vector<unsigned char> resampled32(uaudio::conversion::CalculateResampleSize(size32, sizeof(float), uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_44100));
+		uaudio::conversion::Resample(resampled8.data(), source8.data(), size8, uaudio::WAVE_BITS_PER_SAMPLE_8, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_44100);
+		uaudio::conversion::Resample(resampled32.data(), source32.data(), size32, uaudio::WAVE_BITS_PER_SAMPLE_32, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_SAMPLE_RATE_48000, uaudio::WAVE_SAMPLE_RATE_44100);
+		check_close(resampled8, resampled32, size8, size32);
+
+		size8 = NUM_SAMPLES;
+		size32 = NUM_SAMPLES * sizeof(float);
+		std::vector<unsigned char> stretched8(uaudio::conversion::CalculateTimeStretchSize(size8, 1, 1.5f));
+		std::vector<unsigned char> stretched32(uaudio::conversion::CalculateTimeStretchSize(size32, sizeof(float), 1.5f));
+		uaudio::conversion::TimeStretch(stretched8.data(), source8.data(), size8, uaudio::WAVE_BITS_PER_SAMPLE_8, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_SAMPLE_RATE_48000, 1.5f);
+		uaudio::conversion::TimeStretch(stretched32.data(), source32.data(), size32, uaudio::WAVE_BITS_PER_SAMPLE_32, uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_SAMPLE_RATE_48000, 1.5f);
+		check_close(stretched8, stretched32, size8, size32);
+
+		// Mono to stereo copies the bytes, stereo to mono gives them back.
+		size8 = NUM_SAMPLES;
+		std::vector<unsigned char> stereo(uaudio::conversion::CalculateMonoToStereoSize(size8));
+		uaudio::conversion::ConvertMonoToStereo(stereo.data(), source8.data(), size8, 1);
+		REQUIRE(size8 == NUM_SAMPLES * 2);
+		CHECK(stereo[6] == uint8_data[3]);
+		CHECK(stereo[7] == uint8_data[3]);
+		std::vector<unsigned char> mono(NUM_SAMPLES);
+		uaudio::conversion::ConvertStereoToMono(mono.data(), stereo.data(), size8, 2);
+		CHECK(mono == uint8_data);
+
+		// Silence is 128, so the first and last audible frames get found around it.
+		std::vector<unsigned char> padded(64, 128);
+		padded.insert(padded.end(), uint8_data.begin() + 3, uint8_data.end());
+		padded.insert(padded.end(), 64, 128);
+		uint32_t first_frame = 0, end_frame = 0;
+		REQUIRE(uaudio::conversion::FindAudibleFrames(padded.data(), static_cast<uint32_t>(padded.size()), uaudio::WAVE_BITS_PER_SAMPLE_8, uaudio::WAVE_CHANNELS_MONO, -40.0f, first_frame, end_frame));
+		CHECK(first_frame == 64);
+		CHECK(end_frame == padded.size() - 64);
+		CHECK(uaudio::conversion::FindAudibleFrames(std::vector<unsigned char>(100, 128).data(), 100, uaudio::WAVE_BITS_PER_SAMPLE_8, uaudio::WAVE_CHANNELS_MONO, -40.0f, first_frame, end_frame) == false);
+
+		uaudio::logger::log_success("%s[SAMPLE FORMATS 8-BIT]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Miscellaneous")
+{
+	SUBCASE("Clamp")
+	{
+		uaudio::logger::log_info("%s[CLAMP]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		float value = 5.0f;
+		value = uaudio::utils::clamp(value, 0.0f, 4.0f);
+
+		CHECK(value == 4.0f);
+
+		value = -1.0f;
+		value = uaudio::utils::clamp(value, 0.0f, 4.0f);
+
+		CHECK(value == 0.0f);
+
+		uaudio::logger::log_success("%s[CLAMP]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("SECONDS TO MILLISECONDS")
+	{
+		uaudio::logger::log_info("%s[SECONDS TO MILLISECONDS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		float value = 1.0f;
+		value = uaudio::utils::SecondsToMilliseconds(value);
+
+		CHECK(value == 1000.0f);
+
+		value = 2.0f;
+		value = uaudio::utils::SecondsToMilliseconds(value);
+
+		CHECK(value == 2000.0f);
+
+		value = 2.5f;
+		value = uaudio::utils::SecondsToMilliseconds(value);
+
+		CHECK(value == 2500.0f);
+
+		value = 5.523f;
+		value = uaudio::utils::SecondsToMilliseconds(value);
+
+		CHECK(value == 5523.0f);
+
+		float random = fmodf(rand(), 5.0f);
+		value = random;
+		value = uaudio::utils::SecondsToMilliseconds(value);
+
+		CHECK(value == random * 1000);
+
+		uaudio::logger::log_success("%s[SECONDS TO MILLISECONDS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("MILLISECONDS TO SECONDS")
+	{
+		uaudio::logger::log_info("%s[MILLISECONDS TO SECONDS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		float value = 1000.0f;
+		value = uaudio::utils::MillisecondsToSeconds(value);
+
+		CHECK(value == 1.0f);
+
+		value = 2000.0f;
+		value = uaudio::utils::MillisecondsToSeconds(value);
+
+		CHECK(value == 2.0f);
+
+		value = 2500.0f;
+		value = uaudio::utils::MillisecondsToSeconds(value);
+
+		CHECK(value == 2.5f);
+
+		value = 5523.0f;
+		value = uaudio::utils::MillisecondsToSeconds(value);
+
+		CHECK(value == 5.523f);
+
+		float random = fmodf(rand(), 5.0f) * 1000;
+		value = random;
+		value = uaudio::utils::MillisecondsToSeconds(value);
+
+		CHECK(value == random / 1000);
+
+		uaudio::logger::log_success("%s[MILLISECONDS TO SECONDS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("SECONDS TO HOURS")
+	{
+		uaudio::logger::log_info("%s[SECONDS TO HOURS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		float value = 3600.0f;
+		uint32_t hours = uaudio::utils::SecondsToHours(value);
+
+		CHECK(hours == 1);
+
+		value = 1800.0f;
+		hours = uaudio::utils::SecondsToHours(value);
+
+		CHECK(hours == 0);
+
+		value = 2700.0f;
+		hours = uaudio::utils::SecondsToHours(value);
+
+		CHECK(hours == 0);
+
+		uaudio::logger::log_success("%s[SECONDS TO HOURS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("SECONDS TO MINUTES")
+	{
+		uaudio::logger::log_info("%s[SECONDS TO MINUTES]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		float value = 60.0f;
+		uint32_t minutes = uaudio::utils::SecondsToMinutes(value);
+
+		CHECK(minutes == 1);
+
+		value = 120.0f;
+		minutes = uaudio::utils::SecondsToMinutes(value);
+
+		CHECK(minutes == 2);
+
+		uaudio::logger::log_success("%s[SECONDS TO MINUTES]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}
+
+TEST_CASE("Audio Loading")
+{
+	SUBCASE("Existing file")
+	{
+		uaudio::logger::log_info("%s[OPENING EXISTING VALID FILE]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		uaudio::WaveFormat format;
+		FILE *file = nullptr;
+		uaudio::WaveReader::LoadSound("3 Steps Ahead - Drop It (Happy Mix).wav", format, file);
+
+		CHECK(format.HasChunk(uaudio::FMT_CHUNK_ID));
+
+		uaudio::FMT_Chunk fmt_chunk = format.GetChunkFromData<uaudio::FMT_Chunk>(uaudio::FMT_CHUNK_ID);
 
 		CHECK(format.GetChunkSize(uaudio::FMT_CHUNK_ID) == 16);
 		CHECK(fmt_chunk.audioFormat == uaudio::WAV_FORMAT_PCM);
@@ -709,4 +3882,937 @@ TEST_CASE("Audio Loading")
 
 		uaudio::logger::log_success("%s[OPENING NON-EXISTENT FILE]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Benchmarks")
+{
+	SUBCASE("Resampling")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK RESAMPLING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		constexpr uint32_t SECONDS = 10;
+		constexpr uint32_t PERIOD_FRAMES = 512;
+		const uint32_t source_rate = uaudio::WAVE_SAMPLE_RATE_44100, target_rate = uaudio::WAVE_SAMPLE_RATE_48000;
+		const uint16_t block_align = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+
+		std::vector<int16_t> dat(static_cast<size_t>(source_rate) * SECONDS * 2);
+		for (size_t i = 0; i < dat.size(); i++)
+			dat[i] = static_cast<int16_t>((i * 7919) % 65536 - 32768);
+		const uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+
+		// Load-time conversion (single thread, the data is below the thread threshold).
+		std::vector<unsigned char> load_data(uaudio::conversion::CalculateResampleSize(size, block_align, source_rate, target_rate));
+		uint32_t load_size = size;
+		auto start = std::chrono::high_resolution_clock::now();
+		uaudio::conversion::Resample(load_data.data(), reinterpret_cast<unsigned char *>(dat.data()), load_size, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO, source_rate, target_rate);
+		const double load_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// Streaming conversion in periods of the size the channels use.
+		uaudio::conversion::StreamResampler resampler;
+		resampler.Init(source_rate, target_rate, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_BITS_PER_SAMPLE_16, PERIOD_FRAMES);
+		std::vector<unsigned char> stream_data(resampler.GetMaxOutputSize(PERIOD_FRAMES * block_align));
+		start = std::chrono::high_resolution_clock::now();
+		for (uint32_t pos = 0; pos + PERIOD_FRAMES * block_align <= size; pos += PERIOD_FRAMES * block_align)
+			resampler.Process(reinterpret_cast<unsigned char *>(dat.data()) + pos, PERIOD_FRAMES * block_align, stream_data.data());
+		const double stream_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// Voices per core: how many seconds of audio one core converts per second.
+		uaudio::logger::log_info("Load-time: %.3f ms (%.1f voices per core).", load_seconds * 1000.0, SECONDS / load_seconds);
+		uaudio::logger::log_info("Streaming: %.3f ms (%.1f voices per core).", stream_seconds * 1000.0, SECONDS / stream_seconds);
+
+		CHECK(load_seconds > 0.0);
+		CHECK(stream_seconds > 0.0);
+
+		uaudio::logger::log_success("%s[BENCHMARK RESAMPLING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Time stretching")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK TIME STRETCHING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		constexpr uint32_t SECONDS = 10;
+		constexpr uint32_t PERIOD_FRAMES = 512;
+		const uint32_t sample_rate = uaudio::WAVE_SAMPLE_RATE_48000;
+		const uint16_t block_align = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+
+		std::vector<int16_t> dat(static_cast<size_t>(sample_rate) * SECONDS * 2);
+		for (size_t i = 0; i < dat.size(); i++)
+			dat[i] = static_cast<int16_t>((i * 7919) % 65536 - 32768);
+		const uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+
+		for (const float tempo : {0.5f, 1.5f, 2.0f})
+		{
+			uaudio::conversion::StreamTimeStretch stretch;
+			stretch.Init(sample_rate, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_BITS_PER_SAMPLE_16, PERIOD_FRAMES);
+			stretch.SetTempo(tempo);
+			std::vector<unsigned char> stream_data(stretch.GetMaxOutputSize(PERIOD_FRAMES * block_align));
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (uint32_t pos = 0; pos + PERIOD_FRAMES * block_align <= size; pos += PERIOD_FRAMES * block_align)
+				stretch.Process(reinterpret_cast<unsigned char *>(dat.data()) + pos, PERIOD_FRAMES * block_align, stream_data.data());
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			// Realtime factor: how many seconds of input one core stretches per second.
+			uaudio::logger::log_info("Tempo %.2fx: %.3f ms (realtime factor %.1f).", tempo, seconds * 1000.0, SECONDS / seconds);
+			CHECK(seconds > 0.0);
+		}
+
+		uaudio::logger::log_success("%s[BENCHMARK TIME STRETCHING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Dithering")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK DITHERING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		constexpr uint32_t SECONDS = 10;
+		std::vector<float> dat(static_cast<size_t>(uaudio::WAVE_SAMPLE_RATE_48000) * SECONDS * 2);
+		for (size_t i = 0; i < dat.size(); i++)
+			dat[i] = static_cast<float>((i * 7919) % 65536) / 65536.0f - 0.5f;
+		std::vector<int16_t> result(dat.size());
+
+		for (const uaudio::DITHER dither : {uaudio::DITHER::DITHER_NONE, uaudio::DITHER::DITHER_TPDF, uaudio::DITHER::DITHER_TPDF_NOISE_SHAPING})
+		{
+			uaudio::conversion::Ditherer ditherer;
+			ditherer.Init(dither, uaudio::WAVE_CHANNELS_STEREO);
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			ditherer.Quantize(reinterpret_cast<unsigned char *>(result.data()), dat.data(), static_cast<uint32_t>(dat.size()), uaudio::WAVE_BITS_PER_SAMPLE_16);
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			uaudio::logger::log_info("Dither %i: %.3f ms (%.1f Msamples/s).", static_cast<int>(dither), seconds * 1000.0, dat.size() / seconds / 1000000.0);
+			CHECK(seconds > 0.0);
+		}
+
+		uaudio::logger::log_success("%s[BENCHMARK DITHERING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Channel mixing")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK CHANNEL MIXING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		constexpr uint32_t SECONDS = 10;
+		std::vector<int16_t> dat(static_cast<size_t>(uaudio::WAVE_SAMPLE_RATE_48000) * SECONDS * uaudio::WAVE_CHANNELS_7_1);
+		for (size_t i = 0; i < dat.size(); i++)
+			dat[i] = static_cast<int16_t>((i * 7919) % 65536);
+
+		uint32_t size = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+		std::vector<int16_t> result(uaudio::conversion::CalculateChannelConvertSize(size, uaudio::WAVE_CHANNELS_7_1, uaudio::WAVE_CHANNELS_STEREO) / sizeof(int16_t));
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		uaudio::conversion::ConvertChannels(reinterpret_cast<unsigned char *>(result.data()), reinterpret_cast<const unsigned char *>(dat.data()), size, uaudio::WAVE_BITS_PER_SAMPLE_16, 0, uaudio::WAVE_CHANNELS_7_1, 0, uaudio::WAVE_CHANNELS_STEREO);
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		uaudio::logger::log_info("7.1 to stereo: %.3f ms for %u seconds (%.1fx realtime).", seconds * 1000.0, SECONDS, SECONDS / seconds);
+		CHECK(seconds > 0.0);
+
+		uaudio::logger::log_success("%s[BENCHMARK CHANNEL MIXING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Looping")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK LOOPING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A one second ping-pong loop in a 16-bit stereo sound, read in buffers like a channel does.
+		constexpr uint32_t SECONDS = 100;
+		constexpr uint32_t BUFFER_SIZE = static_cast<uint32_t>(uaudio::BUFFERSIZE::BUFFERSIZE_8192);
+		std::vector<int16_t> dat(static_cast<size_t>(uaudio::WAVE_SAMPLE_RATE_48000) * 2 * uaudio::WAVE_CHANNELS_STEREO);
+		for (size_t i = 0; i < dat.size(); i++)
+			dat[i] = static_cast<int16_t>((i * 7919) % 65536);
+		std::vector<unsigned char> buffer(BUFFER_SIZE);
+
+		uaudio::SMPL_Sample_Loop sample_loop = {0, static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_FORWARD), uaudio::WAVE_SAMPLE_RATE_48000 / 2, uaudio::WAVE_SAMPLE_RATE_48000 * 3 / 2 - 1, 0, 0};
+		uaudio::conversion::LoopSettings loop;
+		loop.end = static_cast<uint32_t>(dat.size() * sizeof(int16_t));
+		loop.sampleLoops = &sample_loop;
+		loop.numSampleLoops = 1;
+
+		const auto measure = [&]()
+		{
+			uint32_t position = 0;
+			uaudio::conversion::LoopState state;
+			const uint64_t total = static_cast<uint64_t>(uaudio::WAVE_SAMPLE_RATE_48000) * SECONDS * uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (uint64_t read = 0; read < total; read += BUFFER_SIZE)
+				uaudio::conversion::ReadLooped(buffer.data(), BUFFER_SIZE, reinterpret_cast<const unsigned char *>(dat.data()), loop.end, position, state, loop, uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_CHANNELS_STEREO);
+			return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		};
+
+		const double forward = measure();
+		sample_loop.type = static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_PING_PONG);
+		const double ping_pong = measure();
+		sample_loop.type = static_cast<uint32_t>(uaudio::LOOP_TYPE::LOOP_TYPE_REVERSE);
+		const double reverse = measure();
+
+		uaudio::logger::log_info("Forward: %.3f ms, ping-pong: %.3f ms, reverse: %.3f ms for %u seconds.", forward * 1000.0, ping_pong * 1000.0, reverse * 1000.0, SECONDS);
+		CHECK(forward > 0.0);
+
+		uaudio::logger::log_success("%s[BENCHMARK LOOPING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Metering")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK METERING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Samples of the gain stage, in the blocks that the channels use.
+		constexpr uint32_t SECONDS = 100;
+		constexpr uint32_t BLOCK_SAMPLES = 256;
+		std::vector<float> samples(static_cast<size_t>(uaudio::WAVE_SAMPLE_RATE_48000) * uaudio::WAVE_CHANNELS_7_1);
+		for (size_t i = 0; i < samples.size(); i++)
+			samples[i] = static_cast<float>((i * 7919) % 65536) / 32768.0f - 1.0f;
+
+		for (const uint16_t num_channels : {uaudio::WAVE_CHANNELS_MONO, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_CHANNELS_7_1})
+		{
+			uaudio::effects::Meter meter;
+			meter.Init(uaudio::WAVE_SAMPLE_RATE_48000, num_channels, uaudio::conversion::GetDefaultChannelMask(num_channels));
+			const uint32_t num_samples = uaudio::WAVE_SAMPLE_RATE_48000 * num_channels;
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (uint32_t second = 0; second < SECONDS; second++)
+				for (uint32_t i = 0; i < num_samples; i += BLOCK_SAMPLES)
+					meter.Process(samples.data() + i, std::min(BLOCK_SAMPLES, num_samples - i));
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			uaudio::logger::log_info("%u channels: %.3f ms for %u seconds (%.1f voices per core).", num_channels, seconds * 1000.0, SECONDS, SECONDS / seconds);
+			CHECK(seconds > 0.0);
+		}
+
+		uaudio::logger::log_success("%s[BENCHMARK METERING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Spectrum analysis")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK SPECTRUM ANALYSIS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// The audio thread only writes to the ring, the worker does the FFT.
+		constexpr uint32_t SECONDS = 100;
+		constexpr uint32_t BLOCK_SAMPLES = 256;
+		const uint32_t num_samples = uaudio::WAVE_SAMPLE_RATE_48000 * uaudio::WAVE_CHANNELS_STEREO;
+		std::vector<float> samples(num_samples);
+		for (size_t i = 0; i < samples.size(); i++)
+			samples[i] = static_cast<float>((i * 7919) % 65536) / 32768.0f - 1.0f;
+
+		uaudio::Analyzer analyzer;
+		analyzer.SetSampleRate(uaudio::WAVE_SAMPLE_RATE_48000);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t second = 0; second < SECONDS; second++)
+		{
+			// An update per buffer of 8192 bytes (2048 frames of 16-bit stereo).
+			for (uint32_t i = 0; i < num_samples; i += BLOCK_SAMPLES)
+			{
+				analyzer.Write(samples.data() + i, std::min(BLOCK_SAMPLES, num_samples - i), i % 4096, uaudio::WAVE_CHANNELS_STEREO);
+				if ((i + BLOCK_SAMPLES) % 4096 == 0)
+					analyzer.Commit();
+			}
+			analyzer.Commit();
+		}
+		const double write_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		constexpr uint32_t NUM_ANALYSES = 1000;
+		start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < NUM_ANALYSES; i++)
+		{
+			analyzer.Write(samples.data(), 2, 0, uaudio::WAVE_CHANNELS_STEREO);
+			analyzer.Commit();
+			analyzer.Analyze();
+		}
+		const double analyze_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		uaudio::logger::log_info("Ring writes: %.3f ms for %u seconds (%.1f voices per core).", write_seconds * 1000.0, SECONDS, SECONDS / write_seconds);
+		uaudio::logger::log_info("Analysis: %.3f us per FFT of %u frames.", analyze_seconds * 1000000.0 / NUM_ANALYSES, analyzer.GetFFTSize());
+		CHECK(write_seconds > 0.0);
+
+		uaudio::logger::log_success("%s[BENCHMARK SPECTRUM ANALYSIS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Loudness measurement")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK LOUDNESS MEASUREMENT]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Five minutes of 24-bit stereo.
+		constexpr uint32_t SECONDS = 300;
+		constexpr uint32_t NUM_SAMPLES = uaudio::WAVE_SAMPLE_RATE_48000 * SECONDS * uaudio::WAVE_CHANNELS_STEREO;
+		std::vector<unsigned char> data(static_cast<size_t>(NUM_SAMPLES) * 3);
+		for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+			uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_24>(data.data() + static_cast<size_t>(i) * 3, 0.5f * std::sin(static_cast<float>(i / 2) * 0.05f) + static_cast<float>((i * 7919) % 256) / 2048.0f);
+
+		for (const uint32_t num_threads : {1u, 0u})
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			const uaudio::effects::LoudnessMeasurement measurement = uaudio::effects::MeasureLoudness(data.data(), static_cast<uint32_t>(data.size()), uaudio::WAVE_BITS_PER_SAMPLE_24, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_SPEAKERS_STEREO, uaudio::WAVE_SAMPLE_RATE_48000, num_threads);
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			uaudio::logger::log_info("%s: %.3f ms for %u seconds (%.1f LUFS, %.2f dBTP).", num_threads == 1 ? "1 thread" : "All cores", seconds * 1000.0, SECONDS, measurement.integrated, measurement.truePeak);
+			CHECK(measurement.integrated > uaudio::effects::METER_SILENCE);
+		}
+
+		uaudio::logger::log_success("%s[BENCHMARK LOUDNESS MEASUREMENT]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Silence detection")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK SILENCE DETECTION]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A minute of quiet noise with a single loud frame in the middle, so both scans read half of the data.
+		constexpr uint32_t SECONDS = 60;
+		constexpr uint32_t NUM_FRAMES = uaudio::WAVE_SAMPLE_RATE_48000 * SECONDS;
+		std::vector<unsigned char> data(static_cast<size_t>(NUM_FRAMES) * uaudio::WAVE_CHANNELS_STEREO * sizeof(float));
+
+		for (const uint16_t bits_per_sample : {uaudio::WAVE_BITS_PER_SAMPLE_16, uaudio::WAVE_BITS_PER_SAMPLE_24, uaudio::WAVE_BITS_PER_SAMPLE_32})
+		{
+			const uint32_t num_samples = NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO;
+			const uint32_t size = num_samples * (bits_per_sample / 8);
+			for (uint32_t i = 0; i < num_samples; i++)
+			{
+				const float sample = i == num_samples / 2 ? 0.5f : static_cast<float>((i * 7919) % 64) / 65536.0f - 0.0005f;
+				if (bits_per_sample == uaudio::WAVE_BITS_PER_SAMPLE_16)
+					uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_16>(data.data() + i * 2, sample);
+				else if (bits_per_sample == uaudio::WAVE_BITS_PER_SAMPLE_24)
+					uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_24>(data.data() + i * 3, sample);
+				else
+					uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_32>(data.data() + i * 4, sample);
+			}
+
+			uint32_t first_frame = 0, end_frame = 0;
+			const auto start = std::chrono::high_resolution_clock::now();
+			uaudio::conversion::FindAudibleFrames(data.data(), size, bits_per_sample, uaudio::WAVE_CHANNELS_STEREO, -60.0f, first_frame, end_frame);
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			uaudio::logger::log_info("%u-bit: %.3f ms for %u seconds (%.1f GB/s).", bits_per_sample, seconds * 1000.0, SECONDS, size / seconds / 1000000000.0);
+			CHECK(first_frame == NUM_FRAMES / 2);
+			CHECK(end_frame == NUM_FRAMES / 2 + 1);
+		}
+
+		uaudio::logger::log_success("%s[BENCHMARK SILENCE DETECTION]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Denormals")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK DENORMALS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Ten seconds of stereo noise, and the same noise fading out (it reaches the denormals after 2 seconds and then stays silent).
+		constexpr uint32_t SAMPLE_RATE = uaudio::WAVE_SAMPLE_RATE_48000;
+		constexpr uint32_t SECONDS = 10;
+		constexpr uint32_t NUM_SAMPLES = SAMPLE_RATE * SECONDS * uaudio::WAVE_CHANNELS_STEREO;
+		std::vector<float> noise(NUM_SAMPLES), decay(NUM_SAMPLES);
+		for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+		{
+			noise[i] = static_cast<float>((i * 7919) % 256) / 128.0f - 1.0f;
+			decay[i] = noise[i] * std::exp(static_cast<float>(i / 2) * -50.0f / SAMPLE_RATE);
+		}
+
+		// Both with and without flushing, a decaying signal should not be slower than a loud one.
+		for (const bool flush : {false, true})
+		{
+			uaudio::utils::DenormalGuard denormal_guard(flush);
+
+			double times[2] = {};
+			for (uint32_t run = 0; run < 3; run++)
+			{
+				for (uint32_t i = 0; i < 2; i++)
+				{
+					uaudio::effects::Meter meter;
+					meter.Init(SAMPLE_RATE, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_SPEAKERS_STEREO);
+					const std::vector<float> &samples = i == 0 ? noise : decay;
+
+					const auto start = std::chrono::high_resolution_clock::now();
+					for (uint32_t j = 0; j < NUM_SAMPLES; j += 1024)
+						meter.Process(samples.data() + j, std::min(1024u, NUM_SAMPLES - j));
+					const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+					times[i] = run == 0 ? seconds : std::min(times[i], seconds);
+				}
+			}
+
+			uaudio::logger::log_info("%s: %.3f ms for %u seconds of noise, %.3f ms for %u seconds of decay (%.2fx).", flush ? "Flushing" : "Not flushing", times[0] * 1000.0, SECONDS, times[1] * 1000.0, SECONDS, times[1] / times[0]);
+			CHECK(times[1] < times[0] * 2.0);
+		}
+
+		uaudio::logger::log_success("%s[BENCHMARK DENORMALS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Memory mapping")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK MEMORY MAPPING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Five minutes of 48kHz 16-bit stereo silence.
+		constexpr uint32_t SECONDS = 300;
+		std::vector<int16_t> samples(uaudio::WAVE_SAMPLE_RATE_48000 * SECONDS * uaudio::WAVE_CHANNELS_STEREO, 0);
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		REQUIRE(uaudio::WaveReader::SaveSound("benchmark.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		// Loading and copying the format (the file is in the page cache after the first run).
+		double times[2] = {};
+		for (uint32_t run = 0; run < 3; run++)
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				uaudio::WaveConfig config;
+				config.memoryMap = i == 1;
+				const auto start = std::chrono::high_resolution_clock::now();
+				uaudio::WaveFormat loaded;
+				FILE *file = nullptr;
+				uaudio::WaveReader::LoadSound("benchmark.wav", loaded, file, config);
+				const uaudio::WaveFormat copy(loaded);
+				const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+				times[i] = run == 0 ? seconds : std::min(times[i], seconds);
+				CHECK(copy.GetChunkSize(uaudio::DATA_CHUNK_ID) == samples.size() * sizeof(int16_t));
+			}
+		remove("benchmark.wav");
+
+		uaudio::logger::log_info("Read: %.3f ms, mapped: %.3f ms for %u seconds.", times[0] * 1000.0, times[1] * 1000.0, SECONDS);
+		CHECK(times[1] < times[0]);
+
+		uaudio::logger::log_success("%s[BENCHMARK MEMORY MAPPING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Batch loading")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK BATCH LOADING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// 64 sounds of two seconds of 48kHz 24-bit stereo noise, that get converted to 16-bit.
+		constexpr uint32_t NUM_SOUNDS = 64;
+		std::vector<unsigned char> samples(uaudio::WAVE_SAMPLE_RATE_48000 * 2 * uaudio::WAVE_CHANNELS_STEREO * 3);
+		for (size_t i = 0; i < samples.size(); i++)
+			samples[i] = static_cast<unsigned char>((i * 7919) >> 3);
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * 3;
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size()));
+
+		std::vector<uaudio::SoundManifestEntry> manifest;
+		for (uint32_t i = 0; i < NUM_SOUNDS; i++)
+		{
+			const std::string path = "benchmark" + std::to_string(i) + ".wav";
+			REQUIRE(uaudio::WaveReader::SaveSound(path.c_str(), wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+			manifest.push_back({path, path, uaudio::WaveConfig()});
+		}
+
+		// One sound after another (like a loop of LoadSound), and the whole manifest at once.
+		uaudio::SoundSystem serial_system;
+		const uaudio::BatchLoadReport serial = serial_system.LoadSounds(manifest, 1);
+		uaudio::SoundSystem batch_system;
+		const uaudio::BatchLoadReport batch = batch_system.LoadSounds(manifest);
+		for (const uaudio::SoundManifestEntry &entry : manifest)
+			remove(entry.path.c_str());
+
+		CHECK(serial.numLoaded == NUM_SOUNDS);
+		CHECK(batch.numLoaded == NUM_SOUNDS);
+		uaudio::logger::log_info("Serial: %.3f ms (%.1f MB/s), batch: %.3f ms (%.1f MB/s) on %u threads.", serial.milliseconds, serial.megabytesPerSecond, batch.milliseconds, batch.megabytesPerSecond, std::thread::hardware_concurrency());
+		if (std::thread::hardware_concurrency() > 1)
+			CHECK(batch.milliseconds < serial.milliseconds);
+
+		uaudio::logger::log_success("%s[BENCHMARK BATCH LOADING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Chunk scanning")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK CHUNK SCANNING]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A file like the ones that come out of editors: metadata chunks (most of them not loaded), then a minute of 48kHz 16-bit stereo.
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO * sizeof(int16_t);
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+		std::vector<int16_t> samples(uaudio::WAVE_SAMPLE_RATE_48000 * 60 * uaudio::WAVE_CHANNELS_STEREO, 0);
+		std::vector<unsigned char> metadata(2000, 0);
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		for (uint32_t i = 0; i < 40; i++)
+		{
+			const char chunk_id[uaudio::CHUNK_ID_SIZE + 1] = {'m', 't', static_cast<char>('a' + i / 10), static_cast<char>('0' + i % 10), 0};
+			add_chunk(wave_format, chunk_id, metadata.data(), static_cast<uint32_t>(metadata.size()));
+		}
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, samples.data(), static_cast<uint32_t>(samples.size() * sizeof(int16_t)));
+		REQUIRE(uaudio::WaveReader::SaveSound("benchmark.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+#if defined(__linux__)
+		// The amount of read system calls of the process so far.
+		const auto count_reads = []()
+		{
+			FILE *io = fopen("/proc/self/io", "r");
+			char line[128] = {};
+			uint64_t reads = 0;
+			while (io != nullptr && fgets(line, sizeof(line), io) != nullptr)
+				if (sscanf(line, "syscr: %llu", reinterpret_cast<unsigned long long *>(&reads)) == 1)
+					break;
+			if (io != nullptr)
+				fclose(io);
+			return reads;
+		};
+#else
+		const auto count_reads = []() { return uint64_t(0); };
+#endif
+
+		// How the chunks used to be found: a read for the id and for the size of every chunk, and a seek over the ones that are not loaded.
+		const auto scan_chunks = []()
+		{
+			FILE *file = nullptr;
+			fopen_s(&file, "benchmark.wav", "rb");
+			fseek(file, 0, SEEK_END);
+			const long total_size = ftell(file);
+			rewind(file);
+			std::vector<std::vector<unsigned char>> chunks;
+			while (total_size != ftell(file))
+			{
+				char chunk_id[uaudio::CHUNK_ID_SIZE] = {};
+				uint32_t chunk_size = 0;
+				fread(chunk_id, sizeof(chunk_id), 1, file);
+				fread(&chunk_size, sizeof(chunk_size), 1, file);
+				if (strncmp(chunk_id, uaudio::RIFF_CHUNK_ID, uaudio::CHUNK_ID_SIZE) == 0)
+					fseek(file, 4, SEEK_CUR);
+				else if (strncmp(chunk_id, uaudio::FMT_CHUNK_ID, uaudio::CHUNK_ID_SIZE) == 0 || strncmp(chunk_id, uaudio::DATA_CHUNK_ID, uaudio::CHUNK_ID_SIZE) == 0)
+				{
+					chunks.emplace_back(chunk_size);
+					fread(chunks.back().data(), 1, chunk_size, file);
+				}
+				else
+					fseek(file, static_cast<long>(chunk_size), SEEK_CUR);
+			}
+			fclose(file);
+			return chunks.size();
+		};
+
+		double times[2] = {};
+		uint64_t reads[2] = {};
+		for (uint32_t run = 0; run < 3; run++)
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				const uint64_t first_reads = count_reads();
+				const auto start = std::chrono::high_resolution_clock::now();
+				if (i == 0)
+					CHECK(scan_chunks() == 2);
+				else
+				{
+					uaudio::WaveFormat loaded;
+					FILE *file = nullptr;
+					uaudio::WaveReader::LoadSound("benchmark.wav", loaded, file);
+					CHECK(loaded.GetChunkSize(uaudio::DATA_CHUNK_ID) == samples.size() * sizeof(int16_t));
+				}
+				const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+				times[i] = run == 0 ? seconds : std::min(times[i], seconds);
+
+				// Counting reads takes one read itself.
+				reads[i] = count_reads() - first_reads - 1;
+			}
+		remove("benchmark.wav");
+
+		uaudio::logger::log_info("Seeking: %.3f ms (%llu reads), single pass: %.3f ms (%llu reads).", times[0] * 1000.0, static_cast<unsigned long long>(reads[0]), times[1] * 1000.0, static_cast<unsigned long long>(reads[1]));
+#if defined(__linux__)
+		CHECK(reads[1] < reads[0]);
+#endif
+
+		uaudio::logger::log_success("%s[BENCHMARK CHUNK SCANNING]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Chunk lookup")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK CHUNK LOOKUP]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A sound with metadata chunks in front of the data, looked up the way a channel does it for every buffer.
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.blockAlign = uaudio::BLOCK_ALIGN_16_BIT_STEREO;
+		std::vector<unsigned char> metadata(64, 0);
+		std::vector<unsigned char> data(4096, 0);
+		uaudio::WaveFormat wave_format;
+		for (uint32_t i = 0; i < 20; i++)
+		{
+			const char chunk_id[uaudio::CHUNK_ID_SIZE + 1] = {'m', 't', static_cast<char>('a' + i / 10), static_cast<char>('0' + i % 10), 0};
+			add_chunk(wave_format, chunk_id, metadata.data(), static_cast<uint32_t>(metadata.size()));
+		}
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, data.data(), static_cast<uint32_t>(data.size()));
+
+		// How the chunks used to be found: a string compare with every chunk until the id matches.
+		std::vector<uaudio::WaveChunkData *> chunks;
+		for (const char *chunk_id : {"mta0", "mta1", "mta2", "mta3", "mta4", "mta5", "mta6", "mta7", "mta8", "mta9", "mtb0", "mtb1", "mtb2", "mtb3", "mtb4", "mtb5", "mtb6", "mtb7", "mtb8", "mtb9", uaudio::FMT_CHUNK_ID, uaudio::DATA_CHUNK_ID})
+			chunks.push_back(reinterpret_cast<uaudio::WaveChunkData *>(wave_format.GetChunkBuffer(chunk_id) - sizeof(uaudio::WaveChunkData)));
+		const auto find_chunk = [&chunks](const char *a_ChunkID)
+		{
+			for (auto *chunk : chunks)
+				if (strncmp(a_ChunkID, reinterpret_cast<char *>(chunk->chunk_id), uaudio::CHUNK_ID_SIZE) == 0)
+					return chunk;
+			return static_cast<uaudio::WaveChunkData *>(nullptr);
+		};
+
+		constexpr uint32_t NUM_LOOKUPS = 1000000;
+		volatile uint32_t sink = 0;
+		double times[2] = {};
+		for (uint32_t run = 0; run < 3; run++)
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				const auto start = std::chrono::high_resolution_clock::now();
+				uint32_t total = 0;
+				for (uint32_t j = 0; j < NUM_LOOKUPS; j++)
+				{
+					// The block align, the data size and the data, like the reads of a channel.
+					const char *chunk_id = (j & 1) == 0 ? uaudio::FMT_CHUNK_ID : uaudio::DATA_CHUNK_ID;
+					if (i == 0)
+						total += find_chunk(chunk_id)->chunkSize;
+					else
+						total += wave_format.GetChunkSize(chunk_id);
+				}
+				sink = total;
+				const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+				times[i] = run == 0 ? seconds : std::min(times[i], seconds);
+			}
+		CHECK(sink == (NUM_LOOKUPS / 2) * (sizeof(fmt_chunk) + data.size()));
+
+		uaudio::logger::log_info("String compare: %.3f ms, index: %.3f ms (%.1fx) for %u lookups.", times[0] * 1000.0, times[1] * 1000.0, times[0] / times[1], NUM_LOOKUPS);
+
+		uaudio::logger::log_success("%s[BENCHMARK CHUNK LOOKUP]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Conversion plan")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK CONVERSION PLAN]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// A minute of 24-bit 48kHz stereo that gets loaded as 16-bit mono.
+		constexpr uint32_t NUM_FRAMES = uaudio::WAVE_SAMPLE_RATE_48000 * 60;
+		const uint32_t source_size = NUM_FRAMES * uaudio::BLOCK_ALIGN_24_BIT_STEREO;
+		unsigned char *source = reinterpret_cast<unsigned char *>(malloc(source_size));
+		REQUIRE(source != nullptr);
+		for (uint32_t i = 0; i < NUM_FRAMES * uaudio::WAVE_CHANNELS_STEREO; i++)
+			uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_24>(source + i * 3, 0.5f * std::sin(static_cast<float>(i) * 0.001f));
+
+#if defined(__linux__)
+		// The memory of the process (in kB): the peak (since the last reset) or what it uses now.
+		const auto read_memory = [](const char *a_Field)
+		{
+			FILE *status = fopen("/proc/self/status", "r");
+			char line[128] = {};
+			unsigned long long memory = 0;
+			while (status != nullptr && fgets(line, sizeof(line), status) != nullptr)
+				if (strncmp(line, a_Field, strlen(a_Field)) == 0 && sscanf(line + strlen(a_Field), ": %llu", &memory) == 1)
+					break;
+			if (status != nullptr)
+				fclose(status);
+			return memory;
+		};
+		const auto reset_peak = []()
+		{
+			FILE *clear_refs = fopen("/proc/self/clear_refs", "w");
+			if (clear_refs == nullptr)
+				return false;
+			const bool reset = fputs("5", clear_refs) >= 0;
+			fclose(clear_refs);
+			return reset;
+		};
+#else
+		const auto read_memory = [](const char *) { return 0ull; };
+		const auto reset_peak = []() { return false; };
+#endif
+
+		uaudio::conversion::ConversionFormat source_format, target_format;
+		source_format.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_24;
+		source_format.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		target_format.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+		target_format.numChannels = uaudio::WAVE_CHANNELS_MONO;
+		uaudio::conversion::ConversionPlan plan;
+		REQUIRE(plan.Init(source_format, target_format, uaudio::DITHER::DITHER_TPDF));
+
+		// How the conversion used to happen: a new data chunk for the bit depth and then another one for the channels.
+		double times[2] = {};
+		unsigned long long peaks[2] = {};
+		bool measured_peak = true;
+		for (uint32_t run = 0; run < 3; run++)
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				const unsigned long long memory = read_memory("VmRSS");
+				measured_peak = reset_peak() && measured_peak;
+				const auto start = std::chrono::high_resolution_clock::now();
+				uint32_t size = source_size;
+				unsigned char *data = nullptr;
+				if (i == 0)
+				{
+					unsigned char *bits = reinterpret_cast<unsigned char *>(malloc(uaudio::conversion::Calculate24To16Size(size)));
+					uaudio::conversion::Convert24To16(bits, source, size, uaudio::DITHER::DITHER_TPDF, uaudio::WAVE_CHANNELS_STEREO);
+					data = reinterpret_cast<unsigned char *>(malloc(uaudio::conversion::CalculateChannelConvertSize(size, uaudio::WAVE_CHANNELS_STEREO, uaudio::WAVE_CHANNELS_MONO)));
+					uaudio::conversion::ConvertChannels(data, bits, size, uaudio::WAVE_BITS_PER_SAMPLE_16, 0, uaudio::WAVE_CHANNELS_STEREO, 0, uaudio::WAVE_CHANNELS_MONO);
+					free(bits);
+				}
+				else
+				{
+					data = reinterpret_cast<unsigned char *>(malloc(plan.CalculateSize(size)));
+					plan.Convert(data, source, size);
+				}
+				const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+				times[i] = run == 0 ? seconds : std::min(times[i], seconds);
+				peaks[i] = read_memory("VmHWM") - std::min(memory, read_memory("VmHWM"));
+				CHECK(size == NUM_FRAMES * uaudio::BLOCK_ALIGN_16_BIT_MONO);
+				free(data);
+#if defined(__GLIBC__)
+				// Freed memory stays in the heap otherwise, so the next run would not need new pages.
+				malloc_trim(0);
+#endif
+			}
+		free(source);
+
+		const double megabytes = static_cast<double>(source_size) / 1000000.0;
+		uaudio::logger::log_info("Two passes: %.3f ms (%.1f MB/s), one pass: %.3f ms (%.1f MB/s).", times[0] * 1000.0, megabytes / times[0], times[1] * 1000.0, megabytes / times[1]);
+		if (measured_peak)
+		{
+			uaudio::logger::log_info("Peak memory on top of the original data: two passes %.1f MB, one pass %.1f MB.", static_cast<double>(peaks[0]) / 1000.0, static_cast<double>(peaks[1]) / 1000.0);
+			CHECK(peaks[1] < peaks[0]);
+		}
+		CHECK(times[1] < times[0]);
+
+		uaudio::logger::log_success("%s[BENCHMARK CONVERSION PLAN]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Conversion kernels")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK CONVERSION KERNELS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Ten seconds of 48kHz stereo through every kernel, scalar and the version that the cpu picks.
+		constexpr uint32_t NUM_SAMPLES = uaudio::WAVE_SAMPLE_RATE_48000 * uaudio::WAVE_CHANNELS_STEREO * 10;
+		std::vector<float> floats(NUM_SAMPLES);
+		std::vector<unsigned char> pcm16(NUM_SAMPLES * sizeof(int16_t)), pcm24(NUM_SAMPLES * 3), pcm32(NUM_SAMPLES * 2 * sizeof(float)), out(NUM_SAMPLES * 2 * sizeof(float));
+		for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+		{
+			floats[i] = 0.8f * std::sin(static_cast<float>(i) * 0.001f);
+			uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_16>(pcm16.data() + i * sizeof(int16_t), floats[i]);
+			uaudio::conversion::WriteSample<uaudio::WAVE_BITS_PER_SAMPLE_24>(pcm24.data() + i * 3, floats[i]);
+			memcpy(pcm32.data() + i * sizeof(float), &floats[i], sizeof(float));
+		}
+
+		const uaudio::conversion::ConversionKernels *kernels[2] = {&uaudio::conversion::GetConversionKernels(uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR), &uaudio::conversion::GetConversionKernels()};
+		const char *names[] = {"SCALAR", "SSE2", "SSSE3", "AVX2", "NEON"};
+		uaudio::logger::log_info("Picked kernels: %s.", names[static_cast<int>(kernels[1]->simdLevel)]);
+
+		// The amount of bytes that a kernel reads and writes.
+		struct Kernel
+		{
+			const char *name;
+			double bytes;
+		};
+		const Kernel kernel_list[] = {
+			{"read 16-bit", NUM_SAMPLES * (2.0 + 4.0)},
+			{"read 24-bit", NUM_SAMPLES * (3.0 + 4.0)},
+			{"write 16-bit", NUM_SAMPLES * (4.0 + 2.0)},
+			{"mono to stereo 16-bit", NUM_SAMPLES * (2.0 + 4.0)},
+			{"stereo to mono 16-bit", NUM_SAMPLES * (2.0 + 1.0)},
+			{"mono to stereo 32-bit", NUM_SAMPLES * (4.0 + 8.0)},
+			{"stereo to mono 32-bit", NUM_SAMPLES * (4.0 + 2.0)},
+		};
+		const auto run_kernel = [&](const uaudio::conversion::ConversionKernels &a_Kernels, uint32_t a_Index)
+		{
+			switch (a_Index)
+			{
+				case 0: a_Kernels.read16(reinterpret_cast<float *>(out.data()), pcm16.data(), NUM_SAMPLES); break;
+				case 1: a_Kernels.read24(reinterpret_cast<float *>(out.data()), pcm24.data(), NUM_SAMPLES); break;
+				case 2: a_Kernels.write16(out.data(), floats.data(), NUM_SAMPLES); break;
+				case 3: a_Kernels.monoToStereo16(out.data(), pcm16.data(), NUM_SAMPLES); break;
+				case 4: a_Kernels.stereoToMono16(out.data(), pcm16.data(), NUM_SAMPLES / 2); break;
+				case 5: a_Kernels.monoToStereo32(out.data(), pcm32.data(), NUM_SAMPLES); break;
+				default: a_Kernels.stereoToMono32(out.data(), pcm32.data(), NUM_SAMPLES / 2); break;
+			}
+		};
+
+		double total_times[2] = {};
+		for (uint32_t k = 0; k < sizeof(kernel_list) / sizeof(kernel_list[0]); k++)
+		{
+			double times[2] = {};
+			for (uint32_t run = 0; run < 5; run++)
+				for (uint32_t i = 0; i < 2; i++)
+				{
+					const auto start = std::chrono::high_resolution_clock::now();
+					run_kernel(*kernels[i], k);
+					const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+					times[i] = run == 0 ? seconds : std::min(times[i], seconds);
+				}
+			total_times[0] += times[0];
+			total_times[1] += times[1];
+			uaudio::logger::log_info("%s: scalar %.2f GB/s, %s %.2f GB/s (%.1fx).", kernel_list[k].name, kernel_list[k].bytes / times[0] / 1e9, names[static_cast<int>(kernels[1]->simdLevel)], kernel_list[k].bytes / times[1] / 1e9, times[0] / times[1]);
+		}
+		if (kernels[1]->simdLevel != uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR)
+			CHECK(total_times[1] < total_times[0]);
+
+		uaudio::logger::log_success("%s[BENCHMARK CONVERSION KERNELS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Sample formats")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK SAMPLE FORMATS]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Ten seconds of 48kHz stereo from every sample format to every other sample format.
+		constexpr uint32_t NUM_SAMPLES = uaudio::WAVE_SAMPLE_RATE_48000 * uaudio::WAVE_CHANNELS_STEREO * 10;
+		const std::array<uaudio::SAMPLE_FORMAT, 6> sample_formats = {uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT24, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64};
+		const char *names[] = {"u8", "i16", "i24", "i32", "f32", "f64"};
+
+		std::vector<unsigned char> reference(NUM_SAMPLES * sizeof(double));
+		for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+			uaudio::conversion::WriteFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(reference.data() + i * sizeof(double), 0.8 * std::sin(static_cast<double>(i) * 0.001));
+		std::array<std::vector<unsigned char>, 6> data;
+		for (size_t i = 0; i < sample_formats.size(); i++)
+		{
+			uint32_t size = static_cast<uint32_t>(reference.size());
+			data[i].resize(uaudio::conversion::CalculateSampleFormatSize(size, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, sample_formats[i]));
+			uaudio::conversion::ConvertSampleFormat(data[i].data(), reference.data(), size, uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64, sample_formats[i], uaudio::DITHER::DITHER_NONE);
+		}
+		std::vector<unsigned char> out(NUM_SAMPLES * sizeof(double));
+
+		// How a conversion without a table would look: the formats get checked for every sample.
+		const auto read_any = [](uaudio::SAMPLE_FORMAT a_SampleFormat, const unsigned char *a_Data)
+		{
+			switch (a_SampleFormat)
+			{
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8: return uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8>(a_Data);
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16: return uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16>(a_Data);
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT24: return uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT24>(a_Data);
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32: return uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>(a_Data);
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32: return uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32>(a_Data);
+				default: return uaudio::conversion::ReadFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(a_Data);
+			}
+		};
+		const auto write_any = [](uaudio::SAMPLE_FORMAT a_SampleFormat, unsigned char *a_Data, double a_Value)
+		{
+			switch (a_SampleFormat)
+			{
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8: uaudio::conversion::WriteFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_UINT8>(a_Data, a_Value); break;
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16: uaudio::conversion::WriteFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT16>(a_Data, a_Value); break;
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT24: uaudio::conversion::WriteFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT24>(a_Data, a_Value); break;
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32: uaudio::conversion::WriteFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_INT32>(a_Data, a_Value); break;
+				case uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32: uaudio::conversion::WriteFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT32>(a_Data, a_Value); break;
+				default: uaudio::conversion::WriteFormatSample<uaudio::SAMPLE_FORMAT::SAMPLE_FORMAT_FLOAT64>(a_Data, a_Value); break;
+			}
+		};
+
+		double total_times[2] = {};
+		for (size_t i = 0; i < sample_formats.size(); i++)
+		{
+			std::string row = std::string(names[i]) + " to:";
+			for (size_t j = 0; j < sample_formats.size(); j++)
+			{
+				const uint32_t original_bytes = uaudio::conversion::GetBitsPerSample(sample_formats[i]) / 8, bytes = uaudio::conversion::GetBitsPerSample(sample_formats[j]) / 8;
+				double times[2] = {};
+				for (uint32_t run = 0; run < 3; run++)
+					for (uint32_t k = 0; k < 2; k++)
+					{
+						const auto start = std::chrono::high_resolution_clock::now();
+						if (k == 0)
+						{
+							for (uint32_t s = 0; s < NUM_SAMPLES; s++)
+								write_any(sample_formats[j], out.data() + s * bytes, read_any(sample_formats[i], data[i].data() + s * original_bytes));
+						}
+						else
+						{
+							uint32_t size = static_cast<uint32_t>(data[i].size());
+							uaudio::conversion::ConvertSampleFormat(out.data(), data[i].data(), size, sample_formats[i], sample_formats[j], uaudio::DITHER::DITHER_NONE);
+						}
+						const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+						times[k] = run == 0 ? seconds : std::min(times[k], seconds);
+					}
+				total_times[0] += times[0];
+				total_times[1] += times[1];
+
+				char cell[32] = {};
+				snprintf(cell, sizeof(cell), " %s %.0f", names[j], static_cast<double>(NUM_SAMPLES) / times[1] / 1000000.0);
+				row += cell;
+			}
+			uaudio::logger::log_info("%s (million samples per second).", row.c_str());
+		}
+		uaudio::logger::log_info("All pairs: per sample checks %.3f ms, table %.3f ms (%.1fx).", total_times[0] * 1000.0, total_times[1] * 1000.0, total_times[0] / total_times[1]);
+		CHECK(total_times[1] < total_times[0]);
+
+		uaudio::logger::log_success("%s[BENCHMARK SAMPLE FORMATS]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("8-bit")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK 8-BIT]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		// Ten seconds of 48kHz stereo 8-bit samples.
+		constexpr uint32_t NUM_SAMPLES = uaudio::WAVE_SAMPLE_RATE_48000 * uaudio::WAVE_CHANNELS_STEREO * 10;
+		std::vector<unsigned char> data(NUM_SAMPLES);
+		for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+			data[i] = static_cast<unsigned char>(128 + std::lrint(100.0 * std::sin(static_cast<double>(i) * 0.001)));
+		std::vector<float> samples(NUM_SAMPLES);
+
+		// Reading as floats with the offset and the scale for every sample, through the table (the scalar kernel) and through the best kernel of the cpu.
+		const uaudio::conversion::ConversionKernels &scalar = uaudio::conversion::GetConversionKernels(uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR);
+		double times[3] = {};
+		for (uint32_t run = 0; run < 5; run++)
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const auto start = std::chrono::high_resolution_clock::now();
+				if (k == 0)
+				{
+					for (uint32_t i = 0; i < NUM_SAMPLES; i++)
+						samples[i] = static_cast<float>(data[i] - 128) / 128.0f;
+				}
+				else if (k == 1)
+					scalar.read8(samples.data(), data.data(), NUM_SAMPLES);
+				else
+					uaudio::conversion::ReadSamples(samples.data(), data.data(), NUM_SAMPLES, uaudio::WAVE_BITS_PER_SAMPLE_8);
+				const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+				times[k] = run == 0 ? seconds : std::min(times[k], seconds);
+			}
+		uaudio::logger::log_info("Reading: per sample %.3f ms, table %.3f ms, kernels %.3f ms.", times[0] * 1000.0, times[1] * 1000.0, times[2] * 1000.0);
+		if (uaudio::conversion::GetSimdLevel() != uaudio::SIMD_LEVEL::SIMD_LEVEL_SCALAR)
+			CHECK(times[2] < times[1]);
+
+		// Loading the same file as 8-bit (the default config) and converted to 16-bit.
+		uaudio::FMT_Chunk fmt_chunk(nullptr);
+		fmt_chunk.audioFormat = uaudio::WAV_FORMAT_PCM;
+		fmt_chunk.numChannels = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.sampleRate = uaudio::WAVE_SAMPLE_RATE_48000;
+		fmt_chunk.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_8;
+		fmt_chunk.blockAlign = uaudio::WAVE_CHANNELS_STEREO;
+		fmt_chunk.byteRate = fmt_chunk.sampleRate * fmt_chunk.blockAlign;
+		uaudio::WaveFormat wave_format;
+		add_chunk(wave_format, uaudio::FMT_CHUNK_ID, &fmt_chunk, sizeof(fmt_chunk));
+		add_chunk(wave_format, uaudio::DATA_CHUNK_ID, data.data(), NUM_SAMPLES);
+		REQUIRE(uaudio::WaveReader::SaveSound("8bit_benchmark.wav", wave_format) == uaudio::WAVE_SAVING_STATUS::STATUS_SUCCESSFUL);
+
+		uint32_t sizes[2] = {};
+		double load_times[2] = {};
+		for (uint32_t k = 0; k < 2; k++)
+		{
+			uaudio::WaveConfig config;
+			if (k == 1)
+				config.bitsPerSample = uaudio::WAVE_BITS_PER_SAMPLE_16;
+			const auto start = std::chrono::high_resolution_clock::now();
+			uaudio::WaveFile file("8bit_benchmark.wav", config);
+			load_times[k] = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			sizes[k] = file.GetDataSize();
+		}
+		remove("8bit_benchmark.wav");
+		uaudio::logger::log_info("Loading: 8-bit %.3f ms (%u bytes), to 16-bit %.3f ms (%u bytes).", load_times[0] * 1000.0, sizes[0], load_times[1] * 1000.0, sizes[1]);
+		CHECK(sizes[0] == NUM_SAMPLES);
+		CHECK(sizes[1] == sizes[0] * 2);
+
+		uaudio::logger::log_success("%s[BENCHMARK 8-BIT]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+	SUBCASE("Spatialization")
+	{
+		uaudio::logger::log_info("%s[BENCHMARK SPATIALIZATION]%s", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+
+		constexpr uint32_t NUM_EMITTERS = 10000;
+		constexpr uint32_t NUM_UPDATES = 100;
+
+		uaudio::Spatializer spatializer(NUM_EMITTERS);
+		for (uint32_t i = 0; i < NUM_EMITTERS; i++)
+		{
+			const uaudio::EmitterHandle emitter = spatializer.AddEmitter();
+			const float value = static_cast<float>(i);
+			spatializer.SetEmitterPosition(emitter, {std::sin(value) * 50.0f, std::cos(value * 0.7f) * 5.0f, std::cos(value) * 50.0f});
+			spatializer.SetEmitterVelocity(emitter, {std::cos(value) * 10.0f, 0.0f, std::sin(value) * 10.0f});
+			spatializer.SetEmitterDirection(emitter, {std::cos(value * 1.3f), 0.0f, std::sin(value * 1.3f)});
+			spatializer.SetEmitterCone(emitter, 1.0f, 2.5f, 0.3f);
+			spatializer.SetEmitterAttenuation(emitter, static_cast<uaudio::ATTENUATION_CURVE>(i % 4), 1.0f, 100.0f);
+		}
+
+		uaudio::Listener listener;
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < NUM_UPDATES; i++)
+		{
+			listener.position.x = static_cast<float>(i) * 0.1f;
+			spatializer.SetListener(listener);
+			spatializer.Update();
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		uaudio::logger::log_info("%u emitters: %.3f us per update (%.2f ns per emitter).", NUM_EMITTERS, seconds * 1000000.0 / NUM_UPDATES, seconds * 1000000000.0 / NUM_UPDATES / NUM_EMITTERS);
+		CHECK(seconds > 0.0);
+
+		uaudio::logger::log_success("%s[BENCHMARK SPATIALIZATION]%s\n", uaudio::logger::COLOR_CYAN, uaudio::logger::COLOR_WHITE);
+	}
+}